@@ -0,0 +1,243 @@
+// times expressions using quantities from include/units against the same expressions using doubles, on the host. Where
+// cases.cpp checks that a single expression compiles to the same code, this measures whole loops, where inlining,
+// vectorization and the optimization level decide whether the units cost anything. Every benchmark runs a units
+// version and a raw version over the same inputs, and prints the time per element of both and their ratio
+#include "units/Angle.hpp"
+#include "units/Pose.hpp"
+#include "units/Vector2D.hpp"
+#include "units/Vector3D.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+namespace {
+// the number of elements every pass works on, small enough that every array fits in the L1 cache
+constexpr size_t SIZE = 512;
+// each benchmark is timed this many times, and the fastest is reported, which is the least disturbed by other processes
+constexpr int REPETITIONS = 5;
+// each repetition runs passes for at least this long
+constexpr double MIN_NANOS = 20e6;
+
+/**
+ * @brief Tell the compiler that memory was read and written, so stores to the outputs aren't removed, and passes
+ * aren't merged, like benchmark::ClobberMemory
+ */
+inline void clobberMemory() { asm volatile("" : : : "memory"); }
+
+/**
+ * @brief Time a function which processes SIZE elements
+ *
+ * @param pass the function
+ * @return double the fastest time per element, in nanoseconds
+ */
+template <typename F> double nanosPerElement(F&& pass) {
+    using Clock = std::chrono::steady_clock;
+    double best = INFINITY;
+    for (int i = 0; i < REPETITIONS; i++) {
+        size_t passes = 0;
+        const auto start = Clock::now();
+        auto end = start;
+        do {
+            pass();
+            clobberMemory();
+            passes++;
+            end = Clock::now();
+        } while (std::chrono::duration<double, std::nano>(end - start).count() < MIN_NANOS);
+        const double nanos = std::chrono::duration<double, std::nano>(end - start).count();
+        best = std::min(best, nanos / double(passes * SIZE));
+    }
+    return best;
+}
+
+/**
+ * @brief Time the units and raw version of an expression, and print a line with both and their ratio
+ *
+ * @param name the name of the benchmark
+ * @param units the units version
+ * @param raw the raw version
+ */
+template <typename U, typename R> void compare(const char* name, U&& units, R&& raw) {
+    const double unitsNanos = nanosPerElement(units);
+    const double rawNanos = nanosPerElement(raw);
+    std::printf("%-12s %-22s %12.3f %12.3f %8.2f\n", BENCH_LEVEL, name, unitsNanos, rawNanos, unitsNanos / rawNanos);
+}
+
+// inputs, which are filled in at runtime so the compiler can't fold them. Quantities can't be default constructed, so
+// every array is a vector, which the raw versions use too so both versions index memory the same way
+std::vector<double> a(SIZE), b(SIZE), c(SIZE), d(SIZE);
+} // namespace
+
+// outputs, which can be seen by other translation units so the compiler can't remove the stores to them
+// vectors are written to the raw output with their components next to each other, like an array of Vector2D
+std::vector<double> rawOut(3 * SIZE);
+std::vector<Length> lengthOut(SIZE, 0_m);
+std::vector<Number> numberOut(SIZE, 0);
+std::vector<Area> areaOut(SIZE, 0_m2);
+std::vector<Angle> angleOut(SIZE, 0_stRad);
+std::vector<units::V2Position> vectorOut(SIZE, units::V2Position(0_m, 0_m));
+std::vector<units::Vector3D<Length>> vector3Out(SIZE, units::Vector3D<Length>(0_m, 0_m, 0_m));
+
+int main() {
+    // a simple linear congruential generator, so every run gets the same inputs
+    uint32_t state = 1;
+    auto random = [&] {
+        state = state * 1664525 + 1013904223;
+        return double(state >> 8) / double(1 << 24) * 2 - 1;
+    };
+    for (size_t i = 0; i < SIZE; i++) {
+        a[i] = random();
+        b[i] = random();
+        c[i] = random();
+        d[i] = random() + 2;
+    }
+    // quantities with the same bits as the raw inputs
+    std::vector<Length> la, lb, lc;
+    std::vector<Time> td;
+    std::vector<Angle> aa;
+    std::vector<units::V2Position> points;
+    for (size_t i = 0; i < SIZE; i++) {
+        la.push_back(Length(a[i]));
+        lb.push_back(Length(b[i]));
+        lc.push_back(Length(c[i]));
+        td.push_back(Time(d[i]));
+        aa.push_back(Angle(a[i] * M_PI));
+        points.push_back(units::V2Position(la[i], lb[i]));
+    }
+
+    std::printf("%-12s %-22s %12s %12s %8s\n", "level", "benchmark", "units ns/el", "raw ns/el", "ratio");
+
+    compare(
+        "quantity_arithmetic",
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) lengthOut[i] = la[i] * 2 + lb[i] - lc[i] / 4;
+        },
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) rawOut[i] = a[i] * 2 + b[i] - c[i] / 4;
+        });
+    compare(
+        "quantity_divide",
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) lengthOut[i] = la[i] / td[i] * 10_msec;
+        },
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) rawOut[i] = a[i] / d[i] * 0.01;
+        });
+    compare(
+        "quantity_accumulate",
+        [&] {
+            Length sum = 0_m;
+            for (size_t i = 0; i < SIZE; i++) sum += la[i] * lb[i] / units::abs(lc[i]);
+            lengthOut[0] = sum;
+        },
+        [&] {
+            double sum = 0;
+            for (size_t i = 0; i < SIZE; i++) sum += a[i] * b[i] / std::abs(c[i]);
+            rawOut[0] = sum;
+        });
+    compare(
+        "trig",
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) numberOut[i] = units::sin(aa[i]) + units::cos(aa[i]);
+        },
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) rawOut[i] = std::sin(a[i] * M_PI) + std::cos(a[i] * M_PI);
+        });
+    compare(
+        "atan2",
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) angleOut[i] = units::atan2(la[i], lb[i]);
+        },
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) rawOut[i] = std::atan2(a[i], b[i]);
+        });
+    compare(
+        "vector2d_add_scale",
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) {
+                vectorOut[i] = (units::V2Position(la[i], lb[i]) + units::V2Position(lc[i], la[i])) * 0.5;
+            }
+        },
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) {
+                rawOut[2 * i] = (a[i] + c[i]) * 0.5;
+                rawOut[2 * i + 1] = (b[i] + a[i]) * 0.5;
+            }
+        });
+    compare(
+        "vector2d_dot",
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) {
+                areaOut[i] = units::V2Position(la[i], lb[i]) * units::V2Position(lc[i], la[i]);
+            }
+        },
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) rawOut[i] = a[i] * c[i] + b[i] * a[i];
+        });
+    compare(
+        "vector2d_magnitude",
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) lengthOut[i] = units::V2Position(la[i], lb[i]).magnitude();
+        },
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) rawOut[i] = std::sqrt(a[i] * a[i] + b[i] * b[i]);
+        });
+    compare(
+        "vector2d_rotate",
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) vectorOut[i] = units::V2Position(la[i], lb[i]).rotatedBy(aa[i]);
+        },
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) {
+                const double angle = std::atan2(b[i], a[i]) + a[i] * M_PI;
+                const double magnitude = std::sqrt(a[i] * a[i] + b[i] * b[i]);
+                rawOut[2 * i] = magnitude * std::cos(angle);
+                rawOut[2 * i + 1] = magnitude * std::sin(angle);
+            }
+        });
+    compare(
+        "vector3d_cross",
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) {
+                const units::Vector3D<Number> u {Number(a[i]), Number(b[i]), Number(c[i])};
+                vector3Out[i] = u.cross(units::Vector3D<Length>(lc[i], la[i], lb[i]));
+            }
+        },
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) {
+                rawOut[3 * i] = b[i] * b[i] - c[i] * a[i];
+                rawOut[3 * i + 1] = c[i] * c[i] - a[i] * b[i];
+                rawOut[3 * i + 2] = a[i] * a[i] - b[i] * c[i];
+            }
+        });
+    // the units version calculates the sine and cosine of the pose for every point, unless the compiler hoists them
+    // out of the loop, while the span version calculates them once like the raw version
+    const units::Pose pose(1_m, -0.5_m, 30_stDeg);
+    compare(
+        "pose_transform",
+        [&] {
+            for (size_t i = 0; i < SIZE; i++) vectorOut[i] = pose.transform(units::V2Position(la[i], lb[i]));
+        },
+        [&] {
+            const double theta = 30 * M_PI / 180;
+            const double cosTheta = std::cos(theta), sinTheta = std::sin(theta);
+            for (size_t i = 0; i < SIZE; i++) {
+                rawOut[2 * i] = cosTheta * a[i] - sinTheta * b[i] + 1;
+                rawOut[2 * i + 1] = sinTheta * a[i] + cosTheta * b[i] - 0.5;
+            }
+        });
+    compare(
+        "pose_transform_span",
+        [&] { pose.transform(points, vectorOut); },
+        [&] {
+            const double theta = 30 * M_PI / 180;
+            const double cosTheta = std::cos(theta), sinTheta = std::sin(theta);
+            for (size_t i = 0; i < SIZE; i++) {
+                rawOut[2 * i] = cosTheta * a[i] - sinTheta * b[i] + 1;
+                rawOut[2 * i + 1] = sinTheta * a[i] + cosTheta * b[i] - 0.5;
+            }
+        });
+    return 0;
+}
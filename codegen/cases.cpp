@@ -0,0 +1,132 @@
+// expressions which have to compile to the same code with and without units. Every function named units_<name> is
+// compared with the function named raw_<name> by check.sh, which fails if their assembly is different. Quantities are
+// passed and returned like plain doubles, so both functions of a pair have the same calling convention
+#include "units/Angle.hpp"
+#include "units/FloatQuantity.hpp"
+#include "units/Matrix.hpp"
+#include "units/Vector2D.hpp"
+
+// with C linkage, the assembly labels are the function names
+extern "C" {
+// arithmetic between quantities
+Angle units_angle_times_number(Angle angle, Number factor) { return angle * factor; }
+
+double raw_angle_times_number(double angle, double factor) { return angle * factor; }
+
+LinearVelocity units_length_over_time(Length length, Time time) { return length / time; }
+
+double raw_length_over_time(double length, double time) { return length / time; }
+
+Length units_add(Length a, Length b) { return a + b; }
+
+double raw_add(double a, double b) { return a + b; }
+
+Length units_compound(Length a, Length b) {
+    a += b;
+    a *= 2;
+    return a;
+}
+
+double raw_compound(double a, double b) {
+    a += b;
+    a *= 2;
+    return a;
+}
+
+bool units_compare(Length a, Length b) { return a < b; }
+
+bool raw_compare(double a, double b) { return a < b; }
+
+// conversions
+double units_to_degrees(Angle angle) { return to_stDeg(angle); }
+
+double raw_to_degrees(double angle) { return angle / (M_PI / 180); }
+
+Angle units_from_centidegrees(int raw) { return from_stDeg(raw / 100.0); }
+
+double raw_from_centidegrees(int raw) { return raw / 100.0 * (M_PI / 180); }
+
+Angle units_ticks_to_angle(int ticks, AngularVelocity outputVelocity) {
+    return from_stRot(ticks / 50.0) * (outputVelocity / 3600_rpm);
+}
+
+double raw_ticks_to_angle(int ticks, double outputVelocity) {
+    return ticks / 50.0 * M_TWOPI * (outputVelocity / (3600 * (M_TWOPI / 60)));
+}
+
+Angle units_scale(int raw) {
+    constexpr units::Scale CENTIDEGREES(deg / 100);
+    return CENTIDEGREES(raw);
+}
+
+double raw_scale(int raw) { return raw * (M_PI / 180 / 100); }
+
+// how Motor::getAngle converts ticks, with the scale cached by setOutputVelocity
+Angle units_motor_angle(int ticks, units::Scale<Angle> scale, Angle offset) { return scale(ticks) + offset; }
+
+double raw_motor_angle(int ticks, double factor, double offset) { return ticks * factor + offset; }
+
+Length units_unit_cast(Angle angle) { return unit_cast<Length>(angle); }
+
+double raw_unit_cast(double angle) { return angle; }
+
+// functions
+Length units_magnitude(Length x, Length y) { return units::V2Position(x, y).magnitude(); }
+
+double raw_magnitude(double x, double y) { return std::sqrt(x * x + y * y); }
+
+Length units_distance(Length ax, Length ay, Length bx, Length by) {
+    return units::V2Position(ax, ay).distanceTo(units::V2Position(bx, by));
+}
+
+double raw_distance(double ax, double ay, double bx, double by) {
+    return std::sqrt((ax - bx) * (ax - bx) + (ay - by) * (ay - by));
+}
+
+Length units_abs(Length length) { return units::abs(length); }
+
+double raw_abs(double length) { return std::abs(length); }
+
+// math on constants is evaluated at compile time, into a single constant
+Length units_constant_hypot() {
+    constexpr Length distance = units::V2Position(0.3_m, 0.4_m).magnitude() + units::round(2.4_m, 1_m);
+    return distance;
+}
+
+double raw_constant_hypot() { return 2.5; }
+
+// the shortest angle between two headings
+Angle units_angle_error(Angle target, Angle current) { return units::angleError(target, current); }
+
+double raw_angle_error(double target, double current) {
+    const double difference = target - current;
+    const double rotations = (difference * (1 / M_TWOPI) + 0x1.8p52) - 0x1.8p52;
+    return difference - rotations * M_TWOPI;
+}
+
+// float quantities
+fLength units_float_add(fLength a, fLength b) { return a + b; }
+
+float raw_float_add(float a, float b) { return a + b; }
+
+fLinearVelocity units_float_divide(fLength length, fTime time) { return length / time; }
+
+float raw_float_divide(float length, float time) { return length / time; }
+
+// matrices
+void units_matrix_multiply(const units::Matrix<Length, 2, 2>* a, const units::ColumnVector<Number, 2>* b,
+                           units::ColumnVector<Length, 2>* out) {
+    *out = *a * *b;
+}
+
+void raw_matrix_multiply(const double* a, const double* b, double* out) {
+    double result[2];
+    for (int row = 0; row < 2; row++) {
+        double sum = 0;
+        for (int i = 0; i < 2; i++) sum += a[row * 2 + i] * b[i];
+        result[row] = sum;
+    }
+    out[0] = result[0];
+    out[1] = result[1];
+}
+}
@@ -0,0 +1,100 @@
+#!/bin/sh
+# compares the assembly of every units_<name> function in an assembly file with the raw_<name> function, and fails if
+# any pair is different. Label numbers are ignored, and constants are compared by value instead of by label. The
+# instructions are compared as a sorted list, so a pair only fails if the units version has different or more
+# instructions, not if the compiler scheduled the same instructions in a different order
+if [ $# -ne 1 ]; then
+    echo "usage: $0 <assembly file>" >&2
+    exit 2
+fi
+
+awk '
+# the data directives which make up constants. Every other directive is ignored
+function isData(line) { return line ~ /^\.(word|long|quad|4byte|8byte|short|hword|value|byte|double|float|single)[ \t]/ }
+
+# sort the lines of a function body, with an insertion sort as function bodies are short
+function sorted(text,    n, i, j, items, item, result) {
+    n = split(text, items, "\n")
+    for (i = 2; i <= n; i++) {
+        item = items[i]
+        for (j = i - 1; j >= 1 && items[j] > item; j--) items[j + 1] = items[j]
+        items[j + 1] = item
+    }
+    result = ""
+    for (i = 1; i <= n; i++) if (items[i] != "") result = result items[i] "\n"
+    return result
+}
+
+function normalize(line) {
+    for (label in constants) gsub(label "([^0-9]|$)", "<" constants[label] ">&", line)
+    gsub(/\.L[A-Za-z]*[0-9]+/, ".L", line)
+    return line
+}
+
+{
+    line = $0
+    sub(/[ \t]*[@#;].*$/, "", line)
+    gsub(/^[ \t]+|[ \t]+$/, "", line)
+    gsub(/[ \t]+/, " ", line)
+    if (line == "") next
+    lines[++count] = line
+}
+
+END {
+    # find the values of local constants
+    for (i = 1; i <= count; i++) {
+        if (lines[i] !~ /^\.L[A-Za-z]*[0-9]+:$/) continue
+        label = substr(lines[i], 1, length(lines[i]) - 1)
+        value = ""
+        for (j = i + 1; j <= count && isData(lines[j]); j++) value = value " " lines[j]
+        if (value != "") constants[label] = value
+    }
+    # collect the body of every function
+    current = ""
+    for (i = 1; i <= count; i++) {
+        line = lines[i]
+        if (line ~ /^(units|raw)_[A-Za-z0-9_]*:$/) {
+            current = substr(line, 1, length(line) - 1)
+            names[current] = 1
+            continue
+        }
+        if (current == "") continue
+        if (line ~ /^\.size/ || line ~ /^\.fnend/ || line ~ /^\.cfi_endproc/) {
+            current = ""
+            continue
+        }
+        # labels of other functions end the current one
+        if (line ~ /^[A-Za-z_][A-Za-z0-9_.$]*:$/) {
+            current = ""
+            continue
+        }
+        if (line ~ /^\./ && line !~ /^\.L[A-Za-z]*[0-9]+:$/ && !isData(line)) continue
+        body[current] = body[current] normalize(line) "\n"
+    }
+    failed = 0
+    checked = 0
+    for (name in names) {
+        if (name !~ /^units_/) continue
+        raw = "raw_" substr(name, 7)
+        if (!(raw in names)) {
+            printf "FAIL %s: no %s to compare with\n", name, raw
+            failed++
+            continue
+        }
+        checked++
+        if (sorted(body[name]) == sorted(body[raw])) {
+            printf "ok   %s\n", substr(name, 7)
+        } else {
+            printf "FAIL %s: the assembly is different\n--- %s\n%s--- %s\n%s", substr(name, 7), name, body[name], raw,
+                   body[raw]
+            failed++
+        }
+    }
+    if (checked == 0) {
+        print "FAIL no functions found"
+        exit 1
+    }
+    printf "%d of %d expressions compile to the same code as raw doubles\n", checked - failed, checked
+    exit failed != 0
+}
+' "$1"
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "hardware/DeviceRegistry.hpp"
+#include "hardware/Port.hpp"
+#include "pros/adi.hpp"
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief An ADI sensor which reads as either active or inactive, like a limit switch or a line tracker over a line
+ *
+ * Inputs can be read directly, but polling them from a user task adds up to the delay of its loop in latency. An
+ * ADIInputSampler reads them every millisecond instead, timestamps every edge, and wakes tasks waiting for one.
+ */
+class ADIInput {
+    public:
+        virtual ~ADIInput() = default;
+        /**
+         * @brief Read whether the input is active
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port could not be read, like when its ADI expander is unplugged
+         *
+         * @return 1 if the input is active
+         * @return 0 if the input is inactive
+         * @return INT_MAX if there is an error, setting errno
+         */
+        virtual int32_t read() const = 0;
+        /**
+         * @brief Get the smart port the input is read through
+         *
+         * @return uint8_t the port of the ADI expander, or DeviceRegistry::BRAIN_ADI_PORT
+         */
+        uint8_t getExpanderPort() const { return m_expanderPort; }
+    protected:
+        /**
+         * @brief Construct a new ADI Input, and claim its port
+         *
+         * @param expanderPort the port of the ADI expander, or DeviceRegistry::BRAIN_ADI_PORT
+         * @param port the ADI port
+         */
+        ADIInput(uint8_t expanderPort, ADIPort port)
+            : m_expanderPort(expanderPort),
+              m_claim(expanderPort, port) {}
+
+        uint8_t m_expanderPort;
+        PortClaim m_claim;
+};
+
+/**
+ * @brief A digital ADI sensor, like a limit switch or a bumper, which is active while it is pressed
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::ADIDigitalInput limitSwitch('A');
+ *
+ * void opcontrol() {
+ *     if (limitSwitch.read() == 1) std::cout << "pressed" << std::endl;
+ * }
+ * @endcode
+ */
+class ADIDigitalInput final : public ADIInput {
+    public:
+        /**
+         * @brief Construct a new ADI Digital Input on the brain
+         *
+         * @param port the ADI port (1-8, 'a'-'h', 'A'-'H')
+         */
+        ADIDigitalInput(ADIPort port);
+        /**
+         * @brief Construct a new ADI Digital Input on an ADI expander
+         *
+         * @param expanderPort the port of the ADI expander
+         * @param port the ADI port (1-8, 'a'-'h', 'A'-'H')
+         */
+        ADIDigitalInput(SmartPort expanderPort, ADIPort port);
+        /**
+         * @brief Read whether the sensor is pressed
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port could not be read
+         *
+         * @return 1 if the sensor is pressed
+         * @return 0 if it is released
+         * @return INT_MAX if there is an error, setting errno
+         */
+        int32_t read() const override;
+    private:
+        pros::adi::DigitalIn m_input;
+};
+
+/**
+ * @brief A line tracker, which is active while it is over a line
+ *
+ * Line trackers measure how much light is reflected back, and read lower over lighter surfaces. The tracker is active
+ * while its reading is below the threshold, so it detects a white line on grey tiles.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::ADILineTracker lineTracker('B', 2000);
+ *
+ * void opcontrol() {
+ *     if (lineTracker.read() == 1) std::cout << "on the line" << std::endl;
+ * }
+ * @endcode
+ */
+class ADILineTracker final : public ADIInput {
+    public:
+        /**
+         * @brief Construct a new ADI Line Tracker on the brain
+         *
+         * @param port the ADI port (1-8, 'a'-'h', 'A'-'H')
+         * @param threshold the reading, from 0 to 4095, below which the tracker is over a line
+         */
+        ADILineTracker(ADIPort port, int32_t threshold);
+        /**
+         * @brief Construct a new ADI Line Tracker on an ADI expander
+         *
+         * @param expanderPort the port of the ADI expander
+         * @param port the ADI port (1-8, 'a'-'h', 'A'-'H')
+         * @param threshold the reading, from 0 to 4095, below which the tracker is over a line
+         */
+        ADILineTracker(SmartPort expanderPort, ADIPort port, int32_t threshold);
+        /**
+         * @brief Read whether the tracker is over a line
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port could not be read
+         *
+         * @return 1 if the reading is below the threshold
+         * @return 0 if it is not
+         * @return INT_MAX if there is an error, setting errno
+         */
+        int32_t read() const override;
+        /**
+         * @brief Get the raw reading of the tracker
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port could not be read
+         *
+         * @return int32_t the reading, from 0 to 4095
+         * @return INT_MAX if there is an error, setting errno
+         */
+        int32_t getValue() const;
+    private:
+        pros::adi::LineSensor m_input;
+        int32_t m_threshold;
+};
+} // namespace lemlib
@@ -0,0 +1,222 @@
+#pragma once
+
+#include "hardware/ADI/ADIInput.hpp"
+#include "hardware/DoubleBuffer.hpp"
+#include "units/core.hpp"
+#include "pros/rtos.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief The kinds of edges a task can wait for. A rising edge is an input becoming active
+ */
+enum class EdgeKind { RISING, FALLING, ANY };
+
+/**
+ * @brief A change of an ADI input, detected by an ADIInputSampler
+ */
+struct InputEdge {
+        /** the time the sampler read the new level, measured since the program started. INFINITY if there is none */
+        Time timestamp = from_sec(INFINITY);
+        /** whether the input became active */
+        bool rising = false;
+        /** the number of edges of the input so far, including this one */
+        uint32_t count = 0;
+};
+
+/**
+ * @brief ADIInputSampler class
+ *
+ * The ADI has no interrupts the program can use, so a limit switch polled from a user task is only noticed on the
+ * next iteration of its loop. The sampler reads registered inputs every millisecond, from a task with a higher
+ * priority than user code, and timestamps every edge as it is detected. Tasks which wait for an edge sleep on a task
+ * notification, and the sampler wakes them as soon as the edge is detected, instead of them polling the input.
+ *
+ * Like the DevicePoller, the sampler has a fixed capacity, so it never allocates memory after construction. Inputs
+ * must outlive the sampler.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::ADIDigitalInput limitSwitch('A');
+ * lemlib::ADIInputSampler sampler;
+ *
+ * void autonomous() {
+ *     const int32_t index = sampler.addInput(limitSwitch);
+ *     sampler.start();
+ *     intake.move(1);
+ *     // wait for up to 2 seconds for a ball to press the switch
+ *     const lemlib::InputEdge edge = sampler.waitForEdge(index, lemlib::EdgeKind::RISING, 2_sec);
+ *     intake.brake();
+ * }
+ * @endcode
+ */
+class ADIInputSampler {
+    public:
+        /** the maximum number of inputs a sampler can read */
+        static constexpr size_t MAX_INPUTS = 16;
+        /** the maximum number of tasks which can wait for an edge at once */
+        static constexpr size_t MAX_WAITERS = 8;
+        /**
+         * @brief Construct a new ADI Input Sampler
+         *
+         * The sampler does not read anything until start is called
+         *
+         * @param period how often inputs are read. Defaults to 1 ms, which is the shortest delay a task can have
+         */
+        ADIInputSampler(Time period = 1_msec);
+        ADIInputSampler(const ADIInputSampler& other) = delete;
+        ADIInputSampler& operator=(const ADIInputSampler& other) = delete;
+        /**
+         * @brief Destroy the ADI Input Sampler, stopping its task
+         */
+        ~ADIInputSampler();
+        /**
+         * @brief Register an input to be read
+         *
+         * Inputs can be registered while the sampler is running. The first read only sets the level, so an input
+         * which is already active when it is registered doesn't report an edge.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOMEM: the sampler is already reading MAX_INPUTS inputs
+         *
+         * @param input the input to read. It must outlive the sampler
+         * @return int32_t the index of the input, which is passed to getLevel, getLastEdge and waitForEdge
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t addInput(ADIInput& input);
+        /**
+         * @brief Get the level of an input when it was last read
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the index does not belong to a registered input
+         * ENODEV: the input could not be read, or has not been read yet
+         *
+         * @param index the index returned by addInput
+         * @return 1 if the input is active
+         * @return 0 if it is inactive
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t getLevel(int32_t index) const;
+        /**
+         * @brief Get the latest edge of an input
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the index does not belong to a registered input
+         *
+         * @param index the index returned by addInput
+         * @return InputEdge the edge. The timestamp is INFINITY if the index is invalid, or if the input has not
+         * changed yet
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     const lemlib::InputEdge edge = sampler.getLastEdge(index);
+         *     if (edge.count != lastCount) std::cout << "pressed at " << to_msec(edge.timestamp) << std::endl;
+         * }
+         * @endcode
+         */
+        InputEdge getLastEdge(int32_t index) const;
+        /**
+         * @brief Block the calling task until an input changes
+         *
+         * Only edges detected after the call count. The task sleeps on a task notification, so it uses no CPU while
+         * it waits, and is woken by the sampler task right after the edge is read. This function must not be called
+         * from the sampler task.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the index does not belong to a registered input
+         * EBUSY: MAX_WAITERS tasks are already waiting
+         * ETIMEDOUT: no edge was detected before the timeout
+         *
+         * @param index the index returned by addInput
+         * @param kind the kind of edge to wait for. Defaults to either
+         * @param timeout how long to wait for. Defaults to forever
+         * @return InputEdge the edge which woke the task. The timestamp is INFINITY on failure, setting errno
+         */
+        InputEdge waitForEdge(int32_t index, EdgeKind kind = EdgeKind::ANY, Time timeout = from_sec(INFINITY));
+        /**
+         * @brief Read every registered input once, and wake the tasks waiting for the edges
+         *
+         * This is called periodically by the sampler task, but can also be called manually if the sampler is not
+         * started. It must not be called from more than one task at once.
+         */
+        void update();
+        /**
+         * @brief Start the sampler task
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EBUSY: the sampler is already running
+         * ENOMEM: the task could not be created
+         *
+         * @param priority the priority of the sampler task. Defaults to one below the maximum, so an edge is read as
+         * soon as the task is due, even while user tasks are busy
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t start(uint32_t priority = TASK_PRIORITY_MAX - 1);
+        /**
+         * @brief Stop the sampler task
+         *
+         * This function blocks until the current update finishes. Tasks which are waiting for an edge keep waiting
+         * until their timeout.
+         */
+        void stop();
+    private:
+        /**
+         * @brief the function run by the sampler task
+         *
+         * @param sampler pointer to the sampler
+         */
+        static void taskFunction(void* sampler);
+        /**
+         * @brief Wake the tasks waiting for an edge of an input
+         *
+         * @param index the index of the input
+         * @param edge the edge
+         */
+        void notifyWaiters(size_t index, const InputEdge& edge);
+
+        struct InputEntry {
+                ADIInput* input = nullptr;
+                // INT_MAX until the input is read successfully, so the first reading isn't an edge
+                std::atomic<int32_t> level = INT_MAX;
+                DoubleBuffer<InputEdge> edge;
+        };
+
+        struct Waiter {
+                // nullptr if the slot is free
+                pros::task_t task = nullptr;
+                size_t index = 0;
+                EdgeKind kind = EdgeKind::ANY;
+                // set by the sampler task before it notifies the waiting task
+                bool woken = false;
+                InputEdge edge;
+        };
+
+        Time m_period;
+        // registering inputs is locked, so two tasks can't claim the same entry. Reading inputs never locks
+        pros::Mutex m_mutex;
+        std::array<InputEntry, MAX_INPUTS> m_inputs;
+        // entries are filled in before the count is incremented, so the sampler task only sees complete entries
+        std::atomic<size_t> m_inputCount = 0;
+        // protects the waiters. The sampler task only locks it when an input changed while a task is waiting
+        pros::Mutex m_waiterMutex;
+        std::array<Waiter, MAX_WAITERS> m_waiters;
+        std::atomic<size_t> m_waiterCount = 0;
+        // the task is not deleted from outside, as it could be holding the waiter mutex. Instead it is asked to exit
+        std::atomic<bool> m_running = false;
+        std::atomic<bool> m_taskExited = true;
+};
+} // namespace lemlib
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "pros/rtos.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace lemlib {
+/**
+ * @brief Heap allocations made through operator new
+ */
+struct AllocationStats {
+        /** the number of allocations */
+        uint32_t allocations = 0;
+        /** the number of frees */
+        uint32_t frees = 0;
+        /** the total number of bytes allocated */
+        uint64_t bytes = 0;
+};
+
+/**
+ * @brief Called when memory is allocated inside an allocation-free scope
+ *
+ * @param scope the name of the innermost allocation-free scope
+ * @param size the size of the allocation, in bytes
+ */
+using AllocationFailureHandler = void (*)(const char* scope, size_t size);
+
+/**
+ * @brief Whether allocations are being tracked
+ *
+ * Tracking is only compiled in when LEMLIB_TRACK_ALLOCATIONS is defined, which `make TRACK_ALLOCATIONS=1` does. It
+ * replaces the global operator new and operator delete, so every allocation made through them is counted, for the
+ * task which made it. Allocations made by calling malloc directly, like inside PROS, are not counted.
+ *
+ * @return true allocations are being tracked
+ * @return false tracking was not compiled in, so every statistic is 0
+ */
+bool isTrackingAllocations();
+/**
+ * @brief Get the allocations made by every task
+ *
+ * @return AllocationStats the allocations
+ */
+AllocationStats getAllocationStats();
+/**
+ * @brief Get the allocations made by a task
+ *
+ * Only the first 32 tasks which allocate are tracked on their own. Allocations of every other task are only counted by
+ * getAllocationStats.
+ *
+ * @param task the task. Defaults to the calling task
+ * @return AllocationStats the allocations
+ */
+AllocationStats getTaskAllocationStats(pros::task_t task = pros::c::task_get_current());
+/**
+ * @brief Write the allocations of every tracked task as csv, with a header line naming the columns
+ *
+ * @param file the file to write to. Defaults to stdout, which is sent over the serial port
+ * @return int32_t always returns 0
+ */
+int32_t dumpAllocations(FILE* file = stdout);
+/**
+ * @brief Set the function called when memory is allocated inside an allocation-free scope
+ *
+ * The default handler prints the name of the scope and the size of the allocation to stderr, and aborts. The handler
+ * is called from inside operator new, so it must not allocate memory itself.
+ *
+ * @param handler the handler
+ */
+void setAllocationFailureHandler(AllocationFailureHandler handler);
+
+/**
+ * @brief Asserts that the calling task does not allocate memory until the scope ends
+ *
+ * Wrapped around a hot path, like a control loop, this proves it never allocates, and keeps it that way. Every
+ * allocation the task makes while the scope is alive calls the allocation failure handler, from inside operator new,
+ * so a debugger stops exactly where the allocation happened. Scopes can be nested.
+ *
+ * Use LEMLIB_ALLOCATION_FREE instead of creating these directly, so scopes compile away when tracking is disabled.
+ */
+class AllocationFreeScope {
+    public:
+        /**
+         * @brief Start the scope
+         *
+         * @param name the name of the scope. It must outlive the scope, like a string literal
+         */
+        AllocationFreeScope(const char* name);
+        AllocationFreeScope(const AllocationFreeScope& other) = delete;
+        AllocationFreeScope& operator=(const AllocationFreeScope& other) = delete;
+        /**
+         * @brief End the scope, restoring the scope it was nested in
+         */
+        ~AllocationFreeScope();
+    private:
+        const char* m_previous;
+};
+} // namespace lemlib
+
+#define LEMLIB_ALLOCATION_FREE_CONCAT_(a, b) a##b
+#define LEMLIB_ALLOCATION_FREE_CONCAT(a, b) LEMLIB_ALLOCATION_FREE_CONCAT_(a, b)
+
+/**
+ * @brief Assert that the rest of the enclosing scope does not allocate memory
+ *
+ * Scopes are only compiled in when LEMLIB_TRACK_ALLOCATIONS is defined, which `make TRACK_ALLOCATIONS=1` does.
+ * Otherwise this expands to nothing.
+ *
+ * @param name the name of the scope, as a string literal
+ */
+#ifdef LEMLIB_TRACK_ALLOCATIONS
+#define LEMLIB_ALLOCATION_FREE(name)                                                                                   \
+    const ::lemlib::AllocationFreeScope LEMLIB_ALLOCATION_FREE_CONCAT(lemlibAllocationFree, __LINE__)(name)
+#else
+#define LEMLIB_ALLOCATION_FREE(name) static_cast<void>(0)
+#endif
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "units/core.hpp"
+#include "units/Electrical.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief Battery class
+ *
+ * The voltage of the battery is shared by every motor, so it doesn't make sense for every motor to read it from the
+ * SDK. The Battery keeps the latest reading, which is taken at most once per update period, by whichever task asks for
+ * the voltage first once the reading is out of date. Reading the voltage is otherwise an atomic load.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * void opcontrol() {
+ *     while (true) {
+ *         std::cout << "Battery: " << to_volt(lemlib::Battery::get().getVoltage()) << std::endl;
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class Battery {
+    public:
+        Battery(const Battery& other) = delete;
+        Battery& operator=(const Battery& other) = delete;
+        /**
+         * @brief Get the battery
+         *
+         * The battery is constructed the first time this function is called, so it can be used by devices which are
+         * globals
+         *
+         * @return Battery& the battery
+         */
+        static Battery& get();
+        /**
+         * @brief Get the voltage of the battery
+         *
+         * The voltage is read again if the latest reading is older than the update period.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EACCES: another resource is currently trying to access the battery port
+         *
+         * @return Voltage the voltage of the battery
+         * @return INFINITY on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     const Voltage voltage = lemlib::Battery::get().getVoltage();
+         *     if (voltage.internal() == INFINITY) std::cout << "Could not read the battery" << std::endl;
+         *     else if (voltage < 12_volt) std::cout << "Charge the battery!" << std::endl;
+         * }
+         * @endcode
+         */
+        Voltage getVoltage();
+        /**
+         * @brief Read the voltage of the battery now
+         *
+         * This is called by getVoltage when the latest reading is out of date. If another task is already reading the
+         * battery, this returns straight away, and the reading of the other task is used.
+         */
+        void update();
+        /**
+         * @brief Set how long a reading of the battery is used for before it is read again
+         *
+         * @param period the period, rounded to whole milliseconds. Defaults to 10 ms, which is how often the battery
+         * voltage updates
+         * @return int32_t always returns 0
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     // the battery changes slowly, so it only needs to be read every 50 ms
+         *     lemlib::Battery::get().setUpdatePeriod(50_msec);
+         * }
+         * @endcode
+         */
+        int32_t setUpdatePeriod(Time period);
+        /**
+         * @brief Get how long a reading of the battery is used for before it is read again
+         *
+         * @return Time the period
+         */
+        Time getUpdatePeriod() const;
+    private:
+        Battery() = default;
+
+        // the latest reading, in millivolts. INT32_MAX if it could not be read
+        std::atomic<int32_t> m_millivolts = 0;
+        // when the latest reading was taken, in milliseconds
+        std::atomic<uint32_t> m_updateTime = 0;
+        std::atomic<uint32_t> m_updatePeriod = 10;
+        std::atomic<bool> m_updated = false;
+        std::atomic<bool> m_updating = false;
+};
+} // namespace lemlib
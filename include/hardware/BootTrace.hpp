@@ -0,0 +1,140 @@
+#pragma once
+
+#include "pros/rtos.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// the number of events the boot trace can hold. Events recorded once it is full are dropped and counted
+#ifndef LEMLIB_BOOT_TRACE_SIZE
+#define LEMLIB_BOOT_TRACE_SIZE 256
+#endif
+
+namespace lemlib {
+/**
+ * @brief Start a span of the boot trace, which ends when endBootSpan is called with the index it returns
+ *
+ * Use LEMLIB_BOOT_SPAN instead of calling this directly, so the trace compiles away when it is disabled. Recording
+ * never locks and never allocates, so it can be called from any task, and during static initialization.
+ *
+ * @param name the name of the span. It must outlive the trace, like a string literal
+ * @param port the port the span is about, or 0 if it isn't about a port
+ * @return size_t the index of the span, or SIZE_MAX if the trace is full
+ */
+size_t beginBootSpan(const char* name, uint8_t port);
+/**
+ * @brief End a span of the boot trace
+ *
+ * @param index the index returned by beginBootSpan. SIZE_MAX is ignored
+ */
+void endBootSpan(size_t index);
+/**
+ * @brief Record an instant in the boot trace, like a task being created
+ *
+ * @param name the name of the event. It must outlive the trace, like a string literal
+ * @param port the port the event is about, or 0 if it isn't about a port
+ */
+void recordBootEvent(const char* name, uint8_t port);
+
+/**
+ * @brief Ends a span of the boot trace when the scope ends
+ *
+ * Use LEMLIB_BOOT_SPAN instead of creating these directly, so the trace compiles away when it is disabled.
+ */
+class ScopedBootSpan {
+    public:
+        /**
+         * @brief Start the span
+         *
+         * @param name the name of the span, like a string literal
+         * @param port the port the span is about, or 0
+         */
+        ScopedBootSpan(const char* name, uint8_t port)
+            : m_index(beginBootSpan(name, port)) {}
+
+        ScopedBootSpan(const ScopedBootSpan& other) = delete;
+        ScopedBootSpan& operator=(const ScopedBootSpan& other) = delete;
+
+        ~ScopedBootSpan() { endBootSpan(m_index); }
+    private:
+        const size_t m_index;
+};
+
+/**
+ * @brief Write the boot trace as json, in the Chrome trace event format
+ *
+ * The trace opens in Perfetto (ui.perfetto.dev) or chrome://tracing, with a track for every task which recorded an
+ * event. Timestamps are in microseconds since the brain started the program. Spans which haven't ended yet are
+ * written as if they ended now.
+ *
+ * @param file the file to write to. Defaults to stdout, which is sent over the serial port
+ * @return int32_t always returns 0
+ *
+ * @b Example:
+ * @code {.cpp}
+ * void initialize() {
+ *     lemlib::calibrateIMUs({&imu}).wait();
+ *     LEMLIB_BOOT_EVENT("ready", 0);
+ *     lemlib::dumpBootTrace();
+ * }
+ * @endcode
+ */
+int32_t dumpBootTrace(FILE* file = stdout);
+/**
+ * @brief Write the boot trace as json to a file, like on the SD card
+ *
+ * This function uses the following values of errno when an error state is reached:
+ *
+ * any errno set by fopen, like ENXIO when there is no SD card
+ *
+ * @param path the path of the file. It is overwritten
+ * @return int32_t 0 on success
+ * @return INT_MAX on failure, setting errno
+ *
+ * @b Example:
+ * @code {.cpp}
+ * void initialize() {
+ *     lemlib::calibrateIMUs({&imu}).wait();
+ *     lemlib::dumpBootTrace("/usd/boot.json");
+ * }
+ * @endcode
+ */
+int32_t dumpBootTrace(const char* path);
+/**
+ * @brief Get the number of events which were dropped, because the trace was full
+ *
+ * @return size_t the number of events
+ */
+size_t getDroppedBootEvents();
+} // namespace lemlib
+
+#define LEMLIB_BOOT_CONCAT_(a, b) a##b
+#define LEMLIB_BOOT_CONCAT(a, b) LEMLIB_BOOT_CONCAT_(a, b)
+
+/**
+ * @brief Record the rest of the enclosing scope as a span of the boot trace
+ *
+ * The trace is only compiled in when LEMLIB_BOOT_TRACE is defined, which `make BOOT_TRACE=1` does. Otherwise this
+ * expands to nothing, so the trace costs nothing when it is disabled.
+ *
+ * @param name the name of the span, as a string literal
+ * @param port the port the span is about, or 0
+ */
+#ifdef LEMLIB_BOOT_TRACE
+#define LEMLIB_BOOT_SPAN(name, port)                                                                                   \
+    const ::lemlib::ScopedBootSpan LEMLIB_BOOT_CONCAT(lemlibBootSpan, __LINE__)(name, port)
+#else
+#define LEMLIB_BOOT_SPAN(name, port) static_cast<void>(0)
+#endif
+
+/**
+ * @brief Record an instant in the boot trace, which is compiled in like LEMLIB_BOOT_SPAN
+ *
+ * @param name the name of the event, as a string literal
+ * @param port the port the event is about, or 0
+ */
+#ifdef LEMLIB_BOOT_TRACE
+#define LEMLIB_BOOT_EVENT(name, port) ::lemlib::recordBootEvent(name, port)
+#else
+#define LEMLIB_BOOT_EVENT(name, port) static_cast<void>(0)
+#endif
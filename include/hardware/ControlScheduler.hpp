@@ -0,0 +1,370 @@
+#pragma once
+
+#include "hardware/DoubleBuffer.hpp"
+#include "hardware/TaskManager.hpp"
+#include "units/Statistics.hpp"
+#include "units/core.hpp"
+#include "pros/rtos.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+
+namespace lemlib {
+class TelemetryLogger;
+
+/**
+ * @brief How important it is for a callback of a ControlScheduler to run on time
+ */
+enum class CallbackPriority {
+    /** the callback always runs at its period, even when the scheduler is degraded */
+    CRITICAL,
+    /** the default. The callback is slowed down once the scheduler is badly degraded */
+    NORMAL,
+    /** the callback is slowed down, then dropped, first */
+    BACKGROUND
+};
+
+/**
+ * @brief How a degraded ControlScheduler runs the callbacks which aren't critical
+ *
+ * A callback only runs on one of every divider of its periods. A divider of 0 drops the callback.
+ */
+struct DegradationStep {
+        /** the divider of normal priority callbacks */
+        uint32_t normalDivider = 1;
+        /** the divider of background callbacks */
+        uint32_t backgroundDivider = 1;
+};
+
+/**
+ * @brief What a ControlScheduler does when its ticks overrun
+ */
+struct OverrunPolicy {
+        /** the most steps a policy can have */
+        static constexpr size_t MAX_STEPS = 4;
+
+        /** whether the watchdog is enabled. It is disabled by default, so every callback always runs */
+        bool enabled = false;
+        /** how many ticks in a row have to run late before the scheduler degrades by a step */
+        uint32_t overrunLimit = 3;
+        /** how many ticks in a row have to run on time before the scheduler recovers by a step */
+        uint32_t recoveryTicks = 1000;
+        /**
+         * the steps, from the mildest to the most severe. By default, background callbacks like telemetry run at a
+         * quarter of their rate, then are dropped, then normal priority callbacks like odometry run at half their rate
+         */
+        std::array<DegradationStep, MAX_STEPS> steps {DegradationStep {.normalDivider = 1, .backgroundDivider = 4},
+                                                      DegradationStep {.normalDivider = 1, .backgroundDivider = 0},
+                                                      DegradationStep {.normalDivider = 2, .backgroundDivider = 0}};
+        /** how many of the steps are used */
+        uint32_t stepCount = 3;
+        /**
+         * a logger which every change of the degradation level is pushed to, or nullptr. Records are pushed from the
+         * scheduler task, so only callbacks of the scheduler may push to the same logger
+         */
+        TelemetryLogger* logger = nullptr;
+        /** the device of the records pushed to the logger */
+        uint16_t device = 0;
+};
+
+/**
+ * @brief A change of the degradation level of a ControlScheduler
+ */
+struct DegradationEvent {
+        /** when the level changed, measured since the program started */
+        Time time = 0_sec;
+        /** the new level. 0 runs every callback at its period, and level i uses step i - 1 of the policy */
+        uint32_t level = 0;
+        /** the number of late ticks since the scheduler was constructed */
+        uint32_t lateTicks = 0;
+};
+
+/**
+ * @brief The timing of a callback run by a ControlScheduler, measured with pros::micros
+ */
+struct CallbackTiming {
+        /** the period of the callback, rounded to a whole number of ticks */
+        Time period = 0_sec;
+        /** the tick the callback runs on, out of the number of ticks in its period */
+        uint32_t phase = 0;
+        /** how long the latest run took */
+        Time lastExecution = 0_sec;
+        /** how long the slowest run took */
+        Time maxExecution = 0_sec;
+        /** how long the runs took on average */
+        Time meanExecution = 0_sec;
+        /** the standard deviation of how long the runs took, which is how much the callback jitters the tick */
+        Time executionStdDev = 0_sec;
+        /** an estimate of the time 99% of runs finish within, which is less sensitive to one slow run than the max */
+        Time p99Execution = 0_sec;
+        /** the number of times the callback has run */
+        uint32_t runs = 0;
+        /** the number of runs which took longer than a tick, delaying everything after them */
+        uint32_t overruns = 0;
+};
+
+/**
+ * @brief ControlScheduler class
+ *
+ * Loops timed with pros::delay drift, as the time the loop takes is added to every period. The ControlScheduler runs
+ * registered callbacks at exact periods from a single task, which wakes up once per tick with task_delay_until.
+ *
+ * Every callback runs at a period which is a whole number of ticks. Callbacks with the same period form a rate group,
+ * like 200 Hz, 100 Hz and 20 Hz groups. When a callback is added, it is given the phase with the least work already
+ * scheduled on it, so slower callbacks are staggered between the faster ones instead of all running on the same tick.
+ *
+ * The scheduler has a fixed capacity. Callbacks are called from the scheduler task. Critical callbacks run first on
+ * every tick, and then the rest, each in the order they were added.
+ *
+ * An optional watchdog degrades the scheduler when several ticks in a row run late. Each level of degradation slows
+ * down or drops the callbacks which aren't critical, as set by its OverrunPolicy. Once the ticks have run on time for
+ * a while, the scheduler recovers one level at a time. Every change of level is recorded, and can be pushed to a
+ * TelemetryLogger.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::ControlScheduler scheduler(5_msec);
+ *
+ * void initialize() {
+ *     scheduler.add([] { odom.update(); }, 5_msec);
+ *     scheduler.add([] { controller.update(); }, 10_msec);
+ *     scheduler.add([] { logTelemetry(); }, 50_msec);
+ *     scheduler.start();
+ * }
+ * @endcode
+ */
+class ControlScheduler {
+    public:
+        /** the maximum number of callbacks a scheduler can run */
+        static constexpr size_t MAX_CALLBACKS = 16;
+        /** the number of changes of the degradation level which are kept */
+        static constexpr size_t MAX_EVENTS = 8;
+        /**
+         * @brief Construct a new Control Scheduler
+         *
+         * The scheduler does not run anything until start is called
+         *
+         * @param tick the shortest period a callback can have, rounded to whole milliseconds. Every period is a
+         * multiple of it. Defaults to 5 ms, which runs the fastest rate group at 200 Hz
+         */
+        ControlScheduler(Time tick = 5_msec);
+        ControlScheduler(const ControlScheduler& other) = delete;
+        ControlScheduler& operator=(const ControlScheduler& other) = delete;
+        /**
+         * @brief Destroy the Control Scheduler, stopping its task
+         */
+        ~ControlScheduler();
+        /**
+         * @brief Register a callback to run periodically
+         *
+         * Callbacks can be added while the scheduler is running. They start running on their phase, after the
+         * current tick.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOMEM: the scheduler is already running MAX_CALLBACKS callbacks
+         * EINVAL: the callback is empty
+         *
+         * @param callback the function to run
+         * @param period how often to run it. Rounded to the nearest whole number of ticks, and at least one tick
+         * @param priority how important it is for the callback to run on time when the scheduler is degraded.
+         * Defaults to normal
+         * @return int32_t the index of the callback, which is passed to getTiming
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     const int32_t index = scheduler.add([] { odom.update(); }, 10_msec);
+         *     if (index == INT_MAX) std::cout << "Scheduler is full" << std::endl;
+         * }
+         * @endcode
+         */
+        int32_t add(std::function<void()> callback, Time period,
+                    CallbackPriority priority = CallbackPriority::NORMAL);
+        /**
+         * @brief Get the timing of a callback
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the index does not belong to a registered callback
+         *
+         * @param index the index returned by add
+         * @return CallbackTiming the timing. Empty if the index is invalid
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     const lemlib::CallbackTiming timing = scheduler.getTiming(index);
+         *     std::cout << to_usec(timing.maxExecution) << " us, " << timing.overruns << " overruns" << std::endl;
+         * }
+         * @endcode
+         */
+        CallbackTiming getTiming(int32_t index) const;
+        /**
+         * @brief Get the number of ticks which finished after the next tick should have started
+         *
+         * The scheduler catches up on late ticks, so a late tick doesn't delay the ones after it
+         *
+         * @return uint32_t the number of late ticks
+         */
+        uint32_t getLateTicks() const;
+        /**
+         * @brief Set what the scheduler does when its ticks overrun
+         *
+         * The scheduler goes back to running every callback at its period.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the overrun limit or the recovery ticks are 0, or the step count is 0 or more than MAX_STEPS
+         *
+         * @param policy the policy
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * lemlib::TelemetryLogger logger("/usd/log.bin");
+         *
+         * void initialize() {
+         *     scheduler.add([] { chassis.update(); }, 5_msec, lemlib::CallbackPriority::CRITICAL);
+         *     scheduler.add([] { odom.update(); }, 10_msec);
+         *     scheduler.add([] { logTelemetry(); }, 20_msec, lemlib::CallbackPriority::BACKGROUND);
+         *     scheduler.setOverrunPolicy({.enabled = true, .logger = &logger, .device = 100});
+         *     scheduler.start();
+         * }
+         * @endcode
+         */
+        int32_t setOverrunPolicy(OverrunPolicy policy);
+        /**
+         * @brief Get what the scheduler does when its ticks overrun
+         *
+         * @return OverrunPolicy the policy
+         */
+        OverrunPolicy getOverrunPolicy() const;
+        /**
+         * @brief Get how degraded the scheduler is
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * @return uint32_t the level. 0 runs every callback at its period
+         */
+        uint32_t getDegradationLevel() const;
+        /**
+         * @brief Get the latest changes of the degradation level
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * @param buffer the buffer to write to
+         * @return int32_t the number of changes written, oldest first. Only the latest MAX_EVENTS changes are kept
+         */
+        int32_t getDegradationEvents(std::span<DegradationEvent> buffer) const;
+        /**
+         * @brief Run one tick, calling every callback whose phase it is
+         *
+         * This is called once per tick by the scheduler task, but can also be called manually if the scheduler is not
+         * started. It must not be called from more than one task at once.
+         */
+        void update();
+        /**
+         * @brief Start the scheduler task
+         *
+         * The task is created by the TaskManager, with the stack depth and the CPU budget of its role. Callbacks run
+         * in the task, so they share its budget.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EBUSY: the scheduler is already running
+         * ENOMEM: the task could not be created
+         *
+         * @param priority the priority of the scheduler task. Defaults to the priority the TaskManager configures for
+         * TaskRole::CONTROL_SCHEDULER, two above the default priority so control loops run on time
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t start(uint32_t priority = MANAGED_PRIORITY);
+        /**
+         * @brief Stop the scheduler task
+         *
+         * This function blocks until the current tick finishes
+         */
+        void stop();
+    private:
+        /**
+         * @brief the function run by the scheduler task
+         *
+         * @param scheduler pointer to the scheduler
+         */
+        static void taskFunction(void* scheduler);
+        /**
+         * @brief Find the phase with the least work already scheduled on it
+         *
+         * The mutex has to be locked before this function is called
+         *
+         * @param ticks the period of the new callback, in ticks
+         * @return uint32_t the phase
+         */
+        uint32_t findPhase(uint32_t ticks) const;
+        /**
+         * @brief Run the callbacks of one priority whose phase it is
+         *
+         * @param count the number of callbacks to consider
+         * @param tick the tick
+         * @param critical whether to run the critical callbacks, or the others
+         * @param step how the callbacks which aren't critical are slowed down, or nullptr to run them at their period
+         */
+        void runCallbacks(size_t count, uint32_t tick, bool critical, const DegradationStep* step);
+        /**
+         * @brief Feed the watchdog with whether the latest tick ran late, changing the degradation level if needed
+         *
+         * This is only called by the scheduler task
+         *
+         * @param late whether the tick ran late
+         */
+        void watchdog(bool late);
+
+        struct Entry {
+                std::function<void()> callback;
+                uint32_t ticks = 1;
+                uint32_t phase = 0;
+                CallbackPriority priority = CallbackPriority::NORMAL;
+                DoubleBuffer<CallbackTiming> timing;
+                // only touched by the scheduler task, which publishes them into the timing
+                units::RunningStats<Time> execution;
+                units::QuantileEstimator<Time> p99Execution {0.99};
+        };
+
+        struct DegradationLog {
+                std::array<DegradationEvent, MAX_EVENTS> events {};
+                // the total number of changes. The latest one is at index (count - 1) % MAX_EVENTS
+                uint32_t count = 0;
+        };
+
+        const Time m_tick;
+        // registering callbacks is locked, so two tasks can't claim the same entry. Running them never locks
+        pros::Mutex m_mutex;
+        std::array<Entry, MAX_CALLBACKS> m_entries;
+        // entries are filled in before the count is incremented, so the scheduler task only sees complete entries
+        std::atomic<size_t> m_count = 0;
+        // the number of ticks run, which decides which callbacks run next
+        std::atomic<uint32_t> m_tickCount = 0;
+        std::atomic<uint32_t> m_lateTicks = 0;
+        // the policy is written by setOverrunPolicy while holding the mutex, and read by the scheduler task
+        DoubleBuffer<OverrunPolicy> m_policy;
+        std::atomic<uint32_t> m_level = 0;
+        // set by setOverrunPolicy, so the scheduler task starts the watchdog over
+        std::atomic<bool> m_policyChanged = false;
+        // only touched by the scheduler task
+        uint32_t m_consecutiveLate = 0;
+        uint32_t m_consecutiveOnTime = 0;
+        DoubleBuffer<DegradationLog> m_log;
+        // the task is not deleted from outside, as it could be in the middle of a callback. Instead it is asked to exit
+        std::atomic<bool> m_running = false;
+        std::atomic<bool> m_taskExited = true;
+};
+} // namespace lemlib
@@ -0,0 +1,206 @@
+#pragma once
+
+#include "hardware/DoubleBuffer.hpp"
+#include "units/core.hpp"
+#include "pros/misc.h"
+#include "pros/rtos.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace lemlib {
+/**
+ * @brief How the raw position of a stick is turned into an output
+ */
+struct AxisCurve {
+        /** positions this close to the center, out of 127, read as centered, so a worn stick doesn't drift */
+        int32_t deadband = 5;
+        /** how much of the curve is cubic, from 0 for linear to 1 for cubic. Cubic curves give finer control slowly */
+        Number expo = 0;
+        /** the output at full stick */
+        Number scale = 1;
+};
+
+/**
+ * @brief Everything read from a controller in one update
+ */
+struct ControllerSnapshot {
+        /** whether the controller was connected. The axes and buttons of a disconnected controller are all 0 */
+        bool connected = false;
+        /** the axes after their curves, indexed by pros::controller_analog_e_t */
+        std::array<float, 4> axes {};
+        /** the raw axes, from -127 to 127 */
+        std::array<int8_t, 4> raw {};
+        /** the buttons which are held, a bit per button starting from pros::E_CONTROLLER_DIGITAL_L1 */
+        uint16_t buttons = 0;
+        /** the buttons which were pressed since the previous update */
+        uint16_t pressed = 0;
+        /** the buttons which were released since the previous update */
+        uint16_t released = 0;
+        /** when the controller was read, measured since the program started */
+        Time timestamp = 0_sec;
+
+        /**
+         * @brief Get an axis, after its curve
+         *
+         * @param axis the axis
+         * @return double the output of the curve of the axis
+         */
+        double getAxis(pros::controller_analog_e_t axis) const { return axes[axis]; }
+
+        /**
+         * @brief Get whether a button is held
+         *
+         * @param button the button
+         * @return true the button is held
+         * @return false the button is not held
+         */
+        bool isHeld(pros::controller_digital_e_t button) const { return buttons & bit(button); }
+
+        /**
+         * @brief Get whether a button was pressed since the previous update
+         *
+         * @param button the button
+         * @return true the button was pressed
+         * @return false the button was not pressed
+         */
+        bool wasPressed(pros::controller_digital_e_t button) const { return pressed & bit(button); }
+
+        /**
+         * @brief Get whether a button was released since the previous update
+         *
+         * @param button the button
+         * @return true the button was released
+         * @return false the button was not released
+         */
+        bool wasReleased(pros::controller_digital_e_t button) const { return released & bit(button); }
+
+        /**
+         * @brief Get the bit of a button
+         *
+         * @param button the button
+         * @return uint16_t the bit
+         */
+        static constexpr uint16_t bit(pros::controller_digital_e_t button) {
+            return uint16_t(1u << (button - pros::E_CONTROLLER_DIGITAL_L1));
+        }
+};
+
+/**
+ * @brief ControllerInput class
+ *
+ * Driver control code usually reads every axis and button it needs straight from the controller, every iteration of
+ * its loop, and works out deadbands, curves and presses on the spot. The input reads every channel of a controller
+ * once per update into a snapshot instead, so every reader shares one set of reads. The curve of every axis is turned
+ * into a lookup table when it is set, so an update doesn't do any floating point math, and presses and releases are
+ * worked out from the buttons of the previous update.
+ *
+ * Subscribers are only called when the snapshot changes, so code which reacts to the driver doesn't run while the
+ * sticks are still, or within their deadband. They are called from the task which updates the input, in the order
+ * they subscribed, and must be quick.
+ *
+ * The input doesn't have a task. Register update with a ControlScheduler, which runs it at an exact period from the
+ * same task as the other control loops. The controller only sends new values every 10 ms or so, which is a good
+ * period. Other tasks can read the latest snapshot with getSnapshot, which never blocks.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::ControllerInput input;
+ * lemlib::ControlScheduler scheduler;
+ *
+ * void initialize() {
+ *     input.setCurve(pros::E_CONTROLLER_ANALOG_LEFT_Y, {.deadband = 5, .expo = 0.5});
+ *     input.subscribe([](const lemlib::ControllerSnapshot& snapshot) {
+ *         drive.arcade(snapshot.getAxis(pros::E_CONTROLLER_ANALOG_LEFT_Y),
+ *                      snapshot.getAxis(pros::E_CONTROLLER_ANALOG_RIGHT_X));
+ *         if (snapshot.wasPressed(pros::E_CONTROLLER_DIGITAL_A)) clamp.toggle();
+ *     });
+ *     scheduler.add([] { input.update(); }, 10_msec);
+ *     scheduler.start();
+ * }
+ * @endcode
+ */
+class ControllerInput {
+    public:
+        /** the maximum number of subscribers an input can have */
+        static constexpr size_t MAX_SUBSCRIBERS = 8;
+        /**
+         * @brief Construct a new Controller Input
+         *
+         * Every axis has the default curve until setCurve is called
+         *
+         * @param id the controller to read. Defaults to the master controller
+         */
+        ControllerInput(pros::controller_id_e_t id = pros::E_CONTROLLER_MASTER);
+        ControllerInput(const ControllerInput& other) = delete;
+        ControllerInput& operator=(const ControllerInput& other) = delete;
+        /**
+         * @brief Set the curve of an axis
+         *
+         * The lookup table of the axis is rebuilt, and used from the next update
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the axis is invalid, the deadband isn't from 0 to 126, or the expo isn't from 0 to 1
+         *
+         * @param axis the axis
+         * @param curve the curve
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t setCurve(pros::controller_analog_e_t axis, AxisCurve curve);
+        /**
+         * @brief Call a function every time the snapshot changes
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the callback is empty
+         * ENOMEM: the input already has MAX_SUBSCRIBERS subscribers
+         *
+         * @param callback the function, which is passed the new snapshot
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t subscribe(std::function<void(const ControllerSnapshot&)> callback);
+        /**
+         * @brief Read the controller, and notify the subscribers if anything changed
+         *
+         * Call this periodically, like from a ControlScheduler. Only one task may update an input.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the controller is not connected. The snapshot is centered and every button is released, so
+         * anything driven by it stops
+         *
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t update();
+        /**
+         * @brief Get the snapshot of the latest update
+         *
+         * This function does not lock, and can be called from any task. Presses and releases are only those of the
+         * latest update, so tasks which read the snapshot less often than it is updated should subscribe instead.
+         *
+         * @return ControllerSnapshot the snapshot
+         */
+        ControllerSnapshot getSnapshot() const;
+    private:
+        // the output of every raw position of an axis, indexed by the position plus 127
+        using CurveTable = std::array<float, 255>;
+
+        const pros::controller_id_e_t m_id;
+        // protects the tables, which are changed by setCurve and used by update, and serializes subscribing
+        mutable pros::Mutex m_mutex;
+        std::array<CurveTable, 4> m_tables;
+        // subscribers are only ever appended, and published by the count, so update calls them without locking
+        std::array<std::function<void(const ControllerSnapshot&)>, MAX_SUBSCRIBERS> m_subscribers;
+        std::atomic<size_t> m_subscriberCount = 0;
+        // only touched by the task which updates the input
+        ControllerSnapshot m_previous;
+        bool m_first = true;
+        DoubleBuffer<ControllerSnapshot> m_snapshot;
+};
+} // namespace lemlib
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <climits>
+#include <cstdint>
+
+namespace lemlib {
+struct DeferredInit {};
+
+/**
+ * @brief Construct a device without touching the hardware, the device registry or the mutex pool
+ *
+ * A device constructed with this tag is constant initialized, so it can be declared constinit. Its constructor runs
+ * at compile time instead of during static initialization, so it doesn't add to boot time, and it can't depend on the
+ * order other globals are constructed in. The device does nothing until it is initialized with initializeAll, which
+ * claims its port and configures it. Using it before then is undefined behavior.
+ */
+constexpr DeferredInit deferred_init {};
+
+/**
+ * @brief Initialize devices which were constructed with deferred_init
+ *
+ * Every device is initialized once, in the order they are passed, from the task which calls this, like initialize.
+ *
+ * This function uses the following values of errno when an error state is reached:
+ *
+ * errno is set by the device which failed. The other devices are still initialized
+ *
+ * @param devices the devices
+ * @return int32_t 0 on success
+ * @return INT_MAX if any device failed to initialize, setting errno
+ *
+ * @b Example:
+ * @code {.cpp}
+ * constinit lemlib::V5RotationSensor vertical(1, lemlib::deferred_init);
+ * constinit lemlib::V5RotationSensor horizontal(-2, lemlib::deferred_init);
+ *
+ * void initialize() {
+ *     lemlib::initializeAll(vertical, horizontal);
+ * }
+ * @endcode
+ */
+template <typename... Devices> int32_t initializeAll(Devices&... devices) {
+    bool ok = true;
+    ((ok &= devices.initialize() == 0), ...);
+    return ok ? 0 : INT_MAX;
+}
+} // namespace lemlib
@@ -10,6 +10,33 @@ namespace lemlib {
  */
 class Device {
     public:
+        /**
+         * @brief whether the device is connected
+         *
+         * Devices read their connection from the shared snapshot of the DeviceRegistry, which is taken once per scan
+         * period, so this is cheap enough to call on every update
+         *
+         * @return 1 the device is connected
+         * @return 0 the device is not connected
+         */
         virtual int32_t isConnected() const = 0;
+        /**
+         * @brief Start the slow parts of setting up the device, without waiting for them to finish
+         *
+         * Called by DeviceRegistry::initializeAll, which starts every device before it waits for any of them, so slow
+         * setup like IMU calibration overlaps with the setup of the other devices. Devices which have nothing to set
+         * up do nothing.
+         *
+         * @return 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        virtual int32_t startInitialization() { return 0; }
+        /**
+         * @brief whether the setup started by startInitialization is still running
+         *
+         * @return 1 the device is still initializing
+         * @return 0 the device is ready, or initializing it failed
+         */
+        virtual int32_t isInitializing() const { return 0; }
 };
 } // namespace lemlib
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "hardware/Motor/MotorGroup.hpp"
+#include "hardware/Port.hpp"
+#include "units/core.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+
+namespace lemlib {
+/** the version of the device config file format */
+constexpr uint16_t CONFIG_FORMAT_VERSION = 1;
+
+/**
+ * @brief What a config record holds
+ */
+enum class ConfigRecordType : uint8_t {
+    /** signed smart ports, negative when the device is reversed, like the ports of a motor group */
+    PORTS = 1,
+    /** numbers, like a gyro scalar, a gear ratio or the gains of a controller */
+    NUMBERS = 2
+};
+
+/**
+ * @brief A named value of a device config file
+ *
+ * Records have a fixed size, so a file can be read straight into an array of them. They are written to the file
+ * exactly as they are laid out in memory, which is little-endian on the brain and on the computers configs are
+ * written on.
+ */
+struct ConfigRecord {
+        /** the most characters a name can have */
+        static constexpr size_t MAX_NAME_LENGTH = 21;
+        /** the most values a record can hold */
+        static constexpr size_t MAX_VALUES = 8;
+        /** the name of the record, padded with 0 bytes */
+        char name[MAX_NAME_LENGTH + 1] = {};
+        /** what the record holds */
+        ConfigRecordType type = ConfigRecordType::NUMBERS;
+        /** how many of the values are used */
+        uint8_t count = 0;
+        /** the values. Ports are stored as whole numbers */
+        float values[MAX_VALUES] = {};
+};
+
+static_assert(sizeof(ConfigRecord) == 56, "config records are written as raw 56 byte structs");
+
+/**
+ * @brief Make a record of ports
+ *
+ * This function uses the following values of errno when an error state is reached:
+ *
+ * EINVAL: the name is too long or empty, there are more than MAX_VALUES ports, or a port is out of range
+ *
+ * @param record set to the record
+ * @param name the name of the record
+ * @param ports the ports, negative when the device is reversed
+ * @return int32_t 0 on success
+ * @return INT_MAX on failure, setting errno
+ */
+int32_t makeConfigRecord(ConfigRecord& record, const char* name, std::span<const ReversibleSmartPort> ports);
+
+/**
+ * @brief Make a record of numbers
+ *
+ * This function uses the following values of errno when an error state is reached:
+ *
+ * EINVAL: the name is too long or empty, there are more than MAX_VALUES numbers, or a number isn't finite
+ *
+ * @param record set to the record
+ * @param name the name of the record
+ * @param values the numbers, which are stored as floats
+ * @return int32_t 0 on success
+ * @return INT_MAX on failure, setting errno
+ */
+int32_t makeConfigRecord(ConfigRecord& record, const char* name, std::span<const double> values);
+
+/**
+ * @brief Write a device config file
+ *
+ * The file starts with a 16 byte header: "LCFG", the format version, the size of a record and the number of records,
+ * followed by a CRC-32 of the records, which come right after it.
+ *
+ * This function uses the following values of errno when an error state is reached:
+ *
+ * EPROTO: a record is invalid, or two records use the same port
+ * EIO: the file could not be written completely
+ * any errno set by fopen
+ *
+ * @param path the path of the file
+ * @param records the records
+ * @return int32_t 0 on success
+ * @return INT_MAX on failure, setting errno
+ */
+int32_t saveDeviceConfig(const char* path, std::span<const ConfigRecord> records);
+
+/**
+ * @brief Robot configuration loaded from a file on the SD card, so tuning it doesn't need a new upload
+ *
+ * Ports, reversals, gear ratios, gyro scalars and gains are usually compiled in, so changing any of them means
+ * building and uploading the whole program again. A device config holds them as named records instead, in a binary
+ * file which is read in one pass at boot, straight into storage inside the config, without parsing or allocating.
+ * Every record is then checked: ports follow the same rules as the consteval constructors in Port.hpp, no port is
+ * used by two records, numbers are finite, and the file has to match its checksum. A file which fails any check is
+ * rejected as a whole.
+ *
+ * Every getter takes the value compiled into the program as a fallback, which it returns when the file doesn't have
+ * the record, so a robot without an SD card, or with a corrupt file, still runs on the compiled config. The
+ * config_encode tool in sim/tools writes a file from a text file.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::DeviceConfig<32> config;
+ * lemlib::MotorGroup left({}, 450_rpm);
+ * lemlib::V5InertialSensor imu(10);
+ *
+ * void initialize() {
+ *     config.load("/usd/robot.lcfg");
+ *     config.addMotors("drive.left", left, {1, -2, 3});
+ *     imu.setGyroScalar(config.getNumber("imu.scalar", 1.0));
+ *     std::array<double, 3> gains {0.5, 0, 0.02};
+ *     config.getNumbers("lift.gains", gains);
+ * }
+ * @endcode
+ */
+class DeviceConfigBase {
+    public:
+        DeviceConfigBase(const DeviceConfigBase& other) = delete;
+        DeviceConfigBase& operator=(const DeviceConfigBase& other) = delete;
+        /**
+         * @brief Load a device config file, replacing the records loaded before
+         *
+         * This must be called before the config is read by other tasks, like in initialize.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EPROTO: the file is not a device config file of this version, is corrupt, or has an invalid record
+         * ENOBUFS: the file has more records than the config can hold
+         * any errno set by fopen, like ENOENT when the file does not exist
+         *
+         * @param path the path of the file, like "/usd/robot.lcfg"
+         * @return int32_t the number of records
+         * @return INT_MAX on failure, setting errno. The config is left empty, so every getter returns its fallback
+         */
+        int32_t load(const char* path);
+        /**
+         * @brief Get the number of records loaded
+         *
+         * @return size_t the number of records
+         */
+        size_t size() const;
+        /**
+         * @brief Get a number of a record
+         *
+         * @param name the name of the record
+         * @param fallback the value to return if there is no record of numbers with that name, or it is too short
+         * @param index the index of the number in the record
+         * @return Number the number
+         */
+        Number getNumber(const char* name, Number fallback, size_t index = 0) const;
+        /**
+         * @brief Get every number of a record
+         *
+         * The buffer is left unchanged if the record isn't found, so it can hold the fallback values.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOENT: there is no record of numbers with that name
+         *
+         * @param name the name of the record
+         * @param buffer the buffer to write the numbers to. Numbers past its end are not written
+         * @return int32_t the number of numbers written
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t getNumbers(const char* name, std::span<double> buffer) const;
+        /**
+         * @brief Get the first port of a record
+         *
+         * @param name the name of the record
+         * @param fallback the port to return if there is no record of ports with that name
+         * @return ReversibleSmartPort the port
+         */
+        ReversibleSmartPort getPort(const char* name, ReversibleSmartPort fallback) const;
+        /**
+         * @brief Add the motors of a record of ports to a motor group
+         *
+         * The group is usually constructed without motors, as the ports are only known once the file is loaded.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOSPC: the group can't hold every motor
+         *
+         * @param name the name of the record
+         * @param group the group
+         * @param fallback the ports to add if there is no record of ports with that name
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno like MotorGroup::addMotor
+         */
+        int32_t addMotors(const char* name, MotorGroup& group,
+                          std::initializer_list<ReversibleSmartPort> fallback) const;
+    protected:
+        /**
+         * @brief Construct a new Device Config Base
+         *
+         * @param storage the storage for the records. It must outlive the config
+         * @param capacity the number of records the storage can hold
+         */
+        DeviceConfigBase(ConfigRecord* storage, size_t capacity);
+    private:
+        /**
+         * @brief Find a record
+         *
+         * @param name the name of the record
+         * @param type what the record has to hold
+         * @return const ConfigRecord* the record, or nullptr if there isn't one
+         */
+        const ConfigRecord* find(const char* name, ConfigRecordType type) const;
+
+        ConfigRecord* const m_storage;
+        const size_t m_capacity;
+        size_t m_size = 0;
+};
+
+/**
+ * @brief A DeviceConfig with storage for N records
+ *
+ * @tparam N the most records a file can have
+ */
+template <size_t N> class DeviceConfig : public DeviceConfigBase {
+    public:
+        /**
+         * @brief Construct a new, empty Device Config
+         */
+        DeviceConfig()
+            : DeviceConfigBase(m_records.data(), N) {}
+    private:
+        std::array<ConfigRecord, N> m_records;
+};
+} // namespace lemlib
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "hardware/DeferredInit.hpp"
+#include "hardware/MutexPool.hpp"
+#include "pros/rtos.h"
+#include <atomic>
+
+namespace lemlib {
+/**
+ * @brief A lock which does nothing, for devices which are only ever used by one task
+ */
+class NullLock {
+    public:
+        NullLock() = default;
+
+        constexpr explicit NullLock(DeferredInit) {}
+
+        constexpr void initialize() {}
+
+        constexpr void lock() {}
+
+        constexpr void unlock() {}
+
+        constexpr bool try_lock() { return true; }
+};
+
+/**
+ * @brief A lock which is a single atomic flag, instead of an RTOS mutex
+ *
+ * Locking an unlocked spin lock is a single atomic exchange, without a call into the RTOS, and the lock takes a single
+ * byte and nothing from the heap. A task which finds it locked sleeps for a millisecond before it tries again, so a
+ * lower priority task holding it can finish, but the lock doesn't inherit priorities like an RTOS mutex does. It suits
+ * devices which are rarely used by more than one task at once.
+ *
+ * Like a pooled mutex, a spin lock can be moved. The moved-to lock is unlocked.
+ */
+class SpinLock {
+    public:
+        SpinLock() = default;
+        constexpr explicit SpinLock(DeferredInit) {}
+        SpinLock(const SpinLock& other) = delete;
+        SpinLock& operator=(const SpinLock& other) = delete;
+
+        /**
+         * @brief Construct an unlocked spin lock in place of another
+         *
+         * Only the storage of the lock moves, so the other lock must not be locked
+         */
+        SpinLock(SpinLock&&) noexcept {}
+
+        /**
+         * @brief Keep this lock as it is, as only the storage of a lock moves
+         *
+         * @return SpinLock& this
+         */
+        SpinLock& operator=(SpinLock&&) noexcept { return *this; }
+
+        /**
+         * @brief Does nothing, as a spin lock needs nothing besides its flag
+         */
+        void initialize() {}
+
+        /**
+         * @brief Lock the spin lock, sleeping a millisecond at a time while another task holds it
+         */
+        void lock() {
+            while (m_locked.exchange(true, std::memory_order_acquire)) pros::c::delay(1);
+        }
+
+        /**
+         * @brief Unlock the spin lock
+         */
+        void unlock() { m_locked.store(false, std::memory_order_release); }
+
+        /**
+         * @brief Try to lock the spin lock, without waiting
+         *
+         * @return true the lock was locked
+         * @return false another task holds the lock
+         */
+        bool try_lock() { return !m_locked.exchange(true, std::memory_order_acquire); }
+    private:
+        std::atomic<bool> m_locked = false;
+};
+
+/**
+ * @brief The lock every device holds, chosen when the library is built
+ *
+ * By default, every device holds a PooledMutex, so any number of tasks can use a device at once. Programs in which a
+ * single task owns each device can build the library with -DLEMLIB_DEVICE_LOCK_NONE, so devices don't lock at all, or
+ * with -DLEMLIB_DEVICE_LOCK_SPIN, so they lock a SpinLock instead of an RTOS mutex. Every object of the library and the
+ * program has to be built with the same choice.
+ */
+#if defined(LEMLIB_DEVICE_LOCK_NONE)
+using DeviceMutex = NullLock;
+#elif defined(LEMLIB_DEVICE_LOCK_SPIN)
+using DeviceMutex = SpinLock;
+#else
+using DeviceMutex = PooledMutex;
+#endif
+} // namespace lemlib
@@ -0,0 +1,708 @@
+#pragma once
+
+#include "hardware/Distance/V5DistanceSensor.hpp"
+#include "hardware/DoubleBuffer.hpp"
+#include "hardware/Encoder/Encoder.hpp"
+#include "hardware/Encoder/EncoderHistory.hpp"
+#include "hardware/GPS/V5GPS.hpp"
+#include "hardware/IMU/IMU.hpp"
+#include "hardware/IMU/V5InertialSensor.hpp"
+#include "hardware/Motor/MotorGroup.hpp"
+#include "hardware/Optical/V5OpticalSensor.hpp"
+#include "hardware/TaskManager.hpp"
+#include "units/core.hpp"
+#include "units/Electrical.hpp"
+#include "units/Quaternion.hpp"
+#include "units/Statistics.hpp"
+#include "pros/rtos.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief A sample of an IMU, taken by a DevicePoller
+ */
+struct IMUSample {
+        /** the time the sample was taken, measured since the program started */
+        Time timestamp = 0_sec;
+        /** the rotation of the IMU. INFINITY if it could not be read */
+        Angle rotation = from_stDeg(INFINITY);
+        /** whether the IMU was connected when the sample was taken */
+        bool connected = false;
+        /**
+         * the orientation of the IMU, integrated from its gyro rates, for IMUs registered with addOrientationIMU. It
+         * rotates vectors from the axes of the IMU into a level frame whose z axis points up, counterclockwise
+         * positive. The identity for other IMUs
+         */
+        units::Quaternion orientation;
+        /** whether the orientation is being integrated, which is false until the IMU is first read successfully */
+        bool hasOrientation = false;
+};
+
+/**
+ * @brief A sample of the motors of a motor group, taken by a DevicePoller
+ */
+struct MotorGroupSample {
+        /** the time the sample was taken, measured since the program started */
+        Time timestamp = 0_sec;
+        /** the temperature of the hottest motor. INFINITY if no motor could be read */
+        Temperature maxTemperature = units::from_celsius(INFINITY);
+        /** the total current drawn by the motors which could be read */
+        Current current = 0_amp;
+        /** the number of motors which could be read */
+        uint8_t motors = 0;
+        /** whether any motor of the group was connected when the sample was taken */
+        bool connected = false;
+};
+
+/**
+ * @brief DevicePoller class
+ *
+ * Smart devices only send new data about every 10 ms, but every call to a getter of a device locks its mutex and
+ * makes a call to the SDK. The DevicePoller samples registered devices once per period in its own task, and publishes
+ * the samples through lock-free buffers. Reading a sample takes constant time and never waits on a device mutex.
+ *
+ * The poller has a fixed capacity, so it never allocates memory after construction. Devices must outlive the poller.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::V5RotationSensor encoder(1);
+ * lemlib::V5InertialSensor imu(2);
+ * lemlib::DevicePoller poller;
+ *
+ * void initialize() {
+ *     const int32_t encoderIndex = poller.addEncoder(encoder);
+ *     const int32_t imuIndex = poller.addIMU(imu);
+ *     poller.start();
+ *     while (true) {
+ *         std::cout << poller.getEncoderSample(encoderIndex).angle << std::endl;
+ *         std::cout << poller.getIMUSample(imuIndex).rotation << std::endl;
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class DevicePoller {
+    public:
+        /** the maximum number of encoders a poller can sample */
+        static constexpr size_t MAX_ENCODERS = 32;
+        /** the maximum number of IMUs a poller can sample */
+        static constexpr size_t MAX_IMUS = 8;
+        /** the maximum number of motor groups a poller can sample */
+        static constexpr size_t MAX_MOTOR_GROUPS = 8;
+        /** the maximum number of motors sampled in each motor group. Motors beyond it are not sampled */
+        static constexpr size_t MAX_GROUP_MOTORS = 8;
+        /** the maximum number of motors a poller can finish the motions of */
+        static constexpr size_t MAX_MOTORS = 16;
+        /** the maximum number of GPS sensors a poller can sample */
+        static constexpr size_t MAX_GPS = 2;
+        /** the maximum number of optical sensors a poller can sample */
+        static constexpr size_t MAX_OPTICAL = 4;
+        /** the maximum number of distance sensors a poller can sample */
+        static constexpr size_t MAX_DISTANCE_SENSORS = 8;
+        /** the number of samples the median of a distance sensor is taken over */
+        static constexpr size_t DISTANCE_MEDIAN_SAMPLES = 5;
+        /**
+         * @brief Construct a new Device Poller
+         *
+         * The poller does not sample anything until start is called
+         *
+         * @param period how often devices are sampled. Defaults to 10 ms, which is how often smart devices update
+         *
+         * @b Example:
+         * @code {.cpp}
+         * // sample devices every 5 ms
+         * lemlib::DevicePoller poller(5_msec);
+         * @endcode
+         */
+        DevicePoller(Time period = 10_msec);
+        DevicePoller(const DevicePoller& other) = delete;
+        DevicePoller& operator=(const DevicePoller& other) = delete;
+        /**
+         * @brief Destroy the Device Poller, stopping its task
+         */
+        ~DevicePoller();
+        /**
+         * @brief Register an encoder to be sampled
+         *
+         * Encoders can be registered while the poller is running. The first sample is taken in the next update.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOMEM: the poller is already sampling MAX_ENCODERS encoders
+         *
+         * @param encoder the encoder to sample. It must outlive the poller
+         * @return int32_t the index of the encoder, which is passed to getEncoderSample
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     const int32_t index = poller.addEncoder(encoder);
+         *     if (index == INT_MAX) std::cout << "Poller is full" << std::endl;
+         * }
+         * @endcode
+         */
+        int32_t addEncoder(Encoder& encoder);
+        /**
+         * @brief Register an encoder to be sampled, and record its samples in a history
+         *
+         * Every sample where the encoder is connected is also pushed to the history, which can be used to calculate
+         * velocity and acceleration. See addEncoder(Encoder&) for details.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOMEM: the poller is already sampling MAX_ENCODERS encoders
+         *
+         * @param encoder the encoder to sample. It must outlive the poller
+         * @param history the history to fill. It must outlive the poller
+         * @return int32_t the index of the encoder, which is passed to getEncoderSample
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * lemlib::EncoderHistory<16> history;
+         *
+         * void initialize() {
+         *     poller.addEncoder(encoder, history);
+         * }
+         * @endcode
+         */
+        int32_t addEncoder(Encoder& encoder, EncoderHistoryBase& history);
+        /**
+         * @brief Register an IMU to be sampled
+         *
+         * IMUs can be registered while the poller is running. The first sample is taken in the next update.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOMEM: the poller is already sampling MAX_IMUS IMUs
+         *
+         * @param imu the IMU to sample. It must outlive the poller
+         * @return int32_t the index of the IMU, which is passed to getIMUSample
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     const int32_t index = poller.addIMU(imu);
+         *     if (index == INT_MAX) std::cout << "Poller is full" << std::endl;
+         * }
+         * @endcode
+         */
+        int32_t addIMU(IMU& imu);
+        /**
+         * @brief Register a V5 Inertial Sensor to be sampled, and integrate its 3D orientation
+         *
+         * Every update reads the gyro rates and the acceleration of the sensor through its readout, and adds the
+         * rotation since the last update to a quaternion, which is published in the sample. The first successful read
+         * levels the orientation with the acceleration, which is gravity while the robot is at rest, and sets its yaw
+         * to the rotation of the sensor. Integrating a sample is a few dozen multiplications, and no trig.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOMEM: the poller is already sampling MAX_IMUS IMUs
+         *
+         * @param imu the IMU to sample. It must outlive the poller
+         * @return int32_t the index of the IMU, which is passed to getIMUSample
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     const int32_t index = poller.addOrientationIMU(imu);
+         *     while (true) {
+         *         const lemlib::IMUSample sample = poller.getIMUSample(index);
+         *         const bool tipping = sample.hasOrientation && sample.orientation.cosTilt() < 0.9;
+         *         if (tipping) std::cout << "tipping!" << std::endl;
+         *         pros::delay(10);
+         *     }
+         * }
+         * @endcode
+         */
+        int32_t addOrientationIMU(V5InertialSensor& imu);
+        /**
+         * @brief Level the orientation of an IMU registered with addOrientationIMU again, in its next sample
+         *
+         * Call this while the robot is at rest, so the acceleration is only gravity. It removes the drift of the tilt.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the index does not belong to an IMU registered with addOrientationIMU
+         *
+         * @param index the index returned by addOrientationIMU
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t levelOrientation(int32_t index);
+        /**
+         * @brief Register a motor group to be sampled
+         *
+         * The temperature and current of every connected motor is read, and summarized into a single sample. Motor
+         * groups can be registered while the poller is running. The first sample is taken in the next update. The
+         * poller also finishes the motions started by MotorGroup::moveToAngle.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOMEM: the poller is already sampling MAX_MOTOR_GROUPS motor groups
+         *
+         * @param group the motor group to sample. It must outlive the poller
+         * @return int32_t the index of the motor group, which is passed to getMotorGroupSample
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     const int32_t index = poller.addMotorGroup(leftMotors);
+         *     if (index == INT_MAX) std::cout << "Poller is full" << std::endl;
+         * }
+         * @endcode
+         */
+        int32_t addMotorGroup(MotorGroup& group);
+        /**
+         * @brief Register a motor, so the poller finishes the motions started by Motor::moveToAngle
+         *
+         * The angle of the motor is only read while a motion is pending, so registered motors which aren't moving to
+         * an angle cost nothing. Motors can be registered while the poller is running.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOMEM: the poller is already watching MAX_MOTORS motors
+         *
+         * @param motor the motor. It must outlive the poller
+         * @return int32_t the index of the motor, like the index returned by the other functions which add a device
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     poller.addMotor(arm);
+         *     poller.start();
+         * }
+         * @endcode
+         */
+        int32_t addMotor(Motor& motor);
+        /**
+         * @brief Register a GPS to be sampled
+         *
+         * GPS sensors can be registered while the poller is running. The first sample is taken in the next update.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOMEM: the poller is already sampling MAX_GPS GPS sensors
+         *
+         * @param gps the GPS to sample. It must outlive the poller
+         * @return int32_t the index of the GPS, which is passed to getGPSSample
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     const int32_t index = poller.addGPS(gps);
+         *     if (index == INT_MAX) std::cout << "Poller is full" << std::endl;
+         * }
+         * @endcode
+         */
+        int32_t addGPS(V5GPS& gps);
+        /**
+         * @brief Register an optical sensor to be sampled
+         *
+         * Optical sensors can be registered while the poller is running. The first sample is taken in the next update.
+         * The poller becomes the only task which reads the sensor, so getReading must not be called anywhere else.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOMEM: the poller is already sampling MAX_OPTICAL optical sensors
+         *
+         * @param sensor the optical sensor to sample. It must outlive the poller
+         * @return int32_t the index of the optical sensor, which is passed to getOpticalSample
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     const int32_t index = poller.addOpticalSensor(optical);
+         *     if (index == INT_MAX) std::cout << "Poller is full" << std::endl;
+         * }
+         * @endcode
+         */
+        int32_t addOpticalSensor(V5OpticalSensor& sensor);
+        /**
+         * @brief Register a distance sensor to be sampled
+         *
+         * Distance sensors can be registered while the poller is running. The first sample is taken in the next
+         * update. Every sample has the median of the latest DISTANCE_MEDIAN_SAMPLES distances which were in range, so
+         * a reading which sees past the object is ignored. The median starts over when the sensor can't be read.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOMEM: the poller is already sampling MAX_DISTANCE_SENSORS distance sensors
+         *
+         * @param sensor the distance sensor to sample. It must outlive the poller
+         * @return int32_t the index of the distance sensor, which is passed to getDistanceSample
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     const int32_t index = poller.addDistanceSensor(back);
+         *     if (index == INT_MAX) std::cout << "Poller is full" << std::endl;
+         * }
+         * @endcode
+         */
+        int32_t addDistanceSensor(V5DistanceSensor& sensor);
+        /**
+         * @brief Get the latest sample of an encoder
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the index does not belong to a registered encoder
+         *
+         * @param index the index returned by addEncoder
+         * @return EncoderSample the latest sample. The angle is INFINITY if the index is invalid, or if no sample has
+         * been taken yet
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     const lemlib::EncoderSample sample = poller.getEncoderSample(index);
+         *     if (sample.connected) std::cout << sample.angle << std::endl;
+         * }
+         * @endcode
+         */
+        EncoderSample getEncoderSample(int32_t index) const;
+        /**
+         * @brief Get the latest sample of an IMU
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the index does not belong to a registered IMU
+         *
+         * @param index the index returned by addIMU
+         * @return IMUSample the latest sample. The rotation is INFINITY if the index is invalid, or if no sample has
+         * been taken yet
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     const lemlib::IMUSample sample = poller.getIMUSample(index);
+         *     if (sample.connected) std::cout << sample.rotation << std::endl;
+         * }
+         * @endcode
+         */
+        IMUSample getIMUSample(int32_t index) const;
+        /**
+         * @brief Get the latest sample of a motor group
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the index does not belong to a registered motor group
+         *
+         * @param index the index returned by addMotorGroup
+         * @return MotorGroupSample the latest sample. The maximum temperature is INFINITY if the index is invalid, or
+         * if no sample has been taken yet
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     const lemlib::MotorGroupSample sample = poller.getMotorGroupSample(index);
+         *     if (sample.connected) std::cout << units::to_celsius(sample.maxTemperature) << std::endl;
+         * }
+         * @endcode
+         */
+        MotorGroupSample getMotorGroupSample(int32_t index) const;
+        /**
+         * @brief Get the latest sample of a GPS
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the index does not belong to a registered GPS
+         *
+         * @param index the index returned by addGPS
+         * @return GPSReading the latest sample. The pose is INFINITY if the index is invalid, if no sample has been
+         * taken yet, or if the GPS could not be read
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     const lemlib::GPSReading sample = poller.getGPSSample(index);
+         *     fusion.fuse(sample);
+         * }
+         * @endcode
+         */
+        GPSReading getGPSSample(int32_t index) const;
+        /**
+         * @brief Get the latest sample of an optical sensor
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the index does not belong to a registered optical sensor
+         *
+         * @param index the index returned by addOpticalSensor
+         * @return OpticalReading the latest sample. The hue is INFINITY if the index is invalid, if no sample has been
+         * taken yet, or if the sensor could not be read
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     const lemlib::OpticalReading sample = poller.getOpticalSample(index);
+         *     if (sample.color == BLUE) ejector.move(1);
+         * }
+         * @endcode
+         */
+        OpticalReading getOpticalSample(int32_t index) const;
+        /**
+         * @brief Get the latest sample of a distance sensor
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the index does not belong to a registered distance sensor
+         *
+         * @param index the index returned by addDistanceSensor
+         * @return DistanceSample the latest sample. The distance and median are INFINITY if the index is invalid, or
+         * if no sample has been taken yet
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     const lemlib::DistanceSample sample = poller.getDistanceSample(index);
+         *     if (sample.median < 4_in) intake.move(1);
+         * }
+         * @endcode
+         */
+        DistanceSample getDistanceSample(int32_t index) const;
+        /**
+         * @brief Sample every registered device once
+         *
+         * This is called periodically by the poller task, but can also be called manually if the poller is not
+         * started. It must not be called from more than one task at once.
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     while (true) {
+         *         poller.update();
+         *         pros::delay(10);
+         *     }
+         * }
+         * @endcode
+         */
+        void update();
+        /**
+         * @brief Set how often devices are sampled
+         *
+         * Sampling faster than a device updates only reads the same value again, and sampling slower adds delay, so
+         * the period should match the data rate of the fastest device that matters, like a rotation sensor which was
+         * set to update every 5 ms. The new period is used from the next update, even while the poller is running.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the period is shorter than 1 ms, or not finite
+         *
+         * @param period how often devices are sampled. It is rounded to whole milliseconds
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     encoder.setDataRate(5_msec);
+         *     poller.setPeriod(encoder.getDataRate());
+         *     poller.start();
+         * }
+         * @endcode
+         */
+        int32_t setPeriod(Time period);
+        /**
+         * @brief Get how often devices are sampled
+         *
+         * @return Time the period
+         */
+        Time getPeriod() const;
+        /**
+         * @brief Align the updates of the poller task with the updates of an IMU
+         *
+         * The SDK doesn't report when an IMU updated, so a poller with the same period as the sensor still samples
+         * it at an arbitrary point between two updates, which adds up to a whole period of latency to the heading.
+         * When aligned, the task reads the rotation of the IMU every millisecond until it changes, and starts its
+         * update right then, so every sample is taken just after the sensor updated. The alignment is repeated every
+         * second, as the clocks of the brain and the sensor drift apart. An IMU which isn't rotating at all doesn't
+         * change, so the task keeps its schedule until it does.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the index does not belong to a registered IMU
+         *
+         * @param index the index returned by addIMU, or -1 to stop aligning
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     imu.setDataRate(5_msec);
+         *     poller.setPeriod(imu.getDataRate());
+         *     poller.syncToIMU(poller.addIMU(imu));
+         *     poller.start();
+         * }
+         * @endcode
+         */
+        int32_t syncToIMU(int32_t index);
+        /**
+         * @brief Start the poller task
+         *
+         * The task is created by the TaskManager, with the stack depth and the CPU budget of its role.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EBUSY: the poller is already running
+         * ENOMEM: the task could not be created
+         *
+         * @param priority the priority of the poller task. Defaults to the priority the TaskManager configures for
+         * TaskRole::DEVICE_POLLER, one above the default priority so samples are taken on time
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     poller.start();
+         * }
+         * @endcode
+         */
+        int32_t start(uint32_t priority = MANAGED_PRIORITY);
+        /**
+         * @brief Stop the poller task
+         *
+         * This function blocks until the current update finishes. The latest samples can still be read after the
+         * poller is stopped
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void disabled() {
+         *     poller.stop();
+         * }
+         * @endcode
+         */
+        void stop();
+    private:
+        /**
+         * @brief the function run by the poller task
+         *
+         * @param poller pointer to the poller
+         */
+        static void taskFunction(void* poller);
+        /**
+         * @brief Wait until the IMU the poller is aligned with changes its rotation
+         *
+         * @param period the period of the poller, in milliseconds. The wait ends after twice the period
+         */
+        void waitForIMUUpdate(uint32_t period);
+        /**
+         * @brief Claim the next encoder entry
+         *
+         * The mutex has to be locked before this function is called
+         *
+         * @param encoder the encoder to sample
+         * @param history the history to fill, or nullptr if there is none
+         * @return int32_t the index of the encoder, or INT_MAX on failure, setting errno
+         */
+        int32_t addEncoderEntry(Encoder& encoder, EncoderHistoryBase* history);
+        /**
+         * @brief Register an IMU
+         *
+         * @param imu the IMU to sample
+         * @param orientationImu the same IMU, if its orientation is integrated, or nullptr
+         * @return int32_t the index of the IMU, or INT_MAX on failure, setting errno
+         */
+        int32_t addIMUEntry(IMU& imu, V5InertialSensor* orientationImu);
+        struct IMUEntry;
+        /**
+         * @brief Add the rotation of an IMU since its last sample to its orientation
+         *
+         * This is only called by the poller task
+         *
+         * @param entry the entry of the IMU
+         * @param sample the sample to write the orientation to
+         */
+        static void integrateOrientation(IMUEntry& entry, IMUSample& sample);
+
+        struct EncoderEntry {
+                Encoder* encoder = nullptr;
+                EncoderHistoryBase* history = nullptr;
+                DoubleBuffer<EncoderSample> sample;
+        };
+
+        struct IMUEntry {
+                IMU* imu = nullptr;
+                V5InertialSensor* orientationImu = nullptr;
+                DoubleBuffer<IMUSample> sample;
+                // set by levelOrientation, and cleared by the poller task once it has leveled the orientation
+                std::atomic<bool> level = true;
+                // only touched by the poller task
+                units::Quaternion orientation;
+                Time lastReadout = from_sec(INFINITY);
+        };
+
+        struct MotorGroupEntry {
+                MotorGroup* group = nullptr;
+                DoubleBuffer<MotorGroupSample> sample;
+        };
+
+        struct GPSEntry {
+                V5GPS* gps = nullptr;
+                DoubleBuffer<GPSReading> sample;
+        };
+
+        struct OpticalEntry {
+                V5OpticalSensor* sensor = nullptr;
+                DoubleBuffer<OpticalReading> sample;
+        };
+
+        struct DistanceEntry {
+                V5DistanceSensor* sensor = nullptr;
+                DoubleBuffer<DistanceSample> sample;
+                // only touched by the poller task
+                units::SlidingMedian<Length, DISTANCE_MEDIAN_SAMPLES> median;
+        };
+
+        // read by the poller task before every delay, so it can be changed while the poller is running
+        std::atomic<Time> m_period;
+        // registering devices is locked, so two tasks can't claim the same entry. Sampling and reading never lock
+        pros::Mutex m_mutex;
+        std::array<EncoderEntry, MAX_ENCODERS> m_encoders;
+        std::array<IMUEntry, MAX_IMUS> m_imus;
+        std::array<MotorGroupEntry, MAX_MOTOR_GROUPS> m_motorGroups;
+        std::array<Motor*, MAX_MOTORS> m_motors {};
+        std::array<GPSEntry, MAX_GPS> m_gps;
+        std::array<OpticalEntry, MAX_OPTICAL> m_optical;
+        std::array<DistanceEntry, MAX_DISTANCE_SENSORS> m_distanceSensors;
+        // entries are filled in before the count is incremented, so the poller task only sees complete entries
+        std::atomic<size_t> m_encoderCount = 0;
+        std::atomic<size_t> m_imuCount = 0;
+        std::atomic<size_t> m_motorGroupCount = 0;
+        std::atomic<size_t> m_motorCount = 0;
+        std::atomic<size_t> m_gpsCount = 0;
+        std::atomic<size_t> m_opticalCount = 0;
+        std::atomic<size_t> m_distanceCount = 0;
+        // the index of the IMU the task is aligned with, or -1
+        std::atomic<int32_t> m_syncIMU = -1;
+        // the task is not deleted from outside, as it could be holding a device mutex. Instead it is asked to exit
+        std::atomic<bool> m_running = false;
+        std::atomic<bool> m_taskExited = true;
+};
+} // namespace lemlib
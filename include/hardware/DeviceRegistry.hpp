@@ -0,0 +1,609 @@
+#pragma once
+
+#include "hardware/DeferredInit.hpp"
+#include "hardware/Device.hpp"
+#include "hardware/Signal.hpp"
+#include "units/core.hpp"
+#include "pros/device.h"
+#include <array>
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+
+namespace lemlib {
+namespace detail {
+/**
+ * @brief Check if any two ports refer to the same smart port, ignoring reversal
+ *
+ * @param ports the ports to check
+ * @return true if a port is used more than once
+ */
+template <std::size_t N> consteval bool hasDuplicatePorts(const std::array<std::int64_t, N>& ports) {
+    for (std::size_t i = 0; i < N; i++) {
+        for (std::size_t j = i + 1; j < N; j++) {
+            if ((ports[i] < 0 ? -ports[i] : ports[i]) == (ports[j] < 0 ? -ports[j] : ports[j])) return true;
+        }
+    }
+    return false;
+}
+} // namespace detail
+
+/**
+ * @brief Whether every port is a different smart port, ignoring reversal
+ *
+ * Ports which are known at compile time can be checked for conflicts before the program is uploaded. Ports which are
+ * only known at runtime are checked by the DeviceRegistry instead.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * static_assert(lemlib::portsAreUnique<1, -2, 3, 4>, "two devices share a port!");
+ * @endcode
+ */
+template <std::int64_t... Ports>
+constexpr bool portsAreUnique = !detail::hasDuplicatePorts<sizeof...(Ports)>({Ports...});
+
+/**
+ * @brief The state of a smart port which devices cache, shared by every device object on the port
+ *
+ * Caches kept in a device object are lost with it, and two objects on the same port can't see each other's caches,
+ * so each would detect the motor type on its own, and one could skip a command because it matches the last command
+ * it sent, after another object sent a different one. Every object caches into the state of its port instead. The
+ * state of a port is cleared when the DeviceRegistry sees its device unplugged or replaced.
+ *
+ * Every field is a separate atomic, so reading and updating the state never locks.
+ */
+struct PortState {
+        /** the value of motorType when the type is not known */
+        static constexpr uint8_t UNKNOWN_TYPE = UINT8_MAX;
+
+        /** the type of motor detected on the port, as a MotorType, or UNKNOWN_TYPE */
+        std::atomic<uint8_t> motorType = UNKNOWN_TYPE;
+        /** the cartridge of the motor on the port in rpm, or 0 if it is not known */
+        std::atomic<uint16_t> cartridge = 0;
+        /** the last command sent to the motor on the port, packed by packCommand. 0 if it is not known */
+        std::atomic<uint64_t> command = 0;
+        /** the latest raw reading of the position of the device, in the format of a ReadCache */
+        std::atomic<uint64_t> reading = 0;
+        /**
+         * the command waiting to be sent by the CommandDispatcher, packed by packCommand with its priority in the top
+         * byte. 0 if there is none
+         */
+        std::atomic<uint64_t> pending = 0;
+        /**
+         * the source which owns the port, with its command priority in bits 32 to 39 and when it last commanded the
+         * port in the bottom 32, in milliseconds. 0 if no source with a priority above 0 owns it. See
+         * CommandDispatcher::claim
+         */
+        std::atomic<uint64_t> owner = 0;
+
+        /**
+         * @brief Pack a command, so it can be saved in a single atomic
+         *
+         * @param kind the kind of command, which must not be 0
+         * @param value the raw value of the command. Values which don't fit in 16 bits can't be cached
+         * @param time when the command was sent, in milliseconds
+         * @return uint64_t the packed command, or 0 if the value doesn't fit
+         */
+        static constexpr uint64_t packCommand(uint8_t kind, int32_t value, uint32_t time) {
+            if (value < INT16_MIN || value > INT16_MAX) return 0;
+            return (uint64_t(kind) << 48) | (uint64_t(uint16_t(value)) << 32) | time;
+        }
+
+        /**
+         * @brief Get the kind of a packed command
+         *
+         * @param command the packed command
+         * @return uint8_t the kind, or 0 if the command is empty
+         */
+        static constexpr uint8_t commandKind(uint64_t command) { return uint8_t(command >> 48); }
+
+        /**
+         * @brief Get the value of a packed command
+         *
+         * @param command the packed command
+         * @return int32_t the value
+         */
+        static constexpr int32_t commandValue(uint64_t command) { return int16_t(uint16_t(command >> 32)); }
+
+        /**
+         * @brief Get when a packed command was sent
+         *
+         * @param command the packed command
+         * @return uint32_t the time, in milliseconds
+         */
+        static constexpr uint32_t commandTime(uint64_t command) { return uint32_t(command); }
+
+        /**
+         * @brief Get the priority of a pending command
+         *
+         * @param command the packed command
+         * @return uint8_t the priority
+         */
+        static constexpr uint8_t commandPriority(uint64_t command) { return uint8_t(command >> 56); }
+
+        /**
+         * @brief Forget everything cached about the device on the port
+         *
+         * A pending command and the owner are kept, so a motor which was replaced still gets the command of its owner
+         */
+        void invalidate() {
+            motorType.store(UNKNOWN_TYPE, std::memory_order_relaxed);
+            cartridge.store(0, std::memory_order_relaxed);
+            command.store(0, std::memory_order_relaxed);
+            reading.store(0, std::memory_order_relaxed);
+        }
+};
+
+/**
+ * @brief DeviceRegistry class
+ *
+ * Every device claims the ports it uses from the registry when it is constructed. Claiming a port which another
+ * device has already claimed is a conflict, for example two motors on the same port, or a motor and a rotation sensor.
+ * Conflicts can't be reported by a constructor, so they are recorded, and can be checked once every device has been
+ * constructed. Copies of a device share the claim of the original, so copying a device is never a conflict.
+ *
+ * The registry also keeps a snapshot of the type of device plugged into every smart port. The snapshot is taken in a
+ * single pass over all 21 ports, at most once per scan period, and every device reads from the same snapshot. This
+ * makes checking whether a device is connected a lookup, instead of a call to the SDK per device.
+ *
+ * Every snapshot is compared with the previous one, port by port. When a device is plugged in, unplugged or replaced,
+ * the plug sequence is incremented and every subscriber is called, so code which reacts to reconnects can check a
+ * single counter, or be told, instead of polling every device.
+ *
+ * Claims are lock-free, so devices can be constructed before the scheduler starts, for example as globals.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::Motor left(1, 600_rpm);
+ * lemlib::V5RotationSensor encoder(1); // conflicts with the motor
+ *
+ * void initialize() {
+ *     const uint32_t conflicts = lemlib::DeviceRegistry::get().getConflicts();
+ *     if (conflicts != 0) std::cout << "Port conflicts: " << conflicts << std::endl;
+ * }
+ * @endcode
+ */
+class DeviceRegistry {
+    public:
+        /** the port number PROS uses for the ADI ports on the brain */
+        static constexpr uint8_t BRAIN_ADI_PORT = 22;
+        /** the number of smart ports on the brain */
+        static constexpr uint8_t SMART_PORTS = 21;
+        /** the number of ADI ports on the brain, and on every ADI expander */
+        static constexpr uint8_t ADI_PORTS = 8;
+        /** the most subscribers which can be notified of changes to the plugged devices */
+        static constexpr std::size_t MAX_SUBSCRIBERS = 16;
+        /**
+         * @brief Called when the type of device plugged into a port changes
+         *
+         * The arguments are the smart port, the type which was plugged in before, and the type which is plugged in
+         * now. E_DEVICE_NONE means nothing is plugged in
+         */
+        using PlugCallback = std::function<void(uint8_t, pros::c::v5_device_e_t, pros::c::v5_device_e_t)>;
+
+        DeviceRegistry(const DeviceRegistry& other) = delete;
+        DeviceRegistry& operator=(const DeviceRegistry& other) = delete;
+        /**
+         * @brief Get the registry
+         *
+         * The registry is constructed the first time this function is called, so it can be used by devices which are
+         * globals
+         *
+         * @return DeviceRegistry& the registry
+         */
+        static DeviceRegistry& get();
+        /**
+         * @brief Claim a smart port for a device
+         *
+         * If the port has already been claimed, the claim still counts, so releasing it later stays balanced, and the
+         * conflict is recorded. Ports which are out of range are ignored, as the device can't use them anyway.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EADDRINUSE: the port has already been claimed by another device
+         *
+         * @param port the smart port, from 1 to 21
+         * @param type the type of the device
+         * @param shared whether the port can be shared with other devices of the same type which share it too, like
+         * ADI devices on the same expander
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t claim(uint8_t port, pros::c::v5_device_e_t type, bool shared = false);
+        /**
+         * @brief Add another claim to a port which has already been claimed, for a copy of the device which claimed it
+         *
+         * This is never a conflict, as the copy refers to the same device
+         *
+         * @param port the smart port, from 1 to 21
+         */
+        void retain(uint8_t port);
+        /**
+         * @brief Release a claim of a smart port
+         *
+         * @param port the smart port, from 1 to 21
+         */
+        void release(uint8_t port);
+        /**
+         * @brief Claim an ADI port for a device
+         *
+         * The smart port of the expander is claimed too, shared with the other ADI devices on the expander. See
+         * claim for details.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EADDRINUSE: the port has already been claimed by another device
+         *
+         * @param expanderPort the smart port of the ADI expander, or BRAIN_ADI_PORT
+         * @param adiPort the ADI port, either a number from 1 to 8 or a letter
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t claimADI(uint8_t expanderPort, uint8_t adiPort);
+        /**
+         * @brief Add another claim to an ADI port which has already been claimed, for a copy of the device which
+         * claimed it
+         *
+         * @param expanderPort the smart port of the ADI expander, or BRAIN_ADI_PORT
+         * @param adiPort the ADI port, either a number from 1 to 8 or a letter
+         */
+        void retainADI(uint8_t expanderPort, uint8_t adiPort);
+        /**
+         * @brief Release a claim of an ADI port, and of the smart port of its expander
+         *
+         * @param expanderPort the smart port of the ADI expander, or BRAIN_ADI_PORT
+         * @param adiPort the ADI port, either a number from 1 to 8 or a letter
+         */
+        void releaseADI(uint8_t expanderPort, uint8_t adiPort);
+        /**
+         * @brief Get the ports which have been claimed by more than one device
+         *
+         * Conflicts stay recorded after the devices are destroyed.
+         *
+         * @return uint32_t a bitmask, where bit port - 1 is set if the port had a conflict. A conflict on an ADI port
+         * sets the bit of its expander, or bit 21 for the ADI ports on the brain
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     const uint32_t conflicts = lemlib::DeviceRegistry::get().getConflicts();
+         *     for (int port = 1; port <= 22; port++) {
+         *         if (conflicts & (1 << (port - 1))) std::cout << "Port " << port << " is used twice" << std::endl;
+         *     }
+         * }
+         * @endcode
+         */
+        uint32_t getConflicts() const;
+        /**
+         * @brief Get the type of device plugged into a smart port
+         *
+         * The type is read from the latest snapshot, which is taken again first if it is older than the scan period.
+         *
+         * @param port the smart port, from 1 to 21
+         * @return pros::c::v5_device_e_t the type of the device, or E_DEVICE_UNDEFINED if the port is out of range
+         */
+        pros::c::v5_device_e_t getPluggedType(uint8_t port);
+        /**
+         * @brief Get every port which has a certain type of device plugged in
+         *
+         * The masks of motors, rotation sensors, inertial sensors and ADI expanders are calculated once per snapshot, so
+         * checking them is a single load. Other types are found from the plugged type of every port.
+         *
+         * @param type the type of device
+         * @return uint32_t a bitmask, where bit port - 1 is set if the device is plugged into the port. The ADI ports
+         * on the brain, bit 21, are always plugged in as E_DEVICE_ADI
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     const uint32_t motors = lemlib::DeviceRegistry::get().getPluggedPorts(pros::c::E_DEVICE_MOTOR);
+         *     std::cout << "Motors plugged in: " << std::popcount(motors) << std::endl;
+         * }
+         * @endcode
+         */
+        uint32_t getPluggedPorts(pros::c::v5_device_e_t type);
+        /**
+         * @brief Check if a certain type of device is plugged into a port
+         *
+         * This is how devices check whether they are connected, so it costs a load and a comparison on hot paths.
+         *
+         * @param port the smart port, from 1 to 21, or BRAIN_ADI_PORT
+         * @param type the type of device
+         * @return true the device is plugged in, as of the latest snapshot
+         * @return false the device is not plugged in, or the port is out of range
+         */
+        bool isPlugged(uint8_t port, pros::c::v5_device_e_t type);
+        /**
+         * @brief Get the cached state of a smart port, which is shared by every device object on it
+         *
+         * @param port the smart port, from 1 to 21. Ports out of range share a state of their own, as no device can be
+         * read through them
+         * @return PortState& the state
+         */
+        PortState& getPortState(uint8_t port) { return m_portStates[port <= SMART_PORTS ? port : 0]; }
+        /**
+         * @brief Check if a port is set in a port mask, like the masks returned by getPluggedPorts
+         *
+         * @param mask the mask
+         * @param port the smart port, from 1 to 21, or BRAIN_ADI_PORT
+         * @return true the port is in range, and its bit is set
+         * @return false the port is out of range, or its bit is not set
+         */
+        static constexpr bool hasPort(uint32_t mask, uint8_t port) {
+            return port >= 1 && port <= BRAIN_ADI_PORT && (mask & (uint32_t(1) << (port - 1))) != 0;
+        }
+        /**
+         * @brief Get how many snapshots found a device plugged in, unplugged or replaced
+         *
+         * Saving the sequence and comparing it later tells if anything changed in between with a single load, without
+         * checking every port. The snapshot is taken again first if it is older than the scan period.
+         *
+         * @return uint32_t the sequence. It only ever increases, and wraps around
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     uint32_t sequence = lemlib::DeviceRegistry::get().getPlugSequence();
+         *     while (true) {
+         *         const uint32_t latest = lemlib::DeviceRegistry::get().getPlugSequence();
+         *         if (latest != sequence) std::cout << "A device was plugged in or unplugged" << std::endl;
+         *         sequence = latest;
+         *         pros::delay(10);
+         *     }
+         * }
+         * @endcode
+         */
+        uint32_t getPlugSequence();
+        /**
+         * @brief Block the calling task until a certain type of device is plugged into a port
+         *
+         * The task sleeps until a snapshot finds the device, so it uses no CPU while it waits. Snapshots are only
+         * taken when a task checks the ports, so something has to keep checking them, like a running DevicePoller,
+         * which refreshes the snapshot every update.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the port is out of range
+         *
+         * ETIMEDOUT: the device was not plugged in before the timeout
+         *
+         * @param port the smart port, from 1 to 21
+         * @param type the type of device
+         * @param timeout the longest time to wait. Defaults to forever
+         * @return int32_t 0 once the device is plugged in
+         * @return INT_MAX error occurred, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     if (lemlib::DeviceRegistry::get().waitForPlugged(1, pros::c::E_DEVICE_MOTOR, 5_sec) == INT_MAX) {
+         *         std::cout << "The motor is still unplugged" << std::endl;
+         *     }
+         * }
+         * @endcode
+         */
+        int32_t waitForPlugged(uint8_t port, pros::c::v5_device_e_t type, Time timeout = from_sec(INFINITY));
+        /**
+         * @brief Get notified whenever the type of device plugged into a port changes
+         *
+         * The callback is called once for every changed port, by the task which took the snapshot, right after it was
+         * taken. It should return quickly, and must not block, as that task is usually a control loop. It is never
+         * called for the first snapshot.
+         *
+         * Subscribing allocates memory, so it should be done in initialize rather than in a control loop.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the callback is empty
+         *
+         * ENOMEM: there are already MAX_SUBSCRIBERS subscribers
+         *
+         * @param callback the function to call
+         * @param ports a bitmask of the ports to be notified of, where bit port - 1 is set. Defaults to every port
+         * @return int32_t the index of the subscriber, to unsubscribe with
+         * @return INT_MAX error occurred, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::DeviceRegistry::get().subscribe([](uint8_t port, auto previous, auto current) {
+         *         if (current == pros::c::E_DEVICE_NONE) std::cout << "Port " << int(port) << " unplugged" << std::endl;
+         *     });
+         * }
+         * @endcode
+         */
+        int32_t subscribe(PlugCallback callback, uint32_t ports = UINT32_MAX);
+        /**
+         * @brief Stop notifying a subscriber
+         *
+         * The slot of the subscriber is not reused, so its callback is kept until the program ends
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: there is no subscriber with the index
+         *
+         * @param index the index returned by subscribe
+         * @return int32_t 0 on success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t unsubscribe(int32_t index);
+        /**
+         * @brief Set up every device at once
+         *
+         * Devices are set up in two phases. First, the slow part of every device is started, like calibrating IMUs
+         * and detecting the type of motors, without waiting for any of them. Then the registry waits until none of
+         * them is initializing anymore. The setup of the devices overlaps, so the whole robot is ready about as soon
+         * as the slowest device, usually an IMU, instead of after the sum of them.
+         *
+         * A device which fails to start doesn't stop the others from being set up.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ETIMEDOUT: a device was still initializing after the timeout
+         *
+         * Any other value is the error of the first device which failed to start
+         *
+         * @param devices the devices to set up
+         * @param timeout how long to wait for the devices. Defaults to 5 seconds
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::DeviceRegistry::get().initializeAll({&imu, &leftMotors, &rightMotors, &intake});
+         * }
+         * @endcode
+         */
+        int32_t initializeAll(std::initializer_list<Device*> devices, Time timeout = 5_sec);
+        /**
+         * @brief Take a new snapshot of every smart port now
+         *
+         * If another task is taking a snapshot already, this function returns without taking another one
+         */
+        void scan();
+        /**
+         * @brief Take a new snapshot if the latest one is older than the scan period
+         */
+        void refresh();
+        /**
+         * @brief Set how old a snapshot can be before it is taken again
+         *
+         * @param period the period. Defaults to 10 ms, which is how often smart devices update. 0 takes a snapshot
+         * every time a port is checked
+         * @return int32_t always returns 0
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     // check ports more often
+         *     lemlib::DeviceRegistry::get().setScanPeriod(5_msec);
+         * }
+         * @endcode
+         */
+        int32_t setScanPeriod(Time period);
+        /**
+         * @brief Get how old a snapshot can be before it is taken again
+         *
+         * @return Time the period
+         */
+        Time getScanPeriod() const;
+    private:
+        DeviceRegistry() = default;
+
+        /** the types of device whose ports are saved as a mask in every snapshot */
+        static constexpr std::array<pros::c::v5_device_e_t, 4> MASKED_TYPES = {
+            pros::c::E_DEVICE_MOTOR, pros::c::E_DEVICE_ROTATION, pros::c::E_DEVICE_IMU, pros::c::E_DEVICE_ADI};
+
+        /**
+         * @brief Call every subscriber of a port which changed in the latest snapshot
+         *
+         * @param changed a bitmask of the ports which changed
+         * @param previous the type of device plugged into every port before the latest snapshot
+         */
+        void notify(uint32_t changed, const std::array<pros::c::v5_device_e_t, SMART_PORTS>& previous);
+
+        /**
+         * @brief Record a claim in a slot
+         *
+         * Slots hold the number of claims in the low 16 bits, and the type of the claim and whether it can be shared
+         * in the bits above, so a claim is a single compare and swap
+         *
+         * @param slot the slot
+         * @param type the type of the device
+         * @param shared whether the claim can be shared with claims of the same type
+         * @return true the claim is a conflict
+         */
+        static bool claimSlot(std::atomic<uint32_t>& slot, uint8_t type, bool shared);
+        /**
+         * @brief Remove a claim from a slot
+         *
+         * @param slot the slot
+         */
+        static void releaseSlot(std::atomic<uint32_t>& slot);
+
+        /**
+         * @brief A function to notify of changes to the plugged devices
+         */
+        struct Subscriber {
+                PlugCallback callback;
+                uint32_t ports;
+                std::atomic<bool> enabled = false;
+        };
+
+        std::array<std::atomic<uint32_t>, SMART_PORTS> m_smartClaims {};
+        // the ADI ports on the brain use the first expander slot, as smart port 0 does not exist
+        std::array<std::atomic<uint32_t>, (SMART_PORTS + 1) * ADI_PORTS> m_adiClaims {};
+        std::atomic<uint32_t> m_conflicts = 0;
+
+        std::array<std::atomic<pros::c::v5_device_e_t>, SMART_PORTS> m_pluggedTypes {};
+        // the ports of every type in MASKED_TYPES, in the same order
+        std::array<std::atomic<uint32_t>, MASKED_TYPES.size()> m_pluggedMasks {};
+        // when the latest snapshot was taken, in milliseconds
+        std::atomic<uint32_t> m_scanTime = 0;
+        std::atomic<uint32_t> m_scanPeriod = 10;
+        std::atomic<bool> m_scanned = false;
+        std::atomic<bool> m_scanning = false;
+        std::atomic<uint32_t> m_plugSequence = 0;
+        // the state of every smart port, indexed by the port. Index 0 is shared by ports which are out of range
+        std::array<PortState, SMART_PORTS + 1> m_portStates {};
+        // notified whenever a snapshot finds a change, to wake the tasks blocked in waitForPlugged
+        Signal m_plugSignal;
+
+        std::array<Subscriber, MAX_SUBSCRIBERS> m_subscribers;
+        // the number of slots which have been taken. A subscriber is only enabled once it is filled in, so the scanning
+        // task never sees a partial one
+        std::atomic<std::size_t> m_subscriberSlots = 0;
+};
+
+/**
+ * @brief A claim of a port in the DeviceRegistry, which is released when it is destroyed
+ *
+ * Devices hold a PortClaim for every port they use. Copying a claim shares the port with the copy, so the port is
+ * only free again once every copy has been destroyed.
+ */
+class PortClaim {
+    public:
+        /**
+         * @brief Claim a smart port
+         *
+         * @param port the smart port, from 1 to 21. Ports which are out of range are not claimed
+         * @param type the type of the device
+         */
+        PortClaim(uint8_t port, pros::c::v5_device_e_t type);
+        /**
+         * @brief Claim an ADI port, and share the smart port of its expander
+         *
+         * @param expanderPort the smart port of the ADI expander, or DeviceRegistry::BRAIN_ADI_PORT
+         * @param adiPort the ADI port, either a number from 1 to 8 or a letter
+         */
+        PortClaim(uint8_t expanderPort, uint8_t adiPort);
+        /**
+         * @brief Construct a claim of no port, so it can be constant initialized. A claim can be assigned to it later
+         */
+        constexpr explicit PortClaim(DeferredInit)
+            : m_port(0),
+              m_adiPort(0),
+              m_type(pros::c::E_DEVICE_NONE) {}
+        PortClaim(const PortClaim& other);
+        PortClaim& operator=(const PortClaim& other);
+        ~PortClaim();
+    private:
+        /**
+         * @brief Add another claim to the port of this claim
+         */
+        void retain() const;
+        /**
+         * @brief Release the port of this claim
+         */
+        void release() const;
+
+        uint8_t m_port;
+        // 0 if this is a claim of a smart port
+        uint8_t m_adiPort;
+        pros::c::v5_device_e_t m_type;
+};
+} // namespace lemlib
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "hardware/Device.hpp"
+#include "hardware/Result.hpp"
+#include "units/units.hpp"
+#include <errno.h>
+
+namespace lemlib {
+/**
+ * @brief abstract DistanceSensor class
+ *
+ * A distance sensor measures how far away the nearest object in front of it is, like a V5DistanceSensor.
+ */
+class DistanceSensor : public Device {
+    public:
+        /**
+         * @brief Get the distance to the object in front of the sensor
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ERANGE: there is no object in range of the sensor
+         *
+         * Implementations may use other values of errno as well, like ENODEV when the sensor is unplugged.
+         *
+         * @return Length the distance
+         * @return INFINITY on failure, setting errno
+         */
+        virtual Length getDistance() const = 0;
+        /**
+         * @brief Get the distance to the object in front of the sensor, or the error which prevented reading it
+         *
+         * Errors are returned in the result instead of by setting errno, like Encoder::tryGetAngle. The default
+         * implementation calls getDistance.
+         *
+         * @return Result<Length> the distance, or the error
+         */
+        virtual Result<Length> tryGetDistance() const {
+            const Length distance = getDistance();
+            if (distance == from_in(INFINITY)) [[unlikely]]
+                return Result<Length>::failure(errno);
+            return distance;
+        }
+        /**
+         * @brief Get how confident the sensor is in its latest distance
+         *
+         * @return Number the confidence, from 0 to 1
+         * @return INFINITY on failure, setting errno
+         */
+        virtual Number getConfidence() const = 0;
+};
+} // namespace lemlib
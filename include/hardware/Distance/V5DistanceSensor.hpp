@@ -0,0 +1,166 @@
+#pragma once
+
+#include "hardware/DeviceRegistry.hpp"
+#include "hardware/Distance/DistanceSensor.hpp"
+#include "hardware/Port.hpp"
+#include "hardware/ReadCache.hpp"
+#include "pros/distance.hpp"
+
+namespace lemlib {
+/**
+ * @brief A timestamped distance, read by a V5DistanceSensor or sampled by a DevicePoller
+ */
+struct DistanceSample {
+        /** when the distance was read, measured since the program started */
+        Time timestamp = 0_sec;
+        /** the distance. INFINITY if there is no object in range, or if the sensor could not be read */
+        Length distance = from_in(INFINITY);
+        /**
+         * the median of the latest in range distances, which ignores a few readings which see past the object. Only
+         * set by a DevicePoller, and INFINITY until it has a distance
+         */
+        Length median = from_in(INFINITY);
+        /** whether the sensor could be read, even if there was no object in range */
+        bool connected = false;
+};
+
+/**
+ * @brief DistanceSensor implementation for the V5 Distance Sensor
+ *
+ * The sensor measures up to about 2 meters. Below 200 mm it is accurate to about 15 mm, and above that to about 5%.
+ */
+class V5DistanceSensor final : public DistanceSensor {
+    public:
+        /**
+         * @brief Construct a new V5 Distance Sensor
+         *
+         * @param port the port of the distance sensor
+         *
+         * @b Example:
+         * @code {.cpp}
+         * // distance sensor on port 4
+         * lemlib::V5DistanceSensor sensor(4);
+         * @endcode
+         */
+        V5DistanceSensor(SmartPort port);
+        // the simulator only implements the PROS C api, so PROS objects can't be converted
+#ifndef LEMLIB_SIM
+        /**
+         * @brief Create a new V5 Distance Sensor
+         *
+         * @param sensor the pros::Distance object to use
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::V5DistanceSensor sensor = lemlib::V5DistanceSensor::from_pros_dist(pros::Distance(4));
+         * }
+         * @endcode
+         */
+        static V5DistanceSensor from_pros_dist(pros::Distance sensor);
+#endif
+        /**
+         * @brief whether the V5 Distance Sensor is connected
+         *
+         * The connection is read from the latest snapshot of the DeviceRegistry, so this is only a lookup, and can be
+         * up to one scan period old
+         *
+         * @return 0 if its not connected
+         * @return 1 if it is connected
+         */
+        int32_t isConnected() const override;
+        /**
+         * @brief Get the distance to the object in front of the V5 Distance Sensor
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENXIO: the port is not within the range of valid ports (1-21)
+         * ENODEV: the port cannot be configured as a V5 Distance Sensor
+         * ERANGE: there is no object in range of the sensor
+         *
+         * @return Length the distance
+         * @return INFINITY on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     const Length distance = sensor.getDistance();
+         *     if (distance != from_in(INFINITY)) std::cout << to_in(distance) << std::endl;
+         * }
+         * @endcode
+         */
+        Length getDistance() const override { return tryGetDistance().orSentinel(from_in(INFINITY)); }
+        /**
+         * @brief Get the distance to the object in front of the V5 Distance Sensor, or the error which prevented
+         * reading it
+         *
+         * The raw reading is checked as an integer, and errno is only read if it failed.
+         *
+         * @return Result<Length> the distance, or the error set by the SDK. ERANGE if there is no object in range
+         */
+        Result<Length> tryGetDistance() const override;
+        /**
+         * @brief Get how confident the V5 Distance Sensor is in its latest distance
+         *
+         * The sensor only reports its confidence for objects further away than 200 mm.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENXIO: the port is not within the range of valid ports (1-21)
+         * ENODEV: the port cannot be configured as a V5 Distance Sensor
+         *
+         * @return Number the confidence, from 0 to 1
+         * @return INFINITY on failure, setting errno
+         */
+        Number getConfidence() const override;
+        /**
+         * @brief Get the distance, and when it was read
+         *
+         * The distance goes through the read cache, like getDistance. The median is not set, as it needs the
+         * previous samples, which a DevicePoller keeps.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENXIO: the port is not within the range of valid ports (1-21)
+         * ENODEV: the port cannot be configured as a V5 Distance Sensor
+         *
+         * @return DistanceSample the sample. The distance is INFINITY if there is no object in range, and the sample
+         * is not connected if the sensor could not be read, setting errno
+         */
+        DistanceSample getSample() const;
+        /**
+         * @brief Set how long getDistance reuses the last distance read from the sensor
+         *
+         * The sensor only measures every few tens of milliseconds, so reading it more often returns the same
+         * distance. With a window, the sensor is only read if the last reading is older than the window, so a poller
+         * and a routine can read it in the same cycle for the cost of one read.
+         *
+         * @param window how old a reading can be and still be used. 0 disables the cache, which is the default
+         * @return int32_t always returns 0
+         */
+        int32_t setReadCacheWindow(Time window);
+        /**
+         * @brief Get how long getDistance reuses the last distance read from the sensor
+         *
+         * @return Time the window. 0 if the cache is disabled
+         */
+        Time getReadCacheWindow() const;
+        /**
+         * @brief Get the port of the V5 Distance Sensor
+         *
+         * @return uint8_t the port
+         */
+        uint8_t getPort() const;
+    private:
+        /** the reading of the sensor when there is no object in range, in millimeters */
+        static constexpr int32_t NO_OBJECT = 9999;
+        /** the highest confidence the sensor reports */
+        static constexpr int32_t MAX_CONFIDENCE = 63;
+
+        uint8_t m_port;
+        // the claim of the port in the DeviceRegistry
+        PortClaim m_claim;
+        // the last raw distance, kept in the state of the port so every sensor object on the port shares it
+        mutable ReadCache m_readCache;
+};
+} // namespace lemlib
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace lemlib {
+/**
+ * @brief A lock-free buffer with a single writer and any number of readers
+ *
+ * The buffer is a seqlock over two slots. The writer makes the sequence odd before it starts copying a value into the
+ * slot that is not published, and even again once the copy is done, which publishes that slot. Readers copy the
+ * published slot, and retry if the writer started on that same slot while they were copying, which it only does two
+ * writes later. A write in progress is always on the other slot, so a reader which preempted the writer in the middle
+ * of a write still reads the last published value straight away, instead of waiting for a writer that can't run until
+ * it is done.
+ *
+ * Writing from more than one task at once is not supported.
+ *
+ * @tparam T the type of the value. It is copied with memcpy semantics, so it has to be trivially copyable
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::DoubleBuffer<Angle> buffer(0_stDeg);
+ *
+ * void writerTask() {
+ *     buffer.write(motor.getAngle());
+ * }
+ *
+ * void readerTask() {
+ *     const Angle angle = buffer.read();
+ * }
+ * @endcode
+ */
+template <typename T> class DoubleBuffer {
+        static_assert(std::is_trivially_copyable_v<T>, "DoubleBuffer can only hold trivially copyable types");
+    public:
+        /**
+         * @brief Construct a new Double Buffer
+         *
+         * @param initial the value readers get before anything is written
+         */
+        constexpr DoubleBuffer(const T& initial = T())
+            : m_slots {initial, initial} {}
+
+        /**
+         * @brief Publish a new value
+         *
+         * Only one task may write to the buffer.
+         *
+         * @param value the value to publish
+         */
+        void write(const T& value) {
+            const uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+            // an odd sequence marks the write as in progress, before any byte of the slot changes
+            m_sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_slots[slotOf(sequence + 2)] = value;
+            m_sequence.store(sequence + 2, std::memory_order_release);
+        }
+
+        /**
+         * @brief Get the latest published value
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * @return T the latest published value
+         */
+        T read() const {
+            while (true) {
+                const uint32_t sequence = m_sequence.load(std::memory_order_acquire);
+                const T value = m_slots[slotOf(sequence)];
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (unchanged(sequence)) return value;
+            }
+        }
+
+        /**
+         * @brief Get the latest published value, and the sequence it was published with
+         *
+         * @param sequence set to the number of values written when the value was published
+         * @return T the latest published value
+         */
+        T read(uint32_t& sequence) const {
+            while (true) {
+                const uint32_t loaded = m_sequence.load(std::memory_order_acquire);
+                const T value = m_slots[slotOf(loaded)];
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (!unchanged(loaded)) continue;
+                sequence = loaded >> 1;
+                return value;
+            }
+        }
+
+        /**
+         * @brief Read part of the latest published value in place, without copying all of it
+         *
+         * The reader is called on the published slot, and called again if the writer started on that slot while it
+         * ran, so it has to be cheap and free of side effects, and only its result may be kept, like a single field.
+         *
+         * @param reader the function, which takes a const T& and returns what it read from it
+         * @return the result of the reader
+         */
+        template <typename F> auto read(F&& reader) const {
+            while (true) {
+                const uint32_t sequence = m_sequence.load(std::memory_order_acquire);
+                auto result = reader(m_slots[slotOf(sequence)]);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (unchanged(sequence)) return result;
+            }
+        }
+
+        /**
+         * @brief Get the number of values written to the buffer
+         *
+         * @return uint32_t the number of values written since construction. Wraps around after 2^31 writes
+         */
+        uint32_t getSequence() const { return m_sequence.load(std::memory_order_acquire) >> 1; }
+    private:
+        /**
+         * @brief Get the slot published at a sequence
+         *
+         * @param sequence the sequence, odd while a write is in progress
+         * @return std::size_t the index of the slot
+         */
+        static constexpr std::size_t slotOf(uint32_t sequence) { return (sequence >> 1) & 1; }
+
+        /**
+         * @brief Check that the slot published at a sequence wasn't written to since it was loaded
+         *
+         * The slot is written to again by the write after the next one, which makes the sequence odd for the second
+         * time after the last completed write. Any change before that only touched the other slot
+         *
+         * @param sequence the sequence loaded before the slot was read
+         * @return true the slot read is whole
+         * @return false the writer started on the slot, so it has to be read again
+         */
+        bool unchanged(uint32_t sequence) const {
+            return m_sequence.load(std::memory_order_relaxed) - (sequence & ~uint32_t(1)) <= 2;
+        }
+
+        T m_slots[2];
+        // twice the number of completed writes, plus 1 while a write is in progress
+        std::atomic<uint32_t> m_sequence = 0;
+};
+} // namespace lemlib
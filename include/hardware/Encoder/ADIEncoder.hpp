@@ -1,9 +1,16 @@
 #pragma once
 
+#include "hardware/DeviceMutex.hpp"
+#include "hardware/DeviceRegistry.hpp"
 #include "hardware/Encoder/Encoder.hpp"
+#include "hardware/Encoder/EncoderPosition.hpp"
+#include "hardware/Encoder/TickAccumulator.hpp"
+#include "hardware/Encoder/TickVelocityEstimator.hpp"
 #include "hardware/Port.hpp"
+#include "hardware/ReadCache.hpp"
 #include "pros/adi.hpp"
 #include "pros/rtos.hpp"
+#include <atomic>
 
 namespace lemlib {
 /**
@@ -61,7 +68,7 @@ class ADIEncoder : public Encoder {
         /**
          * @brief ADIEncoder copy constructor
          *
-         * Because pros::Mutex does not have a copy constructor, an explicit
+         * Because DeviceMutex does not have a copy constructor, an explicit
          * copy constructor for the ADIEncoder is necessary
          *
          * @param other the ADIEncoder to copy
@@ -72,11 +79,12 @@ class ADIEncoder : public Encoder {
          *
          * @deprecated This function is deprecated because there is no way to check if the ADIEncoder is connected due
          * to the nature of the ADI ports. If this function is called, it will act as if the encoder is connected.
-         * However, it may still return an error and set errno
+         * However, it may still return an error and set errno. Only the ADI expander can be checked, which is read
+         * from the latest snapshot of the DeviceRegistry
          *
          * This function uses the following values of errno when an error state is reached:
          *
-         * ENODEV: the port could not be configured as an encoder
+         * ENODEV: the ADI expander of the encoder is not connected
          *
          * @return 1 if there are no errors
          * @return INT_MAX if there is an error, setting errno
@@ -110,12 +118,36 @@ class ADIEncoder : public Encoder {
          * @endcode
          */
         Angle getAngle() const override;
+        /**
+         * @brief Get the raw count of the encoder, in degrees, and when it was read
+         *
+         * The count is the one getAngle converts, before the offset is applied.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port could not be configured as an encoder
+         *
+         * @return RawReading the count and when it was read. The value is INT_MAX if there is an error, setting errno
+         */
+        RawReading getRaw() const;
+        /**
+         * @brief Get the position of the encoder, which is converted to an angle only when it is needed
+         *
+         * The position holds the same reading as getRaw, and the scale and offset getAngle would apply to it.
+         * Subtracting two positions gives the angle the encoder moved without converting either of them.
+         *
+         * @return EncoderPosition the position. It is invalid if there is an error, setting errno like getRaw
+         */
+        EncoderPosition getPosition() const;
         /**
          * @brief Set the relative angle of the encoder
          *
          * This function sets the relative angle of the encoder. The relative angle is the number of rotations the
          * encoder has measured since the last reset. This function is non-blocking.
          *
+         * The angle is set by saving an offset from the current count, which keeps running, so ticks counted while the
+         * angle is set aren't lost, and the velocity isn't disturbed. Use resetCount to reset the count itself.
+         *
          * This function uses the following values of errno when an error state is reached:
          *
          * ENODEV: the port could not be configured as an encoder
@@ -139,9 +171,91 @@ class ADIEncoder : public Encoder {
          * @endcode
          */
         int32_t setAngle(Angle angle) override;
+        /**
+         * @brief Reset the count of the encoder in the hardware, and set the relative angle
+         *
+         * This is a round trip to the ADI, and ticks counted while the count is reset are lost, so setAngle should be
+         * used to zero the encoder while it moves. The velocity estimate starts over after a reset.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port could not be configured as an encoder
+         *
+         * @param angle the angle to set the measured angle to. Defaults to 0
+         * @return 0 on success
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::ADIEncoder encoder = pros::adi::Encoder('A', 'B');
+         *     // the robot is still, so no ticks can be lost
+         *     if (encoder.resetCount() != 0) std::cout << "Error resetting the encoder!" << std::endl;
+         * }
+         * @endcode
+         */
+        int32_t resetCount(Angle angle = 0_stDeg);
+        /**
+         * @brief Get the velocity of the encoder
+         *
+         * The optical shaft encoder only counts a tick per degree, so the velocity is estimated by a
+         * TickVelocityEstimator, from the time between ticks at low speed and from the change in count at high speed.
+         * The estimate is updated every time this function is called, so it should be called periodically, for
+         * example every 10 ms. Calls to getAngle don't update the estimate.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port could not be configured as an encoder
+         *
+         * @return AngularVelocity the velocity of the encoder
+         * @return INFINITY if there is an error, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     lemlib::ADIEncoder encoder = pros::adi::Encoder('A', 'B');
+         *     while (true) {
+         *         std::cout << "Velocity: " << to_rpm(encoder.getVelocity()) << std::endl;
+         *         pros::delay(10);
+         *     }
+         * }
+         * @endcode
+         */
+        AngularVelocity getVelocity() const;
+        /**
+         * @brief Set the settings of the velocity estimate used by getVelocity
+         *
+         * @param settings the settings
+         * @return int32_t always returns 0
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::ADIEncoder encoder = pros::adi::Encoder('A', 'B');
+         *     // a tracking wheel which rolls to a stop quickly
+         *     encoder.setVelocityEstimation({.timeout = 100_msec});
+         * }
+         * @endcode
+         */
+        int32_t setVelocityEstimation(TickVelocitySettings settings);
+        /**
+         * @brief Get the settings of the velocity estimate used by getVelocity
+         *
+         * @return TickVelocitySettings the settings
+         */
+        TickVelocitySettings getVelocityEstimation() const;
     private:
-        mutable pros::Mutex m_mutex;
+        // serializes calls to setAngle, resetCount and getVelocity. The offset is atomic, so reading the angle doesn't
+        // need the mutex
+        mutable DeviceMutex m_mutex;
         pros::adi::Encoder m_encoder;
-        Angle m_offset = 0_stDeg;
+        std::atomic<Angle> m_offset = 0_stDeg;
+        // the count extended to 64 bits, which the offset is added to
+        mutable TickAccumulator m_ticks;
+        // estimates the velocity from the raw angle, without the offset, so setting the angle doesn't look like motion
+        mutable TickVelocityEstimator m_velocityEstimator;
+        // the claims of both ADI ports in the DeviceRegistry
+        PortClaim m_topClaim;
+        PortClaim m_bottomClaim;
 };
 } // namespace lemlib
\ No newline at end of file
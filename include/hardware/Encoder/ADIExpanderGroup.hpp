@@ -0,0 +1,311 @@
+#pragma once
+
+#include "hardware/DeviceRegistry.hpp"
+#include "hardware/DoubleBuffer.hpp"
+#include "hardware/Encoder/Encoder.hpp"
+#include "hardware/Encoder/TickVelocityEstimator.hpp"
+#include "hardware/Port.hpp"
+#include "pros/adi.hpp"
+#include "pros/rtos.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace lemlib {
+/**
+ * @brief ADIExpanderGroup class
+ *
+ * Tracking wheels read through separate ADIEncoders on one ADI expander each make their own call to the SDK, at
+ * slightly different times, so the wheels of a single odometry update are not sampled together. The group owns every
+ * optical shaft encoder on one expander, and reads all of them in a single sweep, at most once per update period,
+ * by whichever task asks for an angle first once the latest sweep is out of date. Every ADIExpanderEncoder of the
+ * group reads from the same sweep, which is published through a DoubleBuffer, so reading an angle is otherwise a copy
+ * of the sweep.
+ *
+ * The velocity of every encoder is estimated during the sweep, with a TickVelocityEstimator.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * // ADI expander on port 2, with three tracking wheels
+ * lemlib::ADIExpanderGroup expander(2);
+ * lemlib::ADIExpanderEncoder left(expander, {'A', 'B'}, false);
+ * lemlib::ADIExpanderEncoder right(expander, {'C', 'D'}, true);
+ * lemlib::ADIExpanderEncoder back(expander, {'E', 'F'}, false);
+ *
+ * void opcontrol() {
+ *     while (true) {
+ *         // all three angles come from the same sweep
+ *         std::cout << to_stDeg(left.getAngle()) << ", " << to_stDeg(right.getAngle()) << ", "
+ *                   << to_stDeg(back.getAngle()) << std::endl;
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class ADIExpanderGroup {
+    public:
+        /** the maximum number of encoders on one expander, as every encoder takes two of its eight ports */
+        static constexpr size_t MAX_ENCODERS = 4;
+        /**
+         * @brief Construct a new ADI Expander Group
+         *
+         * @param expanderPort the port of the ADI expander
+         */
+        ADIExpanderGroup(SmartPort expanderPort);
+        ADIExpanderGroup(const ADIExpanderGroup& other) = delete;
+        ADIExpanderGroup& operator=(const ADIExpanderGroup& other) = delete;
+        /**
+         * @brief Add an optical shaft encoder to the group
+         *
+         * This is called by the constructor of ADIExpanderEncoder, and only needs to be called directly to read an
+         * encoder through getAngle and getVelocity of the group. Encoders can be added while the group is being swept,
+         * and are read from the next sweep.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EADDRINUSE: the ports are already used by another encoder of the group
+         * ENOMEM: the group is full
+         *
+         * @param ports the two ports of the optical shaft encoder (1-8, 'a'-'h', 'A'-'H')
+         * @param reversed whether the encoder is reversed or not
+         * @return int32_t the index of the encoder in the group
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     const int32_t index = expander.addEncoder({'G', 'H'}, false);
+         *     if (index == INT_MAX) std::cout << "Could not add the encoder" << std::endl;
+         * }
+         * @endcode
+         */
+        int32_t addEncoder(ADIPair ports, bool reversed);
+        /**
+         * @brief Get the raw angle of an encoder of the group, as of the latest sweep
+         *
+         * The group is swept first if the latest sweep is older than the update period. The angle is counted from when
+         * the encoder was added, and is not changed by ADIExpanderEncoder::setAngle.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the index does not belong to an encoder of the group
+         * ENODEV: the encoder could not be read
+         *
+         * @param index the index returned by addEncoder
+         * @return Angle the angle of the encoder
+         * @return INFINITY on failure, setting errno
+         */
+        Angle getAngle(int32_t index);
+        /**
+         * @brief Get the velocity of an encoder of the group, as of the latest sweep
+         *
+         * The group is swept first if the latest sweep is older than the update period.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the index does not belong to an encoder of the group
+         * ENODEV: the encoder could not be read
+         *
+         * @param index the index returned by addEncoder
+         * @return AngularVelocity the velocity of the encoder
+         * @return INFINITY on failure, setting errno
+         */
+        AngularVelocity getVelocity(int32_t index);
+        /**
+         * @brief Check if the ADI expander is plugged in
+         *
+         * The encoders themselves can't be checked, due to hardware limitations. The expander is checked against the
+         * shared snapshot of the DeviceRegistry.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the expander is not plugged in
+         *
+         * @return 1 the expander is plugged in
+         * @return INT_MAX the expander is not plugged in, setting errno
+         */
+        int32_t isConnected() const;
+        /**
+         * @brief Read every encoder of the group now, and publish the sweep
+         *
+         * This is called when the latest sweep is out of date. If another task is already sweeping the group, this
+         * returns straight away, and the sweep of the other task is used.
+         */
+        void update();
+        /**
+         * @brief Set how long a sweep is used for before the group is swept again
+         *
+         * @param period the period, rounded to whole milliseconds. Defaults to 10 ms, which is how often the ADI
+         * updates. 0 sweeps the group on every read
+         * @return int32_t always returns 0
+         */
+        int32_t setUpdatePeriod(Time period);
+        /**
+         * @brief Get how long a sweep is used for before the group is swept again
+         *
+         * @return Time the period
+         */
+        Time getUpdatePeriod() const;
+        /**
+         * @brief Set the settings of the velocity estimation of every encoder of the group
+         *
+         * The settings are used from the next sweep. The estimates are kept.
+         *
+         * @param settings the settings
+         * @return int32_t always returns 0
+         */
+        int32_t setVelocityEstimation(TickVelocitySettings settings);
+        /**
+         * @brief Get the settings of the velocity estimation of every encoder of the group
+         *
+         * @return TickVelocitySettings the settings
+         */
+        TickVelocitySettings getVelocityEstimation() const;
+    private:
+        struct Reading {
+                // INT32_MAX if the encoder could not be read
+                int32_t ticks = INT32_MAX;
+                AngularVelocity velocity = 0_radps;
+        };
+
+        struct Sweep {
+                std::array<Reading, MAX_ENCODERS> readings {};
+        };
+
+        struct Channel {
+                // only constructed once, by addEncoder, before the channel is published
+                std::optional<pros::adi::Encoder> encoder;
+                std::optional<PortClaim> topClaim;
+                std::optional<PortClaim> bottomClaim;
+                uint8_t topPort = 0;
+                // only touched by update
+                TickVelocityEstimator velocityEstimator;
+        };
+
+        /**
+         * @brief Sweep the group if the latest sweep is older than the update period, and get the latest sweep
+         *
+         * @return Sweep the latest sweep
+         */
+        Sweep refresh();
+
+        uint8_t m_expanderPort;
+        // adding encoders is locked, as addEncoder can be called from more than one task
+        pros::Mutex m_mutex;
+        std::array<Channel, MAX_ENCODERS> m_channels;
+        // channels are filled in before the count is incremented, so update only sees complete channels
+        std::atomic<size_t> m_count = 0;
+        DoubleBuffer<Sweep> m_sweep;
+        DoubleBuffer<TickVelocitySettings> m_velocitySettings;
+        // when the latest sweep was taken, in milliseconds
+        std::atomic<uint32_t> m_updateTime = 0;
+        std::atomic<uint32_t> m_updatePeriod = 10;
+        std::atomic<bool> m_updated = false;
+        std::atomic<bool> m_updating = false;
+};
+
+/**
+ * @brief Encoder implementation for an Optical Shaft Encoder on an ADIExpanderGroup
+ *
+ * The encoder reads from the sweeps of its group, so every encoder of the group is sampled at the same time.
+ */
+class ADIExpanderEncoder : public Encoder {
+    public:
+        /**
+         * @brief Construct a new ADI Expander Encoder, and add it to a group
+         *
+         * If the encoder can't be added to the group, every read of the encoder fails, setting errno to the error of
+         * ADIExpanderGroup::addEncoder.
+         *
+         * @param group the group of the ADI expander the encoder is plugged into. It must outlive the encoder, so it
+         * should be constructed first
+         * @param ports the two ports of the optical shaft encoder (1-8, 'a'-'h', 'A'-'H')
+         * @param reversed whether the encoder is reversed or not
+         *
+         * @b Example:
+         * @code {.cpp}
+         * lemlib::ADIExpanderGroup expander(2);
+         * // optical shaft encoder on ports 'c' and 'd' of the expander on port 2, which is not reversed
+         * lemlib::ADIExpanderEncoder encoder(expander, {'c', 'd'}, false);
+         * @endcode
+         */
+        ADIExpanderEncoder(ADIExpanderGroup& group, ADIPair ports, bool reversed);
+        /**
+         * @brief Construct a new ADI Expander Encoder, which reads the same encoder as another
+         *
+         * @param other the encoder to copy, including its offset
+         */
+        ADIExpanderEncoder(const ADIExpanderEncoder& other);
+        /**
+         * @brief Check if the ADI expander of the encoder is plugged in
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the expander is not plugged in
+         *
+         * @return 1 the expander is plugged in
+         * @return INT_MAX the expander is not plugged in, or the encoder is not part of the group, setting errno
+         */
+        int32_t isConnected() const override;
+        /**
+         * @brief Get the angle of the encoder, as of the latest sweep of its group
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the encoder could not be read
+         *
+         * @return Angle the angle of the encoder
+         * @return INFINITY on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     const Angle angle = encoder.getAngle();
+         *     if (angle.internal() == INFINITY) std::cout << "Could not read the encoder" << std::endl;
+         * }
+         * @endcode
+         */
+        Angle getAngle() const override;
+        /**
+         * @brief Set the angle of the encoder
+         *
+         * The encoder is shared with the other encoders reading the same ports, so it is not reset. The angle is saved
+         * as an offset from the latest sweep instead.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the encoder could not be read
+         *
+         * @param angle the new angle
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     encoder.setAngle(0_stDeg);
+         * }
+         * @endcode
+         */
+        int32_t setAngle(Angle angle) override;
+        /**
+         * @brief Get the velocity of the encoder, as of the latest sweep of its group
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the encoder could not be read
+         *
+         * @return AngularVelocity the velocity of the encoder
+         * @return INFINITY on failure, setting errno
+         */
+        AngularVelocity getVelocity() const;
+    private:
+        ADIExpanderGroup& m_group;
+        // the index in the group, or INT_MAX if the encoder could not be added, in which case m_error is why
+        int32_t m_index;
+        int m_error = 0;
+        std::atomic<Angle> m_offset = 0_stDeg;
+};
+} // namespace lemlib
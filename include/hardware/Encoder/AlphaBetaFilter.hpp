@@ -0,0 +1,142 @@
+#pragma once
+
+#include "units/Angle.hpp"
+
+namespace lemlib {
+/**
+ * @brief The gains of an AlphaBetaFilter
+ *
+ * Larger gains follow the measurements more closely, with less delay and more noise. Setting gamma to 0 turns the
+ * filter into a plain alpha-beta filter, which assumes the velocity is constant between samples and never estimates an
+ * acceleration. The default gains are criticallyDamped(0.7).
+ */
+struct AlphaBetaGains {
+        /** how much of the position error is corrected every sample */
+        double alpha = 0.657;
+        /** how much of the position error is used to correct the velocity every sample */
+        double beta = 0.2295;
+        /** how much of the position error is used to correct the acceleration every sample */
+        double gamma = 0.0135;
+
+        /**
+         * @brief Find gains which don't overshoot a change in acceleration by more than necessary
+         *
+         * These are the gains of a critically damped filter, where every estimate fades the weight of older samples
+         * by the same factor
+         *
+         * @param smoothing how much weight older samples keep, from 0 to 1. Larger values are smoother, but respond
+         * later
+         * @return AlphaBetaGains the gains
+         *
+         * @b Example:
+         * @code {.cpp}
+         * lemlib::AlphaBetaFilter filter(lemlib::AlphaBetaGains::criticallyDamped(0.8));
+         * @endcode
+         */
+        static constexpr AlphaBetaGains criticallyDamped(double smoothing) {
+            const double remaining = 1 - smoothing;
+            return {.alpha = 1 - smoothing * smoothing * smoothing,
+                    .beta = 1.5 * (1 - smoothing * smoothing) * remaining,
+                    .gamma = remaining * remaining * remaining / 2};
+        }
+};
+
+/**
+ * @brief An alpha-beta-gamma filter, which estimates the velocity and acceleration of an angle
+ *
+ * Differencing angle samples amplifies the noise of every sample, and their quantization. This filter predicts the
+ * next angle from the current estimates, and corrects the estimates by a fraction of the difference between the
+ * prediction and the measurement. Every sample takes a constant amount of work and no extra memory, no matter how
+ * smooth the filter is, and the samples don't have to be evenly spaced.
+ *
+ * This class is not thread safe.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::AlphaBetaFilter filter;
+ * lemlib::V5RotationSensor encoder(1);
+ *
+ * void opcontrol() {
+ *     while (true) {
+ *         filter.update(from_usec(pros::micros()), encoder.getAngle());
+ *         std::cout << to_rpm(filter.getVelocity()) << std::endl;
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class AlphaBetaFilter {
+    public:
+        /**
+         * @brief Construct a new Alpha Beta Filter
+         *
+         * @param gains the gains of the filter
+         */
+        AlphaBetaFilter(AlphaBetaGains gains = {});
+        /**
+         * @brief Add a measurement to the filter
+         *
+         * The first measurement initializes the angle, with no velocity or acceleration. Measurements which are not
+         * newer than the previous measurement are ignored, so a reading that hasn't been updated by the device yet can
+         * be passed again without distorting the estimates.
+         *
+         * @param timestamp the time the angle was measured
+         * @param angle the measured angle
+         */
+        void update(Time timestamp, Angle angle);
+        /**
+         * @brief Discard every measurement, for example when the device disconnects
+         */
+        void reset();
+        /**
+         * @brief Scale the estimates, so they match measurements that are scaled by the same factor from now on
+         *
+         * @param factor the factor to scale by
+         */
+        void rescale(Number factor);
+        /**
+         * @brief Set the gains of the filter. The estimates are kept
+         *
+         * @param gains the new gains
+         */
+        void setGains(AlphaBetaGains gains);
+        /**
+         * @brief Get the gains of the filter
+         *
+         * @return AlphaBetaGains the gains
+         */
+        AlphaBetaGains getGains() const;
+        /**
+         * @brief Get whether the filter has been given a measurement since it was constructed or reset
+         *
+         * @return true the estimates are valid
+         * @return false there are no estimates
+         */
+        bool isInitialized() const;
+        /**
+         * @brief Get the estimated angle
+         *
+         * @return Angle the angle, or 0 if the filter has not been given a measurement
+         */
+        Angle getAngle() const;
+        /**
+         * @brief Get the estimated velocity
+         *
+         * @return AngularVelocity the velocity, or 0 if the filter has not been given two measurements
+         */
+        AngularVelocity getVelocity() const;
+        /**
+         * @brief Get the estimated acceleration
+         *
+         * @return AngularAcceleration the acceleration, or 0 if the filter has not been given two measurements
+         */
+        AngularAcceleration getAcceleration() const;
+    private:
+        AlphaBetaGains m_gains;
+        bool m_initialized = false;
+        Time m_timestamp = 0_sec;
+        Angle m_angle = 0_stDeg;
+        AngularVelocity m_velocity = 0_radps;
+        AngularAcceleration m_acceleration = 0_radps2;
+};
+} // namespace lemlib
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "hardware/Encoder/CompositeEncoder.hpp"
+
+namespace lemlib {
+/**
+ * @brief An encoder which measures the average angle of several encoders
+ *
+ * Useful for a pair of parallel tracking wheels, or the two sides of a mechanism driven from both ends. Every encoder
+ * is read in the same critical section, see CompositeEncoder.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::V5RotationSensor leftWheel(1);
+ * lemlib::V5RotationSensor rightWheel(2);
+ * lemlib::AverageEncoder forward({&leftWheel, &rightWheel});
+ *
+ * void opcontrol() {
+ *     while (true) {
+ *         std::cout << "Forward: " << to_stDeg(forward.getAngle()) << std::endl;
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class AverageEncoder : public CompositeEncoder {
+    public:
+        /**
+         * @brief Construct a new Average Encoder
+         *
+         * @param encoders the encoders to average. They must outlive the average encoder
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::AverageEncoder forward({&leftWheel, &rightWheel});
+         * }
+         * @endcode
+         */
+        AverageEncoder(std::initializer_list<Encoder*> encoders);
+    protected:
+        Angle combine(std::span<const Angle> angles) const override;
+};
+} // namespace lemlib
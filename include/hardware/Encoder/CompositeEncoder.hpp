@@ -0,0 +1,120 @@
+#pragma once
+
+#include "hardware/DeviceMutex.hpp"
+#include "hardware/Encoder/Encoder.hpp"
+#include <atomic>
+#include <initializer_list>
+#include <span>
+#include <vector>
+
+namespace lemlib {
+/**
+ * @brief An encoder whose angle is calculated from the angles of other encoders
+ *
+ * Calling getAngle on every encoder separately gives no guarantee that they are read at the same time, or that every
+ * task sees the same combination. A composite encoder reads all of its encoders back to back, while holding its mutex,
+ * and keeps the result for the update period, so every task which reads it within the same cycle gets the same angle,
+ * calculated once.
+ *
+ * The angle fails to be read if any of the encoders fails to be read, rather than jumping to a combination of the
+ * rest.
+ */
+class CompositeEncoder : public Encoder {
+    public:
+        /**
+         * @brief Construct a new Composite Encoder
+         *
+         * @param encoders the encoders to combine. They must outlive the composite encoder
+         */
+        CompositeEncoder(std::initializer_list<Encoder*> encoders);
+        /**
+         * @brief CompositeEncoder copy constructor
+         *
+         * The copy combines the same encoders, with the same offset
+         *
+         * @param other the composite encoder to copy
+         */
+        CompositeEncoder(const CompositeEncoder& other);
+        /**
+         * @brief whether every encoder is connected
+         *
+         * @return 1 every encoder is connected
+         * @return 0 at least one encoder is not connected
+         */
+        int32_t isConnected() const override;
+        /**
+         * @brief Get the combined angle
+         *
+         * The encoders are read again if the latest reading is older than the update period.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: at least one of the encoders could not be read
+         *
+         * @return Angle the combined angle
+         * @return INFINITY on failure, setting errno
+         */
+        Angle getAngle() const override;
+        /**
+         * @brief Set the combined angle
+         *
+         * The encoders are not changed, as they may be used on their own too. The angle is saved as an offset from the
+         * combination of their current angles instead.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: at least one of the encoders could not be read
+         *
+         * @param angle the new angle
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t setAngle(Angle angle) override;
+        /**
+         * @brief Set how long a combined angle is used for before the encoders are read again
+         *
+         * @param period the period, rounded to whole milliseconds. Defaults to 0, which reads the encoders on every
+         * call to getAngle. Set it to the period of the control loop so the angle is only calculated once per cycle
+         * @return int32_t always returns 0
+         */
+        int32_t setUpdatePeriod(Time period);
+        /**
+         * @brief Get how long a combined angle is used for before the encoders are read again
+         *
+         * @return Time the period
+         */
+        Time getUpdatePeriod() const;
+        virtual ~CompositeEncoder() = default;
+    protected:
+        /**
+         * @brief Combine the angles of the encoders
+         *
+         * This is called with the mutex held, and must not block or allocate.
+         *
+         * @param angles the angle of every encoder, in the order they were passed to the constructor. None of them
+         * are INFINITY
+         * @return Angle the combined angle
+         */
+        virtual Angle combine(std::span<const Angle> angles) const = 0;
+    private:
+        /**
+         * @brief Get the combined angle without the offset, reading the encoders if the latest reading is too old
+         *
+         * @param force whether to read the encoders even if the latest reading is not too old
+         * @return Angle the combined angle, or INFINITY if an encoder could not be read, setting errno
+         */
+        Angle readCombined(bool force) const;
+
+        std::vector<Encoder*> m_encoders;
+        // serializes reading the encoders, so every task gets the same reading
+        mutable DeviceMutex m_mutex;
+        // only touched with the mutex held
+        mutable std::vector<Angle> m_angles;
+        mutable Angle m_combined = 0_stDeg;
+        mutable int m_error = 0;
+        mutable bool m_read = false;
+        mutable uint32_t m_readTime = 0;
+        std::atomic<uint32_t> m_updatePeriod = 0;
+        std::atomic<Angle> m_offset = 0_stDeg;
+};
+} // namespace lemlib
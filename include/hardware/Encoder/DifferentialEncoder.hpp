@@ -0,0 +1,78 @@
+#pragma once
+
+#include "hardware/Encoder/CompositeEncoder.hpp"
+
+namespace lemlib {
+/**
+ * @brief An encoder which measures the difference between the angles of two encoders
+ *
+ * With the encoders of a left and a right tracking wheel, and the size of the wheels and the distance between them,
+ * the angle is the heading of the robot, measured from the wheels alone. Both encoders are read in the same critical
+ * section, see CompositeEncoder, so a heading is never calculated from a left reading and a right reading of different
+ * cycles.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::V5RotationSensor leftWheel(1);
+ * lemlib::V5RotationSensor rightWheel(2);
+ * // 2.75 inch wheels, 10 inches apart
+ * lemlib::DifferentialEncoder wheelHeading(leftWheel, rightWheel, 2.75_in, 10_in);
+ *
+ * void opcontrol() {
+ *     while (true) {
+ *         std::cout << "Heading: " << to_stDeg(wheelHeading.getAngle()) << std::endl;
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class DifferentialEncoder : public CompositeEncoder {
+    public:
+        /**
+         * @brief Construct a new Differential Encoder
+         *
+         * The angle is (right - left) * scale.
+         *
+         * @param left the encoder which is subtracted. It must outlive the differential encoder
+         * @param right the encoder which is added. It must outlive the differential encoder
+         * @param scale the ratio between the difference of the two encoders and the angle. Defaults to 1
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     // the difference between the two halves of a differential
+         *     lemlib::DifferentialEncoder twist(leftHalf, rightHalf, 0.5);
+         * }
+         * @endcode
+         */
+        DifferentialEncoder(Encoder& left, Encoder& right, double scale = 1);
+        /**
+         * @brief Construct a new Differential Encoder which measures the heading of a robot from two tracking wheels
+         *
+         * The angle is counterclockwise positive, when the wheels measure positive angles as the robot drives forwards.
+         *
+         * @param left the encoder of the left tracking wheel. It must outlive the differential encoder
+         * @param right the encoder of the right tracking wheel. It must outlive the differential encoder
+         * @param wheelDiameter the diameter of the tracking wheels
+         * @param trackWidth the distance between the centers of the tracking wheels
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::DifferentialEncoder wheelHeading(leftWheel, rightWheel, 2.75_in, 10_in);
+         * }
+         * @endcode
+         */
+        DifferentialEncoder(Encoder& left, Encoder& right, Length wheelDiameter, Length trackWidth);
+        /**
+         * @brief Get the ratio between the difference of the two encoders and the angle
+         *
+         * @return double the scale
+         */
+        double getScale() const;
+    protected:
+        Angle combine(std::span<const Angle> angles) const override;
+    private:
+        const double m_scale;
+};
+} // namespace lemlib
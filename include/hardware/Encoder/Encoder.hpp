@@ -1,7 +1,9 @@
 #pragma once
 
 #include "hardware/Device.hpp"
+#include "hardware/Result.hpp"
 #include "units/Angle.hpp"
+#include <concepts>
 
 namespace lemlib {
 /**
@@ -35,6 +37,30 @@ class Encoder : public Device {
          * @endcode
          */
         virtual Angle getAngle() const = 0;
+        /**
+         * @brief Get the relative angle measured by the encoder, or the error which prevented reading it
+         *
+         * Errors are returned in the result instead of by setting errno, so checking for them is an integer test
+         * instead of comparing the angle with INFINITY. The default implementation converts the result of getAngle.
+         * The device implementations override it, so a successful read never touches errno.
+         *
+         * @return Result<Angle> the relative angle, or the error, like a value of errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     Encoder* encoder;
+         *     const lemlib::Result<Angle> angle = encoder->tryGetAngle();
+         *     if (angle.ok()) std::cout << "Relative angle: " << angle.value().convert(deg) << std::endl;
+         * }
+         * @endcode
+         */
+        virtual Result<Angle> tryGetAngle() const {
+            const Angle angle = getAngle();
+            if (angle == from_stDeg(INFINITY)) [[unlikely]]
+                return Result<Angle>::failure(errno);
+            return angle;
+        }
         /**
          * @brief Set the relative angle of the encoder
          *
@@ -61,4 +87,25 @@ class Encoder : public Device {
         virtual int32_t setAngle(Angle angle) = 0;
         virtual ~Encoder() = default;
 };
+
+/**
+ * @brief A type which can be read like an Encoder
+ *
+ * Code which reads encoders in a hot loop can take an EncoderLike template parameter instead of an Encoder reference.
+ * When it is instantiated with a final implementation, like V5RotationSensor or MockEncoder, the read is a direct
+ * call which can be inlined, instead of a virtual call. Encoder itself satisfies the concept, so the same code still
+ * works through the interface when the type is only known at runtime.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * template <lemlib::EncoderLike E> Length wheelTravel(const E& encoder, Length diameter) {
+ *     return to_stRot(encoder.getAngle()) * diameter * M_PI;
+ * }
+ * @endcode
+ */
+template <typename E>
+concept EncoderLike = requires(const E& encoder) {
+    { encoder.getAngle() } -> std::same_as<Angle>;
+    { encoder.isConnected() } -> std::convertible_to<int32_t>;
+};
 } // namespace lemlib
\ No newline at end of file
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "units/Angle.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief A sample of an encoder, taken by a DevicePoller
+ */
+struct EncoderSample {
+        /** the time the sample was taken, measured since the program started */
+        Time timestamp = 0_sec;
+        /** the angle of the encoder. INFINITY if it could not be read */
+        Angle angle = from_stDeg(INFINITY);
+        /** whether the encoder was connected when the sample was taken */
+        bool connected = false;
+};
+
+/**
+ * @brief The storage independent part of EncoderHistory
+ *
+ * DevicePoller feeds histories through this class, so it doesn't need to know their capacity. Use EncoderHistory to
+ * create a history.
+ */
+class EncoderHistoryBase {
+    public:
+        EncoderHistoryBase(const EncoderHistoryBase& other) = delete;
+        EncoderHistoryBase& operator=(const EncoderHistoryBase& other) = delete;
+        /**
+         * @brief Add a sample to the history, replacing the oldest sample if the history is full
+         *
+         * Only one task may push samples. This is normally the DevicePoller task.
+         *
+         * @param sample the sample to add
+         */
+        void push(const EncoderSample& sample);
+        /**
+         * @brief Get a sample from the history
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: there are not enough samples in the history
+         *
+         * @param age how many samples ago the sample was taken. 0 is the latest sample
+         * @return EncoderSample the sample. The angle is INFINITY on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     const lemlib::EncoderSample previous = history.getSample(1);
+         * }
+         * @endcode
+         */
+        EncoderSample getSample(size_t age) const;
+        /**
+         * @brief Get the angle of the encoder at a time, interpolated between the two samples around it
+         *
+         * Encoders are sampled one after another, so two histories hold samples taken at slightly different times.
+         * Reading both at the same time lines them up. This function does not lock, and can be called from any task.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the history is empty
+         * ERANGE: the time is older than the oldest sample, or newer than the latest sample
+         *
+         * @param timestamp the time, since the program started
+         * @return Angle the angle at that time
+         * @return INFINITY on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     // the angle of the left wheel when the right wheel was last sampled
+         *     const Angle left = leftHistory.getAngle(rightHistory.getSample(0).timestamp);
+         * }
+         * @endcode
+         */
+        Angle getAngle(Time timestamp) const;
+        /**
+         * @brief Get the number of samples in the history
+         *
+         * @return size_t the number of samples, which is never more than the capacity
+         */
+        size_t getSize() const;
+        /**
+         * @brief Get the maximum number of samples the history can hold
+         *
+         * @return size_t the capacity
+         */
+        size_t getCapacity() const;
+        /**
+         * @brief Get the velocity of the encoder, using the two latest samples
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: there are less than two samples in the history
+         *
+         * @return AngularVelocity the velocity
+         * @return INFINITY on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     std::cout << to_rpm(history.getVelocity()) << std::endl;
+         * }
+         * @endcode
+         */
+        AngularVelocity getVelocity() const;
+        /**
+         * @brief Get the acceleration of the encoder, using the three latest samples
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: there are less than three samples in the history
+         *
+         * @return AngularAcceleration the acceleration
+         * @return INFINITY on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     std::cout << to_rps2(history.getAcceleration()) << std::endl;
+         * }
+         * @endcode
+         */
+        AngularAcceleration getAcceleration() const;
+    protected:
+        /**
+         * @brief Construct a new Encoder History Base
+         *
+         * @param storage the storage for the samples. It must outlive the history
+         * @param capacity the number of samples the storage can hold. One more than the number of readable samples
+         */
+        EncoderHistoryBase(EncoderSample* storage, size_t capacity);
+    private:
+        /**
+         * @brief Copy the latest samples, retrying if the writer overwrote them while they were copied
+         *
+         * @param out where to copy the samples to. out[0] is the latest sample
+         * @param count the number of samples to copy
+         * @return true if there were enough samples
+         */
+        bool readLatest(EncoderSample* out, size_t count) const;
+
+        EncoderSample* const m_storage;
+        // the size of the storage. One slot is reserved for the writer, so a sample is never read while it is written
+        const size_t m_capacity;
+        // the total number of samples pushed. The latest sample is at (m_head - 1) % m_capacity
+        std::atomic<uint32_t> m_head = 0;
+};
+
+/**
+ * @brief A fixed-size ring of timestamped encoder samples
+ *
+ * Register an EncoderHistory with DevicePoller::addEncoder to have it filled once per poller period. The samples are
+ * stored inside the object, so the history never allocates memory. Reading is lock-free, and the latest samples can
+ * be read in constant time.
+ *
+ * @tparam N the maximum number of samples to keep
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::V5RotationSensor encoder(1);
+ * lemlib::EncoderHistory<16> history;
+ * lemlib::DevicePoller poller;
+ *
+ * void initialize() {
+ *     poller.addEncoder(encoder, history);
+ *     poller.start();
+ *     while (true) {
+ *         std::cout << to_rpm(history.getVelocity()) << std::endl;
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+template <size_t N> class EncoderHistory : public EncoderHistoryBase {
+        static_assert(N >= 3, "EncoderHistory needs at least 3 samples to calculate acceleration");
+    public:
+        /**
+         * @brief Construct a new, empty Encoder History
+         */
+        EncoderHistory()
+            : EncoderHistoryBase(m_samples.data(), N + 1) {}
+    private:
+        std::array<EncoderSample, N + 1> m_samples;
+};
+} // namespace lemlib
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "hardware/ReadCache.hpp"
+#include "units/Angle.hpp"
+#include <climits>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief A raw reading of an encoder, with the scale and offset which convert it to an angle
+ *
+ * getAngle converts the reading and adds the offset on every call. A position only does that when angle is called, so
+ * code which only needs how far an encoder moved, like odometry, can subtract two positions instead. The difference
+ * is taken between the integer readings, so the offsets cancel without being added, and it is scaled with a single
+ * multiply.
+ *
+ * The scale and offset are copied from the device when the position is read, so a position always converts the same
+ * way, even if the device is reversed or its offset is set afterwards.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * void opcontrol() {
+ *     lemlib::V5RotationSensor encoder(1);
+ *     lemlib::EncoderPosition last = encoder.getPosition();
+ *     while (true) {
+ *         const lemlib::EncoderPosition position = encoder.getPosition();
+ *         const Angle moved = position - last;
+ *         last = position;
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class EncoderPosition {
+    public:
+        /**
+         * @brief Construct a new Encoder Position
+         *
+         * @param reading the raw reading of the encoder. Its value is INT_MAX if the encoder could not be read
+         * @param scale the scale which converts the raw value to an angle, including any reversal
+         * @param offset the angle added after the raw value is scaled
+         */
+        constexpr EncoderPosition(RawReading reading, units::Scale<Angle> scale, Angle offset)
+            : m_reading(reading),
+              m_scale(scale),
+              m_offset(offset) {}
+
+        /**
+         * @brief whether the encoder was read successfully
+         *
+         * @return true the reading is valid
+         * @return false the encoder could not be read, and angle returns INFINITY
+         */
+        constexpr bool isValid() const { return m_reading.value != INT_MAX; }
+
+        /**
+         * @brief Convert the position to an angle, like getAngle does
+         *
+         * @return Angle the angle, or INFINITY if the encoder could not be read
+         */
+        constexpr Angle angle() const {
+            if (!isValid()) return from_stRot(INFINITY);
+            return m_scale(m_reading.value) + m_offset;
+        }
+
+        /**
+         * @brief Get the raw reading, before the scale and offset
+         *
+         * @return RawReading the reading and when it was taken
+         */
+        constexpr RawReading raw() const { return m_reading; }
+
+        /**
+         * @brief Get how far the encoder moved since another position
+         *
+         * When both positions were read with the same scale, the raw readings are subtracted as integers and scaled
+         * once, and the offsets aren't used. The subtraction wraps around like the raw readings do, so it is correct
+         * across a wraparound of the raw count. Otherwise, like when the encoder was reversed in between, both positions
+         * are converted to angles first. Setting the angle of the encoder in between only changes its offset, so it
+         * doesn't count as movement, unless the device resets its count, like ADIEncoder::resetCount does.
+         *
+         * @param other the earlier position
+         * @return Angle the angle the encoder moved, or INFINITY if either position is invalid
+         */
+        constexpr Angle operator-(const EncoderPosition& other) const {
+            if (!isValid() || !other.isValid()) return from_stRot(INFINITY);
+            if (m_scale.factor() != other.m_scale.factor()) return angle() - other.angle();
+            return m_scale(int32_t(uint32_t(m_reading.value) - uint32_t(other.m_reading.value)));
+        }
+    private:
+        RawReading m_reading;
+        units::Scale<Angle> m_scale;
+        Angle m_offset;
+};
+} // namespace lemlib
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "hardware/Encoder/Encoder.hpp"
+#include <errno.h>
+
+namespace lemlib {
+/**
+ * @brief Encoder implementation which reads an angle set by the program, instead of a device
+ *
+ * Every function is defined in the header, and the class is final, so code which calls a MockEncoder through its own
+ * type compiles the read down to a load and an add, while code which calls it through an Encoder reference still pays
+ * for the virtual call. That makes it useful for measuring the cost of device polymorphism separately from the cost
+ * of the SDK, and for testing code which reads encoders without the simulator.
+ *
+ * Unlike the device implementations, a mock encoder is not thread safe.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::MockEncoder encoder;
+ * encoder.setReading(90_stDeg);
+ * Angle angle = encoder.getAngle(); // 90 degrees
+ * @endcode
+ */
+class MockEncoder final : public Encoder {
+    public:
+        /**
+         * @brief Construct a new, connected Mock Encoder
+         *
+         * @param reading the angle the encoder reads before an offset is set. Defaults to 0
+         */
+        MockEncoder(Angle reading = 0_stDeg)
+            : m_reading(reading) {}
+
+        /**
+         * @brief whether the mock is connected
+         *
+         * @return 0 if it was disconnected with setConnected
+         * @return 1 if it is connected
+         */
+        int32_t isConnected() const override { return m_connected; }
+
+        /**
+         * @brief Get the reading plus the offset set by setAngle
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the mock is disconnected
+         *
+         * @return Angle the angle, or INFINITY if an error occurred, setting errno
+         */
+        Angle getAngle() const override {
+            if (!m_connected) {
+                errno = ENODEV;
+                return from_stRot(INFINITY);
+            }
+            return m_reading + m_offset;
+        }
+
+        /**
+         * @brief Set the angle the encoder reads, by changing its offset
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the mock is disconnected
+         *
+         * @param angle the angle to set it to
+         * @return 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t setAngle(Angle angle) override {
+            if (!m_connected) {
+                errno = ENODEV;
+                return INT32_MAX;
+            }
+            m_offset = angle - m_reading;
+            return 0;
+        }
+
+        /**
+         * @brief Set the raw angle the mock reads, like a device measuring a new angle
+         *
+         * @param reading the angle, before the offset
+         */
+        void setReading(Angle reading) { m_reading = reading; }
+
+        /**
+         * @brief Connect or disconnect the mock
+         *
+         * @param connected whether the mock is connected
+         */
+        void setConnected(bool connected) { m_connected = connected; }
+    private:
+        Angle m_reading;
+        Angle m_offset = 0_stDeg;
+        bool m_connected = true;
+};
+} // namespace lemlib
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "hardware/DeviceMutex.hpp"
+#include "hardware/Encoder/Encoder.hpp"
+#include "hardware/ReplayLog.hpp"
+#include "pros/rtos.hpp"
+#include <atomic>
+
+namespace lemlib {
+/**
+ * @brief Encoder implementation which plays back the angle of an encoder recorded by TelemetryLogger
+ *
+ * The angle is the latest record of the encoder at the playback time of the log, held until the next record, like a
+ * real sensor between updates.
+ */
+class ReplayEncoder : public Encoder {
+    public:
+        /**
+         * @brief Construct a new Replay Encoder
+         *
+         * @param log the log to play back. It must outlive the encoder
+         * @param device the id the encoder was logged with, by TelemetryLogger::logEncoder
+         *
+         * @b Example:
+         * @code {.cpp}
+         * lemlib::ReplayLog log;
+         * lemlib::ReplayEncoder encoder(log, 1);
+         * @endcode
+         */
+        ReplayEncoder(const ReplayLog& log, uint16_t device);
+        /**
+         * @brief ReplayEncoder copy constructor
+         *
+         * @param other the ReplayEncoder to copy
+         */
+        ReplayEncoder(const ReplayEncoder& other);
+        /**
+         * @brief whether the encoder was connected at the playback time
+         *
+         * @return 0 if it was not connected, or no record of it has been played yet
+         * @return 1 if it was connected
+         */
+        int32_t isConnected() const override;
+        /**
+         * @brief Get the recorded angle at the playback time
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the encoder was not connected, or no record of it has been played yet
+         *
+         * @return Angle the angle, or INFINITY if an error occurred, setting errno
+         */
+        Angle getAngle() const override;
+        /**
+         * @brief Set the angle the encoder reads at the playback time
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the encoder was not connected, or no record of it has been played yet
+         *
+         * @param angle the angle to set it to
+         * @return 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t setAngle(Angle angle) override;
+    private:
+        /**
+         * @brief Read the recorded angle, before the offset is added
+         *
+         * @return Angle the angle, or INFINITY with errno set to ENODEV
+         */
+        Angle readAngle() const;
+
+        const ReplayLog& m_log;
+        const uint16_t m_device;
+        // serializes calls to setAngle. The offset is atomic, so reading the angle doesn't need the mutex
+        mutable DeviceMutex m_mutex;
+        std::atomic<Angle> m_offset = 0_stDeg;
+};
+} // namespace lemlib
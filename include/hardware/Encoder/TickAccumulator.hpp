@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief Extends the 32-bit tick count of a device to 64 bits
+ *
+ * The SDK reports the position of motors and ADI encoders as an int, which wraps around from INT_MAX to INT_MIN. The
+ * accumulator adds the difference between each reading and the last one, taken with wrapping arithmetic, to a 64-bit
+ * count, so the count keeps going past the range of an int. The count is only converted to an angle on output, and a
+ * double holds every count up to 2^53 exactly, so the precision of the angle doesn't depend on how long the program
+ * has been running.
+ *
+ * The low 32 bits of the count are always the last reading, so the whole state is a single 64-bit atomic, and any
+ * number of tasks can update it at once without locking. A wraparound is only missed if the device moves by more than
+ * 2^31 ticks between two readings, which takes days for any motor or encoder.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::TickAccumulator ticks;
+ *
+ * void opcontrol() {
+ *     while (true) {
+ *         const int64_t count = ticks.update(pros::c::motor_get_raw_position(1, NULL));
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class TickAccumulator {
+    public:
+        /**
+         * @brief Construct a new Tick Accumulator, which starts at 0
+         */
+        TickAccumulator() = default;
+
+        /**
+         * @brief Copy the count of another accumulator
+         *
+         * @param other the accumulator to copy
+         */
+        TickAccumulator(const TickAccumulator& other)
+            : m_count(other.m_count.load(std::memory_order_relaxed)) {}
+
+        /**
+         * @brief Copy the count of another accumulator
+         *
+         * @param other the accumulator to copy
+         * @return TickAccumulator& this accumulator
+         */
+        TickAccumulator& operator=(const TickAccumulator& other) {
+            m_count.store(other.m_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            return *this;
+        }
+
+        /**
+         * @brief Add the motion since the last reading to the count
+         *
+         * The reading must be valid. Readings of INT_MAX, which the SDK returns on failure, must not be passed.
+         *
+         * @param raw the tick count the SDK reported
+         * @return int64_t the extended count
+         */
+        int64_t update(int32_t raw) {
+            int64_t count = m_count.load(std::memory_order_relaxed);
+            while (true) {
+                // the difference of the low 32 bits, which is correct across a wraparound
+                const int64_t next = count + int32_t(uint32_t(raw) - uint32_t(count));
+                if (next == count || m_count.compare_exchange_weak(count, next, std::memory_order_relaxed)) {
+                    return next;
+                }
+            }
+        }
+
+        /**
+         * @brief Set the count, like when the device reset its own count
+         *
+         * @param count the new count. Its low 32 bits should match the next reading
+         */
+        void reset(int64_t count = 0) { m_count.store(count, std::memory_order_relaxed); }
+    private:
+        std::atomic<int64_t> m_count = 0;
+};
+} // namespace lemlib
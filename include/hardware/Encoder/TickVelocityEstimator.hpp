@@ -0,0 +1,103 @@
+#pragma once
+
+#include "units/Angle.hpp"
+
+namespace lemlib {
+/**
+ * @brief The settings of a TickVelocityEstimator
+ */
+struct TickVelocitySettings {
+        /**
+         * changes of at least this many ticks between two samples are measured from how far the encoder turned
+         * between the samples. Smaller changes are measured from the time between ticks
+         */
+        double highSpeedTicks = 4;
+        /** how long the encoder can go without a tick before it is considered stopped */
+        Time timeout = 250_msec;
+};
+
+/**
+ * @brief Estimates the velocity of an encoder with a coarse resolution, like the optical shaft encoder
+ *
+ * Differencing the angle of a 360 tick encoder every 10 ms can only measure velocities in steps of 16.7 rpm, so a
+ * tracking wheel crawling at 5 rpm reads 0 most of the time, and 16.7 rpm the rest. This estimator timestamps every
+ * sample where the count changes, and measures low velocities from the time between those changes instead, which
+ * resolves velocities far below a tick per sample. Each change is assumed to have happened halfway between the sample
+ * which saw it and the sample before, which halves the timing error of the polling.
+ *
+ * Above highSpeedTicks ticks per sample, the change of the count is precise enough on its own, and reacts faster. When
+ * no tick arrives, the velocity decays, as the encoder can't be turning faster than a tick over the time since the
+ * last one.
+ *
+ * Every sample takes a constant amount of work and no extra memory. This class is not thread safe.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::TickVelocityEstimator estimator(1_stDeg);
+ * lemlib::ADIEncoder encoder({'A', 'B'}, false);
+ *
+ * void opcontrol() {
+ *     while (true) {
+ *         estimator.update(from_usec(pros::micros()), encoder.getAngle());
+ *         std::cout << to_rpm(estimator.getVelocity()) << std::endl;
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class TickVelocityEstimator {
+    public:
+        /**
+         * @brief Construct a new Tick Velocity Estimator
+         *
+         * @param tick the angle of a single tick of the encoder. Defaults to 1 degree, the resolution of the optical
+         * shaft encoder
+         * @param settings the settings of the estimator
+         */
+        TickVelocityEstimator(Angle tick = 1_stDeg, TickVelocitySettings settings = {});
+        /**
+         * @brief Add a sample of the encoder
+         *
+         * The first sample initializes the estimator, with no velocity. Samples which are not newer than the previous
+         * sample are ignored.
+         *
+         * @param timestamp the time the angle was measured
+         * @param angle the measured angle
+         */
+        void update(Time timestamp, Angle angle);
+        /**
+         * @brief Discard every sample, for example when the encoder is reset
+         */
+        void reset();
+        /**
+         * @brief Set the settings of the estimator. The estimate is kept
+         *
+         * @param settings the settings
+         */
+        void setSettings(TickVelocitySettings settings);
+        /**
+         * @brief Get the settings of the estimator
+         *
+         * @return TickVelocitySettings the settings
+         */
+        TickVelocitySettings getSettings() const;
+        /**
+         * @brief Get the estimated velocity
+         *
+         * @return AngularVelocity the velocity, or 0 if the estimator has not been given a sample
+         */
+        AngularVelocity getVelocity() const;
+    private:
+        Angle m_tick;
+        TickVelocitySettings m_settings;
+        bool m_initialized = false;
+        // the latest sample
+        Time m_sampleTime = 0_sec;
+        Angle m_sampleAngle = 0_stDeg;
+        // the estimated time of the latest change of the count, and the angle after it
+        bool m_edgeKnown = false;
+        Time m_edgeTime = 0_sec;
+        Angle m_edgeAngle = 0_stDeg;
+        AngularVelocity m_velocity = 0_radps;
+};
+} // namespace lemlib
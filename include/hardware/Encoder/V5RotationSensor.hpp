@@ -1,15 +1,28 @@
 #pragma once
 
+#include "hardware/DeferredInit.hpp"
+#include "hardware/DeviceMutex.hpp"
+#include "hardware/DeviceRegistry.hpp"
+#include "hardware/DoubleBuffer.hpp"
 #include "hardware/Encoder/Encoder.hpp"
+#include "hardware/Encoder/EncoderPosition.hpp"
 #include "hardware/Port.hpp"
+#include "hardware/ReadCache.hpp"
+#include "hardware/SdkCallTracker.hpp"
 #include "pros/rotation.hpp"
+#include <atomic>
+#include <limits.h>
+#include <span>
+#include <vector>
 
 namespace lemlib {
 /**
  * @brief Encoder implementation for the V5 Rotation sensor
  *
+ * The class is final and getAngle is defined in the header, so code which reads a V5RotationSensor through its own
+ * type, or through an EncoderLike template parameter, inlines the offset and reversal math around the SDK call.
  */
-class V5RotationSensor : public Encoder {
+class V5RotationSensor final : public Encoder {
     public:
         /**
          * @brief Construct a new V5 Rotation Sensor
@@ -25,15 +38,41 @@ class V5RotationSensor : public Encoder {
          * @endcode
          */
         V5RotationSensor(ReversibleSmartPort port);
+        /**
+         * @brief Construct a new V5 Rotation Sensor without touching the hardware, so it can be declared constinit
+         *
+         * The sensor doesn't claim its port or configure the sensor until it is initialized, by initialize or
+         * initializeAll, and must not be used before then.
+         *
+         * @param port the signed port of the rotation sensor. Positive if the sensor is reversed, Negative otherwise
+         *
+         * @b Example:
+         * @code {.cpp}
+         * // constructed at compile time, instead of during static initialization
+         * constinit lemlib::V5RotationSensor encoder(-1, lemlib::deferred_init);
+         *
+         * void initialize() {
+         *     lemlib::initializeAll(encoder);
+         * }
+         * @endcode
+         */
+        constexpr V5RotationSensor(ReversibleSmartPort port, DeferredInit)
+            : m_mutex(deferred_init),
+              m_port(abs(port)),
+              m_config({.offset = 0_stRot, .reversed = port < 0}),
+              m_claim(deferred_init),
+              m_readCache(deferred_init) {}
         /**
          * @brief V5RotationSensor copy constructor
          *
-         * Because pros::Mutex does not have a copy constructor, an explicit
+         * Because DeviceMutex does not have a copy constructor, an explicit
          * copy constructor for the V5RotationSensor is necessary
          *
          * @param other the V5RotationSensor to copy
          */
         V5RotationSensor(const V5RotationSensor& other);
+        // the simulator only implements the PROS C api, so PROS objects can't be converted
+#ifndef LEMLIB_SIM
         /**
          * @brief Create a new V5 Rotation Sensor
          *
@@ -47,9 +86,46 @@ class V5RotationSensor : public Encoder {
          * @endcode
          */
         static V5RotationSensor from_pros_rot(pros::Rotation encoder);
+        /**
+         * @brief Create a V5 Rotation Sensor for every pros rotation sensor, in one pass
+         *
+         * The vector is reserved once. Like from_pros_rot, the reversal of every sensor is read from the SDK, as it is
+         * handled in software after the conversion.
+         *
+         * @param encoders the pros rotation sensors
+         * @return std::vector<V5RotationSensor> the sensors, in the same order
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     const std::array<pros::Rotation, 2> prosEncoders {pros::Rotation(1), pros::Rotation(-2)};
+         *     std::vector<lemlib::V5RotationSensor> encoders = lemlib::V5RotationSensor::from_pros_rots(prosEncoders);
+         * }
+         * @endcode
+         */
+        static std::vector<V5RotationSensor> from_pros_rots(std::span<const pros::Rotation> encoders);
+#endif
+        /**
+         * @brief Claim the port of a sensor constructed with deferred_init, and configure the sensor
+         *
+         * Call this once, before the sensor is used. Sensors constructed without deferred_init are initialized by
+         * their constructor.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENXIO: the port is not within the range of valid ports (1-21)
+         * ENODEV: the port cannot be configured as a V5 Rotation sensor
+         *
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno. The sensor is still usable once it is plugged in
+         */
+        int32_t initialize();
         /**
          * @brief whether the V5 Rotation Sensor is connected
          *
+         * The connection is read from the latest snapshot of the DeviceRegistry, so this is only a lookup, and can be up
+         * to one scan period old
+         *
          * @return 0 if its not connected
          * @return 1 if it is connected
          *
@@ -96,7 +172,22 @@ class V5RotationSensor : public Encoder {
          * }
          * @endcode
          */
-        Angle getAngle() const override;
+        Angle getAngle() const override { return tryGetAngle().orSentinel(from_stRot(INFINITY)); }
+        /**
+         * @brief Get the relative angle measured by the V5 Rotation Sensor, or the error which prevented reading it
+         *
+         * The raw reading is checked as an integer, and errno is only read if it failed.
+         *
+         * @return Result<Angle> the relative angle, or the error set by the SDK
+         */
+        Result<Angle> tryGetAngle() const override {
+            const Config config = m_config.read();
+            const int32_t raw =
+                m_readCache.get([&] { return LEMLIB_SDK_CALL(m_port, pros::c::rotation_get_position(m_port)); });
+            if (raw == INT_MAX) [[unlikely]]
+                return Result<Angle>::failure(errno);
+            return rawToAngle(raw, config.reversed) + config.offset;
+        }
         /**
          * @brief Set the relative angle of the V5 Rotation Sensor
          *
@@ -125,6 +216,36 @@ class V5RotationSensor : public Encoder {
          * }
          * @endcode
          */
+        /**
+         * @brief Get the raw position of the V5 Rotation Sensor, in centidegrees, and when it was read
+         *
+         * The position is the one getAngle converts, before the reversal and the offset are applied, so it doesn't
+         * change direction when setReversed is called. The reading goes through the same cache as getAngle.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENXIO: the port is not within the range of valid ports (1-21)
+         * ENODEV: the port cannot be configured as an V5 Rotation sensor
+         *
+         * @return RawReading the position and when it was read. The value is INT_MAX if there is an error, setting
+         * errno
+         */
+        RawReading getRaw() const {
+            return m_readCache.getReading(
+                [&] { return LEMLIB_SDK_CALL(m_port, pros::c::rotation_get_position(m_port)); });
+        }
+        /**
+         * @brief Get the position of the V5 Rotation Sensor, which is converted to an angle only when it is needed
+         *
+         * The position holds the same reading as getRaw, and the scale and offset getAngle would apply to it.
+         * Subtracting two positions gives the angle the sensor moved without converting either of them.
+         *
+         * @return EncoderPosition the position. It is invalid if there is an error, setting errno like getRaw
+         */
+        EncoderPosition getPosition() const {
+            const Config config = m_config.read();
+            return EncoderPosition(getRaw(), config.reversed ? CENTIDEGREES * Number(-1) : CENTIDEGREES, config.offset);
+        }
         int32_t setAngle(Angle angle) override;
         /**
          * @brief returns whether the V5 Rotation Sensor is reversed or not
@@ -149,28 +270,143 @@ class V5RotationSensor : public Encoder {
         /**
          * @brief Set whether the V5 Rotation Sensor is reversed or not
          *
+         * Reversal is handled in software, so this function does not communicate with the sensor and can't fail
+         *
+         * @return 0 on success
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::V5RotationSensor encoder = pros::Rotation(1);
+         *     // reverse the encoder
+         *     encoder.setReversed(true);
+         * }
+         * @endcode
+         */
+        int32_t setReversed(bool reversed);
+        /**
+         * @brief Get the angular velocity measured by the V5 Rotation Sensor
+         *
+         * The velocity is measured by the sensor itself, so it isn't delayed by differentiating angles read by the
+         * program. It is updated at the data rate of the sensor. Like getAngle, it is negated if the sensor is
+         * reversed.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENXIO: the port is not within the range of valid ports (1-21)
+         * ENODEV: the port cannot be configured as an V5 Rotation sensor
+         *
+         * @return AngularVelocity the angular velocity
+         * @return INFINITY if there is an error, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     lemlib::V5RotationSensor encoder(1);
+         *     std::cout << "velocity: " << to_rpm(encoder.getVelocity()) << std::endl;
+         * }
+         * @endcode
+         */
+        AngularVelocity getVelocity() const;
+        /**
+         * @brief Set how often the V5 Rotation Sensor measures its position and velocity
+         *
+         * The sensor measures every 10 ms by default, and can measure as often as every 5 ms. The rate is rounded
+         * down to a multiple of 5 ms, like the sensor does. The sensor goes back to 10 ms when it loses power, so the
+         * rate has to be set again after it reconnects.
+         *
+         * A DevicePoller which samples the sensor should use the same period, see DevicePoller::setPeriod.
+         *
          * This function uses the following values of errno when an error state is reached:
          *
+         * EINVAL: the rate is shorter than 5 ms, or not finite
          * ENXIO: the port is not within the range of valid ports (1-21)
          * ENODEV: the port cannot be configured as an V5 Rotation sensor
          *
+         * @param rate how often the sensor measures
          * @return 0 on success
          * @return INT_MAX on failure, setting errno
          *
          * @b Example:
          * @code {.cpp}
          * void initialize() {
-         *     lemlib::V5RotationSensor encoder = pros::Rotation(1);
-         *     // reverse the encoder
-         *     encoder.setReversed(true);
+         *     lemlib::V5RotationSensor encoder(1);
+         *     encoder.setDataRate(5_msec);
+         *     poller.setPeriod(encoder.getDataRate());
          * }
          * @endcode
          */
-        int32_t setReversed(bool reversed);
+        int32_t setDataRate(Time rate);
+        /**
+         * @brief Get how often the V5 Rotation Sensor measures its position and velocity
+         *
+         * @return Time the rate last set with setDataRate, or 10 ms if it was never set
+         */
+        Time getDataRate() const;
+        /**
+         * @brief Set how long getAngle reuses the last position read from the sensor
+         *
+         * The sensor only measures its position every few milliseconds, so reading it more often returns the same
+         * value. With a window, getAngle only reads the sensor if the last reading is older than the window, so
+         * several subsystems can read the angle in the same cycle for the cost of one read.
+         *
+         * @param window how old a reading can be and still be used. 0 disables the cache, which is the default
+         * @return int32_t always returns 0
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::V5RotationSensor encoder(1);
+         *     encoder.setReadCacheWindow(10_msec);
+         * }
+         * @endcode
+         */
+        int32_t setReadCacheWindow(Time window);
+        /**
+         * @brief Get how long getAngle reuses the last position read from the sensor
+         *
+         * @return Time the window. 0 if the cache is disabled
+         */
+        Time getReadCacheWindow() const;
     private:
-        mutable pros::Mutex m_mutex;
-        Angle m_offset = 0_stRot;
-        bool m_reversed;
+        /**
+         * @brief The offset and reversal of the sensor
+         *
+         * The offset is calculated for a specific reversal, so they are published together through a lock-free
+         * buffer. Reading them never waits for the mutex
+         */
+        struct Config {
+                Angle offset;
+                bool reversed;
+        };
+
+        // the rotation sensor returns centidegrees
+        static constexpr units::Scale CENTIDEGREES {deg / 100};
+
+        /**
+         * @brief Convert the raw position reported by PROS to an angle, without the offset
+         *
+         * The sensor itself is never reversed, so the position is negated here if the sensor should be reversed.
+         *
+         * @param raw the position in centidegrees
+         * @param reversed whether the sensor is reversed
+         * @return Angle the angle of the sensor
+         */
+        static Angle rawToAngle(int32_t raw, bool reversed) {
+            const Angle angle = CENTIDEGREES(raw);
+            return reversed ? -angle : angle;
+        }
+
+        // serializes writes to m_config
+        mutable DeviceMutex m_mutex;
         int m_port;
+        // the data rate in milliseconds. It is next to the port, so the config after them isn't padded
+        std::atomic<uint32_t> m_dataRate = 10;
+        DoubleBuffer<Config> m_config;
+        // the claim of the port in the DeviceRegistry
+        PortClaim m_claim;
+        // the last raw position read by getAngle, kept in the state of the port so every sensor object on the port
+        // shares it. The raw position doesn't depend on the reversal or the offset
+        mutable ReadCache m_readCache;
 };
 } // namespace lemlib
\ No newline at end of file
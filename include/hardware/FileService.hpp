@@ -0,0 +1,373 @@
+#pragma once
+
+#include "hardware/MessageQueue.hpp"
+#include "hardware/Signal.hpp"
+#include "hardware/TaskManager.hpp"
+#include "units/core.hpp"
+#include "pros/rtos.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+
+namespace lemlib {
+/**
+ * @brief The state of a file operation
+ */
+enum class FileOperationState : uint8_t {
+    /** the operation was never submitted, or could not be queued */
+    IDLE,
+    /** the operation is queued, or the I/O task is working on it */
+    PENDING,
+    /** the operation finished */
+    DONE,
+    /** the operation failed. getResult sets errno to the reason */
+    FAILED
+};
+
+/**
+ * @brief A file operation submitted to a FileService, which the submitting task can poll or wait on
+ *
+ * The operation is owned by the task which submits it, so submitting never allocates. It can be reused once it has
+ * finished, but must not be destroyed while it is pending. An optional callback is called by the I/O task when the
+ * operation finishes, before the operation is marked as finished, so it must be short and must not block.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * std::atomic<bool> pathLoaded = false;
+ * void loaded(int32_t result, void* context) { static_cast<std::atomic<bool>*>(context)->store(result != INT_MAX); }
+ *
+ * lemlib::FileOperation load(loaded, &pathLoaded);
+ * @endcode
+ */
+class FileOperation {
+    public:
+        /**
+         * the function called when an operation finishes, with the result getResult will return, and the context the
+         * operation was constructed with. errno is set like getResult sets it
+         */
+        using Callback = void (*)(int32_t result, void* context);
+        /**
+         * @brief Construct a new File Operation
+         *
+         * @param callback called by the I/O task when the operation finishes. Defaults to none
+         * @param context passed to the callback
+         */
+        FileOperation(Callback callback = nullptr, void* context = nullptr);
+        FileOperation(const FileOperation& other) = delete;
+        FileOperation& operator=(const FileOperation& other) = delete;
+        /**
+         * @brief Get the state of the operation
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * @return FileOperationState the state
+         */
+        FileOperationState getState() const;
+        /**
+         * @brief Check whether the operation has finished or failed
+         *
+         * @return true the operation isn't pending
+         * @return false the operation is still pending
+         */
+        bool isDone() const;
+        /**
+         * @brief Block the calling task until the operation finishes
+         *
+         * The task sleeps until the I/O task wakes it, so it uses no CPU while it waits. Control tasks should poll
+         * isDone instead.
+         *
+         * @param timeout the longest time to wait. Defaults to waiting until the operation finishes
+         * @return FileOperationState the state of the operation. PENDING if the wait timed out first
+         */
+        FileOperationState wait(Time timeout = from_sec(INFINITY));
+        /**
+         * @brief Get the result of a finished operation
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EBUSY: the operation hasn't finished
+         * the errno the operation failed with, like ENOENT when a file to read doesn't exist
+         *
+         * @return int32_t the number of bytes read or written
+         * @return INT_MAX the operation failed or hasn't finished, setting errno
+         */
+        int32_t getResult() const;
+    private:
+        friend class FileService;
+
+        const Callback m_callback;
+        void* const m_context;
+        std::atomic<FileOperationState> m_state = FileOperationState::IDLE;
+        // written by the I/O task before the state, so they are visible once the state is
+        int32_t m_result = 0;
+        int m_error = 0;
+        // the signal of the service the operation was submitted to, which outlives it
+        Signal* m_finished = nullptr;
+};
+
+/**
+ * @brief Does the file I/O of other tasks in a low priority task, so they never block on the SD card
+ *
+ * Opening, writing or closing a file on /usd/ can block the calling task for tens of milliseconds, which a control
+ * loop can't afford. A file service owns a low priority I/O task, and the only file handles. Other tasks submit
+ * requests to it through a lock-free queue, and get their results through a FileOperation, which they can poll, wait
+ * on, or have call them back.
+ *
+ * read and write transfer a whole buffer the caller owns, which must stay valid until the operation finishes, like
+ * loading a path or saving a config. A stream is for data which is produced a little at a time, like a log: append
+ * copies the data into one of two aligned buffers of BUFFER_SIZE bytes, and never waits. Once a buffer fills, the
+ * producer moves on to the other one, and the I/O task writes the full buffer in one call. Data which doesn't fit
+ * in either buffer is dropped and counted, so a slow card never blocks the producer. The stream is unbuffered by the
+ * C library, so a full buffer goes to the SD driver in one piece, as 8 whole sectors.
+ *
+ * Requests are handled in the order they are queued. Only one task may append to, flush, or close the stream at a
+ * time, but any task can submit reads and writes.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::FileService files;
+ * lemlib::FileOperation open;
+ * std::array<uint8_t, 2048> pathBuffer;
+ * lemlib::FileOperation loadPath;
+ *
+ * void initialize() {
+ *     files.start();
+ *     files.openStream("/usd/log.bin", open);
+ *     files.read("/usd/path.bin", pathBuffer, loadPath);
+ * }
+ *
+ * void autonomous() {
+ *     while (!loadPath.isDone()) pros::delay(10);
+ *     while (true) {
+ *         const float sample = imu.getRotation().convert(deg);
+ *         files.append({reinterpret_cast<const uint8_t*>(&sample), sizeof(sample)});
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class FileService {
+    public:
+        /** the size of each buffer of the stream, a whole number of 512 byte sectors */
+        static constexpr size_t BUFFER_SIZE = 4096;
+        /** the number of requests which can be queued at once */
+        static constexpr size_t QUEUE_SIZE = 16;
+        /**
+         * @brief Construct a new File Service
+         *
+         * @param period how often the I/O task checks for full stream buffers while no request arrives. Defaults to
+         * 10 ms
+         */
+        FileService(Time period = 10_msec);
+        FileService(const FileService& other) = delete;
+        FileService& operator=(const FileService& other) = delete;
+        /**
+         * @brief Destroy the File Service, finishing every queued request and closing the stream
+         */
+        ~FileService();
+        /**
+         * @brief Queue a read of a file into a buffer
+         *
+         * The operation reads until the buffer is full or the file ends. Its result is the number of bytes read.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EBUSY: the operation is already pending
+         * ENOBUFS: the queue is full
+         *
+         * @param path the path of the file. It must stay valid until the operation finishes, like a string literal
+         * @param buffer the buffer to read into. It must stay valid until the operation finishes
+         * @param operation the operation, which finishes once the file is read
+         * @param offset where to start reading, in bytes from the start of the file. Defaults to 0
+         * @return int32_t 0 the read was queued
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t read(const char* path, std::span<uint8_t> buffer, FileOperation& operation, size_t offset = 0);
+        /**
+         * @brief Queue a write of a buffer to a file
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EBUSY: the operation is already pending
+         * ENOBUFS: the queue is full
+         *
+         * @param path the path of the file. It must stay valid until the operation finishes, like a string literal
+         * @param data the data to write. It must stay valid until the operation finishes
+         * @param operation the operation, which finishes once the file is written and closed
+         * @param append whether to write to the end of the file, instead of replacing it. Defaults to false
+         * @return int32_t 0 the write was queued
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t write(const char* path, std::span<const uint8_t> data, FileOperation& operation, bool append = false);
+        /**
+         * @brief Queue the opening of the stream, replacing the file
+         *
+         * Data can be appended right away, and is written once the file is open. If the file can't be opened, the
+         * data appended before is dropped.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EBUSY: the operation is already pending
+         * ENOBUFS: the queue is full
+         *
+         * @param path the path of the file. It must stay valid until the operation finishes, like a string literal
+         * @param operation the operation, which finishes once the file is open
+         * @return int32_t 0 the open was queued
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t openStream(const char* path, FileOperation& operation);
+        /**
+         * @brief Copy data into the buffers of the stream
+         *
+         * This function does not lock, never waits for the SD card, and never allocates memory. The data is dropped
+         * as a whole if it doesn't fit, so a record is never split.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOBUFS: the buffers are full, so the data was dropped
+         *
+         * @param data the data
+         * @return int32_t 0 on success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t append(std::span<const uint8_t> data);
+        /**
+         * @brief Hand the partly filled buffer of the stream to the I/O task, and queue a flush of the file
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EAGAIN: the other buffer is still being written, so nothing was handed over. Try again later
+         * EBUSY: the operation is already pending
+         * ENOBUFS: the queue is full
+         *
+         * @param operation the operation, which finishes once every byte appended before is in the file
+         * @return int32_t 0 the flush was queued
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t flushStream(FileOperation& operation);
+        /**
+         * @brief Hand the partly filled buffer of the stream to the I/O task, and queue the closing of the file
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EAGAIN: the other buffer is still being written, so nothing was handed over. Try again later
+         * EBUSY: the operation is already pending
+         * ENOBUFS: the queue is full
+         *
+         * @param operation the operation, which finishes once every byte appended before is in the closed file
+         * @return int32_t 0 the close was queued
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t closeStream(FileOperation& operation);
+        /**
+         * @brief Get the number of bytes appended to the stream which were dropped
+         *
+         * This includes data which didn't fit in the buffers, and data which couldn't be written to the file.
+         *
+         * @return uint32_t the number of bytes
+         */
+        uint32_t getDropped() const;
+        /**
+         * @brief Start the I/O task
+         *
+         * Requests queued before the task starts are handled once it starts. The task is created by the TaskManager,
+         * with the stack depth and the CPU budget of its role.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EBUSY: the service is already running
+         * ENOMEM: the task could not be created
+         *
+         * @param priority the priority of the I/O task. Defaults to the priority the TaskManager configures for
+         * TaskRole::FILE_SERVICE, just above the lowest priority so it never delays control tasks
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t start(uint32_t priority = MANAGED_PRIORITY);
+        /**
+         * @brief Stop the I/O task, once it has finished every queued request
+         *
+         * This function blocks until the requests are finished. The stream stays open.
+         */
+        void stop();
+    private:
+        enum class RequestType : uint8_t { READ, WRITE, OPEN, FLUSH, CLOSE };
+
+        struct Request {
+                RequestType type = RequestType::READ;
+                const char* path = nullptr;
+                // only read from by a write
+                uint8_t* data = nullptr;
+                size_t size = 0;
+                size_t offset = 0;
+                bool append = false;
+                FileOperation* operation = nullptr;
+        };
+
+        /**
+         * @brief the function run by the I/O task
+         *
+         * @param service pointer to the service
+         */
+        static void taskFunction(void* service);
+        /**
+         * @brief Mark an operation as pending, and queue a request for it
+         *
+         * @param request the request
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t submit(const Request& request);
+        /**
+         * @brief Do a request, and finish its operation
+         *
+         * Only the I/O task, or stop once the task has exited, may call this function
+         *
+         * @param request the request
+         */
+        void handle(const Request& request);
+        /**
+         * @brief Finish an operation, calling its callback and waking the tasks waiting on it
+         *
+         * @param operation the operation
+         * @param result the number of bytes transferred, or INT_MAX if it failed
+         * @param error the errno it failed with
+         */
+        void finish(FileOperation& operation, int32_t result, int error);
+        /**
+         * @brief Hand the buffer the producer is filling to the I/O task, if the other buffer is free
+         *
+         * @return true the buffer was handed over, or was empty
+         * @return false the other buffer is still being written
+         */
+        bool handOver();
+        /**
+         * @brief Write the handed over buffer of the stream to the file
+         *
+         * Only the I/O task, or stop once the task has exited, may call this function
+         */
+        void writeBuffers();
+
+        const Time m_period;
+        MpscQueue<Request, QUEUE_SIZE> m_requests;
+        // notified whenever an operation finishes, to wake the tasks blocked in FileOperation::wait
+        Signal m_finished;
+        // aligned to a cache line, so the SD driver can copy a buffer by whole words
+        alignas(32) uint8_t m_buffers[2][BUFFER_SIZE];
+        // set by the producer once a buffer is handed over, and cleared by the I/O task once it is written. Only one
+        // buffer is handed over at a time, so they are written in the order they were filled
+        std::atomic<bool> m_full[2] = {false, false};
+        // the number of bytes in each handed over buffer, written before it is marked full
+        size_t m_sizes[2] = {0, 0};
+        // only used by the producer
+        uint8_t m_active = 0;
+        size_t m_filled = 0;
+        // only used by the I/O task
+        FILE* m_stream = nullptr;
+        std::atomic<uint32_t> m_dropped = 0;
+        std::atomic<bool> m_running = false;
+        std::atomic<bool> m_taskExited = true;
+};
+} // namespace lemlib
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "hardware/GPS/V5GPS.hpp"
+#include "hardware/Odometry/Odometry.hpp"
+#include "units/Pose.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief How much a GPSFusion trusts odometry and the GPS
+ */
+struct GPSFusionSettings {
+        /** how much the error of odometry grows, per unit of distance travelled */
+        Number odometryDrift = 0.02;
+        /** how much the error of odometry grows every fused reading, even if it didn't move, like when it is pushed */
+        Length minDrift = 0.05_in;
+        /** the error of odometry when the fusion starts, or is reset */
+        Length initialError = 1_in;
+        /** how long after the robot was at a pose the GPS reports it. Correcting odometry clears its history, so readings
+         * taken before the last correction fail, and readings are fused at most once per latency */
+        Time latency = 0_msec;
+        /** the fraction of the heading error corrected by every reading. Defaults to 0, which trusts the IMU */
+        Number headingGain = 0;
+        /** readings further from odometry than this many standard deviations of both errors combined are rejected */
+        Number gate = 3;
+};
+
+/**
+ * @brief GPSFusion class
+ *
+ * Odometry is smooth but drifts, and the GPS doesn't drift but is noisy, and can be blocked by other robots. The
+ * fusion corrects odometry with GPS readings, weighted by how much each can be trusted, like a Kalman filter with one
+ * variance for the position. The variance of odometry grows with the distance it travelled, and the variance of a
+ * reading is the root mean square error the sensor reports. Each reading moves the pose of the robot at the time the
+ * reading was taken by the fraction of the difference the variances call for, and the motion since then is kept, so
+ * the correction goes through the pose history of the odometry.
+ *
+ * Readings which disagree with odometry by more than the gate are rejected, like a reading taken while the sensor was
+ * blocked. Odometry keeps getting less certain while readings are rejected, so a real jump is accepted eventually.
+ * After a jump which is known to have happened, like the robot being placed on the field, reset makes the fusion
+ * accept the next readings right away.
+ *
+ * The fusion has no task. update is called periodically, like from a ControlScheduler, or fuse is called with the
+ * samples of a DevicePoller.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::V5GPS gps(7, {-4_in, 0_in, 180_stDeg});
+ * lemlib::PoseHistory<64> history;
+ * lemlib::GPSFusion fusion(odom, gps);
+ *
+ * void initialize() {
+ *     odom.setHistory(history);
+ *     odom.start();
+ *     while (true) {
+ *         fusion.update();
+ *         pros::delay(20);
+ *     }
+ * }
+ * @endcode
+ */
+class GPSFusion {
+    public:
+        /**
+         * @brief Construct a new GPS Fusion
+         *
+         * @param odometry the odometry to correct. It needs a history. It must outlive the fusion
+         * @param gps the GPS. It must outlive the fusion
+         * @param settings the settings of the fusion
+         */
+        GPSFusion(Odometry& odometry, V5GPS& gps, const GPSFusionSettings& settings = {});
+        /**
+         * @brief Read the GPS, and fuse its reading
+         *
+         * It must not be called from more than one task at once.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENXIO: the port is not within the range of valid ports (1-21)
+         * ENODEV: the port cannot be configured as a V5 GPS
+         * EINVAL: the odometry has no history, or it is empty
+         * ERANGE: the reading is older than the oldest pose in the history
+         *
+         * @return int32_t 0 on success, including when the reading was rejected
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t update();
+        /**
+         * @brief Fuse a reading of the GPS
+         *
+         * A reading identical to the previous one is the same measurement read twice, and is skipped. It must not be
+         * called from more than one task at once.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the reading is invalid, or the odometry has no history, or it is empty
+         * ERANGE: the reading is older than the oldest pose in the history
+         *
+         * @param reading the reading, like a sample of a DevicePoller
+         * @return int32_t 0 on success, including when the reading was rejected
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     fusion.fuse(poller.getGPSSample(gpsIndex));
+         * }
+         * @endcode
+         */
+        int32_t fuse(const GPSReading& reading);
+        /**
+         * @brief Set the error of odometry, like after the pose was set
+         *
+         * @param error the standard deviation of the position of odometry
+         */
+        void reset(Length error);
+        /**
+         * @brief Get the estimated error of the position of odometry
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * @return Length the standard deviation of the position
+         */
+        Length getError() const;
+    private:
+        Odometry& m_odometry;
+        V5GPS& m_gps;
+        const GPSFusionSettings m_settings;
+        // the variance of the position of odometry, in square meters
+        std::atomic<double> m_variance;
+        // the pose of odometry when the variance was last grown
+        units::Pose m_lastOdometry;
+        bool m_hasLastOdometry = false;
+        // the previous reading, so a reading is never fused twice
+        units::Pose m_lastReading;
+};
+} // namespace lemlib
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "hardware/Device.hpp"
+#include "hardware/DeviceRegistry.hpp"
+#include "hardware/DoubleBuffer.hpp"
+#include "hardware/Port.hpp"
+#include "units/Pose.hpp"
+#include "pros/gps.hpp"
+
+namespace lemlib {
+/**
+ * @brief A pose measured by a GPS
+ */
+struct GPSReading {
+        /** when the sensor was read, measured since the program started */
+        Time timestamp = 0_sec;
+        /** the pose of the tracking center of the robot, in standard position. INFINITY if it could not be read */
+        units::Pose pose = units::Pose(from_in(INFINITY), from_in(INFINITY), from_stDeg(INFINITY));
+        /** the root mean square error of the position the sensor reports. INFINITY if it could not be read */
+        Length error = from_in(INFINITY);
+};
+
+/**
+ * @brief Device implementation for the V5 GPS sensor
+ *
+ * The GPS measures its position on the field by looking at the code strip on the field walls. Its coordinates have
+ * their origin in the center of the field, and are converted to standard position, so its pose can be compared
+ * directly with odometry which uses the same origin.
+ *
+ * Like the reversal of a V5RotationSensor, the offset of the sensor from the tracking center is applied in software,
+ * so it doesn't have to be set again when the sensor reconnects. A reading is three calls to the SDK and never locks a
+ * mutex, so it can be sampled by a DevicePoller.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * // a GPS 4" behind the tracking center, facing backwards
+ * lemlib::V5GPS gps(7, {-4_in, 0_in, 180_stDeg});
+ *
+ * void opcontrol() {
+ *     const lemlib::GPSReading reading = gps.getReading();
+ *     std::cout << to_in(reading.pose.x) << ", " << to_in(reading.pose.y) << std::endl;
+ * }
+ * @endcode
+ */
+class V5GPS final : public Device {
+    public:
+        /**
+         * @brief Construct a new V5 GPS
+         *
+         * @param port the port of the GPS
+         * @param offset the pose of the GPS relative to the tracking center of the robot. 0_stDeg faces forwards.
+         * Defaults to the tracking center
+         */
+        V5GPS(SmartPort port, units::Pose offset = {});
+        V5GPS(const V5GPS& other);
+        // the simulator only implements the PROS C api, so PROS objects can't be converted
+#ifndef LEMLIB_SIM
+        /**
+         * @brief Create a new V5 GPS
+         *
+         * The offset set on the pros::Gps is not read, as it is applied in software instead.
+         *
+         * @param gps the pros::Gps object to use
+         * @param offset the pose of the GPS relative to the tracking center of the robot
+         * @return V5GPS the GPS
+         */
+        static V5GPS from_pros_gps(pros::Gps gps, units::Pose offset = {});
+#endif
+        /**
+         * @brief whether the V5 GPS is connected
+         *
+         * The connection is read from the latest snapshot of the DeviceRegistry, so this is only a lookup, and can be
+         * up to one scan period old
+         *
+         * @return 0 if its not connected
+         * @return 1 if it is connected
+         */
+        int32_t isConnected() const override;
+        /**
+         * @brief Read the pose of the robot, and the error the sensor reports for it
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENXIO: the port is not within the range of valid ports (1-21)
+         * ENODEV: the port cannot be configured as a V5 GPS
+         * EAGAIN: the sensor is still calibrating
+         *
+         * @return GPSReading the reading. The pose and error are INFINITY on failure, setting errno
+         */
+        GPSReading getReading() const;
+        /**
+         * @brief Set the pose of the GPS relative to the tracking center of the robot
+         *
+         * @param offset the offset. 0_stDeg faces forwards
+         * @return int32_t always returns 0
+         */
+        int32_t setOffset(units::Pose offset);
+        /**
+         * @brief Get the pose of the GPS relative to the tracking center of the robot
+         *
+         * @return units::Pose the offset
+         */
+        units::Pose getOffset() const;
+    private:
+        uint8_t m_port;
+        // published through a lock-free buffer, so reading the sensor never waits for setOffset
+        DoubleBuffer<units::Pose> m_offset;
+        // the claim of the port in the DeviceRegistry
+        PortClaim m_claim;
+};
+} // namespace lemlib
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "hardware/IMU/IMU.hpp"
+#include "hardware/Signal.hpp"
+#include "units/core.hpp"
+#include "pros/rtos.h"
+#include <atomic>
+#include <climits>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+namespace lemlib {
+namespace detail {
+/**
+ * @brief The state of a calibration, shared by its handles and the task which monitors it
+ */
+struct CalibrationState {
+        std::vector<IMU*> imus;
+        std::function<void(int32_t)> callback;
+        pros::task_t notify = nullptr;
+        Time timeout = 0_sec;
+        std::atomic<bool> done = false;
+        std::atomic<int32_t> result = INT_MAX;
+        std::atomic<int32_t> error = 0;
+        std::atomic<int32_t> calibrated = 0;
+        // notified once the calibration is done, to wake the tasks blocked in CalibrationHandle::wait
+        Signal finished;
+};
+} // namespace detail
+
+/**
+ * @brief A handle to a calibration started by calibrateIMUs
+ *
+ * Handles can be copied, and every copy refers to the same calibration. The calibration keeps running if every handle
+ * is destroyed.
+ */
+class CalibrationHandle {
+    public:
+        /**
+         * @brief whether the calibration has finished, successfully or not
+         *
+         * @return 1 the calibration has finished
+         * @return 0 the calibration is still running
+         */
+        int32_t isDone() const;
+        /**
+         * @brief Get the result of the calibration
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EAGAIN: the calibration is still running
+         * ENODEV: an IMU could not start calibrating
+         * ETIMEDOUT: an IMU was still calibrating when the calibration timed out
+         *
+         * @return 0 every IMU is calibrated
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t getResult() const;
+        /**
+         * @brief Get the number of IMUs which finished calibrating successfully
+         *
+         * @return int32_t the number of calibrated IMUs
+         */
+        int32_t getCalibratedCount() const;
+        /**
+         * @brief Block the calling task until the calibration has finished
+         *
+         * The task sleeps until the monitoring task wakes it, so it uses no CPU while it waits.
+         *
+         * @param timeout the maximum time to wait. Waits forever by default
+         * @return 0 every IMU is calibrated
+         * @return INT_MAX error occurred, or the wait timed out, setting errno like getResult
+         */
+        int32_t wait(Time timeout = from_sec(INFINITY)) const;
+    private:
+        friend CalibrationHandle calibrateIMUs(std::initializer_list<IMU*> imus,
+                                               std::function<void(int32_t)> callback, pros::task_t notify,
+                                               Time timeout);
+
+        CalibrationHandle(std::shared_ptr<detail::CalibrationState> state);
+
+        std::shared_ptr<detail::CalibrationState> m_state;
+};
+
+/**
+ * @brief Start calibrating several IMUs at the same time, without blocking
+ *
+ * Every IMU starts calibrating before this function returns, so they calibrate in parallel and the whole calibration
+ * takes as long as the slowest IMU. A task monitors the IMUs until they are done. Once they are, the result is saved in
+ * the handle, the callback is called from the monitoring task, and the notify task is notified, in that order.
+ *
+ * The IMUs must outlive the calibration.
+ *
+ * @param imus the IMUs to calibrate
+ * @param callback called with the result once the calibration has finished, like CalibrationHandle::getResult
+ * @param notify a task to notify with pros::c::task_notify once the calibration has finished, or nullptr
+ * @param timeout how long to wait for the IMUs before the calibration fails
+ * @return CalibrationHandle a handle to the calibration
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::V5InertialSensor left(1);
+ * lemlib::V5InertialSensor right(2);
+ *
+ * void initialize() {
+ *     // calibrate both sensors while the rest of the robot is set up
+ *     const lemlib::CalibrationHandle calibration =
+ *         lemlib::calibrateIMUs({&left, &right}, nullptr, pros::c::task_get_current());
+ *     setUpEverythingElse();
+ *     // wait for the notification
+ *     pros::c::task_notify_take(true, TIMEOUT_MAX);
+ *     if (calibration.getResult() != 0) std::cout << "IMU calibration failed" << std::endl;
+ * }
+ * @endcode
+ */
+CalibrationHandle calibrateIMUs(std::initializer_list<IMU*> imus, std::function<void(int32_t)> callback = nullptr,
+                                pros::task_t notify = nullptr, Time timeout = 5_sec);
+} // namespace lemlib
@@ -0,0 +1,258 @@
+#pragma once
+
+#include "hardware/IMU/IMU.hpp"
+#include "hardware/Motor/DifferentialDrive.hpp"
+#include "hardware/Odometry/Odometry.hpp"
+#include "hardware/Result.hpp"
+#include "units/Angle.hpp"
+#include "pros/rtos.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+namespace lemlib {
+/**
+ * @brief The spin a GyroCharacterization runs
+ */
+struct GyroCharacterizationSettings {
+        /** the power the drive spins at. Slower spins slip the tracking wheels less */
+        Number power = 0.4;
+        /** how far the robot spins, as measured by the tracking wheels. Defaults to 10 turns */
+        Angle rotation = 3600_stDeg;
+        /** how long the power takes to ramp up to the spin power, so the wheels don't slip as the robot starts */
+        Time rampDuration = 0.5_sec;
+        /** how long the robot coasts to a stop after the spin, which is still measured */
+        Time settleDuration = 1_sec;
+        /** the longest the spin can take, after which the robot stops wherever it is */
+        Time timeout = 30_sec;
+        /** whether to spin clockwise instead of counterclockwise */
+        bool reverse = false;
+};
+
+/**
+ * @brief What a GyroCharacterization is doing
+ */
+enum class GyroCharacterizationPhase {
+    /** the spin hasn't started */
+    IDLE,
+    /** the robot is spinning */
+    SPINNING,
+    /** the robot is coasting to a stop */
+    SETTLING,
+    /** the spin finished, or was stopped */
+    DONE
+};
+
+/**
+ * @brief Finds the gyro scalar of several IMUs by spinning the robot
+ *
+ * An IMU which reads 3590 degrees over 10 turns needs a gyro scalar of 3600 / 3590, which is tedious to measure by
+ * hand. The characterization spins the robot in place with the drive, and measures its heading with two parallel
+ * tracking wheels at the same time as every IMU. Every period, the change in the raw reading of each IMU, without its
+ * current scalar, and the change in the heading of the wheels are added to an online least squares fit of
+ * wheels = scalar * IMU, so the fit covers the whole spin in constant memory, and every IMU is fitted from the same
+ * spin.
+ *
+ * Unpowered tracking wheels, which don't slip as the drive turns, give the best reference. Measure the distance
+ * between them well, as an error in it is an error in every scalar. The fitted scalars can be applied to the IMUs,
+ * and saved to the SD card with saveGyroScalars, so loadGyroScalars sets them on every boot without spinning again.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::GyroCharacterization characterization(drive, leftWheel, rightWheel, {&imuA, &imuB});
+ *
+ * void opcontrol() {
+ *     characterization.start();
+ *     while (characterization.getPhase() != lemlib::GyroCharacterizationPhase::DONE) pros::delay(100);
+ *     if (characterization.apply() == 0) lemlib::saveGyroScalars("/usd/gyro.txt", {&imuA, &imuB});
+ * }
+ * @endcode
+ */
+class GyroCharacterization {
+    public:
+        /** the most IMUs a characterization can fit at once */
+        static constexpr size_t MAX_IMUS = 4;
+        /**
+         * @brief Construct a new Gyro Characterization
+         *
+         * IMUs past MAX_IMUS are ignored. The IMUs have to be calibrated before the spin starts.
+         *
+         * @param drive the drive which spins the robot. It must outlive the characterization
+         * @param a a tracking wheel which measures forward motion. It must outlive the characterization
+         * @param b a tracking wheel parallel to the first, with a different offset. It must outlive the
+         * characterization
+         * @param imus the IMUs to fit. They must outlive the characterization
+         * @param settings the spin to run
+         */
+        GyroCharacterization(DifferentialDrive& drive, const TrackingWheel& a, const TrackingWheel& b,
+                             std::initializer_list<IMU*> imus, const GyroCharacterizationSettings& settings = {});
+        GyroCharacterization(const GyroCharacterization& other) = delete;
+        GyroCharacterization& operator=(const GyroCharacterization& other) = delete;
+        /**
+         * @brief Destroy the Gyro Characterization, stopping its task
+         */
+        ~GyroCharacterization();
+        /**
+         * @brief Run one step of the spin
+         *
+         * This is called periodically by the characterization task, but can also be called manually if the task is
+         * not started. It never allocates memory.
+         *
+         * @return 0 the drive was moved
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t update();
+        /**
+         * @brief Start the spin in a task
+         *
+         * The fit of the last run is cleared.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EBUSY: the spin is already running
+         * ENOMEM: the task could not be created
+         *
+         * @param period how often the IMUs and the wheels are sampled. Defaults to 10 ms, which is how often smart
+         * devices update
+         * @param priority the priority of the task. Defaults to two above the default priority
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t start(Time period = 10_msec, uint32_t priority = TASK_PRIORITY_DEFAULT + 2);
+        /**
+         * @brief Stop the spin, and stop the drive
+         *
+         * This function blocks until the current update finishes. The samples fitted so far are kept.
+         */
+        void stop();
+        /**
+         * @brief Get what the spin is doing
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * @return GyroCharacterizationPhase the phase
+         */
+        GyroCharacterizationPhase getPhase() const;
+        /**
+         * @brief Get how far the robot has turned so far, as measured by the tracking wheels
+         *
+         * @return Angle the rotation since the spin started
+         */
+        Angle getReferenceRotation() const;
+        /**
+         * @brief Solve the fit of an IMU
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the index isn't the index of an IMU
+         * EAGAIN: the wheels measured less than a turn, which is too little to fit a scalar
+         * EDOM: the IMU never read a change, like when it was disconnected for the whole spin
+         *
+         * @param index the index of the IMU, in the order they were passed to the constructor
+         * @return Result<Number> the gyro scalar the IMU needs
+         */
+        Result<Number> getScalar(size_t index) const;
+        /**
+         * @brief Set the gyro scalar of every IMU to its fit
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EAGAIN: the wheels measured less than a turn
+         * EDOM: an IMU never read a change. The other IMUs are still set
+         *
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t apply();
+    private:
+        /**
+         * @brief the function run by the characterization task
+         *
+         * @param characterization pointer to the characterization
+         */
+        static void taskFunction(void* characterization);
+        /**
+         * @brief Read the heading of the robot from the tracking wheels
+         *
+         * @return double the heading in radians, or INFINITY if a wheel couldn't be read
+         */
+        double wheelHeading() const;
+
+        /**
+         * @brief The online fit of one IMU
+         */
+        struct Fit {
+                IMU* imu = nullptr;
+                // the latest raw reading, in radians, or INFINITY if there isn't one
+                double last = INFINITY;
+                double xx = 0;
+                double xy = 0;
+        };
+
+        DifferentialDrive& m_drive;
+        const TrackingWheel m_a;
+        const TrackingWheel m_b;
+        const GyroCharacterizationSettings m_settings;
+        std::array<Fit, MAX_IMUS> m_fits {};
+        const size_t m_count;
+        std::atomic<GyroCharacterizationPhase> m_phase = GyroCharacterizationPhase::IDLE;
+        // when the spin and the current phase started, in microseconds
+        uint64_t m_start = 0;
+        uint64_t m_phaseStart = 0;
+        // the heading of the wheels when the spin started, and in the latest update, in radians
+        double m_firstHeading = INFINITY;
+        double m_lastHeading = INFINITY;
+        // protects the fits and the headings, which are written by the task and solved by any task
+        mutable pros::Mutex m_mutex;
+        Time m_period = 10_msec;
+        // the task is not deleted from outside, as it could be holding a device mutex. Instead it is asked to exit
+        std::atomic<bool> m_running = false;
+        std::atomic<bool> m_taskExited = true;
+};
+
+/**
+ * @brief Save the gyro scalars of IMUs to a file
+ *
+ * The file is text, with the scalar of every IMU on its own line, in the order they are passed.
+ *
+ * This function uses the following values of errno when an error state is reached:
+ *
+ * EIO: the file could not be written completely
+ * any errno set by fopen
+ *
+ * @param path the path of the file, like "/usd/gyro.txt"
+ * @param imus the IMUs
+ * @return int32_t 0 on success
+ * @return INT_MAX on failure, setting errno
+ */
+int32_t saveGyroScalars(const char* path, std::initializer_list<const IMU*> imus);
+
+/**
+ * @brief Set the gyro scalars of IMUs from a file written by saveGyroScalars
+ *
+ * The IMUs have to be passed in the same order they were saved in.
+ *
+ * This function uses the following values of errno when an error state is reached:
+ *
+ * EPROTO: the file has fewer scalars than there are IMUs, or a scalar isn't a finite positive number. No scalar is
+ * set
+ * any errno set by fopen, like ENOENT when the file does not exist
+ *
+ * @param path the path of the file, like "/usd/gyro.txt"
+ * @param imus the IMUs
+ * @return int32_t 0 on success
+ * @return INT_MAX on failure, setting errno
+ *
+ * @b Example:
+ * @code {.cpp}
+ * void initialize() {
+ *     if (lemlib::loadGyroScalars("/usd/gyro.txt", {&imuA, &imuB}) == INT_MAX) {
+ *         std::cout << "gyro scalars weren't characterized" << std::endl;
+ *     }
+ * }
+ * @endcode
+ */
+int32_t loadGyroScalars(const char* path, std::initializer_list<IMU*> imus);
+} // namespace lemlib
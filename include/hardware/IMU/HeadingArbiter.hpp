@@ -0,0 +1,268 @@
+#pragma once
+
+#include "hardware/Encoder/Encoder.hpp"
+#include "hardware/GPS/V5GPS.hpp"
+#include "hardware/IMU/IMU.hpp"
+#include "hardware/StaticVector.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief How a HeadingArbiter scores and blends its sources
+ */
+struct HeadingArbiterSettings {
+        /**
+         * a source which turned more or less than the consensus by more than this in a single update is treated as
+         * slipping or glitching, and is left out of that update
+         */
+        Angle outlierThreshold = 2_stDeg;
+        /** a source whose reading doesn't change for this long while the robot turns is treated as frozen */
+        Time staleTime = 250_msec;
+        /**
+         * how fast the noise of a source follows its recent disagreement with the consensus, from 0 to 1. Higher
+         * values react faster to a source going bad, and recover faster once it is good again
+         */
+        double smoothing = 0.05;
+};
+
+/**
+ * @brief The health of a source of a HeadingArbiter, as of its latest update
+ */
+enum class HeadingSourceHealth : uint8_t {
+    /** the source was used */
+    HEALTHY,
+    /** the source is not plugged in */
+    DISCONNECTED,
+    /** the source is plugged in, but could not be read */
+    UNREADABLE,
+    /** the reading of the source stopped changing while the robot turned */
+    STALE,
+    /** the source disagreed with the consensus by more than the outlier threshold */
+    OUTLIER
+};
+
+/**
+ * @brief The state of a source of a HeadingArbiter, as of its latest update
+ */
+struct HeadingSourceStatus {
+        HeadingSourceHealth health = HeadingSourceHealth::DISCONNECTED;
+        /** how far the turn the source measured per update typically disagrees with the consensus */
+        Angle noise = from_stDeg(INFINITY);
+        /** the share of the blended turn which came from the source, from 0 to 1 */
+        Number weight = 0;
+};
+
+/**
+ * @brief IMU implementation which arbitrates between several sources of heading, scoring the health of each online
+ *
+ * A robot can measure its heading with a V5 Inertial Sensor, an IMUArray, a pair of tracking wheels, or a GPS, and
+ * each of them fails differently: an IMU disconnects, wheels slip, a GPS loses sight of the field strip, and any of
+ * them can freeze. The arbiter reads every source each update, and blends the turn each measured since the previous
+ * update. Only turns are blended, never absolute headings, so sources can join, leave or change weight from one
+ * update to the next without the heading jumping, and odometry reading the arbiter never needs to be reset.
+ *
+ * Each update, every source is checked in order:
+ * - a source which isn't plugged in, going by the DeviceRegistry for V5 devices, is left out, as is one which can't
+ *   be read. It is measured from the current heading again once it is back
+ * - a source whose reading doesn't change for staleTime while the heading moves is frozen, and left out until it
+ *   changes again
+ * - the consensus is the weighted median of the turns of the remaining sources, and a source which disagrees with it
+ *   by more than the outlier threshold is left out
+ * The rest are averaged, each weighted by the inverse of its noise variance, which is its configured noise plus how
+ * far it recently disagreed with the blend. A source which gets noisy loses weight smoothly, instead of switching off.
+ *
+ * The arbiter is updated every time the rotation is read, in constant time, with no memory allocated. It doesn't
+ * correct drift by itself; a source can be a WheelAidedIMU or a GPSFusion to do that.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::IMUArray imus({1, 2});
+ * lemlib::DifferentialEncoder wheelHeading(leftWheel, rightWheel, 2.75_in, 10_in);
+ * lemlib::V5GPS gps(7);
+ * lemlib::HeadingArbiter heading;
+ *
+ * void initialize() {
+ *     heading.addSource(imus, 0.01_stDeg);
+ *     heading.addSource(wheelHeading, 0.2_stDeg);
+ *     heading.addSource(gps, 1_stDeg);
+ *     heading.calibrate();
+ *     while (heading.isCalibrating()) pros::delay(10);
+ * }
+ * @endcode
+ */
+class HeadingArbiter : public IMU {
+    public:
+        /** the most sources an arbiter can have */
+        static constexpr size_t MAX_SOURCES = 4;
+        /**
+         * @brief Construct a new Heading Arbiter, without any sources
+         *
+         * @param settings how the sources are scored and blended
+         */
+        HeadingArbiter(HeadingArbiterSettings settings = {});
+        HeadingArbiter(const HeadingArbiter& other) = delete;
+        HeadingArbiter& operator=(const HeadingArbiter& other) = delete;
+        /**
+         * @brief Add an IMU as a source, like a V5InertialSensor or an IMUArray
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOSPC: the arbiter already has MAX_SOURCES sources
+         *
+         * @param imu the IMU. It must outlive the arbiter
+         * @param noise how far the turn it measures in a single update is typically off, while it works
+         * @return int32_t the index of the source
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t addSource(IMU& imu, Angle noise);
+        /**
+         * @brief Add an encoder measuring the heading of the robot as a source, like a DifferentialEncoder
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOSPC: the arbiter already has MAX_SOURCES sources
+         *
+         * @param heading the encoder, counterclockwise positive like the rotation of an IMU. It must outlive the
+         * arbiter
+         * @param noise how far the turn it measures in a single update is typically off, while it works
+         * @return int32_t the index of the source
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t addSource(Encoder& heading, Angle noise);
+        /**
+         * @brief Add the orientation of a GPS as a source
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOSPC: the arbiter already has MAX_SOURCES sources
+         *
+         * @param gps the GPS. It must outlive the arbiter
+         * @param noise how far the turn it measures in a single update is typically off, while it works
+         * @return int32_t the index of the source
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t addSource(V5GPS& gps, Angle noise);
+        /**
+         * @brief calibrate every IMU source at the same time
+         *
+         * The rotation starts over at 0, like the rotation of a V5 Inertial Sensor. This function is non-blocking
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: there are IMU sources, but none of them could be calibrated
+         *
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t calibrate() override;
+        /**
+         * @brief check if the IMU sources are calibrated
+         *
+         * @return 1 at least one IMU source is calibrated, or there are no IMU sources
+         * @return 0 no IMU source is calibrated
+         */
+        int32_t isCalibrated() const override;
+        /**
+         * @brief check if any IMU source is calibrating
+         *
+         * @return 1 an IMU source is calibrating
+         * @return 0 no IMU source is calibrating
+         */
+        int32_t isCalibrating() const override;
+        /**
+         * @brief whether any source is connected
+         *
+         * @return 1 at least one source is connected
+         * @return 0 no source is connected
+         */
+        int32_t isConnected() const override;
+        /**
+         * @brief Update the arbiter, and get the blended rotation
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: no source could be read
+         *
+         * @return Angle the rotation
+         * @return INFINITY error occurred, setting errno
+         */
+        Angle getRotation() const override;
+        /**
+         * @brief Set the rotation
+         *
+         * Every source is measured from the new rotation, and keeps its score.
+         *
+         * @param rotation the new rotation
+         * @return int32_t always returns 0
+         */
+        int32_t setRotation(Angle rotation) override;
+        /**
+         * @brief Set the gyro scalar of every IMU source
+         *
+         * @param scalar the scalar
+         * @return 0 success
+         * @return INT_MAX error occurred on a source, setting errno
+         */
+        int32_t setGyroScalar(Number scalar) override;
+        /**
+         * @brief Get the state of a source, as of the latest update
+         *
+         * @param index the index of the source, returned when it was added
+         * @return HeadingSourceStatus the state. A source which doesn't exist is DISCONNECTED
+         */
+        HeadingSourceStatus getSourceStatus(size_t index) const;
+        /**
+         * @brief Get how many times the blend lost or regained a source
+         *
+         * @return uint32_t the number of times a source went from healthy to unhealthy, or back
+         */
+        uint32_t getSwitchCount() const;
+    private:
+        enum class SourceKind : uint8_t { IMU, ENCODER, GPS };
+
+        struct Source {
+                SourceKind kind = SourceKind::IMU;
+                // downcast according to the kind
+                Device* device = nullptr;
+                // the configured noise, in radians
+                double noise = 0;
+                // the previous reading, in radians, or INFINITY if the source has to be measured from scratch
+                double last = INFINITY;
+                // the smoothed square of the disagreement with the blend, in square radians
+                double variance = 0;
+                // when the reading last stopped changing, in seconds, and the heading at that time
+                double frozenSince = INFINITY;
+                double headingWhenFrozen = 0;
+                // the turn measured this update, in radians, or INFINITY if there is none
+                double turn = INFINITY;
+                double weight = 0;
+                HeadingSourceHealth health = HeadingSourceHealth::DISCONNECTED;
+        };
+
+        /**
+         * @brief Add a source
+         *
+         * @param kind the kind of device
+         * @param device the device
+         * @param noise the configured noise
+         * @return int32_t the index of the source
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t add(SourceKind kind, Device* device, Angle noise);
+        /**
+         * @brief Read a source
+         *
+         * @param source the source
+         * @return double the reading, in radians, or INFINITY if it is not connected or could not be read, setting the
+         * health of the source
+         */
+        static double read(Source& source);
+
+        const HeadingArbiterSettings m_settings;
+        // only touched with the mutex held. Everything is in radians and seconds
+        mutable StaticVector<Source, MAX_SOURCES> m_sources;
+        mutable double m_heading = 0;
+        mutable uint32_t m_switches = 0;
+};
+} // namespace lemlib
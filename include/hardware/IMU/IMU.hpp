@@ -1,8 +1,12 @@
 #pragma once
 
 #include "hardware/Device.hpp"
+#include "hardware/DeviceMutex.hpp"
+#include "hardware/Result.hpp"
 #include "units/Angle.hpp"
 #include "pros/rtos.hpp"
+#include <atomic>
+#include <concepts>
 
 namespace lemlib {
 class IMU : public Device {
@@ -16,7 +20,7 @@ class IMU : public Device {
         /**
          * @brief IMU copy constructor
          *
-         * since pros::Mutex does not have a copy constructor, we need an explicit copy constructor
+         * since DeviceMutex does not have a copy constructor, we need an explicit copy constructor
          *
          * @param other the imu to copy
          */
@@ -47,6 +51,20 @@ class IMU : public Device {
          * @return INT_MAX error occurred, setting errno
          */
         virtual int32_t isCalibrating() const = 0;
+        /**
+         * @brief Start calibrating the IMU, for DeviceRegistry::initializeAll
+         *
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t startInitialization() override { return calibrate(); }
+        /**
+         * @brief whether the IMU is still calibrating
+         *
+         * @return 1 the IMU is calibrating
+         * @return 0 the IMU is calibrated, or calibrating it failed
+         */
+        int32_t isInitializing() const override { return isCalibrating() == 1; }
         /**
          * @brief Get the rotation of the IMU
          *
@@ -56,6 +74,20 @@ class IMU : public Device {
          * @return INFINITY error occurred, setting errno
          */
         virtual Angle getRotation() const = 0;
+        /**
+         * @brief Get the rotation of the IMU, or the error which prevented reading it
+         *
+         * Errors are returned in the result instead of by setting errno, like Encoder::tryGetAngle. The default
+         * implementation converts the result of getRotation.
+         *
+         * @return Result<Angle> the rotation, or the error, like a value of errno
+         */
+        virtual Result<Angle> tryGetRotation() const {
+            const Angle rotation = getRotation();
+            if (rotation == from_stDeg(INFINITY)) [[unlikely]]
+                return Result<Angle>::failure(errno);
+            return rotation;
+        }
         /**
          * @brief Set the rotation of the IMU
          *
@@ -89,7 +121,21 @@ class IMU : public Device {
         virtual Number getGyroScalar() const;
         virtual ~IMU() = default;
     protected:
-        mutable pros::Mutex m_mutex;
-        Number m_gyroScalar;
+        // serializes changes to the IMU. The gyro scalar and the offsets of implementations are atomic, so reading
+        // them doesn't need the mutex
+        mutable DeviceMutex m_mutex;
+        std::atomic<Number> m_gyroScalar;
+};
+
+/**
+ * @brief A type which can be read like an IMU
+ *
+ * Like EncoderLike, code which takes an IMULike template parameter calls a final implementation, like
+ * V5InertialSensor or MockIMU, directly, and still works through an IMU reference.
+ */
+template <typename I>
+concept IMULike = requires(const I& imu) {
+    { imu.getRotation() } -> std::same_as<Angle>;
+    { imu.isConnected() } -> std::convertible_to<int32_t>;
 };
 } // namespace lemlib
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "hardware/IMU/V5InertialSensor.hpp"
+#include "hardware/Port.hpp"
+#include <initializer_list>
+#include <vector>
+
+namespace lemlib {
+/** the variance of an angle */
+using AngleVariance = Multiplied<Angle, Angle>;
+
+/**
+ * @brief Several V5 Inertial Sensors which measure a single rotation together
+ *
+ * Every sensor is read once per call to getRotation. Sensors which disagree with the median of all the readings by
+ * more than the outlier threshold are left out, and the rest are averaged, weighted by how much each sensor has
+ * disagreed with the combined rotation recently. Sensors which are noisier, or drift, get less weight. This gives a
+ * single rotation with less noise than any of the sensors, which keeps working if a sensor fails or disconnects.
+ *
+ * Sensors which disconnect are left out until they reconnect, and their rotation is then set to the combined rotation
+ * of the others, like motors which reconnect to a MotorGroup.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::IMUArray imus({1, 2, 3});
+ *
+ * void initialize() {
+ *     // every sensor calibrates at the same time
+ *     imus.calibrate();
+ *     while (imus.isCalibrating()) pros::delay(10);
+ * }
+ *
+ * void opcontrol() {
+ *     std::cout << "Heading: " << to_cDeg(imus.getRotation()) << std::endl;
+ * }
+ * @endcode
+ */
+class IMUArray : public IMU {
+    public:
+        /**
+         * @brief Construct a new IMU Array
+         *
+         * @param ports the ports of the V5 Inertial Sensors
+         * @param scalar the scalar to apply to the gyro readings of every sensor. Defaults to 1
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::IMUArray imus({1, 2, 3});
+         * }
+         * @endcode
+         */
+        IMUArray(std::initializer_list<SmartPort> ports, Number scalar = 1.0);
+        /**
+         * @brief IMUArray copy constructor
+         *
+         * @param other the IMUArray to copy
+         */
+        IMUArray(const IMUArray& other);
+        /**
+         * @brief calibrate every sensor at the same time
+         *
+         * This function is non-blocking
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: no sensor could be calibrated
+         *
+         * @return 0 at least one sensor started calibrating
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t calibrate() override;
+        /**
+         * @brief check if the sensors are calibrated
+         *
+         * @return true no sensor is calibrating, and at least one sensor is calibrated
+         * @return false the sensors are not calibrated
+         */
+        int32_t isCalibrated() const override;
+        /**
+         * @brief check if any sensor is calibrating
+         *
+         * @return true at least one sensor is calibrating
+         * @return false no sensor is calibrating
+         */
+        int32_t isCalibrating() const override;
+        /**
+         * @brief whether any sensor is connected
+         *
+         * @return true at least one sensor is connected
+         * @return false no sensor is connected
+         */
+        int32_t isConnected() const override;
+        /**
+         * @brief Get the combined rotation of the sensors
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: no sensor could be read
+         *
+         * @return Angle the combined rotation
+         * @return INFINITY error occurred, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     std::cout << "Rotation: " << to_cDeg(imus.getRotation()) << std::endl;
+         * }
+         * @endcode
+         */
+        Angle getRotation() const override;
+        /**
+         * @brief Set the rotation of every connected sensor
+         *
+         * @param rotation the new rotation
+         * @return 0 at least one sensor was set
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t setRotation(Angle rotation) override;
+        /**
+         * @brief Set the gyro scalar of every sensor
+         *
+         * @param scalar the scalar
+         * @return int32_t always returns 0
+         */
+        int32_t setGyroScalar(Number scalar) override;
+        /**
+         * @brief Set how far a reading can be from the median of all readings before it is left out
+         *
+         * @param threshold the threshold. Defaults to 3 degrees
+         * @return int32_t always returns 0
+         */
+        int32_t setOutlierThreshold(Angle threshold);
+        /**
+         * @brief Get the variance of every sensor around the combined rotation
+         *
+         * @return std::vector<AngleVariance> the variances, in the same order as the ports
+         */
+        std::vector<AngleVariance> getVariances() const;
+        /**
+         * @brief Get the number of sensors which were used for the latest rotation
+         *
+         * @return int32_t the number of sensors which were connected and not outliers
+         */
+        int32_t getSize() const;
+    private:
+        struct SensorInfo {
+                V5InertialSensor imu;
+                // whether the sensor could be read the last time the rotation was read
+                bool connectedLastRead;
+                // the exponentially weighted variance of the sensor around the combined rotation
+                AngleVariance variance;
+        };
+
+        /** how much of the variance is replaced by the latest squared error, every reading */
+        static constexpr double VARIANCE_GAIN = 0.05;
+        /** the smallest variance, so no sensor can get all the weight */
+        static constexpr AngleVariance MIN_VARIANCE = AngleVariance(1E-10);
+        /** the variance every sensor starts with */
+        static constexpr AngleVariance INITIAL_VARIANCE = AngleVariance(1E-4);
+
+        // reading the rotation changes the sensors, as sensors which reconnect are set to the combined rotation
+        mutable std::vector<SensorInfo> m_sensors;
+        // the readings of the latest pass, reused between calls so reading the rotation never allocates memory
+        mutable std::vector<Angle> m_readings;
+        mutable std::vector<Angle> m_sorted;
+        Angle m_outlierThreshold = 3_stDeg;
+        mutable int32_t m_used = 0;
+};
+} // namespace lemlib
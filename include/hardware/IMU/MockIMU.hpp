@@ -0,0 +1,122 @@
+#pragma once
+
+#include "hardware/IMU/IMU.hpp"
+#include <errno.h>
+
+namespace lemlib {
+/**
+ * @brief IMU implementation which reads a rotation set by the program, instead of a device
+ *
+ * Like MockEncoder, every function is defined in the header and the class is final, so calls through the concrete
+ * type are inlined, and calls through an IMU reference only cost the virtual call. Calibration finishes immediately.
+ * The reading is in degrees clockwise, like the SDK reports it, and is converted and scaled by the gyro scalar the same
+ * way as V5InertialSensor does.
+ *
+ * Unlike the device implementations, a mock IMU is not thread safe.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::MockIMU imu;
+ * imu.setReading(90);
+ * Angle heading = imu.getRotation(); // 90 degrees clockwise, which is 0_stDeg
+ * @endcode
+ */
+class MockIMU final : public IMU {
+    public:
+        /**
+         * @brief Construct a new, connected and calibrated Mock IMU
+         *
+         * @param reading the rotation the IMU reads, in degrees clockwise, before the gyro scalar and offset are
+         * applied. Defaults to 0
+         * @param scalar the gyro scalar. Defaults to 1
+         */
+        MockIMU(double reading = 0, Number scalar = 1.0)
+            : IMU(scalar),
+              m_reading(reading) {}
+
+        /**
+         * @brief Reset the rotation to 0, as a real IMU does when it is calibrated
+         *
+         * @return 0 on success
+         * @return INT_MAX on failure, setting errno like setRotation
+         */
+        int32_t calibrate() override { return setRotation(0_stDeg); }
+
+        /**
+         * @brief whether the IMU is calibrated
+         *
+         * @return 1 always, as calibration finishes immediately
+         */
+        int32_t isCalibrated() const override { return 1; }
+
+        /**
+         * @brief whether the IMU is calibrating
+         *
+         * @return 0 always
+         */
+        int32_t isCalibrating() const override { return 0; }
+
+        /**
+         * @brief whether the mock is connected
+         *
+         * @return 0 if it was disconnected with setConnected
+         * @return 1 if it is connected
+         */
+        int32_t isConnected() const override { return m_connected; }
+
+        /**
+         * @brief Get the reading, scaled by the gyro scalar, plus the offset set by setRotation
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the mock is disconnected
+         *
+         * @return Angle the rotation, or INFINITY if an error occurred, setting errno
+         */
+        Angle getRotation() const override {
+            if (!m_connected) {
+                errno = ENODEV;
+                return from_stDeg(INFINITY);
+            }
+            return from_cDeg(m_reading * m_gyroScalar.load(std::memory_order_relaxed)) + m_offset;
+        }
+
+        /**
+         * @brief Set the rotation the IMU reads, by changing its offset
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the mock is disconnected
+         *
+         * @param rotation the rotation to set it to
+         * @return 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t setRotation(Angle rotation) override {
+            if (!m_connected) {
+                errno = ENODEV;
+                return INT32_MAX;
+            }
+            m_offset = rotation - from_cDeg(m_reading * m_gyroScalar.load(std::memory_order_relaxed));
+            return 0;
+        }
+
+        /**
+         * @brief Set the raw rotation the mock reads, like a device measuring a new rotation
+         *
+         * @param reading the rotation in degrees clockwise, before the gyro scalar and offset
+         */
+        void setReading(double reading) { m_reading = reading; }
+
+        /**
+         * @brief Connect or disconnect the mock
+         *
+         * @param connected whether the mock is connected
+         */
+        void setConnected(bool connected) { m_connected = connected; }
+    private:
+        double m_reading;
+        Angle m_offset = 0_stDeg;
+        bool m_connected = true;
+};
+} // namespace lemlib
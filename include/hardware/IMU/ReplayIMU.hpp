@@ -0,0 +1,96 @@
+#pragma once
+
+#include "hardware/IMU/IMU.hpp"
+#include "hardware/ReplayLog.hpp"
+#include <atomic>
+
+namespace lemlib {
+/**
+ * @brief IMU implementation which plays back the rotation of an IMU recorded by TelemetryLogger
+ *
+ * The recorded rotation is already calibrated, so the IMU is always calibrated. The gyro scalar is applied on top of
+ * the recording, so a scalar can be tuned offline.
+ */
+class ReplayIMU : public IMU {
+    public:
+        /**
+         * @brief Construct a new Replay IMU
+         *
+         * @param log the log to play back. It must outlive the IMU
+         * @param device the id the IMU was logged with, by TelemetryLogger::logIMU
+         * @param scalar the gyro scalar applied to the recorded rotation. Defaults to 1
+         *
+         * @b Example:
+         * @code {.cpp}
+         * lemlib::ReplayLog log;
+         * lemlib::ReplayIMU imu(log, 3);
+         * @endcode
+         */
+        ReplayIMU(const ReplayLog& log, uint16_t device, Number scalar = 1.0);
+        /**
+         * @brief ReplayIMU copy constructor
+         *
+         * @param other the ReplayIMU to copy
+         */
+        ReplayIMU(const ReplayIMU& other);
+        /**
+         * @brief Reset the rotation to 0, as a real IMU does when it is calibrated
+         *
+         * @return 0 on success
+         * @return INT_MAX on failure, setting errno like setRotation
+         */
+        int32_t calibrate() override;
+        /**
+         * @brief whether the IMU is calibrated
+         *
+         * @return 1 always, as the recording is already calibrated
+         */
+        int32_t isCalibrated() const override;
+        /**
+         * @brief whether the IMU is calibrating
+         *
+         * @return 0 always
+         */
+        int32_t isCalibrating() const override;
+        /**
+         * @brief whether the IMU was connected at the playback time
+         *
+         * @return 0 if it was not connected, or no record of it has been played yet
+         * @return 1 if it was connected
+         */
+        int32_t isConnected() const override;
+        /**
+         * @brief Get the recorded rotation at the playback time
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the IMU was not connected, or no record of it has been played yet
+         *
+         * @return Angle the rotation, or INFINITY if an error occurred, setting errno
+         */
+        Angle getRotation() const override;
+        /**
+         * @brief Set the rotation the IMU reads at the playback time
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the IMU was not connected, or no record of it has been played yet
+         *
+         * @param rotation the rotation to set it to
+         * @return 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t setRotation(Angle rotation) override;
+    private:
+        /**
+         * @brief Read the recorded rotation, scaled by the gyro scalar, before the offset is added
+         *
+         * @return Angle the rotation, or INFINITY with errno set to ENODEV
+         */
+        Angle readRotation() const;
+
+        const ReplayLog& m_log;
+        const uint16_t m_device;
+        std::atomic<Angle> m_offset = 0_stDeg;
+};
+} // namespace lemlib
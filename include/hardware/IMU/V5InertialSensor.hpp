@@ -1,11 +1,75 @@
 #pragma once
 
+#include "hardware/DeviceRegistry.hpp"
+#include "hardware/DoubleBuffer.hpp"
 #include "hardware/Port.hpp"
 #include "hardware/IMU/IMU.hpp"
 #include "pros/imu.hpp"
+#include "units/Accumulator.hpp"
+#include "units/Vector3D.hpp"
+#include <atomic>
+#include <span>
+#include <vector>
 
 namespace lemlib {
-class V5InertialSensor : public IMU {
+/** the variance of an angular velocity */
+using AngularVelocityVariance = Multiplied<AngularVelocity, AngularVelocity>;
+
+/**
+ * @brief Settings for integrating the gyro rate of a V5 Inertial Sensor
+ */
+struct RateIntegrationSettings {
+        /** how often the gyro rate is read. The sensor updates every 10 ms unless its data rate was changed */
+        Time period = 10_msec;
+        /** the sensor is considered stationary while its bias corrected rate is smaller than this */
+        AngularVelocity stationaryThreshold = 1_degps;
+        /** how long the rate has to stay below the threshold before the sensor is considered stationary */
+        Time stationaryTime = 500_msec;
+        /** how quickly the bias estimate follows the rate while the sensor is stationary */
+        Time biasTimeConstant = 2_sec;
+        /** how quickly the mean and variance of the rate follow new readings */
+        Time noiseTimeConstant = 100_msec;
+};
+
+/**
+ * @brief The state of a V5 Inertial Sensor which integrates its gyro rate
+ */
+struct GyroState {
+        /** the time of the latest gyro reading, measured since the program started */
+        Time timestamp = 0_sec;
+        /** the integrated rotation, like getRotation. INFINITY if the sensor could not be read */
+        Angle rotation = from_stDeg(INFINITY);
+        /** the bias corrected rate, counterclockwise positive. INFINITY if the sensor could not be read */
+        AngularVelocity rate = from_radps(INFINITY);
+        /** the variance of the measured rate around its recent mean */
+        AngularVelocityVariance rateVariance = AngularVelocityVariance(INFINITY);
+        /** the estimated bias, which is subtracted from every reading, counterclockwise positive */
+        AngularVelocity bias = 0_radps;
+        /** whether the sensor is considered stationary, in which case the bias is being estimated */
+        bool stationary = false;
+};
+
+/**
+ * @brief Every channel of a V5 Inertial Sensor, read together
+ *
+ * Every vector is in the axes of the sensor, with the signs the sensor reports them with, and without the gyro scalar.
+ * The components of a vector are INFINITY if it could not be read.
+ */
+struct IMUReadout {
+        /** when the channels were read, measured since the program started */
+        Time timestamp = 0_sec;
+        /** the acceleration measured by the accelerometer, which includes gravity */
+        units::Vector3D<LinearAcceleration> acceleration = units::Vector3D<LinearAcceleration>(
+            from_mps2(INFINITY), from_mps2(INFINITY), from_mps2(INFINITY));
+        /** the rates of the gyro around the x, y and z axes */
+        units::Vector3D<AngularVelocity> gyroRates = units::Vector3D<AngularVelocity>(
+            from_radps(INFINITY), from_radps(INFINITY), from_radps(INFINITY));
+        /** the roll, pitch and yaw of the sensor, which are its rotations around the x, y and z axes */
+        units::Vector3D<Angle> orientation = units::Vector3D<Angle>(
+            from_stDeg(INFINITY), from_stDeg(INFINITY), from_stDeg(INFINITY));
+};
+
+class V5InertialSensor final : public IMU {
     public:
         /**
          * @brief Construct a new V5 Inertial Sensor
@@ -31,6 +95,8 @@ class V5InertialSensor : public IMU {
          * @param other the V5InertialSensor to copy
          */
         V5InertialSensor(const V5InertialSensor& other);
+        // the simulator only implements the PROS C api, so PROS objects can't be converted
+#ifndef LEMLIB_SIM
         /**
          * @brief Create a new V5 Inertial Sensor
          *
@@ -46,6 +112,25 @@ class V5InertialSensor : public IMU {
          * @endcode
          */
         static V5InertialSensor from_pros_imu(pros::Imu imu, Number scalar = 1.0);
+        /**
+         * @brief Create a V5 Inertial Sensor for every pros inertial sensor, in one pass
+         *
+         * The vector is reserved once, and only the ports are read from the pros sensors, so no SDK calls are made.
+         *
+         * @param imus the inertial sensors
+         * @param scalar the scalar to apply to the gyro readings of every sensor. Defaults to 1
+         * @return std::vector<V5InertialSensor> the sensors, in the same order
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *    const std::array<pros::Imu, 2> prosImus {pros::Imu(1), pros::Imu(2)};
+         *    std::vector<lemlib::V5InertialSensor> imus = lemlib::V5InertialSensor::from_pros_imus(prosImus);
+         * }
+         * @endcode
+         */
+        static std::vector<V5InertialSensor> from_pros_imus(std::span<const pros::Imu> imus, Number scalar = 1.0);
+#endif
         /**
          * @brief calibrate the V5 Inertial Sensor
          *
@@ -125,7 +210,8 @@ class V5InertialSensor : public IMU {
          * @brief whether the V5 Inertial Sensor is connected
          *
          * This function can't fail, as any failure is interpreted by either VEXOS or PROS as the IMU not being
-         * connected. This function is non-blocking
+         * connected. This function is non-blocking. The connection is read from the latest snapshot of the
+         * DeviceRegistry, so this is only a lookup, and can be up to one scan period old
          *
          * @return true the IMU is connected
          * @return false the IMU is not connected
@@ -175,6 +261,13 @@ class V5InertialSensor : public IMU {
          * @endcode
          */
         Angle getRotation() const override;
+        /**
+         * @brief Get the rotation of the V5 Inertial Sensor, or the error which prevented reading it
+         *
+         * @return Result<Angle> the rotation, or the error set by the SDK, or EAGAIN if the rate is being integrated
+         * but no reading has been integrated yet
+         */
+        Result<Angle> tryGetRotation() const override;
         /**
          * @brief Set the rotation of the V5 Inertial Sensor
          *
@@ -207,8 +300,286 @@ class V5InertialSensor : public IMU {
          * @endcode
          */
         int32_t setRotation(Angle rotation) override;
+        /**
+         * @brief Start integrating the gyro rate of the sensor in a dedicated task
+         *
+         * The heading integrated by the sensor itself is only as good as its calibration, and is read with the latency
+         * of its filter. In this mode, a task reads the raw gyro rate every period and integrates it with the time
+         * between readings. Whenever the rate stays small for long enough, the sensor is assumed to be stationary, and
+         * the bias of the rate is estimated and removed from every reading.
+         *
+         * While the rate is integrated, getRotation and setRotation use the integrated rotation. It starts at the
+         * rotation measured by the sensor, so the rotation doesn't jump. Calibrating the sensor resets it, and the
+         * bias estimate, to 0.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EBUSY: the rate is already being integrated
+         * ENOMEM: the task could not be created
+         *
+         * @param settings the settings of the integration
+         * @param priority the priority of the task
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * lemlib::V5InertialSensor imu(1);
+         *
+         * void initialize() {
+         *     imu.calibrate();
+         *     while (imu.isCalibrating()) pros::delay(10);
+         *     imu.startRateIntegration({.period = 5_msec});
+         * }
+         * @endcode
+         */
+        int32_t startRateIntegration(RateIntegrationSettings settings = {},
+                                     uint32_t priority = TASK_PRIORITY_DEFAULT + 1);
+        /**
+         * @brief Stop integrating the gyro rate
+         *
+         * getRotation uses the rotation integrated by the sensor again. It may be different from the integrated
+         * rotation, so call setRotation afterwards if the rotation has to stay the same. This function waits until
+         * the task has exited
+         */
+        void stopRateIntegration();
+        /**
+         * @brief Whether the gyro rate is being integrated
+         *
+         * @return 1 the gyro rate is being integrated
+         * @return 0 the sensor integrates its own rotation
+         */
+        int32_t isIntegratingRate() const;
+        /**
+         * @brief Get the rate the sensor is rotating at, scaled by the gyro scalar
+         *
+         * While the gyro rate is integrated, this is the latest bias corrected rate read by the task. Otherwise, the
+         * gyro is read directly.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENXIO: The given value is not within the range of V5 ports (1-21).
+         * ENODEV: The port cannot be configured as an Inertial Sensor
+         * EAGAIN: The sensor is still calibrating
+         *
+         * @return AngularVelocity the rate, counterclockwise positive
+         * @return INFINITY error occurred
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     std::cout << "IMU rate: " << to_degps(imu.getRate()) << std::endl;
+         * }
+         * @endcode
+         */
+        AngularVelocity getRate() const;
+        /**
+         * @brief Get the rotation, rate, rate variance and bias estimate of the integrated gyro rate at once
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the gyro rate is not being integrated
+         *
+         * @return GyroState the state. The rotation and the rate are INFINITY on failure
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     const lemlib::GyroState state = imu.getGyroState();
+         *     std::cout << "Bias: " << to_degps(state.bias) << std::endl;
+         * }
+         * @endcode
+         */
+        GyroState getGyroState() const;
+        /**
+         * @brief Read the accelerometer, the gyro rates and the orientation together
+         *
+         * The channels are read back to back in a single pass, while holding the mutex, and the readout is kept for
+         * the readout period, so getAcceleration, getGyroRates and getOrientation called in the same cycle all come
+         * from the same readout, read once.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENXIO: The given value is not within the range of V5 ports (1-21).
+         * ENODEV: The port cannot be configured as an Inertial Sensor
+         * EAGAIN: The sensor is still calibrating
+         *
+         * @return IMUReadout the readout. Vectors which could not be read are INFINITY, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     const lemlib::IMUReadout readout = imu.getReadout();
+         *     // the robot is tipping if gravity isn't straight down the z axis
+         *     const Angle tilt = acos(abs(readout.acceleration.z) / readout.acceleration.magnitude());
+         * }
+         * @endcode
+         */
+        IMUReadout getReadout() const;
+        /**
+         * @brief Get the acceleration measured by the accelerometer, from the readout
+         *
+         * This function uses the same values of errno as getReadout
+         *
+         * @return units::Vector3D<LinearAcceleration> the acceleration, which includes gravity
+         * @return INFINITY error occurred, setting errno
+         */
+        units::Vector3D<LinearAcceleration> getAcceleration() const;
+        /**
+         * @brief Get the rates of the gyro around all 3 axes, from the readout
+         *
+         * Unlike getRate, these are not scaled or corrected for bias, and z has the sign the sensor reports it with.
+         *
+         * This function uses the same values of errno as getReadout
+         *
+         * @return units::Vector3D<AngularVelocity> the rates around the x, y and z axes
+         * @return INFINITY error occurred, setting errno
+         */
+        units::Vector3D<AngularVelocity> getGyroRates() const;
+        /**
+         * @brief Get the roll, pitch and yaw of the sensor, from the readout
+         *
+         * This function uses the same values of errno as getReadout
+         *
+         * @return units::Vector3D<Angle> the roll, pitch and yaw
+         * @return INFINITY error occurred, setting errno
+         */
+        units::Vector3D<Angle> getOrientation() const;
+        /**
+         * @brief Set how long a readout is used for before the sensor is read again
+         *
+         * @param period the period, rounded to whole milliseconds. Defaults to 10 ms, which is how often the sensor
+         * updates unless its data rate was changed. 0 reads the sensor on every call
+         * @return int32_t always returns 0
+         */
+        int32_t setReadoutPeriod(Time period);
+        /**
+         * @brief Get how long a readout is used for before the sensor is read again
+         *
+         * @return Time the period
+         */
+        Time getReadoutPeriod() const;
+        /** the fastest rate the sensor can update at */
+        static constexpr Time MIN_DATA_RATE = 5_msec;
+        /**
+         * @brief Set how often the V5 Inertial Sensor updates its readings
+         *
+         * The sensor updates every 10 ms by default, and can update as often as every MIN_DATA_RATE. A faster rate
+         * lowers the latency of the heading, which matters most when the robot turns quickly. The rate is rounded down
+         * to a multiple of 5 ms, like the sensor does, and the readout period is set to the same rate. The sensor goes
+         * back to 10 ms when it loses power, so the rate has to be set again after it reconnects.
+         *
+         * A DevicePoller which samples the sensor should use the same period, and can align its samples with the
+         * updates of the sensor, see DevicePoller::syncToIMU.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the rate is shorter than MIN_DATA_RATE, or not finite
+         * ENXIO: The given value is not within the range of V5 ports (1-21).
+         * ENODEV: The port cannot be configured as an Inertial Sensor
+         *
+         * @param rate how often the sensor updates. Defaults to MIN_DATA_RATE, the fastest rate it supports
+         * @return 0 on success
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     imu.setDataRate();
+         *     poller.setPeriod(imu.getDataRate());
+         *     poller.syncToIMU(poller.addIMU(imu));
+         *     poller.start();
+         * }
+         * @endcode
+         */
+        int32_t setDataRate(Time rate = MIN_DATA_RATE);
+        /**
+         * @brief Get how often the V5 Inertial Sensor updates its readings
+         *
+         * @return Time the rate last set with setDataRate, or 10 ms if it was never set
+         */
+        Time getDataRate() const;
+        /**
+         * @brief Destroy the V5 Inertial Sensor, stopping the integration task if it is running
+         */
+        ~V5InertialSensor() override;
     private:
-        Angle m_offset = 0_stRot;
-        mutable pros::Imu m_imu;
+        /**
+         * @brief The latest state of the integration, in the units PROS uses: clockwise degrees, without the gyro
+         * scalar or the offset. These are applied when the state is read, so changing them takes effect immediately
+         */
+        struct RateSample {
+                Time timestamp = 0_sec;
+                double rotation = 0;
+                double rate = 0;
+                double rateVariance = 0;
+                double bias = 0;
+                bool stationary = false;
+                bool valid = false;
+        };
+
+        /**
+         * @brief The state of the integration which is only used by the integration task
+         */
+        struct RateIntegrator {
+                RateIntegrationSettings settings;
+                // whether the rotation has been set to the rotation measured by the sensor itself
+                bool synced = false;
+                // whether there is a previous reading to integrate from
+                bool initialized = false;
+                Time lastTimestamp = 0_sec;
+                // the bias corrected rate of the last reading, for trapezoidal integration
+                double lastRate = 0;
+                // the integrated rotation, in clockwise degrees. Thousands of small steps are added every minute, so
+                // the sum is compensated
+                units::Accumulator<Number> rotation {};
+                double bias = 0;
+                double mean = 0;
+                double variance = 0;
+                Time stationaryFor = 0_sec;
+        };
+
+        /**
+         * @brief Get the rotation without the gyro scalar or the offset, from the integration task if it is running
+         *
+         * @return double the rotation, in clockwise degrees
+         * @return INFINITY error occurred, setting errno
+         */
+        double readRotation() const;
+        /**
+         * @brief Read the gyro rate once, and integrate it
+         *
+         * This is called by the integration task every period
+         */
+        void integrateRate();
+        /**
+         * @brief Call integrateRate every period until the integration is stopped
+         */
+        static void rateTaskFunction(void* imu);
+
+        std::atomic<Angle> m_offset = 0_stRot;
+        // the flags are kept next to the port, and the words after them, so none of them are padded to 8 bytes
+        SmartPort m_port;
+        // set by calibrate, so the task restarts the integration once the sensor has been calibrated
+        std::atomic<bool> m_resetRequested = false;
+        // the task is not deleted from outside, as it could be holding the mutex. Instead it is asked to exit
+        std::atomic<bool> m_integrating = false;
+        std::atomic<bool> m_taskExited = true;
+        // whether the latest readout was read, only touched with the mutex held
+        mutable bool m_readoutRead = false;
+        // the claim of the port in the DeviceRegistry
+        PortClaim m_claim;
+        mutable int m_readoutError = 0;
+        mutable uint32_t m_readoutTime = 0;
+        std::atomic<uint32_t> m_readoutPeriod = 10;
+        // the data rate in milliseconds
+        std::atomic<uint32_t> m_dataRate = 10;
+        // only used by the integration task, or before it is started
+        RateIntegrator m_integrator;
+        DoubleBuffer<RateSample> m_rateSample;
+        // the latest readout, only touched with the mutex held
+        mutable IMUReadout m_readout;
 };
 } // namespace lemlib
\ No newline at end of file
@@ -0,0 +1,217 @@
+#pragma once
+
+#include "hardware/Encoder/Encoder.hpp"
+#include "hardware/IMU/IMU.hpp"
+#include "units/Matrix.hpp"
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief How a WheelAidedIMU weighs the IMU against the wheels
+ *
+ * Every value is a standard deviation. Lower values mean the source is trusted more.
+ */
+struct WheelAidedIMUSettings {
+        /** how far the heading of the IMU wanders in one second, on top of its drift */
+        Angle gyroNoise = 0.05_stDeg;
+        /** how far the drift rate of the IMU changes in one second */
+        AngularVelocity driftNoise = 0.002_degps;
+        /** how far the heading measured by the wheels is off, while they are not slipping */
+        Angle wheelNoise = 1_stDeg;
+        /**
+         * wheel headings which disagree with the filter by more than this many standard deviations are treated as the
+         * wheels slipping, and are not used. The wheels are then measured from the heading of the filter
+         */
+        double slipThreshold = 5;
+};
+
+/**
+ * @brief IMU implementation which corrects the drift of an IMU with the heading measured by tracking wheels
+ *
+ * The heading of a V5 Inertial Sensor drifts slowly over a long run, while the heading measured by a pair of tracking
+ * wheels, for example with a DifferentialEncoder, doesn't drift while the wheels grip, but jumps when they slip. A
+ * two state Kalman filter estimates the heading and the drift rate of the IMU: the change in the rotation of the IMU
+ * moves the heading every update, minus the estimated drift, and the heading of the wheels corrects it. Corrections
+ * too large to be noise are treated as the wheels slipping, and are skipped.
+ *
+ * If the IMU can't be read, the heading follows the wheels until it can be read again.
+ *
+ * The filter is updated every time the rotation is read, in constant time, with no memory allocated.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::V5InertialSensor imu(10);
+ * lemlib::V5RotationSensor leftWheel(1);
+ * lemlib::V5RotationSensor rightWheel(2);
+ * lemlib::DifferentialEncoder wheelHeading(leftWheel, rightWheel, 2.75_in, 10_in);
+ * lemlib::WheelAidedIMU heading(imu, wheelHeading);
+ *
+ * void initialize() {
+ *     heading.calibrate();
+ *     while (heading.isCalibrating()) pros::delay(10);
+ * }
+ *
+ * void opcontrol() {
+ *     while (true) {
+ *         std::cout << "Heading: " << to_cDeg(heading.getRotation()) << std::endl;
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class WheelAidedIMU : public IMU {
+    public:
+        /**
+         * @brief Construct a new Wheel Aided IMU
+         *
+         * @param imu the IMU whose drift is corrected. It must outlive the wheel aided IMU
+         * @param wheelHeading an encoder measuring the heading of the robot from its wheels, counterclockwise positive
+         * like the rotation of an IMU. It must outlive the wheel aided IMU
+         * @param settings how the IMU is weighed against the wheels
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     // the wheels are close together, so they measure heading badly
+         *     lemlib::WheelAidedIMU heading(imu, wheelHeading, {.wheelNoise = 3_stDeg});
+         * }
+         * @endcode
+         */
+        WheelAidedIMU(IMU& imu, Encoder& wheelHeading, WheelAidedIMUSettings settings = {});
+        /**
+         * @brief WheelAidedIMU copy constructor
+         *
+         * The copy uses the same IMU and wheels, and the same settings, and starts a new estimate
+         *
+         * @param other the WheelAidedIMU to copy
+         */
+        WheelAidedIMU(const WheelAidedIMU& other);
+        /**
+         * @brief calibrate the IMU
+         *
+         * The estimate starts over when the IMU is calibrated. This function is non-blocking
+         *
+         * @return 0 the IMU started calibrating
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t calibrate() override;
+        /**
+         * @brief check if the IMU is calibrated
+         *
+         * @return true the IMU is calibrated
+         * @return false the IMU is not calibrated
+         */
+        int32_t isCalibrated() const override;
+        /**
+         * @brief check if the IMU is calibrating
+         *
+         * @return true the IMU is calibrating
+         * @return false the IMU is not calibrating
+         */
+        int32_t isCalibrating() const override;
+        /**
+         * @brief whether the IMU or the wheels are connected
+         *
+         * @return true the filter can measure the heading
+         * @return false neither the IMU nor the wheels are connected
+         */
+        int32_t isConnected() const override;
+        /**
+         * @brief Update the filter, and get the estimated rotation
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: neither the IMU nor the wheels could be read
+         *
+         * @return Angle the estimated rotation
+         * @return INFINITY error occurred, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     std::cout << "Rotation: " << to_cDeg(heading.getRotation()) << std::endl;
+         * }
+         * @endcode
+         */
+        Angle getRotation() const override;
+        /**
+         * @brief Set the estimated rotation
+         *
+         * The estimated drift is kept, as it belongs to the IMU, not to the heading it started from.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: neither the IMU nor the wheels could be read
+         *
+         * @param rotation the new rotation
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t setRotation(Angle rotation) override;
+        /**
+         * @brief Set the gyro scalar of the IMU
+         *
+         * @param scalar the scalar
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t setGyroScalar(Number scalar) override;
+        /**
+         * @brief Set how the IMU is weighed against the wheels
+         *
+         * The estimate is kept.
+         *
+         * @param settings the settings
+         * @return int32_t always returns 0
+         */
+        int32_t setSettings(WheelAidedIMUSettings settings);
+        /**
+         * @brief Get how the IMU is weighed against the wheels
+         *
+         * @return WheelAidedIMUSettings the settings
+         */
+        WheelAidedIMUSettings getSettings() const;
+        /**
+         * @brief Get the estimated drift rate of the IMU, as of the latest update
+         *
+         * @return AngularVelocity the drift rate, which is subtracted from the rotation of the IMU
+         */
+        AngularVelocity getDrift() const;
+        /**
+         * @brief Get how many times the wheels were treated as slipping
+         *
+         * @return int32_t the number of wheel headings which were not used
+         */
+        int32_t getSlipCount() const;
+    private:
+        /**
+         * @brief Start a new estimate at a rotation, measuring the IMU and wheels from it
+         *
+         * Called with the mutex held.
+         *
+         * @param rotation the rotation, in radians
+         * @param imu the rotation of the IMU, in radians, or INFINITY if it could not be read
+         * @param wheels the heading of the wheels, in radians, or INFINITY if they could not be read
+         * @param time the time, in seconds
+         * @param keepDrift whether to keep the estimated drift, instead of starting it over at 0
+         */
+        void restart(double rotation, double imu, double wheels, double time, bool keepDrift) const;
+
+        IMU& m_imu;
+        Encoder& m_wheelHeading;
+        WheelAidedIMUSettings m_settings;
+        // the filter, only touched with the mutex held. Everything is in radians and seconds
+        mutable bool m_started = false;
+        mutable double m_heading = 0;
+        mutable double m_drift = 0;
+        // the covariance of the heading and the drift
+        mutable units::SquareMatrix<Number, 2> m_covariance;
+        // the previous rotation of the IMU, or INFINITY if the IMU couldn't be read
+        mutable double m_lastIMU = 0;
+        mutable double m_lastTime = 0;
+        // the wheel heading plus this offset is the heading of the robot. Not anchored while the wheels can't be read
+        mutable bool m_wheelsAnchored = false;
+        mutable double m_wheelOffset = 0;
+        mutable int32_t m_slips = 0;
+};
+} // namespace lemlib
@@ -0,0 +1,236 @@
+#pragma once
+
+#include "hardware/Topic.hpp"
+#include "units/Pose.hpp"
+#include "pros/rtos.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief A pose rounded to fit in 6 bytes, for sending over a radio
+ *
+ * The position is rounded to a millimeter, which covers 32 meters in either direction, and the orientation to 1/65536
+ * of a turn. Records are sent exactly as they are laid out in memory, which is little-endian on every brain.
+ */
+struct PoseRecord {
+        /** the x position, in millimeters, or INT16_MIN if the pose isn't known */
+        int16_t x = 0;
+        /** the y position, in millimeters */
+        int16_t y = 0;
+        /** the orientation, in 1/65536 of a turn counterclockwise from the positive x axis */
+        uint16_t theta = 0;
+};
+
+static_assert(sizeof(PoseRecord) == 6, "pose records are sent as raw 6 byte structs");
+
+/**
+ * @brief Round a pose into a record
+ *
+ * A position outside of the range of a record is clamped to it. A pose which isn't finite, like the pose of odometry
+ * which lost its sensors, is stored as unknown.
+ *
+ * @param pose the pose
+ * @return PoseRecord the record
+ */
+PoseRecord encodePose(const units::Pose& pose);
+
+/**
+ * @brief Convert a record back into a pose
+ *
+ * @param record the record
+ * @return units::Pose the pose, with every field INFINITY if the pose is unknown. The orientation is from 0 to 360
+ * degrees
+ */
+units::Pose decodePoseRecord(const PoseRecord& record);
+
+/**
+ * @brief What a robot tells its alliance partner it is about to do
+ */
+struct AllianceIntent {
+        /** a code the routines of both robots agree on, like which goal the robot is going for. 0 is nothing */
+        uint16_t code = 0;
+        /** where the robot is heading, or INFINITY if it isn't heading anywhere. Rounded like a PoseRecord */
+        units::V2Position target = units::V2Position(from_m(INFINITY), from_m(INFINITY));
+};
+
+/**
+ * @brief The latest message received from the alliance partner
+ */
+struct PartnerState {
+        /** the pose of the partner, in its own odometry frame, or INFINITY if it didn't know its pose */
+        units::Pose pose = units::Pose(from_m(INFINITY), from_m(INFINITY), from_stRad(INFINITY));
+        /** what the partner is about to do */
+        AllianceIntent intent;
+        /** when the message was received, in microseconds */
+        uint32_t timestamp = 0;
+};
+
+/**
+ * @brief Shares the pose and the intent of the robot with its alliance partner, over VEXlink
+ *
+ * Both robots run an AllianceLink on the port of a V5 Radio, with the same link id, one as the transmitter and the
+ * other as the receiver. Every period, the link receives the messages which arrived from the partner and publishes
+ * the latest one to a Topic, then sends the latest pose of its own robot and the intent set with setIntent. A message
+ * is 14 bytes, as the pose is rounded to a PoseRecord, which is 18 bytes once PROS frames it. The transmitter of a link
+ * sends 1040 bytes per second, and the receiver only 520, so start refuses a period which sends more than its end can
+ * carry, which is any period under 35 ms on the receiver.
+ *
+ * The pose is read from a Topic, like Odometry::getPoseTopic, and the intent is stored in one, so neither is ever
+ * locked by the link. Its task runs below the default priority, and never waits for the radio: a message which
+ * doesn't fit in the transmit buffer is dropped, as a newer one is sent next period anyway. The control loops of the
+ * robot never wait on the link.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::AllianceLink link(10, "team 1234 alliance", true, odom.getPoseTopic());
+ *
+ * void autonomous() {
+ *     link.start();
+ *     link.setIntent({.code = LEFT_GOAL, .target = units::V2Position(-24_in, 48_in)});
+ *     // let the partner take the goal if it already went for it
+ *     if (link.getPartnerTopic().read().intent.code == LEFT_GOAL) goToRightGoal();
+ * }
+ * @endcode
+ */
+class AllianceLink {
+    public:
+        /** the version of the message format, which messages of any other version are dropped for */
+        static constexpr uint8_t FORMAT_VERSION = 1;
+        /** the size of a message, without the framing PROS adds */
+        static constexpr size_t MESSAGE_SIZE = 14;
+        /** the bytes PROS adds to frame every message: a start byte and the size before it, and a checksum after it */
+        static constexpr size_t PROTOCOL_SIZE = 4;
+        /**
+         * @brief Construct a new Alliance Link
+         *
+         * The radio is initialized by start.
+         *
+         * @param port the port of the radio
+         * @param id the id of the link, which has to be the same on both robots, and different from every other link
+         * nearby. It must outlive the link, like a string literal
+         * @param transmitter whether this end is the transmitter, which has to be true on exactly one of the robots
+         * @param pose the topic the pose of the robot is published to. It must outlive the link
+         */
+        AllianceLink(uint8_t port, const char* id, bool transmitter, const Topic<units::Pose>& pose);
+        AllianceLink(const AllianceLink& other) = delete;
+        AllianceLink& operator=(const AllianceLink& other) = delete;
+        /**
+         * @brief Destroy the Alliance Link, stopping its task
+         */
+        ~AllianceLink();
+        /**
+         * @brief Set what this robot is about to do, which is sent with the next message
+         *
+         * Only one task may set the intent. This never blocks.
+         *
+         * @param intent the intent
+         */
+        void setIntent(const AllianceIntent& intent);
+        /**
+         * @brief Get the topic the messages of the partner are published to
+         *
+         * @return const Topic<PartnerState>& the topic. Its version is 0 until the first message arrives
+         */
+        const Topic<PartnerState>& getPartnerTopic() const;
+        /**
+         * @brief Get whether the radio is linked to the radio of the partner
+         *
+         * @return true the radios are linked
+         * @return false the radios aren't linked, or the radio isn't initialized
+         */
+        bool isConnected() const;
+        /**
+         * @brief Get how many messages of the partner were lost or dropped
+         *
+         * Messages are counted as lost from the gaps in their sequence numbers, so this includes messages which never
+         * arrived, as well as messages which arrived corrupted or in another format, once a valid message follows
+         * them. This function does not lock.
+         *
+         * @return uint32_t the number of messages
+         */
+        uint32_t getLost() const;
+        /**
+         * @brief Receive the messages which arrived, and send the latest pose and intent
+         *
+         * This is called periodically by the link task, but can also be called manually if the task is not started.
+         * It never blocks on the radio, and never allocates memory.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port is not a radio
+         * ENXIO: the radio isn't linked
+         * EBUSY: the message didn't fit in the transmit buffer, and was dropped
+         *
+         * @return int32_t 0 a message was sent
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t update();
+        /**
+         * @brief Initialize the radio, and start exchanging messages in a task
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the period sends more than the link can carry
+         * EBUSY: the link is already running
+         * ENOMEM: the task could not be created
+         * ENODEV: the port is not a radio
+         *
+         * @param period how often a message is sent. Defaults to 50 ms, which uses about 70% of the link
+         * @param priority the priority of the task. Defaults to one below the default priority, so it never delays a
+         * control loop
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t start(Time period = 50_msec, uint32_t priority = TASK_PRIORITY_DEFAULT - 1);
+        /**
+         * @brief Stop exchanging messages
+         *
+         * This function blocks until the current update finishes. The radio stays linked.
+         */
+        void stop();
+    private:
+        /**
+         * @brief The message sent over the link, laid out like it is sent
+         */
+        struct Message {
+                uint8_t version;
+                uint8_t sequence;
+                uint16_t code;
+                PoseRecord pose;
+                // the target of the intent, in millimeters, or INT16_MIN if there is none
+                int16_t targetX;
+                int16_t targetY;
+        };
+
+        static_assert(sizeof(Message) == MESSAGE_SIZE, "messages are sent as raw structs");
+
+        /**
+         * @brief the function run by the link task
+         *
+         * @param link pointer to the link
+         */
+        static void taskFunction(void* link);
+        /**
+         * @brief Receive every message which arrived, and publish the latest one
+         */
+        void receive();
+
+        const uint8_t m_port;
+        const char* const m_id;
+        const bool m_transmitter;
+        const Topic<units::Pose>& m_pose;
+        Topic<AllianceIntent> m_intent;
+        Topic<PartnerState> m_partner;
+        // the sequence number of the next message sent, and of the last message received
+        uint8_t m_sequence = 0;
+        uint8_t m_lastReceived = 0;
+        bool m_received = false;
+        std::atomic<uint32_t> m_lost = 0;
+        Time m_period = 50_msec;
+        // the task is not deleted from outside, as it could be holding a device mutex. Instead it is asked to exit
+        std::atomic<bool> m_running = false;
+        std::atomic<bool> m_taskExited = true;
+};
+} // namespace lemlib
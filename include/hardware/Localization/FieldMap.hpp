@@ -0,0 +1,120 @@
+#pragma once
+
+#include "units/Pose.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace lemlib {
+/**
+ * @brief A rectangular obstacle on the field, like a goal, with its sides parallel to the walls
+ */
+struct FieldObstacle {
+        /** the corner of the obstacle with the smallest x and y */
+        units::V2Position min;
+        /** the corner of the obstacle with the largest x and y */
+        units::V2Position max;
+};
+
+/**
+ * @brief FieldMap class
+ *
+ * A field map stores, for a grid of points on the field, how far each point is from the nearest wall or obstacle. It
+ * is calculated once when the map is constructed, which is the only time it allocates memory. Distance sensors are
+ * simulated by marching along their beam: the distance stored under the current point is a step which can't cross a
+ * wall, so a beam reaches the wall it points at in a few steps, without testing every wall and obstacle.
+ *
+ * Every cell stores the distance from its center, minus half of its diagonal, so steps never pass through a wall from
+ * anywhere in the cell. Beams stop up to about one cell in front of a wall, so the resolution should be smaller than
+ * the error of the sensors.
+ *
+ * Distances are stored as floats, in meters, so many beams can be marched at once in loops the compiler can vectorize.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * // a 12 by 12 foot field, with the origin in its center, and a goal in the middle
+ * const lemlib::FieldObstacle goal {{-6_in, -6_in}, {6_in, 6_in}};
+ * lemlib::FieldMap field({-72_in, -72_in}, {72_in, 72_in}, {&goal, 1});
+ * @endcode
+ */
+class FieldMap {
+    public:
+        /** the most steps a beam is marched for. Beams which run parallel to a wall take the most steps */
+        static constexpr size_t MAX_STEPS = 32;
+        /**
+         * @brief Construct a new Field Map
+         *
+         * The field is surrounded by walls along its edges.
+         *
+         * @param min the corner of the field with the smallest x and y
+         * @param max the corner of the field with the largest x and y
+         * @param obstacles the obstacles on the field. They are only read by the constructor
+         * @param resolution the size of a cell of the grid. Defaults to 1 inch, which is 84 KB for a 12 by 12 foot
+         * field
+         */
+        FieldMap(units::V2Position min, units::V2Position max, std::span<const FieldObstacle> obstacles = {},
+                 Length resolution = 1_in);
+        /**
+         * @brief Get how far a point is from the nearest wall or obstacle
+         *
+         * @param point the point
+         * @return Length the distance stored for the cell the point is in. 0 if the point is outside the field, or
+         * inside an obstacle
+         */
+        Length getDistance(units::V2Position point) const;
+        /**
+         * @brief Find how far a beam travels before it hits a wall or obstacle
+         *
+         * @param origin where the beam starts
+         * @param direction the direction of the beam
+         * @param maxRange the furthest the beam can travel
+         * @return Length the distance travelled, which is maxRange if nothing is hit
+         */
+        Length castRay(units::V2Position origin, Angle direction, Length maxRange) const;
+        /**
+         * @brief Find how far many beams travel before they hit a wall or obstacle
+         *
+         * Every beam is marched one step at a time, in lockstep, so the inner loop has no branches and runs over
+         * arrays of floats. Marching stops once no beam moved further than a millimeter in the last step.
+         *
+         * Positions and distances are in meters. The arrays must not overlap.
+         *
+         * @param x the x positions of the start of the beams
+         * @param y the y positions of the start of the beams
+         * @param dx the x components of the directions of the beams, which have a length of 1
+         * @param dy the y components of the directions of the beams, which have a length of 1
+         * @param out where to write the distance each beam travelled
+         * @param count the number of beams
+         * @param maxRange the furthest a beam can travel, in meters
+         */
+        void castRays(const float* x, const float* y, const float* dx, const float* dy, float* out, size_t count,
+                      float maxRange) const;
+    private:
+        /**
+         * @brief Get the distance stored for the cell a point is in
+         *
+         * Points outside the grid use the nearest cell, which touches a wall, so they read close to 0.
+         *
+         * @param x the x position, in meters
+         * @param y the y position, in meters
+         * @return float the distance, in meters
+         */
+        float lookup(float x, float y) const {
+            const int32_t column =
+                std::clamp(static_cast<int32_t>((x - m_minX) * m_inverseResolution), int32_t(0), m_columns - 1);
+            const int32_t row =
+                std::clamp(static_cast<int32_t>((y - m_minY) * m_inverseResolution), int32_t(0), m_rows - 1);
+            return m_cells[row * m_columns + column];
+        }
+
+        float m_minX;
+        float m_minY;
+        float m_inverseResolution;
+        int32_t m_columns;
+        int32_t m_rows;
+        // distances in meters, row by row. Only written by the constructor
+        std::vector<float> m_cells;
+};
+} // namespace lemlib
@@ -0,0 +1,308 @@
+#pragma once
+
+#include "hardware/Distance/DistanceSensor.hpp"
+#include "hardware/DoubleBuffer.hpp"
+#include "hardware/Localization/FieldMap.hpp"
+#include "hardware/Odometry/Odometry.hpp"
+#include "units/Pose.hpp"
+#include "pros/rtos.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief How much a ParticleFilter trusts odometry and its distance sensors
+ */
+struct ParticleFilterSettings {
+        /** the noise added to the motion measured by odometry, per unit of distance travelled */
+        Number translationNoise = 0.05;
+        /** the noise added to the rotation measured by odometry, per unit of rotation */
+        Number rotationNoise = 0.05;
+        /** the noise added to the position of every particle in every update, so particles never collapse */
+        Length minTranslationNoise = 0.05_in;
+        /** the noise added to the orientation of every particle in every update */
+        Angle minRotationNoise = 0.1_stDeg;
+        /** the smallest error of a distance sensor, which is its error for close objects */
+        Length sensorError = 15_mm;
+        /** the error of a distance sensor for far objects, as a fraction of the distance */
+        Number sensorErrorRatio = 0.05;
+        /** readings with a lower confidence than this are ignored. The V5 Distance Sensor only reports its confidence
+         * for objects further away than 200 mm, so closer readings are always used */
+        Number minConfidence = 0.5;
+        /** the particles are resampled when the effective number of particles drops below this fraction */
+        Number resampleThreshold = 0.5;
+};
+
+/**
+ * @brief The storage independent part of ParticleFilter
+ *
+ * Use ParticleFilter to create a filter.
+ */
+class ParticleFilterBase {
+    public:
+        /** the maximum number of distance sensors a filter can use */
+        static constexpr size_t MAX_SENSORS = 4;
+        /** the furthest a V5 Distance Sensor measures */
+        static constexpr Length MAX_RANGE = 2_m;
+        /** the number of floats stored per particle */
+        static constexpr size_t FLOATS_PER_PARTICLE = 12;
+
+        ParticleFilterBase(const ParticleFilterBase& other) = delete;
+        ParticleFilterBase& operator=(const ParticleFilterBase& other) = delete;
+        /**
+         * @brief Destroy the Particle Filter, stopping its task
+         */
+        ~ParticleFilterBase();
+        /**
+         * @brief Register a distance sensor
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOMEM: the filter already uses MAX_SENSORS sensors
+         *
+         * @param sensor the sensor. It must outlive the filter
+         * @param offset the pose of the sensor relative to the tracking center of the robot, facing the direction it
+         * measures. 0_stDeg faces forwards
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     // a sensor 5" left of the tracking center, facing left
+         *     filter.addSensor(leftDistance, {0_in, 5_in, 90_stDeg});
+         * }
+         * @endcode
+         */
+        int32_t addSensor(DistanceSensor& sensor, units::Pose offset);
+        /**
+         * @brief Spread the particles around a pose
+         *
+         * Particles are placed with a normal distribution around the pose, and weighted equally. Motion odometry
+         * measured before this call is ignored.
+         *
+         * @param pose the pose of the robot
+         * @param spread the standard deviation of the position of the particles
+         * @param angularSpread the standard deviation of the orientation of the particles
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void autonomous() {
+         *     // the robot starts within about an inch of the starting tile, facing forwards
+         *     filter.setPose({-60_in, -36_in, 0_stDeg}, 1_in, 2_stDeg);
+         * }
+         * @endcode
+         */
+        void setPose(units::Pose pose, Length spread = 0_in, Angle angularSpread = 0_stDeg);
+        /**
+         * @brief Get the latest estimate of the pose of the robot
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * @return units::Pose the weighted mean of the particles
+         */
+        units::Pose getPose() const;
+        /**
+         * @brief Move the particles by the motion odometry measured, weigh them by the distance sensors, and resample
+         * them if too few particles carry most of the weight
+         *
+         * This is called periodically by the filter task, but can also be called manually if the filter is not
+         * started. It never allocates memory. Sensors which can't be read, or which don't see anything, are skipped.
+         *
+         * @return int32_t 0 on success
+         */
+        int32_t update();
+        /**
+         * @brief Start the filter task
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EBUSY: the filter task is already running
+         * ENOMEM: the task could not be created
+         *
+         * @param period how often the filter is updated. Defaults to 20 ms, which is how often distance sensors measure
+         * @param priority the priority of the filter task. Defaults to the default priority, below odometry
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t start(Time period = 20_msec, uint32_t priority = TASK_PRIORITY_DEFAULT);
+        /**
+         * @brief Stop the filter task
+         *
+         * This function blocks until the current update finishes.
+         */
+        void stop();
+        /**
+         * @brief Get the number of particles
+         *
+         * @return size_t the number of particles
+         */
+        size_t getParticleCount() const;
+    protected:
+        /**
+         * @brief Construct a new Particle Filter Base
+         *
+         * @param odometry the odometry which measures the motion of the robot. Only its relative motion is used. It
+         * must outlive the filter
+         * @param field the map of the field. It must outlive the filter
+         * @param storage the storage for the particles, FLOATS_PER_PARTICLE floats per particle. It must outlive the
+         * filter
+         * @param count the number of particles
+         * @param settings the settings of the filter
+         */
+        ParticleFilterBase(Odometry& odometry, const FieldMap& field, float* storage, size_t count,
+                           const ParticleFilterSettings& settings);
+    private:
+        struct Sensor {
+                DistanceSensor* sensor = nullptr;
+                // the pose of the sensor relative to the robot, in meters and radians
+                float x = 0;
+                float y = 0;
+                float cos = 1;
+                float sin = 0;
+        };
+
+        /**
+         * @brief Get a uniformly distributed random number
+         *
+         * @return float a number from 0 to 1
+         */
+        float uniform();
+        /**
+         * @brief Get a normally distributed random number
+         *
+         * @return float a number with a mean of 0 and a standard deviation of about 1
+         */
+        float gaussian();
+        /**
+         * @brief Move every particle by the motion measured by odometry since the last update, with noise
+         *
+         * @param motion the motion, relative to the pose of the robot in the last update
+         */
+        void predict(const units::Pose& motion);
+        /**
+         * @brief Add the log likelihood of a distance reading to every particle
+         *
+         * @param sensor the sensor
+         * @param reading the distance it measured, in meters
+         */
+        void weigh(const Sensor& sensor, float reading);
+        /**
+         * @brief Turn the log likelihoods into normalized weights
+         *
+         * If every weight is 0, like before the particles are placed, the weights become uniform.
+         *
+         * @return float the effective number of particles
+         */
+        float normalize();
+        /**
+         * @brief Draw a new set of particles with systematic resampling
+         */
+        void resample();
+        /**
+         * @brief Publish the weighted mean of the particles
+         *
+         * Orientations are averaged relative to the first particle, so the mean doesn't wrap around.
+         */
+        void publishEstimate();
+        /**
+         * @brief the function run by the filter task
+         *
+         * @param filter pointer to the filter
+         */
+        static void taskFunction(void* filter);
+
+        Odometry& m_odometry;
+        const FieldMap& m_field;
+        const size_t m_count;
+        const ParticleFilterSettings m_settings;
+        // the particles, stored as arrays of floats, in meters and radians. The next arrays are filled by resample,
+        // and then swapped with the current ones. Until then, they hold the sine and cosine of the orientation of
+        // every particle, and the distance every beam travelled
+        float* m_x;
+        float* m_y;
+        float* m_theta;
+        float* m_nextX;
+        float* m_nextY;
+        float* m_nextTheta;
+        float* m_weight;
+        float* m_logLikelihood;
+        // the start and direction of the beam of the sensor being weighed, for every particle
+        float* m_beamX;
+        float* m_beamY;
+        float* m_beamDx;
+        float* m_beamDy;
+        std::array<Sensor, MAX_SENSORS> m_sensors;
+        size_t m_sensorCount = 0;
+        // the pose odometry measured in the last update, once there was an update
+        units::Pose m_lastOdometry;
+        bool m_hasLastOdometry = false;
+        uint32_t m_random = 0x9e3779b9;
+        DoubleBuffer<units::Pose> m_estimate;
+        // protects the particles and sensors. Reading the estimate never locks
+        pros::Mutex m_mutex;
+        Time m_period = 20_msec;
+        // the task is not deleted from outside, as it could be holding a device mutex. Instead it is asked to exit
+        std::atomic<bool> m_running = false;
+        std::atomic<bool> m_taskExited = true;
+};
+
+/**
+ * @brief ParticleFilter class
+ *
+ * A particle filter, or Monte Carlo localization, tracks the pose of the robot on the field with distance sensors
+ * facing the walls. Each particle is a guess of the pose. Every update moves the particles by the motion odometry
+ * measured, with noise, and weighs them by how well the distances their sensors would measure, found by casting beams
+ * through a FieldMap, match the distances the sensors did measure. When a few particles carry most of the weight, the
+ * particles are redrawn in proportion to their weights with systematic resampling.
+ *
+ * The particles are stored inside the object, as arrays of floats, so the filter never allocates memory after
+ * construction, and every step is a loop over arrays the compiler can vectorize. A few hundred particles with four
+ * sensors can be updated at 50 Hz on the brain.
+ *
+ * The filter only uses the motion odometry measures between updates, so odometry keeps its own pose, and the pose of
+ * the filter is read with getPose. Setting the pose of odometry while the filter runs moves every particle by the
+ * jump.
+ *
+ * @tparam N the number of particles
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::FieldMap field({-72_in, -72_in}, {72_in, 72_in});
+ * lemlib::V5DistanceSensor leftDistance(5);
+ * lemlib::V5DistanceSensor backDistance(6);
+ * lemlib::ParticleFilter<300> filter(odom, field);
+ *
+ * void initialize() {
+ *     filter.addSensor(leftDistance, {0_in, 5_in, 90_stDeg});
+ *     filter.addSensor(backDistance, {-6_in, 0_in, 180_stDeg});
+ *     filter.setPose({-60_in, -36_in, 0_stDeg}, 2_in, 3_stDeg);
+ *     odom.start();
+ *     filter.start();
+ * }
+ * @endcode
+ */
+template <size_t N> class ParticleFilter : public ParticleFilterBase {
+        static_assert(N >= 1, "ParticleFilter needs at least 1 particle");
+    public:
+        /**
+         * @brief Construct a new Particle Filter
+         *
+         * Every particle starts at the origin. Use setPose to place them.
+         *
+         * @param odometry the odometry which measures the motion of the robot. It must outlive the filter
+         * @param field the map of the field. It must outlive the filter
+         * @param settings the settings of the filter
+         */
+        ParticleFilter(Odometry& odometry, const FieldMap& field, const ParticleFilterSettings& settings = {})
+            : ParticleFilterBase(odometry, field, m_storage.data(), N, settings) {}
+        /**
+         * @brief Destroy the Particle Filter, stopping its task before the particles are destroyed
+         */
+        ~ParticleFilter() { stop(); }
+    private:
+        std::array<float, N * FLOATS_PER_PARTICLE> m_storage {};
+};
+} // namespace lemlib
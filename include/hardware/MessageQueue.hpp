@@ -0,0 +1,279 @@
+#pragma once
+
+#include "hardware/Signal.hpp"
+#include "units/core.hpp"
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace lemlib {
+/**
+ * @brief A fixed-capacity queue from one producer task to one consumer task
+ *
+ * The messages are stored in a ring inside the queue, so pushing and popping never allocate memory, and never lock.
+ * The producer only writes the head and the consumer only writes the tail, so both push and pop finish in a bounded
+ * number of steps no matter what the other task is doing, even if it was preempted halfway through.
+ *
+ * A consumer which has nothing else to do can block in pop until a message arrives. It sleeps on a Signal, which the
+ * producer notifies after every push, so it wakes as soon as the scheduler runs it, without polling.
+ *
+ * Only one task may push and only one task may pop at a time. Use an MpscQueue when several tasks push.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::SpscQueue<Angle, 16> targets;
+ *
+ * void driverTask() {
+ *     if (targets.push(90_stDeg) != 0) std::cout << "queue full" << std::endl;
+ * }
+ *
+ * void armTask() {
+ *     Angle target;
+ *     while (targets.pop(target)) arm.moveToAngle(target, 100_rpm);
+ * }
+ * @endcode
+ *
+ * @tparam T the type of the messages. It has to be default constructible and move assignable
+ * @tparam N the capacity, a power of 2
+ */
+template <typename T, size_t N> class SpscQueue {
+        static_assert(N >= 2 && (N & (N - 1)) == 0, "the capacity of a queue has to be a power of 2");
+    public:
+        SpscQueue() = default;
+        SpscQueue(const SpscQueue& other) = delete;
+        SpscQueue& operator=(const SpscQueue& other) = delete;
+
+        /**
+         * @brief Add a message to the back of the queue
+         *
+         * Only one task may push to the queue.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOBUFS: the queue is full, so the message was dropped
+         *
+         * @param message the message
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t push(T message) {
+            const uint32_t head = m_head.load(std::memory_order_relaxed);
+            // the tail is acquired, so the consumer has finished moving a message out of its slot before it is reused
+            if (head - m_tail.load(std::memory_order_acquire) >= N) {
+                errno = ENOBUFS;
+                return INT_MAX;
+            }
+            m_slots[head & (N - 1)] = std::move(message);
+            // publish the message only after it has been stored
+            m_head.store(head + 1, std::memory_order_release);
+            m_signal.notify();
+            return 0;
+        }
+
+        /**
+         * @brief Remove the message at the front of the queue, if there is one
+         *
+         * Only one task may pop from the queue.
+         *
+         * @param message where the message is moved to. It is not changed if the queue is empty
+         * @return true a message was removed
+         * @return false the queue was empty
+         */
+        bool tryPop(T& message) {
+            const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+            if (m_head.load(std::memory_order_acquire) == tail) return false;
+            message = std::move(m_slots[tail & (N - 1)]);
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Remove the message at the front of the queue, blocking until there is one
+         *
+         * The task sleeps on its notification while it waits, so it must not expect other notifications meanwhile.
+         *
+         * @param message where the message is moved to. It is not changed if the timeout elapses
+         * @param timeout the longest time to wait. Defaults to forever
+         * @return true a message was removed
+         * @return false the timeout elapsed first
+         */
+        bool pop(T& message, Time timeout = from_sec(INFINITY)) {
+            if (tryPop(message)) return true;
+            return m_signal.waitUntil([&] { return tryPop(message); }, timeout);
+        }
+
+        /**
+         * @brief Get the number of messages in the queue
+         *
+         * The count can be out of date by the time it is used, unless it is read while neither task is using the queue
+         *
+         * @return size_t the number of messages
+         */
+        size_t size() const { return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Get the number of messages the queue can hold
+         *
+         * @return size_t N
+         */
+        static constexpr size_t capacity() { return N; }
+    private:
+        std::array<T, N> m_slots {};
+        // the producer only writes the head, and the consumer only writes the tail. Both count messages since the
+        // queue was made, and wrap around, so a full queue can be told apart from an empty one
+        std::atomic<uint32_t> m_head = 0;
+        std::atomic<uint32_t> m_tail = 0;
+        Signal m_signal;
+};
+
+/**
+ * @brief A fixed-capacity queue from any number of producer tasks to one consumer task
+ *
+ * Like an SpscQueue, the messages are stored inside the queue, so pushing and popping never allocate memory, and never
+ * lock. Every slot has a sequence number which says whether it is free, holds a message, or is still being written.
+ * Producers claim a slot by advancing the head with a compare and swap, which only has to be retried when another
+ * producer claimed the same slot first, and then publish the message through the sequence of the slot. Popping
+ * always finishes in a bounded number of steps.
+ *
+ * Messages are popped in the order their slots were claimed. A producer which is preempted after claiming a slot, but
+ * before publishing it, holds up the messages pushed after it until it runs again, so the consumer may briefly see
+ * the queue as empty while it isn't.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * enum class Event { MOTOR_UNPLUGGED, IMU_UNPLUGGED, OVERHEATING };
+ * lemlib::MpscQueue<Event, 32> events;
+ *
+ * // called from any task
+ * void report(Event event) { events.push(event); }
+ *
+ * void eventTask() {
+ *     Event event;
+ *     while (events.pop(event)) controller.rumble(".");
+ * }
+ * @endcode
+ *
+ * @tparam T the type of the messages. It has to be default constructible and move assignable
+ * @tparam N the capacity, a power of 2
+ */
+template <typename T, size_t N> class MpscQueue {
+        static_assert(N >= 2 && (N & (N - 1)) == 0, "the capacity of a queue has to be a power of 2");
+    public:
+        /**
+         * @brief Construct a new, empty MPSC Queue
+         */
+        MpscQueue() {
+            for (size_t i = 0; i < N; i++) m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        MpscQueue(const MpscQueue& other) = delete;
+        MpscQueue& operator=(const MpscQueue& other) = delete;
+
+        /**
+         * @brief Add a message to the back of the queue
+         *
+         * Any number of tasks may push at once.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOBUFS: the queue is full, so the message was dropped
+         *
+         * @param message the message
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t push(T message) {
+            uint32_t head = m_head.load(std::memory_order_relaxed);
+            Slot* slot;
+            while (true) {
+                slot = &m_slots[head & (N - 1)];
+                // the slot is free for this lap when its sequence equals the head, and still holds the message of the
+                // previous lap when it is behind
+                const int32_t lag = int32_t(slot->sequence.load(std::memory_order_acquire) - head);
+                if (lag < 0) {
+                    errno = ENOBUFS;
+                    return INT_MAX;
+                }
+                // a failed exchange loads the head another producer advanced it to, and tries that slot instead
+                if (lag == 0 && m_head.compare_exchange_weak(head, head + 1, std::memory_order_relaxed)) break;
+                if (lag > 0) head = m_head.load(std::memory_order_relaxed);
+            }
+            slot->message = std::move(message);
+            // publish the message only after it has been stored
+            slot->sequence.store(head + 1, std::memory_order_release);
+            m_signal.notify();
+            return 0;
+        }
+
+        /**
+         * @brief Remove the message at the front of the queue, if there is one
+         *
+         * Only one task may pop from the queue.
+         *
+         * @param message where the message is moved to. It is not changed if the queue is empty
+         * @return true a message was removed
+         * @return false the queue was empty, or the producer of the next message hasn't published it yet
+         */
+        bool tryPop(T& message) {
+            const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+            Slot& slot = m_slots[tail & (N - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != tail + 1) return false;
+            message = std::move(slot.message);
+            // free the slot for the lap after this one
+            slot.sequence.store(tail + N, std::memory_order_release);
+            m_tail.store(tail + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * @brief Remove the message at the front of the queue, blocking until there is one
+         *
+         * The task sleeps on its notification while it waits, so it must not expect other notifications meanwhile.
+         *
+         * @param message where the message is moved to. It is not changed if the timeout elapses
+         * @param timeout the longest time to wait. Defaults to forever
+         * @return true a message was removed
+         * @return false the timeout elapsed first
+         */
+        bool pop(T& message, Time timeout = from_sec(INFINITY)) {
+            if (tryPop(message)) return true;
+            return m_signal.waitUntil([&] { return tryPop(message); }, timeout);
+        }
+
+        /**
+         * @brief Get the number of messages which have been pushed but not popped, including any still being written
+         *
+         * This can be out of date by the time it is used, and is only exact while no task is pushing
+         *
+         * @return size_t the number of messages
+         */
+        size_t size() const {
+            return m_head.load(std::memory_order_relaxed) - m_tail.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Get the number of messages the queue can hold
+         *
+         * @return size_t N
+         */
+        static constexpr size_t capacity() { return N; }
+    private:
+        struct Slot {
+                // the lap the slot is free for while it equals the index of the message to be pushed into it, and
+                // one more than that index once the message has been published
+                std::atomic<uint32_t> sequence;
+                T message {};
+        };
+
+        std::array<Slot, N> m_slots;
+        // claimed by producers with a compare and swap
+        std::atomic<uint32_t> m_head = 0;
+        // only touched by the consumer. It is atomic so size can be read from any task
+        std::atomic<uint32_t> m_tail = 0;
+        Signal m_signal;
+};
+} // namespace lemlib
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "hardware/DoubleBuffer.hpp"
+#include "hardware/Routine.hpp"
+#include "hardware/Signal.hpp"
+#include "units/Angle.hpp"
+#include "units/core.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief When a motion to an angle counts as finished
+ */
+struct MotionSettings {
+        /** how far from the target the angle can be, and still count as being at the target */
+        Angle tolerance = 2_stDeg;
+        /** how long the angle has to stay within the tolerance before the motion is settled */
+        Time settleTime = 50_msec;
+        /** how long the motion can take before it times out. Defaults to never timing out */
+        Time timeout = from_sec(INFINITY);
+};
+
+/**
+ * @brief The state of a motion to an angle
+ */
+enum class MotionState : uint8_t {
+    /** the motion is still moving towards its target */
+    PENDING,
+    /** the angle stayed within the tolerance of the target for the settle time */
+    SETTLED,
+    /** the motion did not settle before its timeout */
+    TIMED_OUT,
+    /** another command was sent to the device before the motion settled */
+    CANCELLED,
+    /** the motion could not be started */
+    FAILED
+};
+
+class MotionFuture;
+
+/**
+ * @brief Tracks the latest motion of a device, like a motor, and whether it has settled
+ *
+ * A device has a single motion status. Starting a motion gives it a new id, and returns a future which remembers the
+ * id. The result of the latest finished motion is packed into a single atomic together with its id, so futures read
+ * it with one load, and a late result can never be mistaken for the result of a newer motion.
+ *
+ * Only one task may start motions at a time, and only one task may call update, but any task can cancel motions and
+ * read futures.
+ */
+class MotionStatus {
+    public:
+        /**
+         * @brief Construct a new Motion Status, with no motion
+         */
+        MotionStatus() = default;
+        MotionStatus(const MotionStatus& other) = delete;
+        MotionStatus& operator=(const MotionStatus& other) = delete;
+        /**
+         * @brief Start a new motion, cancelling the previous one if it hasn't finished
+         *
+         * @param target the angle the device is moving to
+         * @param settings when the motion counts as finished
+         * @return MotionFuture the future of the new motion
+         */
+        MotionFuture begin(Angle target, MotionSettings settings);
+        /**
+         * @brief Mark the motion of a future as failed, because it could not be started
+         *
+         * @param future the future returned by begin
+         */
+        void fail(const MotionFuture& future);
+        /**
+         * @brief Cancel the latest motion, if it hasn't finished
+         *
+         * This is called whenever another command is sent to the device. It is a single atomic load if there is no
+         * motion to cancel.
+         */
+        void cancel();
+        /**
+         * @brief Check whether the latest motion hasn't finished yet
+         *
+         * @return true the latest motion is pending
+         * @return false there is no motion, or it has finished
+         */
+        bool isPending() const;
+        /**
+         * @brief Check whether the latest motion has settled or timed out
+         *
+         * @param angle the latest angle of the device. INFINITY if it could not be read, which never settles
+         */
+        void update(Angle angle);
+    private:
+        friend class MotionFuture;
+
+        // the words are next to each other, so neither is padded to 8 bytes
+        struct Target {
+                Angle angle = 0_stDeg;
+                MotionSettings settings;
+                uint32_t id = 0;
+                uint32_t startTime = 0;
+        };
+
+        /**
+         * @brief Pack the id and result of a motion into a single value
+         *
+         * @param id the id of the motion
+         * @param state the result of the motion
+         * @return uint32_t the packed result
+         */
+        static constexpr uint32_t pack(uint32_t id, MotionState state) { return (id << 3) | uint32_t(state); }
+
+        /**
+         * @brief Finish a motion, unless it has already finished
+         *
+         * @param id the id of the motion
+         * @param state the result of the motion
+         */
+        void finish(uint32_t id, MotionState state);
+
+        DoubleBuffer<Target> m_target;
+        // the id of the latest motion, which only uses the bits which fit in a packed result. 0 means no motion
+        std::atomic<uint32_t> m_id = 0;
+        // the id and result of the latest motion which finished
+        std::atomic<uint32_t> m_result = pack(0, MotionState::SETTLED);
+        // notified whenever a motion finishes, to wake the tasks blocked in MotionFuture::wait
+        mutable Signal m_finished;
+        // only used by the task which calls update
+        uint32_t m_trackedId = 0;
+        bool m_inTolerance = false;
+        uint32_t m_inToleranceSince = 0;
+};
+
+/**
+ * @brief A handle to a motion to an angle, which finishes when the motion settles
+ *
+ * The future is two words, and reading it is an atomic load, so it can be checked from any task, as often as needed,
+ * without reading the device. The motion is checked by a DevicePoller the device is registered with.
+ *
+ * A routine can co_await the future, which waits until the motion finishes without blocking other routines.
+ *
+ * The device only remembers the result of its latest finished motion. A motion which was superseded by another one
+ * reports CANCELLED once the newer motion finishes, even if it settled first.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * void autonomous() {
+ *     lemlib::MotionFuture lift = arm.moveToAngle(90_stDeg, 100_rpm);
+ *     // do other work while the arm moves
+ *     if (lift.wait(2_sec) != lemlib::MotionState::SETTLED) std::cout << "The arm didn't get there" << std::endl;
+ * }
+ *
+ * lemlib::Routine raiseArm() {
+ *     co_await arm.moveToAngle(90_stDeg, 100_rpm);
+ *     intake.move(1);
+ * }
+ * @endcode
+ */
+class MotionFuture {
+    public:
+        /**
+         * @brief Construct a future of a motion which failed to start
+         */
+        MotionFuture() = default;
+        /**
+         * @brief Get the state of the motion
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * @return MotionState the state
+         */
+        MotionState getState() const;
+        /**
+         * @brief Check whether the motion has finished, in any way
+         *
+         * @return true the motion isn't pending
+         * @return false the motion is still moving towards its target
+         */
+        bool isDone() const;
+        /**
+         * @brief Block the calling task until the motion finishes
+         *
+         * The task sleeps until the task which finishes the motion, usually a DevicePoller, wakes it, so it uses no
+         * CPU while it waits, and returns as soon as the motion settles.
+         *
+         * @param timeout the longest time to wait. Defaults to waiting until the motion finishes
+         * @return MotionState the state of the motion. PENDING if the wait timed out before the motion finished
+         */
+        MotionState wait(Time timeout = from_sec(INFINITY)) const;
+        /**
+         * @brief Wait for the motion to finish in a routine
+         *
+         * @return RoutineWait the wait used by the compiler
+         */
+        RoutineWait operator co_await() const;
+    private:
+        friend class MotionStatus;
+
+        MotionFuture(const MotionStatus* status, uint32_t id)
+            : m_status(status),
+              m_id(id) {}
+
+        const MotionStatus* m_status = nullptr;
+        uint32_t m_id = 0;
+};
+} // namespace lemlib
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "units/core.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief The limits of a motion profile
+ */
+struct ProfileConstraints {
+        /** the maximum velocity */
+        LinearVelocity maxVelocity;
+        /** the maximum acceleration, which is also the maximum deceleration */
+        LinearAcceleration maxAcceleration;
+        /** the maximum jerk. INFINITY by default, which gives a trapezoidal profile instead of an S-curve */
+        LinearJerk maxJerk = from_mps3(INFINITY);
+};
+
+/**
+ * @brief A setpoint of a motion profile
+ */
+struct ProfilePoint {
+        /** the distance travelled since the start of the profile */
+        Length position = 0_m;
+        LinearVelocity velocity = 0_mps;
+        LinearAcceleration acceleration = 0_mps2;
+};
+
+/**
+ * @brief The storage independent part of MotionProfile
+ *
+ * Use MotionProfile to create a profile.
+ */
+class MotionProfileBase {
+    public:
+        MotionProfileBase(const MotionProfileBase& other) = delete;
+        MotionProfileBase& operator=(const MotionProfileBase& other) = delete;
+        /**
+         * @brief Generate a profile which travels a distance, starting and ending at rest
+         *
+         * The profile is precomputed into the table of the profile, one setpoint per step. Profiles which are too
+         * short to reach the maximum velocity, or the maximum acceleration, peak below them instead. This is the only
+         * function which does any kinematics, so it should be called before the profile is followed, not in the
+         * control loop.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the distance is not finite, or a constraint is not positive
+         * ERANGE: the profile takes too long to fit in the table
+         *
+         * @param distance the distance to travel. Negative distances travel backwards
+         * @param constraints the limits of the profile
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno. The previous profile is kept
+         *
+         * @b Example:
+         * @code {.cpp}
+         * lemlib::MotionProfile<500> profile(10_msec);
+         *
+         * void autonomous() {
+         *     // an S-curve
+         *     profile.generate(24_in, {.maxVelocity = 60_inps, .maxAcceleration = 120_inps2, .maxJerk = 600_inps3});
+         * }
+         * @endcode
+         */
+        int32_t generate(Length distance, ProfileConstraints constraints);
+        /**
+         * @brief Get the setpoint of the profile at a time
+         *
+         * This is a constant time lookup, which interpolates between the two closest setpoints of the table. Times
+         * before the start and after the end of the profile give the first and last setpoints.
+         *
+         * @param time the time since the start of the profile
+         * @return ProfilePoint the setpoint. At rest at 0 if no profile has been generated
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void autonomous() {
+         *     const uint32_t start = pros::millis();
+         *     while (from_msec(pros::millis() - start) < profile.getDuration()) {
+         *         const lemlib::ProfilePoint setpoint = profile.sample(from_msec(pros::millis() - start));
+         *         followSetpoint(setpoint);
+         *         pros::delay(10);
+         *     }
+         * }
+         * @endcode
+         */
+        ProfilePoint sample(Time time) const;
+        /**
+         * @brief Get how long the profile takes
+         *
+         * @return Time the duration. 0 if no profile has been generated
+         */
+        Time getDuration() const;
+        /**
+         * @brief Get the time between the setpoints of the table
+         *
+         * @return Time the step
+         */
+        Time getStep() const;
+        /**
+         * @brief Get the number of setpoints in the table
+         *
+         * @return size_t the number of setpoints, which is never more than the capacity
+         */
+        size_t getSize() const;
+        /**
+         * @brief Get the maximum number of setpoints the table can hold
+         *
+         * @return size_t the capacity
+         */
+        size_t getCapacity() const;
+    protected:
+        /**
+         * @brief Construct a new Motion Profile Base
+         *
+         * @param storage the storage for the setpoints. It must outlive the profile
+         * @param capacity the number of setpoints the storage can hold
+         * @param step the time between setpoints
+         */
+        MotionProfileBase(ProfilePoint* storage, size_t capacity, Time step);
+    private:
+        ProfilePoint* const m_storage;
+        const size_t m_capacity;
+        const Time m_step;
+        size_t m_size = 0;
+        Time m_duration = 0_sec;
+};
+
+/**
+ * @brief A motion profile, precomputed into a fixed-step table of setpoints
+ *
+ * The setpoints are stored inside the object, so the profile never allocates memory. Generating a profile does all
+ * the kinematics once, and sampling it in the control loop is a constant time lookup.
+ *
+ * @tparam N the maximum number of setpoints. The longest profile is N - 1 steps long
+ *
+ * @b Example:
+ * @code {.cpp}
+ * // up to 5 seconds, with a setpoint every 10 ms
+ * lemlib::MotionProfile<501> profile(10_msec);
+ *
+ * void autonomous() {
+ *     profile.generate(48_in, {.maxVelocity = 60_inps, .maxAcceleration = 120_inps2});
+ * }
+ * @endcode
+ */
+template <size_t N> class MotionProfile : public MotionProfileBase {
+        static_assert(N >= 2, "MotionProfile needs at least 2 setpoints");
+    public:
+        /**
+         * @brief Construct a new, empty Motion Profile
+         *
+         * @param step the time between setpoints. Defaults to 10 ms
+         */
+        MotionProfile(Time step = 10_msec)
+            : MotionProfileBase(m_points.data(), N, step) {}
+    private:
+        std::array<ProfilePoint, N> m_points;
+};
+} // namespace lemlib
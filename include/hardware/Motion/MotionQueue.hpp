@@ -0,0 +1,234 @@
+#pragma once
+
+#include "hardware/Motion/PathProfile.hpp"
+#include "hardware/Motion/Ramsete.hpp"
+#include "hardware/Motor/DifferentialDrive.hpp"
+#include "hardware/Odometry/Odometry.hpp"
+#include "pros/rtos.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace lemlib {
+/**
+ * @brief Follows a queue of paths one after another, without stopping between them
+ *
+ * A path profiled on its own ends at rest, so a routine which follows paths one at a time stops the robot at the end
+ * of every one. The queue joins every path it is given onto the end of the ones before it, and profiles them as one:
+ * the point where two paths meet is only slowed down by the corner between them, and the velocity is blended into
+ * the next path instead of falling to 0. Paths can be queued while the robot is already following the queue, and the
+ * rest of the profile is blended from the current segment on, so the routine queues the next path as soon as it is
+ * known, and never has to decide when the previous one is finished. The robot only stops at the end of the last path.
+ *
+ * Every path is profiled with the same constraints. The velocities of the samples given to enqueue are ignored. The
+ * profile is followed by a RamseteController through a TrajectorySampler, with the pose from odometry.
+ *
+ * update should be called by a ControlScheduler, at the period of the odometry or faster. The samples are stored
+ * inside the queue, which never allocates memory. The storage is reused from the start once every queued path is
+ * finished, so it only has to hold the paths of one run without a stop.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::MotionQueue<512> queue(drive, odom, lemlib::RamseteController(11_in), 3.25_in,
+ *                                {.maxVelocity = 60_inps, .maxAcceleration = 120_inps2,
+ *                                 .maxLateralAcceleration = 80_inps2});
+ * lemlib::ControlScheduler scheduler;
+ *
+ * void autonomous() {
+ *     scheduler.add([] { queue.update(); }, 10_msec, lemlib::CallbackPriority::CRITICAL);
+ *     scheduler.start();
+ *     queue.enqueue(toGoal);
+ *     const int32_t last = queue.enqueue(toCorner);
+ *     // the robot drives through the goal without stopping, and stops in the corner
+ *     while (queue.getCompleted() <= uint32_t(last)) pros::delay(10);
+ * }
+ * @endcode
+ */
+class MotionQueueBase {
+    public:
+        /** the most paths which can be queued in one run without a stop */
+        static constexpr size_t MAX_MOTIONS = 16;
+        MotionQueueBase(const MotionQueueBase& other) = delete;
+        MotionQueueBase& operator=(const MotionQueueBase& other) = delete;
+        /**
+         * @brief Add a path to the end of the queue
+         *
+         * The path starts where the previous one ends. A first sample at the end of the previous path is dropped, and
+         * any other first sample is joined to it with a straight segment. The profile is blended from the segment the
+         * robot is on, so it never changes the velocity the robot is already following. If the queue was idle, the
+         * robot starts following the path from rest on the next update.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the path is empty, or has a position which isn't finite
+         * ENOMEM: the samples or MAX_MOTIONS paths of the current run would not fit
+         *
+         * @param samples the samples of the path. Only their positions are used. They are copied into the queue
+         * @return int32_t the id of the path, which counts every path ever queued, from 0
+         * @return INT_MAX on failure, setting errno. The queue is not changed
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void autonomous() {
+         *     const int32_t id = queue.enqueue(toGoal);
+         *     // score once the robot passes the end of the path
+         *     while (queue.getCompleted() <= uint32_t(id)) pros::delay(10);
+         *     clamp.set(true);
+         * }
+         * @endcode
+         */
+        int32_t enqueue(std::span<const PathSample> samples);
+        /**
+         * @brief Stop following the queue, and drop every path in it
+         *
+         * The drive brakes, and every dropped path counts as completed.
+         *
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno like DifferentialDrive::brake
+         */
+        int32_t clear();
+        /**
+         * @brief Get how many paths have been completed, since the queue was constructed
+         *
+         * A path is completed when the robot's reference passes its last sample. The id of a path is less than the
+         * count once it is completed. This function does not lock, and can be called from any task.
+         *
+         * @return uint32_t the number of completed paths
+         */
+        uint32_t getCompleted() const;
+        /**
+         * @brief Get whether the queue is following a path
+         *
+         * @return true a path is queued which isn't completed
+         * @return false every queued path is completed
+         */
+        bool isBusy() const;
+        /**
+         * @brief Get the state of the trajectory as of the latest update
+         *
+         * @return TrajectoryState the reference the robot was moved towards
+         */
+        TrajectoryState getReference() const;
+        /**
+         * @brief Set the latency between an update and its command taking effect
+         *
+         * Every update then tracks the trajectory as it will be after the latency, from the pose odometry predicts
+         * for that time, so the output targets where the robot will be when the motors act on it instead of where it
+         * was when it was last measured. The odometry needs a PoseHistory to predict the pose. Without one, the
+         * latest pose is used. Measure the latency as the time from a command to the velocity of the drive changing,
+         * plus the period of the odometry.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the latency is negative or not finite
+         *
+         * @param latency the latency. Defaults to 0, which tracks the latest pose
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     odom.setHistory(history);
+         *     queue.setLatency(15_msec);
+         * }
+         * @endcode
+         */
+        int32_t setLatency(Time latency);
+        /**
+         * @brief Get the latency the queue compensates for
+         *
+         * @return Time the latency
+         */
+        Time getLatency() const;
+        /**
+         * @brief Move the robot along the queue once
+         *
+         * This must not be called from more than one task at once. It does nothing while the queue is idle.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the drive could not be moved
+         *
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t update();
+    protected:
+        /**
+         * @brief Construct a new Motion Queue Base
+         *
+         * @param storage the storage for the samples. It must outlive the queue
+         * @param capacity the number of samples the storage can hold
+         * @param drive the drive to move. It must outlive the queue
+         * @param odometry the odometry which measures the pose of the robot. It must outlive the queue
+         * @param controller the controller which tracks the trajectory
+         * @param wheelDiameter the diameter of the wheels of the drive
+         * @param constraints the limits of the profile. The start and end velocities are ignored, as every run starts
+         * and ends at rest
+         */
+        MotionQueueBase(PathSample* storage, size_t capacity, DifferentialDrive& drive, Odometry& odometry,
+                        RamseteController controller, Length wheelDiameter, PathConstraints constraints);
+    private:
+        /**
+         * @brief Profile the samples after the one the robot is heading to, blended from its velocity
+         *
+         * The mutex has to be locked before this function is called. The new samples have to be added already
+         *
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno like profilePath. No sample is changed
+         */
+        int32_t reprofile();
+
+        PathSample* const m_storage;
+        const size_t m_capacity;
+        DifferentialDrive& m_drive;
+        Odometry& m_odometry;
+        const RamseteController m_controller;
+        const Length m_wheelDiameter;
+        const PathConstraints m_constraints;
+        // protects everything below, as enqueue changes the profile update follows
+        mutable pros::Mutex m_mutex;
+        TrajectorySampler m_sampler;
+        TrajectoryState m_reference;
+        size_t m_size = 0;
+        // the index of the last sample of every path of the current run
+        std::array<size_t, MAX_MOTIONS> m_ends {};
+        size_t m_motions = 0;
+        // the number of paths of the current run which are completed
+        size_t m_passed = 0;
+        // when the current run started, in microseconds
+        uint64_t m_start = 0;
+        Time m_latency = 0_sec;
+        bool m_running = false;
+        // the ids of paths, counted over every run
+        uint32_t m_queued = 0;
+        std::atomic<uint32_t> m_completed = 0;
+};
+
+/**
+ * @brief A MotionQueue with storage for N samples
+ *
+ * @tparam N the most samples the paths of one run can have in total
+ */
+template <size_t N> class MotionQueue : public MotionQueueBase {
+        static_assert(N >= 2, "MotionQueue needs at least 2 samples");
+    public:
+        /**
+         * @brief Construct a new, empty Motion Queue
+         *
+         * @param drive the drive to move. It must outlive the queue
+         * @param odometry the odometry which measures the pose of the robot. It must outlive the queue
+         * @param controller the controller which tracks the trajectory
+         * @param wheelDiameter the diameter of the wheels of the drive
+         * @param constraints the limits of the profile
+         */
+        MotionQueue(DifferentialDrive& drive, Odometry& odometry, RamseteController controller, Length wheelDiameter,
+                    PathConstraints constraints)
+            : MotionQueueBase(m_samples.data(), N, drive, odometry, controller, wheelDiameter, constraints) {}
+    private:
+        std::array<PathSample, N> m_samples;
+};
+} // namespace lemlib
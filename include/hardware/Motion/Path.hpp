@@ -0,0 +1,225 @@
+#pragma once
+
+#include "hardware/Motion/PathFile.hpp"
+#include "units/Vector2D.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <vector>
+
+namespace lemlib {
+/**
+ * @brief A point on a Path
+ */
+struct PathPoint {
+        /** the position of the point */
+        units::V2Position position = units::V2Position(0_m, 0_m);
+        /** the index of the segment the point is on. Segment i goes from waypoint i to waypoint i + 1 */
+        size_t segment = 0;
+        /** the distance along the path from the first waypoint to the point */
+        Length distance = 0_m;
+};
+
+/**
+ * @brief A path through a list of waypoints, indexed for fast closest point searches
+ *
+ * The waypoints are joined by straight segments. When the path is constructed, the length along the path to every
+ * waypoint is calculated, and every segment is added to a coarse uniform grid covering the path, so the segments close
+ * to any position can be found without checking all of them. Nothing is allocated after the path is constructed.
+ *
+ * A Path is never changed after it is constructed, so it can be shared by any number of PathTrackers, in any task.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::Path path({{0_in, 0_in}, {24_in, 0_in}, {24_in, 24_in}, {48_in, 24_in}});
+ * @endcode
+ */
+class Path {
+    public:
+        /** the maximum number of cells in the grid */
+        static constexpr size_t MAX_CELLS = 16384;
+        /**
+         * @brief Construct a new Path
+         *
+         * Waypoints which are in the same place as the waypoint before them are dropped.
+         *
+         * @param waypoints the waypoints
+         * @param cellSize the size of the cells of the grid. Cells about as big as the lookahead distance work well.
+         * Defaults to 6 inches. The cells are made bigger if the grid would have more than MAX_CELLS cells
+         */
+        Path(std::span<const units::V2Position> waypoints, Length cellSize = 6_in);
+        /**
+         * @brief Construct a new Path
+         *
+         * @param waypoints the waypoints
+         * @param cellSize the size of the cells of the grid. Defaults to 6 inches
+         */
+        Path(std::initializer_list<units::V2Position> waypoints, Length cellSize = 6_in);
+        /**
+         * @brief Construct a new Path from the records of a path file
+         *
+         * Only the positions of the records are used. Their velocities and curvatures can be looked up in the records
+         * by the index of the segment, as long as no waypoints were dropped.
+         *
+         * @param records the records, like ones read by loadPath
+         * @param cellSize the size of the cells of the grid. Defaults to 6 inches
+         */
+        Path(std::span<const PathRecord> records, Length cellSize = 6_in);
+        /**
+         * @brief Get the number of waypoints
+         *
+         * @return size_t the number of waypoints
+         */
+        size_t size() const;
+        /**
+         * @brief Get the number of segments, which is one less than the number of waypoints
+         *
+         * @return size_t the number of segments, or 0 if the path has less than 2 waypoints
+         */
+        size_t segments() const;
+        /**
+         * @brief Get a waypoint
+         *
+         * @param index the index of the waypoint, which must be less than size()
+         * @return units::V2Position the waypoint
+         */
+        units::V2Position getWaypoint(size_t index) const;
+        /**
+         * @brief Get the distance along the path from the first waypoint to a waypoint
+         *
+         * @param index the index of the waypoint, which must be less than size()
+         * @return Length the distance
+         */
+        Length getDistance(size_t index) const;
+        /**
+         * @brief Get the length of the whole path
+         *
+         * @return Length the length
+         */
+        Length getLength() const;
+        /**
+         * @brief Find the point on a segment closest to a position
+         *
+         * @param segment the index of the segment, which must be less than segments()
+         * @param position the position
+         * @return PathPoint the closest point
+         */
+        PathPoint closestOnSegment(size_t segment, units::V2Position position) const;
+        /**
+         * @brief Find the point on the path closest to a position, using the grid
+         *
+         * The grid is searched in rings of cells around the position, so the search only checks the segments near the
+         * position. This does not depend on where the position was before, so it finds the closest point even after
+         * the robot was pushed, but PathTracker::closest is faster in the control loop.
+         *
+         * @param position the position
+         * @param firstSegment segments before this one are ignored. Defaults to 0
+         * @return PathPoint the closest point. The first waypoint if the path has less than 2 waypoints
+         */
+        PathPoint closest(units::V2Position position, size_t firstSegment = 0) const;
+    private:
+        /**
+         * @brief Calculate the distances to every waypoint, and fill the grid
+         *
+         * @param cellSize the requested size of the cells
+         */
+        void build(double cellSize);
+        /**
+         * @brief Get the cell a position is in, clamped to the grid
+         *
+         * @param x the x position, in meters
+         * @param y the y position, in meters
+         * @param col set to the column of the cell
+         * @param row set to the row of the cell
+         */
+        void cellOf(double x, double y, size_t& col, size_t& row) const;
+
+        std::vector<units::V2Position> m_waypoints;
+        // the distance along the path to every waypoint, in meters
+        std::vector<double> m_distances;
+        // the grid, in meters. The segments in cell i are m_cellSegments[m_cellStart[i]] to
+        // m_cellSegments[m_cellStart[i + 1] - 1]
+        double m_originX = 0;
+        double m_originY = 0;
+        double m_cellSize = 1;
+        size_t m_cols = 0;
+        size_t m_rows = 0;
+        std::vector<uint32_t> m_cellStart;
+        std::vector<uint32_t> m_cellSegments;
+};
+
+/**
+ * @brief Follows the progress of the robot along a Path
+ *
+ * A follower asks for the closest point and the lookahead point every cycle, and the robot only moves a little along
+ * the path between cycles. The tracker remembers the segment of the previous answer, and only searches a small window
+ * of segments from there, walking forwards while the path keeps getting closer. Over a whole path, every segment is
+ * walked past once, so each query takes amortized constant time, however long the path is. The tracker never moves
+ * backwards along the path, so it doesn't jump to a later part of a path which crosses itself, or back to an earlier
+ * one.
+ *
+ * If the closest point in the window is further than the relocalize distance, for example because the robot was
+ * pushed, the tracker finds the closest point on the rest of the path with the grid of the path instead.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::Path path({{0_in, 0_in}, {24_in, 0_in}, {24_in, 24_in}, {48_in, 24_in}});
+ *
+ * void autonomous() {
+ *     lemlib::PathTracker tracker(path);
+ *     while (tracker.closest(getPosition()).segment + 1 < path.segments()) {
+ *         const lemlib::PathPoint target = tracker.lookahead(getPosition(), 12_in);
+ *         purePursuit(target.position);
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class PathTracker {
+    public:
+        /**
+         * @brief Construct a new Path Tracker, at the start of a path
+         *
+         * @param path the path. It must outlive the tracker
+         * @param window how many segments after the previous closest point are searched, before the search stops
+         * if the path is getting further away. Defaults to 8
+         * @param relocalizeDistance closest points further than this from the position are searched for again with
+         * the grid. Defaults to 12 inches
+         */
+        PathTracker(const Path& path, size_t window = 8, Length relocalizeDistance = 12_in);
+        /**
+         * @brief Find the point on the path closest to a position, at or after the previous closest point
+         *
+         * @param position the position, usually the position of the robot
+         * @return PathPoint the closest point
+         */
+        PathPoint closest(units::V2Position position);
+        /**
+         * @brief Find the lookahead point of pure pursuit
+         *
+         * The lookahead point is the point after the closest point where the path leaves a circle around the position.
+         * Once the end of the path is inside the circle, the lookahead point is the end of the path. If the path
+         * doesn't leave the circle after the closest point, the lookahead point is the closest point. The lookahead
+         * point never moves backwards along the path, so if the robot falls behind it, it waits where it is.
+         *
+         * @param position the position, usually the position of the robot
+         * @param radius the lookahead distance
+         * @return PathPoint the lookahead point
+         */
+        PathPoint lookahead(units::V2Position position, Length radius);
+        /**
+         * @brief Start following the path from the start again
+         */
+        void reset();
+    private:
+        const Path& m_path;
+        const size_t m_window;
+        const Length m_relocalizeDistance;
+        bool m_started = false;
+        // the segment of the previous closest point
+        size_t m_segment = 0;
+        // the previous lookahead point
+        PathPoint m_lookahead;
+};
+} // namespace lemlib
@@ -0,0 +1,232 @@
+#pragma once
+
+#include "units/Vector2D.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <span>
+
+namespace lemlib {
+/**
+ * @brief A point of a path, as it is stored in a path file
+ *
+ * Every value is a fixed-point integer, so a point takes 12 bytes instead of the 32 of a PathSample, and a file can be
+ * read straight into an array of records. Records are written to the file exactly as they are laid out in memory,
+ * which is little-endian on the brain and on the computers paths are generated on.
+ */
+struct PathRecord {
+        /** the x position, in tenths of a millimeter */
+        int32_t x = 0;
+        /** the y position, in tenths of a millimeter */
+        int32_t y = 0;
+        /** the target velocity, in millimeters per second */
+        int16_t velocity = 0;
+        /** the curvature of the path, in thousandths of a radian per meter */
+        int16_t curvature = 0;
+};
+
+static_assert(sizeof(PathRecord) == 12, "path records are written as raw 12 byte structs");
+
+/**
+ * @brief A point of a path, in units
+ */
+struct PathSample {
+        /** the position of the point */
+        units::V2Position position = units::V2Position(0_m, 0_m);
+        /** the target velocity at the point */
+        LinearVelocity velocity = 0_mps;
+        /** the curvature of the path at the point, positive when it turns counterclockwise */
+        Curvature curvature = 0_radpm;
+};
+
+/**
+ * @brief Convert a sample to a record
+ *
+ * Values are rounded to the resolution of a record. Values too large for a record, which are positions further than
+ * 214 km away, velocities faster than 32 m/s and curvatures tighter than 32 rad/m, are clamped.
+ *
+ * @param sample the sample
+ * @return PathRecord the record
+ */
+PathRecord encodePathSample(const PathSample& sample);
+
+/**
+ * @brief Convert a record to a sample
+ *
+ * @param record the record
+ * @return PathSample the sample
+ */
+PathSample decodePathRecord(const PathRecord& record);
+
+/**
+ * @brief The version of the path file format
+ *
+ * A path file starts with a 16 byte header: the characters "LPTH", the format version and the record size as 16 bit
+ * integers, the number of records as a 32 bit integer, and 4 reserved bytes. The records follow it back to back.
+ */
+constexpr uint16_t PATH_FORMAT_VERSION = 1;
+
+/**
+ * @brief Load a whole path file into a buffer
+ *
+ * The records are read with a single read, straight into the buffer, so nothing is allocated or parsed, and the
+ * buffer can be preallocated, or static.
+ *
+ * This function uses the following values of errno when an error state is reached:
+ *
+ * EPROTO: the file is not a path file, was written by a different version of the format, or is shorter than its
+ * header says
+ * ENOBUFS: the buffer is too small for the path. Nothing is read
+ * any errno set by fopen, like ENOENT when the file does not exist
+ *
+ * @param path the path of the file, like "/usd/skills.lpth"
+ * @param buffer the buffer the records are read into
+ * @return int32_t the number of records read
+ * @return INT_MAX on failure, setting errno
+ *
+ * @b Example:
+ * @code {.cpp}
+ * // reserved once, so loading a path never allocates
+ * static std::array<lemlib::PathRecord, 2048> buffer;
+ *
+ * void autonomous() {
+ *     const int32_t count = lemlib::loadPath("/usd/auton.lpth", buffer);
+ *     if (count == INT_MAX) return;
+ *     const lemlib::Path path(std::span(buffer.data(), count));
+ * }
+ * @endcode
+ */
+int32_t loadPath(const char* path, std::span<PathRecord> buffer);
+
+/**
+ * @brief Write a path file
+ *
+ * Paths are usually generated and written on a computer, with the simulator's path_encode tool, but they can be
+ * written on the brain too.
+ *
+ * This function uses the following values of errno when an error state is reached:
+ *
+ * EIO: the file could not be written completely
+ * any errno set by fopen
+ *
+ * @param path the path of the file, like "/usd/auton.lpth"
+ * @param records the records
+ * @return int32_t 0 on success
+ * @return INT_MAX on failure, setting errno
+ */
+int32_t savePath(const char* path, std::span<const PathRecord> records);
+
+/**
+ * @brief Write a path file from samples
+ *
+ * The samples are encoded a chunk at a time, so no buffer of records is needed.
+ *
+ * This function uses the following values of errno when an error state is reached:
+ *
+ * EIO: the file could not be written completely
+ * any errno set by fopen
+ *
+ * @param path the path of the file, like "/usd/auton.lpth"
+ * @param samples the samples
+ * @return int32_t 0 on success
+ * @return INT_MAX on failure, setting errno
+ */
+int32_t savePath(const char* path, std::span<const PathSample> samples);
+
+/**
+ * @brief Reads a path file in chunks
+ *
+ * Long paths, like the path of a skills run, don't have to fit in memory at once. A follower can read the next chunk
+ * of the path into a small buffer while it nears the end of the current one.
+ *
+ * A reader is not thread safe, and should only be used by one task.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * void autonomous() {
+ *     lemlib::PathReader reader;
+ *     if (reader.open("/usd/skills.lpth") == INT_MAX) return;
+ *     std::array<lemlib::PathRecord, 64> chunk;
+ *     int32_t count;
+ *     while ((count = reader.read(chunk)) > 0) {
+ *         follow(std::span(chunk.data(), count));
+ *     }
+ * }
+ * @endcode
+ */
+class PathReader {
+    public:
+        /**
+         * @brief Construct a new Path Reader, without a file open
+         */
+        PathReader() = default;
+        PathReader(const PathReader& other) = delete;
+        PathReader& operator=(const PathReader& other) = delete;
+        /**
+         * @brief Open a path file, closing the file which was open before
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EPROTO: the file is not a path file, or was written by a different version of the format
+         * any errno set by fopen, like ENOENT when the file does not exist
+         *
+         * @param path the path of the file, like "/usd/skills.lpth"
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno. No file is open
+         */
+        int32_t open(const char* path);
+        /**
+         * @brief Close the file
+         */
+        void close();
+        /**
+         * @brief Whether a file is open
+         *
+         * @return true a file is open
+         * @return false no file is open
+         */
+        bool isOpen() const;
+        /**
+         * @brief Read the next records
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EBADF: no file is open
+         * EPROTO: the file is shorter than its header says
+         *
+         * @param chunk the buffer the records are read into
+         * @return int32_t the number of records read, which is less than the size of the chunk at the end of the file,
+         * and 0 once every record has been read
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t read(std::span<PathRecord> chunk);
+        /**
+         * @brief Go back to the first record
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EBADF: no file is open
+         * any errno set by fseek
+         *
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t rewind();
+        /**
+         * @brief Get the number of records in the file
+         *
+         * @return uint32_t the number of records, or 0 if no file is open
+         */
+        uint32_t getSize() const;
+        /**
+         * @brief Get the index of the next record read
+         *
+         * @return uint32_t the number of records read since the file was opened or rewound
+         */
+        uint32_t getPosition() const;
+        ~PathReader();
+    private:
+        FILE* m_file = nullptr;
+        uint32_t m_size = 0;
+        uint32_t m_position = 0;
+};
+} // namespace lemlib
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "hardware/Motion/Path.hpp"
+#include "hardware/Motion/PathFile.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace lemlib {
+/**
+ * @brief The limits of a velocity profile along a path
+ */
+struct PathConstraints {
+        /** the maximum velocity */
+        LinearVelocity maxVelocity;
+        /** the maximum acceleration along the path, which is also the maximum deceleration */
+        LinearAcceleration maxAcceleration;
+        /** the maximum centripetal acceleration, which limits the velocity through turns */
+        LinearAcceleration maxLateralAcceleration;
+        /** the velocity at the first point. Defaults to 0, starting at rest */
+        LinearVelocity startVelocity = 0_mps;
+        /** the velocity at the last point. Defaults to 0, ending at rest */
+        LinearVelocity endVelocity = 0_mps;
+};
+
+namespace detail {
+/**
+ * @brief Find the signed curvature of the circle through three points
+ *
+ * @param a the first point
+ * @param b the second point
+ * @param c the third point
+ * @return Curvature the curvature, positive when the points turn counterclockwise. 0 if two of the points are in the
+ * same place
+ */
+constexpr Curvature curvatureOf(const units::V2Position& a, const units::V2Position& b, const units::V2Position& c) {
+    const double abX = to_m(b.x - a.x), abY = to_m(b.y - a.y);
+    const double bcX = to_m(c.x - b.x), bcY = to_m(c.y - b.y);
+    const double acX = to_m(c.x - a.x), acY = to_m(c.y - a.y);
+    const double lengths =
+        units::cmath::hypot(abX, abY) * units::cmath::hypot(bcX, bcY) * units::cmath::hypot(acX, acY);
+    if (lengths == 0) return 0_radpm;
+    return from_radpm(2 * (abX * bcY - abY * bcX) / lengths);
+}
+
+/**
+ * @brief Set the curvature and the target velocity of every point of a path, without checking the constraints
+ *
+ * This is the body of profilePath. It is constexpr so path tables made at compile time are profiled by exactly the
+ * same steps as paths profiled at runtime.
+ *
+ * @param samples the points of the path
+ * @param constraints the limits of the profile, which must be valid
+ */
+constexpr void profileSamples(std::span<PathSample> samples, const PathConstraints& constraints) {
+    const double maxVelocity = to_mps(constraints.maxVelocity);
+    const double maxAcceleration = to_mps2(constraints.maxAcceleration);
+    const double maxLateral = to_mps2(constraints.maxLateralAcceleration);
+    const size_t size = samples.size();
+    if (size == 0) return;
+    for (size_t i = 1; i + 1 < size; i++) {
+        samples[i].curvature = curvatureOf(samples[i - 1].position, samples[i].position, samples[i + 1].position);
+    }
+    samples[0].curvature = size > 2 ? samples[1].curvature : 0_radpm;
+    samples[size - 1].curvature = size > 2 ? samples[size - 2].curvature : 0_radpm;
+    // the velocity through a turn is limited by the lateral acceleration, v^2 * k <= a
+    for (PathSample& sample : samples) {
+        const double curvature = units::cmath::abs(to_radpm(sample.curvature));
+        sample.velocity = from_mps(std::min(maxVelocity, units::cmath::sqrt(maxLateral / curvature)));
+    }
+    samples[0].velocity = std::min(samples[0].velocity, constraints.startVelocity);
+    samples[size - 1].velocity = std::min(samples[size - 1].velocity, constraints.endVelocity);
+    // v1^2 = v0^2 + 2 * a * d, forwards for accelerating and backwards for decelerating
+    for (size_t i = 1; i < size; i++) {
+        const double distance = to_m(samples[i - 1].position.distanceTo(samples[i].position));
+        const double previous = to_mps(samples[i - 1].velocity);
+        const double reachable = units::cmath::sqrt(previous * previous + 2 * maxAcceleration * distance);
+        samples[i].velocity = std::min(samples[i].velocity, from_mps(reachable));
+    }
+    for (size_t i = size - 1; i > 0; i--) {
+        const double distance = to_m(samples[i - 1].position.distanceTo(samples[i].position));
+        const double next = to_mps(samples[i].velocity);
+        const double reachable = units::cmath::sqrt(next * next + 2 * maxAcceleration * distance);
+        samples[i - 1].velocity = std::min(samples[i - 1].velocity, from_mps(reachable));
+    }
+}
+} // namespace detail
+
+/**
+ * @brief Calculate the curvature and the target velocity of every point of a path
+ *
+ * The curvature at every point is the curvature of the circle through it and its neighbours, and the first and last
+ * points take the curvature of their neighbour. Every velocity is limited by the maximum velocity, and by the maximum
+ * lateral acceleration at its curvature. A forward pass then limits how fast the velocity can rise from one point to
+ * the next, and a backward pass how fast it can fall, so the velocities can be followed without exceeding the maximum
+ * acceleration.
+ *
+ * This takes O(n) time, and should be done when the path is generated, or once when it is loaded, rather than in the
+ * control loop. The velocity between two points can then be looked up in constant time with samplePath.
+ *
+ * This function uses the following values of errno when an error state is reached:
+ *
+ * EINVAL: a constraint is not positive, a start or end velocity is negative, or a position is not finite
+ *
+ * @param samples the points of the path. Their positions are used, and their curvatures and velocities are set
+ * @param constraints the limits of the profile
+ * @return int32_t 0 on success
+ * @return INT_MAX on failure, setting errno. The samples are not changed
+ *
+ * @b Example:
+ * @code {.cpp}
+ * std::vector<lemlib::PathSample> samples = generatePath();
+ * lemlib::profilePath(samples, {.maxVelocity = 60_inps, .maxAcceleration = 120_inps2,
+ *                               .maxLateralAcceleration = 80_inps2});
+ * @endcode
+ */
+int32_t profilePath(std::span<PathSample> samples, PathConstraints constraints);
+
+/**
+ * @brief Look up the target velocity and the curvature at a point of a path
+ *
+ * The velocity is interpolated so that its square changes linearly with distance, which is exact for the
+ * accelerating and decelerating parts of a profile. The curvature is taken from the closest end of the segment.
+ *
+ * @param path the path
+ * @param samples the points of the path, one per waypoint, like ones set by profilePath. The path must not have
+ * dropped any of them as duplicates
+ * @param point the point, like one found by PathTracker::closest
+ * @return PathSample the sample at the point. A sample at rest at the point if there are fewer samples than
+ * waypoints
+ *
+ * @b Example:
+ * @code {.cpp}
+ * void autonomous() {
+ *     lemlib::PathTracker tracker(path);
+ *     while (true) {
+ *         const lemlib::PathSample target = lemlib::samplePath(path, samples, tracker.closest(getPosition()));
+ *         drive(target.velocity, target.curvature);
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+PathSample samplePath(const Path& path, std::span<const PathSample> samples, const PathPoint& point);
+
+/**
+ * @brief Look up the target velocity and the curvature at a point of a path
+ *
+ * @param path the path
+ * @param records the records of the path, one per waypoint, like ones read by loadPath. The path must not have
+ * dropped any of them as duplicates
+ * @param point the point, like one found by PathTracker::closest
+ * @return PathSample the sample at the point. A sample at rest at the point if there are fewer records than
+ * waypoints
+ */
+PathSample samplePath(const Path& path, std::span<const PathRecord> records, const PathPoint& point);
+} // namespace lemlib
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "hardware/Motion/PathProfile.hpp"
+#include "units/Angle.hpp"
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace lemlib {
+/**
+ * @brief A path which was profiled at compile time
+ *
+ * Every array has one element per waypoint. A table made with makePathTable and stored in a constexpr variable is
+ * placed in read-only memory, so it takes no RAM and no time at startup.
+ */
+template <size_t N> struct PathTable {
+        /** the waypoints, which a Path can be constructed from */
+        std::array<units::V2Position, N> waypoints;
+        /** the curvature and target velocity at every waypoint, which samplePath looks up */
+        std::array<PathSample, N> samples;
+        /** the direction of travel at every waypoint, counterclockwise from the positive x axis */
+        std::array<Angle, N> headings;
+        /** the distance along the path from the first waypoint to every waypoint */
+        std::array<Length, N> distances;
+
+        /**
+         * @brief Get the length of the whole path
+         *
+         * @return Length the length
+         */
+        constexpr Length length() const { return N == 0 ? 0_m : distances[N - 1]; }
+};
+
+namespace detail {
+// not constexpr, so a path table with invalid constraints or repeated waypoints fails to compile, and the error names it
+void invalidPathTable();
+
+// an array with every element set to a value, for quantities, which can't be default constructed
+template <typename T, size_t N> constexpr std::array<T, N> filledArray(const T& value) {
+    return [&]<size_t... I>(std::index_sequence<I...>) {
+        return std::array<T, N> {((void)I, value)...};
+    }(std::make_index_sequence<N>());
+}
+} // namespace detail
+
+/**
+ * @brief Profile a path at compile time
+ *
+ * The curvatures and velocities are calculated by the same steps as profilePath, so they match a path profiled at
+ * runtime. The heading at every waypoint is the direction from the waypoint before it to the waypoint after it, and
+ * the first and last waypoints take the direction of their segment.
+ *
+ * Constraints which profilePath would reject, waypoints which aren't finite, and waypoints in the same place as the
+ * one before them fail to compile, because a Path would drop them and the table would no longer line up with it.
+ *
+ * @param waypoints the waypoints
+ * @param constraints the limits of the profile
+ * @return PathTable<N> the table
+ *
+ * @b Example:
+ * @code {.cpp}
+ * constexpr auto skills = lemlib::makePathTable<4>({{{0_in, 0_in}, {1_tile, 0_in}, {1_tile, 1_tile}, {2_tile, 1_tile}}},
+ *                                                  {.maxVelocity = 60_inps, .maxAcceleration = 120_inps2,
+ *                                                   .maxLateralAcceleration = 80_inps2});
+ *
+ * void autonomous() {
+ *     const lemlib::Path path(skills.waypoints);
+ *     lemlib::PathTracker tracker(path);
+ *     while (true) {
+ *         const lemlib::PathSample target = lemlib::samplePath(path, skills.samples, tracker.closest(getPosition()));
+ *         drive(target.velocity, target.curvature);
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+template <size_t N>
+consteval PathTable<N> makePathTable(const std::array<units::V2Position, N>& waypoints, PathConstraints constraints) {
+    // the comparisons are written so NaN fails them
+    if (!(constraints.maxVelocity > 0_mps && constraints.maxAcceleration > 0_mps2 &&
+          constraints.maxLateralAcceleration > 0_mps2 && constraints.startVelocity >= 0_mps &&
+          constraints.endVelocity >= 0_mps)) {
+        detail::invalidPathTable();
+    }
+    PathTable<N> table {.waypoints = waypoints,
+                        .samples = {},
+                        .headings = detail::filledArray<Angle, N>(0_stDeg),
+                        .distances = detail::filledArray<Length, N>(0_m)};
+    for (size_t i = 0; i < N; i++) {
+        const units::V2Position& waypoint = waypoints[i];
+        // infinity minus itself is NaN, so this only holds for finite positions
+        if (!(to_m(waypoint.x - waypoint.x) == 0 && to_m(waypoint.y - waypoint.y) == 0)) detail::invalidPathTable();
+        if (i > 0 && waypoint.x == waypoints[i - 1].x && waypoint.y == waypoints[i - 1].y) detail::invalidPathTable();
+        table.samples[i].position = waypoint;
+        table.distances[i] = i == 0 ? 0_m : table.distances[i - 1] + waypoints[i - 1].distanceTo(waypoint);
+    }
+    detail::profileSamples(table.samples, constraints);
+    for (size_t i = 0; N > 1 && i < N; i++) {
+        const size_t from = i == 0 ? 0 : i - 1;
+        const size_t to = i == N - 1 ? N - 1 : i + 1;
+        table.headings[i] = waypoints[from].angleTo(waypoints[to]);
+    }
+    return table;
+}
+} // namespace lemlib
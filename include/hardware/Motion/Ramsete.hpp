@@ -0,0 +1,153 @@
+#pragma once
+
+#include "hardware/Motion/PathFile.hpp"
+#include "hardware/Motor/DifferentialDrive.hpp"
+#include "units/Pose.hpp"
+#include <cstddef>
+#include <span>
+
+namespace lemlib {
+/**
+ * @brief Where a trajectory wants the robot to be at a point in time, and how fast it wants it to move
+ */
+struct TrajectoryState {
+        /** the pose of the robot. The orientation is counterclockwise from the positive x axis */
+        units::Pose pose = units::Pose(0_m, 0_m, 0_stRad);
+        /** the forward velocity of the robot */
+        LinearVelocity velocity = 0_mps;
+        /** the rate the robot turns at, positive counterclockwise */
+        AngularVelocity angularVelocity = 0_radps;
+};
+
+/**
+ * @brief Samples a profiled path by time
+ *
+ * The samples of a path, like ones set by profilePath or read from a path file, are given a time each. Between two
+ * samples the robot accelerates at a constant rate, so the square of the velocity changes linearly with distance, like
+ * it does in the profile. The orientation is the direction of the segment the robot is on, and the angular velocity is
+ * the velocity times the curvature.
+ *
+ * Time only moves forwards in a control loop, so the sampler keeps the segment it is on, and each sample only steps
+ * over the segments passed since the last one. Nothing is stored per sample, and nothing is allocated.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::TrajectorySampler trajectory(samples);
+ *
+ * void autonomous() {
+ *     const uint32_t start = pros::millis();
+ *     while (!trajectory.done()) {
+ *         const lemlib::TrajectoryState reference = trajectory.sample(from_msec(pros::millis() - start));
+ *         drive.moveVelocity(ramsete.calculate(odom.getPose(), reference), 3.25_in);
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class TrajectorySampler {
+    public:
+        /**
+         * @brief Construct a new Trajectory Sampler
+         *
+         * @param samples the points of the path, with their velocities and curvatures. They must outlive the sampler
+         */
+        TrajectorySampler(std::span<const PathSample> samples);
+        /**
+         * @brief Get the state of the trajectory at a time
+         *
+         * Times before the time of the last sample step backwards from the start. Times after the end return the
+         * last point, at rest.
+         *
+         * @param time the time since the start of the trajectory
+         * @return TrajectoryState the state
+         */
+        TrajectoryState sample(Time time);
+        /**
+         * @brief whether the last sample reached the end of the trajectory
+         *
+         * @return true the last sample was at or after the end
+         * @return false the trajectory has not been sampled, or the last sample was before the end
+         */
+        bool done() const;
+        /**
+         * @brief Get the segment the last sample was on
+         *
+         * @return size_t the index of the sample the segment starts at. The index of the last sample once the
+         * trajectory is done
+         */
+        size_t getSegment() const;
+        /**
+         * @brief Go back to the start of the trajectory
+         */
+        void reset();
+    private:
+        /**
+         * @brief Get the time it takes to follow a segment
+         *
+         * @param segment the index of the segment, from the sample at the same index to the next one
+         * @return double the time, in seconds. 0 if the robot is at rest at both ends, as it never moves along it
+         */
+        double segmentTime(size_t segment) const;
+
+        std::span<const PathSample> m_samples;
+        // the segment the last sample was on, and the time it starts, in seconds
+        size_t m_segment = 0;
+        double m_segmentStart = 0;
+        bool m_done = false;
+};
+
+/**
+ * @brief The gains of a RamseteController
+ */
+struct RamseteGains {
+        /** how aggressively errors are corrected, in rad^2/m^2. Larger values converge faster */
+        Number b = 2;
+        /** the damping of the correction, from 0 to 1. Larger values overshoot less */
+        Number zeta = 0.7;
+};
+
+/**
+ * @brief A RAMSETE trajectory tracking controller for a differential drive
+ *
+ * RAMSETE is a nonlinear feedback law for a unicycle. The error between the pose of the robot and the pose of the
+ * trajectory is rotated into the frame of the robot, and the velocity and angular velocity of the trajectory are
+ * corrected by it, with a gain that grows with the speed of the trajectory. Unlike a linear controller, it converges
+ * from any error, so it keeps tracking after a bump.
+ *
+ * Every sine and cosine comes from the fast trig kernels, the orientation of the robot and the heading error each
+ * taking a single sincos, and nothing is allocated, so one step takes a few microseconds on the brain.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::RamseteController ramsete(11_in);
+ *
+ * void autonomous() {
+ *     const lemlib::DriveVelocities velocities = ramsete.calculate(odom.getPose(), trajectory.sample(elapsed));
+ *     drive.moveVelocity(velocities, 3.25_in);
+ * }
+ * @endcode
+ */
+class RamseteController {
+    public:
+        /**
+         * @brief Construct a new Ramsete Controller
+         *
+         * @param trackWidth the distance between the wheels on the left and right sides
+         * @param gains the gains of the controller
+         */
+        RamseteController(Length trackWidth, RamseteGains gains = {});
+        /**
+         * @brief Calculate the velocity of each side which brings the robot onto the trajectory
+         *
+         * @param current the pose of the robot. The orientation is counterclockwise from the positive x axis
+         * @param reference the state of the trajectory at the same time
+         * @return DriveVelocities the velocity of the wheels on each side
+         */
+        DriveVelocities calculate(const units::Pose& current, const TrajectoryState& reference) const;
+    private:
+        // in meters, and in the units of the gains
+        double m_halfTrackWidth;
+        double m_b;
+        double m_zeta;
+};
+} // namespace lemlib
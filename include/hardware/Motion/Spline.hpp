@@ -0,0 +1,242 @@
+#pragma once
+
+#include "units/Angle.hpp"
+#include "units/Vector2D.hpp"
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace lemlib {
+/**
+ * @brief A point on a Spline, with the direction and curvature of the spline there
+ */
+struct SplineSample {
+        /** the position of the point */
+        units::V2Position position = units::V2Position(0_m, 0_m);
+        /** the direction of the spline, counterclockwise from the positive x axis */
+        Angle heading = 0_stRad;
+        /** the curvature of the spline, positive when it turns counterclockwise. INFINITY where it stops moving */
+        Curvature curvature = 0_radpm;
+};
+
+/**
+ * @brief A polynomial curve, up to degree 5, with a parameter from 0 to 1
+ *
+ * Splines are made from Hermite control data, which is the position, tangent and, for quintics, acceleration at both
+ * ends, or from the control points of a Bezier curve. Every kind is converted to the coefficients of one polynomial
+ * per axis when it is made, so they are all evaluated the same way, with Horner's method.
+ *
+ * Tangents and accelerations are derivatives with respect to the parameter, so they are lengths. Longer tangents make
+ * the spline leave its ends in a straighter line.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * // leave the origin facing forwards, and arrive at (24, 24) facing left
+ * const lemlib::Spline spline =
+ *     lemlib::Spline::cubicHermite({0_in, 0_in}, {36_in, 0_in}, {24_in, 24_in}, {0_in, 36_in});
+ * const lemlib::SplineSample middle = spline.sample(0.5);
+ * @endcode
+ */
+class Spline {
+    public:
+        /**
+         * @brief Make a cubic Hermite spline
+         *
+         * @param start the position at the start
+         * @param startTangent the derivative of the position at the start
+         * @param end the position at the end
+         * @param endTangent the derivative of the position at the end
+         * @return Spline the spline
+         */
+        static Spline cubicHermite(units::V2Position start, units::V2Position startTangent, units::V2Position end,
+                                   units::V2Position endTangent);
+        /**
+         * @brief Make a quintic Hermite spline
+         *
+         * Unlike a cubic Hermite spline, the second derivative is also set at both ends, so splines joined end to end
+         * have continuous curvature, and the robot doesn't have to change its turning rate instantly.
+         *
+         * @param start the position at the start
+         * @param startTangent the derivative of the position at the start
+         * @param startAcceleration the second derivative of the position at the start
+         * @param end the position at the end
+         * @param endTangent the derivative of the position at the end
+         * @param endAcceleration the second derivative of the position at the end
+         * @return Spline the spline
+         */
+        static Spline quinticHermite(units::V2Position start, units::V2Position startTangent,
+                                     units::V2Position startAcceleration, units::V2Position end,
+                                     units::V2Position endTangent, units::V2Position endAcceleration);
+        /**
+         * @brief Make a cubic Bezier curve
+         *
+         * The curve starts at the first control point, heading towards the second, and ends at the last, arriving from
+         * the direction of the third.
+         *
+         * @param p0 the first control point
+         * @param p1 the second control point
+         * @param p2 the third control point
+         * @param p3 the last control point
+         * @return Spline the spline
+         */
+        static Spline cubicBezier(units::V2Position p0, units::V2Position p1, units::V2Position p2,
+                                  units::V2Position p3);
+        /**
+         * @brief Make a quintic Bezier curve
+         *
+         * @param points the six control points
+         * @return Spline the spline
+         */
+        static Spline quinticBezier(const std::array<units::V2Position, 6>& points);
+        /**
+         * @brief Get the position at a parameter
+         *
+         * @param t the parameter, from 0 at the start to 1 at the end
+         * @return units::V2Position the position
+         */
+        units::V2Position position(Number t) const;
+        /**
+         * @brief Get the position, heading and curvature at a parameter
+         *
+         * @param t the parameter, from 0 at the start to 1 at the end
+         * @return SplineSample the sample
+         */
+        SplineSample sample(Number t) const;
+        /**
+         * @brief Get the degree of the spline
+         *
+         * @return size_t 3 for cubic splines, 5 for quintic splines
+         */
+        size_t degree() const;
+    private:
+        friend class SplineStepper;
+
+        /** the highest degree a spline can have */
+        static constexpr size_t MAX_DEGREE = 5;
+        /** the coefficients of a polynomial, in meters, lowest power first */
+        using Coefficients = std::array<double, MAX_DEGREE + 1>;
+
+        Spline(const Coefficients& x, const Coefficients& y, size_t degree);
+
+        Coefficients m_x;
+        Coefficients m_y;
+        size_t m_degree;
+};
+
+/**
+ * @brief Samples a Spline at evenly spaced parameters with forward differencing
+ *
+ * The differences of a polynomial of degree n, sampled at even steps, are a polynomial of degree n - 1, so its n-th
+ * difference is constant. The stepper keeps every difference of the position and of its first two derivatives, and
+ * each step adds each difference to the one below it. A sample then takes a few additions per axis, instead of
+ * evaluating three polynomials, plus the atan2 and division of the heading and curvature.
+ *
+ * The first differences are calculated from the coefficients, not by differencing evaluated points, so the rounding
+ * errors which build up over the steps stay about as small as those of evaluating the polynomial directly.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::SplineStepper stepper(spline, 100);
+ * while (!stepper.done()) {
+ *     const lemlib::SplineSample sample = stepper.next();
+ *     std::cout << to_in(sample.position.x) << ", " << to_in(sample.position.y) << std::endl;
+ * }
+ * @endcode
+ */
+class SplineStepper {
+    public:
+        /**
+         * @brief Construct a new Spline Stepper
+         *
+         * @param spline the spline. It is only read by the constructor
+         * @param steps the number of even steps from the start to the end. steps + 1 samples are taken, including both
+         * ends. At least 1
+         */
+        SplineStepper(const Spline& spline, size_t steps);
+        /**
+         * @brief whether every sample has been taken
+         *
+         * @return true the last sample, at the end of the spline, has been taken
+         * @return false there are samples left
+         */
+        bool done() const;
+        /**
+         * @brief Take the next sample, and step forwards
+         *
+         * @return SplineSample the sample. Once done, the last sample is returned again
+         */
+        SplineSample next();
+        /**
+         * @brief Take the next position, and step forwards, skipping the heading and curvature
+         *
+         * @return units::V2Position the position. Once done, the last position is returned again
+         */
+        units::V2Position nextPosition();
+    private:
+        // the position, first derivative and second derivative, for each axis
+        static constexpr size_t SERIES = 6;
+
+        /**
+         * @brief Step every series forwards
+         */
+        void step();
+
+        // the forward differences of every series, from the value itself up to the fifth difference
+        std::array<Spline::Coefficients, SERIES> m_differences;
+        size_t m_remaining;
+};
+
+/**
+ * @brief The distance along a Spline at evenly spaced parameters, to find where a distance along it is
+ *
+ * Even steps of the parameter aren't even steps of distance, as the spline moves faster in some places than in others.
+ * The table is calculated once, when it is constructed, which is the only time it allocates memory. Looking up the
+ * parameter at a distance is then a binary search, and a linear interpolation.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * const lemlib::ArcLengthTable table(spline);
+ *
+ * void autonomous() {
+ *     // the point 12 inches along the spline
+ *     const lemlib::SplineSample target = spline.sample(table.getParameter(12_in));
+ * }
+ * @endcode
+ */
+class ArcLengthTable {
+    public:
+        /**
+         * @brief Construct a new Arc Length Table
+         *
+         * The distance between two samples is the length of the straight line between them, so the length is
+         * slightly short where the spline curves. The error shrinks with the square of the number of steps.
+         *
+         * @param spline the spline. It is only read by the constructor
+         * @param steps the number of even steps of the parameter. Defaults to 64
+         */
+        ArcLengthTable(const Spline& spline, size_t steps = 64);
+        /**
+         * @brief Get the length of the whole spline
+         *
+         * @return Length the length
+         */
+        Length getLength() const;
+        /**
+         * @brief Get the parameter at a distance along the spline
+         *
+         * @param distance the distance from the start. It is clamped to the length of the spline
+         * @return Number the parameter, from 0 to 1
+         */
+        Number getParameter(Length distance) const;
+        /**
+         * @brief Get the distance along the spline at a parameter
+         *
+         * @param t the parameter. It is clamped from 0 to 1
+         * @return Length the distance from the start
+         */
+        Length getDistance(Number t) const;
+    private:
+        // the distance at every step, in meters, from 0 at the start to the length at the end
+        std::vector<double> m_distances;
+};
+} // namespace lemlib
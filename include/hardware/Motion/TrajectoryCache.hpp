@@ -0,0 +1,159 @@
+#pragma once
+
+#include "hardware/Motion/PathFile.hpp"
+#include "hardware/Motion/PathProfile.hpp"
+#include "units/Angle.hpp"
+#include <atomic>
+#include <cstdint>
+#include <span>
+
+namespace lemlib {
+/**
+ * @brief A point a generated trajectory passes through, with the direction it passes through it in
+ */
+struct Waypoint {
+        /** the position of the point */
+        units::V2Position position = units::V2Position(0_m, 0_m);
+        /** the direction of travel, counterclockwise from the positive x axis */
+        Angle heading = 0_stRad;
+};
+
+/**
+ * @brief Get the number of samples generateTrajectory makes from a list of waypoints
+ *
+ * @param waypoints the waypoints
+ * @param spacing the distance between samples
+ * @return int32_t the number of samples
+ * @return INT_MAX on failure, setting errno to EINVAL: there are fewer than 2 waypoints, or the spacing isn't positive
+ */
+int32_t countTrajectorySamples(std::span<const Waypoint> waypoints, Length spacing);
+
+/**
+ * @brief Generate a profiled trajectory through a list of waypoints
+ *
+ * Consecutive waypoints are joined by cubic Hermite splines, with tangents as long as the chord between them, which
+ * are sampled at even distances along them. The samples are then given a time-optimal velocity profile by
+ * profilePath. Every spline builds an ArcLengthTable, so this allocates memory, and should be run before the
+ * routine starts. Use a TrajectoryCache to only generate a trajectory once.
+ *
+ * This function uses the following values of errno when an error state is reached:
+ *
+ * EINVAL: there are fewer than 2 waypoints, the spacing isn't positive, or the constraints are invalid
+ * ENOBUFS: the samples don't fit in the buffer. countTrajectorySamples gives the size it needs
+ *
+ * @param waypoints the waypoints
+ * @param constraints the limits of the profile
+ * @param spacing the distance between samples
+ * @param samples the buffer the samples are written to
+ * @return int32_t the number of samples
+ * @return INT_MAX on failure, setting errno
+ *
+ * @b Example:
+ * @code {.cpp}
+ * const lemlib::Waypoint waypoints[] = {{{0_in, 0_in}, 0_stDeg}, {{24_in, 24_in}, 90_stDeg}};
+ * std::array<lemlib::PathSample, 256> samples;
+ *
+ * void initialize() {
+ *     const int32_t count = lemlib::generateTrajectory(waypoints, constraints, 1_cm, samples);
+ * }
+ * @endcode
+ */
+int32_t generateTrajectory(std::span<const Waypoint> waypoints, const PathConstraints& constraints, Length spacing,
+                           std::span<PathSample> samples);
+
+/**
+ * @brief Hash every input of generateTrajectory
+ *
+ * The hash is a 64 bit FNV-1a of the waypoints, the constraints, the spacing, the version of the path file format and
+ * the version of the generator, so a trajectory is generated again whenever any of them changes.
+ *
+ * @param waypoints the waypoints
+ * @param constraints the limits of the profile
+ * @param spacing the distance between samples
+ * @return uint64_t the hash
+ */
+uint64_t hashTrajectory(std::span<const Waypoint> waypoints, const PathConstraints& constraints, Length spacing);
+
+/**
+ * @brief Caches generated trajectories as path files, named after the hash of their inputs
+ *
+ * Generating every trajectory of a routine can take a noticeable time at startup. The first time a trajectory is
+ * asked for, it is generated and saved to the SD card, in a file named after hashTrajectory. On every later boot,
+ * the file is loaded instead, which is a few reads of the card, until the waypoints, the constraints or the spacing
+ * change. A file of a trajectory which isn't used anymore is never read again, and can be deleted.
+ *
+ * A generated trajectory is rounded to the resolution of a path file before it is returned, so it is exactly the
+ * trajectory later boots load. The trajectory_gen tool prints the file name of every path it generates, so a cache
+ * can be filled on a computer too.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::TrajectoryCache cache("/usd");
+ * std::array<lemlib::PathSample, 512> toGoal;
+ * int32_t toGoalSize = 0;
+ *
+ * void initialize() {
+ *     toGoalSize = cache.get(toGoalWaypoints, constraints, 1_cm, toGoal);
+ *     std::cout << cache.getHits() << " trajectories loaded" << std::endl;
+ * }
+ * @endcode
+ */
+class TrajectoryCache {
+    public:
+        /** the version of the generator, which is part of the hash so a changed generator doesn't load old files */
+        static constexpr uint32_t GENERATOR_VERSION = 1;
+        /**
+         * @brief Construct a new Trajectory Cache
+         *
+         * @param directory the directory the files are stored in, like "/usd". It must exist, and the string must
+         * outlive the cache
+         */
+        TrajectoryCache(const char* directory = "/usd");
+        /**
+         * @brief Load a trajectory from the cache, or generate it and save it if it isn't cached
+         *
+         * A file which can't be read, or is corrupt, is generated and saved again. The trajectory is still returned
+         * when it can't be saved, like when there is no SD card, it is just generated again on the next boot.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: there are fewer than 2 waypoints, the spacing isn't positive, or the constraints are invalid
+         * ENOBUFS: the samples don't fit in the buffer
+         *
+         * @param waypoints the waypoints
+         * @param constraints the limits of the profile
+         * @param spacing the distance between samples
+         * @param samples the buffer the samples are written to
+         * @return int32_t the number of samples
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t get(std::span<const Waypoint> waypoints, const PathConstraints& constraints, Length spacing,
+                    std::span<PathSample> samples);
+        /**
+         * @brief Get the number of trajectories which were loaded from files
+         *
+         * @return uint32_t the number of hits
+         */
+        uint32_t getHits() const;
+        /**
+         * @brief Get the number of trajectories which had to be generated
+         *
+         * @return uint32_t the number of misses
+         */
+        uint32_t getMisses() const;
+    private:
+        /**
+         * @brief Load a cached trajectory
+         *
+         * @param path the path of the file
+         * @param samples the buffer the samples are written to
+         * @return int32_t the number of samples
+         * @return INT_MAX if the file can't be read, is corrupt, or doesn't fit in the buffer, setting errno
+         */
+        static int32_t load(const char* path, std::span<PathSample> samples);
+
+        const char* m_directory;
+        std::atomic<uint32_t> m_hits = 0;
+        std::atomic<uint32_t> m_misses = 0;
+};
+} // namespace lemlib
@@ -0,0 +1,294 @@
+#pragma once
+
+#include "hardware/Motor/Motor.hpp"
+#include "hardware/Motor/MotorGroup.hpp"
+#include "hardware/Motor/VelocityController.hpp"
+#include "hardware/Result.hpp"
+#include "pros/rtos.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace lemlib {
+/**
+ * @brief The tests a Characterization runs
+ */
+struct CharacterizationSettings {
+        /** the power the quasistatic ramp ends at */
+        Number rampPower = 0.5;
+        /** how long the quasistatic ramp takes to reach its power. Slower ramps keep the acceleration closer to 0 */
+        Time rampDuration = 4_sec;
+        /** the power of the dynamic step */
+        Number stepPower = 0.6;
+        /** how long the dynamic step lasts */
+        Time stepDuration = 1.5_sec;
+        /** how long the motors coast to a stop between the tests */
+        Time settleDuration = 1_sec;
+        /** samples slower than this are not fitted, as the direction of static friction is unknown when stopped */
+        AngularVelocity minVelocity = 2_rpm;
+        /** whether to run the tests backwards */
+        bool reverse = false;
+};
+
+/**
+ * @brief A sample logged by a Characterization
+ */
+struct CharacterizationSample {
+        /** the time since the tests started */
+        Time time = 0_sec;
+        /** the power the motors were moved at */
+        Number power = 0;
+        /** the power times the voltage of the battery, which is the voltage the motors were given */
+        Voltage voltage = 0_volt;
+        /** the velocity of the motors, after gearing */
+        AngularVelocity velocity = 0_rpm;
+        /** the acceleration of the motors, after gearing */
+        AngularAcceleration acceleration = 0_rps2;
+        /** the combined current of the motors */
+        Current current = 0_amp;
+};
+
+/**
+ * @brief The feedforward fitted by a Characterization
+ */
+struct CharacterizationResult {
+        /** the feedforward, in the units of a VelocityController. Only kS, kV and kA are set */
+        VelocityControllerGains gains;
+        /** the fraction of the variance of the power explained by the fit, from 0 to 1. Close to 1 is a good fit */
+        Number rSquared = 0;
+        /** the number of samples which were fitted */
+        size_t samples = 0;
+};
+
+/**
+ * @brief What a Characterization is doing
+ */
+enum class CharacterizationPhase {
+    /** the tests haven't started */
+    IDLE,
+    /** the power is ramping up slowly */
+    QUASISTATIC,
+    /** the motors are coasting to a stop */
+    SETTLING,
+    /** the power jumped to the step power */
+    DYNAMIC,
+    /** the tests finished, or were stopped */
+    DONE
+};
+
+/**
+ * @brief The storage independent part of Characterization
+ *
+ * Use Characterization to create a characterization.
+ */
+class CharacterizationBase {
+    public:
+        CharacterizationBase(const CharacterizationBase& other) = delete;
+        CharacterizationBase& operator=(const CharacterizationBase& other) = delete;
+        /**
+         * @brief Destroy the Characterization, stopping its task
+         */
+        ~CharacterizationBase();
+        /**
+         * @brief Run one step of the tests
+         *
+         * This is called periodically by the characterization task, but can also be called manually if the task is
+         * not started. It never allocates memory.
+         *
+         * @return 0 the motors were moved
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t update();
+        /**
+         * @brief Start the tests in a task
+         *
+         * The fit and the log from the last run are cleared.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EBUSY: the tests are already running
+         * ENOMEM: the task could not be created
+         *
+         * @param period how often a sample is taken. Defaults to 10 ms, which is how often motors update
+         * @param priority the priority of the task. Defaults to two above the default priority, like a
+         * VelocityController
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t start(Time period = 10_msec, uint32_t priority = TASK_PRIORITY_DEFAULT + 2);
+        /**
+         * @brief Stop the tests, and stop the motors
+         *
+         * This function blocks until the current update finishes. The samples fitted so far are kept.
+         */
+        void stop();
+        /**
+         * @brief Get what the tests are doing
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * @return CharacterizationPhase the phase
+         */
+        CharacterizationPhase getPhase() const;
+        /**
+         * @brief Solve the fit of the samples so far
+         *
+         * The fit is a least squares fit of power = kS * sign(velocity) + kV * velocity + kA * acceleration. Every
+         * sample is added to its normal equations as it is taken, so the fit covers every sample, even ones which no
+         * longer fit in the log, and solving it is a 3x3 system no matter how many samples there are.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EAGAIN: fewer than 3 samples were fitted
+         * EDOM: the samples can't separate the three gains, like when the acceleration was always 0
+         *
+         * @return Result<CharacterizationResult> the fit
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void autonomous() {
+         *     characterization.start();
+         *     while (characterization.getPhase() != lemlib::CharacterizationPhase::DONE) pros::delay(100);
+         *     const lemlib::Result<lemlib::CharacterizationResult> fit = characterization.getResult();
+         *     if (fit.ok()) controller.setGains(fit.value().gains);
+         * }
+         * @endcode
+         */
+        Result<CharacterizationResult> getResult() const;
+        /**
+         * @brief Get the log of the samples
+         *
+         * Only read the log once the tests are done, as the task writes to it while they run.
+         *
+         * @return std::span<const CharacterizationSample> the samples, oldest first. Samples taken once the log was
+         * full are dropped
+         */
+        std::span<const CharacterizationSample> getSamples() const;
+    protected:
+        /**
+         * @brief Construct a new Characterization Base for a motor
+         *
+         * @param motor the motor. It must outlive the characterization
+         * @param settings the tests to run
+         * @param storage the storage for the log. It must outlive the characterization
+         * @param capacity the number of samples the storage holds
+         */
+        CharacterizationBase(Motor& motor, const CharacterizationSettings& settings, CharacterizationSample* storage,
+                             size_t capacity);
+        /**
+         * @brief Construct a new Characterization Base for a motor group
+         *
+         * @param motors the motor group. It must outlive the characterization
+         * @param settings the tests to run
+         * @param storage the storage for the log. It must outlive the characterization
+         * @param capacity the number of samples the storage holds
+         */
+        CharacterizationBase(MotorGroup& motors, const CharacterizationSettings& settings,
+                             CharacterizationSample* storage, size_t capacity);
+    private:
+        /**
+         * @brief the function run by the characterization task
+         *
+         * @param characterization pointer to the characterization
+         */
+        static void taskFunction(void* characterization);
+        /**
+         * @brief Clear the fit and the log, and go back to the start of the tests
+         *
+         * The mutex has to be locked before this function is called
+         */
+        void reset();
+        /**
+         * @brief Add a sample to the normal equations of the fit
+         *
+         * @param sample the sample
+         */
+        void fit(const CharacterizationSample& sample);
+        template <typename T> static int32_t moveTarget(Encoder& target, Number power);
+        template <typename T> static AngularVelocity measureVelocity(const Encoder& target);
+        template <typename T> static AngularAcceleration measureAcceleration(const Encoder& target);
+        template <typename T> static Current measureCurrent(const Encoder& target);
+
+        Encoder& m_target;
+        int32_t (*const m_move)(Encoder&, Number);
+        AngularVelocity (*const m_measureVelocity)(const Encoder&);
+        AngularAcceleration (*const m_measureAcceleration)(const Encoder&);
+        Current (*const m_measureCurrent)(const Encoder&);
+        const CharacterizationSettings m_settings;
+        CharacterizationSample* const m_storage;
+        const size_t m_capacity;
+        // the number of samples in the log, published once each sample is written
+        std::atomic<size_t> m_size = 0;
+        std::atomic<CharacterizationPhase> m_phase = CharacterizationPhase::IDLE;
+        // when the tests and the current phase started, in microseconds, and the power the motors are moving at
+        uint64_t m_start = 0;
+        uint64_t m_phaseStart = 0;
+        double m_power = 0;
+        // the normal equations of the fit: the upper triangle of X^T X, X^T y, and the sums of y and y^2
+        std::array<double, 6> m_xx {};
+        std::array<double, 3> m_xy {};
+        double m_y = 0;
+        double m_yy = 0;
+        size_t m_fitted = 0;
+        // protects the fit, which is written by the task and solved by any task
+        mutable pros::Mutex m_mutex;
+        Time m_period = 10_msec;
+        // the task is not deleted from outside, as it could be holding a device mutex. Instead it is asked to exit
+        std::atomic<bool> m_running = false;
+        std::atomic<bool> m_taskExited = true;
+};
+
+/**
+ * @brief Characterization class
+ *
+ * Finds the kS, kV and kA feedforward of a motor or motor group on the brain, so a mechanism can be retuned in seconds
+ * at an event, without a laptop. Two tests are run through move: a quasistatic ramp, where the power rises slowly so
+ * the velocity follows it with almost no acceleration, and a dynamic step, where the power jumps so the acceleration
+ * is large. The power, the voltage, the velocity, the acceleration and the current are logged every period, and fitted
+ * with an online least squares fit as they are taken.
+ *
+ * The log is stored inside the object, so the tests never allocate memory. The fit keeps going once the log is full.
+ *
+ * @tparam N the number of samples the log holds
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::MotorGroup flywheel({1, -2}, 3600_rpm);
+ * lemlib::Characterization<1000> characterization(flywheel);
+ *
+ * void opcontrol() {
+ *     characterization.start();
+ *     while (characterization.getPhase() != lemlib::CharacterizationPhase::DONE) pros::delay(100);
+ *     const auto fit = characterization.getResult();
+ *     if (fit.ok()) printf("kS %f kV %f kA %f\n", fit.value().gains.kS, fit.value().gains.kV, fit.value().gains.kA);
+ * }
+ * @endcode
+ */
+template <size_t N> class Characterization : public CharacterizationBase {
+    public:
+        /**
+         * @brief Construct a new Characterization for a motor
+         *
+         * @param motor the motor. It must outlive the characterization
+         * @param settings the tests to run
+         */
+        Characterization(Motor& motor, const CharacterizationSettings& settings = {})
+            : CharacterizationBase(motor, settings, m_storage.data(), N) {}
+        /**
+         * @brief Construct a new Characterization for a motor group
+         *
+         * @param motors the motor group. It must outlive the characterization
+         * @param settings the tests to run
+         */
+        Characterization(MotorGroup& motors, const CharacterizationSettings& settings = {})
+            : CharacterizationBase(motors, settings, m_storage.data(), N) {}
+        /**
+         * @brief Destroy the Characterization, stopping its task before the log is destroyed
+         */
+        ~Characterization() { stop(); }
+    private:
+        std::array<CharacterizationSample, N> m_storage {};
+};
+} // namespace lemlib
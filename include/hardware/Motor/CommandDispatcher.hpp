@@ -0,0 +1,172 @@
+#pragma once
+
+#include "hardware/Motor/Motor.hpp"
+#include "units/core.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief CommandDispatcher class
+ *
+ * Every move, moveVelocity or brake sends its command to the motor right away, so a motor commanded by several
+ * control loops gets a command from each, and every task which commands a motor pays for the SDK call. The dispatcher
+ * separates working out a command from sending it. A control task prepares a command with Motor::prepareMove,
+ * prepareMoveVelocity or prepareBrake, and submits it, which writes it into the PortState of the port of the motor.
+ * Submitting never locks and never calls the SDK. Once per tick, flush sends the latest command of every port, one
+ * after the other.
+ *
+ * The latest command submitted to a port replaces the previous one, unless the previous one has a higher priority, so
+ * a higher priority task, like a safety stop, can't be overridden by a lower priority one until the next flush. A
+ * command which is exactly the command last sent to the motor, less than a refresh period ago, isn't sent again.
+ *
+ * The dispatcher also arbitrates between sources which command the same port, whether they submit commands or move
+ * motors directly. A command with a priority above 0, set with Motor::setCommandPriority or passed to submit, makes
+ * its source the owner of the port. While the owner keeps commanding the port, commands with a lower priority are
+ * dropped before they reach the SDK, so an autonomous routine and a driver assist feature moving the same motor don't
+ * take turns overwriting each other. Ownership lapses once the owner hasn't commanded the port for the ownership
+ * timeout, or when it releases the port. Commands with priority 0, the default, never take ownership, so motors which
+ * aren't arbitrated only pay for a single load.
+ *
+ * The dispatcher doesn't have a task. Register flush with a ControlScheduler, which runs it at an exact period, after
+ * the control loops which submit commands. Motors which are commanded through the dispatcher shouldn't also be moved
+ * directly, as a direct command is overridden at the next flush if a command is pending.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::Motor intake(1, 600_rpm);
+ * lemlib::ControlScheduler scheduler;
+ *
+ * void initialize() {
+ *     scheduler.add([] { lemlib::CommandDispatcher::get().submit(intake.prepareMove(0.8)); }, 10_msec);
+ *     scheduler.add([] { lemlib::CommandDispatcher::get().flush(); }, 10_msec);
+ *     scheduler.start();
+ * }
+ *
+ * void jamDetected() {
+ *     // overrides the intake loop until the next flush
+ *     lemlib::CommandDispatcher::get().submit(intake.prepareBrake(), 1);
+ * }
+ *
+ * void autonomous() {
+ *     // the driver assist loop, which moves the drive with priority 0, is ignored until the routine is done
+ *     leftMotors.setCommandPriority(2);
+ *     rightMotors.setCommandPriority(2);
+ *     runRoutine();
+ *     leftMotors.releaseCommands();
+ *     rightMotors.releaseCommands();
+ * }
+ * @endcode
+ */
+class CommandDispatcher {
+    public:
+        CommandDispatcher(const CommandDispatcher& other) = delete;
+        CommandDispatcher& operator=(const CommandDispatcher& other) = delete;
+        /**
+         * @brief Get the dispatcher
+         *
+         * The dispatcher is constructed the first time this function is called, so it can be used by devices which
+         * are globals
+         *
+         * @return CommandDispatcher& the dispatcher
+         */
+        static CommandDispatcher& get();
+        /**
+         * @brief Submit a command, to be sent at the next flush
+         *
+         * This function does not lock, and can be called from any task. The command cache of the motor which prepared
+         * the command isn't used, as the dispatcher skips repeated commands itself. The command is submitted with the
+         * higher of the priority passed here and the command priority of the motor which prepared it.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the command could not be prepared, or its value doesn't fit in 16 bits
+         * EBUSY: a command with a higher priority is already pending for the port, or a source with a higher priority
+         * owns it
+         *
+         * @param command the command, prepared by a motor
+         * @param priority the priority of the command. Defaults to 0, the lowest
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t submit(const MotorCommand& command, uint8_t priority = 0);
+        /**
+         * @brief Send the pending command of every port
+         *
+         * Call this periodically, like from a ControlScheduler. Only one task may flush the dispatcher. A command whose
+         * port was claimed by a source with a higher priority since it was submitted is dropped.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: a motor could not be commanded. The other commands are still sent
+         *
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t flush();
+        /**
+         * @brief Set how long a command which was sent is trusted to still be followed by the motor
+         *
+         * @param period the refresh period, rounded to whole milliseconds. Defaults to 100 ms, like the command cache
+         * of a motor. 0 sends every command
+         */
+        void setRefreshPeriod(Time period);
+        /**
+         * @brief Claim a port for a source, before sending it a command
+         *
+         * Motors call this for every command they send, and the dispatcher for every command it submits or flushes.
+         * The claim succeeds unless a source with a higher priority owns the port and commanded it less than the
+         * ownership timeout ago. A successful claim with a priority above 0 makes the source the owner. This function
+         * does not lock, and can be called from any task.
+         *
+         * @param port the port of the motor, negative if it is reversed
+         * @param priority the command priority of the source
+         * @return true the command may be sent
+         * @return false the command has to be dropped. It is counted by getDropped
+         */
+        bool claim(int8_t port, uint8_t priority);
+        /**
+         * @brief Release a port, if it is owned by a source with a priority
+         *
+         * Sources with a lower priority can command the port straight away, instead of after the ownership timeout.
+         *
+         * @param port the port of the motor, negative if it is reversed
+         * @param priority the priority the port was claimed with
+         */
+        void release(int8_t port, uint8_t priority);
+        /**
+         * @brief Set how long a source owns a port after it last commanded it
+         *
+         * @param timeout the timeout, rounded to whole milliseconds. Defaults to 50 ms, a few periods of a control
+         * loop, so a loop which is a little late doesn't lose the port
+         */
+        void setOwnershipTimeout(Time timeout);
+        /**
+         * @brief Get the number of commands sent to motors
+         *
+         * @return uint32_t the number of commands. Wraps around on overflow
+         */
+        uint32_t getSent() const;
+        /**
+         * @brief Get the number of commands which weren't sent, as they were replaced before a flush, or repeated the
+         * command the motor was already following
+         *
+         * @return uint32_t the number of commands. Wraps around on overflow
+         */
+        uint32_t getSkipped() const;
+        /**
+         * @brief Get the number of commands which were dropped, as a source with a higher priority owned their port
+         *
+         * @return uint32_t the number of commands. Wraps around on overflow
+         */
+        uint32_t getDropped() const;
+    private:
+        CommandDispatcher() = default;
+
+        std::atomic<uint32_t> m_refreshPeriod = 100;
+        std::atomic<uint32_t> m_ownershipTimeout = 50;
+        std::atomic<uint32_t> m_dropped = 0;
+        std::atomic<uint32_t> m_sent = 0;
+        std::atomic<uint32_t> m_skipped = 0;
+};
+} // namespace lemlib
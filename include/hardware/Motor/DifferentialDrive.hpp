@@ -0,0 +1,198 @@
+#pragma once
+
+#include "hardware/Motor/MotorGroup.hpp"
+#include "hardware/Port.hpp"
+#include <initializer_list>
+
+namespace lemlib {
+/**
+ * @brief The power of each side of a differential drive, from -1.0 to +1.0
+ */
+struct DrivePowers {
+        Number left;
+        Number right;
+};
+
+/**
+ * @brief The linear velocity of the wheels on each side of a differential drive
+ */
+struct DriveVelocities {
+        LinearVelocity left;
+        LinearVelocity right;
+};
+
+/**
+ * @brief A differential drive, with a motor group on each side
+ *
+ * Commands are sent to both sides in a single pass: the ports are checked against one snapshot, the command of every
+ * motor on both sides is prepared, and only then are all of them sent. So both sides, and every motor on each side,
+ * get their commands back to back, which keeps the robot from yawing when it accelerates hard.
+ *
+ * Like lemlib::MotorGroup, commands succeed as long as one motor works, and errno is set to whatever error happened
+ * last.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::DifferentialDrive drive({1, -2, 3}, {-4, 5, -6}, 450_rpm);
+ * pros::Controller controller(pros::E_CONTROLLER_MASTER);
+ *
+ * void opcontrol() {
+ *     while (true) {
+ *         const double throttle = controller.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_Y) / 127.0;
+ *         const double turn = controller.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_X) / 127.0;
+ *         drive.arcade(throttle, turn);
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class DifferentialDrive {
+    public:
+        /**
+         * @brief Construct a new Differential Drive
+         *
+         * @param leftPorts the ports of the motors on the left side
+         * @param rightPorts the ports of the motors on the right side
+         * @param outputVelocity the theoretical maximum output velocity of each side, after gearing
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::DifferentialDrive drive({1, -2, 3}, {-4, 5, -6}, 450_rpm);
+         * }
+         * @endcode
+         */
+        DifferentialDrive(const std::initializer_list<ReversibleSmartPort>& leftPorts,
+                          const std::initializer_list<ReversibleSmartPort>& rightPorts,
+                          AngularVelocity outputVelocity);
+        /**
+         * @brief Get the motor group on the left side
+         *
+         * The group can be used to configure the side, or as an encoder for odometry
+         *
+         * @return MotorGroup& the left motor group
+         */
+        MotorGroup& getLeft();
+        /**
+         * @brief Get the motor group on the right side
+         *
+         * @return MotorGroup& the right motor group
+         */
+        MotorGroup& getRight();
+        /**
+         * @brief move each side at a percent power from -1.0 to +1.0
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @param left the power of the left side
+         * @param right the power of the right side
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t move(Number left, Number right);
+        /**
+         * @brief move each side at a percent power from -1.0 to +1.0
+         *
+         * @param powers the power of each side
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t move(DrivePowers powers);
+        /**
+         * @brief move each side at an angular velocity
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @param left the target velocity of the left side
+         * @param right the target velocity of the right side
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t moveVelocity(AngularVelocity left, AngularVelocity right);
+        /**
+         * @brief move the wheels on each side at a linear velocity
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @param velocities the target velocity of the wheels on each side, like ones from a RamseteController
+         * @param wheelDiameter the diameter of the wheels, which turn at the output velocity of the motors
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t moveVelocity(DriveVelocities velocities, Length wheelDiameter);
+        /**
+         * @brief drive with arcade controls
+         *
+         * @param throttle the forward power, from -1.0 to +1.0
+         * @param turn the turning power, from -1.0 to +1.0. Positive turns clockwise
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t arcade(Number throttle, Number turn);
+        /**
+         * @brief drive with curvature controls
+         *
+         * @param throttle the forward power, from -1.0 to +1.0
+         * @param curvature how sharply to turn, from -1.0 to +1.0. Positive turns clockwise
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t curvature(Number throttle, Number curvature);
+        /**
+         * @brief brake both sides
+         *
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t brake();
+        /**
+         * @brief Mix arcade controls into the power of each side
+         *
+         * The turn is added to the left side and taken from the right. If either side would be past full power, both
+         * are scaled down by the same amount, so the robot still turns at the requested ratio.
+         *
+         * @param throttle the forward power, from -1.0 to +1.0
+         * @param turn the turning power, from -1.0 to +1.0. Positive turns clockwise
+         * @return DrivePowers the power of each side
+         *
+         * @b Example:
+         * @code {.cpp}
+         * // full throttle and full turn saturates, so the right side stops
+         * const lemlib::DrivePowers powers = lemlib::DifferentialDrive::arcadeMix(1, 1);
+         * // powers.left == 1, powers.right == 0
+         * @endcode
+         */
+        static DrivePowers arcadeMix(Number throttle, Number turn);
+        /**
+         * @brief Mix curvature controls into the power of each side
+         *
+         * The turn is scaled by the magnitude of the throttle, so the radius of the turn stays the same at any speed.
+         * The robot does not turn when the throttle is 0.
+         *
+         * @param throttle the forward power, from -1.0 to +1.0
+         * @param curvature how sharply to turn, from -1.0 to +1.0. Positive turns clockwise
+         * @return DrivePowers the power of each side
+         */
+        static DrivePowers curvatureMix(Number throttle, Number curvature);
+    private:
+        /**
+         * @brief Send a command to every connected motor on both sides at once
+         *
+         * @param prepareLeft called with every connected motor on the left side, returning its command
+         * @param prepareRight called with every connected motor on the right side, returning its command
+         * @return 0 at least one motor got its command
+         * @return INT_MAX error occurred, setting errno
+         */
+        template <typename PrepareLeft, typename PrepareRight>
+        int32_t dispatch(PrepareLeft prepareLeft, PrepareRight prepareRight);
+
+        MotorGroup m_left;
+        MotorGroup m_right;
+};
+} // namespace lemlib
@@ -0,0 +1,255 @@
+#pragma once
+
+#include "hardware/DoubleBuffer.hpp"
+#include "hardware/Encoder/EncoderHistory.hpp"
+#include "hardware/Motor/Motor.hpp"
+#include "hardware/Motor/MotorGroup.hpp"
+#include "units/Angle.hpp"
+#include "pros/rtos.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief The settings of a FlywheelController
+ *
+ * The output is a percent power from -1.0 to +1.0. Velocities are measured in rpm, after gearing, so a kV of 1 / 3600
+ * gives full power at 3600 rpm.
+ */
+struct FlywheelSettings {
+        /** the power needed to overcome friction, added in the direction of the target velocity */
+        double kS = 0;
+        /** the power per rpm of target velocity */
+        double kV = 0;
+        /** the power per rpm second of accumulated velocity error, the gain of take back half */
+        double kTBH = 0;
+        /**
+         * the velocity error above which the flywheel recovers at full power, like after a shot or while spinning up.
+         * The controller takes over with take back half once the error falls below it
+         */
+        AngularVelocity recoveryThreshold = 150_rpm;
+        /** the velocity error within which the flywheel is ready to shoot */
+        AngularVelocity readyTolerance = 50_rpm;
+        /**
+         * the number of new samples the velocity is fit over, from 2 to FlywheelController::MAX_SAMPLES. More samples
+         * smooth the velocity more, but notice a shot later
+         */
+        size_t velocitySamples = 4;
+};
+
+/**
+ * @brief The state of a FlywheelController, as of its latest update
+ */
+struct FlywheelState {
+        /** the target velocity */
+        AngularVelocity target = 0_rpm;
+        /** the velocity, fit to the latest samples of the encoder */
+        AngularVelocity velocity = 0_rpm;
+        /** the power sent to the motors */
+        double output = 0;
+        /** whether the flywheel is recovering at full power */
+        bool recovering = false;
+        /** whether the flywheel is within readyTolerance of the target, and not recovering */
+        bool ready = false;
+        /**
+         * the number of times the flywheel fell more than recoveryThreshold below the target, like after a shot or when
+         * it spins up
+         */
+        uint32_t recoveries = 0;
+        /** how long the latest recovery took, from when it started to when the flywheel was ready again */
+        Time lastRecovery = 0_sec;
+};
+
+/**
+ * @brief A velocity controller for a flywheel, which recovers from shots as fast as the motors allow
+ *
+ * The internal velocity controller of the motors, and a PID tuned to hold a velocity, take a long time to recover
+ * the speed a flywheel loses on every shot. This controller has two modes:
+ *
+ * - when the flywheel is more than recoveryThreshold below its target, like after a shot, it runs at full power
+ *   (bang-bang), which is the fastest way back
+ * - near the target, it holds the velocity with take back half: the output integrates the error, and every time the
+ *   error changes sign the output jumps to halfway between itself and the output at the previous crossing. The output
+ *   starts from the kS/kV feedforward of the target, so it barely oscillates
+ *
+ * The velocity comes from the timestamped samples of the encoder of the motors, fit with a line over the latest
+ * velocitySamples samples. The motors measure their position every 10 ms, and each sample is placed at the time the
+ * motor measured it, so the fit isn't thrown off by the jitter of the task which reads it, and the velocity is more
+ * recent than the one the motors filter internally.
+ *
+ * update should be called by a ControlScheduler at 200 Hz or faster, so a new sample is used as soon as the motors
+ * report it. Samples which were already used are skipped. The controller has a fixed size, and never allocates memory.
+ * The target and the settings can be changed from any task.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::MotorGroup flywheel({1, -2}, 3600_rpm);
+ * lemlib::FlywheelController controller(flywheel, {.kS = 0.02, .kV = 1.0 / 3600, .kTBH = 0.00002});
+ * lemlib::ControlScheduler scheduler;
+ *
+ * void initialize() {
+ *     scheduler.add([] { controller.update(); }, 5_msec, lemlib::CallbackPriority::CRITICAL);
+ *     scheduler.start();
+ *     controller.setTarget(3000_rpm);
+ * }
+ *
+ * void opcontrol() {
+ *     while (true) {
+ *         if (controller.isReady()) indexer.move(1);
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class FlywheelController {
+    public:
+        /** the most samples the velocity can be fit over */
+        static constexpr size_t MAX_SAMPLES = 16;
+        /**
+         * @brief Construct a new Flywheel Controller for a motor
+         *
+         * The controller does not move the motor until it is updated with a target
+         *
+         * @param motor the motor to control. It must outlive the controller
+         * @param settings the settings of the controller
+         */
+        FlywheelController(Motor& motor, FlywheelSettings settings);
+        /**
+         * @brief Construct a new Flywheel Controller for a motor group
+         *
+         * @param motors the motor group to control. It must outlive the controller
+         * @param settings the settings of the controller
+         */
+        FlywheelController(MotorGroup& motors, FlywheelSettings settings);
+        FlywheelController(const FlywheelController& other) = delete;
+        FlywheelController& operator=(const FlywheelController& other) = delete;
+        /**
+         * @brief Set the target velocity of the flywheel
+         *
+         * This function can be called from any task. The next update starts holding the new target from its
+         * feedforward, or recovers to it at full power if it is far away. A target of 0 stops the motors.
+         *
+         * @param velocity the target velocity
+         * @return int32_t always returns 0
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     // slow down for a shot from close to the goal
+         *     controller.setTarget(2400_rpm);
+         * }
+         * @endcode
+         */
+        int32_t setTarget(AngularVelocity velocity);
+        /**
+         * @brief Get the target velocity of the flywheel
+         *
+         * @return AngularVelocity the target velocity
+         */
+        AngularVelocity getTarget() const;
+        /**
+         * @brief Set the settings of the controller
+         *
+         * The take back half state starts over from the feedforward, as it was accumulated with the old settings. The
+         * number of velocity samples is clamped from 2 to MAX_SAMPLES.
+         *
+         * @param settings the settings
+         * @return int32_t always returns 0
+         */
+        int32_t setSettings(FlywheelSettings settings);
+        /**
+         * @brief Get the settings of the controller
+         *
+         * @return FlywheelSettings the settings
+         */
+        FlywheelSettings getSettings() const;
+        /**
+         * @brief Get the state of the controller, as of its latest update
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * @return FlywheelState the state
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     const lemlib::FlywheelState state = controller.getState();
+         *     std::cout << to_rpm(state.velocity) << " rpm, recovered in " << to_msec(state.lastRecovery) << " ms"
+         *               << std::endl;
+         * }
+         * @endcode
+         */
+        FlywheelState getState() const;
+        /**
+         * @brief Get whether the flywheel is at its target velocity, and ready to shoot
+         *
+         * @return true the flywheel is within readyTolerance of a target which isn't 0, and not recovering
+         * @return false the flywheel is not ready
+         */
+        bool isReady() const;
+        /**
+         * @brief Update the controller once
+         *
+         * This must not be called from more than one task at once.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the motors could not be read or moved
+         *
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno. The velocity fit starts over once the motors can be read again
+         */
+        int32_t update();
+    private:
+        /**
+         * @brief Move the target of the controller at a percent power
+         *
+         * @tparam T the type of the target
+         * @param target the target
+         * @param power the power
+         * @return int32_t the result of move
+         */
+        template <typename T> static int32_t moveTarget(Encoder& target, Number power);
+        /**
+         * @brief Get a timestamped sample of the target of the controller
+         *
+         * @tparam T the type of the target
+         * @param target the target
+         * @return EncoderSample the sample
+         */
+        template <typename T> static EncoderSample sampleTarget(const Encoder& target);
+        /**
+         * @brief Fit a line to the latest samples
+         *
+         * @param count the number of samples to fit
+         * @return double the slope of the line, in rpm, or 0 if there are fewer than 2 samples
+         */
+        double fitVelocity(size_t count) const;
+
+        Encoder& m_target;
+        int32_t (*const m_move)(Encoder&, Number);
+        EncoderSample (*const m_sample)(const Encoder&);
+        // the settings and the target are written by any task, and read by update without locking
+        DoubleBuffer<FlywheelSettings> m_settings;
+        DoubleBuffer<AngularVelocity> m_targetVelocity;
+        DoubleBuffer<FlywheelState> m_state;
+        pros::Mutex m_mutex;
+        std::atomic<bool> m_reseed = true;
+        // the latest samples, in seconds and degrees, as a ring which is only touched by update
+        std::array<double, MAX_SAMPLES> m_times {};
+        std::array<double, MAX_SAMPLES> m_angles {};
+        size_t m_newest = 0;
+        size_t m_samples = 0;
+        // the state of take back half, in the direction of the target, which is only touched by update
+        double m_output = 0;
+        double m_takeBack = 0;
+        double m_lastError = 0;
+        double m_lastTarget = 0;
+        uint64_t m_lastUpdate = 0;
+        // when the current recovery started, until the flywheel is ready again
+        bool m_timingRecovery = false;
+        uint64_t m_recoveryStart = 0;
+};
+} // namespace lemlib
@@ -0,0 +1,196 @@
+#pragma once
+
+#include "hardware/Motor/MotorGroup.hpp"
+#include "hardware/Port.hpp"
+#include "units/Vector2D.hpp"
+#include <array>
+#include <initializer_list>
+
+namespace lemlib {
+/**
+ * @brief How the wheels of a holonomic drive are mounted
+ */
+enum class HolonomicLayout {
+    /** mecanum wheels, facing forwards, with their rollers at 45 degrees */
+    MECANUM,
+    /** omni wheels at the corners, each turned 45 degrees towards the center */
+    X_DRIVE
+};
+
+/**
+ * @brief The size and layout of a holonomic drive
+ */
+struct HolonomicGeometry {
+        /** how the wheels are mounted */
+        HolonomicLayout layout;
+        /** the distance between the centers of the left and right wheels */
+        Length trackWidth;
+        /** the distance between the centers of the front and back wheels */
+        Length wheelBase;
+        /** the diameter of the wheels */
+        Length wheelDiameter;
+};
+
+/**
+ * @brief The velocity of every wheel of a holonomic drive
+ *
+ * Positive velocities move the robot forwards.
+ */
+struct HolonomicVelocities {
+        LinearVelocity frontLeft;
+        LinearVelocity frontRight;
+        LinearVelocity backLeft;
+        LinearVelocity backRight;
+};
+
+/**
+ * @brief A holonomic drive, like a mecanum drive or an X-drive, with a motor group on each wheel
+ *
+ * The velocity of the robot is turned into the velocity of every wheel with one 4x3 matrix, whose rows are the
+ * contribution of the forward, sideways and angular velocity to each wheel. The matrix is calculated once, when the
+ * drive is constructed, so a command is 12 multiplications, which the compiler vectorizes.
+ *
+ * Like lemlib::DifferentialDrive, commands are sent to all four groups in a single pass: the ports are checked against
+ * one snapshot, the command of every motor is prepared, and only then are all of them sent. As long as one motor works,
+ * commands succeed, and errno is set to whatever error happened last.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::HolonomicDrive drive({1, -2}, {-3, 4}, {5, -6}, {-7, 8}, 600_rpm,
+ *                              {.layout = lemlib::HolonomicLayout::X_DRIVE,
+ *                               .trackWidth = 12_in,
+ *                               .wheelBase = 12_in,
+ *                               .wheelDiameter = 3.25_in});
+ *
+ * void autonomous() {
+ *     // strafe left while turning counterclockwise
+ *     drive.moveVelocity({0_inps, 30_inps}, 1_radps);
+ * }
+ * @endcode
+ */
+class HolonomicDrive {
+    public:
+        /**
+         * @brief Construct a new Holonomic Drive
+         *
+         * @param frontLeftPorts the ports of the motors on the front left wheel
+         * @param frontRightPorts the ports of the motors on the front right wheel
+         * @param backLeftPorts the ports of the motors on the back left wheel
+         * @param backRightPorts the ports of the motors on the back right wheel
+         * @param outputVelocity the theoretical maximum output velocity of each wheel, after gearing
+         * @param geometry the size and layout of the drive
+         */
+        HolonomicDrive(const std::initializer_list<ReversibleSmartPort>& frontLeftPorts,
+                       const std::initializer_list<ReversibleSmartPort>& frontRightPorts,
+                       const std::initializer_list<ReversibleSmartPort>& backLeftPorts,
+                       const std::initializer_list<ReversibleSmartPort>& backRightPorts,
+                       AngularVelocity outputVelocity, HolonomicGeometry geometry);
+        /**
+         * @brief Get the motor group on the front left wheel
+         *
+         * @return MotorGroup& the motor group
+         */
+        MotorGroup& getFrontLeft();
+        /**
+         * @brief Get the motor group on the front right wheel
+         *
+         * @return MotorGroup& the motor group
+         */
+        MotorGroup& getFrontRight();
+        /**
+         * @brief Get the motor group on the back left wheel
+         *
+         * @return MotorGroup& the motor group
+         */
+        MotorGroup& getBackLeft();
+        /**
+         * @brief Get the motor group on the back right wheel
+         *
+         * @return MotorGroup& the motor group
+         */
+        MotorGroup& getBackRight();
+        /**
+         * @brief Find the velocity of every wheel which moves the robot at a velocity
+         *
+         * If a wheel would be faster than the maximum velocity of the wheels, every wheel is slowed down by the same
+         * amount, so the robot still moves in the requested direction, and turns at the requested ratio.
+         *
+         * @param velocity the velocity of the robot, relative to the robot. x is forwards and y is to the left
+         * @param angularVelocity the angular velocity of the robot, positive counterclockwise
+         * @return HolonomicVelocities the velocity of every wheel
+         */
+        HolonomicVelocities inverseKinematics(units::V2Velocity velocity, AngularVelocity angularVelocity) const;
+        /**
+         * @brief move the robot at a velocity
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @param velocity the velocity of the robot, relative to the robot. x is forwards and y is to the left
+         * @param angularVelocity the angular velocity of the robot, positive counterclockwise
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t moveVelocity(units::V2Velocity velocity, AngularVelocity angularVelocity);
+        /**
+         * @brief move every wheel at a velocity
+         *
+         * @param velocities the velocity of every wheel
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t moveVelocity(HolonomicVelocities velocities);
+        /**
+         * @brief drive with percent powers, like from a controller
+         *
+         * The powers are mixed with the same matrix as velocities, and desaturated the same way.
+         *
+         * @param forward the forward power, from -1.0 to +1.0
+         * @param strafe the power to the left, from -1.0 to +1.0
+         * @param turn the counterclockwise turning power, from -1.0 to +1.0
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t move(Number forward, Number strafe, Number turn);
+        /**
+         * @brief brake every wheel
+         *
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t brake();
+    private:
+        /** the wheels, in the order of the rows of the matrix */
+        static constexpr size_t WHEELS = 4;
+
+        /**
+         * @brief Multiply the velocity of the robot by the matrix, and desaturate the result
+         *
+         * @param x the forward velocity
+         * @param y the velocity to the left
+         * @param omega the angular velocity, scaled the same way as the linear velocities
+         * @param limit the largest value a wheel can have
+         * @return std::array<double, WHEELS> the value of every wheel
+         */
+        std::array<double, WHEELS> mix(double x, double y, double omega, double limit) const;
+        /**
+         * @brief Send a command to every connected motor on every wheel at once
+         *
+         * @param prepare called with the index of the wheel and every connected motor on it, returning its command
+         * @return 0 at least one motor got its command
+         * @return INT_MAX error occurred, setting errno
+         */
+        template <typename Prepare> int32_t dispatch(Prepare prepare);
+
+        std::array<MotorGroup, WHEELS> m_wheels;
+        // the contribution of the forward velocity, the velocity to the left and the angular velocity to every wheel.
+        // The angular velocity is in radians, times meters, so the rows are unitless
+        std::array<double, WHEELS> m_forward;
+        std::array<double, WHEELS> m_strafe;
+        std::array<double, WHEELS> m_turn;
+        // the maximum velocity of a wheel, in meters per second, and the radius of the wheels, in meters
+        double m_maxVelocity;
+        double m_wheelRadius;
+};
+} // namespace lemlib
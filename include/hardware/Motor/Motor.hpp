@@ -1,16 +1,107 @@
 #pragma once
 
+#include "hardware/DeviceMutex.hpp"
+#include "hardware/DeviceRegistry.hpp"
+#include "hardware/DoubleBuffer.hpp"
+#include "hardware/Encoder/AlphaBetaFilter.hpp"
 #include "hardware/Encoder/Encoder.hpp"
+#include "hardware/Encoder/EncoderHistory.hpp"
+#include "hardware/Encoder/EncoderPosition.hpp"
+#include "hardware/Encoder/TickAccumulator.hpp"
+#include "hardware/Motion/MotionFuture.hpp"
 #include "hardware/Port.hpp"
+#include "hardware/ReadCache.hpp"
+#include "units/Electrical.hpp"
+#include "units/Mechanics.hpp"
 #include "units/Temperature.hpp"
 #include "pros/rtos.hpp"
 #include "pros/motors.hpp"
+#include <atomic>
+#include <climits>
+#include <span>
+#include <vector>
 
 namespace lemlib {
 
 enum class BrakeMode { COAST, BRAKE, HOLD, INVALID };
 
-enum class MotorType { V5, EXP, INVALID };
+enum class MotorType : uint8_t { V5, EXP, INVALID };
+
+/**
+ * @brief A snapshot of the state of a motor
+ *
+ * All the fields are read in a single pass while the motor is locked, so they are consistent with each other. Fields
+ * which could not be read are set to INFINITY, or BrakeMode::INVALID for the brake mode.
+ */
+struct MotorTelemetry {
+        /** the time the snapshot was taken, measured since the program started */
+        Time timestamp = 0_sec;
+        /** the angle of the motor, after gearing */
+        Angle angle = 0_stDeg;
+        /** the velocity of the motor, after gearing */
+        AngularVelocity velocity = 0_rpm;
+        /** the current drawn by the motor */
+        Current current = 0_amp;
+        /** the electrical power drawn by the motor */
+        Power power = 0_watt;
+        /** the torque of the motor, as reported by the motor */
+        Torque torque = 0_Nm;
+        /** the mechanical power out of the motor divided by the electrical power into it, from 0 to 1 */
+        Number efficiency = 0;
+        /** the temperature of the motor */
+        Temperature temperature = 0_celsius;
+        /** the brake mode of the motor */
+        BrakeMode brakeMode = BrakeMode::INVALID;
+        /**
+         * whether the motor group of the motor excludes it from the angle of the group, because its angle diverged
+         * from the other motors. Always false for motors which aren't in a group. See MotorGroup::setOutlierThreshold
+         */
+        bool outlier = false;
+};
+
+/**
+ * @brief The settings of the command cache of a motor
+ *
+ * Control loops often send the same command over and over, like 0 while holding still, or full power while driving.
+ * When the cache is enabled, a command which matches the last command sent to the motor is not sent again, until the
+ * refresh period has passed. This cuts traffic on the smart port bus when there are many motors.
+ */
+struct CommandCacheSettings {
+        /** whether repeated commands are skipped. Disabled by default, so every command is sent */
+        bool enabled = false;
+        /** power commands which differ from the last power command by no more than this are skipped */
+        Number powerTolerance = 0;
+        /** velocity commands which differ from the last velocity command by no more than this are skipped */
+        AngularVelocity velocityTolerance = 0_rpm;
+        /** how long a command can be skipped before it is sent again anyway, in case the motor lost it */
+        Time refreshPeriod = 100_msec;
+};
+
+/**
+ * @brief A raw command for a motor, prepared ahead of time so it can be sent with no other work
+ *
+ * Motor groups prepare the command of every motor first, and then send all of them at once with Motor::sendCommands,
+ * so the motors in a group start moving as close together as possible.
+ */
+struct MotorCommand {
+        /** the kinds of command */
+        enum class Kind : uint8_t { NONE, VOLTAGE, VELOCITY, BRAKE };
+
+        /** the kind of command. NONE if the command could not be prepared */
+        Kind kind = Kind::NONE;
+        /** the port of the motor, negative if it is reversed */
+        int8_t port = 0;
+        /** the raw value sent to PROS, in millivolts for voltage commands or rpm for velocity commands */
+        int32_t value = 0;
+        /** whether the command has to be sent. It doesn't if it was skipped by the command cache */
+        bool send = false;
+        /** the command priority of the motor which prepared the command. See CommandDispatcher::claim */
+        uint8_t priority = 0;
+        /** whether the command was dropped by sendCommands, as a source with a higher priority owns the port */
+        bool dropped = false;
+        /** the result of the command, set once it has been sent */
+        int32_t result = INT_MAX;
+};
 
 class Motor : public Encoder {
     public:
@@ -28,15 +119,65 @@ class Motor : public Encoder {
          * @endcode
          */
         Motor(ReversibleSmartPort port, AngularVelocity outputVelocity);
+        /**
+         * @brief Construct a new Motor object with a known motor type
+         *
+         * Detecting the type of a motor takes multiple round trips to the motor. If the type of the motor is known
+         * ahead of time, it can be passed to this constructor so the motor is never probed.
+         *
+         * @param port the signed port of the motor. Negative if the motor is reversed
+         * @param outputVelocity the maximum theoretical velocity of the motor
+         * @param type the type of the motor
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     // construct a new 5.5W motor on port 1, which powers a mechanism that spins at 200 rpm
+         *     lemlib::Motor motor(1, 200_rpm, lemlib::MotorType::EXP);
+         * }
+         * @endcode
+         */
+        Motor(ReversibleSmartPort port, AngularVelocity outputVelocity, MotorType type);
         /**
          * @brief Motor copy constructor
          *
-         * Because pros::Mutex does not have a copy constructor, an explicit
-         * copy constructor is necessary
+         * Because DeviceMutex does not have a copy constructor, an explicit
+         * copy constructor is necessary. The copy gets its own mutex
          *
          * @param other the Motor to copy
          */
         Motor(const Motor& other);
+        /**
+         * @brief Motor move constructor
+         *
+         * The mutex of the other motor is taken over by this motor, so unlike copying a motor, moving a motor does
+         * not create a new RTOS mutex. The other motor can't be used after it has been moved.
+         *
+         * @param other the Motor to move
+         */
+        Motor(Motor&& other) noexcept;
+        /**
+         * @brief Motor copy assignment operator
+         *
+         * Because DeviceMutex can't be copied, an explicit copy assignment operator is necessary. The mutex of this
+         * motor is kept, and everything else is copied.
+         *
+         * @param other the Motor to copy
+         * @return Motor& this motor
+         */
+        Motor& operator=(const Motor& other);
+        /**
+         * @brief Motor move assignment operator
+         *
+         * The mutex of the other motor is taken over by this motor. The other motor can't be used after it has been
+         * moved.
+         *
+         * @param other the Motor to move
+         * @return Motor& this motor
+         */
+        Motor& operator=(Motor&& other) noexcept;
+        // the simulator only implements the PROS C api, so PROS objects can't be converted
+#ifndef LEMLIB_SIM
         /**
          * @brief Create a new Motor object
          *
@@ -54,12 +195,33 @@ class Motor : public Encoder {
          * @endcode
          */
         static Motor from_pros_motor(const pros::Motor motor, AngularVelocity outputVelocity);
+        /**
+         * @brief Create a Motor object for every pros motor, in one pass
+         *
+         * The vector is reserved once, and only the ports are read from the pros motors, so converting every motor of
+         * a robot at startup doesn't make any SDK calls or reallocate.
+         *
+         * @param motors the pros motors to get the ports from
+         * @param outputVelocity the maximum theoretical velocity of every motor
+         * @return std::vector<Motor> the motors, in the same order
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     const std::array<pros::Motor, 3> prosMotors {pros::Motor(1), pros::Motor(-2), pros::Motor(3)};
+         *     std::vector<lemlib::Motor> motors = lemlib::Motor::from_pros_motors(prosMotors, 200_rpm);
+         * }
+         * @endcode
+         */
+        static std::vector<Motor> from_pros_motors(std::span<const pros::Motor> motors, AngularVelocity outputVelocity);
+#endif
         /**
          * @brief move the motor at a percent power from -1.0 to +1.0
          *
          * This function uses the following values of errno when an error state is reached:
          *
          * ENODEV: the port cannot be configured as a motor
+         * EBUSY: a motor object with a higher command priority owns the port
          *
          * @param percent the power to move the motor at from -1.0 to +1.0
          * @return 0 on success
@@ -85,6 +247,7 @@ class Motor : public Encoder {
          * This function uses the following values of errno when an error state is reached:
          *
          * ENODEV: the port cannot be configured as a motor
+         * EBUSY: a motor object with a higher command priority owns the port
          *
          * @param velocity the target angular velocity to move the motor at
          * @return 0 on success
@@ -112,6 +275,7 @@ class Motor : public Encoder {
          * This function uses the following values of errno when an error state is reached:
          *
          * ENODEV: the port cannot be configured as a motor
+         * EBUSY: a motor object with a higher command priority owns the port
          *
          * @return 0 on success
          * @return INT_MAX on failure, setting errno
@@ -128,6 +292,107 @@ class Motor : public Encoder {
          * @endcode
          */
         int32_t brake();
+        /**
+         * @brief move the motor to an angle, without waiting for it to get there
+         *
+         * The motor follows the motion with its own position controller. The returned future finishes once the angle
+         * of the motor stays within the tolerance for the settle time, which is checked by a DevicePoller the motor is
+         * registered with, or by calling updateMotion. Sending any other command to the motor cancels the motion.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         * EBUSY: a motor object with a higher command priority owns the port
+         *
+         * @param angle the angle to move to, measured the same way as getAngle
+         * @param velocity the maximum velocity of the motion, at the output of the motor
+         * @param settings when the motion counts as finished
+         * @return MotionFuture the future of the motion. Its state is FAILED if the motion could not be started
+         *
+         * @b Example:
+         * @code {.cpp}
+         * lemlib::Motor arm(1, 100_rpm);
+         * lemlib::DevicePoller poller;
+         *
+         * void initialize() {
+         *     poller.addMotor(arm);
+         *     poller.start();
+         * }
+         *
+         * void autonomous() {
+         *     lemlib::MotionFuture raise = arm.moveToAngle(90_stDeg, 50_rpm);
+         *     // drive while the arm is raised, then wait for it
+         *     raise.wait();
+         * }
+         * @endcode
+         */
+        MotionFuture moveToAngle(Angle angle, AngularVelocity velocity, MotionSettings settings = {});
+        /**
+         * @brief Check whether the motion started by moveToAngle has settled
+         *
+         * This is called by a DevicePoller the motor is registered with. The angle is only read while a motion is
+         * pending, so calling it when there is no motion costs a single atomic load.
+         */
+        void updateMotion();
+        /**
+         * @brief Prepare a power command, without sending it
+         *
+         * This does all the work of move, other than sending the command. The command then has to be sent with
+         * sendCommands, and finished with finishCommand.
+         *
+         * @param percent the power to move the motor at from -1.0 to +1.0
+         * @return MotorCommand the command
+         */
+        MotorCommand prepareMove(Number percent);
+        /**
+         * @brief Prepare a velocity command, without sending it
+         *
+         * @param velocity the target angular velocity to move the motor at
+         * @return MotorCommand the command
+         */
+        MotorCommand prepareMoveVelocity(AngularVelocity velocity);
+        /**
+         * @brief Prepare a brake command, without sending it
+         *
+         * @return MotorCommand the command
+         */
+        MotorCommand prepareBrake();
+        /**
+         * @brief Send prepared commands, one after the other
+         *
+         * Every command claims its port from the CommandDispatcher first, and is dropped without calling the SDK if a
+         * source with a higher priority owns the port
+         *
+         * Nothing is done between the commands, so the motors get them as close together as possible
+         *
+         * @param commands the commands to send. Their results are saved in them
+         */
+        static void sendCommands(std::span<MotorCommand> commands);
+        /**
+         * @brief Finish a command prepared by this motor, once it has been sent
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @param command the command
+         * @return 0 the command was sent successfully, or didn't have to be sent
+         * @return INT_MAX error occurred, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     lemlib::Motor left(1, 200_rpm);
+         *     lemlib::Motor right(-2, 200_rpm);
+         *     // the motors get their commands one right after the other
+         *     std::array<lemlib::MotorCommand, 2> commands = {left.prepareMove(0.5), right.prepareMove(0.5)};
+         *     lemlib::Motor::sendCommands(commands);
+         *     left.finishCommand(commands[0]);
+         *     right.finishCommand(commands[1]);
+         * }
+         * @endcode
+         */
+        int32_t finishCommand(const MotorCommand& command);
         /**
          * @brief set the brake mode of the motor
          *
@@ -185,6 +450,9 @@ class Motor : public Encoder {
         /**
          * @brief whether the motor is connected
          *
+         * The connection is read from the latest snapshot of the DeviceRegistry, so this is only a lookup, and can be up
+         * to one scan period old
+         *
          * @return 0 if its not connected
          * @return 1 if it is connected
          *
@@ -231,6 +499,85 @@ class Motor : public Encoder {
          * @endcode
          */
         Angle getAngle() const override;
+        /**
+         * @brief Get the relative angle measured by the motor, or the error which prevented reading it
+         *
+         * The raw ticks are checked as an integer, and errno is only read if the read failed.
+         *
+         * @return Result<Angle> the relative angle, or the error set by the SDK
+         */
+        Result<Angle> tryGetAngle() const override;
+        /**
+         * @brief Get the raw position of the motor, in encoder ticks, and when it was read
+         *
+         * The ticks are the ones getAngle converts, before the output velocity scale and the offset are applied. The
+         * motor counts 50 ticks per rotation of a 3600 rpm motor, and reversed motors count backwards. The reading
+         * goes through the same cache as getAngle, so it can be up to the read cache window old. The timestamp is when
+         * the motor measured the ticks, as reported by the motor, to the millisecond, not when they were read.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @return RawReading the ticks and when they were read. The value is INT_MAX if there is an error, setting
+         * errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     lemlib::Motor motor(1, 200_rpm);
+         *     lemlib::RawReading last = motor.getRaw();
+         *     while (true) {
+         *         const lemlib::RawReading reading = motor.getRaw();
+         *         const int32_t ticks = reading.value - last.value;
+         *         last = reading;
+         *         pros::delay(10);
+         *     }
+         * }
+         * @endcode
+         */
+        RawReading getRaw() const;
+        /**
+         * @brief Get the position of the motor, which is converted to an angle only when it is needed
+         *
+         * The position holds the same reading as getRaw, and the scale and offset getAngle would apply to it.
+         * Subtracting two positions gives the angle the motor moved without converting either of them.
+         *
+         * @return EncoderPosition the position. It is invalid if there is an error, setting errno like getRaw
+         */
+        EncoderPosition getPosition() const;
+        /**
+         * @brief Get the relative angle of the motor, and when the motor measured it
+         *
+         * The motor measures its position about every 10 ms, and reports when it did, so the time between two
+         * samples is the time between the measurements, not between the calls. Derivatives like a velocity calculated
+         * from samples don't pick up the jitter of the task which reads them.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @return EncoderSample the angle, measured like getAngle, and its timestamp, measured since the program
+         * started. The angle is INFINITY and connected is false if there is an error, setting errno. The timestamp is
+         * then the time of the call
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     lemlib::Motor motor(1, 200_rpm);
+         *     lemlib::EncoderSample last = motor.getSample();
+         *     while (true) {
+         *         pros::delay(10);
+         *         const lemlib::EncoderSample sample = motor.getSample();
+         *         if (sample.timestamp > last.timestamp) {
+         *             const AngularVelocity velocity = (sample.angle - last.angle) / (sample.timestamp - last.timestamp);
+         *             last = sample;
+         *         }
+         *     }
+         * }
+         * @endcode
+         */
+        EncoderSample getSample() const;
         /**
          * @brief Set the relative angle of the motor
          *
@@ -288,7 +635,7 @@ class Motor : public Encoder {
          * }
          * @endcode
          */
-        Angle getOffset() const;
+        Angle getOffset() const { return m_config.read().offset; }
         /**
          * @brief Set the offset of the motor encoder
          *
@@ -318,6 +665,9 @@ class Motor : public Encoder {
          *
          * There are 2 motors legal for use: The 11W V5 motor and the 5.5W EXP motor
          *
+         * The type of the motor is only detected the first time this function is called, and then saved. It is
+         * detected again if the motor disconnects, unless the type was passed to the constructor.
+         *
          * This function uses the following values of errno when an error state is reached:
          *
          * ENODEV: the port cannot be configured as a motor
@@ -344,6 +694,20 @@ class Motor : public Encoder {
          * @endcode
          */
         MotorType getType() const;
+        /**
+         * @brief Detect the type and cartridge of the motor, for DeviceRegistry::initializeAll
+         *
+         * Detecting the type takes several SDK calls, which would otherwise be made by the first command sent to the
+         * motor. The motor is ready as soon as this returns.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @return 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t startInitialization() override;
         /**
          * @brief get whether the motor is reversed
          *
@@ -364,7 +728,10 @@ class Motor : public Encoder {
          * }
          * @endcode
          */
-        int32_t isReversed() const;
+        int32_t isReversed() const {
+            // the reversal is stored as the sign of the port, so this can't fail
+            return m_config.read().port < 0;
+        }
         /**
          * @brief set whether the motor should be reversed or not
          *
@@ -396,7 +763,7 @@ class Motor : public Encoder {
          * }
          * @endcode
          */
-        ReversibleSmartPort getPort() const;
+        ReversibleSmartPort getPort() const { return m_config.read().port; }
         /**
          * @brief Get the current limit of the motor
          *
@@ -472,6 +839,32 @@ class Motor : public Encoder {
          * @endcode
          */
         Temperature getTemperature() const;
+        /**
+         * @brief Get the current drawn by the motor
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @return Current the current drawn by the motor
+         * @return INFINITY on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::Motor motor(1, 200_rpm);
+         *
+         *     // output the current draw of the motor to the console
+         *     const Current current = motor.getCurrent();
+         *     if (current.internal() == INFINITY) {
+         *         std::cout << "Error getting motor current" << std::endl;
+         *     } else {
+         *         std::cout << "Motor Current: " << to_amp(current) << std::endl;
+         *     }
+         * }
+         * @endcode
+         */
+        Current getCurrent() const;
         /**
          * @brief set the output velocity of the motor
          *
@@ -503,11 +896,434 @@ class Motor : public Encoder {
          * }
          * @endcode
          */
-        AngularVelocity getOutputVelocity() const;
+        AngularVelocity getOutputVelocity() const { return m_config.read().outputVelocity; }
+        /**
+         * @brief Get the filtered velocity of the motor, after gearing
+         *
+         * The velocity is estimated by an AlphaBetaFilter from the encoder position and the time it was measured by
+         * the motor. Every call adds the latest position to the filter, which only changes when the motor sends a new
+         * reading, so velocity should be read periodically, like once per control loop, and the estimate settles after
+         * a few readings. Unlike the velocity in MotorTelemetry, which is reported by the motor, the filtered velocity
+         * has almost no delay, and its smoothing can be configured with setVelocityFilter.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @return AngularVelocity the velocity of the motor
+         * @return INFINITY on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     lemlib::Motor motor(1, 200_rpm);
+         *     while (true) {
+         *         std::cout << "Velocity: " << to_rpm(motor.getVelocity()) << std::endl;
+         *         pros::delay(10);
+         *     }
+         * }
+         * @endcode
+         */
+        AngularVelocity getVelocity() const;
+        /**
+         * @brief Get the filtered acceleration of the motor, after gearing
+         *
+         * The acceleration is estimated by the same filter as getVelocity, and every call adds the latest position to
+         * it too.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @return AngularAcceleration the acceleration of the motor
+         * @return INFINITY on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     lemlib::Motor motor(1, 200_rpm);
+         *     while (true) {
+         *         std::cout << "Acceleration: " << to_rps2(motor.getAcceleration()) << std::endl;
+         *         pros::delay(10);
+         *     }
+         * }
+         * @endcode
+         */
+        AngularAcceleration getAcceleration() const;
+        /**
+         * @brief Set the gains of the filter used by getVelocity and getAcceleration
+         *
+         * @param gains the gains of the filter
+         * @return int32_t always returns 0
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::Motor motor(1, 200_rpm);
+         *     // smoother, but slower to respond
+         *     motor.setVelocityFilter(lemlib::AlphaBetaGains::criticallyDamped(0.85));
+         * }
+         * @endcode
+         */
+        int32_t setVelocityFilter(AlphaBetaGains gains);
+        /**
+         * @brief Get the gains of the filter used by getVelocity and getAcceleration
+         *
+         * @return AlphaBetaGains the gains of the filter
+         */
+        AlphaBetaGains getVelocityFilter() const;
+        /**
+         * @brief Set the command cache of the motor, which skips commands that match the last command sent
+         *
+         * move, moveVelocity and brake are checked against the last command sent to the port by any motor object, as
+         * every object on a port, like copies of the motor and the motors of a group, shares one cache. Commands sent
+         * straight through PROS are not seen by the cache. The cache is cleared when the motor disconnects, when any
+         * object on the port is reversed, and when these settings are set, so the next command is always sent.
+         *
+         * @param settings the settings of the cache
+         * @return int32_t always returns 0
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::Motor motor(1, 200_rpm);
+         *     // skip power commands within 1% of the last one, and send them again every 50 ms
+         *     motor.setCommandCache({.enabled = true, .powerTolerance = 0.01, .refreshPeriod = 50_msec});
+         * }
+         * @endcode
+         */
+        int32_t setCommandCache(CommandCacheSettings settings);
+        /**
+         * @brief Get the settings of the command cache of the motor
+         *
+         * The tolerances and the refresh period are stored as floats, so they may differ from the values which were
+         * set in their 8th significant digit
+         *
+         * @return CommandCacheSettings the settings
+         */
+        CommandCacheSettings getCommandCache() const;
+        /**
+         * @brief Set the priority of the commands sent by this motor object
+         *
+         * Objects on the same port share it. While an object with a higher priority keeps commanding the port, move,
+         * moveVelocity, brake and moveToAngle of objects with a lower priority are dropped before they reach the SDK,
+         * and fail with EBUSY. See CommandDispatcher
+         *
+         * @param priority the priority. Defaults to 0, which never owns the port
+         * @return int32_t always returns 0
+         *
+         * @b Example:
+         * @code {.cpp}
+         * lemlib::Motor intake(1, 600_rpm);
+         * // a copy for the jam clearing routine, which overrides the driver while it runs
+         * lemlib::Motor jamClearer = intake;
+         *
+         * void initialize() {
+         *     jamClearer.setCommandPriority(1);
+         * }
+         * @endcode
+         */
+        int32_t setCommandPriority(uint8_t priority);
+        /**
+         * @brief Get the priority of the commands sent by this motor object
+         *
+         * @return uint8_t the priority
+         */
+        uint8_t getCommandPriority() const;
+        /**
+         * @brief Release the port, if this motor object owns it with its priority
+         *
+         * Objects with a lower priority can command the port straight away, instead of after the ownership timeout of
+         * the CommandDispatcher
+         *
+         * @return int32_t always returns 0
+         */
+        int32_t releaseCommands();
+        /**
+         * @brief Set how long getAngle reuses the last position read from the motor
+         *
+         * The motor only measures its position about every 10 ms, so reading it more often returns the same value.
+         * With a window, getAngle only reads the motor if the last reading is older than the window, so several
+         * subsystems can read the angle in the same cycle for the cost of one read. The cache is discarded when the
+         * motor disconnects or is reversed.
+         *
+         * @param window how old a reading can be and still be used. 0 disables the cache, which is the default
+         * @return int32_t always returns 0
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::Motor motor(1, 200_rpm);
+         *     // the motor updates every 10 ms, so a reading is at most one update old
+         *     motor.setReadCacheWindow(10_msec);
+         * }
+         * @endcode
+         */
+        int32_t setReadCacheWindow(Time window);
+        /**
+         * @brief Get how long getAngle reuses the last position read from the motor
+         *
+         * @return Time the window. 0 if the cache is disabled
+         */
+        Time getReadCacheWindow() const;
+        /**
+         * @brief Set the battery voltage power commands are compensated for
+         *
+         * move maps full power to the highest voltage the motor accepts, but the power the motor actually gets drops
+         * as the battery sags, so feedforward gains which were tuned on a full battery stop matching. With
+         * compensation, move scales every command by the nominal voltage divided by the voltage of the battery, so a
+         * given power gets the same effective voltage for as long as the battery stays above the nominal voltage.
+         * Commands are capped at the highest voltage the motor accepts.
+         *
+         * The battery voltage is shared by every motor, and read at most once per update period of the Battery, so
+         * compensating many motors costs a single read of the battery. If the battery can't be read, commands are
+         * sent uncompensated. Compensation is disabled by default.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the nominal voltage is negative or infinite
+         *
+         * @param nominal the battery voltage the gains of the program were tuned at, or 0 volts to disable
+         * compensation
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::Motor motor(1, 200_rpm);
+         *     // half power always gets 6 volts, as long as the battery is above 12 volts
+         *     motor.setVoltageCompensation(12_volt);
+         *     motor.move(0.5);
+         * }
+         * @endcode
+         */
+        int32_t setVoltageCompensation(Voltage nominal);
+        /**
+         * @brief Get the battery voltage power commands are compensated for
+         *
+         * @return Voltage the nominal voltage, or 0 volts if compensation is disabled
+         */
+        Voltage getVoltageCompensation() const;
+        /**
+         * @brief Get the angle, velocity, current draw, power, torque, efficiency, temperature and brake mode of the motor
+         * at once
+         *
+         * Calling the individual getters reads the values at different times. This function locks the motor once and
+         * reads every value in a single pass, which is cheaper when multiple values are needed and guarantees they
+         * belong to the same moment in time.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @return MotorTelemetry the state of the motor. Values which could not be read are set to INFINITY
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::Motor motor(1, 200_rpm);
+         *     // read the state of the motor
+         *     const lemlib::MotorTelemetry telemetry = motor.getTelemetry();
+         *     std::cout << "Angle: " << telemetry.angle << std::endl;
+         *     std::cout << "Velocity: " << telemetry.velocity << std::endl;
+         * }
+         * @endcode
+         */
+        MotorTelemetry getTelemetry() const;
     private:
-        mutable pros::Mutex m_mutex;
-        AngularVelocity m_outputVelocity;
-        Angle m_offset = 0_stDeg;
-        ReversibleSmartPort m_port;
+        // motor groups lock their own mutex, and then use the unlocked paths below on the motors they own
+        friend class MotorGroup;
+        friend class DifferentialDrive;
+        friend class HolonomicDrive;
+        template <std::int64_t... Ports> friend class StaticMotorGroup;
+
+        /**
+         * @name Unlocked paths
+         *
+         * Each public function which locks the mutex does so once, and then calls its unlocked path. A motor owned by
+         * a motor group is only ever used while the mutex of the group is locked, so the group calls the unlocked
+         * paths directly, and each call to the group takes a single lock. The mutex of the motor, or of the group
+         * which owns it, has to be locked before any of these functions is called
+         */
+        ///@{
+        MotionFuture moveToAngleImpl(Angle angle, AngularVelocity velocity, MotionSettings settings);
+        MotorCommand prepareMoveImpl(Number percent);
+        MotorCommand prepareMoveVelocityImpl(AngularVelocity velocity);
+        MotorCommand prepareBrakeImpl();
+        int32_t finishCommandImpl(const MotorCommand& command);
+        int32_t isConnectedImpl() const;
+        int32_t setAngleImpl(Angle angle);
+        MotorType getTypeImpl() const;
+        int32_t setOutputVelocityImpl(AngularVelocity outputVelocity);
+        AngularVelocity getVelocityImpl() const;
+        AngularAcceleration getAccelerationImpl() const;
+        int32_t setVelocityFilterImpl(AlphaBetaGains gains);
+        int32_t setCommandCacheImpl(CommandCacheSettings settings);
+        /**
+         * @brief Get the settings of the command cache, without locking the mutex
+         *
+         * @return CommandCacheSettings the settings
+         */
+        CommandCacheSettings getCommandCacheImpl() const;
+        MotorTelemetry getTelemetryImpl() const;
+        ///@}
+
+        /**
+         * @brief Discard the saved motor type, cartridge, brake mode, last command and reading of the port
+         *
+         * This function is called when the motor disconnects, as it could be replaced with a different motor, or the
+         * cartridge could be changed, before it reconnects. It discards the state shared by every object on the port
+         */
+        void invalidateCache() const;
+        /**
+         * @brief Get the cartridge of the motor, which is read once and shared by every object on the port
+         *
+         * @param port the port of the motor
+         * @return AngularVelocity the cartridge, or 0 rpm if it could not be read
+         */
+        AngularVelocity getCartridge(ReversibleSmartPort port) const;
+        /**
+         * @brief Add the latest encoder position to the velocity filter
+         *
+         * Positions are filtered before the offset is added, so setting the angle doesn't look like the motor moved.
+         * The mutex has to be locked before this function is called
+         *
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t updateVelocityFilter() const;
+        /**
+         * @brief Read the raw encoder position, which may come from the read cache
+         *
+         * This function does not lock, so motor groups can read every motor back to back
+         *
+         * @return int32_t the raw position in ticks, or INT_MAX on failure, setting errno
+         */
+        int32_t readTicks() const;
+        /**
+         * @brief Read the raw encoder position from the motor, without the read cache
+         *
+         * This function does not lock, so motor groups can read every motor back to back
+         *
+         * @return int32_t the raw position in ticks, or INT_MAX on failure, setting errno
+         */
+        int32_t readTicksUncached() const;
+        /**
+         * @brief Set the offset, so the motor measures an angle at a raw position which was already read
+         *
+         * The mutex has to be locked before this function is called
+         *
+         * @param angle the angle the motor measures at the position
+         * @param ticks the raw position returned by readTicksUncached
+         * @return 0 success
+         * @return INT_MAX the position could not be read
+         */
+        int32_t setAngleAtTicks(Angle angle, int32_t ticks);
+        /**
+         * @brief Convert a raw encoder position to the angle of the mechanism, including the offset
+         *
+         * The position is extended to 64 bits first, so the angle stays correct after the raw position wraps around.
+         *
+         * @param ticks the raw position returned by readTicks
+         * @return Angle the angle, or INFINITY if the position could not be read
+         */
+        Angle ticksToAngle(int32_t ticks) const;
+
+        /** the kinds of command the command cache can skip */
+        using Command = MotorCommand::Kind;
+
+        /**
+         * @brief Check if a command can be skipped, because the last command sent matches it
+         *
+         * The mutex has to be locked before this function is called
+         *
+         * @param command the kind of command
+         * @param value the raw value of the command, as sent to PROS
+         * @param tolerance how far the value can be from the last value sent, in the same units
+         * @return true the command does not have to be sent
+         */
+        bool skipCommand(Command command, int32_t value, int32_t tolerance) const;
+        /**
+         * @brief Save the result of sending a command to the command cache
+         *
+         * The mutex has to be locked before this function is called
+         *
+         * @param command the kind of command
+         * @param value the raw value of the command, as sent to PROS
+         * @param result the result of sending it
+         */
+        void recordCommand(Command command, int32_t value, int32_t result);
+        /**
+         * @brief The settings of the motor which don't depend on the hardware
+         *
+         * They are read far more often than they are changed, so they are published through a lock-free buffer.
+         * Readers never wait for the mutex, and always see a port, output velocity and offset that belong together.
+         * The getters which only read the config are defined in this header, so loops over motors can inline them.
+         */
+        struct Config {
+                ReversibleSmartPort port;
+                AngularVelocity outputVelocity;
+                // converts raw encoder ticks to the angle of the mechanism. It depends on the output velocity, so it is
+                // calculated whenever the output velocity changes
+                units::Scale<Angle> tickScale;
+                Angle offset;
+        };
+
+        /**
+         * @brief Find the scale which converts raw encoder ticks to the angle of the mechanism, without the offset
+         *
+         * @param outputVelocity the output velocity of the motor
+         * @return units::Scale<Angle> the scale, which converts ticks with a single multiply
+         */
+        static units::Scale<Angle> tickScale(AngularVelocity outputVelocity);
+
+        /**
+         * The mutex is leased from the mutex pool, and can be moved. This lets motors be moved, for example when the
+         * vector of motors in a MotorGroup grows, without creating and destroying RTOS mutexes.
+         *
+         * The mutex protects the cached hardware state below, and serializes writes to m_config. Reading m_config
+         * doesn't need it.
+         *
+         * Locks are always taken in the same order: the maintenance registry, then motor groups, then motors. The
+         * mutex of a motor is the innermost lock, and nothing is locked while it is held, so it can never deadlock
+         */
+        mutable DeviceMutex m_mutex;
+        DoubleBuffer<Config> m_config;
+        /**
+         * The state of the port, where the motor type, cartridge, brake mode, last command and latest reading are
+         * cached. It is shared by every object on the port, so caches survive temporary objects, and one object never
+         * skips a command because of a command another object didn't send
+         */
+        PortState* m_state;
+        // the members of a byte or a word are kept next to each other, so a motor doesn't pad them to 8 bytes each
+        // the type passed to the constructor, which is never detected, or MotorType::INVALID to detect it
+        MotorType m_fixedType = MotorType::INVALID;
+        // whether the command cache is enabled. It is read without the mutex, so disabled caches cost nothing
+        std::atomic<bool> m_commandCacheEnabled = false;
+        // the priority commands are sent with, read without the mutex
+        std::atomic<uint8_t> m_commandPriority = 0;
+        // the nominal voltage of battery compensation, in millivolts, or 0 if it is disabled. It is read without the
+        // mutex, so disabled compensation costs nothing
+        std::atomic<int32_t> m_compensationVoltage = 0;
+        /**
+         * The tolerances and refresh period of the command cache, in SI units. They are only compared against, so
+         * floats are precise enough, and take half the space of the CommandCacheSettings they are set from
+         */
+        float m_powerTolerance = 0;
+        float m_velocityTolerance = 0;
+        float m_refreshPeriod = 0.1;
+        // estimates the velocity and acceleration from the position of the motor, without the offset
+        mutable AlphaBetaFilter m_velocityFilter;
+        // the claim of the port in the DeviceRegistry
+        PortClaim m_claim;
+        // the last raw position read by getAngle, kept in the state of the port. It never locks, so getAngle stays
+        // lock-free
+        mutable ReadCache m_readCache;
+        // the raw position extended to 64 bits. Offsets are relative to it, not to the raw position
+        mutable TickAccumulator m_ticks;
+        // the latest motion started by moveToAngle. Copies and moves of the motor start without a motion, as futures
+        // point to the status of the motor which started them
+        MotionStatus m_motion;
 };
 } // namespace lemlib
\ No newline at end of file
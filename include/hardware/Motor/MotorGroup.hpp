@@ -1,13 +1,65 @@
 #pragma once
 
+#include "hardware/DeviceMutex.hpp"
+#include "hardware/DoubleBuffer.hpp"
 #include "hardware/Motor/Motor.hpp"
 #include "hardware/Port.hpp"
+#include "hardware/StaticVector.hpp"
 #include "units/Angle.hpp"
 #include "pros/motor_group.hpp"
 #include "pros/rtos.hpp"
+#include <atomic>
+#include <span>
 #include <vector>
 
 namespace lemlib {
+/**
+ * @brief How the angles of the motors in a group are combined into the angle of the group
+ */
+enum class AngleAggregate {
+    /** the average of the angles. This is the default */
+    MEAN,
+    /** the median of the angles, which ignores a single motor which slipped or lost its position */
+    MEDIAN
+};
+
+/**
+ * @brief How a motor group balances the load between its motors
+ *
+ * Every 10 ms, the share of the power of each motor is trimmed a little away from motors which are hotter, or draw
+ * more current, than the average of the group.
+ */
+struct LoadBalanceSettings {
+        /** whether the load is balanced. Disabling it puts every motor back at an even share */
+        bool enabled = false;
+        /** the trim per degree celsius above the average temperature of the group, every 10 ms */
+        double temperatureGain = 0.001;
+        /** the trim per amp above the average current of the group, every 10 ms */
+        double currentGain = 0.002;
+        /** the furthest the share of a motor can be trimmed from an even share, as a fraction of it */
+        Number maxTrim = 0.2;
+};
+
+/**
+ * @brief How quickly the commands of a motor group can change
+ *
+ * The limits are on the linear motion of a wheel driven by the group, so they can be taken straight from the
+ * constraints of a motion profile.
+ */
+struct SlewLimits {
+        /** the largest acceleration of the wheel. INFINITY disables the limit, which is the default */
+        LinearAcceleration maxAcceleration = from_mps2(INFINITY);
+        /** the largest jerk of the wheel. INFINITY disables the limit, which is the default */
+        LinearJerk maxJerk = from_mps3(INFINITY);
+        /** the diameter of the wheel, which turns the limits into limits on the output of the group */
+        Length wheelDiameter = 0_m;
+        /**
+         * the time between commands. The limiter steps by this time on every command, instead of measuring it, so
+         * set it to the tick of the ControlScheduler, or the period of the loop, which sends the commands
+         */
+        Time period = 10_msec;
+};
+
 /**
  * @brief MotorGroup class
  *
@@ -16,17 +68,34 @@ namespace lemlib {
  * class also enables users to add and remove motors from the group, which is useful when a motor can be moved between
  * subsystems using a Power Take Off (PTO) or similar mechanism.
  *
+ * Motors which reconnect are not used again until they have been configured, which sets their angle and brake mode to
+ * match the rest of the group. This is done by a low priority maintenance task shared by every motor group, instead of
+ * by the function which noticed the reconnect, so a reconnect never makes a call like move() take longer. The task
+ * also runs whenever the DeviceRegistry reports that a device was plugged in or unplugged, so motors are configured
+ * even if the group isn't used in between.
+ *
+ * The group remembers the brake mode it applied to each motor, so commands don't have to read the brake mode of every
+ * motor. The maintenance task checks that the brake modes are still correct once per second.
+ *
+ * A group holds at most MAX_MOTORS motors. They are stored inside the group, so constructing and copying a group
+ * doesn't allocate memory.
+ *
  * Error handling for the MotorGroup class is a bit different from other hardware classes. This is because
  * the MotorGroup class represents a group of motors, any of which could fail. However, as long as one
  * motor in the group is functioning properly, the MotorGroup will not throw any errors. In addition, errno will be set
  * to whatever error was thrown last, as there may be multiple motors in a motor group.
  */
 class MotorGroup : public Encoder {
+        // send the commands of all of their groups in one pass
+        friend class DifferentialDrive;
+        friend class HolonomicDrive;
     public:
+        /** the most motors a group can hold */
+        static constexpr size_t MAX_MOTORS = 8;
         /**
          * @brief Construct a new Motor Group
          *
-         * @param ports list of ports of the motors in the group
+         * @param ports list of ports of the motors in the group. Only the first MAX_MOTORS ports are used
          * @param outputVelocity the theoretical maximum output velocity of the motor group, after gearing
          *
          * @b Example:
@@ -42,12 +111,20 @@ class MotorGroup : public Encoder {
         /**
          * @brief MotorGroup copy constructor
          *
-         * Because pros::Mutex does not have a copy constructor, an explicit
+         * Because DeviceMutex does not have a copy constructor, an explicit
          * copy constructor is necessary
          *
          * @param other the MotorGroup to copy
          */
         MotorGroup(const MotorGroup& other);
+        /**
+         * @brief Destroy the Motor Group
+         *
+         * Waits for the reconnect task if it is configuring a motor in this group
+         */
+        ~MotorGroup();
+        // the simulator only implements the PROS C api, so PROS objects can't be converted
+#ifndef LEMLIB_SIM
         /**
          * @brief Create a new Motor Group
          *
@@ -66,12 +143,14 @@ class MotorGroup : public Encoder {
          * @endcode
          */
         static MotorGroup from_pros_group(const pros::MotorGroup group, AngularVelocity outputVelocity);
+#endif
         /**
          * @brief move the motors at a percent power from -1.0 to +1.0
          *
          * This function uses the following values of errno when an error state is reached:
          *
          * ENODEV: the port cannot be configured as a motor
+         * EBUSY: a source with a higher command priority owns the ports of every motor
          *
          * @param percent the power to move the motors at from -1.0 to +1.0
          * @return 0 on success
@@ -98,6 +177,7 @@ class MotorGroup : public Encoder {
          * This function uses the following values of errno when an error state is reached:
          *
          * ENODEV: the port cannot be configured as a motor
+         * EBUSY: a source with a higher command priority owns the ports of every motor
          *
          * @param velocity the target angular velocity to move the motors at
          * @return 0 on success
@@ -124,6 +204,7 @@ class MotorGroup : public Encoder {
          * This function uses the following values of errno when an error state is reached:
          *
          * ENODEV: the port cannot be configured as a motor
+         * EBUSY: a source with a higher command priority owns the ports of every motor
          *
          * This function will stop the motors using the set brake mode
          *
@@ -143,6 +224,47 @@ class MotorGroup : public Encoder {
          * @endcode
          */
         int32_t brake();
+        /**
+         * @brief move the motors to an angle, without waiting for them to get there
+         *
+         * Every connected motor follows the motion with its own position controller. The returned future finishes
+         * once the angle of the group stays within the tolerance for the settle time, which is checked by a
+         * DevicePoller the group is registered with, or by calling updateMotion. Sending any other command to the
+         * group cancels the motion.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: none of the motors could start the motion
+         *
+         * @param angle the angle to move to, measured the same way as getAngle
+         * @param velocity the maximum velocity of the motion, at the output of the motors
+         * @param settings when the motion counts as finished
+         * @return MotionFuture the future of the motion. Its state is FAILED if no motor could start the motion
+         *
+         * @b Example:
+         * @code {.cpp}
+         * lemlib::MotorGroup lift({1, -2}, 100_rpm);
+         * lemlib::DevicePoller poller;
+         *
+         * void initialize() {
+         *     poller.addMotorGroup(lift);
+         *     poller.start();
+         * }
+         *
+         * lemlib::Routine scoreRoutine() {
+         *     co_await lift.moveToAngle(120_stDeg, 80_rpm);
+         *     claw.move(-1);
+         * }
+         * @endcode
+         */
+        MotionFuture moveToAngle(Angle angle, AngularVelocity velocity, MotionSettings settings = {});
+        /**
+         * @brief Check whether the motion started by moveToAngle has settled
+         *
+         * This is called by a DevicePoller the group is registered with. The angle is only read while a motion is
+         * pending, so calling it when there is no motion costs a single atomic load.
+         */
+        void updateMotion();
         /**
          * @brief set the brake mode of the motors
          *
@@ -191,6 +313,9 @@ class MotorGroup : public Encoder {
         /**
          * @brief whether any of the motors in the motor group are connected
          *
+         * While no motor of the group is plugged in or unplugged, this reuses the result of the last check of the
+         * motors, so it costs a few loads and doesn't lock the group
+         *
          * @return 0 no motors are connected
          * @return 1 if at least one motor is connected
          *
@@ -211,12 +336,24 @@ class MotorGroup : public Encoder {
          * @endcode
          */
         int32_t isConnected() const override;
+        /**
+         * @brief Detect the type and cartridge of every motor, for DeviceRegistry::initializeAll
+         *
+         * See Motor::startInitialization
+         *
+         * @return 0 if the type of at least one motor was detected
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t startInitialization() override;
         /**
          * @brief Get the average relative angle measured by the motors
          *
          * The relative angle measured by the encoder is the angle of the encoder relative to the last time the encoder
          * was reset. As such, it is unbounded.
          *
+         * The positions of every motor are read back to back before any of them is converted, so the angle combines
+         * samples taken as close together as possible. How they are combined is set by setAngleAggregate.
+         *
          * This function uses the following values of errno when an error state is reached:
          *
          * ENODEV: the port cannot be configured as a motor
@@ -239,6 +376,39 @@ class MotorGroup : public Encoder {
          * @endcode
          */
         Angle getAngle() const override;
+        /**
+         * @brief Get the relative angle measured by the motor group, or the error which prevented reading it
+         *
+         * See getAngle for how the motors are combined. Motors which could not be read are skipped with an integer
+         * test on their raw ticks.
+         *
+         * @return Result<Angle> the relative angle, or ENODEV if no motor could be read
+         */
+        Result<Angle> tryGetAngle() const override;
+        /**
+         * @brief Get the relative angle of the motor group, and when the motors measured it
+         *
+         * The angle is combined like getAngle. Every motor reports when it measured its position, and the timestamp is
+         * the average of the times of the motors which were combined, so the time between two samples is the time
+         * between the measurements, not between the calls.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: no motor could be read
+         *
+         * @return EncoderSample the angle and its timestamp, measured since the program started. The angle is INFINITY
+         * and connected is false if there is an error, setting errno. The timestamp is then the time of the call
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     lemlib::MotorGroup motorGroup({1, -2, 3}, 360_rpm);
+         *     const lemlib::EncoderSample sample = motorGroup.getSample();
+         *     std::cout << to_sDeg(sample.angle) << " at " << to_sec(sample.timestamp) << std::endl;
+         * }
+         * @endcode
+         */
+        EncoderSample getSample() const;
         /**
          * @brief Set the relative angle of all the motors
          *
@@ -268,6 +438,324 @@ class MotorGroup : public Encoder {
          * @endcode
          */
         int32_t setAngle(Angle angle) override;
+        /**
+         * @brief Get the average filtered velocity of the connected motors in the group, after gearing
+         *
+         * Every motor filters its own position, like Motor::getVelocity, so velocity should be read periodically. The
+         * average doesn't allocate memory, so it can be read from the control loop.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @return AngularVelocity the average velocity
+         * @return INFINITY on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     lemlib::MotorGroup motorGroup({1, -2, 3}, 360_rpm);
+         *     while (true) {
+         *         std::cout << "Velocity: " << to_rpm(motorGroup.getVelocity()) << std::endl;
+         *         pros::delay(10);
+         *     }
+         * }
+         * @endcode
+         */
+        AngularVelocity getVelocity() const;
+        /**
+         * @brief Get the average filtered acceleration of the connected motors in the group, after gearing
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @return AngularAcceleration the average acceleration
+         * @return INFINITY on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     lemlib::MotorGroup motorGroup({1, -2, 3}, 360_rpm);
+         *     while (true) {
+         *         std::cout << "Acceleration: " << to_rps2(motorGroup.getAcceleration()) << std::endl;
+         *         pros::delay(10);
+         *     }
+         * }
+         * @endcode
+         */
+        AngularAcceleration getAcceleration() const;
+        /**
+         * @brief Set the gains of the velocity filter of every motor in the group
+         *
+         * Motors which are added to the group later use the same gains
+         *
+         * @param gains the gains of the filter
+         * @return int32_t always returns 0
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::MotorGroup motorGroup({1, -2, 3}, 360_rpm);
+         *     motorGroup.setVelocityFilter(lemlib::AlphaBetaGains::criticallyDamped(0.85));
+         * }
+         * @endcode
+         */
+        int32_t setVelocityFilter(AlphaBetaGains gains);
+        /**
+         * @brief Get the gains of the velocity filter of the motors in the group
+         *
+         * @return AlphaBetaGains the gains of the filter
+         */
+        AlphaBetaGains getVelocityFilter() const;
+        /**
+         * @brief Set the command cache of every motor in the group
+         *
+         * Motors which are added to the group later use the same settings
+         *
+         * @param settings the settings of the cache
+         * @return int32_t always returns 0
+         */
+        int32_t setCommandCache(CommandCacheSettings settings);
+        /**
+         * @brief Get the settings of the command cache of the motors in the group
+         *
+         * @return CommandCacheSettings the settings
+         */
+        CommandCacheSettings getCommandCache() const;
+        /**
+         * @brief Set the command priority of every motor in the group
+         *
+         * Motors which are added to the group later use the same priority. See Motor::setCommandPriority
+         *
+         * @param priority the priority. Defaults to 0, which never owns the ports
+         * @return int32_t always returns 0
+         */
+        int32_t setCommandPriority(uint8_t priority);
+        /**
+         * @brief Get the command priority of the motors in the group
+         *
+         * @return uint8_t the priority
+         */
+        uint8_t getCommandPriority() const;
+        /**
+         * @brief Release the port of every motor in the group which the group owns with its priority
+         *
+         * See Motor::releaseCommands
+         *
+         * @return int32_t always returns 0
+         */
+        int32_t releaseCommands();
+        /**
+         * @brief Set how long every motor in the group reuses the last position it read
+         *
+         * Motors which are added to the group later use the same window. See Motor::setReadCacheWindow
+         *
+         * @param window how old a reading can be and still be used. 0 disables the cache, which is the default
+         * @return int32_t always returns 0
+         */
+        int32_t setReadCacheWindow(Time window);
+        /**
+         * @brief Get how long the motors in the group reuse the last position they read
+         *
+         * @return Time the window. 0 if the cache is disabled
+         */
+        Time getReadCacheWindow() const;
+        /**
+         * @brief Set the battery voltage power commands of every motor in the group are compensated for
+         *
+         * Motors which are added to the group later use the same voltage. See Motor::setVoltageCompensation for
+         * details.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the nominal voltage is negative or infinite
+         *
+         * @param nominal the battery voltage the gains of the program were tuned at, or 0 volts to disable
+         * compensation
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t setVoltageCompensation(Voltage nominal);
+        /**
+         * @brief Get the battery voltage power commands of the motors in the group are compensated for
+         *
+         * @return Voltage the nominal voltage, or 0 volts if compensation is disabled
+         */
+        Voltage getVoltageCompensation() const;
+        /**
+         * @brief Limit the acceleration and jerk of move and moveVelocity
+         *
+         * Commands are ramped towards their target by a limiter inside the group, which runs once per command for the
+         * whole group, rather than for every motor. A command changes the velocity of the group by at most one period
+         * of acceleration, and the acceleration by at most one period of jerk. The acceleration is eased off as the
+         * velocity nears the target, so the velocity settles on it without overshooting. brake and moveToAngle
+         * bypass the limiter, and reset it to rest.
+         *
+         * The limiter only knows the commands it was sent, so send a command every period, even if the target doesn't
+         * change, until the group reaches it.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: a limit or the period is not positive, or a limit is set without a positive wheel diameter
+         *
+         * @param limits the limits. The default SlewLimits disables the limiter
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * lemlib::MotorGroup lift({1, -2}, 200_rpm);
+         * lemlib::ControlScheduler scheduler(10_msec);
+         * pros::Controller controller(pros::E_CONTROLLER_MASTER);
+         *
+         * void initialize() {
+         *     // the period matches the tick of the scheduler, which sends the commands
+         *     lift.setSlewLimits(
+         *         {.maxAcceleration = 2_mps2, .maxJerk = 20_mps3, .wheelDiameter = 1.5_in, .period = 10_msec});
+         *     // the joystick jumps to full power, but the lift ramps up over the next few ticks
+         *     scheduler.add([] { lift.move(controller.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_Y) / 127.0); }, 10_msec);
+         *     scheduler.start();
+         * }
+         * @endcode
+         */
+        int32_t setSlewLimits(SlewLimits limits);
+        /**
+         * @brief Get the acceleration and jerk limits of move and moveVelocity
+         *
+         * @return SlewLimits the limits
+         */
+        SlewLimits getSlewLimits() const;
+        /**
+         * @brief Balance the load between the motors in the group
+         *
+         * When the motors of a group heat up unevenly, the hottest one is throttled first, and drags the group down.
+         * With load balancing enabled, the maintenance task trims the share of the power of each motor a little every
+         * 10 ms, from the temperature and current of every motor. The trims are adjusted incrementally, and always
+         * average to 1, even when some of them are at the maximum trim, so the total output of the group stays the same
+         * unless a motor is already at full power.
+         *
+         * Only move is trimmed, as velocity commands are closed loop on every motor, which would fight the trims.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: a gain is negative, or the maximum trim is not between 0 and 1
+         *
+         * @param settings how the load is balanced
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * lemlib::MotorGroup leftDrive({1, -2, 3}, 450_rpm);
+         *
+         * void opcontrol() {
+         *     // the trims are updated in the background
+         *     leftDrive.setLoadBalancing({.enabled = true});
+         *     while (true) {
+         *         leftDrive.move(controller.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_Y) / 127.0);
+         *         pros::delay(10);
+         *     }
+         * }
+         * @endcode
+         */
+        int32_t setLoadBalancing(LoadBalanceSettings settings);
+        /**
+         * @brief Get how the load is balanced between the motors in the group
+         *
+         * @return LoadBalanceSettings the settings
+         */
+        LoadBalanceSettings getLoadBalancing() const;
+        /**
+         * @brief Set how the angles of the motors are combined by getAngle
+         *
+         * The median is slower to calculate than the mean, but a single motor with a bad reading doesn't move it.
+         * This is useful when the angle of a drivetrain is used for odometry.
+         *
+         * @param aggregate how the angles are combined
+         * @return int32_t always returns 0
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::MotorGroup motorGroup({1, -2, 3}, 360_rpm);
+         *     motorGroup.setAngleAggregate(lemlib::AngleAggregate::MEDIAN);
+         * }
+         * @endcode
+         */
+        int32_t setAngleAggregate(AngleAggregate aggregate);
+        /**
+         * @brief Get how the angles of the motors are combined by getAngle
+         *
+         * @return AngleAggregate how the angles are combined
+         */
+        AngleAggregate getAngleAggregate() const;
+        /**
+         * @brief Set how far the angle of a motor can diverge from the median of the group before it is excluded
+         *
+         * A motor which slips, or has a damaged gear, measures an angle which drifts away from the other motors.
+         * Whenever getAngle is called, a motor further than the threshold from the median angle of the group is
+         * flagged as an outlier, and excluded from the angle of the group until it comes back within half of the
+         * threshold. Outliers are flagged in the telemetry of the group. At least 3 working motors are needed to
+         * find an outlier.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the threshold is not positive
+         *
+         * @param threshold how far a motor can be from the median angle. INFINITY disables detection, which is the
+         * default
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::MotorGroup motorGroup({1, -2, 3}, 360_rpm);
+         *     // ignore a motor which is more than a quarter of a rotation off the others
+         *     motorGroup.setOutlierThreshold(90_stDeg);
+         * }
+         * @endcode
+         */
+        int32_t setOutlierThreshold(Angle threshold);
+        /**
+         * @brief Get how far the angle of a motor can diverge from the median of the group before it is excluded
+         *
+         * @return Angle the threshold. INFINITY if detection is disabled
+         */
+        Angle getOutlierThreshold() const;
+        /**
+         * @brief Set whether the wiring of the group is trusted, so commands skip the health checks of the motors
+         *
+         * By default, every call to the group checks which motors are connected, applies the brake mode and the
+         * current limit to motors which don't have them yet, and notices motors which reconnected. A trusted group
+         * moves all of that to the maintenance task, which audits it every 10 ms, and every other call reuses the
+         * motors the last audit found, so a command is just the SDK call of every motor. A motor which is unplugged
+         * is still commanded until the next audit, and the call fails for it like for an untrusted group.
+         *
+         * Setters like setBrakeMode and setCurrentLimit still check the motors, so their changes apply right away.
+         *
+         * @param trusted whether the group is trusted. Defaults to false
+         * @return 0 on success
+         *
+         * @b Example:
+         * @code {.cpp}
+         * lemlib::MotorGroup left({1, -2, 3}, 360_rpm);
+         *
+         * void initialize() {
+         *     // the drive is checked before every match, so its commands don't need to check it again
+         *     left.setTrusted(true);
+         * }
+         * @endcode
+         */
+        int32_t setTrusted(bool trusted);
+        /**
+         * @brief Get whether the wiring of the group is trusted
+         *
+         * @return true commands skip the health checks, which the maintenance task does instead
+         * @return false every call checks the motors
+         */
+        bool isTrusted() const;
         /**
          * @brief Get the combined current limit of all motors in the group
          *
@@ -299,11 +787,19 @@ class MotorGroup : public Encoder {
         /**
          * @brief set the combined current limit of all motors in the group
          *
+         * The limit is split evenly between the connected motors. The group remembers the limit, and splits it again
+         * whenever a motor disconnects or reconnects, so the combined limit stays the same. Only motors whose share of
+         * the limit changed are written to. A limit of INFINITY lifts the limit, setting every motor back to the
+         * largest current it can draw.
+         *
          * This function uses the following values of errno when an error state is reached:
          *
          * ENODEV: the port cannot be configured as a motor
          *
-         * @param limit the maximum allowed current
+         * EIO: a connected motor didn't accept its share of the limit. It is tried again every time the group checks
+         * its motors
+         *
+         * @param limit the maximum allowed current, or INFINITY for no limit
          * @return 0 on success
          * @return INT_MAX on failure, setting errno
          *
@@ -347,9 +843,177 @@ class MotorGroup : public Encoder {
          * @endcode
          */
         std::vector<Temperature> getTemperatures() const;
+        /**
+         * @brief Write the temperature of every connected motor in the motor group into a buffer
+         *
+         * This function does not allocate any memory, so it can be called from time-sensitive tasks. The motor group
+         * is locked once while every motor is read. If there are more connected motors than there is space in the
+         * buffer, the extra motors are not read.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @param buffer the buffer to write to. The temperature of a motor which could not be read is INFINITY
+         * @return int32_t the number of motors written to the buffer
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::MotorGroup motorGroup({1, -2, 3}, 360_rpm);
+         *     std::array<Temperature, 3> buffer {0_celsius, 0_celsius, 0_celsius};
+         *     // output the temperature of every motor to the console
+         *     const int32_t count = motorGroup.getTemperatures(buffer);
+         *     for (int32_t i = 0; i < count; i++) {
+         *         std::cout << "Motor Temperature: " << units::to_celsius(buffer[i]) << std::endl;
+         *     }
+         * }
+         * @endcode
+         */
+        int32_t getTemperatures(std::span<Temperature> buffer) const;
+        /**
+         * @brief Write the angle of every connected motor in the motor group into a buffer
+         *
+         * This function does not allocate any memory, so it can be called from time-sensitive tasks. The motor group
+         * is locked once while every motor is read. If there are more connected motors than there is space in the
+         * buffer, the extra motors are not read.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @param buffer the buffer to write to. The angle of a motor which could not be read is INFINITY
+         * @return int32_t the number of motors written to the buffer
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::MotorGroup motorGroup({1, -2, 3}, 360_rpm);
+         *     std::array<Angle, 3> buffer {0_stDeg, 0_stDeg, 0_stDeg};
+         *     // output the angle of every motor to the console. Unlike getAngle, these are not averaged, so they
+         *     // show how far the motors have drifted apart
+         *     const int32_t count = motorGroup.getAngles(buffer);
+         *     for (int32_t i = 0; i < count; i++) {
+         *         std::cout << "Motor Angle: " << to_stDeg(buffer[i]) << std::endl;
+         *     }
+         * }
+         * @endcode
+         */
+        int32_t getAngles(std::span<Angle> buffer) const;
+        /**
+         * @brief Write the velocity of every connected motor in the motor group into a buffer
+         *
+         * This function does not allocate any memory, so it can be called from time-sensitive tasks. The motor group
+         * is locked once while every motor is read. If there are more connected motors than there is space in the
+         * buffer, the extra motors are not read.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @param buffer the buffer to write to. The velocity of a motor which could not be read is INFINITY
+         * @return int32_t the number of motors written to the buffer
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::MotorGroup motorGroup({1, -2, 3}, 360_rpm);
+         *     std::array<AngularVelocity, 3> buffer {0_rpm, 0_rpm, 0_rpm};
+         *     // output the velocity of every motor to the console
+         *     const int32_t count = motorGroup.getVelocities(buffer);
+         *     for (int32_t i = 0; i < count; i++) {
+         *         std::cout << "Motor Velocity: " << to_rpm(buffer[i]) << std::endl;
+         *     }
+         * }
+         * @endcode
+         */
+        int32_t getVelocities(std::span<AngularVelocity> buffer) const;
+        /**
+         * @brief Write the current drawn by every connected motor in the motor group into a buffer
+         *
+         * This function does not allocate any memory, so it can be called from time-sensitive tasks. The motor group
+         * is locked once while every motor is read. If there are more connected motors than there is space in the
+         * buffer, the extra motors are not read.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @param buffer the buffer to write to. The current of a motor which could not be read is INFINITY
+         * @return int32_t the number of motors written to the buffer
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::MotorGroup motorGroup({1, -2, 3}, 360_rpm);
+         *     std::array<Current, 3> buffer {0_amp, 0_amp, 0_amp};
+         *     // output the current draw of every motor to the console
+         *     const int32_t count = motorGroup.getCurrents(buffer);
+         *     for (int32_t i = 0; i < count; i++) {
+         *         std::cout << "Motor Current: " << to_amp(buffer[i]) << std::endl;
+         *     }
+         * }
+         * @endcode
+         */
+        int32_t getCurrents(std::span<Current> buffer) const;
+        /**
+         * @brief Get the state of every connected motor in the motor group
+         *
+         * The motor group is locked once while every motor is read, and every motor is read in a single pass. See
+         * Motor::getTelemetry for details.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @return std::vector<MotorTelemetry> the state of each connected motor
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::MotorGroup motorGroup({1, -2, 3}, 360_rpm);
+         *     // output the velocity of every motor to the console
+         *     for (const lemlib::MotorTelemetry& telemetry : motorGroup.getTelemetry()) {
+         *         std::cout << "Motor Velocity: " << telemetry.velocity << std::endl;
+         *     }
+         * }
+         * @endcode
+         */
+        std::vector<MotorTelemetry> getTelemetry() const;
+        /**
+         * @brief Write the state of every connected motor in the motor group into a buffer
+         *
+         * This function does the same as the overload without parameters, but it does not allocate any memory, so it
+         * can be called from time-sensitive tasks. If there are more connected motors than there is space in the
+         * buffer, the extra motors are not read.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @param buffer the buffer to write to
+         * @return int32_t the number of motors written to the buffer
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::MotorGroup motorGroup({1, -2, 3}, 360_rpm);
+         *     std::array<lemlib::MotorTelemetry, 3> buffer;
+         *     // output the current draw of every motor to the console
+         *     const int32_t count = motorGroup.getTelemetry(buffer);
+         *     for (int32_t i = 0; i < count; i++) {
+         *         std::cout << "Motor Current: " << buffer[i].current << std::endl;
+         *     }
+         * }
+         * @endcode
+         */
+        int32_t getTelemetry(std::span<MotorTelemetry> buffer) const;
         /**
          * @brief set the output velocity of the motors
          *
+         * Every motor converts ticks to angles with a factor computed from the output velocity. It is only computed
+         * here, so reading the angle of the motor group is a multiply and an add per motor.
+         *
          * @param outputVelocity the theoretical maximum output velocity of the motor group, after gearing, to set
          * @return int 0 success
          * @return INT_MAX error occurred, setting errno
@@ -381,6 +1045,8 @@ class MotorGroup : public Encoder {
         /**
          * @brief Get the number of connected motors in the group
          *
+         * Like isConnected, this doesn't lock the group while no motor of the group is plugged in or unplugged
+         *
          * @return int the number of connected motors in the group
          *
          * @b Example:
@@ -404,6 +1070,7 @@ class MotorGroup : public Encoder {
          * This function uses the following values of errno when an error state is reached:
          *
          * ENODEV: the port cannot be configured as a motor
+         * ENOSPC: the group already has MAX_MOTORS motors. The motor is not added
          *
          * @param port the signed port of the motor to be added to the group. Negative ports indicate the motor should
          * be reversed
@@ -446,7 +1113,7 @@ class MotorGroup : public Encoder {
          * }
          * @endcode
          */
-        int32_t addMotor(Motor motor);
+        int32_t addMotor(const Motor& motor);
         /**
          * @brief Add a motor to the motor group
          *
@@ -472,7 +1139,7 @@ class MotorGroup : public Encoder {
          * }
          * @endcode
          */
-        int32_t addMotor(Motor motor, bool reversed);
+        int32_t addMotor(const Motor& motor, bool reversed);
         /**
          * @brief Remove a motor from the motor group
          *
@@ -505,66 +1172,371 @@ class MotorGroup : public Encoder {
          * }
          * @endcode
          */
-        void removeMotor(Motor motor);
+        void removeMotor(const Motor& motor);
     private:
-        struct MotorInfo {
-                ReversibleSmartPort port;
-                bool connectedLastCycle;
-                Angle offset;
+        /** the priority of the task which configures motors that reconnected and audits brake modes */
+        static constexpr uint32_t MAINTENANCE_TASK_PRIORITY = TASK_PRIORITY_MIN + 1;
+        /** how often the maintenance task checks for motors which reconnected, in milliseconds */
+        static constexpr uint32_t MAINTENANCE_TASK_PERIOD = 10;
+        /** how often the maintenance task checks the brake mode of every connected motor, in milliseconds */
+        static constexpr uint32_t BRAKE_MODE_AUDIT_PERIOD = 1000;
+        /** the current limit of a motor of a group without a limit, which is the highest limit the 11W motor takes */
+        static constexpr Current MAX_MOTOR_CURRENT = from_amp(2.5);
+
+        static_assert(MAX_MOTORS <= 8, "the flags of the motors are packed into a byte");
+
+        /**
+         * @brief The motors of the group, and what the group remembers about each of them
+         *
+         * Loops over the group usually only need one or two of these, so they are stored as parallel arrays, indexed
+         * the same way as motors, instead of a struct per motor. The flags are packed into bitmasks, where bit i is the
+         * flag of motor i, so all the flags of the group are read or cleared with a single byte operation.
+         */
+        struct MotorStates {
+                StaticVector<Motor, MAX_MOTORS> motors;
+                // the brake mode the group last applied to each motor, or BrakeMode::INVALID if it has to be applied
+                StaticVector<BrakeMode, MAX_MOTORS> appliedBrakeModes;
+                // the current limit the group last applied to each motor, or INFINITY if it hasn't applied one since
+                // the motor joined or reconnected
+                StaticVector<Current, MAX_MOTORS> appliedCurrentLimits;
+                // the share of the power of each motor, relative to an even share, set by load balancing
+                StaticVector<double, MAX_MOTORS> loadTrims;
+                // the motors which were connected the last time they were checked
+                uint8_t connected = 0;
+                // the motors whose angles diverged from the group, so they are excluded from getAngle
+                uint8_t outliers = 0;
         };
 
         /**
-         * @brief Configure a motor so its ready to join the motor group, and return its offset
+         * @brief Call a function for every motor returned by getMotors
+         *
+         * m_connectedMotors is in the same order as m_state.motors, so both are walked together. The mutex has to be
+         * locked before this function is called
+         *
+         * @param f the function, which is passed the index of the motor in m_state and its index in m_connectedMotors
+         */
+        template <typename F> void forEachConnected(F&& f) const {
+            std::size_t next = 0;
+            for (std::size_t i = 0; i < m_state.motors.size(); i++) {
+                if (next == m_connectedMotors.size()) break;
+                if (m_connectedMotors[next] != &m_state.motors[i]) continue;
+                f(i, next);
+                next++;
+            }
+        }
+
+        /**
+         * @brief Add a motor to the end of m_state, with nothing applied to it yet
+         *
+         * @param motor the motor
+         * @param connected whether the motor counts as connected
+         */
+        void appendMotor(Motor&& motor, bool connected);
+
+        /**
+         * @brief Record that a motor was unplugged, so everything is applied to it again once it reconnects
+         *
+         * @param index the index of the motor in m_state
+         */
+        void markDisconnected(std::size_t index) const;
+
+        /**
+         * @brief Flag the motors whose angles diverged from the median of the group
+         *
+         * The angles in m_angles of motors which are outliers are replaced with INFINITY, so they are skipped like
+         * motors which could not be read. The mutex has to be locked before this function is called
+         *
+         * @param threshold how far a motor can be from the median angle
+         */
+        void updateOutliers(Angle threshold) const;
+        /**
+         * @brief Read and combine the angles of the motors, like tryGetAngle
+         *
+         * The mutex has to be locked before this function is called
+         *
+         * @param timestamp if it isn't nullptr, set to the average of the times the combined motors measured their
+         * positions, in microseconds since the program started. Not changed on failure
+         * @return Result<Angle> the relative angle, or ENODEV if no motor could be read
+         */
+        Result<Angle> readAngle(uint32_t* timestamp) const;
+
+        /**
+         * @brief Adjust the load trims of the connected motors from their temperatures and currents
+         *
+         * This is called by the maintenance task every period. It does nothing if load balancing is disabled
+         */
+        void updateLoadTrims();
+
+        /**
+         * @brief Configure a motor so its ready to join the motor group
          *
          * Motors may be added to the motor group or reconnect to the motor group during runtime. When this happens,
          * functions like getAngle() would break as the motor is not configured like other motors in the group. This
-         * function sets the angle measured by the specified motor to the average angle measured by the group. It also
-         * sets the brake mode of the motor to be the same as the first working motor in the group.
+         * function sets the angle measured by the specified motor to the average angle measured by the group, and sets
+         * the brake mode of the motor to the brake mode of the group.
+         *
+         * The average angle is estimated from a single reference motor, and the difference between the reference motor
+         * and the average saved the last time getAngle was called. So configuring a motor costs the same number of SDK
+         * calls no matter how many motors are in the group.
          *
          * This function uses the following values of errno when an error state is reached:
          *
          * ENODEV: the port cannot be configured as a motor
          *
-         * @param port the port of the motor to configure
+         * The motor is configured in place, so no temporary motor objects have to be created.
+         *
+         * @param index the index of the motor to configure in m_state
          *
          * @return 0 on success
          * @return INT_MAX on failure, setting errno
          */
-        Angle configureMotor(ReversibleSmartPort port) const;
+        int32_t configureMotor(std::size_t index) const;
+        /**
+         * @brief Configure every motor which reconnected since the last time it was checked
+         *
+         * This is called by the maintenance task, when a motor reconnected or the plugged devices changed. Motors which
+         * were unplugged are recorded as disconnected. Motors are only added back to the group once they are configured
+         */
+        void configureReconnectedMotors();
+        /**
+         * @brief Check the brake mode of every connected motor, and fix it if it changed
+         *
+         * This is called by the maintenance task. The brake mode of a motor could change without the group knowing,
+         * for example if another object controls the same motor.
+         */
+        void auditBrakeModes();
+        /**
+         * @brief Check the motors of a trusted group, like getMotors does for a group which isn't trusted
+         *
+         * This is called by the maintenance task every period
+         */
+        void auditTrusted();
+        /**
+         * @brief Start the maintenance task, if it isn't running yet
+         *
+         * The task is started the first time a motor group is used, so no task is created while global motor groups
+         * are constructed
+         */
+        static void startMaintenanceTask();
+        /**
+         * @brief Configure motors which reconnected, audit brake modes and balance the load, in every motor group
+         */
+        static void maintenanceTaskFunction(void*);
+        /**
+         * @brief Get the connected motors in the motor group
+         *
+         * This function exists to simplify logic in the MotorGroup source code. It checks whether each motor is
+         * connected, and handles disconnects. Motors which reconnected are left out until the maintenance task has
+         * configured them. The brake mode of a motor is only set if the group hasn't applied it yet.
+         *
+         * The returned vector is saved between calls, and stored inside the group, so this function does not allocate
+         * memory. The pointers it contains are valid until the next call to this function,
+         * or until a motor is added or removed.
+         *
+         * @return const StaticVector<Motor*, MAX_MOTORS>& pointers to the connected motors
+         */
+        const StaticVector<Motor*, MAX_MOTORS>& getMotors() const;
         /**
-         * @brief Get motors in the motor group as a vector of lemlib::Motor objects
+         * @brief Get the connected motors, checked against a snapshot of the ports which was already loaded
          *
-         * This function exists to simplify logic in the MotorGroup source code.
+         * A trusted group returns the motors found by the last check instead, without checking them again
          *
-         * @return const std::vector<Motor> vector of lemlib::Motor objects
+         * @param plugged the ports with a motor plugged in, from DeviceRegistry::getPluggedPorts
+         * @return const StaticVector<Motor*, MAX_MOTORS>& pointers to the connected motors
          */
-        const std::vector<Motor> getMotors() const;
+        const StaticVector<Motor*, MAX_MOTORS>& getMotors(uint32_t plugged) const;
         /**
-         * @brief Get the Motor Infos
+         * @brief Check which motors are connected, like getMotors does for a group which isn't trusted
+         *
+         * @param plugged the ports with a motor plugged in, from DeviceRegistry::getPluggedPorts
+         * @return const StaticVector<Motor*, MAX_MOTORS>& pointers to the connected motors
+         */
+        const StaticVector<Motor*, MAX_MOTORS>& checkMotors(uint32_t plugged) const;
+        /**
+         * @brief Get a copy of the motors and their states
          *
          * This function exists to make the copy constructor thread-safe
          *
-         * @return const std::vector<MotorInfo>
+         * @return MotorStates a copy of m_state
+         */
+        MotorStates getMotorStates() const;
+        /**
+         * @brief Find a connected motor to estimate the angle of the group from
+         *
+         * The reference motor saved by getAngle is used if it is still connected. Otherwise, the first other motor
+         * which was connected the last time it was checked becomes the new reference.
+         *
+         * @param port the port of the motor being configured, which can't be its own reference
+         * @return const Motor* the reference motor, or nullptr if no other motor is connected
+         */
+        const Motor* getReferenceMotor(ReversibleSmartPort port) const;
+        /**
+         * @brief Split the current limit of the group between the connected motors
+         *
+         * This is called by getMotors, once it found the connected motors. Motors which already have their share of
+         * the limit are skipped, so this only writes to motors when the limit or the number of connected motors
+         * changed. Motors which failed are tried again the next time this is called
+         */
+        void applyCurrentLimit() const;
+        /**
+         * @brief Get the share of the current limit of each connected motor
+         *
+         * The mutex has to be locked, and the connected motors found, before this function is called
+         *
+         * @return Current the limit divided between the connected motors, or MAX_MOTOR_CURRENT without a limit
+         */
+        Current currentLimitShare() const;
+        /**
+         * @brief Check whether a connected motor has its share of the current limit
+         *
+         * The mutex has to be locked, and the connected motors found, before this function is called
+         *
+         * @param index the index of the motor in m_state
+         * @return true if the motor doesn't have to be written to
+         */
+        bool hasCurrentLimitShare(std::size_t index) const;
+        /**
+         * @brief Send a command to every connected motor at once
+         *
+         * The command of every motor is prepared first, and then all of them are sent in one go, so the last motor
+         * gets its command right after the first. The mutex has to be locked before this function is called
+         *
+         * @param prepare called with every connected motor, returning the command to send to it
+         * @return 0 at least one motor got its command
+         * @return INT_MAX error occurred, setting errno
+         */
+        template <typename Prepare> int32_t dispatch(Prepare prepare);
+        /**
+         * @brief Prepare the command of every connected motor, without sending them
+         *
+         * The commands are saved in m_commands, in the same order as the motors returned by getMotors. The mutex has
+         * to be locked before this function is called
+         *
+         * @param plugged the ports with a motor plugged in, from DeviceRegistry::getPluggedPorts
+         * @param prepare called with every connected motor, returning the command to send to it
+         */
+        template <typename Prepare> void prepareCommands(uint32_t plugged, Prepare prepare) {
+            const StaticVector<Motor*, MAX_MOTORS>& motors = getMotors(plugged);
+            // every command is prepared before any is sent, so checking a motor never delays the motors after it. The
+            // commands are stored inside the group, so this never allocates memory
+            m_commands.clear();
+            for (Motor* motor : motors) m_commands.push_back(prepare(*motor));
+        }
+        /**
+         * @brief Finish the commands saved in m_commands, once they have been sent
+         *
+         * The mutex has to be locked before this function is called
+         *
+         * @return true at least one motor got its command
+         * @return false no motor got its command, setting errno
+         */
+        bool finishCommands();
+
+        /**
+         * @brief The settings of the group, which don't depend on the hardware
+         *
+         * They are published through a lock-free buffer, so getters like getBrakeMode never wait for the mutex, and
+         * tasks reading the settings never block each other, or a task commanding the group. Writers hold the mutex,
+         * so there is only ever one writer.
          */
-        const std::vector<MotorInfo> getMotorInfo() const;
+        struct Settings {
+                BrakeMode brakeMode = BrakeMode::COAST;
+                // the combined current limit of the group, or INFINITY if it was never set
+                Current currentLimit = from_amp(INFINITY);
+                AngularVelocity outputVelocity = 0_rpm;
+                // the gains of the velocity filter of every motor, saved so motors which are added later use them too
+                AlphaBetaGains velocityFilterGains;
+                // the settings of the command cache of every motor, saved for the same reason
+                CommandCacheSettings commandCache;
+                // the read cache window of every motor, saved for the same reason
+                Time readCacheWindow = 0_sec;
+                // the command priority of every motor, saved for the same reason
+                uint8_t commandPriority = 0;
+                // the nominal voltage of battery compensation of every motor, saved for the same reason
+                Voltage compensationVoltage = 0_volt;
+                AngleAggregate angleAggregate = AngleAggregate::MEAN;
+                Angle outlierThreshold = from_stDeg(INFINITY);
+                SlewLimits slewLimits;
+                LoadBalanceSettings loadBalance;
+                bool trusted = false;
+        };
 
-        mutable pros::Mutex m_mutex;
-        BrakeMode m_brakeMode = BrakeMode::COAST;
-        AngularVelocity m_outputVelocity;
         /**
-         * This member variable is a vector of motor information
+         * @brief Ramp the velocity of the group towards a target, within the slew limits
          *
-         * Ideally, we'd use a vector of lemlib::Motor objects, but this does not work if you want to remove an element
-         * from the vector as the copy constructor is implicitly deleted.
+         * The mutex has to be locked before this function is called
          *
-         * The ports are signed to indicate whether a motor should be reversed or not.
+         * @param target the velocity of the wheel the group should move at, in meters per second
+         * @param limits the slew limits
+         * @return double the velocity to command, in meters per second
+         */
+        double slew(double target, const SlewLimits& limits);
+
+        /**
+         * @brief Change the settings of the group
          *
-         * It also has a bool for every port, which represents whether the motor was connected or not the last time
-         * `getAngle` was called. This enables the motor group to properly handle a motor reconnect.
+         * The mutex has to be locked before this function is called
          *
-         * It also contains the offset of each motor. This needs to be saved by the motor group, because it can't be
-         * saved in a motor object, as motor objects are not saved as member variables
+         * @param change the function which changes a copy of the settings, before it is published
+         */
+        template <typename F> void updateSettings(F&& change) {
+            Settings settings = m_settings.read();
+            change(settings);
+            m_settings.write(settings);
+        }
+
+        /**
+         * The mutex protects the motors of the group, which are only ever used while it is locked. The motors are
+         * used through their unlocked paths, so each call to the group takes this single lock. It is taken after the
+         * mutex of the maintenance registry, and before the mutexes of motors, see Motor::m_mutex
+         */
+        mutable DeviceMutex m_mutex;
+        DoubleBuffer<Settings> m_settings;
+        /**
+         * The motors of the group and their states
+         *
+         * Every motor in the group is saved as a lemlib::Motor object, which persists for as long as the motor is in
+         * the group. This way, the offset of the motor and any state cached by the motor is kept between calls.
+         *
+         * It also has a flag for every motor, which represents whether the motor was connected or not the last time
+         * `getMotors` was called. This enables the motor group to properly handle a motor reconnect.
+         */
+        mutable MotorStates m_state;
+        /**
+         * Pointers to the motors in m_state which were connected the last time `getMotors` was called. It has room
+         * for every motor, so it can be refilled without allocating memory
+         */
+        mutable StaticVector<Motor*, MAX_MOTORS> m_connectedMotors;
+        // whether m_connectedMotors holds the motors found by the last check, so a trusted group can reuse it
+        mutable bool m_motorsChecked = false;
+        // the commands prepared by dispatch
+        StaticVector<MotorCommand, MAX_MOTORS> m_commands;
+        // the raw readings and angles read by getAngle and setAngle. m_angles is in the same order as m_connectedMotors, while
+        // m_samples only holds the angles which are combined
+        mutable StaticVector<RawReading, MAX_MOTORS> m_readings;
+        mutable StaticVector<Angle, MAX_MOTORS> m_angles;
+        mutable StaticVector<Angle, MAX_MOTORS> m_samples;
+        /**
+         * The port of the reference motor, and the difference between the average angle of the group and the angle of
+         * the reference motor. They are saved whenever getAngle is called, and used to configure motors which
+         * reconnect. The port is 0 if there is no reference motor
+         */
+        mutable std::uint8_t m_referencePort = 0;
+        // set by getMotors when a motor reconnected and needs to be configured by the maintenance task
+        mutable std::atomic<bool> m_reconnectPending = false;
+        /**
+         * What the last check of the motors found, so getSize and isConnected can reuse it without locking while no
+         * motor of the group is plugged in or unplugged. It packs the ports of the group, which of them were plugged
+         * in, and which motors were counted, with a bit which is set while it is valid. It is cleared whenever a motor
+         * is added, removed, marked as disconnected or configured after a reconnect, and published by checkMotors
          */
-        mutable std::vector<MotorInfo> m_motors;
+        mutable std::atomic<uint64_t> m_summary = 0;
+        mutable Angle m_referenceOffset = 0_stDeg;
+        // the latest motion started by moveToAngle. Copies of the group start without a motion
+        MotionStatus m_motion;
+        // the velocity and acceleration of the wheel commanded by the slew limiter, in meters per second and meters
+        // per second squared. Copies of the group start at rest
+        double m_slewVelocity = 0;
+        double m_slewAcceleration = 0;
 };
 }; // namespace lemlib
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "hardware/Motor/MotorGroup.hpp"
+#include "units/Angle.hpp"
+#include "pros/rtos.hpp"
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief The gains of a PositionHold
+ *
+ * The output is a percent power from -1.0 to +1.0. Angles are measured in degrees, after gearing.
+ */
+struct PositionHoldGains {
+        /** the power per degree of error */
+        double kP = 0;
+        /** the power per degree second of accumulated error */
+        double kI = 0;
+        /** the power per degree per second of velocity, which damps the correction */
+        double kD = 0;
+        /** a constant power, like the power which holds a lift up against gravity. It is applied even when idle */
+        double kG = 0;
+};
+
+/**
+ * @brief How a PositionHold corrects the angle of a motor group
+ */
+struct PositionHoldSettings {
+        /** the gains of the controller */
+        PositionHoldGains gains;
+        /** once the error is within this, the hold stops correcting and lets the motors rest */
+        Angle deadband = 1_stDeg;
+        /** the hold starts correcting again once the error is beyond this. It should be larger than the deadband */
+        Angle threshold = 3_stDeg;
+        /** the largest power the hold corrects with */
+        Number maxPower = 0.3;
+        /** the combined current limit of the group while it is held. INFINITY leaves the limit alone */
+        Current currentLimit = from_amp(INFINITY);
+};
+
+/**
+ * @brief A software position hold for a motor group, as an alternative to BrakeMode::HOLD
+ *
+ * BrakeMode::HOLD runs the position controller of the motors all the time, so a lift which is held draws current and
+ * heats up until it is throttled. This hold runs a low gain PID on the brain instead, and only while the angle of the
+ * group is further than the threshold from the target. Once the error is back within the deadband, the motors are
+ * braked with the brake mode of the group and left alone, so they draw no current until the mechanism sags past the
+ * threshold again. BrakeMode::BRAKE works best, as it resists motion without drawing current.
+ *
+ * The hold doesn't have a task. Register update with a ControlScheduler, which runs it at an exact period from the
+ * same task as the other control loops. While idle, update only reads the angle of the group, and doesn't send any
+ * commands.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::MotorGroup lift({1, -2}, 100_rpm);
+ * lemlib::PositionHold liftHold(lift, {.gains = {.kP = 0.02, .kD = 0.0005, .kG = 0.05}, .currentLimit = 2_amp});
+ * lemlib::ControlScheduler scheduler;
+ *
+ * void initialize() {
+ *     lift.setBrakeMode(lemlib::BrakeMode::BRAKE);
+ *     scheduler.add([] { liftHold.update(); }, 10_msec);
+ *     scheduler.start();
+ * }
+ *
+ * void opcontrol() {
+ *     // raise the lift, then hold it where it stopped
+ *     liftHold.release();
+ *     lift.move(0.8);
+ *     pros::delay(500);
+ *     liftHold.hold();
+ * }
+ * @endcode
+ */
+class PositionHold {
+    public:
+        /**
+         * @brief Construct a new Position Hold
+         *
+         * The group is not held until hold is called
+         *
+         * @param motors the motor group to hold. It must outlive the hold
+         * @param settings how the group is held
+         * @param period how often update is called, which is used as the time step of the PID. Defaults to 10 ms,
+         * which is how often motors update
+         */
+        PositionHold(MotorGroup& motors, PositionHoldSettings settings, Time period = 10_msec);
+        PositionHold(const PositionHold& other) = delete;
+        PositionHold& operator=(const PositionHold& other) = delete;
+        /**
+         * @brief Hold the group at the angle it is at
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the angle of the group could not be read
+         *
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t hold();
+        /**
+         * @brief Hold the group at an angle
+         *
+         * The hold corrects the angle straight away, as the group may still be moving, and rests once it is within the
+         * deadband. The current limit of the group is saved, and replaced by the current limit of the hold until it is
+         * released.
+         *
+         * @param angle the angle, measured the same way as MotorGroup::getAngle
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t hold(Angle angle);
+        /**
+         * @brief Stop holding the group, and restore its current limit
+         *
+         * The motors are left moving at whatever they were last commanded, so release the hold before commanding the
+         * group, or the next update overrides the command.
+         *
+         * @return int32_t always returns 0
+         */
+        int32_t release();
+        /**
+         * @brief Get whether the group is held
+         *
+         * @return true the group is held
+         * @return false the group is not held
+         */
+        bool isHolding() const;
+        /**
+         * @brief Get whether the hold is correcting the angle of the group, instead of letting it rest
+         *
+         * @return true the group was just held, or the error went beyond the threshold, and it hasn't come back within
+         * the deadband
+         * @return false the group is resting, or is not held
+         */
+        bool isCorrecting() const;
+        /**
+         * @brief Get the angle the group is held at
+         *
+         * @return Angle the target angle
+         */
+        Angle getTarget() const;
+        /**
+         * @brief Update the hold once
+         *
+         * Call this periodically, like from a ControlScheduler. It does nothing if the group is not held.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the angle of the group could not be read, or none of the motors could be commanded
+         *
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t update();
+    private:
+        MotorGroup& m_motors;
+        const PositionHoldSettings m_settings;
+        const Time m_period;
+        // protects the state of the hold, which is changed by hold and release, and used by update
+        mutable pros::Mutex m_mutex;
+        bool m_holding = false;
+        bool m_correcting = false;
+        Angle m_target = 0_stDeg;
+        // the current limit of the group before it was held, restored when it is released
+        Current m_savedLimit = from_amp(INFINITY);
+        double m_integral = 0;
+};
+} // namespace lemlib
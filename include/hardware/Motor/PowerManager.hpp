@@ -0,0 +1,244 @@
+#pragma once
+
+#include "hardware/DevicePoller.hpp"
+#include "hardware/DoubleBuffer.hpp"
+#include "hardware/Motor/MotorGroup.hpp"
+#include "hardware/Motor/ThermalModel.hpp"
+#include "units/Temperature.hpp"
+#include "pros/rtos.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief How a PowerManager shares current between motor groups
+ *
+ * V5 motors halve their own current limit once they reach 55 degrees celsius, and keep cutting it as they get hotter.
+ * The power manager lowers the limit of a group before that happens, starting at deratingStart, down to
+ * minimumScale of its maximum limit at deratingEnd, so a hot group keeps some power instead of suddenly losing half.
+ * Groups are derated by the temperature a ThermalModel predicts they will reach throttleLookahead from now, so load is
+ * cut a few seconds before a motor heats up, instead of after its coarse reading catches up.
+ */
+struct PowerPolicy {
+        /** the total current every managed group can draw at once */
+        Current budget = 20_amp;
+        /** the temperature of the hottest motor of a group at which its limit starts being lowered */
+        Temperature deratingStart = 45_celsius;
+        /** the temperature of the hottest motor of a group at which its limit is lowered to minimumScale */
+        Temperature deratingEnd = 55_celsius;
+        /** the fraction of its maximum limit a group keeps at deratingEnd */
+        double minimumScale = 0.25;
+        /**
+         * the current each motor may draw above what it is drawing right now, before the spare current of its group is
+         * lent to other groups. Higher values react faster when a group speeds up, but lend less current
+         */
+        Current headroom = 1_amp;
+        /** the smallest change in the limit of a group which is sent to the motors */
+        Current deadband = 0.05_amp;
+        /**
+         * how far ahead the temperature of each group is predicted from its current draw. 0 derates by the estimated
+         * temperature of the group right now
+         */
+        Time throttleLookahead = 5_sec;
+        /** the thermal behavior of every motor, used to predict their temperatures */
+        ThermalParameters thermal = {};
+};
+
+/**
+ * @brief The state of a motor group managed by a PowerManager
+ */
+struct PowerGroupState {
+        /** the current limit of the group, which was sent to its motors */
+        Current limit = 0_amp;
+        /** the current the group was drawing in the latest sample */
+        Current current = 0_amp;
+        /** the temperature of the hottest motor of the group in the latest sample */
+        Temperature maxTemperature = units::from_celsius(INFINITY);
+        /**
+         * the temperature the hottest motor of the group is predicted to reach throttleLookahead from now, if it keeps
+         * drawing the same current. INFINITY if the group has not been updated yet
+         */
+        Temperature predictedTemperature = units::from_celsius(INFINITY);
+        /**
+         * how long until the hottest motor of the group throttles itself, if it keeps drawing the same current.
+         * INFINITY if it never would
+         */
+        Time timeToThrottle = from_sec(INFINITY);
+        /** the fraction of its maximum limit the group is allowed, after derating for temperature */
+        double thermalScale = 1;
+        /** whether any motor of the group was connected in the latest sample */
+        bool connected = false;
+};
+
+/**
+ * @brief PowerManager class
+ *
+ * Checking motor temperatures by hand until the end of a match is easy to forget. The PowerManager watches the
+ * temperature and current draw of every motor of its motor groups, through the samples of a DevicePoller, and shifts
+ * current limits between the groups with setCurrentLimit:
+ *
+ * - the limit of a group is lowered as its hottest motor heats up, or is predicted to heat up, see PowerPolicy
+ * - groups drawing less current than their limit lend the rest to other groups, so a drivetrain can use the current
+ *   an idle intake isn't using, and get it back within a few updates when the intake speeds up
+ * - when groups want more current than the budget, the budget is split by the weight of each group
+ *
+ * update should be called at the rate of the poller, for example by a ControlScheduler. It never allocates memory, and
+ * only sends a new limit to the motors of a group when it changed by more than the deadband.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::MotorGroup drive({1, -2, 3, -4}, 450_rpm);
+ * lemlib::MotorGroup intake({5}, 600_rpm);
+ * lemlib::DevicePoller poller;
+ * lemlib::PowerManager power(poller, {.budget = 12_amp});
+ * lemlib::ControlScheduler scheduler;
+ *
+ * void initialize() {
+ *     // the drivetrain wins twice as much of the budget as the intake when both want more than there is
+ *     power.addGroup(drive, 10_amp, 2);
+ *     power.addGroup(intake, 2.5_amp);
+ *     poller.start();
+ *     scheduler.add([] { power.update(); }, 10_msec);
+ *     scheduler.start();
+ * }
+ * @endcode
+ */
+class PowerManager {
+    public:
+        /** the maximum number of motor groups a power manager can manage */
+        static constexpr size_t MAX_GROUPS = DevicePoller::MAX_MOTOR_GROUPS;
+        /**
+         * @brief Construct a new Power Manager
+         *
+         * @param poller the poller which samples the motor groups. It must outlive the power manager
+         * @param policy how current is shared between the motor groups
+         */
+        PowerManager(DevicePoller& poller, PowerPolicy policy = {});
+        PowerManager(const PowerManager& other) = delete;
+        PowerManager& operator=(const PowerManager& other) = delete;
+        /**
+         * @brief Manage the current limit of a motor group
+         *
+         * The group is registered with the poller too. Groups can be added while update is being called, and are
+         * managed from the next update.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the maximum limit or the weight is not positive
+         * ENOMEM: the power manager or the poller is full
+         *
+         * @param group the motor group. It must outlive the power manager
+         * @param maxLimit the current limit of the group when it is cool, and no other group needs the current
+         * @param weight how much of the budget the group gets when groups want more current than there is, relative to
+         * the other groups. Defaults to 1
+         * @return int32_t the index of the group, which is passed to getGroupState
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     if (power.addGroup(drive, 10_amp) == INT_MAX) std::cout << "Could not manage the drive" << std::endl;
+         * }
+         * @endcode
+         */
+        int32_t addGroup(MotorGroup& group, Current maxLimit, double weight = 1);
+        /**
+         * @brief Set how current is shared between the motor groups
+         *
+         * The policy is used from the next update, and can be changed from any task.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the budget is negative, deratingEnd is not above deratingStart, minimumScale is not between 0 and 1,
+         * throttleLookahead is negative, or the thermal time constant is not positive
+         *
+         * @param policy the policy
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void autonomous() {
+         *     // allow more current during autonomous, as the motors start cool
+         *     power.setPolicy({.budget = 16_amp});
+         * }
+         * @endcode
+         */
+        int32_t setPolicy(PowerPolicy policy);
+        /**
+         * @brief Get how current is shared between the motor groups
+         *
+         * @return PowerPolicy the policy
+         */
+        PowerPolicy getPolicy() const;
+        /**
+         * @brief Get the state of a managed motor group, as of the latest update
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the index does not belong to a managed group
+         *
+         * @param index the index returned by addGroup
+         * @return PowerGroupState the state of the group. The maximum temperature is INFINITY if the index is invalid,
+         * or if the group has not been updated yet
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     const lemlib::PowerGroupState state = power.getGroupState(index);
+         *     std::cout << "Drive limit: " << to_amp(state.limit) << std::endl;
+         * }
+         * @endcode
+         */
+        PowerGroupState getGroupState(int32_t index) const;
+        /**
+         * @brief Recalculate the current limit of every managed group, and send the limits which changed
+         *
+         * Groups which have no connected motors are skipped, and don't use any of the budget. This must not be called
+         * from more than one task at once.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: a limit could not be sent to the motors of a group
+         *
+         * @return int32_t 0 on success
+         * @return INT_MAX if a limit could not be sent, setting errno. The other groups are still updated
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     while (true) {
+         *         power.update();
+         *         pros::delay(10);
+         *     }
+         * }
+         * @endcode
+         */
+        int32_t update();
+    private:
+        struct GroupEntry {
+                MotorGroup* group = nullptr;
+                int32_t pollerIndex = 0;
+                Current maxLimit = 0_amp;
+                double weight = 1;
+                // the limit sent to the motors, only touched by update. INFINITY until a limit has been sent
+                Current applied = from_amp(INFINITY);
+                // the model of the hottest motor of the group, and the time of the sample it was last updated with
+                ThermalModel thermal;
+                Time lastSample = 0_sec;
+                DoubleBuffer<PowerGroupState> state;
+        };
+
+        DevicePoller& m_poller;
+        DoubleBuffer<PowerPolicy> m_policy;
+        // adding groups and setting the policy are locked, as the buffers only support one writer at a time
+        pros::Mutex m_mutex;
+        std::array<GroupEntry, MAX_GROUPS> m_groups;
+        // entries are filled in before the count is incremented, so update only sees complete entries
+        std::atomic<size_t> m_groupCount = 0;
+};
+} // namespace lemlib
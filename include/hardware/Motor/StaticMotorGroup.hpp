@@ -0,0 +1,560 @@
+#pragma once
+
+#include "hardware/DeviceMutex.hpp"
+#include "hardware/Motor/Motor.hpp"
+#include "hardware/Port.hpp"
+#include "units/Angle.hpp"
+#include "units/Temperature.hpp"
+#include "pros/rtos.hpp"
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+namespace lemlib {
+/**
+ * @brief A motor group with a fixed list of ports, known at compile time
+ *
+ * This class behaves like lemlib::MotorGroup, but its ports are template parameters. They are validated at compile
+ * time with the same checks as every other port, and duplicate ports are a compile error. The motors are stored in a
+ * std::array, so the group never allocates memory after it has been constructed, and every group operation is
+ * unrolled at compile time, which lets the compiler inline the work done on each motor.
+ *
+ * Motors can't be added or removed. Use lemlib::MotorGroup for groups which change at runtime, like groups which are
+ * part of a Power Take Off (PTO).
+ *
+ * Like lemlib::MotorGroup, functions succeed as long as one motor in the group works, and errno is set to whatever
+ * error happened last. Motors which reconnect are configured again before they are used: their brake mode is set to
+ * the brake mode of the group, and their angle is set to the average angle of the other connected motors.
+ *
+ * @tparam Ports the ports of the motors in the group. Negative ports are reversed
+ *
+ * @b Example:
+ * @code {.cpp}
+ * // motor group with motors on ports 1, -2, and 3, and a theoretical maximum output of 360 rpm
+ * lemlib::StaticMotorGroup<1, -2, 3> motorGroup(360_rpm);
+ *
+ * void opcontrol() {
+ *     motorGroup.move(0.5);
+ * }
+ * @endcode
+ */
+template <std::int64_t... Ports> class StaticMotorGroup : public Encoder {
+        static_assert(sizeof...(Ports) > 0, "StaticMotorGroup needs at least one motor");
+        static_assert(portsAreUnique<Ports...>, "Ports must be unique!");
+    public:
+        /** the number of motors in the group, including motors which are not connected */
+        static constexpr std::size_t SIZE = sizeof...(Ports);
+
+        /**
+         * @brief Construct a new Static Motor Group
+         *
+         * @param outputVelocity the theoretical maximum output velocity of the motor group, after gearing
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     lemlib::StaticMotorGroup<1, -2, 3> motorGroup(360_rpm);
+         * }
+         * @endcode
+         */
+        StaticMotorGroup(AngularVelocity outputVelocity)
+            : m_outputVelocity(outputVelocity),
+              m_motors {Motor(ReversibleSmartPort(Ports), outputVelocity)...} {}
+
+        /**
+         * @brief move the motors at a percent power from -1.0 to +1.0
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @param percent the power to move the motors at from -1.0 to +1.0
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t move(Number percent) {
+            std::lock_guard lock(m_mutex);
+            return dispatch([&](Motor& motor) { return motor.prepareMoveImpl(percent); });
+        }
+
+        /**
+         * @brief move the motors at a given angular velocity
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @param velocity the target angular velocity to move the motors at
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t moveVelocity(AngularVelocity velocity) {
+            std::lock_guard lock(m_mutex);
+            return dispatch([&](Motor& motor) { return motor.prepareMoveVelocityImpl(velocity); });
+        }
+
+        /**
+         * @brief brake the motors
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t brake() {
+            std::lock_guard lock(m_mutex);
+            return dispatch([](Motor& motor) { return motor.prepareBrakeImpl(); });
+        }
+
+        /**
+         * @brief set the brake mode of the motors
+         *
+         * Motors which are not connected get the brake mode when they reconnect
+         *
+         * @param mode the brake mode to set the motors to
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t setBrakeMode(BrakeMode mode) {
+            std::lock_guard lock(m_mutex);
+            if (mode == BrakeMode::INVALID) {
+                errno = EINVAL;
+                return INT_MAX;
+            }
+            m_brakeMode = mode;
+            // checking the motors sets their brake mode
+            forEach([&](Motor&, std::size_t i) { checkMotor(i); });
+            return 0;
+        }
+
+        /**
+         * @brief get the brake mode of the motor group
+         *
+         * @return BrakeMode the brake mode of the group
+         */
+        BrakeMode getBrakeMode() const {
+            std::lock_guard lock(m_mutex);
+            return m_brakeMode;
+        }
+
+        /**
+         * @brief whether any motor in the group is connected
+         *
+         * @return 0 no motors are connected
+         * @return 1 at least one motor is connected
+         */
+        int32_t isConnected() const override { return getSize() != 0; }
+
+        /**
+         * @brief Get the average angle of the connected motors in the group, after gearing
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @return Angle the angle of the motor group
+         * @return INFINITY error occurred, setting errno
+         */
+        Angle getAngle() const override {
+            std::lock_guard lock(m_mutex);
+            Angle total = 0_stDeg;
+            int count = 0;
+            forEach([&](const Motor& motor, std::size_t i) {
+                if (!checkMotor(i)) return;
+                const Angle angle = motor.getAngle();
+                if (angle == from_stDeg(INFINITY)) return;
+                total += angle;
+                count++;
+            });
+            // if no motors are connected, return INFINITY
+            if (count == 0) return from_stDeg(INFINITY);
+            return total / count;
+        }
+
+        /**
+         * @brief Set the angle of every connected motor in the group, after gearing
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @param angle the new angle of the motor group
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t setAngle(Angle angle) override {
+            std::lock_guard lock(m_mutex);
+            bool success = false;
+            forEach([&](Motor& motor, std::size_t i) {
+                if (checkMotor(i) && motor.setAngleImpl(angle) == 0) success = true;
+            });
+            // as long as one motor sets the angle successfully, return 0 (success)
+            return success ? 0 : INT_MAX;
+        }
+
+        /**
+         * @brief Get the average filtered velocity of the connected motors in the group, after gearing
+         *
+         * Every motor filters its own position, like Motor::getVelocity, so velocity should be read periodically
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @return AngularVelocity the average velocity
+         * @return INFINITY error occurred, setting errno
+         */
+        AngularVelocity getVelocity() const {
+            std::lock_guard lock(m_mutex);
+            AngularVelocity total = 0_rpm;
+            int count = 0;
+            forEach([&](const Motor& motor, std::size_t i) {
+                if (!checkMotor(i)) return;
+                const AngularVelocity velocity = motor.getVelocityImpl();
+                if (velocity.internal() == INFINITY) return;
+                total += velocity;
+                count++;
+            });
+            // if no motors are connected, return INFINITY
+            if (count == 0) return from_rpm(INFINITY);
+            return total / count;
+        }
+
+        /**
+         * @brief Get the average filtered acceleration of the connected motors in the group, after gearing
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @return AngularAcceleration the average acceleration
+         * @return INFINITY error occurred, setting errno
+         */
+        AngularAcceleration getAcceleration() const {
+            std::lock_guard lock(m_mutex);
+            AngularAcceleration total = 0_rps2;
+            int count = 0;
+            forEach([&](const Motor& motor, std::size_t i) {
+                if (!checkMotor(i)) return;
+                const AngularAcceleration acceleration = motor.getAccelerationImpl();
+                if (acceleration.internal() == INFINITY) return;
+                total += acceleration;
+                count++;
+            });
+            // if no motors are connected, return INFINITY
+            if (count == 0) return from_rps2(INFINITY);
+            return total / count;
+        }
+
+        /**
+         * @brief Set the gains of the velocity filter of every motor in the group
+         *
+         * @param gains the gains of the filter
+         * @return int32_t always returns 0
+         */
+        int32_t setVelocityFilter(AlphaBetaGains gains) {
+            std::lock_guard lock(m_mutex);
+            forEach([&](Motor& motor, std::size_t) { motor.setVelocityFilterImpl(gains); });
+            return 0;
+        }
+
+        /**
+         * @brief Get the gains of the velocity filter of the motors in the group
+         *
+         * @return AlphaBetaGains the gains of the filter
+         */
+        AlphaBetaGains getVelocityFilter() const {
+            std::lock_guard lock(m_mutex);
+            // every motor has the same gains, as they can only be set for the whole group
+            return m_motors[0].m_velocityFilter.getGains();
+        }
+
+        /**
+         * @brief Set the command cache of every motor in the group
+         *
+         * @param settings the settings of the cache
+         * @return int32_t always returns 0
+         */
+        int32_t setCommandCache(CommandCacheSettings settings) {
+            std::lock_guard lock(m_mutex);
+            forEach([&](Motor& motor, std::size_t) { motor.setCommandCacheImpl(settings); });
+            return 0;
+        }
+
+        /**
+         * @brief Get the settings of the command cache of the motors in the group
+         *
+         * @return CommandCacheSettings the settings
+         */
+        CommandCacheSettings getCommandCache() const {
+            std::lock_guard lock(m_mutex);
+            return m_motors[0].getCommandCacheImpl();
+        }
+
+        /**
+         * @brief Set the battery voltage power commands of every motor in the group are compensated for
+         *
+         * See Motor::setVoltageCompensation for details.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the nominal voltage is negative or infinite
+         *
+         * @param nominal the battery voltage the gains of the program were tuned at, or 0 volts to disable
+         * compensation
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t setVoltageCompensation(Voltage nominal) {
+            std::lock_guard lock(m_mutex);
+            int32_t result = 0;
+            forEach([&](Motor& motor, std::size_t) {
+                if (motor.setVoltageCompensation(nominal) == INT_MAX) result = INT_MAX;
+            });
+            return result;
+        }
+
+        /**
+         * @brief Get the battery voltage power commands of the motors in the group are compensated for
+         *
+         * @return Voltage the nominal voltage, or 0 volts if compensation is disabled
+         */
+        Voltage getVoltageCompensation() const {
+            std::lock_guard lock(m_mutex);
+            return m_motors[0].getVoltageCompensation();
+        }
+
+        /**
+         * @brief Get the combined current limit of the connected motors
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @return Current the total current limit
+         * @return INFINITY error occurred, setting errno
+         */
+        Current getCurrentLimit() const {
+            std::lock_guard lock(m_mutex);
+            Current total = 0_amp;
+            bool success = false;
+            forEach([&](const Motor& motor, std::size_t i) {
+                if (!checkMotor(i)) return;
+                const Current limit = motor.getCurrentLimit();
+                if (limit.internal() == INFINITY) return;
+                total += limit;
+                success = true;
+            });
+            return success ? total : from_amp(INFINITY);
+        }
+
+        /**
+         * @brief Set the combined current limit of the connected motors
+         *
+         * The limit is split evenly between the connected motors
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: the port cannot be configured as a motor
+         *
+         * @param limit the total current limit
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t setCurrentLimit(Current limit) {
+            std::lock_guard lock(m_mutex);
+            std::array<bool, SIZE> connected;
+            int count = 0;
+            forEach([&](const Motor&, std::size_t i) {
+                connected[i] = checkMotor(i);
+                count += connected[i];
+            });
+            if (count == 0) return INT_MAX;
+            bool success = true;
+            forEach([&](Motor& motor, std::size_t i) {
+                if (connected[i] && motor.setCurrentLimit(limit / count) == INT_MAX) success = false;
+            });
+            return success ? 0 : INT_MAX;
+        }
+
+        /**
+         * @brief Get the temperature of every motor in the group
+         *
+         * @return std::array<Temperature, SIZE> the temperatures, in the same order as the ports. Motors which are not
+         * connected report INFINITY
+         */
+        std::array<Temperature, SIZE> getTemperatures() const {
+            std::lock_guard lock(m_mutex);
+            std::array<Temperature, SIZE> temperatures;
+            forEach([&](const Motor& motor, std::size_t i) {
+                temperatures[i] = checkMotor(i) ? motor.getTemperature() : units::from_celsius(INFINITY);
+            });
+            return temperatures;
+        }
+
+        /**
+         * @brief Get the telemetry of every motor in the group
+         *
+         * @return std::array<MotorTelemetry, SIZE> the telemetry, in the same order as the ports. The values of motors
+         * which are not connected are set to INFINITY
+         */
+        std::array<MotorTelemetry, SIZE> getTelemetry() const {
+            std::lock_guard lock(m_mutex);
+            std::array<MotorTelemetry, SIZE> telemetry;
+            forEach([&](const Motor& motor, std::size_t i) {
+                if (checkMotor(i)) telemetry[i] = motor.getTelemetryImpl();
+                else {
+                    telemetry[i].angle = from_stDeg(INFINITY);
+                    telemetry[i].velocity = from_rpm(INFINITY);
+                    telemetry[i].current = from_amp(INFINITY);
+                    telemetry[i].temperature = units::from_celsius(INFINITY);
+                }
+            });
+            return telemetry;
+        }
+
+        /**
+         * @brief set the output velocity of the motors
+         *
+         * Every motor keeps the angle it measured before the output velocity was changed. The factor motors convert
+         * ticks to angles with is only computed here, so reading the angle of the motor group is a multiply and an add
+         * per motor
+         *
+         * @param outputVelocity the theoretical maximum output velocity of the motor group, after gearing
+         * @return int32_t always returns 0
+         */
+        int32_t setOutputVelocity(AngularVelocity outputVelocity) {
+            std::lock_guard lock(m_mutex);
+            m_outputVelocity = outputVelocity;
+            forEach([&](Motor& motor, std::size_t) { motor.setOutputVelocityImpl(outputVelocity); });
+            return 0;
+        }
+
+        /**
+         * @brief Get the output velocity of the motor group
+         *
+         * @return AngularVelocity the theoretical maximum output velocity of the motor group, after gearing
+         */
+        AngularVelocity getOutputVelocity() const {
+            std::lock_guard lock(m_mutex);
+            return m_outputVelocity;
+        }
+
+        /**
+         * @brief Get the number of connected motors in the group
+         *
+         * @return int32_t the number of connected motors
+         */
+        int32_t getSize() const {
+            std::lock_guard lock(m_mutex);
+            int32_t count = 0;
+            forEach([&](const Motor&, std::size_t i) { count += checkMotor(i); });
+            return count;
+        }
+    private:
+        /**
+         * @brief Call a function on every motor
+         *
+         * The loop is unrolled at compile time, so the index is a constant in every call
+         *
+         * @param f the function, which takes the motor and its index
+         */
+        template <typename F> void forEach(F&& f) const {
+            [&]<std::size_t... I>(std::index_sequence<I...>) {
+                (f(m_motors[I], I), ...);
+            }(std::make_index_sequence<SIZE>());
+        }
+
+        /**
+         * @brief Check if a motor is connected, and configure it if it reconnected
+         *
+         * The mutex has to be locked before this function is called
+         *
+         * @param i the index of the motor
+         * @return true the motor is connected and configured
+         * @return false the motor can't be used
+         */
+        /**
+         * @brief Send a command to every connected motor at once
+         *
+         * The command of every motor is prepared first, and then all of them are sent in one go, so the last motor
+         * gets its command right after the first. Motors which are not connected, or could not be prepared, are not
+         * sent anything. The mutex has to be locked before this function is called
+         *
+         * @param prepare called with every connected motor, returning the command to send to it
+         * @return 0 at least one motor got its command
+         * @return INT_MAX error occurred, setting errno
+         */
+        template <typename Prepare> int32_t dispatch(Prepare prepare) {
+            std::array<MotorCommand, SIZE> commands;
+            forEach([&](Motor& motor, std::size_t i) {
+                // commands of motors which aren't connected are left as NONE, and are never sent
+                commands[i] = checkMotor(i) ? prepare(motor) : MotorCommand {};
+            });
+            Motor::sendCommands(commands);
+            bool success = false;
+            forEach([&](Motor& motor, std::size_t i) {
+                if (motor.finishCommandImpl(commands[i]) == 0) success = true;
+            });
+            // as long as one motor gets its command, return 0 (success)
+            return success ? 0 : INT_MAX;
+        }
+
+        bool checkMotor(std::size_t i) const {
+            Motor& motor = m_motors[i];
+            if (!motor.isConnectedImpl()) {
+                m_connectedLastCycle[i] = false;
+                return false;
+            }
+            // if the motor is connected, but wasn't the last time we checked, then configure it to prevent side
+            // effects of reconnecting
+            if (!m_connectedLastCycle[i] && configureMotor(i) != 0) return false;
+            // check that the brake mode of the motor is correct
+            const BrakeMode mode = motor.getBrakeMode();
+            if (mode != m_brakeMode) {
+                if (motor.setBrakeMode(m_brakeMode) != 0) return false;
+            } else if (mode == BrakeMode::INVALID) return false;
+            m_connectedLastCycle[i] = true;
+            return true;
+        }
+
+        /**
+         * @brief Set the angle of a motor which reconnected to the average angle of the other connected motors
+         *
+         * Only motors which were connected the last time they were checked are used, so this doesn't check the
+         * connection of every other motor. The mutex has to be locked before this function is called
+         *
+         * @param i the index of the motor
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t configureMotor(std::size_t i) const {
+            Angle total = 0_stDeg;
+            int count = 0;
+            forEach([&](const Motor& motor, std::size_t j) {
+                if (j == i || !m_connectedLastCycle[j]) return;
+                const Angle angle = motor.getAngle();
+                if (angle == from_stDeg(INFINITY)) return;
+                total += angle;
+                count++;
+            });
+            return m_motors[i].setAngleImpl(count == 0 ? 0_stDeg : total / count);
+        }
+
+        mutable DeviceMutex m_mutex;
+        BrakeMode m_brakeMode = BrakeMode::COAST;
+        AngularVelocity m_outputVelocity;
+        mutable std::array<Motor, SIZE> m_motors;
+        // motors start as connected, like in MotorGroup, so they keep the angle they had when the program started
+        mutable std::array<bool, SIZE> m_connectedLastCycle = [] {
+            std::array<bool, SIZE> connected;
+            connected.fill(true);
+            return connected;
+        }();
+};
+} // namespace lemlib
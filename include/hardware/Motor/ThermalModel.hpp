@@ -0,0 +1,145 @@
+#pragma once
+
+#include "units/Temperature.hpp"
+#include "units/units.hpp"
+
+namespace lemlib {
+/**
+ * @brief The thermal behavior of a motor, used by ThermalModel
+ *
+ * The defaults are for a V5 smart motor on a robot, and can be fit to a motor by logging its current and temperature
+ * during a long stall.
+ */
+struct ThermalParameters {
+        /** how long the motor takes to get 63% of the way to the temperature its current would settle it at */
+        Time timeConstant = 180_sec;
+        /** how far above ambient the motor settles when it draws 2.5 A, the most a V5 motor can draw, forever */
+        Temperature fullCurrentRise = 60_kelvin;
+        /** the temperature around the motor, which it cools down to when it draws no current */
+        Temperature ambient = 25_celsius;
+        /** the temperature at which the motor halves its own current limit */
+        Temperature throttle = 55_celsius;
+        /**
+         * the step the motor reports its temperature in. A reading means the temperature is from the reading to the
+         * reading plus the step. V5 motors report in steps of 5 degrees
+         */
+        Temperature resolution = 5_kelvin;
+};
+
+/**
+ * @brief A first order thermal model of a motor, which estimates its temperature between coarse readings
+ *
+ * Motors only report their temperature in coarse steps, so a motor which is about to throttle can look the same as one
+ * which just warmed up. The model treats the motor as a thermal resistor and capacitor: the heat of its windings grows
+ * with the square of its current, and it cools towards ambient with a time constant. Every update integrates the
+ * model over the time since the previous one, and then keeps the estimate within the step of the latest reading, so
+ * the estimate can't drift away from the motor. From the estimate, the model predicts the temperature the motor
+ * reaches if it keeps drawing the same current, and how long it takes to throttle.
+ *
+ * Updating never allocates memory and takes constant time. A model must not be updated from more than one task at
+ * once.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::Motor intake(5, 600_rpm);
+ * lemlib::ThermalModel thermal;
+ *
+ * void opcontrol() {
+ *     while (true) {
+ *         thermal.update(intake.getCurrent(), intake.getTemperature(), 10_msec);
+ *         // ease off the intake once it would throttle within 5 seconds
+ *         if (thermal.timeToThrottle(intake.getCurrent()) < 5_sec) intake.setCurrentLimit(1.5_amp);
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class ThermalModel {
+    public:
+        /**
+         * @brief Construct a new Thermal Model
+         *
+         * @param parameters the thermal behavior of the motor. The time constant must be positive
+         */
+        constexpr ThermalModel(ThermalParameters parameters = {})
+            : m_parameters(parameters) {}
+
+        /**
+         * @brief Set the thermal behavior of the motor
+         *
+         * The estimate is kept, and integrated with the new parameters from the next update.
+         *
+         * @param parameters the thermal behavior. The time constant must be positive
+         */
+        constexpr void setParameters(const ThermalParameters& parameters) { m_parameters = parameters; }
+
+        /**
+         * @brief Get the thermal behavior of the motor
+         *
+         * @return ThermalParameters the parameters
+         */
+        constexpr ThermalParameters getParameters() const { return m_parameters; }
+
+        /**
+         * @brief Integrate the model over the time since the previous update, and correct it with a reading
+         *
+         * The first update starts the estimate in the middle of the step of the reading. Readings which aren't finite,
+         * like the INFINITY of a motor which is unplugged, are ignored.
+         *
+         * @param current the current the motor drew since the previous update
+         * @param measured the temperature the motor reports
+         * @param dt the time since the previous update. Ignored by the first update
+         */
+        void update(Current current, Temperature measured, Time dt);
+
+        /**
+         * @brief Forget the estimate, so the next update starts from its reading
+         */
+        constexpr void reset() { m_initialized = false; }
+
+        /**
+         * @brief Get whether the model has been updated with a reading
+         *
+         * @return true the model has an estimate
+         * @return false the model hasn't been updated yet
+         */
+        constexpr bool isInitialized() const { return m_initialized; }
+
+        /**
+         * @brief Get the estimated temperature of the motor
+         *
+         * @return Temperature the temperature, or NaN if the model hasn't been updated yet
+         */
+        Temperature getTemperature() const;
+
+        /**
+         * @brief Predict the temperature of the motor, if it keeps drawing a current
+         *
+         * @param current the current
+         * @param horizon how far ahead to predict
+         * @return Temperature the temperature, or NaN if the model hasn't been updated yet
+         */
+        Temperature predict(Current current, Time horizon) const;
+
+        /**
+         * @brief Predict how long the motor takes to reach its throttle temperature, if it keeps drawing a current
+         *
+         * @param current the current
+         * @return Time the time. 0 if the motor is estimated to be throttling already, and INFINITY if the current
+         * would never make it throttle, or if the model hasn't been updated yet
+         */
+        Time timeToThrottle(Current current) const;
+    private:
+        /**
+         * @brief Get the temperature the motor settles at if it keeps drawing a current
+         *
+         * @param current the current
+         * @return Temperature the temperature
+         */
+        Temperature steadyState(Current current) const;
+
+        ThermalParameters m_parameters;
+        Temperature m_temperature = 0_kelvin;
+        bool m_initialized = false;
+};
+} // namespace lemlib
@@ -0,0 +1,223 @@
+#pragma once
+
+#include "hardware/DoubleBuffer.hpp"
+#include "hardware/Motor/Motor.hpp"
+#include "hardware/Motor/MotorGroup.hpp"
+#include "units/Angle.hpp"
+#include "pros/rtos.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief The gains of a VelocityController
+ *
+ * The output is a percent power from -1.0 to +1.0. Velocities are measured in rpm, after gearing, so a kV of 1 / 600
+ * gives full power at 600 rpm.
+ */
+struct VelocityControllerGains {
+        /** the power needed to overcome static friction, added in the direction of the target velocity */
+        double kS = 0;
+        /** the power per rpm of target velocity */
+        double kV = 0;
+        /** the power per rpm per second of target acceleration */
+        double kA = 0;
+        /** the power per rpm of velocity error */
+        double kP = 0;
+        /** the power per rpm second of accumulated velocity error */
+        double kI = 0;
+        /** the power per rpm per second of change in velocity error */
+        double kD = 0;
+};
+
+/**
+ * @brief The timing of the task of a VelocityController, measured with pros::micros
+ */
+struct VelocityControllerTiming {
+        /** the time between the two latest updates */
+        Time lastPeriod = 0_sec;
+        /** the largest difference between the time between updates and the period, since the controller started */
+        Time maxJitter = 0_sec;
+        /** how long the latest update took */
+        Time lastExecution = 0_sec;
+        /** how long the slowest update took, since the controller started */
+        Time maxExecution = 0_sec;
+        /** the number of updates since the controller started */
+        uint32_t updates = 0;
+};
+
+/**
+ * @brief A velocity controller for a motor or motor group, running on the brain instead of the motor
+ *
+ * The internal velocity controller of the motors can't be tuned, and only sees its target when it is sent. This
+ * controller combines a kS/kV/kA feedforward with a PID on the velocity error, and sends the result with move(). It
+ * runs in its own task at a fixed period, with a priority above the default, so it is updated on time no matter what
+ * else the program is doing.
+ *
+ * The integral is not accumulated while the output is saturated, so it doesn't wind up when the target can't be
+ * reached. The target and the gains can be changed from any task.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::MotorGroup flywheel({1, -2}, 3600_rpm);
+ * lemlib::VelocityController controller(flywheel, {.kS = 0.02, .kV = 1.0 / 3600, .kP = 0.001});
+ *
+ * void initialize() {
+ *     controller.start();
+ *     controller.setTarget(3000_rpm);
+ * }
+ * @endcode
+ */
+class VelocityController {
+    public:
+        /**
+         * @brief Construct a new Velocity Controller for a motor
+         *
+         * The controller does not move the motor until start is called
+         *
+         * @param motor the motor to control. It must outlive the controller
+         * @param gains the gains of the controller
+         * @param period how often the controller is updated. Defaults to 10 ms, which is how often motors update
+         */
+        VelocityController(Motor& motor, VelocityControllerGains gains, Time period = 10_msec);
+        /**
+         * @brief Construct a new Velocity Controller for a motor group
+         *
+         * @param motors the motor group to control. It must outlive the controller
+         * @param gains the gains of the controller
+         * @param period how often the controller is updated. Defaults to 10 ms, which is how often motors update
+         */
+        VelocityController(MotorGroup& motors, VelocityControllerGains gains, Time period = 10_msec);
+        VelocityController(const VelocityController& other) = delete;
+        VelocityController& operator=(const VelocityController& other) = delete;
+        /**
+         * @brief Destroy the Velocity Controller, stopping its task
+         */
+        ~VelocityController();
+        /**
+         * @brief Set the target of the controller
+         *
+         * This function can be called from any task. The controller task reads the target without locking, so it never
+         * waits on this function.
+         *
+         * @param velocity the target velocity
+         * @param acceleration the target acceleration, used by the kA feedforward. Defaults to 0
+         * @return int32_t always returns 0
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     // spin up to 3000 rpm, accelerating at 1000 rpm per second
+         *     controller.setTarget(3000_rpm, 1000_rpm / 1_sec);
+         * }
+         * @endcode
+         */
+        int32_t setTarget(AngularVelocity velocity, AngularAcceleration acceleration = 0_rps2);
+        /**
+         * @brief Get the target velocity of the controller
+         *
+         * @return AngularVelocity the target velocity
+         */
+        AngularVelocity getTarget() const;
+        /**
+         * @brief Set the gains of the controller
+         *
+         * The integral is reset, as it was accumulated with the old gains
+         *
+         * @param gains the gains
+         * @return int32_t always returns 0
+         */
+        int32_t setGains(VelocityControllerGains gains);
+        /**
+         * @brief Get the gains of the controller
+         *
+         * @return VelocityControllerGains the gains
+         */
+        VelocityControllerGains getGains() const;
+        /**
+         * @brief Get the timing of the controller task
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * @return VelocityControllerTiming the timing
+         */
+        VelocityControllerTiming getTiming() const;
+        /**
+         * @brief Update the controller once
+         *
+         * This is called periodically by the controller task, but can also be called manually if the controller is
+         * not started. It must not be called from more than one task at once.
+         *
+         * @return 0 the target was moved
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t update();
+        /**
+         * @brief Start the controller task
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EBUSY: the controller is already running
+         * ENOMEM: the task could not be created
+         *
+         * @param priority the priority of the controller task. Defaults to two above the default priority, so it runs
+         * ahead of a DevicePoller
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t start(uint32_t priority = TASK_PRIORITY_DEFAULT + 2);
+        /**
+         * @brief Stop the controller task, and stop the motors
+         *
+         * This function blocks until the current update finishes
+         */
+        void stop();
+    private:
+        /**
+         * @brief the function run by the controller task
+         *
+         * @param controller pointer to the controller
+         */
+        static void taskFunction(void* controller);
+        /**
+         * @brief Move the target of the controller at a percent power
+         *
+         * @tparam T the type of the target
+         * @param target the target
+         * @param power the power
+         * @return int32_t the result of move
+         */
+        template <typename T> static int32_t moveTarget(Encoder& target, Number power);
+        /**
+         * @brief Measure the velocity of the target of the controller
+         *
+         * @tparam T the type of the target
+         * @param target the target
+         * @return AngularVelocity the velocity, or INFINITY on failure
+         */
+        template <typename T> static AngularVelocity measureTarget(const Encoder& target);
+
+        struct Setpoint {
+                AngularVelocity velocity = 0_rpm;
+                AngularAcceleration acceleration = 0_rps2;
+        };
+
+        Encoder& m_target;
+        int32_t (*const m_move)(Encoder&, Number);
+        AngularVelocity (*const m_measure)(const Encoder&);
+        const Time m_period;
+        // the gains and the target are written by any task, and read by the controller task without locking
+        DoubleBuffer<VelocityControllerGains> m_gains;
+        DoubleBuffer<Setpoint> m_setpoint;
+        DoubleBuffer<VelocityControllerTiming> m_timing;
+        pros::Mutex m_mutex;
+        // the state of the PID, which is only touched by update
+        std::atomic<bool> m_resetIntegral = true;
+        double m_integral = 0;
+        double m_lastError = 0;
+        uint64_t m_lastUpdate = 0;
+        // the task is not deleted from outside, as it could be holding a device mutex. Instead it is asked to exit
+        std::atomic<bool> m_running = false;
+        std::atomic<bool> m_taskExited = true;
+};
+} // namespace lemlib
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "hardware/DeferredInit.hpp"
+#include "pros/rtos.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// the number of mutexes in the pool. Devices which are created while every mutex is in use get one from the heap
+#ifndef LEMLIB_MUTEX_POOL_SIZE
+#define LEMLIB_MUTEX_POOL_SIZE 64
+#endif
+
+namespace lemlib {
+/**
+ * @brief Statistics of the mutex pool
+ */
+struct MutexPoolStats {
+        /** the number of mutexes the pool can hold */
+        size_t capacity = 0;
+        /** the number of mutexes which have been created in the pool. They are never destroyed */
+        size_t created = 0;
+        /** the number of mutexes of the pool which are leased right now */
+        size_t inUse = 0;
+        /** the most mutexes of the pool which were leased at once */
+        size_t peak = 0;
+        /** the number of mutexes which were created on the heap, because every mutex of the pool was in use */
+        size_t overflows = 0;
+};
+
+/**
+ * @brief A mutex leased from a static pool
+ *
+ * Every device holds a mutex, and a pros::Mutex creates an RTOS mutex on the heap when it is constructed, and frees it
+ * when it is destroyed. Over a long event day, creating and destroying devices fragments the heap. A pooled mutex
+ * leases one of LEMLIB_MUTEX_POOL_SIZE mutexes from a static pool instead, and returns it when it is destroyed. The
+ * RTOS mutex of a slot is only created the first time the slot is used and is never destroyed, so once the most
+ * devices a program uses at once have been created, creating devices never touches the heap again.
+ *
+ * Unlike pros::Mutex, a pooled mutex can be moved, so devices which hold one can be stored in vectors. A moved-from
+ * pooled mutex must not be locked.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * void initialize() {
+ *     // create the mutexes of every device up front, before the heap is used for anything else
+ *     lemlib::reserveMutexes(16);
+ * }
+ * @endcode
+ */
+class PooledMutex {
+    public:
+        /**
+         * @brief Lease a mutex from the pool, or create one on the heap if every mutex of the pool is in use
+         */
+        PooledMutex();
+        /**
+         * @brief Construct a pooled mutex which doesn't hold a mutex yet, so it can be constant initialized
+         *
+         * It must be initialized before it is locked
+         */
+        constexpr explicit PooledMutex(DeferredInit) {}
+        PooledMutex(const PooledMutex& other) = delete;
+        PooledMutex& operator=(const PooledMutex& other) = delete;
+        /**
+         * @brief Take over the mutex of another pooled mutex
+         *
+         * @param other the pooled mutex to move from. It must not be locked afterwards
+         */
+        PooledMutex(PooledMutex&& other) noexcept;
+        /**
+         * @brief Return the mutex this holds, and take over the mutex of another pooled mutex
+         *
+         * @param other the pooled mutex to move from. It must not be locked afterwards
+         * @return PooledMutex& this
+         */
+        PooledMutex& operator=(PooledMutex&& other) noexcept;
+        /**
+         * @brief Return the mutex to the pool
+         */
+        ~PooledMutex();
+        /**
+         * @brief Lease a mutex, if this doesn't hold one yet
+         */
+        void initialize();
+        /**
+         * @brief Lock the mutex, waiting for as long as it takes
+         */
+        void lock();
+        /**
+         * @brief Unlock the mutex
+         */
+        void unlock();
+        /**
+         * @brief Try to lock the mutex, without waiting
+         *
+         * @return true the mutex was locked
+         * @return false the mutex is locked by another task
+         */
+        bool try_lock();
+    private:
+        /**
+         * @brief Return the mutex to the pool, or free it if it is from the heap
+         */
+        void release();
+
+        pros::Mutex* m_mutex = nullptr;
+        // the index of the slot in the pool, or SIZE_MAX if the mutex is from the heap
+        size_t m_slot = SIZE_MAX;
+};
+
+/**
+ * @brief Create mutexes in the pool up front, so devices created later don't touch the heap
+ *
+ * @param count the number of mutexes which should exist in the pool. Capped at LEMLIB_MUTEX_POOL_SIZE
+ * @return size_t the number of mutexes which exist in the pool afterwards
+ */
+size_t reserveMutexes(size_t count);
+
+/**
+ * @brief Get statistics of the mutex pool
+ *
+ * @return MutexPoolStats the statistics
+ */
+MutexPoolStats getMutexPoolStats();
+} // namespace lemlib
@@ -0,0 +1,621 @@
+#pragma once
+
+#include "hardware/DoubleBuffer.hpp"
+#include "hardware/Topic.hpp"
+#include "hardware/Encoder/Encoder.hpp"
+#include "hardware/Encoder/EncoderHistory.hpp"
+#include "hardware/IMU/IMU.hpp"
+#include "hardware/Odometry/PoseHistory.hpp"
+#include "units/Accumulator.hpp"
+#include "units/Pose.hpp"
+#include "pros/rtos.hpp"
+#include <atomic>
+#include <vector>
+
+namespace lemlib {
+class SlipDetector;
+class DevicePoller;
+
+/**
+ * @brief A tracking wheel used by Odometry
+ *
+ * A tracking wheel is any encoder which measures how far a wheel has travelled, for example a V5RotationSensor, an
+ * ADIEncoder, or a MotorGroup powering a drivetrain.
+ */
+class TrackingWheel {
+    public:
+        /**
+         * @brief Construct a new Tracking Wheel
+         *
+         * The offset is measured from the tracking center of the robot, perpendicular to the direction the wheel
+         * measures. Vertical wheels have a positive offset when they are left of the tracking center, and horizontal
+         * wheels have a positive offset when they are in front of the tracking center.
+         *
+         * @param encoder the encoder which measures the wheel. It must outlive the tracking wheel
+         * @param diameter the diameter of the wheel
+         * @param offset the offset of the wheel from the tracking center
+         *
+         * @b Example:
+         * @code {.cpp}
+         * lemlib::V5RotationSensor encoder(1);
+         * // a 2.75" tracking wheel, 3" left of the tracking center
+         * lemlib::TrackingWheel wheel(encoder, 2.75_in, 3_in);
+         * @endcode
+         */
+        TrackingWheel(Encoder& encoder, Length diameter, Length offset);
+        /**
+         * @brief Construct a new Tracking Wheel which is watched by a slip detector
+         *
+         * While the detector says the wheel slips, Odometry measures the distance travelled with the other tracking
+         * wheels in the same direction instead, if it has any that aren't slipping, and doesn't measure heading with
+         * the wheel.
+         *
+         * @param encoder the encoder which measures the wheel. It must outlive the tracking wheel
+         * @param diameter the diameter of the wheel
+         * @param offset the offset of the wheel from the tracking center
+         * @param slipDetector the detector watching the motors which drive the wheel. It must outlive the tracking
+         * wheel
+         *
+         * @b Example:
+         * @code {.cpp}
+         * lemlib::SlipDetector leftSlip(leftDrive, imu, 3.25_in);
+         * // the left side of the drivetrain, 5" left of the tracking center
+         * lemlib::TrackingWheel wheel(leftDrive, 3.25_in, 5_in, leftSlip);
+         * @endcode
+         */
+        TrackingWheel(Encoder& encoder, Length diameter, Length offset, const SlipDetector& slipDetector);
+        /**
+         * @brief Construct a new Tracking Wheel which is read from the history of its encoder
+         *
+         * A DevicePoller samples each encoder at a slightly different time, and an IMU is read later still. While the
+         * robot turns quickly, those few hundred microseconds are enough for the wheels to disagree about the motion.
+         * Odometry interpolates the history of every wheel which has one to the same instant, the latest time they
+         * all have a sample for, and carries the heading of the IMU back to it, so the wheels and the IMU measure the
+         * same motion. The history has to be filled by a DevicePoller at least as often as odometry is updated.
+         *
+         * @param encoder the encoder which measures the wheel, read directly while the history is empty or stops
+         * being filled. It must outlive the tracking wheel
+         * @param diameter the diameter of the wheel
+         * @param offset the offset of the wheel from the tracking center
+         * @param history the history the encoder is sampled into. It must outlive the tracking wheel
+         *
+         * @b Example:
+         * @code {.cpp}
+         * lemlib::V5RotationSensor encoder(1);
+         * lemlib::EncoderHistory<8> history;
+         * lemlib::TrackingWheel wheel(encoder, 2.75_in, 3_in, history);
+         *
+         * void initialize() {
+         *     poller.addEncoder(encoder, history);
+         *     poller.start();
+         * }
+         * @endcode
+         */
+        TrackingWheel(Encoder& encoder, Length diameter, Length offset, const EncoderHistoryBase& history);
+        /**
+         * @brief Construct a new Tracking Wheel which is read from the history of its encoder, and watched by a slip
+         * detector
+         *
+         * See the constructors which take a history and a slip detector separately for details.
+         *
+         * @param encoder the encoder which measures the wheel. It must outlive the tracking wheel
+         * @param diameter the diameter of the wheel
+         * @param offset the offset of the wheel from the tracking center
+         * @param history the history the encoder is sampled into. It must outlive the tracking wheel
+         * @param slipDetector the detector watching the motors which drive the wheel. It must outlive the tracking
+         * wheel
+         */
+        TrackingWheel(Encoder& encoder, Length diameter, Length offset, const EncoderHistoryBase& history,
+                      const SlipDetector& slipDetector);
+        /**
+         * @brief Get the distance travelled by the tracking wheel
+         *
+         * @return Length the distance travelled
+         * @return INFINITY on failure, setting errno
+         */
+        Length getDistance() const;
+        /**
+         * @brief Get the distance travelled by the tracking wheel at a time, interpolated from its history
+         *
+         * The encoder is read directly if the wheel has no history.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the history is empty
+         * ERANGE: the time is not covered by the history
+         *
+         * @param timestamp the time, since the program started
+         * @return Length the distance travelled
+         * @return INFINITY on failure, setting errno
+         */
+        Length getDistance(Time timestamp) const;
+        /**
+         * @brief Get when the latest sample in the history of the tracking wheel was taken
+         *
+         * @return Time the time of the latest sample, since the program started
+         * @return INFINITY if the wheel has no history, or it is empty
+         */
+        Time getLatestTimestamp() const;
+        /**
+         * @brief Get the offset of the tracking wheel from the tracking center
+         *
+         * @return Length the offset
+         */
+        Length getOffset() const;
+        /**
+         * @brief Whether the slip detector of the wheel says it is slipping
+         *
+         * @return true the wheel is slipping
+         * @return false the wheel is gripping, or has no slip detector
+         */
+        bool isSlipping() const;
+    private:
+        Encoder* m_encoder;
+        Length m_diameter;
+        Length m_offset;
+        const SlipDetector* m_slipDetector = nullptr;
+        const EncoderHistoryBase* m_history = nullptr;
+};
+
+/**
+ * @brief How Odometry picks its update rate from the velocity of the robot
+ *
+ * The robot is moving as soon as one update measures a speed or a turn rate above the thresholds, and at rest once
+ * every update has been below both for restDelay.
+ */
+struct AdaptiveRate {
+        /** the period while the robot moves. Defaults to 5 ms, which is 200 Hz */
+        Time movingPeriod = 5_msec;
+        /** the period while the robot is at rest. Defaults to 50 ms, which is 20 Hz */
+        Time restingPeriod = 50_msec;
+        /** the speed below which the robot can be at rest. Defaults to 1 inch per second */
+        LinearVelocity restSpeed = 1_inps;
+        /** the turn rate below which the robot can be at rest. Defaults to 5 degrees per second */
+        AngularVelocity restTurnRate = 5_degps;
+        /** how long the robot has to stay below both thresholds to be at rest. Defaults to 250 ms */
+        Time restDelay = 250_msec;
+};
+
+/**
+ * @brief Odometry class
+ *
+ * Odometry combines tracking wheels and an optional IMU to track the pose of the robot. The pose is integrated in
+ * update, which is called periodically by a dedicated task once start is called. The pose is published through a
+ * lock-free topic, so getPose can be called from any task without waiting for the integration step, and tasks can wait
+ * on the topic for the next pose.
+ *
+ * Poses use standard position: x and y are measured on the field, and the orientation is measured counterclockwise
+ * from the positive x axis. If no IMU is used, at least two parallel tracking wheels are needed to measure heading.
+ *
+ * Memory is only allocated when the odometry is constructed, never in the integration step.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::V5RotationSensor verticalEncoder(1);
+ * lemlib::V5RotationSensor horizontalEncoder(2);
+ * lemlib::V5InertialSensor imu(3);
+ * lemlib::Odometry odom({{verticalEncoder, 2.75_in, 0_in}}, {{horizontalEncoder, 2.75_in, -2_in}}, imu);
+ *
+ * void initialize() {
+ *     odom.start();
+ *     while (true) {
+ *         const units::Pose pose = odom.getPose();
+ *         std::cout << to_in(pose.x) << ", " << to_in(pose.y) << std::endl;
+ *         pros::delay(50);
+ *     }
+ * }
+ * @endcode
+ */
+class Odometry {
+    public:
+        /**
+         * @brief Construct a new Odometry object which measures heading with an IMU
+         *
+         * @param verticals the tracking wheels which measure forward motion
+         * @param horizontals the tracking wheels which measure sideways motion. Can be empty
+         * @param imu the IMU which measures heading. It must outlive the odometry
+         */
+        Odometry(const std::vector<TrackingWheel>& verticals, const std::vector<TrackingWheel>& horizontals, IMU& imu);
+        /**
+         * @brief Construct a new Odometry object which measures heading with tracking wheels
+         *
+         * Heading is measured with the first two vertical tracking wheels, or the first two horizontal tracking wheels
+         * if there are less than two vertical tracking wheels.
+         *
+         * @param verticals the tracking wheels which measure forward motion
+         * @param horizontals the tracking wheels which measure sideways motion. Can be empty
+         */
+        Odometry(const std::vector<TrackingWheel>& verticals, const std::vector<TrackingWheel>& horizontals);
+        Odometry(const Odometry& other) = delete;
+        Odometry& operator=(const Odometry& other) = delete;
+        /**
+         * @brief Destroy the Odometry object, stopping its task
+         */
+        ~Odometry();
+        /**
+         * @brief Get the latest pose of the robot
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * @return units::Pose the pose of the robot
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     const units::Pose pose = odom.getPose();
+         *     std::cout << to_in(pose.x) << ", " << to_in(pose.y) << ", " << to_stDeg(pose.orientation) << std::endl;
+         * }
+         * @endcode
+         */
+        units::Pose getPose() const;
+        /**
+         * @brief Get the pose of the robot at a past time, from the history
+         *
+         * Poses between two updates are interpolated, and times after the latest update get the latest pose.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: no history was set, or it is empty
+         * ERANGE: the time is older than the oldest pose in the history
+         *
+         * @param timestamp the time, since the program started
+         * @return units::Pose the pose at that time. INFINITY on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     // where the robot was 50 ms ago
+         *     const units::Pose pose = odom.getPose(from_usec(pros::micros()) - 50_msec);
+         * }
+         * @endcode
+         */
+        units::Pose getPose(Time timestamp) const;
+        /**
+         * @brief Predict where the robot will be after a latency
+         *
+         * Commands take a few milliseconds to reach the motors, and the latest pose is already as old as the last
+         * update, so a controller which compares the trajectory to the latest pose reacts to where the robot was.
+         * The pose is predicted from the history, with PoseHistoryBase::predictPose, at the current time plus the
+         * latency.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: no history was set, or it is empty
+         *
+         * @param latency how far ahead of the current time to predict the pose
+         * @param window how far back the velocity is measured over. Defaults to 20 ms
+         * @return units::Pose the predicted pose. The position is INFINITY on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void autonomous() {
+         *     const units::Pose pose = odom.predictPose(15_msec);
+         *     drive.moveVelocity(ramsete.calculate(pose, trajectory.sample(elapsed + 15_msec)), 3.25_in);
+         * }
+         * @endcode
+         */
+        units::Pose predictPose(Time latency, Time window = 20_msec) const;
+        /**
+         * @brief Get the topic the pose is published to after every update
+         *
+         * Tasks which only need to act when the pose changes can wait on the topic, instead of polling getPose
+         *
+         * @return const Topic<units::Pose>& the topic
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void displayTask() {
+         *     uint32_t version = 0;
+         *     units::Pose pose;
+         *     while (odom.getPoseTopic().waitForNext(version, pose)) {
+         *         pros::lcd::print(0, "x: %f", to_in(pose.x));
+         *     }
+         * }
+         * @endcode
+         */
+        const Topic<units::Pose>& getPoseTopic() const;
+        /**
+         * @brief Set the pose of the robot
+         *
+         * @param pose the new pose of the robot
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void autonomous() {
+         *     // the robot starts in the corner of the field, facing forwards
+         *     odom.setPose({0_in, 0_in, 90_stDeg});
+         * }
+         * @endcode
+         */
+        void setPose(units::Pose pose);
+        /**
+         * @brief Record every integrated pose in a history
+         *
+         * The history is cleared when the pose is set, since poses from before are measured from a different origin.
+         *
+         * @param history the history to write to. It must outlive the odometry
+         *
+         * @b Example:
+         * @code {.cpp}
+         * lemlib::PoseHistory<64> history;
+         *
+         * void initialize() {
+         *     odom.setHistory(history);
+         *     odom.start();
+         * }
+         * @endcode
+         */
+        void setHistory(PoseHistoryBase& history);
+        /**
+         * @brief Correct the distances measured by the tracking wheels for the tilt of the robot
+         *
+         * A robot climbing a barrier travels along the slope, so its wheels measure more than it moved across the
+         * field. Every update projects the forward and sideways distances onto the field with the orientation the
+         * poller integrates for the IMU, which takes two rotations of a vector and two square roots, and no trig.
+         * Samples without an orientation, like those of a disconnected IMU, aren't corrected. The IMU has to be mounted
+         * with its x axis facing forwards, like the tracking center.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the index is negative
+         *
+         * @param poller the poller. It must outlive the odometry
+         * @param index the index returned by DevicePoller::addOrientationIMU
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     odom.setTiltSource(poller, poller.addOrientationIMU(imu));
+         *     poller.start();
+         *     odom.start();
+         * }
+         * @endcode
+         */
+        int32_t setTiltSource(const DevicePoller& poller, int32_t index);
+        /**
+         * @brief Correct the pose with a measurement of where the robot was at a past time
+         *
+         * The motion odometry measured since the measurement was taken is applied on top of the measured pose, so a
+         * delayed measurement, like one from a vision sensor, corrects the pose without moving the robot back to where
+         * it was. The pose at the time is looked up in the history, instead of rerunning odometry.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: no history was set, or it is empty
+         * ERANGE: the measurement is older than the oldest pose in the history
+         *
+         * @param timestamp the time the measurement was taken, since the program started
+         * @param measured the pose of the robot at that time
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void onGpsReading(Time taken, units::Pose measured) {
+         *     odom.correctPose(taken, measured);
+         * }
+         * @endcode
+         */
+        int32_t correctPose(Time timestamp, units::Pose measured);
+        /**
+         * @brief Pick the update rate from the velocity of the robot, instead of a fixed period
+         *
+         * Integrating at full rate while the robot is still wastes time other loops could use, and a slow rate while
+         * it moves adds error, as every step assumes the robot moved along one arc. Every update measures the speed
+         * and turn rate of the robot from how far it moved since the previous update, and picks the moving or the
+         * resting period of the settings. The odometry task sleeps for the current period. From a ControlScheduler,
+         * register updateIfDue at the moving period instead of update, so the ticks in between cost only a check of
+         * the time. If a poller is passed, its period is set to the current period too, so the devices odometry
+         * reads are sampled only as often as they are used. Only pass a poller which samples nothing faster.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: a period is shorter than 1 ms or not finite, the resting period is shorter than the moving period,
+         * or a threshold or the delay is negative
+         *
+         * @param settings the periods and thresholds
+         * @param poller the poller to set the period of, or nullptr to leave it alone. It must outlive the odometry
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno. The rate is not changed
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *     // 200 Hz while driving, 20 Hz while the robot waits
+         *     odom.setAdaptiveRate({.movingPeriod = 5_msec, .restingPeriod = 50_msec});
+         *     scheduler.add([] { odom.updateIfDue(); }, 5_msec, lemlib::CallbackPriority::CRITICAL);
+         *     scheduler.start();
+         * }
+         * @endcode
+         */
+        int32_t setAdaptiveRate(AdaptiveRate settings, DevicePoller* poller = nullptr);
+        /**
+         * @brief Go back to integrating at the fixed period passed to start
+         *
+         * The period of the poller passed to setAdaptiveRate is left as it is.
+         */
+        void clearAdaptiveRate();
+        /**
+         * @brief Get the period odometry is integrated at
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * @return Time the current period of the adaptive rate, or the period passed to start if it isn't adaptive
+         */
+        Time getPeriod() const;
+        /**
+         * @brief Get whether the robot is at rest, as measured by the adaptive rate
+         *
+         * @return true the robot has been below the thresholds of the adaptive rate for its delay
+         * @return false the robot is moving, or the rate isn't adaptive
+         */
+        bool isResting() const;
+        /**
+         * @brief Integrate the pose of the robot once
+         *
+         * This is called periodically by the odometry task, but can also be called manually if the odometry is not
+         * started.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: heading can't be measured, since there is no IMU and there are less than two parallel tracking
+         * wheels
+         *
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t update();
+        /**
+         * @brief Integrate the pose of the robot if the current period has passed since the last update
+         *
+         * This is meant to be called by a ControlScheduler at the moving period of an adaptive rate, so odometry runs
+         * slower at rest without changing the schedule.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: heading can't be measured, since there is no IMU and there are less than two parallel tracking
+         * wheels
+         *
+         * @return int32_t 0 on success, or if no update was due
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t updateIfDue();
+        /**
+         * @brief Start the odometry task
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EBUSY: the odometry task is already running
+         * ENOMEM: the task could not be created
+         *
+         * @param period how often the pose is integrated. Defaults to 10 ms, which is how often smart devices update.
+         * An adaptive rate replaces it
+         * @param priority the priority of the odometry task. Defaults to above the default priority
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t start(Time period = 10_msec, uint32_t priority = TASK_PRIORITY_DEFAULT + 2);
+        /**
+         * @brief Stop the odometry task
+         *
+         * This function blocks until the current update finishes. The latest pose can still be read after the
+         * odometry is stopped
+         */
+        void stop();
+    private:
+        /**
+         * @brief A tracking wheel, and its distance in the previous update
+         */
+        struct WheelState {
+                TrackingWheel wheel;
+                Length lastDistance = 0_in;
+                // whether lastDistance holds a valid reading. Wheels are skipped for one update when they reconnect
+                bool valid = false;
+                // whether the wheel was slipping in the current update
+                bool slipping = false;
+        };
+
+        /**
+         * @brief Read a tracking wheel and calculate how far it travelled since the last update
+         *
+         * @param state the tracking wheel to read
+         * @param timestamp the instant to interpolate wheels with a history to, or INFINITY to read them directly
+         * @return Length the distance travelled, or INFINITY if the wheel couldn't be read or just reconnected
+         */
+        static Length readDelta(WheelState& state, Time timestamp);
+        /**
+         * @brief Find the latest instant every tracking wheel with a recent history has a sample for
+         *
+         * @param now the current time, in microseconds
+         * @return Time the instant, or INFINITY if no wheel has a recent history
+         */
+        Time findCommonTimestamp(uint64_t now) const;
+        /**
+         * @brief Calculate the change in heading from two parallel tracking wheels
+         *
+         * @param a the first tracking wheel
+         * @param b the second tracking wheel
+         * @param deltaA the distance travelled by the first tracking wheel
+         * @param deltaB the distance travelled by the second tracking wheel
+         * @return Angle the change in heading, or INFINITY if it can't be calculated
+         */
+        static Angle wheelHeadingDelta(const WheelState& a, const WheelState& b, Length deltaA, Length deltaB);
+        /**
+         * @brief the function run by the odometry task
+         *
+         * @param odometry pointer to the odometry object
+         */
+        static void taskFunction(void* odometry);
+
+        /**
+         * @brief Get the pose being integrated
+         *
+         * The mutex has to be locked before this function is called
+         *
+         * @return units::Pose the sums of the accumulators
+         */
+        units::Pose getIntegratedPose() const;
+        /**
+         * @brief Set the pose being integrated, and publish it
+         *
+         * The mutex has to be locked before this function is called. The history is not changed
+         *
+         * @param pose the pose
+         */
+        void setIntegratedPose(units::Pose pose);
+        /**
+         * @brief Pick the period of the adaptive rate from the motion of one update
+         *
+         * The mutex has to be locked before this function is called
+         *
+         * @param now the time of the update, in microseconds
+         * @param distance how far the tracking center moved
+         * @param turn how far the robot turned
+         */
+        void adaptRate(uint64_t now, Length distance, Angle turn);
+
+        std::vector<WheelState> m_verticals;
+        std::vector<WheelState> m_horizontals;
+        // reused by update, so the integration step never allocates memory
+        std::vector<Length> m_verticalDeltas;
+        std::vector<Length> m_horizontalDeltas;
+        IMU* m_imu;
+        Angle m_lastImuRotation = from_stDeg(INFINITY);
+        // the rotation of the IMU carried back to the instant the wheels were interpolated to, whether it could be
+        // carried back, and when it was read in microseconds
+        Angle m_lastSyncedImuRotation = from_stDeg(INFINITY);
+        bool m_imuCarried = false;
+        uint64_t m_lastImuTime = 0;
+        // the instant the wheels were interpolated to in the previous update, or INFINITY if they were read directly
+        Time m_lastCommon = from_sec(INFINITY);
+        // the pose being integrated, as compensated sums, so thousands of small steps don't add up rounding errors. It
+        // is only accessed while the mutex is locked
+        units::Accumulator<Length> m_x;
+        units::Accumulator<Length> m_y;
+        units::Accumulator<Angle> m_orientation;
+        // the pose published to readers
+        Topic<units::Pose> m_publishedPose;
+        // written by update, so only the task holding the mutex writes to it
+        PoseHistoryBase* m_history = nullptr;
+        // the orientation the wheel distances are projected with, or nullptr to not correct for tilt
+        const DevicePoller* m_tiltPoller = nullptr;
+        int32_t m_tiltIndex = 0;
+        mutable pros::Mutex m_mutex;
+        Time m_period = 10_msec;
+        // the adaptive rate is only touched while the mutex is locked
+        bool m_adaptive = false;
+        AdaptiveRate m_rate;
+        DevicePoller* m_ratePoller = nullptr;
+        // when the robot was last seen moving, in microseconds
+        uint64_t m_lastMoving = 0;
+        // read by the task and updateIfDue without locking. When the previous update ran, in microseconds
+        std::atomic<uint64_t> m_lastUpdate = 0;
+        std::atomic<Time> m_currentPeriod = 10_msec;
+        std::atomic<bool> m_resting = false;
+        // the task is not deleted from outside, as it could be holding a device mutex. Instead it is asked to exit
+        std::atomic<bool> m_running = false;
+        std::atomic<bool> m_taskExited = true;
+};
+} // namespace lemlib
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "units/Pose.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief A pose of the robot, and when it was measured
+ */
+struct PoseSample {
+        /** the time the pose was measured, since the program started */
+        Time timestamp = 0_sec;
+        /** the pose of the robot */
+        units::Pose pose;
+};
+
+/**
+ * @brief The storage independent part of PoseHistory
+ *
+ * Odometry writes to histories through this class, so it doesn't need to know their capacity. Use PoseHistory to
+ * create a history.
+ */
+class PoseHistoryBase {
+    public:
+        PoseHistoryBase(const PoseHistoryBase& other) = delete;
+        PoseHistoryBase& operator=(const PoseHistoryBase& other) = delete;
+        /**
+         * @brief Add a pose to the history, replacing the oldest pose if the history is full
+         *
+         * Only one task may push poses. This is normally the odometry task. Timestamps must increase, so a pose which
+         * is not newer than the latest pose replaces it.
+         *
+         * @param timestamp the time the pose was measured
+         * @param pose the pose
+         */
+        void push(Time timestamp, const units::Pose& pose);
+        /**
+         * @brief Remove every pose from the history
+         *
+         * Only the task which pushes poses may clear the history. Odometry clears it when the pose is set, so poses
+         * from before and after a jump are never interpolated.
+         */
+        void clear();
+        /**
+         * @brief Get the pose of the robot at a past time
+         *
+         * The two poses measured around the time are found with a binary search, and interpolated linearly, so this
+         * takes O(log n) time. Times after the latest pose give the latest pose, since odometry hasn't measured
+         * anything newer.
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the history is empty
+         * ERANGE: the time is before the oldest pose in the history
+         *
+         * @param timestamp the time, since the program started
+         * @return units::Pose the pose at that time. The position is INFINITY on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void onVisionFrame(Time captured) {
+         *     // where the robot was when the camera took the frame
+         *     const units::Pose pose = history.getPose(captured);
+         * }
+         * @endcode
+         */
+        units::Pose getPose(Time timestamp) const;
+        /**
+         * @brief Predict the pose of the robot at a future time
+         *
+         * The velocity and angular velocity of the robot are measured in its own frame over the latest window of the
+         * history, and the latest pose is moved along the arc they make until the time, like an odometry step. A
+         * controller which targets the predicted pose makes up for the time its output takes to reach the motors,
+         * and for the age of the latest pose. A time before the latest pose is looked up like getPose.
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the history is empty
+         *
+         * @param timestamp the time, since the program started
+         * @param window how far back the velocity is measured over. Longer windows filter out more noise, but lag
+         * more behind changes of velocity. Defaults to 20 ms. If the history is shorter, or the window isn't positive,
+         * the latest pose is returned
+         * @return units::Pose the predicted pose. The position is INFINITY on failure, setting errno
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void autonomous() {
+         *     // where the robot will be when a command sent now takes effect
+         *     const units::Pose pose = history.predictPose(from_usec(pros::micros()) + 15_msec);
+         * }
+         * @endcode
+         */
+        units::Pose predictPose(Time timestamp, Time window = 20_msec) const;
+        /**
+         * @brief Get the latest pose in the history
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the history is empty
+         *
+         * @return PoseSample the latest pose. The position is INFINITY on failure, setting errno
+         */
+        PoseSample getLatest() const;
+        /**
+         * @brief Get the number of poses in the history
+         *
+         * @return size_t the number of poses, which is never more than the capacity
+         */
+        size_t getSize() const;
+        /**
+         * @brief Get the maximum number of poses the history can hold
+         *
+         * @return size_t the capacity
+         */
+        size_t getCapacity() const;
+    protected:
+        /**
+         * @brief Construct a new Pose History Base
+         *
+         * @param storage the storage for the poses. It must outlive the history
+         * @param capacity the number of poses the storage can hold. One more than the number of readable poses
+         */
+        PoseHistoryBase(PoseSample* storage, size_t capacity);
+    private:
+        /**
+         * @brief the sample returned on failure
+         *
+         * @return PoseSample a sample with an infinite position
+         */
+        static PoseSample invalidSample();
+
+        PoseSample* const m_storage;
+        // the size of the storage. One slot is reserved for the writer, so a pose is never read while it is written
+        const size_t m_capacity;
+        // the total number of poses pushed. The latest pose is at (m_head - 1) % m_capacity
+        std::atomic<uint32_t> m_head = 0;
+        // the value of m_head when the history was last cleared. Poses pushed before it are not read
+        std::atomic<uint32_t> m_start = 0;
+};
+
+/**
+ * @brief A fixed-size ring of timestamped poses, for latency compensation
+ *
+ * Measurements from vision sensors, the GPS, or anything else with latency describe where the robot was when they
+ * were taken, not where it is when they arrive. Register a PoseHistory with Odometry::setHistory to have every
+ * integrated pose recorded, and look up the pose at the time of the measurement, instead of rerunning odometry. The
+ * poses are stored inside the object, so the history never allocates memory, and reading is lock-free.
+ *
+ * @tparam N the maximum number of poses to keep. With the default odometry period of 10 ms, 64 poses cover 640 ms
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::PoseHistory<64> history;
+ *
+ * void initialize() {
+ *     odom.setHistory(history);
+ *     odom.start();
+ * }
+ * @endcode
+ */
+template <size_t N> class PoseHistory : public PoseHistoryBase {
+        static_assert(N >= 2, "PoseHistory needs at least 2 poses to interpolate");
+    public:
+        /**
+         * @brief Construct a new, empty Pose History
+         */
+        PoseHistory()
+            : PoseHistoryBase(m_samples.data(), N + 1) {}
+    private:
+        std::array<PoseSample, N + 1> m_samples;
+};
+} // namespace lemlib
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "hardware/DoubleBuffer.hpp"
+#include "hardware/IMU/V5InertialSensor.hpp"
+#include "hardware/Motor/MotorGroup.hpp"
+#include "hardware/MutexPool.hpp"
+#include <array>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief How a SlipDetector decides that the wheels slip, or that the robot collided
+ */
+struct SlipDetectorSettings {
+        /** the direction the robot drives in, in the axes of the IMU. Defaults to the x axis */
+        units::Vector3D<Number> imuForward = units::Vector3D<Number>(1, 0, 0);
+        /**
+         * how quickly the baseline of the IMU acceleration follows it. The baseline removes the part of gravity the
+         * accelerometer measures when the robot is tilted, and the bias of the accelerometer
+         */
+        Time baselineTimeConstant = 500_msec;
+        /** differences between the acceleration of the wheels and of the IMU smaller than this are noise */
+        LinearAcceleration slipAllowance = 2_mps2;
+        /**
+         * the wheels are slipping once the differences larger than the allowance add up to this much velocity. A
+         * wheel spinning up 10 m/s^2 faster than the robot is flagged within 2 updates of 10 ms with the default
+         */
+        LinearVelocity slipThreshold = 0.1_mps;
+        /**
+         * the robot accelerating this much harder than its wheels, in any horizontal direction, is an impact. The
+         * lateral acceleration is measured from its baseline, so turns don't count
+         */
+        LinearAcceleration impactThreshold = 10_mps2;
+        /** motors drawing at least this much current on average are pushing hard */
+        Current stallCurrent = 2_amp;
+        /** motors pushing hard, but slower than this on average, while the IMU barely accelerates, are stalled */
+        AngularVelocity stallVelocity = 10_rpm;
+        /** how long the motors have to be stalled before it counts as a collision */
+        Time stallTime = 50_msec;
+        /** how long a slip or a collision stays flagged after it was last detected */
+        Time holdTime = 100_msec;
+};
+
+/**
+ * @brief The latest result of a SlipDetector
+ */
+struct SlipState {
+        /** the time of the update, measured since the program started */
+        Time timestamp = 0_sec;
+        /** whether the wheels are slipping, either spinning faster than the robot moves or skidding */
+        bool slipping = false;
+        /** whether the robot hit something, or is pushing against something */
+        bool colliding = false;
+        /** the forward acceleration measured by the wheels */
+        LinearAcceleration wheelAcceleration = 0_mps2;
+        /** the forward acceleration measured by the IMU, with its baseline removed */
+        LinearAcceleration imuAcceleration = 0_mps2;
+        /** the sum of differences between the two accelerations, which is compared against the slip threshold */
+        LinearVelocity slipEvidence = 0_mps;
+        /** how many slips have been detected */
+        uint32_t slips = 0;
+        /** how many collisions have been detected */
+        uint32_t collisions = 0;
+};
+
+/**
+ * @brief Detects wheel slip and collisions from the motors of a drivetrain and an IMU
+ *
+ * Every update compares how fast the wheels accelerate, from the velocity of the motors, with how fast the IMU says
+ * the robot accelerates. While the wheels grip, the two agree. When the wheels spin out, or skid, they disagree, and
+ * the difference is added up with a CUSUM: differences below the allowance drain the sum, and larger ones fill it, so
+ * noise is ignored while a real slip is flagged within one or two updates.
+ *
+ * Collisions are detected two ways. An impact is the IMU accelerating much harder than the wheels, which is flagged
+ * in the update it happens in. Pushing against something, like a wall or another robot, shows as the
+ * motors drawing a high current while barely moving, and the IMU barely accelerating.
+ *
+ * Every statistic is updated incrementally, in constant time, and nothing is allocated after construction, so
+ * update can be called from a control loop. Only one task should call update, but any task can read the state.
+ *
+ * A tracking wheel can be given a slip detector, so Odometry stops trusting the wheel while it slips.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::MotorGroup leftDrive({1, -2, 3}, 450_rpm);
+ * lemlib::V5InertialSensor imu(10);
+ * lemlib::SlipDetector leftSlip(leftDrive, imu, 3.25_in);
+ * lemlib::ControlScheduler scheduler(10_msec);
+ *
+ * void initialize() {
+ *     scheduler.add([] { leftSlip.update(); }, 10_msec);
+ *     scheduler.start();
+ * }
+ *
+ * void autonomous() {
+ *     if (leftSlip.isColliding()) std::cout << "Hit something" << std::endl;
+ * }
+ * @endcode
+ */
+class SlipDetector {
+    public:
+        /** the most motors which are read from the motor group */
+        static constexpr size_t MAX_MOTORS = 8;
+        /**
+         * @brief Construct a new Slip Detector
+         *
+         * @param motors the motors which drive the wheels. They must outlive the detector
+         * @param imu the IMU. It must outlive the detector
+         * @param wheelDiameter the diameter of the wheels the motors drive, at the output velocity of the motor group
+         * @param settings how slips and collisions are detected
+         */
+        SlipDetector(MotorGroup& motors, V5InertialSensor& imu, Length wheelDiameter,
+                     SlipDetectorSettings settings = {});
+        SlipDetector(const SlipDetector& other) = delete;
+        SlipDetector& operator=(const SlipDetector& other) = delete;
+        /**
+         * @brief Read the motors and the IMU, and update the detector
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENODEV: none of the motors could be read. If only the IMU could not be read, collisions are still detected
+         * from the motors, and 0 is returned
+         *
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno. The previous state is kept
+         */
+        int32_t update();
+        /**
+         * @brief Get the result of the latest update
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * @return SlipState the state
+         */
+        SlipState getState() const;
+        /**
+         * @brief Whether the wheels are slipping, as of the latest update
+         *
+         * @return true the wheels are slipping
+         * @return false the wheels are gripping
+         */
+        bool isSlipping() const;
+        /**
+         * @brief Whether the robot collided with something, as of the latest update
+         *
+         * @return true the robot hit something or is pushing against something
+         * @return false no collision
+         */
+        bool isColliding() const;
+        /**
+         * @brief Set how slips and collisions are detected
+         *
+         * @param settings the settings
+         * @return int32_t always returns 0
+         */
+        int32_t setSettings(SlipDetectorSettings settings);
+        /**
+         * @brief Get how slips and collisions are detected
+         *
+         * @return SlipDetectorSettings the settings
+         */
+        SlipDetectorSettings getSettings() const;
+    private:
+        MotorGroup& m_motors;
+        V5InertialSensor& m_imu;
+        const Length m_wheelDiameter;
+        // serializes writing the settings, which have a single writer
+        PooledMutex m_mutex;
+        DoubleBuffer<SlipDetectorSettings> m_settings;
+        DoubleBuffer<SlipState> m_state;
+        // reused by update, so it never allocates memory
+        std::array<MotorTelemetry, MAX_MOTORS> m_telemetry;
+        // only used by the task which calls update. Everything is in SI units
+        bool m_started = false;
+        double m_lastTime = 0;
+        double m_lastSpeed = 0;
+        bool m_baselineValid = false;
+        double m_baselineForward = 0;
+        double m_baselineLateral = 0;
+        double m_slipSum = 0;
+        double m_stalledFor = 0;
+        double m_slipUntil = -INFINITY;
+        double m_collisionUntil = -INFINITY;
+};
+} // namespace lemlib
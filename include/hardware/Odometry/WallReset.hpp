@@ -0,0 +1,69 @@
+#pragma once
+
+#include "hardware/Distance/V5DistanceSensor.hpp"
+#include "hardware/Odometry/Odometry.hpp"
+#include "units/Angle.hpp"
+#include "units/Pose.hpp"
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief An axis of the field
+ */
+enum class FieldAxis { X, Y };
+
+/**
+ * @brief A wall of the field, or any flat surface parallel to one, which a distance sensor can measure the position of
+ * the robot from
+ *
+ * @b Example:
+ * @code {.cpp}
+ * // the wall at the top of a field whose origin is in its center
+ * constexpr lemlib::Wall top {lemlib::FieldAxis::Y, 70.2_in};
+ * @endcode
+ */
+struct Wall {
+        /** the axis the wall crosses, which is the axis of the pose it resets */
+        FieldAxis axis;
+        /** where the wall crosses the axis */
+        Length position;
+};
+
+/**
+ * @brief Reset one axis of the pose of the robot from the distance to a wall
+ *
+ * The position of the robot along the axis is found from the distance the sensor measured, where the sensor is mounted
+ * and the heading of the robot, and only that axis of the pose is changed. The median of the sample is used if it has
+ * one, so a sample from a DevicePoller is already filtered, without averaging readings before the reset. If the
+ * odometry has a history, the reset is applied at the time the sample was taken, with correctPose, so motion since
+ * then is kept.
+ *
+ * This function uses the following values of errno when an error state is reached:
+ *
+ * ENODEV: the sensor could not be read when the sample was taken
+ * ERANGE: there was no object in range of the sensor
+ * EDOM: the sensor doesn't face the wall, or faces it at more than maxIncidence from straight on
+ *
+ * @param odometry the odometry to reset
+ * @param sample the sample of the distance sensor, from a DevicePoller or V5DistanceSensor::getSample
+ * @param offset the pose of the sensor relative to the tracking center of the robot, facing the direction it measures
+ * @param wall the wall the sensor faces
+ * @param maxIncidence how far from perpendicular to the wall the sensor can face. The further from perpendicular, the
+ * more an error in the heading moves the reset. Defaults to 20 degrees
+ * @return int32_t 0 on success
+ * @return INT_MAX on failure, setting errno. The pose is not changed
+ *
+ * @b Example:
+ * @code {.cpp}
+ * // a distance sensor 5" behind the tracking center, facing backwards
+ * const units::Pose backOffset(-5_in, 0_in, 180_stDeg);
+ *
+ * void autonomous() {
+ *     // the robot backs up to the bottom wall before the next segment
+ *     lemlib::resetFromWall(odom, poller.getDistanceSample(backIndex), backOffset, {lemlib::FieldAxis::Y, -70.2_in});
+ * }
+ * @endcode
+ */
+int32_t resetFromWall(Odometry& odometry, const DistanceSample& sample, units::Pose offset, Wall wall,
+                      Angle maxIncidence = 20_stDeg);
+} // namespace lemlib
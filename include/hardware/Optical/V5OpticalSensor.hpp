@@ -0,0 +1,270 @@
+#pragma once
+
+#include "hardware/Device.hpp"
+#include "hardware/DeviceRegistry.hpp"
+#include "hardware/DoubleBuffer.hpp"
+#include "hardware/Port.hpp"
+#include "units/Angle.hpp"
+#include "pros/optical.hpp"
+#include "pros/rtos.hpp"
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+
+namespace lemlib {
+/**
+ * @brief A range of hues which belong to one color, used by HueClassifier
+ *
+ * Hues are measured in degrees from 0 to 360, with red at 0. A range whose end is below its start wraps around 360, so
+ * red can be a single range from 340 to 20 degrees.
+ */
+struct HueRange {
+        /** the first hue of the range */
+        Angle from;
+        /** the hue the range ends before */
+        Angle to;
+        /** the color of the range. Must not be HueClassifier::NONE */
+        uint8_t color;
+};
+
+/**
+ * @brief Classifies hues into colors with a table of every whole degree
+ *
+ * The table is filled once, when the classifier is constructed, so classifying a hue is a single lookup however many
+ * ranges there are. Hues are rounded down to the degree. Constructing a classifier is constexpr, so the table of a
+ * global classifier is usually built by the compiler.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * enum Color : uint8_t { NONE = lemlib::HueClassifier::NONE, RED, BLUE };
+ *
+ * constexpr lemlib::HueClassifier classifier({{340_stDeg, 20_stDeg, RED}, {190_stDeg, 250_stDeg, BLUE}});
+ * @endcode
+ */
+class HueClassifier {
+    public:
+        /** the color of hues which aren't in any range */
+        static constexpr uint8_t NONE = 0;
+
+        /**
+         * @brief Construct a new Hue Classifier which classifies every hue as NONE
+         */
+        constexpr HueClassifier() { m_table.fill(NONE); }
+
+        /**
+         * @brief Construct a new Hue Classifier
+         *
+         * @param ranges the ranges of every color. Where ranges overlap, the later range wins
+         */
+        constexpr HueClassifier(std::initializer_list<HueRange> ranges)
+            : HueClassifier() {
+            for (const HueRange& range : ranges) {
+                const int from = wrap(to_stDeg(range.from));
+                const int to = wrap(to_stDeg(range.to));
+                for (int hue = from; hue != to; hue = (hue + 1) % DEGREES) m_table[hue] = range.color;
+            }
+        }
+
+        /**
+         * @brief Get the color of a hue
+         *
+         * @param hue the hue. Any finite angle is wrapped to 0 to 360 degrees
+         * @return uint8_t the color, or NONE if the hue isn't in any range, or isn't finite
+         */
+        constexpr uint8_t classify(Angle hue) const {
+            const double degrees = to_stDeg(hue);
+            // written so NaN isn't finite either
+            if (!(degrees > -INFINITY && degrees < INFINITY)) return NONE;
+            return m_table[wrap(degrees)];
+        }
+    private:
+        static constexpr int DEGREES = 360;
+
+        /**
+         * @brief Round a hue down to the degree, and wrap it to 0 to 359
+         *
+         * @param degrees the hue, in degrees
+         * @return int the index of the hue in the table
+         */
+        static constexpr int wrap(double degrees) {
+            const int index = int(std::floor(degrees - DEGREES * std::floor(degrees / DEGREES)));
+            // a tiny negative hue wraps to exactly 360 after rounding
+            return index == DEGREES ? 0 : index;
+        }
+
+        std::array<uint8_t, DEGREES> m_table {};
+};
+
+/**
+ * @brief The settings of a V5OpticalSensor
+ */
+struct OpticalSettings {
+        /** how close an object has to be to be classified, from 0 (nothing in front) to 1 (touching the sensor) */
+        Number minProximity = 0.5;
+        /** the saturation a color needs to be classified, so grays like the field tiles are ignored, from 0 to 1 */
+        Number minSaturation = 0.3;
+        /** the brightness of the LED of the sensor, from 0 to 1. A short integration time needs a bright LED */
+        Number ledPower = 1;
+};
+
+/**
+ * @brief A color read by a V5OpticalSensor
+ */
+struct OpticalReading {
+        /** when the sensor was read, measured since the program started */
+        Time timestamp = 0_sec;
+        /** the hue, from 0 to 360 degrees. INFINITY if it could not be read */
+        Angle hue = from_stDeg(INFINITY);
+        /** the saturation, from 0 to 1. INFINITY if it could not be read */
+        Number saturation = INFINITY;
+        /** how close the object in front of the sensor is, from 0 to 1. INFINITY if it could not be read */
+        Number proximity = INFINITY;
+        /** the color of the object, or HueClassifier::NONE if nothing was classified */
+        uint8_t color = HueClassifier::NONE;
+        /** when the sensor was first read with the current color, which is when an object was detected */
+        Time detectedAt = 0_sec;
+};
+
+/**
+ * @brief Device implementation for the V5 Optical Sensor, which classifies the color of objects in front of it
+ *
+ * The sensor integrates light for 100 ms by default, so an object is only seen up to 100 ms after it arrives. The
+ * sensor is set to its shortest integration time, 3 ms, with its LED at full power to make up for the shorter
+ * exposure. The sensor forgets its settings when it reconnects, so they are sent again on the first read after the
+ * DeviceRegistry sees any device plugged in.
+ *
+ * Every reading is classified with a HueClassifier, so it costs a table lookup, and the time the color changed is
+ * kept, so a sorter can tell how long ago an object arrived. A reading is three calls to the SDK and never locks a
+ * mutex, so it can be sampled by a DevicePoller, which should run at 5 ms or less to keep up with the sensor.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * enum Color : uint8_t { NONE = lemlib::HueClassifier::NONE, RED, BLUE };
+ *
+ * lemlib::V5OpticalSensor optical(6, {{340_stDeg, 20_stDeg, RED}, {190_stDeg, 250_stDeg, BLUE}});
+ *
+ * void opcontrol() {
+ *     const lemlib::OpticalReading reading = optical.getReading();
+ *     if (reading.color == BLUE) ejector.move(1);
+ * }
+ * @endcode
+ */
+class V5OpticalSensor final : public Device {
+    public:
+        /** the shortest integration time the sensor supports */
+        static constexpr Time MIN_INTEGRATION_TIME = 3_msec;
+        /**
+         * @brief Construct a new V5 Optical Sensor
+         *
+         * The sensor is configured on its first read, or by startInitialization.
+         *
+         * @param port the port of the optical sensor
+         * @param classifier the colors to classify hues into
+         * @param settings the settings of the sensor
+         */
+        V5OpticalSensor(SmartPort port, const HueClassifier& classifier, OpticalSettings settings = {});
+        V5OpticalSensor(const V5OpticalSensor& other);
+        // the simulator only implements the PROS C api, so PROS objects can't be converted
+#ifndef LEMLIB_SIM
+        /**
+         * @brief Create a new V5 Optical Sensor
+         *
+         * The integration time and LED brightness set on the pros::Optical are replaced.
+         *
+         * @param sensor the pros::Optical object to use
+         * @param classifier the colors to classify hues into
+         * @param settings the settings of the sensor
+         * @return V5OpticalSensor the optical sensor
+         */
+        static V5OpticalSensor from_pros_optical(pros::Optical sensor, const HueClassifier& classifier,
+                                                 OpticalSettings settings = {});
+#endif
+        /**
+         * @brief whether the V5 Optical Sensor is connected
+         *
+         * The connection is read from the latest snapshot of the DeviceRegistry, so this is only a lookup, and can be
+         * up to one scan period old
+         *
+         * @return 0 if its not connected
+         * @return 1 if it is connected
+         */
+        int32_t isConnected() const override;
+        /**
+         * @brief Set the integration time and LED brightness of the sensor
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENXIO: the port is not within the range of valid ports (1-21)
+         * ENODEV: the port cannot be configured as a V5 Optical Sensor
+         *
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno. The sensor is configured again on its next read
+         */
+        int32_t startInitialization() override;
+        /**
+         * @brief Read and classify the color in front of the sensor
+         *
+         * The detection time is kept by the sensor, so this must not be called from more than one task at once.
+         * Register the sensor with a DevicePoller to read it from several tasks.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENXIO: the port is not within the range of valid ports (1-21)
+         * ENODEV: the port cannot be configured as a V5 Optical Sensor
+         *
+         * @return OpticalReading the reading. The hue, saturation and proximity are INFINITY on failure, setting errno,
+         * and the color is NONE
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void opcontrol() {
+         *     const lemlib::OpticalReading reading = optical.getReading();
+         *     if (reading.color != lemlib::HueClassifier::NONE) {
+         *         std::cout << "seen for " << to_msec(reading.timestamp - reading.detectedAt) << " ms" << std::endl;
+         *     }
+         * }
+         * @endcode
+         */
+        OpticalReading getReading();
+        /**
+         * @brief Set the settings of the sensor
+         *
+         * This function can be called from any task. The LED brightness is sent on the next read.
+         *
+         * @param settings the settings
+         * @return int32_t always returns 0
+         */
+        int32_t setSettings(OpticalSettings settings);
+        /**
+         * @brief Get the settings of the sensor
+         *
+         * @return OpticalSettings the settings
+         */
+        OpticalSettings getSettings() const;
+        /**
+         * @brief Get the port of the V5 Optical Sensor
+         *
+         * @return uint8_t the port
+         */
+        uint8_t getPort() const;
+    private:
+        /** the highest proximity the sensor reports */
+        static constexpr int32_t MAX_PROXIMITY = 255;
+
+        uint8_t m_port;
+        // the table is never changed, so it is read without locking
+        const HueClassifier m_classifier;
+        // published through a lock-free buffer, so reading the sensor never waits for setSettings
+        DoubleBuffer<OpticalSettings> m_settings;
+        pros::Mutex m_mutex;
+        std::atomic<bool> m_reconfigure = true;
+        // only touched by getReading
+        uint32_t m_plugSequence = 0;
+        uint8_t m_color = HueClassifier::NONE;
+        Time m_detectedAt = 0_sec;
+        // the claim of the port in the DeviceRegistry
+        PortClaim m_claim;
+};
+} // namespace lemlib
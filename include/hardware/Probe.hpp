@@ -0,0 +1,156 @@
+#pragma once
+
+#include "pros/rtos.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace lemlib {
+/**
+ * @brief A histogram of how long a call site takes, with fixed buckets
+ *
+ * Bucket 0 counts calls which took less than 1 us, and bucket i counts calls which took from 2^(i - 1) us up to
+ * 2^i us. The last bucket counts every call slower than that. Recording a call is a few relaxed atomic operations, so
+ * probes can be used from any task, and never lock.
+ *
+ * Every histogram adds itself to a global list when it is constructed, which dumpProbes walks. Histograms are created
+ * by the LEMLIB_PROBE macro, and are never destroyed.
+ */
+class LatencyHistogram {
+    public:
+        /** the number of buckets */
+        static constexpr size_t BUCKETS = 16;
+        /**
+         * @brief Construct a new Latency Histogram, and add it to the list of histograms
+         *
+         * @param name the name of the call site. It must outlive the histogram, like a string literal
+         */
+        LatencyHistogram(const char* name);
+        LatencyHistogram(const LatencyHistogram& other) = delete;
+        LatencyHistogram& operator=(const LatencyHistogram& other) = delete;
+        /**
+         * @brief Record a call
+         *
+         * @param micros how long the call took, in microseconds
+         */
+        void record(uint32_t micros);
+        /**
+         * @brief Clear every recorded call
+         */
+        void reset();
+        /**
+         * @brief Write the histogram as a line of csv, with the columns written by dumpProbes
+         *
+         * @param file the file to write to
+         */
+        void dump(FILE* file) const;
+        /**
+         * @brief Get the first histogram in the list of histograms
+         *
+         * @return LatencyHistogram* the first histogram, or nullptr if there are none
+         */
+        static LatencyHistogram* getFirst();
+        /**
+         * @brief Get the next histogram in the list of histograms
+         *
+         * @return LatencyHistogram* the next histogram, or nullptr if this is the last one
+         */
+        LatencyHistogram* getNext() const;
+    private:
+        const char* const m_name;
+        std::array<std::atomic<uint32_t>, BUCKETS> m_buckets {};
+        std::atomic<uint32_t> m_count = 0;
+        std::atomic<uint32_t> m_max = 0;
+        std::atomic<uint64_t> m_total = 0;
+        LatencyHistogram* m_next = nullptr;
+};
+
+/**
+ * @brief Records how long a scope takes into a histogram
+ *
+ * Use LEMLIB_PROBE instead of creating these directly, so probes compile away when they are disabled.
+ */
+class ScopedProbe {
+    public:
+        /**
+         * @brief Start timing the scope
+         *
+         * @param histogram the histogram to record into when the scope ends
+         */
+        ScopedProbe(LatencyHistogram& histogram)
+            : m_histogram(histogram),
+              m_start(pros::c::micros()) {}
+
+        ScopedProbe(const ScopedProbe& other) = delete;
+        ScopedProbe& operator=(const ScopedProbe& other) = delete;
+
+        ~ScopedProbe() { m_histogram.record(pros::c::micros() - m_start); }
+    private:
+        LatencyHistogram& m_histogram;
+        const uint64_t m_start;
+};
+
+/**
+ * @brief Write every histogram as csv, with a header line naming the columns
+ *
+ * The columns are the name of the call site, the number of calls, the mean and the slowest call in microseconds, and
+ * the count of every bucket.
+ *
+ * @param file the file to write to. Defaults to stdout, which is sent over the serial port
+ * @return int32_t always returns 0
+ *
+ * @b Example:
+ * @code {.cpp}
+ * void disabled() {
+ *     // print the latencies over serial after the match
+ *     lemlib::dumpProbes();
+ * }
+ * @endcode
+ */
+int32_t dumpProbes(FILE* file = stdout);
+/**
+ * @brief Write every histogram as csv to a file, like on the SD card
+ *
+ * This function uses the following values of errno when an error state is reached:
+ *
+ * any errno set by fopen, like ENXIO when there is no SD card
+ *
+ * @param path the path of the file. It is overwritten
+ * @return int32_t 0 on success
+ * @return INT_MAX on failure, setting errno
+ *
+ * @b Example:
+ * @code {.cpp}
+ * void disabled() {
+ *     lemlib::dumpProbes("/usd/probes.csv");
+ * }
+ * @endcode
+ */
+int32_t dumpProbes(const char* path);
+/**
+ * @brief Clear every histogram, like at the start of a match
+ */
+void resetProbes();
+} // namespace lemlib
+
+#define LEMLIB_PROBE_CONCAT_(a, b) a##b
+#define LEMLIB_PROBE_CONCAT(a, b) LEMLIB_PROBE_CONCAT_(a, b)
+
+/**
+ * @brief Time the rest of the enclosing scope, recording it into a histogram for this call site
+ *
+ * Probes are only compiled in when LEMLIB_PROBES is defined, which `make PROBES=1` does. Otherwise this expands to
+ * nothing, so probes cost nothing when they are disabled.
+ *
+ * @param name the name of the call site, as a string literal
+ */
+#ifdef LEMLIB_PROBES
+#define LEMLIB_PROBE(name)                                                                                             \
+    static ::lemlib::LatencyHistogram LEMLIB_PROBE_CONCAT(lemlibProbeHistogram, __LINE__)(name);                       \
+    const ::lemlib::ScopedProbe LEMLIB_PROBE_CONCAT(lemlibProbe, __LINE__)(                                            \
+        LEMLIB_PROBE_CONCAT(lemlibProbeHistogram, __LINE__))
+#else
+#define LEMLIB_PROBE(name) static_cast<void>(0)
+#endif
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "hardware/DeferredInit.hpp"
+#include "units/core.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief A raw reading of a device, in the integer units the SDK reports, and when it was taken
+ *
+ * Code which works in the units of the device, like a filter over encoder ticks, can use raw readings to skip the
+ * conversion to a quantity and back, and the offset, which it would subtract again anyway.
+ */
+struct RawReading {
+        /** the reading, before any scale, reversal or offset. INT_MAX if the device could not be read */
+        int32_t value = INT_MAX;
+        /** when the reading was taken, in microseconds since the program started. It wraps around every 71 minutes */
+        uint32_t timestamp = 0;
+};
+
+/**
+ * @brief Remembers the latest raw reading of a device, so reads inside a staleness window reuse it
+ *
+ * Smart devices only update their readings every few milliseconds, about every 10 ms for motors and rotation sensors.
+ * Reading a device more often than that makes a call to the SDK for the same value. When several subsystems read the
+ * same device in one cycle, only the first read goes to the SDK, and the others get the cached reading.
+ *
+ * The reading and the time it was taken are packed into a single 64-bit atomic, so the cache never locks, and any
+ * number of tasks can read and fill it at once. Raw readings are cached, before any offset or scale is applied, so
+ * changing the offset of a device doesn't have to invalidate the cache.
+ *
+ * The reading is kept in a slot shared by every cache of the same device, the PortState of its smart port, so objects
+ * which read the same port share their readings, and a temporary object starts with the latest one. The window is
+ * per cache.
+ *
+ * The cache is disabled by default, so every read goes to the SDK.
+ */
+class ReadCache {
+    public:
+        /**
+         * @brief Construct a new, disabled Read Cache
+         *
+         * @param reading the slot the reading is kept in, which must outlive the cache, like PortState::reading
+         */
+        explicit ReadCache(std::atomic<uint64_t>& reading)
+            : m_reading(&reading) {}
+
+        /**
+         * @brief Construct a disabled Read Cache without a slot, so it can be constant initialized
+         *
+         * A slot has to be assigned to it, by copying another cache, before it is used
+         */
+        constexpr explicit ReadCache(DeferredInit)
+            : m_reading(nullptr) {}
+
+        /**
+         * @brief Copy the window and the slot of another cache
+         *
+         * @param other the cache to copy
+         */
+        ReadCache(const ReadCache& other)
+            : m_window(other.m_window.load(std::memory_order_relaxed)),
+              m_reading(other.m_reading) {}
+
+        /**
+         * @brief Copy the window and the slot of another cache
+         *
+         * @param other the cache to copy
+         * @return ReadCache& this cache
+         */
+        ReadCache& operator=(const ReadCache& other) {
+            m_window.store(other.m_window.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            m_reading = other.m_reading;
+            return *this;
+        }
+
+        /**
+         * @brief Set how old a cached reading can be and still be used
+         *
+         * @param window the staleness window, rounded to whole microseconds. 0 disables the cache
+         */
+        void setWindow(Time window) {
+            m_window.store(std::max(0.0, std::round(to_usec(window))), std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Get how old a cached reading can be and still be used
+         *
+         * @return Time the staleness window. 0 if the cache is disabled
+         */
+        Time getWindow() const { return from_usec(m_window.load(std::memory_order_relaxed)); }
+
+        /**
+         * @brief Get the cached reading if it is fresh, or read the device and cache the result
+         *
+         * Readings which failed, which are INT_MAX, are never cached.
+         *
+         * @param readDevice the function which reads the device, returning the raw reading or INT_MAX on failure
+         * @return int32_t the raw reading
+         */
+        template <typename F> int32_t get(F&& readDevice) {
+            const uint32_t window = m_window.load(std::memory_order_relaxed);
+            if (window == 0) return readDevice();
+            // only the low 32 bits of the time are kept. The difference is still correct when they wrap around
+            const uint32_t now = pros::c::micros();
+            const uint64_t cached = m_reading->load(std::memory_order_relaxed);
+            if (cached != 0 && now - uint32_t(cached >> 32) < window) return int32_t(uint32_t(cached));
+            const int32_t raw = readDevice();
+            if (raw != INT_MAX) m_reading->store((uint64_t(now) << 32) | uint32_t(raw), std::memory_order_relaxed);
+            return raw;
+        }
+
+        /**
+         * @brief Like get, but also return when the reading was taken
+         *
+         * A cached reading keeps the time it was read from the device, not the time it was returned from the cache.
+         *
+         * @param readDevice the function which reads the device, returning the raw reading or INT_MAX on failure
+         * @return RawReading the raw reading and when it was taken
+         */
+        template <typename F> RawReading getReading(F&& readDevice) {
+            const uint32_t window = m_window.load(std::memory_order_relaxed);
+            const uint32_t now = pros::c::micros();
+            if (window == 0) return {.value = readDevice(), .timestamp = now};
+            const uint64_t cached = m_reading->load(std::memory_order_relaxed);
+            if (cached != 0 && now - uint32_t(cached >> 32) < window) {
+                return {.value = int32_t(uint32_t(cached)), .timestamp = uint32_t(cached >> 32)};
+            }
+            const int32_t raw = readDevice();
+            if (raw != INT_MAX) m_reading->store((uint64_t(now) << 32) | uint32_t(raw), std::memory_order_relaxed);
+            return {.value = raw, .timestamp = now};
+        }
+
+        /**
+         * @brief Like getReading, for devices which report when they took the reading
+         *
+         * The device's timestamp is cached instead of the time of the call, so the window is measured from when the
+         * device took the reading. Every read of a slot should go through this function, or none should.
+         *
+         * @param readDevice the function which reads the device, returning the raw reading or INT_MAX on failure. It
+         * takes a uint32_t&, which it sets to when the device took the reading, in microseconds since the program
+         * started
+         * @return RawReading the raw reading and when the device took it. The timestamp is the time of the call if
+         * the read failed
+         */
+        template <typename F> RawReading getSample(F&& readDevice) {
+            const uint32_t window = m_window.load(std::memory_order_relaxed);
+            const uint32_t now = pros::c::micros();
+            if (window != 0) {
+                const uint64_t cached = m_reading->load(std::memory_order_relaxed);
+                if (cached != 0 && now - uint32_t(cached >> 32) < window) {
+                    return {.value = int32_t(uint32_t(cached)), .timestamp = uint32_t(cached >> 32)};
+                }
+            }
+            uint32_t timestamp = now;
+            const int32_t raw = readDevice(timestamp);
+            if (raw == INT_MAX) return {.value = raw, .timestamp = now};
+            if (window != 0) m_reading->store((uint64_t(timestamp) << 32) | uint32_t(raw), std::memory_order_relaxed);
+            return {.value = raw, .timestamp = timestamp};
+        }
+
+        /**
+         * @brief Discard the cached reading, so the next read goes to the SDK
+         *
+         * This is called when the reading may have changed meaning, like when the device disconnects
+         */
+        void invalidate() { m_reading->store(0, std::memory_order_relaxed); }
+    private:
+        // the staleness window in microseconds, or 0 if the cache is disabled
+        std::atomic<uint32_t> m_window = 0;
+        // the time the reading was taken in the high 32 bits, and the reading in the low 32 bits. 0 if it is empty. The
+        // time is when the device took it for slots filled by getSample, and when it was read otherwise
+        std::atomic<uint64_t>* m_reading;
+};
+} // namespace lemlib
@@ -0,0 +1,238 @@
+#pragma once
+
+#include "hardware/ReplayLog.hpp"
+#include "hardware/Encoder/ReplayEncoder.hpp"
+#include "hardware/IMU/ReplayIMU.hpp"
+#include "hardware/Motion/Ramsete.hpp"
+#include "hardware/Motor/DifferentialDrive.hpp"
+#include "hardware/Odometry/Odometry.hpp"
+#include "units/Pose.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace lemlib {
+/**
+ * @brief The stages a ReplayGate times
+ */
+enum class ReplayStage : uint8_t {
+    /** Odometry::update, reading the replayed encoders and IMU */
+    ODOMETRY,
+    /** sampling the trajectory, and RamseteController::calculate */
+    CONTROLLER,
+    /** DifferentialDrive::moveVelocity, if the gate has a drive */
+    COMMAND
+};
+
+/**
+ * @brief The robot a ReplayGate replays a log on
+ */
+struct ReplayRobot {
+        /** the ids the left and right tracking wheels and the IMU were logged with */
+        uint16_t leftEncoder = 1;
+        uint16_t rightEncoder = 2;
+        uint16_t imu = 3;
+        /** the diameter of the tracking wheels */
+        Length trackingWheelDiameter = 2.75_in;
+        /** the offsets of the tracking wheels from the tracking center, positive to the left */
+        Length leftOffset = 5_in;
+        Length rightOffset = -5_in;
+        /** the distance between the wheels of the drive on the left and right sides */
+        Length trackWidth = 11_in;
+        /** the diameter of the wheels of the drive */
+        Length driveWheelDiameter = 3.25_in;
+        /** how often the pipeline is stepped, in the time of the log */
+        Time period = 10_msec;
+};
+
+/**
+ * @brief How far a replay may stray from its baseline before the gate fails
+ */
+struct ReplayLimits {
+        /** the largest difference in the position of the robot, at any step */
+        Length position = 0.1_in;
+        /** the largest difference in the orientation of the robot, at any step */
+        Angle orientation = 0.1_stDeg;
+        /** the largest difference in the velocity commanded to either side, at any step */
+        LinearVelocity command = 0.005_mps;
+        /**
+         * how many times slower than in the baseline a stage may be. Stages are compared by their mean time, leaving
+         * out the slowest percent of the steps, which is mostly other tasks preempting the replay
+         */
+        double slowdown = 1.25;
+};
+
+/**
+ * @brief The timing of a stage of a ReplayGate, over every step of its latest run
+ */
+struct ReplayTiming {
+        double meanMicros = 0;
+        double medianMicros = 0;
+        double p99Micros = 0;
+        double maxMicros = 0;
+};
+
+/**
+ * @brief How a run of a ReplayGate compares to its baseline
+ */
+struct ReplayReport {
+        /** the largest differences at any step */
+        Length position = 0_in;
+        Angle orientation = 0_stDeg;
+        LinearVelocity command = 0_mps;
+        /** the time of each stage, divided by its time in the baseline. See ReplayLimits::slowdown */
+        std::array<double, 3> slowdown {};
+        /** whether every difference and slowdown is within the limits */
+        bool passed = false;
+};
+
+/**
+ * @brief Replays a match log through odometry, a controller and the drive, and compares the run with a baseline
+ *
+ * The log is stepped through at a fixed period, like in the ReplayLog example, without waiting. Every step updates
+ * odometry from the replayed encoders and IMU, samples the trajectory at the time of the log and tracks it with a
+ * RamseteController, and sends the velocities to the drive. Each stage is timed, and the pose and the commands of every
+ * step are kept. The pipeline only reads the log, so the same log always produces the same commands, on the host and
+ * on the brain.
+ *
+ * A baseline is a run saved to a file. Comparing a later run with it reports how far the pose and the commands
+ * drifted, and how much slower each stage got, so a change which makes the robot behave differently and a change
+ * which makes it slower fail the same gate. Timings only compare with a baseline saved on the same platform.
+ *
+ * Stages are timed with pros::micros on the brain. In the simulator, where time only moves when a task sleeps, they
+ * are timed with the clock of the host.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::ReplayLog log;
+ * log.load("/usd/match.bin");
+ * lemlib::ReplayGate gate(log, trajectory);
+ * gate.run();
+ * gate.print("match");
+ * if (gate.compare("/usd/match.base", {}) != 0) std::printf("the replay regressed\n");
+ * @endcode
+ */
+class ReplayGate {
+    public:
+        /**
+         * @brief Construct a new Replay Gate
+         *
+         * @param log the log to replay. It must outlive the gate
+         * @param trajectory the trajectory the controller tracks, starting at the start of the log. It must outlive
+         * the gate
+         * @param robot the ids of the devices in the log, and the dimensions of the robot
+         * @param drive the drive the commands are sent to, or nullptr to only calculate them. It must outlive the gate
+         */
+        ReplayGate(ReplayLog& log, std::span<const PathSample> trajectory, ReplayRobot robot = {},
+                   DifferentialDrive* drive = nullptr);
+        ReplayGate(const ReplayGate& other) = delete;
+        ReplayGate& operator=(const ReplayGate& other) = delete;
+        /**
+         * @brief Replay the whole log, from its start
+         *
+         * Memory for every step is allocated before the first step, so allocations are not timed. The playback clock
+         * of the log is left paused at its end.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the log is empty, or the period is not positive
+         *
+         * @return int32_t the number of steps
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t run();
+        /**
+         * @brief Get the timing of a stage in the latest run
+         *
+         * @param stage the stage
+         * @return ReplayTiming the timing, in microseconds. All 0 before the first run
+         */
+        ReplayTiming getTiming(ReplayStage stage) const;
+        /**
+         * @brief Get the pose odometry measured at a step of the latest run
+         *
+         * @param step the index of the step
+         * @return units::Pose the pose. INFINITY if there is no such step
+         */
+        units::Pose getPose(size_t step) const;
+        /**
+         * @brief Save the latest run as a baseline
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: there was no run yet
+         * any errno set by fopen, like ENOENT when the directory does not exist
+         * EIO: the file could not be written
+         *
+         * @param path the path of the baseline, like "/usd/match.base"
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t saveBaseline(const char* path) const;
+        /**
+         * @brief Compare the latest run with a baseline
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: there was no run yet
+         * any errno set by fopen, like ENOENT when the baseline does not exist
+         * EPROTO: the file is not a baseline, or was saved from a run with a different number of steps
+         * ERANGE: the pose or the commands drifted further than the limits
+         * ETIMEDOUT: the pose and the commands are within the limits, but a stage is slower than the limit
+         *
+         * @param path the path of the baseline
+         * @param limits how far the run may stray from the baseline
+         * @param report where to write the comparison, or nullptr. It is written whenever the baseline was read
+         * @return int32_t 0 if the run is within the limits
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t compare(const char* path, const ReplayLimits& limits, ReplayReport* report = nullptr) const;
+        /**
+         * @brief Print the timing of every stage of the latest run over the serial port
+         *
+         * Every stage is printed on its own line, starting with "REPLAY", followed by a JSON object, like the lines
+         * of the benchmark program:
+         *
+         * REPLAY {"log":"match","stage":"odometry","n":1500,"mean_us":11.2,"median_us":11,"p99_us":19,"max_us":40}
+         *
+         * @param name the name of the log, printed in every line
+         */
+        void print(const char* name) const;
+    private:
+        // what the pipeline produced in a step, compared with the baseline
+        struct Step {
+                float x;
+                float y;
+                float orientation;
+                float left;
+                float right;
+        };
+
+        static constexpr size_t STAGES = 3;
+
+        /**
+         * @brief Get the mean time of a stage in the latest run, leaving out its slowest percent of steps
+         *
+         * @param stage the index of the stage
+         * @return double the time, in microseconds. 0 before the first run
+         */
+        double typicalMicros(size_t stage) const;
+
+        ReplayLog& m_log;
+        std::span<const PathSample> m_trajectory;
+        const ReplayRobot m_robot;
+        DifferentialDrive* const m_drive;
+        ReplayEncoder m_leftEncoder;
+        ReplayEncoder m_rightEncoder;
+        ReplayIMU m_imu;
+        RamseteController m_controller;
+        // constructed again for every run, so the tracking wheels start over
+        std::optional<Odometry> m_odometry;
+        std::vector<Step> m_steps;
+        // the duration of each stage in each step, in microseconds
+        std::array<std::vector<float>, STAGES> m_durations;
+};
+} // namespace lemlib
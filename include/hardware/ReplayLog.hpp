@@ -0,0 +1,131 @@
+#pragma once
+
+#include "hardware/DoubleBuffer.hpp"
+#include "hardware/TelemetryLogger.hpp"
+#include "pros/rtos.hpp"
+#include "units/core.hpp"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace lemlib {
+/**
+ * @brief ReplayLog class
+ *
+ * Holds the records of a log written by TelemetryLogger, and plays them back on a clock of its own. ReplayEncoder and
+ * ReplayIMU read their samples from a replay log, so odometry and controllers can be run on recorded match data.
+ *
+ * The playback clock is paused at the start of the log until play is called, and then follows the system clock.
+ * Seeking pauses it again, so a program can step through a log deterministically, as fast as it can process it:
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::ReplayLog log;
+ * log.load("/usd/auton.bin");
+ * lemlib::ReplayEncoder left(log, 1);
+ * lemlib::ReplayEncoder right(log, 2);
+ * lemlib::ReplayIMU imu(log, 3);
+ * lemlib::Odometry odom({{left, 2.75_in, 5_in}, {right, 2.75_in, -5_in}}, {}, imu);
+ * // run odometry every 10 ms of the log, without waiting
+ * for (Time time = 0_sec; time <= log.getDuration(); time += 10_msec) {
+ *     log.seek(time);
+ *     odom.update();
+ * }
+ * @endcode
+ *
+ * Loading a log is not thread safe, and must not happen while devices are reading from it. Everything else is.
+ */
+class ReplayLog {
+    public:
+        /**
+         * @brief Construct a new, empty Replay Log
+         */
+        ReplayLog() = default;
+        ReplayLog(const ReplayLog& other) = delete;
+        ReplayLog& operator=(const ReplayLog& other) = delete;
+        /**
+         * @brief Load a log file written by TelemetryLogger
+         *
+         * The whole file is read into memory once, so playback never touches the SD card. The playback clock is reset
+         * to the start of the log, and paused.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EPROTO: the file is not a log, or was written by a different version of TelemetryLogger
+         * any errno set by fopen, like ENOENT when the file does not exist
+         *
+         * @param path the path of the log file, like "/usd/auton.bin"
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno. The log is left empty
+         */
+        int32_t load(const char* path);
+        /**
+         * @brief Load records which are already in memory, like ones generated by a test
+         *
+         * @param records the records. They are copied, and do not need to be sorted
+         */
+        void load(std::span<const TelemetryRecord> records);
+        /**
+         * @brief Get the number of records in the log
+         *
+         * @return size_t the number of records
+         */
+        size_t getSize() const;
+        /**
+         * @brief Get how long the log is, from its first record to its last
+         *
+         * @return Time the duration of the log
+         */
+        Time getDuration() const;
+        /**
+         * @brief Start or resume playback, from the current playback time
+         */
+        void play();
+        /**
+         * @brief Move the playback clock, and pause it there
+         *
+         * @param time the time since the start of the log
+         */
+        void seek(Time time);
+        /**
+         * @brief Get the playback time
+         *
+         * @return Time the time since the start of the log
+         */
+        Time getTime() const;
+        /**
+         * @brief Find the latest record of a device at a time
+         *
+         * This takes O(log n) time, in the number of records of the device.
+         *
+         * @param device the id of the device, as it was logged
+         * @param kind the kind of the device
+         * @param time the time since the start of the log
+         * @return const TelemetryRecord* the latest record made at or before time, or nullptr if there is none
+         */
+        const TelemetryRecord* find(uint16_t device, TelemetryKind kind, Time time) const;
+        /**
+         * @brief Find the latest record of a device at the playback time
+         *
+         * @param device the id of the device, as it was logged
+         * @param kind the kind of the device
+         * @return const TelemetryRecord* the latest record, or nullptr if there is none yet
+         */
+        const TelemetryRecord* find(uint16_t device, TelemetryKind kind) const;
+    private:
+        struct Clock {
+                // the playback time when the clock was last changed, and the system time it was changed at
+                int64_t position = 0;
+                uint64_t anchor = 0;
+                bool playing = false;
+        };
+
+        // sorted by device, then kind, then timestamp, so the records of a device can be binary searched
+        std::vector<TelemetryRecord> m_records;
+        uint32_t m_start = 0;
+        uint32_t m_end = 0;
+        DoubleBuffer<Clock> m_clock;
+        // serializes changes to the clock, which only has room for a single writer
+        pros::Mutex m_mutex;
+};
+} // namespace lemlib
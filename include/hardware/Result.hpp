@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <errno.h>
+
+namespace lemlib {
+/**
+ * @brief A value, or the error which prevented reading it
+ *
+ * The getters of devices report errors by returning a sentinel, like INFINITY or INT_MAX, and setting errno. Checking
+ * a sentinel which is a quantity compares doubles, and setting errno is a store to a thread local. A result carries
+ * the error code next to the value instead, so checking it is an integer test, and errno is only touched when the
+ * caller converts the result back to the sentinel convention. The success branch is marked as likely, so the compiler
+ * lays out the error handling out of the way of the hot path.
+ *
+ * A result is as cheap to copy as the value and an int, so it is returned by value.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * void opcontrol() {
+ *     const lemlib::Result<Angle> angle = encoder.tryGetAngle();
+ *     if (angle.ok()) std::cout << to_stDeg(angle.value()) << std::endl;
+ *     else std::cout << "error " << angle.error() << std::endl;
+ * }
+ * @endcode
+ */
+template <typename T> class Result {
+        static_assert(std::is_trivially_copyable_v<T>, "Result can only hold trivially copyable types");
+    public:
+        /**
+         * @brief Construct a successful result
+         *
+         * @param value the value
+         */
+        constexpr Result(T value)
+            : m_value(value),
+              m_error(0) {}
+
+        /**
+         * @brief Construct a failed result
+         *
+         * @param error the error, a value of errno other than 0
+         * @return Result the result
+         */
+        static constexpr Result failure(int32_t error) { return Result(Failure(), error == 0 ? EIO : error); }
+
+        /**
+         * @brief whether the value was read successfully
+         *
+         * @return true the result holds a value
+         * @return false the result holds an error
+         */
+        constexpr bool ok() const { return m_error == 0; }
+
+        /**
+         * @brief Get the value
+         *
+         * @return T the value. Must only be called if ok returns true
+         */
+        constexpr T value() const { return m_value; }
+
+        /**
+         * @brief Get the value, or a fallback if there is an error
+         *
+         * @param fallback the value to return if there is an error
+         * @return T the value or the fallback
+         */
+        constexpr T valueOr(T fallback) const {
+            if (ok()) [[likely]]
+                return m_value;
+            return fallback;
+        }
+
+        /**
+         * @brief Get the error
+         *
+         * @return int32_t the error, like a value of errno, or 0 if the value was read successfully
+         */
+        constexpr int32_t error() const { return m_error; }
+
+        /**
+         * @brief Convert the result to the sentinel convention of the device getters
+         *
+         * @param sentinel the value to return if there is an error, like INFINITY
+         * @return T the value, or the sentinel if there is an error, setting errno
+         */
+        T orSentinel(T sentinel) const {
+            if (ok()) [[likely]]
+                return m_value;
+            errno = m_error;
+            return sentinel;
+        }
+    private:
+        struct Failure {};
+
+        constexpr Result(Failure, int32_t error)
+            : m_empty(0),
+              m_error(error) {}
+
+        // quantities can't be default constructed, so a failed result leaves the value uninitialized
+        union {
+                T m_value;
+                char m_empty;
+        };
+
+        int32_t m_error;
+};
+} // namespace lemlib
@@ -0,0 +1,318 @@
+#pragma once
+
+#include "units/core.hpp"
+#include <array>
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace lemlib {
+class RoutineWait;
+
+/**
+ * @brief A cooperative routine, written as a C++20 coroutine
+ *
+ * A routine is a function which returns a Routine, and waits with co_await instead of pros::delay. While it waits, the
+ * task running it is free to run other routines, so concurrent behaviors like running an intake while driving don't
+ * each need their own task, stack and mutexes. Routines are run by a RoutineExecutor.
+ *
+ * A routine can wait for:
+ * - a duration, with waitFor
+ * - a condition, like a motion finishing or a sensor reading, with waitUntil
+ * - another routine, by awaiting it, which runs it to completion as part of the awaiting routine
+ *
+ * A routine doesn't start running until it is added to an executor, or awaited by a running routine. The state of a
+ * routine is allocated when the routine function is called, so routines should be created when an autonomous starts,
+ * not in a control loop.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::Routine runIntake() {
+ *     intake.move(1);
+ *     co_await lemlib::waitUntil([] { return distance.get() < 50; }, 2_sec);
+ *     intake.brake();
+ * }
+ *
+ * lemlib::Routine driveForward() {
+ *     drive.move(0.5, 0);
+ *     co_await lemlib::waitFor(1_sec);
+ *     drive.brake();
+ * }
+ *
+ * lemlib::Routine autonomousRoutine() {
+ *     executor.add(runIntake());
+ *     co_await driveForward();
+ * }
+ * @endcode
+ */
+class Routine {
+    public:
+        /**
+         * @brief The state of a routine, used by the compiler
+         */
+        struct promise_type {
+                /**
+                 * @brief Transfers control back to the routine which awaited this one, if there is one
+                 */
+                struct FinalAwaiter {
+                        bool await_ready() const noexcept { return false; }
+
+                        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept;
+
+                        void await_resume() const noexcept {}
+                };
+
+                Routine get_return_object() noexcept;
+
+                std::suspend_always initial_suspend() const noexcept { return {}; }
+
+                FinalAwaiter final_suspend() const noexcept { return {}; }
+
+                void return_void() const noexcept {}
+
+                void unhandled_exception() const noexcept;
+
+                // the routine which awaits this one, which is resumed once this one finishes
+                std::coroutine_handle<promise_type> parent = nullptr;
+                // the routine added to the executor. Only its leaf and wait are used
+                promise_type* root = this;
+                // the innermost routine which is running, and has to be resumed
+                std::coroutine_handle<promise_type> leaf = nullptr;
+                // what the leaf is waiting for. The wait lives in the frame of the leaf while it is suspended
+                RoutineWait* wait = nullptr;
+        };
+
+        /**
+         * @brief Run an awaited routine as part of the routine which awaits it
+         */
+        class Awaiter {
+            public:
+                bool await_ready() const noexcept { return !m_handle || m_handle.done(); }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> parent) noexcept;
+
+                void await_resume() const noexcept {}
+            private:
+                friend class Routine;
+
+                explicit Awaiter(std::coroutine_handle<promise_type> handle)
+                    : m_handle(handle) {}
+
+                std::coroutine_handle<promise_type> m_handle;
+        };
+
+        /**
+         * @brief Construct an empty Routine, which is already done
+         */
+        Routine() = default;
+        Routine(const Routine& other) = delete;
+        Routine& operator=(const Routine& other) = delete;
+        Routine(Routine&& other) noexcept;
+        Routine& operator=(Routine&& other) noexcept;
+        /**
+         * @brief Destroy the Routine. A routine which hasn't finished is stopped where it is waiting
+         */
+        ~Routine();
+        /**
+         * @brief Check whether the routine has finished
+         *
+         * @return true the routine finished, or is empty
+         * @return false the routine is still running, or hasn't started
+         */
+        bool isDone() const;
+        /**
+         * @brief Wait for the routine to finish, running it as part of the awaiting routine
+         *
+         * @return Awaiter the awaiter used by the compiler
+         */
+        Awaiter operator co_await() && noexcept { return Awaiter(m_handle); }
+    private:
+        friend class RoutineExecutor;
+
+        explicit Routine(std::coroutine_handle<promise_type> handle)
+            : m_handle(handle) {}
+
+        std::coroutine_handle<promise_type> m_handle = nullptr;
+};
+
+/**
+ * @brief What a routine is waiting for, created by waitFor and waitUntil
+ *
+ * The result of co_await is true if the condition was met, and false if the wait timed out. Waiting for a duration
+ * always returns true.
+ */
+class RoutineWait {
+    public:
+        bool await_ready();
+
+        void await_suspend(std::coroutine_handle<Routine::promise_type> handle) noexcept;
+
+        bool await_resume() const noexcept { return !m_timedOut; }
+
+        /**
+         * @brief Check whether the routine can be resumed
+         *
+         * @param now the time, from pros::c::millis
+         * @return true the condition was met, or the wait timed out
+         * @return false the routine has to keep waiting
+         */
+        bool isReady(uint32_t now);
+    private:
+        friend RoutineWait waitFor(Time duration);
+        friend RoutineWait waitUntil(std::function<bool()> condition, Time timeout);
+
+        RoutineWait(std::function<bool()> condition, Time timeout);
+
+        std::function<bool()> m_condition;
+        uint32_t m_timeout;
+        bool m_hasTimeout;
+        uint32_t m_deadline = 0;
+        bool m_timedOut = false;
+};
+
+/**
+ * @brief Wait for a duration
+ *
+ * The routine always gives way to other routines, even if the duration is 0, so waitFor(0_sec) waits for the next
+ * update of the executor.
+ *
+ * @param duration how long to wait, rounded to whole milliseconds
+ * @return RoutineWait the wait, to co_await
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::Routine routine() {
+ *     intake.move(1);
+ *     co_await lemlib::waitFor(500_msec);
+ *     intake.brake();
+ * }
+ * @endcode
+ */
+RoutineWait waitFor(Time duration);
+
+/**
+ * @brief Wait until a condition is true
+ *
+ * The condition is checked straight away, and then once per update of the executor, from the task running the
+ * executor. It should return quickly. If it is already true, the routine doesn't give way to other routines.
+ *
+ * @param condition the condition
+ * @param timeout the longest time to wait, rounded to whole milliseconds. Defaults to waiting forever
+ * @return RoutineWait the wait, to co_await. It returns false if it timed out
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::Routine routine() {
+ *     arm.move(1);
+ *     const bool raised = co_await lemlib::waitUntil([] { return arm.getAngle() > 90_stDeg; }, 1_sec);
+ *     if (!raised) std::cout << "The arm is stuck" << std::endl;
+ *     arm.brake();
+ * }
+ * @endcode
+ */
+RoutineWait waitUntil(std::function<bool()> condition, Time timeout = from_sec(INFINITY));
+
+/**
+ * @brief RoutineExecutor class
+ *
+ * Runs routines cooperatively, in the task which calls update. Every update resumes the routines which are done
+ * waiting, in the order they were added. Registering the update with a ControlScheduler runs every routine at the
+ * rate of the scheduler, with no extra tasks.
+ *
+ * The executor has a fixed capacity. Routines can be added and cancelled from any task, without locking.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::ControlScheduler scheduler(10_msec);
+ * lemlib::RoutineExecutor executor;
+ *
+ * void initialize() {
+ *     scheduler.add([] { executor.update(); }, 10_msec);
+ *     scheduler.start();
+ * }
+ *
+ * void autonomous() {
+ *     executor.add(autonomousRoutine());
+ *     while (executor.getActiveCount() > 0) pros::delay(10);
+ * }
+ * @endcode
+ */
+class RoutineExecutor {
+    public:
+        /** the maximum number of routines an executor can run at once */
+        static constexpr size_t MAX_ROUTINES = 16;
+        /**
+         * @brief Construct a new Routine Executor
+         */
+        RoutineExecutor() = default;
+        RoutineExecutor(const RoutineExecutor& other) = delete;
+        RoutineExecutor& operator=(const RoutineExecutor& other) = delete;
+        /**
+         * @brief Start running a routine
+         *
+         * The routine starts in the next update.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the routine is empty, or already done
+         * ENOMEM: the executor is already running MAX_ROUTINES routines
+         *
+         * @param routine the routine
+         * @return int32_t the index of the routine, which is passed to cancel
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t add(Routine routine);
+        /**
+         * @brief Stop a routine where it is waiting
+         *
+         * The routine is destroyed in the next update, so it is never stopped in the middle of running. The index is
+         * reused once the routine finishes, so it should only be cancelled while it is known to be running.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: there is no routine running with the index
+         *
+         * @param index the index returned by add
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t cancel(int32_t index);
+        /**
+         * @brief Stop every routine where it is waiting
+         */
+        void cancelAll();
+        /**
+         * @brief Get the number of routines which haven't finished
+         *
+         * @return size_t the number of routines
+         */
+        size_t getActiveCount() const;
+        /**
+         * @brief Resume every routine which is done waiting
+         *
+         * This is usually called by a ControlScheduler, but can be called from a loop in any task. It must not be
+         * called from more than one task at once.
+         */
+        void update();
+    private:
+        enum class SlotState : uint8_t { EMPTY, CLAIMED, ACTIVE };
+
+        struct Slot {
+                Routine routine;
+                std::atomic<SlotState> state = SlotState::EMPTY;
+                std::atomic<bool> cancelled = false;
+        };
+
+        /**
+         * @brief Destroy the routine in a slot, and free the slot
+         *
+         * @param slot the slot
+         */
+        void finish(Slot& slot);
+
+        std::array<Slot, MAX_ROUTINES> m_slots;
+        std::atomic<size_t> m_activeCount = 0;
+};
+} // namespace lemlib
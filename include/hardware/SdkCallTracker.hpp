@@ -0,0 +1,76 @@
+#pragma once
+
+#include "pros/rtos.h"
+#include <cstdint>
+#include <cstdio>
+
+namespace lemlib {
+/**
+ * @brief Whether calls to the SDK are being counted
+ *
+ * Counting is only compiled in when LEMLIB_TRACK_SDK_CALLS is defined, which `make TRACK_SDK_CALLS=1` does. Every call
+ * the hardware layer makes to a device through the SDK is then counted, for the port of the device and for the task
+ * which made it. Calls which only read the clock or manage tasks are not counted.
+ *
+ * @return true calls are being counted
+ * @return false counting was not compiled in, so every count is 0
+ */
+bool isTrackingSdkCalls();
+/**
+ * @brief Get the number of SDK calls made by every task, to every device
+ *
+ * @return uint32_t the number of calls
+ */
+uint32_t getSdkCalls();
+/**
+ * @brief Get the number of SDK calls made to the device on a port
+ *
+ * @param port the smart port, from 1 to 21, or DeviceRegistry::BRAIN_ADI_PORT for the ADI ports on the brain.
+ * Devices on an ADI expander are counted for the smart port of the expander
+ * @return uint32_t the number of calls, or 0 if the port is out of range
+ */
+uint32_t getPortSdkCalls(uint8_t port);
+/**
+ * @brief Get the number of SDK calls made by a task
+ *
+ * Only the first 32 tasks which call the SDK are tracked on their own. Calls of every other task are only counted by
+ * getSdkCalls and getPortSdkCalls.
+ *
+ * @param task the task. Defaults to the calling task
+ * @return uint32_t the number of calls
+ */
+uint32_t getTaskSdkCalls(pros::task_t task = pros::c::task_get_current());
+/**
+ * @brief Write the calls of every tracked task, then of every port, as csv, with a header line naming the columns
+ *
+ * @param file the file to write to. Defaults to stdout, which is sent over the serial port
+ * @return int32_t always returns 0
+ */
+int32_t dumpSdkCalls(FILE* file = stdout);
+
+namespace detail {
+/**
+ * @brief Count one SDK call to the device on a port, by the calling task
+ *
+ * Use LEMLIB_SDK_CALL instead of calling this directly, so counting compiles away when tracking is disabled.
+ *
+ * @param port the port of the device. Reversed ports are negative
+ */
+void countSdkCall(int port);
+} // namespace detail
+} // namespace lemlib
+
+/**
+ * @brief Count a call to the SDK for a device, and make it
+ *
+ * Calls are only counted when LEMLIB_TRACK_SDK_CALLS is defined, which `make TRACK_SDK_CALLS=1` does. Otherwise this
+ * expands to the call itself.
+ *
+ * @param port the port of the device
+ * @param call the call, like pros::c::motor_brake(port)
+ */
+#ifdef LEMLIB_TRACK_SDK_CALLS
+#define LEMLIB_SDK_CALL(port, call) (::lemlib::detail::countSdkCall(port), call)
+#else
+#define LEMLIB_SDK_CALL(port, call) (call)
+#endif
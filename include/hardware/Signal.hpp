@@ -0,0 +1,114 @@
+#pragma once
+
+#include "units/core.hpp"
+#include "pros/rtos.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief A condition tasks can sleep on until another task signals that it may have changed
+ *
+ * Waiting tasks register themselves, check their condition, and block on their task notification until the condition
+ * is true. The task which changes the state the condition reads calls notify afterwards, which notifies every
+ * registered task, so waiting uses no CPU, and a waiting task wakes as soon as the scheduler runs it, instead of on
+ * the next iteration of a delay loop. A task registers before it checks the condition, so a change can't slip in
+ * between the check and the wait.
+ *
+ * Waiting uses the notification of the task, which is shared with everything else that notifies it, so a task must
+ * not expect other notifications while it waits. Other notifications only wake it early, and it checks the condition
+ * again. When more than MAX_WAITERS tasks wait at once, the extra ones check their condition every millisecond
+ * instead.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * std::atomic<bool> ready = false;
+ * lemlib::Signal readySignal;
+ *
+ * void producer() {
+ *     ready = true;
+ *     readySignal.notify();
+ * }
+ *
+ * void consumer() {
+ *     if (!readySignal.waitUntil([] { return ready.load(); }, 1_sec)) std::cout << "timed out" << std::endl;
+ * }
+ * @endcode
+ */
+class Signal {
+    public:
+        /** the maximum number of tasks which can sleep on a signal at once */
+        static constexpr size_t MAX_WAITERS = 8;
+
+        Signal() = default;
+        Signal(const Signal& other) = delete;
+        Signal& operator=(const Signal& other) = delete;
+
+        /**
+         * @brief Block the calling task until a condition is true
+         *
+         * @param condition the condition, which is checked once before the task sleeps, and again every time it is
+         * woken. It must be safe to call from the waiting task, and should only read atomics
+         * @param timeout the longest time to wait. Defaults to forever
+         * @return true the condition is true
+         * @return false the timeout elapsed first
+         */
+        template <typename F> bool waitUntil(F&& condition, Time timeout = from_sec(INFINITY)) {
+            const int32_t slot = registerWaiter();
+            const uint32_t start = pros::c::millis();
+            const bool forever = timeout == from_sec(INFINITY);
+            const uint32_t limit = forever ? 0 : toMilliseconds(timeout);
+            bool result = false;
+            while (true) {
+                if (condition()) {
+                    result = true;
+                    break;
+                }
+                const uint32_t elapsed = pros::c::millis() - start;
+                if (!forever && elapsed >= limit) break;
+                sleep(slot, forever ? TIMEOUT_MAX : limit - elapsed);
+            }
+            unregisterWaiter(slot);
+            return result;
+        }
+
+        /**
+         * @brief Wake every task waiting on the signal, so it checks its condition again
+         *
+         * This is a load per waiter slot when no task is waiting, and never blocks, so it can be called from control
+         * loops. It must be called after the state the conditions read has changed.
+         */
+        void notify();
+    private:
+        /**
+         * @brief Claim a waiter slot for the calling task
+         *
+         * @return int32_t the slot, or -1 if every slot is taken
+         */
+        int32_t registerWaiter();
+        /**
+         * @brief Release the slot of the calling task
+         *
+         * @param slot the slot returned by registerWaiter
+         */
+        void unregisterWaiter(int32_t slot);
+        /**
+         * @brief Sleep until the task is notified, or the timeout elapses
+         *
+         * @param slot the slot returned by registerWaiter. Tasks without a slot sleep for 1 ms instead
+         * @param timeout the longest time to sleep, in milliseconds
+         */
+        static void sleep(int32_t slot, uint32_t timeout);
+        /**
+         * @brief Convert a timeout to whole milliseconds
+         *
+         * @param timeout the timeout
+         * @return uint32_t the milliseconds, rounded, and 0 if the timeout is negative
+         */
+        static uint32_t toMilliseconds(Time timeout);
+
+        std::array<std::atomic<pros::task_t>, MAX_WAITERS> m_waiters {};
+};
+} // namespace lemlib
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace lemlib {
+/**
+ * @brief A vector with a fixed capacity, stored inline
+ *
+ * The elements live inside the object, so it never allocates memory, and copying it copies the elements straight into
+ * the new object. Like a vector, elements are constructed when they are added and destroyed when they are removed, so
+ * it can hold types without a default constructor.
+ *
+ * Adding an element to a full StaticVector is a precondition violation. Check full() first.
+ *
+ * @tparam T the type of the elements
+ * @tparam N the capacity
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::StaticVector<Angle, 8> angles;
+ * if (!angles.full()) angles.push_back(motor.getAngle());
+ * @endcode
+ */
+template <typename T, size_t N> class StaticVector {
+    public:
+        using value_type = T;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        /**
+         * @brief Construct a new, empty Static Vector
+         */
+        StaticVector() = default;
+
+        /**
+         * @brief Copy the elements of another Static Vector
+         *
+         * @param other the vector to copy
+         */
+        StaticVector(const StaticVector& other) {
+            for (const T& element : other) push_back(element);
+        }
+
+        /**
+         * @brief Move the elements of another Static Vector. The other vector keeps its moved-from elements
+         *
+         * @param other the vector to move from
+         */
+        StaticVector(StaticVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+            for (T& element : other) push_back(std::move(element));
+        }
+
+        StaticVector& operator=(const StaticVector& other) {
+            if (this == &other) return *this;
+            clear();
+            for (const T& element : other) push_back(element);
+            return *this;
+        }
+
+        StaticVector& operator=(StaticVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+            if (this == &other) return *this;
+            clear();
+            for (T& element : other) push_back(std::move(element));
+            return *this;
+        }
+
+        ~StaticVector() { clear(); }
+
+        /**
+         * @brief Construct an element in place at the end of the vector
+         *
+         * @param args the arguments of the constructor of the element
+         * @return T& the new element
+         */
+        template <typename... Args> T& emplace_back(Args&&... args) {
+            T* element = std::construct_at(data() + m_size, std::forward<Args>(args)...);
+            m_size++;
+            return *element;
+        }
+
+        void push_back(const T& value) { emplace_back(value); }
+
+        void push_back(T&& value) { emplace_back(std::move(value)); }
+
+        void pop_back() { std::destroy_at(data() + --m_size); }
+
+        /**
+         * @brief Remove a range of elements, moving the elements after it forward
+         *
+         * @param first the first element to remove
+         * @param last the element after the last one to remove
+         * @return iterator the element which took the place of the first removed element
+         */
+        iterator erase(const_iterator first, const_iterator last) {
+            iterator target = begin() + (first - begin());
+            const iterator end = std::move(begin() + (last - begin()), this->end(), target);
+            while (this->end() != end) pop_back();
+            return target;
+        }
+
+        void clear() {
+            std::destroy(begin(), end());
+            m_size = 0;
+        }
+
+        size_t size() const { return m_size; }
+
+        static constexpr size_t capacity() { return N; }
+
+        bool empty() const { return m_size == 0; }
+
+        bool full() const { return m_size == N; }
+
+        T* data() { return reinterpret_cast<T*>(m_storage); }
+
+        const T* data() const { return reinterpret_cast<const T*>(m_storage); }
+
+        T& operator[](size_t index) { return data()[index]; }
+
+        const T& operator[](size_t index) const { return data()[index]; }
+
+        T& back() { return data()[m_size - 1]; }
+
+        const T& back() const { return data()[m_size - 1]; }
+
+        iterator begin() { return data(); }
+
+        iterator end() { return data() + m_size; }
+
+        const_iterator begin() const { return data(); }
+
+        const_iterator end() const { return data() + m_size; }
+    private:
+        alignas(T) std::byte m_storage[N * sizeof(T)];
+        size_t m_size = 0;
+};
+} // namespace lemlib
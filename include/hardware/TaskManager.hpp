@@ -0,0 +1,151 @@
+#pragma once
+
+#include "units/core.hpp"
+#include "pros/rtos.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * passed as the priority to the start function of a background task of the library, like DevicePoller::start, to use
+ * the priority the TaskManager has configured for it. It is below TASK_PRIORITY_MIN, so it is never a real priority
+ */
+constexpr uint32_t MANAGED_PRIORITY = 0;
+
+/**
+ * @brief The background tasks of the library which the TaskManager creates
+ */
+enum class TaskRole : uint8_t {
+    /** the task of a DevicePoller */
+    DEVICE_POLLER,
+    /** the task of a ControlScheduler, which also runs the callbacks added to it, like PowerManager::update */
+    CONTROL_SCHEDULER,
+    /** the writer task of a TelemetryLogger */
+    TELEMETRY_LOGGER,
+    /** the I/O task of a FileService */
+    FILE_SERVICE
+};
+
+/**
+ * @brief How the TaskManager creates the task of a role
+ */
+struct TaskConfig {
+        /** the priority of the task, from TASK_PRIORITY_MIN to TASK_PRIORITY_MAX */
+        uint32_t priority = TASK_PRIORITY_DEFAULT;
+        /** the stack depth of the task, in words like task_create. At least TASK_STACK_DEPTH_MIN */
+        uint16_t stackDepth = TASK_STACK_DEPTH_DEFAULT;
+        /** the fraction of each window the task may work for before it is demoted, above 0 and at most 1 */
+        Number budget = 1;
+        /** how long a budget window is */
+        Time window = 100_msec;
+};
+
+/**
+ * @brief TaskManager class
+ *
+ * Creates the background tasks of the library, and keeps them from starving the tasks of the user. Every role has a
+ * priority, a stack depth and a CPU budget, tuned so the loops which need to run on time do, and the work which can
+ * wait does:
+ *
+ * | role              | priority                  | stack  | budget         |
+ * | ----------------- | ------------------------- | ------ | -------------- |
+ * | DEVICE_POLLER     | TASK_PRIORITY_DEFAULT + 1 | 0x2000 | 20% of 100 ms  |
+ * | CONTROL_SCHEDULER | TASK_PRIORITY_DEFAULT + 2 | 0x2000 | 40% of 100 ms  |
+ * | TELEMETRY_LOGGER  | TASK_PRIORITY_MIN + 1     | 0x1000 | 10% of 1000 ms |
+ * | FILE_SERVICE      | TASK_PRIORITY_MIN + 1     | 0x1000 | 10% of 1000 ms |
+ *
+ * The poller and the scheduler run above the default priority of user tasks, so a sample or a control loop is never
+ * late because of driver control. In exchange, a task which works for longer than its budget in a window, like a
+ * scheduler with too many callbacks, is demoted to the lowest priority by the TaskMonitor until the window ends. The
+ * driver control loop then keeps running, and the demoted task catches up whenever the CPU is free. Demotions are
+ * counted in the TaskStats of the task.
+ *
+ * The PROS API doesn't expose the runtime statistics of FreeRTOS, so the work of each task is measured by the
+ * TaskMonitor, which the tasks of every role attach to. The power manager has no task of its own; it runs as a
+ * callback of the scheduler, and shares its budget.
+ *
+ * Configuring a role only affects tasks started afterwards.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * void initialize() {
+ *     lemlib::TaskManager& tasks = lemlib::TaskManager::get();
+ *     // this robot runs a lot of control loops, and has a light driver control loop
+ *     lemlib::TaskConfig scheduler = tasks.getConfig(lemlib::TaskRole::CONTROL_SCHEDULER);
+ *     scheduler.budget = 0.6;
+ *     tasks.configure(lemlib::TaskRole::CONTROL_SCHEDULER, scheduler);
+ *     poller.start();
+ *     controlScheduler.start();
+ * }
+ * @endcode
+ */
+class TaskManager {
+    public:
+        /** the number of roles */
+        static constexpr size_t ROLES = 4;
+
+        TaskManager(const TaskManager& other) = delete;
+        TaskManager& operator=(const TaskManager& other) = delete;
+        /**
+         * @brief Get the task manager
+         *
+         * @return TaskManager& the task manager
+         */
+        static TaskManager& get();
+        /**
+         * @brief Configure how the task of a role is created
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the priority, the stack depth, the budget or the window is out of range
+         *
+         * @param role the role
+         * @param config the config
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t configure(TaskRole role, TaskConfig config);
+        /**
+         * @brief Get how the task of a role is created
+         *
+         * @param role the role
+         * @return TaskConfig the config
+         */
+        TaskConfig getConfig(TaskRole role) const;
+        /**
+         * @brief Create the task of a role, with the stack depth of the role
+         *
+         * @param role the role
+         * @param function the function the task runs. It must call attach first thing
+         * @param parameters passed to the function
+         * @param priority the priority of the task, or MANAGED_PRIORITY to use the priority of the role
+         * @param name the name of the task
+         * @return pros::task_t the task, or nullptr if it could not be created
+         */
+        pros::task_t create(TaskRole role, pros::task_fn_t function, void* parameters, uint32_t priority,
+                            const char* name);
+        /**
+         * @brief Attach the task which calls this function to the TaskMonitor, with the budget of its role
+         *
+         * This is called by the task created by create, first thing, like TaskMonitor::attach.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOSPC: TaskMonitor::MAX_TASKS tasks are already attached
+         *
+         * @param role the role the task was created for
+         * @param name the name of the task
+         * @return int32_t the slot of the task in the TaskMonitor
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t attach(TaskRole role, const char* name);
+    private:
+        TaskManager();
+
+        std::array<TaskConfig, ROLES> m_configs;
+        // the config each role's latest task was created with, which it attaches with
+        std::array<TaskConfig, ROLES> m_created;
+        mutable pros::Mutex m_mutex;
+};
+} // namespace lemlib
@@ -0,0 +1,274 @@
+#pragma once
+
+#include "hardware/TelemetryStream.hpp"
+#include "units/core.hpp"
+#include "pros/rtos.hpp"
+#include <array>
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace lemlib {
+/**
+ * @brief The load and stack use of a task, measured by the TaskMonitor
+ */
+struct TaskStats {
+        /** the name the task was attached with */
+        const char* name = nullptr;
+        /** the fraction of the time between the two latest samples the task spent working, from 0 to 1 */
+        Number cpuLoad = 0;
+        /** the longest single piece of work between the two latest samples */
+        Time maxWork = 0_sec;
+        /** the size of the stack of the task, in bytes */
+        size_t stackSize = 0;
+        /**
+         * the least stack the task has ever had free, in bytes. It only counts the part of the stack which could be
+         * painted, so the real headroom is slightly larger
+         */
+        size_t stackHeadroom = 0;
+        /** the fraction of each budget window the task may work for, or 0 if it has no budget */
+        Number budget = 0;
+        /** how many times the task was demoted for going over its budget since it attached */
+        uint32_t throttles = 0;
+};
+
+/**
+ * @brief TaskMonitor class
+ *
+ * Shows how much headroom the brain has for more loops. Every task which is monitored attaches itself when it starts,
+ * and wraps the work of each loop in a TaskMonitor::Work. The monitor samples the time every task spent working
+ * periodically, and how deep its stack has ever been, and publishes both through a TelemetryStream. The tasks of the
+ * DevicePoller, the ControlScheduler and the TelemetryLogger attach themselves, and user tasks can too.
+ *
+ * The PROS API doesn't expose the runtime statistics or the stack high-water marks of FreeRTOS, so both are measured
+ * by the monitor itself. Working time is measured with pros::micros around each Work. The stack is measured like
+ * FreeRTOS does: attaching fills the unused part of the stack of the task with a pattern, and each sample scans it
+ * for the deepest word the task has overwritten.
+ *
+ * Recording work is two reads of the clock and two relaxed atomic operations, so it never locks.
+ *
+ * A task can also be given a CPU budget, a fraction of a window of time it may spend working. Once its work in a
+ * window goes over the budget, the task is demoted to the lowest priority until the window ends, so it only runs when
+ * nothing else wants the CPU. Its priority is restored by the first Work of the next window. The TaskManager gives the
+ * tasks of the library their budgets.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::TelemetryStream stream;
+ *
+ * void intakeTask(void*) {
+ *     // attach first thing, before the task uses much of its stack
+ *     const int32_t slot = lemlib::TaskMonitor::get().attach("intake");
+ *     while (true) {
+ *         {
+ *             lemlib::TaskMonitor::Work work(slot);
+ *             // run the intake
+ *         }
+ *         pros::delay(10);
+ *     }
+ * }
+ *
+ * void opcontrol() {
+ *     lemlib::TaskMonitor& monitor = lemlib::TaskMonitor::get();
+ *     monitor.start();
+ *     const int32_t channels = monitor.addChannels(stream);
+ *     while (true) {
+ *         monitor.publish(stream, channels);
+ *         stream.send();
+ *         pros::delay(100);
+ *     }
+ * }
+ * @endcode
+ */
+class TaskMonitor {
+    public:
+        /** the most tasks which can be attached at once */
+        static constexpr size_t MAX_TASKS = 12;
+
+        /**
+         * @brief Measures a piece of work of a task, from its construction to its destruction
+         */
+        class Work {
+            public:
+                /**
+                 * @brief Start measuring a piece of work
+                 *
+                 * @param slot the slot returned by attach. Slots which aren't valid, like INT_MAX, are ignored
+                 */
+                Work(int32_t slot);
+                Work(const Work& other) = delete;
+                Work& operator=(const Work& other) = delete;
+                /**
+                 * @brief Finish measuring the piece of work
+                 */
+                ~Work();
+            private:
+                const int32_t m_slot;
+                const uint64_t m_start;
+        };
+
+        TaskMonitor(const TaskMonitor& other) = delete;
+        TaskMonitor& operator=(const TaskMonitor& other) = delete;
+        /**
+         * @brief Get the task monitor
+         *
+         * @return TaskMonitor& the task monitor
+         */
+        static TaskMonitor& get();
+        /**
+         * @brief Attach the task which calls this function to the monitor
+         *
+         * The stack below the caller is painted, so call this first thing in the task, and pass the stack depth the
+         * task was created with. A larger depth than the real one would paint past the end of the stack.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOSPC: MAX_TASKS tasks are already attached
+         *
+         * @param name the name of the task. It is copied, and cut short to fit in a channel name
+         * @param stackDepth the stack depth the task was created with, in words like task_create
+         * @return int32_t the slot of the task, for Work and detach
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t attach(const char* name, uint32_t stackDepth = TASK_STACK_DEPTH_DEFAULT);
+        /**
+         * @brief Give the task which calls this function a CPU budget
+         *
+         * The priority the task has now is the one it gets back at the end of a window it was demoted in. The task
+         * must call this itself, after attaching. The budget is measured in wall time between the construction and
+         * the destruction of each Work, so time the task was preempted for counts too.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the slot is not attached, the budget is not above 0 and at most 1, or the window is not positive
+         *
+         * @param slot the slot returned by attach
+         * @param budget the fraction of each window the task may work for. 1 never demotes the task
+         * @param window how long a window is
+         * @return int32_t 0 on success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t setBudget(int32_t slot, Number budget, Time window);
+        /**
+         * @brief Detach a task, before it exits
+         *
+         * @param slot the slot returned by attach. Slots which aren't valid are ignored
+         */
+        void detach(int32_t slot);
+        /**
+         * @brief Sample the load and the stack of every attached task
+         *
+         * This is called periodically by the monitor task, but can also be called manually if the task is not
+         * started.
+         *
+         * @return int32_t always returns 0
+         */
+        int32_t update();
+        /**
+         * @brief Get the stats of every attached task, from the latest sample
+         *
+         * @param buffer the buffer to write to
+         * @return int32_t the number of tasks written to the buffer
+         */
+        int32_t getStats(std::span<TaskStats> buffer) const;
+        /**
+         * @brief Get the combined load of every attached task, from the latest sample
+         *
+         * @return Number the fraction of the time any attached task was working, from 0 to 1
+         */
+        Number getCpuLoad() const;
+        /**
+         * @brief Add channels for the tasks which are attached to a stream
+         *
+         * A "cpu" channel holds the combined load, and every task gets a ".cpu" channel with its load and a ".stack"
+         * channel with its stack headroom, in bytes. Tasks which are attached later are not added. The monitor only
+         * remembers the tasks of the last stream it added channels to.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOSPC: the stream doesn't have room for every channel
+         *
+         * @param stream the stream
+         * @return int32_t the index of the first channel, for publish
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t addChannels(TelemetryStream& stream);
+        /**
+         * @brief Set the channels added by addChannels to the latest sample
+         *
+         * @param stream the stream
+         * @param first the index returned by addChannels
+         */
+        void publish(TelemetryStream& stream, int32_t first) const;
+        /**
+         * @brief Start sampling in a task
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EBUSY: the monitor is already running
+         * ENOMEM: the task could not be created
+         *
+         * @param period how often to sample. Defaults to 1 second
+         * @param priority the priority of the task. Defaults to the lowest priority, so sampling never delays a loop
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t start(Time period = 1_sec, uint32_t priority = TASK_PRIORITY_MIN);
+        /**
+         * @brief Stop the monitor task
+         *
+         * This function blocks until the current sample finishes
+         */
+        void stop();
+    private:
+        TaskMonitor() = default;
+        /**
+         * @brief the function run by the monitor task
+         *
+         * @param monitor pointer to the monitor
+         */
+        static void taskFunction(void* monitor);
+
+        struct Slot {
+                // set once the rest of the slot is written by attach, and cleared by detach
+                std::atomic<bool> used = false;
+                std::array<char, TelemetryStream::MAX_NAME_LENGTH + 1> name {};
+                // the names of the channels of the task
+                std::array<char, TelemetryStream::MAX_NAME_LENGTH + 1> cpuChannel {};
+                std::array<char, TelemetryStream::MAX_NAME_LENGTH + 1> stackChannel {};
+                // the index of the load channel of the task in the last stream channels were added to, or INT_MAX
+                int32_t streamChannel = INT_MAX;
+                size_t stackSize = 0;
+                // the painted part of the stack, from its lowest address up to where painting stopped
+                uintptr_t paintedBottom = 0;
+                uintptr_t paintedTop = 0;
+                // written by Work
+                std::atomic<uint64_t> busy = 0;
+                std::atomic<uint32_t> maxWork = 0;
+                // the budget, only touched by the task itself after setBudget. A budget of 0 means there is none
+                pros::task_t task = nullptr;
+                uint32_t priority = TASK_PRIORITY_DEFAULT;
+                uint64_t budgetMicros = 0;
+                uint64_t windowMicros = 0;
+                uint64_t windowStart = 0;
+                uint64_t windowBusy = 0;
+                bool throttled = false;
+                std::atomic<uint32_t> throttles = 0;
+                // written by update
+                uint64_t lastBusy = 0;
+                TaskStats stats;
+        };
+
+        std::array<Slot, MAX_TASKS> m_slots;
+        // protects attaching and the stats written by update
+        mutable pros::Mutex m_mutex;
+        uint64_t m_lastSample = 0;
+        Number m_cpuLoad = 0;
+        Time m_period = 1_sec;
+        // the task is not deleted from outside, as it could be holding a mutex. Instead it is asked to exit
+        std::atomic<bool> m_running = false;
+        std::atomic<bool> m_taskExited = true;
+};
+} // namespace lemlib
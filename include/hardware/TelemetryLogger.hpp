@@ -0,0 +1,214 @@
+#pragma once
+
+#include "hardware/Motor/Motor.hpp"
+#include "hardware/TaskManager.hpp"
+#include "units/Angle.hpp"
+#include "pros/rtos.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <span>
+
+namespace lemlib {
+/**
+ * @brief The kind of device a telemetry record came from, which decides what its values mean
+ */
+enum class TelemetryKind : uint8_t {
+    /** values chosen by the user */
+    CUSTOM = 0,
+    /** angle in degrees, velocity in rpm, current in amps, and temperature in degrees celsius */
+    MOTOR = 1,
+    /** rotation in degrees */
+    IMU = 2,
+    /** angle in degrees */
+    ENCODER = 3,
+};
+
+/**
+ * @brief A fixed-size binary telemetry record
+ *
+ * Records are written to the log file exactly as they are laid out in memory, which is little-endian on the brain.
+ */
+struct TelemetryRecord {
+        /** when the record was made, in microseconds since the program started. Wraps after about 71 minutes */
+        uint32_t timestamp = 0;
+        /** an id chosen by the user, to tell devices of the same kind apart */
+        uint16_t device = 0;
+        TelemetryKind kind = TelemetryKind::CUSTOM;
+        /** set to 1 if any value could not be read */
+        uint8_t error = 0;
+        float values[4] = {};
+};
+
+static_assert(sizeof(TelemetryRecord) == 24, "telemetry records are written as raw 24 byte structs");
+
+/**
+ * @brief TelemetryLogger class
+ *
+ * Printing telemetry with std::cout blocks the printing task on formatting, and on the serial FIFO. The logger takes
+ * fixed-size binary records instead, which a control task pushes into a lock-free ring in constant time. A low
+ * priority task drains the ring once per period, and writes the records to a file in large batches.
+ *
+ * The ring has a single producer: only one task may push records to a logger at a time. If the ring is full, new
+ * records are dropped and counted, so a slow SD card never blocks the control task.
+ *
+ * The file starts with a 16 byte header: the characters "LLOG", the format version and the record size as 16 bit
+ * integers, and 8 reserved bytes. The records follow it back to back.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::Motor motor(1, 200_rpm);
+ * lemlib::V5InertialSensor imu(2);
+ * lemlib::TelemetryLogger logger;
+ *
+ * void autonomous() {
+ *     logger.start("/usd/auton.bin");
+ *     while (true) {
+ *         logger.logMotor(1, motor.getTelemetry());
+ *         logger.logIMU(2, imu.getRotation());
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class TelemetryLogger {
+    public:
+        /** the version of the file format */
+        static constexpr uint16_t FORMAT_VERSION = 1;
+        /**
+         * @brief Construct a new Telemetry Logger
+         *
+         * The ring is allocated here, so pushing records never allocates memory
+         *
+         * @param capacity the number of records the ring can hold, rounded up to a power of 2. Defaults to 1024
+         * @param period how often the ring is written to the file. Defaults to 50 ms
+         */
+        TelemetryLogger(size_t capacity = 1024, Time period = 50_msec);
+        TelemetryLogger(const TelemetryLogger& other) = delete;
+        TelemetryLogger& operator=(const TelemetryLogger& other) = delete;
+        /**
+         * @brief Destroy the Telemetry Logger, writing every remaining record and closing the file
+         */
+        ~TelemetryLogger();
+        /**
+         * @brief Push a record into the ring
+         *
+         * This function does not lock, and takes constant time. Only one task may push records at a time.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOBUFS: the ring is full, so the record was dropped
+         *
+         * @param record the record
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t push(const TelemetryRecord& record);
+        /**
+         * @brief Push a record of a motor
+         *
+         * @param device the id of the motor
+         * @param telemetry a snapshot of the motor, from Motor::getTelemetry
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno like push
+         */
+        int32_t logMotor(uint16_t device, const MotorTelemetry& telemetry);
+        /**
+         * @brief Push a record of every motor of a motor group
+         *
+         * @param firstDevice the id of the first motor. The other motors get the ids after it
+         * @param telemetry snapshots of the motors, from MotorGroup::getTelemetry
+         * @return 0 every record was pushed
+         * @return INT_MAX error occurred, setting errno like push
+         */
+        int32_t logMotors(uint16_t firstDevice, std::span<const MotorTelemetry> telemetry);
+        /**
+         * @brief Push a record of an IMU
+         *
+         * @param device the id of the IMU
+         * @param rotation the rotation of the IMU, from IMU::getRotation
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno like push
+         */
+        int32_t logIMU(uint16_t device, Angle rotation);
+        /**
+         * @brief Push a record of an encoder
+         *
+         * @param device the id of the encoder
+         * @param angle the angle of the encoder, from Encoder::getAngle
+         * @return 0 success
+         * @return INT_MAX error occurred, setting errno like push
+         */
+        int32_t logEncoder(uint16_t device, Angle angle);
+        /**
+         * @brief Get the number of records which were dropped because the ring was full
+         *
+         * @return uint32_t the number of dropped records
+         */
+        uint32_t getDropped() const;
+        /**
+         * @brief Get the number of records written to the file
+         *
+         * @return uint32_t the number of written records
+         */
+        uint32_t getWritten() const;
+        /**
+         * @brief Open the log file, and start the writer task
+         *
+         * Records pushed before the logger is started are written once it starts, if they still fit in the ring. The
+         * task is created by the TaskManager, with the stack depth and the CPU budget of its role
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EBUSY: the logger is already running
+         * ENOMEM: the task could not be created
+         * any errno set by fopen, like ENXIO when there is no SD card
+         *
+         * @param path the path of the log file, like "/usd/log.bin". It is overwritten
+         * @param priority the priority of the writer task. Defaults to the priority the TaskManager configures for
+         * TaskRole::TELEMETRY_LOGGER, just above the lowest priority so it never delays control tasks
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t start(const char* path, uint32_t priority = MANAGED_PRIORITY);
+        /**
+         * @brief Stop the writer task, writing every remaining record and closing the file
+         *
+         * This function blocks until the records have been written
+         */
+        void stop();
+    private:
+        /**
+         * @brief the function run by the writer task
+         *
+         * @param logger pointer to the logger
+         */
+        static void taskFunction(void* logger);
+        /**
+         * @brief Write every record in the ring to the file
+         *
+         * Only the writer task, or stop once the task has exited, may call this function
+         */
+        void drain();
+
+        /** the number of records written to the file at once */
+        static constexpr size_t BATCH_SIZE = 128;
+
+        const Time m_period;
+        const uint32_t m_mask;
+        const std::unique_ptr<TelemetryRecord[]> m_ring;
+        // the producer only writes the head, and the writer task only writes the tail
+        std::atomic<uint32_t> m_head = 0;
+        std::atomic<uint32_t> m_tail = 0;
+        std::atomic<uint32_t> m_dropped = 0;
+        std::atomic<uint32_t> m_written = 0;
+        std::array<TelemetryRecord, BATCH_SIZE> m_batch;
+        FILE* m_file = nullptr;
+        pros::Mutex m_mutex;
+        std::atomic<bool> m_running = false;
+        std::atomic<bool> m_taskExited = true;
+};
+} // namespace lemlib
@@ -0,0 +1,370 @@
+#pragma once
+
+#include "units/Pose.hpp"
+#include "units/core.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+
+namespace lemlib {
+/**
+ * @brief The type of a telemetry stream frame, which is its first byte
+ *
+ * SCHEMA frames describe the channels, KEY frames hold the value of every channel, and DELTA frames hold how much the
+ * channels which were sent changed since they were last sent.
+ */
+enum class StreamFrameType : uint8_t { SCHEMA = 1, KEY = 2, DELTA = 3 };
+
+/**
+ * @brief TelemetryStream class
+ *
+ * Printing quantities with operator<< formats text with the names of their units, which is too slow and too large to
+ * stream many devices at 100 Hz. A telemetry stream sends compact binary frames instead. Every channel is a value
+ * rounded to a fixed resolution, like 0.01 degrees. Most frames only hold how much each channel changed since the last
+ * frame, as a variable length integer, so a channel which barely changed takes a single byte.
+ *
+ * Each frame is COBS encoded and ends with a 0 byte, so a decoder which starts listening mid-stream, or misses bytes,
+ * finds the start of the next frame. Every frame also has a sequence number and a checksum. A key frame is sent every
+ * few frames so a decoder can recover from a lost frame, and the schema, which names the channels and their
+ * resolutions, is sent before the first key frame and every few key frames after it.
+ *
+ * A link with little bandwidth, like the radio of a controller, can be given a budget in bytes per second. Frames are
+ * then only sent when the budget allows it, and when frames had to be held back, channels with a lower priority are
+ * decimated, so they are only sent every 2, 4, 8 or more delta frames, and the channels with a higher priority can be
+ * sent more often in the smaller frames. Channels which didn't change since they were last sent are never in delta
+ * frames, budget or not.
+ *
+ * Frames are built without allocating memory. A stream is not thread safe: a single task should set its channels and
+ * send its frames.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::Motor motor(1, 200_rpm);
+ * lemlib::TelemetryStream stream;
+ *
+ * void opcontrol() {
+ *     const int32_t angle = stream.addChannel("angle", 0.01_stDeg);
+ *     const int32_t current = stream.addChannel("current", 0.001_amp);
+ *     while (true) {
+ *         stream.set(angle, motor.getAngle());
+ *         stream.set(current, motor.getCurrent());
+ *         stream.send();
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class TelemetryStream {
+    public:
+        /** the version of the frame format */
+        static constexpr uint8_t FORMAT_VERSION = 2;
+        /** the most channels a stream can have */
+        static constexpr size_t MAX_CHANNELS = 32;
+        /** the longest channel name, in characters. Longer names are cut short */
+        static constexpr size_t MAX_NAME_LENGTH = 31;
+        /** the largest a frame can be once it is encoded, including the 0 byte at its end */
+        static constexpr size_t MAX_FRAME_SIZE = 1536;
+        /** the highest priority of a channel. Channels with this priority are the last to be decimated */
+        static constexpr uint8_t MAX_PRIORITY = 7;
+        /**
+         * @brief Construct a new Telemetry Stream
+         *
+         * @param keyFrameInterval how many frames are sent per key frame. Defaults to 50, so a decoder recovers from a
+         * lost frame within half a second at 100 Hz
+         * @param schemaInterval how many key frames are sent per schema. Defaults to 10
+         */
+        TelemetryStream(uint32_t keyFrameInterval = 50, uint32_t schemaInterval = 10);
+        /**
+         * @brief Add a channel to the stream
+         *
+         * Adding a channel makes the stream send its schema and a key frame next, so decoders learn about it.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOSPC: the stream already has MAX_CHANNELS channels
+         * EINVAL: the resolution is not finite and positive
+         *
+         * @param name the name of the channel. It must outlive the stream, like a string literal
+         * @param resolution the resolution of the channel, in SI units
+         * @return int32_t the index of the channel
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t addChannel(const char* name, double resolution);
+        /**
+         * @brief Add a channel to the stream
+         *
+         * @param name the name of the channel. It must outlive the stream, like a string literal
+         * @param resolution the resolution of the channel, like 0.01_stDeg
+         * @return int32_t the index of the channel
+         * @return INT_MAX error occurred, setting errno like addChannel
+         */
+        template <isQuantity Q> int32_t addChannel(const char* name, Q resolution) {
+            return addChannel(name, resolution.internal());
+        }
+        /**
+         * @brief Add 3 channels for the x, y, and orientation of a pose
+         *
+         * @param name the name of the pose. The channels are named after it, with ".x", ".y" and ".theta" afterwards
+         * @param linear the resolution of x and y
+         * @param angular the resolution of the orientation
+         * @return int32_t the index of the x channel. The y and orientation channels come right after it
+         * @return INT_MAX error occurred, setting errno like addChannel
+         */
+        int32_t addPose(const char* name, Length linear = 0.1_mm, Angle angular = 0.01_stDeg);
+        /**
+         * @brief Get the number of channels
+         *
+         * @return size_t the number of channels
+         */
+        size_t getChannelCount() const;
+        /**
+         * @brief Set how many bytes per second the stream may send
+         *
+         * The budget is enforced with a token bucket, which can hold a quarter of a second of bytes, so short bursts,
+         * like a schema, are smoothed out over the next frames. Once a second, the decimation of the channels is
+         * raised if frames were held back, or lowered if less than a third of the budget was used.
+         *
+         * @param bytesPerSecond the budget, including the COBS overhead and the 0 byte of every frame. 0 removes the
+         * budget, which is the default
+         */
+        void setBandwidth(uint32_t bytesPerSecond);
+        /**
+         * @brief Set the priority of a channel
+         *
+         * When the stream is over its budget, a channel with priority p is sent every 2^(level - p) delta frames,
+         * where the level starts at 0 and is raised by 1 every second the stream doesn't fit, so the channels with the
+         * lowest priority are decimated first. The level never passes the highest priority of any channel, so those
+         * channels are in every frame, and only the frame rate drops. Channels are added with priority 0, so a stream
+         * whose priorities are never set is never decimated.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EINVAL: the channel is out of range, or the priority is higher than MAX_PRIORITY
+         *
+         * @param channel the index of the channel
+         * @param priority the priority, from 0 to MAX_PRIORITY
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t setPriority(size_t channel, uint8_t priority);
+        /**
+         * @brief Get how many delta frames a channel is currently sent in, one out of
+         *
+         * @param channel the index of the channel
+         * @return uint32_t the decimation. 1 when the channel is sent in every frame, and 0 if the channel is out of
+         * range
+         */
+        uint32_t getDecimation(size_t channel) const;
+        /**
+         * @brief Set the value of a channel, which is sent in the next frame
+         *
+         * A value which is not finite, like INFINITY from a disconnected device, is sent as missing.
+         *
+         * @param channel the index of the channel. Indices which are out of range are ignored
+         * @param value the value, in SI units
+         */
+        void set(size_t channel, double value);
+        /**
+         * @brief Set the value of a channel, which is sent in the next frame
+         *
+         * @param channel the index of the channel
+         * @param value the value
+         */
+        template <isQuantity Q> void set(size_t channel, Q value) { set(channel, value.internal()); }
+        /**
+         * @brief Set the value of a pose added with addPose
+         *
+         * @param channel the index of the x channel, returned by addPose
+         * @param pose the pose
+         */
+        void setPose(size_t channel, units::Pose pose);
+        /**
+         * @brief Encode the next frame
+         *
+         * This encodes the schema, a key frame or a delta frame, depending on how many frames have been encoded. Call
+         * it until it returns 0 to get every frame due, or use send instead. When the stream has a budget, nothing is
+         * encoded until the budget allows it, and the values stay due.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * ENOBUFS: the buffer is too small. The frame stays due, and is encoded by the next call
+         *
+         * @param timestamp when the values were measured, in microseconds. The budget is measured with it too
+         * @param buffer the buffer to encode the frame into. MAX_FRAME_SIZE bytes always fits a frame
+         * @return int32_t the size of the frame, or 0 if every frame due has been encoded
+         * @return INT_MAX error occurred, setting errno
+         */
+        int32_t encode(uint32_t timestamp, std::span<uint8_t> buffer);
+        /**
+         * @brief Encode the current values, and write them to a file
+         *
+         * On the brain, PROS frames stdout itself by default. Call pros::c::serctl(SERCTL_DISABLE_COBS, nullptr) first
+         * to stream raw frames over the serial port.
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EIO: the frames could not be written
+         *
+         * @param file the file to write to. Defaults to stdout
+         * @return int32_t 0 on success
+         * @return INT_MAX on failure, setting errno
+         */
+        int32_t send(FILE* file = stdout);
+    private:
+        /**
+         * @brief Write the contents of the next frame, before it is COBS encoded
+         *
+         * @param timestamp the timestamp of the frame
+         * @param frame the buffer to write the contents to
+         * @return size_t the size of the contents
+         */
+        size_t writeFrame(uint32_t timestamp, std::span<uint8_t> frame);
+        /**
+         * @brief Refill the budget, and adjust the decimation once a second
+         *
+         * @param timestamp the current time, in microseconds
+         * @return true a frame can be sent
+         * @return false the budget is used up
+         */
+        bool updateBudget(uint32_t timestamp);
+
+        struct Channel {
+                const char* name;
+                double resolution;
+                int32_t value;
+                int32_t sent;
+                bool valid;
+                // whether the value the decoder has is valid
+                bool sentValid;
+                uint8_t priority;
+        };
+
+        const uint32_t m_keyFrameInterval;
+        const uint32_t m_schemaInterval;
+        std::array<Channel, MAX_CHANNELS> m_channels {};
+        size_t m_channelCount = 0;
+        // every pose channel needs its own name, so they are stored here
+        std::array<std::array<char, MAX_NAME_LENGTH + 1>, MAX_CHANNELS> m_poseNames {};
+        uint32_t m_lastTimestamp = 0;
+        uint32_t m_framesSinceKey = 0;
+        uint32_t m_keysSinceSchema = 0;
+        bool m_schemaDue = true;
+        bool m_keyDue = true;
+        bool m_dataDue = false;
+        uint8_t m_sequence = 0;
+        // the budget in bytes per second, or 0 if there is none
+        uint32_t m_bandwidth = 0;
+        // the bytes which can still be sent, times a million, so a few microseconds of budget aren't rounded away. It
+        // goes negative after a frame larger than what was left
+        int64_t m_tokens = 0;
+        uint32_t m_lastRefill = 0;
+        uint32_t m_windowStart = 0;
+        uint32_t m_windowBytes = 0;
+        bool m_heldBack = false;
+        // how far the channels are decimated. A channel with priority p is sent every 2^(level - p) delta frames
+        uint8_t m_level = 0;
+        // counts delta frames, to pick the channels which are sent in each
+        uint32_t m_deltaIndex = 0;
+        std::array<uint8_t, MAX_FRAME_SIZE> m_frame {};
+        std::array<uint8_t, MAX_FRAME_SIZE> m_encoded {};
+};
+
+/**
+ * @brief TelemetryStreamDecoder class
+ *
+ * Decodes the frames of a telemetry stream, on the host or on another brain. Bytes are pushed in as they arrive, and
+ * the decoder reassembles the frames. It starts with no channels until it has received a schema, and only decodes
+ * delta frames once it has received a key frame after the last lost frame.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::TelemetryStreamDecoder decoder;
+ * int byte;
+ * while ((byte = std::getchar()) != EOF) {
+ *     const int32_t type = decoder.push(byte);
+ *     if (type == int32_t(lemlib::StreamFrameType::KEY) || type == int32_t(lemlib::StreamFrameType::DELTA)) {
+ *         std::printf("%f\n", decoder.getValue(0));
+ *     }
+ * }
+ * @endcode
+ */
+class TelemetryStreamDecoder {
+    public:
+        /**
+         * @brief Push a received byte
+         *
+         * This function uses the following values of errno when an error state is reached:
+         *
+         * EPROTO: the frame which just ended is malformed, or its checksum is wrong
+         * ENODATA: the frame which just ended can not be decoded yet, because there is no schema, or a frame was lost
+         * ENOBUFS: the frame which just ended is longer than TelemetryStream::MAX_FRAME_SIZE
+         *
+         * @param byte the byte
+         * @return int32_t the type of the frame which just ended as a StreamFrameType, if it was decoded
+         * @return 0 no frame has ended yet
+         * @return INT_MAX the frame which just ended could not be decoded, setting errno
+         */
+        int32_t push(uint8_t byte);
+        /**
+         * @brief Decode a single frame
+         *
+         * @param frame the COBS encoded frame, without the 0 byte at its end
+         * @return int32_t the type of the frame, as a StreamFrameType
+         * @return INT_MAX error occurred, setting errno like push
+         */
+        int32_t decode(std::span<const uint8_t> frame);
+        /**
+         * @brief Get the number of channels in the last schema
+         *
+         * @return size_t the number of channels
+         */
+        size_t getChannelCount() const;
+        /**
+         * @brief Get the name of a channel
+         *
+         * @param channel the index of the channel
+         * @return const char* the name, or nullptr if the index is out of range
+         */
+        const char* getName(size_t channel) const;
+        /**
+         * @brief Get the last value of a channel
+         *
+         * @param channel the index of the channel
+         * @return double the value in SI units, or INFINITY if it is missing or the index is out of range
+         */
+        double getValue(size_t channel) const;
+        /**
+         * @brief Get the timestamp of the last frame
+         *
+         * @return uint32_t the timestamp, in microseconds
+         */
+        uint32_t getTimestamp() const;
+        /**
+         * @brief Get the number of frames which were lost or malformed
+         *
+         * @return uint32_t the number of bad frames
+         */
+        uint32_t getErrors() const;
+    private:
+        struct Channel {
+                std::array<char, TelemetryStream::MAX_NAME_LENGTH + 1> name;
+                double resolution;
+                int32_t value;
+                bool valid;
+        };
+
+        std::array<Channel, TelemetryStream::MAX_CHANNELS> m_channels {};
+        size_t m_channelCount = 0;
+        bool m_hasSchema = false;
+        bool m_synced = false;
+        uint8_t m_sequence = 0;
+        uint32_t m_timestamp = 0;
+        uint32_t m_errors = 0;
+        std::array<uint8_t, TelemetryStream::MAX_FRAME_SIZE> m_buffer {};
+        std::array<uint8_t, TelemetryStream::MAX_FRAME_SIZE> m_decoded {};
+        size_t m_size = 0;
+        bool m_overflow = false;
+};
+} // namespace lemlib
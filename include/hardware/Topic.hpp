@@ -0,0 +1,129 @@
+#pragma once
+
+#include "hardware/DoubleBuffer.hpp"
+#include "hardware/Signal.hpp"
+#include "units/core.hpp"
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief A value published by one task and read by any number of others, with a version to tell when it changed
+ *
+ * Poses, headings and telemetry are produced by one loop and consumed by many tasks, which would otherwise each poll
+ * the producer, and lock it, to find out whether anything changed. A topic keeps the latest value in a DoubleBuffer, so
+ * reading it never locks and never waits on the publisher. Every publish increments the version, so a consumer which
+ * remembers the version it last saw can tell whether the value changed with a single load, and can sleep until the
+ * next publish, as the topic notifies a Signal every time it is published.
+ *
+ * Only one task may publish to a topic.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::Topic<units::Pose> pose;
+ *
+ * void odometryTask() {
+ *     pose.publish(odom.getPose());
+ * }
+ *
+ * void displayTask() {
+ *     uint32_t version = 0;
+ *     units::Pose latest;
+ *     while (pose.waitForNext(version, latest)) std::cout << to_in(latest.x) << std::endl;
+ * }
+ *
+ * void autonomousTask() {
+ *     // only the field which is needed is read, without copying the whole pose
+ *     const Length x = pose.read([](const units::Pose& p) { return p.x; });
+ * }
+ * @endcode
+ *
+ * @tparam T the type of the value. It has to be trivially copyable, like the units types and telemetry structs
+ */
+template <typename T> class Topic {
+    public:
+        /**
+         * @brief Construct a new Topic
+         *
+         * @param initial the value readers get before anything is published. Its version is 0
+         */
+        explicit Topic(const T& initial = T())
+            : m_buffer(initial) {}
+
+        Topic(const Topic& other) = delete;
+        Topic& operator=(const Topic& other) = delete;
+
+        /**
+         * @brief Publish a new value, and wake every task waiting for it
+         *
+         * Only one task may publish to the topic. This never blocks.
+         *
+         * @param value the value
+         */
+        void publish(const T& value) {
+            m_buffer.write(value);
+            m_signal.notify();
+        }
+
+        /**
+         * @brief Get the latest value
+         *
+         * This function does not lock, and can be called from any task.
+         *
+         * @return T the latest value
+         */
+        T read() const { return m_buffer.read(); }
+
+        /**
+         * @brief Read part of the latest value in place, without copying all of it
+         *
+         * The reader may be called more than once, if the value is published while it runs, so it has to be cheap and
+         * free of side effects.
+         *
+         * @param reader the function, which takes a const T& and returns what it read from it
+         * @return the result of the reader
+         */
+        template <typename F> auto read(F&& reader) const { return m_buffer.read(reader); }
+
+        /**
+         * @brief Get the version of the latest value, which is the number of values published
+         *
+         * @return uint32_t the version. Wraps around on overflow
+         */
+        uint32_t getVersion() const { return m_buffer.getSequence(); }
+
+        /**
+         * @brief Get the latest value, if it is newer than the version the caller last saw
+         *
+         * @param version the version the caller last saw, which is updated to the version of the value
+         * @param value set to the latest value, if it is newer
+         * @return true the value is newer
+         * @return false the value hasn't changed, so nothing was copied
+         */
+        bool readIfNewer(uint32_t& version, T& value) const {
+            if (m_buffer.getSequence() == version) return false;
+            value = m_buffer.read(version);
+            return true;
+        }
+
+        /**
+         * @brief Block the calling task until a value newer than the version the caller last saw is published
+         *
+         * The task sleeps on its notification while it waits, so it must not expect other notifications meanwhile. If
+         * a newer value was already published, this returns it right away.
+         *
+         * @param version the version the caller last saw, which is updated to the version of the value
+         * @param value set to the newer value
+         * @param timeout the longest time to wait. Defaults to forever
+         * @return true a newer value was read
+         * @return false the timeout elapsed first
+         */
+        bool waitForNext(uint32_t& version, T& value, Time timeout = from_sec(INFINITY)) const {
+            if (readIfNewer(version, value)) return true;
+            return m_signal.waitUntil([&] { return readIfNewer(version, value); }, timeout);
+        }
+    private:
+        DoubleBuffer<T> m_buffer;
+        // waiting only registers the task in the signal, so readers can wait on a const topic
+        mutable Signal m_signal;
+};
+} // namespace lemlib
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "pros/rtos.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// the number of events the runtime trace keeps. Once it is full, the oldest events are overwritten
+#ifndef LEMLIB_TRACE_SIZE
+#define LEMLIB_TRACE_SIZE 4096
+#endif
+
+namespace lemlib {
+/**
+ * @brief Record a span of the runtime trace, which ended just now
+ *
+ * Use LEMLIB_TRACE_SCOPE instead of calling this directly, so the trace compiles away when it is disabled. Recording
+ * never locks and never allocates, so it can be called from any task.
+ *
+ * @param name the name of the span. It must outlive the trace, like a string literal
+ * @param start when the span started, from pros::c::micros
+ */
+void recordTrace(const char* name, uint64_t start);
+
+/**
+ * @brief Records the enclosing scope as a span of the runtime trace
+ *
+ * Use LEMLIB_TRACE_SCOPE instead of creating these directly, so the trace compiles away when it is disabled.
+ */
+class ScopedTrace {
+    public:
+        /**
+         * @brief Start the span
+         *
+         * @param name the name of the span, like a string literal
+         */
+        ScopedTrace(const char* name)
+            : m_name(name),
+              m_start(pros::c::micros()) {}
+
+        ScopedTrace(const ScopedTrace& other) = delete;
+        ScopedTrace& operator=(const ScopedTrace& other) = delete;
+
+        ~ScopedTrace() { recordTrace(m_name, m_start); }
+    private:
+        const char* const m_name;
+        const uint64_t m_start;
+};
+
+/**
+ * @brief Write the runtime trace as json, in the Chrome trace event format
+ *
+ * The trace opens in Perfetto (ui.perfetto.dev) or chrome://tracing, with a track for every task which recorded a
+ * span, so tasks which interleave or hold each other up can be seen side by side. Only the latest LEMLIB_TRACE_SIZE
+ * spans are kept. Tasks may keep recording while the trace is written, and spans which are overwritten meanwhile are
+ * left out.
+ *
+ * @param file the file to write to. Defaults to stdout, which is sent over the serial port
+ * @return int32_t always returns 0
+ *
+ * @b Example:
+ * @code {.cpp}
+ * void disabled() {
+ *     // print the last few seconds of the match over serial
+ *     lemlib::dumpTrace();
+ * }
+ * @endcode
+ */
+int32_t dumpTrace(FILE* file = stdout);
+/**
+ * @brief Write the runtime trace as json to a file, like on the SD card
+ *
+ * This function uses the following values of errno when an error state is reached:
+ *
+ * any errno set by fopen, like ENXIO when there is no SD card
+ *
+ * @param path the path of the file. It is overwritten
+ * @return int32_t 0 on success
+ * @return INT_MAX on failure, setting errno
+ *
+ * @b Example:
+ * @code {.cpp}
+ * void disabled() {
+ *     lemlib::dumpTrace("/usd/trace.json");
+ * }
+ * @endcode
+ */
+int32_t dumpTrace(const char* path);
+/**
+ * @brief Drop every span recorded so far, like at the start of a match
+ */
+void resetTrace();
+
+namespace detail {
+/**
+ * @brief Get the track of the calling task, which is shared by every trace, creating it the first time the task
+ * records an event
+ *
+ * @return uint8_t the index of the track
+ */
+uint8_t getTraceTrack();
+/**
+ * @brief Write the name of every track as Chrome trace metadata, each on its own line, after a comma
+ *
+ * @param file the file to write to
+ */
+void writeTraceTracks(FILE* file);
+/**
+ * @brief Write a string as a json string, escaping quotes and backslashes
+ *
+ * @param file the file to write to
+ * @param string the string
+ */
+void writeJsonString(FILE* file, const char* string);
+} // namespace detail
+} // namespace lemlib
+
+#define LEMLIB_TRACE_CONCAT_(a, b) a##b
+#define LEMLIB_TRACE_CONCAT(a, b) LEMLIB_TRACE_CONCAT_(a, b)
+
+/**
+ * @brief Record the rest of the enclosing scope as a span of the runtime trace
+ *
+ * The trace is only compiled in when LEMLIB_TRACE is defined, which `make TRACE=1` does. Otherwise this expands to
+ * nothing, so the trace costs nothing when it is disabled.
+ *
+ * @param name the name of the span, as a string literal
+ */
+#ifdef LEMLIB_TRACE
+#define LEMLIB_TRACE_SCOPE(name) const ::lemlib::ScopedTrace LEMLIB_TRACE_CONCAT(lemlibTrace, __LINE__)(name)
+#else
+#define LEMLIB_TRACE_SCOPE(name) static_cast<void>(0)
+#endif
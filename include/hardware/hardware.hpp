@@ -4,5 +4,76 @@
 
 #include "hardware/Encoder/ADIEncoder.hpp"
 #include "hardware/Encoder/V5RotationSensor.hpp"
+#include "hardware/Encoder/EncoderPosition.hpp"
 #include "hardware/IMU/V5InertialSensor.hpp"
-#include "hardware/Motor/MotorGroup.hpp"
\ No newline at end of file
+#include "hardware/IMU/IMUArray.hpp"
+#include "hardware/IMU/Calibration.hpp"
+#include "hardware/Motor/MotorGroup.hpp"
+#include "hardware/BootTrace.hpp"
+#include "hardware/DeferredInit.hpp"
+#include "hardware/DeviceMutex.hpp"
+#include "hardware/DevicePoller.hpp"
+#include "hardware/Trace.hpp"
+#include "hardware/DeviceRegistry.hpp"
+#include "hardware/Odometry/Odometry.hpp"
+#include "hardware/Odometry/PoseHistory.hpp"
+#include "hardware/Distance/V5DistanceSensor.hpp"
+#include "hardware/Localization/FieldMap.hpp"
+#include "hardware/Localization/ParticleFilter.hpp"
+#include "hardware/GPS/V5GPS.hpp"
+#include "hardware/GPS/GPSFusion.hpp"
+#include "hardware/Motor/StaticMotorGroup.hpp"
+#include "hardware/Motor/DifferentialDrive.hpp"
+#include "hardware/Motor/HolonomicDrive.hpp"
+#include "hardware/Motion/MotionProfile.hpp"
+#include "hardware/Motor/VelocityController.hpp"
+#include "hardware/Motor/Characterization.hpp"
+#include "hardware/Motor/PositionHold.hpp"
+#include "hardware/ControlScheduler.hpp"
+#include "hardware/ControllerInput.hpp"
+#include "hardware/Probe.hpp"
+#include "hardware/TelemetryLogger.hpp"
+#include "hardware/TelemetryStream.hpp"
+#include "hardware/TaskMonitor.hpp"
+#include "hardware/ReplayLog.hpp"
+#include "hardware/Encoder/ReplayEncoder.hpp"
+#include "hardware/IMU/ReplayIMU.hpp"
+#include "hardware/Encoder/MockEncoder.hpp"
+#include "hardware/IMU/MockIMU.hpp"
+#include "hardware/MutexPool.hpp"
+#include "hardware/Signal.hpp"
+#include "hardware/MessageQueue.hpp"
+#include "hardware/Topic.hpp"
+#include "hardware/AllocationTracker.hpp"
+#include "hardware/SdkCallTracker.hpp"
+#include "hardware/Motor/PowerManager.hpp"
+#include "hardware/Motor/CommandDispatcher.hpp"
+#include "hardware/Battery.hpp"
+#include "hardware/Encoder/ADIExpanderGroup.hpp"
+#include "hardware/ADI/ADIInput.hpp"
+#include "hardware/ADI/ADIInputSampler.hpp"
+#include "hardware/Encoder/AverageEncoder.hpp"
+#include "hardware/Encoder/DifferentialEncoder.hpp"
+#include "hardware/IMU/WheelAidedIMU.hpp"
+#include "hardware/Motion/Path.hpp"
+#include "hardware/Motion/PathFile.hpp"
+#include "hardware/Motion/PathProfile.hpp"
+#include "hardware/Motion/PathTable.hpp"
+#include "hardware/Motion/Spline.hpp"
+#include "hardware/Motion/Ramsete.hpp"
+#include "hardware/Odometry/SlipDetector.hpp"
+#include "hardware/Routine.hpp"
+#include "hardware/Motion/MotionFuture.hpp"
+#include "hardware/Motor/ThermalModel.hpp"
+#include "hardware/Motor/FlywheelController.hpp"
+#include "hardware/Optical/V5OpticalSensor.hpp"
+#include "hardware/Odometry/WallReset.hpp"
+#include "hardware/Motion/MotionQueue.hpp"
+#include "hardware/Motion/TrajectoryCache.hpp"
+#include "hardware/IMU/GyroCharacterization.hpp"
+#include "hardware/Link/AllianceLink.hpp"
+#include "hardware/DeviceConfig.hpp"
+#include "hardware/FileService.hpp"
+#include "hardware/IMU/HeadingArbiter.hpp"
+#include "hardware/ReplayGate.hpp"
+#include "hardware/TaskManager.hpp"
\ No newline at end of file
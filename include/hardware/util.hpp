@@ -22,7 +22,7 @@ namespace lemlib {
  * }
  * @endcode
  */
-inline int convertStatus(int status) {
+constexpr int convertStatus(int status) {
     if (status == 1) return 0;
     else return INT_MAX;
 }
@@ -0,0 +1,10 @@
+// The headers which almost every file of the library and the examples includes. `make PCH=1` compiles them once into a
+// precompiled header, and force-includes it into every C++ file, instead of parsing them again for every file. This
+// file is never included directly, and isn't part of the template. See "Precompiled headers" in README.md
+
+// the simulator only implements the C api of PROS
+#ifndef LEMLIB_SIM
+#include "api.h"
+#endif
+#include "units/units.hpp"
+#include "hardware/hardware.hpp"
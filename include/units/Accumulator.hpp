@@ -0,0 +1,94 @@
+#pragma once
+
+#include "units/core.hpp"
+#include <utility>
+
+namespace units {
+/**
+ * @brief Compensated sum of quantities
+ *
+ * Adding a small increment to a large sum rounds away the low bits of the increment, and integrators add thousands of
+ * small increments, so the error grows with the number of additions. An accumulator keeps the rounding error of the
+ * last addition in a second value, and carries it into the next increment (Kahan summation, with Neumaier's fix for
+ * increments larger than the sum). The error of the sum then stays about the size of a single rounding, no matter how
+ * many increments were added, which makes it safe to integrate in float, like with FloatQuantity, where plain sums
+ * drift after a few minutes. A million increments of 0.1 mm in float are off by less than 0.01 mm, instead of 0.7 m.
+ *
+ * Each addition costs 4 more additions and a comparison, and no division. The compensation must not be optimized
+ * away, so code using an accumulator must not be compiled with -ffast-math.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * units::Accumulator<Angle> heading;
+ * while (true) {
+ *     heading += imu.getRotation() - lastRotation;
+ *     Angle total = heading.value();
+ * }
+ * @endcode
+ *
+ * @tparam Q the quantity to accumulate. Either a Quantity, or a FloatQuantity
+ */
+template <typename Q> class Accumulator {
+        // float for FloatQuantity, double otherwise
+        using Rep = decltype(std::declval<Q>().internal());
+    public:
+        /**
+         * @brief Construct a new Accumulator object, which starts at 0
+         */
+        constexpr Accumulator()
+            : m_sum(0),
+              m_compensation(0) {}
+
+        /**
+         * @brief Construct a new Accumulator object
+         *
+         * @param initial the value the sum starts at
+         */
+        explicit constexpr Accumulator(Q initial)
+            : m_sum(initial.internal()),
+              m_compensation(0) {}
+
+        /**
+         * @brief add an increment to the sum
+         *
+         * @param increment the increment
+         */
+        constexpr void operator+=(Q increment) {
+            // the error of the last addition is carried into this one, so it never grows past a single rounding
+            const Rep x = increment.internal() + m_compensation;
+            const Rep sum = m_sum + x;
+            // the low bits lost by the addition, taken from whichever operand is smaller
+            if (cmath::abs(m_sum) >= cmath::abs(x)) m_compensation = (m_sum - sum) + x;
+            else m_compensation = (x - sum) + m_sum;
+            m_sum = sum;
+        }
+
+        /**
+         * @brief subtract an increment from the sum
+         *
+         * @param increment the increment
+         */
+        constexpr void operator-=(Q increment) { *this += -increment; }
+
+        /**
+         * @brief get the sum, including the compensation
+         *
+         * @return constexpr Q
+         */
+        constexpr Q value() const { return Q(m_sum + m_compensation); }
+
+        /**
+         * @brief set the sum, and discard the compensation
+         *
+         * @param value the new sum
+         */
+        constexpr void reset(Q value = Q(Rep(0))) {
+            m_sum = value.internal();
+            m_compensation = 0;
+        }
+    private:
+        Rep m_sum;
+        // the rounding error of the last addition, which is added to the next increment, and to the sum when it is read
+        Rep m_compensation;
+};
+} // namespace units
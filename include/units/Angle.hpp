@@ -1,30 +1,28 @@
 #pragma once
 
-#include "units/units.hpp"
+#include "units/core.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <span>
 
-class Angle : public Quantity<std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<1>, std::ratio<0>,
-                              std::ratio<0>, std::ratio<0>> {
+class Angle : public BasicQuantity<units::Dimension {0, 0, 0, 0, 1, 0, 0, 0}> {
     public:
         explicit constexpr Angle(double value)
-            : Quantity<std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<1>, std::ratio<0>,
-                       std::ratio<0>, std::ratio<0>>(value) {}
-
-        constexpr Angle(Quantity<std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<1>,
-                                 std::ratio<0>, std::ratio<0>, std::ratio<0>>
-                            value)
-            : Quantity<std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<1>, std::ratio<0>,
-                       std::ratio<0>, std::ratio<0>>(value) {};
+            : BasicQuantity<units::Dimension {0, 0, 0, 0, 1, 0, 0, 0}>(value) {}
+
+        constexpr Angle(BasicQuantity<units::Dimension {0, 0, 0, 0, 1, 0, 0, 0}> value)
+            : BasicQuantity<units::Dimension {0, 0, 0, 0, 1, 0, 0, 0}>(value) {};
 };
 
-template <> struct LookupName<Quantity<std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<1>,
-                                       std::ratio<0>, std::ratio<0>, std::ratio<0>>> {
+template <> struct LookupName<BasicQuantity<units::Dimension {0, 0, 0, 0, 1, 0, 0, 0}>> {
         using Named = Angle;
 };
 
-inline std::ostream& operator<<(std::ostream& os, const Angle& quantity) {
-    os << quantity.internal() << " rad";
-    return os;
-}
+namespace units {
+template <> struct UnitSuffix<Angle> {
+        static constexpr std::string_view value = " rad";
+};
+} // namespace units
 
 /**
  * @brief DO NOT USE
@@ -84,7 +82,7 @@ class CAngle {
  */
 class AngleRange : public Angle {
     public:
-        explicit constexpr AngleRange(double value) : Angle(fabs(value)) {}
+        explicit constexpr AngleRange(double value) : Angle(units::cmath::abs(value)) {}
 
         constexpr AngleRange(Angle value) : Angle(units::abs(value)) {}
 
@@ -157,7 +155,7 @@ template <isQuantity Q> constexpr Angle acos(const Q& rhs) { return Angle(std::a
 template <isQuantity Q> constexpr Angle atan(const Q& rhs) { return Angle(std::atan(rhs.internal())); }
 
 template <isQuantity Q> constexpr Angle atan2(const Q& lhs, const Q& rhs) {
-    return Angle(std::atan2(lhs.internal(), rhs.internal()));
+    return Angle(cmath::atan2(lhs.internal(), rhs.internal()));
 }
 
 static inline Angle constrainAngle360(Angle in) { return mod(in, rot); }
@@ -166,8 +164,201 @@ static inline Angle constrainAngle180(Angle in) {
     in = mod(in + 180 * deg, rot);
     return in < Angle(0) ? in + 180 * deg : in - 180 * deg;
 }
+
+/**
+ * @brief wrap an angle to the range [-pi, pi)
+ *
+ * Unlike constrainAngle180, this doesn't use fmod. It rounds to the nearest whole rotation instead, which only takes a
+ * multiply, a floor and a few conditional moves
+ *
+ * @param in the angle to wrap
+ * @return Angle the wrapped angle
+ */
+constexpr Angle wrapAngle180(Angle in) {
+    double x = in.internal();
+    x -= M_TWOPI * cmath::floor(x * (1 / M_TWOPI) + 0.5);
+    // rounding can leave the angle just outside of the range
+    if (x >= M_PI) x -= M_TWOPI;
+    if (x < -M_PI) x += M_TWOPI;
+    return Angle(x);
+}
+
+/**
+ * @brief wrap an angle to the range [0, 2pi)
+ *
+ * Unlike constrainAngle360, this doesn't use fmod, and negative angles are wrapped to positive angles
+ *
+ * @param in the angle to wrap
+ * @return Angle the wrapped angle
+ */
+constexpr Angle wrapAngle360(Angle in) {
+    double x = in.internal();
+    x -= M_TWOPI * cmath::floor(x * (1 / M_TWOPI));
+    // rounding can leave the angle just outside of the range
+    if (x >= M_TWOPI) x -= M_TWOPI;
+    if (x < 0) x += M_TWOPI;
+    return Angle(x);
+}
+
+/**
+ * @brief find the shortest signed angle from the current angle to the target angle
+ *
+ * This is the error of a heading controller. It takes no branches and no call to floor: the difference is rounded to
+ * the nearest whole rotation by adding and subtracting 1.5 * 2^52, so it only takes a subtract, a multiply, two adds
+ * and a multiply-subtract. Differences of more than 2^51 rotations aren't wrapped correctly.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * // -20 degrees, turning clockwise through 0 instead of counterclockwise through 180
+ * Angle error = units::angleError(350_stDeg, 10_stDeg);
+ * @endcode
+ *
+ * @param target the target angle
+ * @param current the current angle
+ * @return Angle the difference, in the range [-pi, pi]. A difference of exactly half a rotation can be either end
+ */
+constexpr Angle angleError(Angle target, Angle current) {
+    constexpr double ROUNDER = 0x1.8p52;
+    const double difference = target.internal() - current.internal();
+    const double rotations = (difference * (1 / M_TWOPI) + ROUNDER) - ROUNDER;
+    return Angle(difference - rotations * M_TWOPI);
+}
+
+/**
+ * @brief find the shortest signed angle from the current angle to each of the targets
+ *
+ * The loop has no branches, so the compiler can vectorize it.
+ *
+ * @param targets the target angles
+ * @param current the current angle
+ * @param errors set to the error of every target. Only as many errors as fit are written
+ */
+constexpr void angleErrors(std::span<const Angle> targets, Angle current, std::span<Angle> errors) {
+    const size_t size = std::min(targets.size(), errors.size());
+    for (size_t i = 0; i < size; i++) errors[i] = angleError(targets[i], current);
+}
+
+/**
+ * @brief find the target which is the shortest turn from the current angle
+ *
+ * This is useful when a mechanism can line up with any of several angles, like a symmetric game piece, or a drivetrain
+ * which can drive forwards or backwards.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * constexpr std::array<Angle, 2> directions = {0_stDeg, 180_stDeg};
+ * // 1, since the robot is closer to facing backwards
+ * size_t closest = units::closestAngle(directions, 150_stDeg);
+ * @endcode
+ *
+ * @param targets the target angles
+ * @param current the current angle
+ * @return size_t the index of the closest target. The first one if several are as close. 0 if there are no targets
+ */
+constexpr size_t closestAngle(std::span<const Angle> targets, Angle current) {
+    size_t closest = 0;
+    double closestError = INFINITY;
+    for (size_t i = 0; i < targets.size(); i++) {
+        const double error = cmath::abs(angleError(targets[i], current).internal());
+        if (error < closestError) closest = i, closestError = error;
+    }
+    return closest;
+}
 } // namespace units
 
+/**
+ * @brief An angle which is always in the range [-pi, pi)
+ *
+ * The angle is wrapped once, when it is created. Since the range is known, arithmetic between wrapped angles only
+ * needs a single conditional add to stay in the range, and comparisons don't have to wrap anything. Subtracting two
+ * wrapped angles gives the shortest signed angle between them, which is the error heading controllers need.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * WrappedAngle target = 270_stDeg; // stored as -90 degrees
+ * WrappedAngle heading = imu.getRotation();
+ * // the shortest way to turn from the heading to the target, from -180 to 180 degrees
+ * Angle error = target - heading;
+ * @endcode
+ */
+class WrappedAngle {
+    public:
+        /**
+         * @brief Construct a new WrappedAngle object
+         *
+         * This constructor initializes the angle to 0
+         */
+        constexpr WrappedAngle()
+            : m_value(0) {}
+
+        /**
+         * @brief Construct a new WrappedAngle object
+         *
+         * @param angle the angle, which can be outside of the range
+         */
+        constexpr WrappedAngle(Angle angle)
+            : m_value(units::wrapAngle180(angle).internal()) {}
+
+        /**
+         * @brief convert the wrapped angle to an angle
+         *
+         * @return constexpr Angle the angle, in the range [-pi, pi)
+         */
+        constexpr operator Angle() const { return Angle(m_value); }
+
+        /**
+         * @brief get the value of the angle in radians
+         *
+         * @return constexpr double
+         */
+        constexpr double internal() const { return m_value; }
+
+        constexpr WrappedAngle operator-() const { return fromRange(-m_value); }
+
+        constexpr WrappedAngle operator+(WrappedAngle other) const { return fromRange(m_value + other.m_value); }
+
+        /**
+         * @brief find the shortest signed angle from another angle to this angle
+         *
+         * @param other the other angle
+         * @return WrappedAngle the difference, in the range [-pi, pi)
+         */
+        constexpr WrappedAngle operator-(WrappedAngle other) const { return fromRange(m_value - other.m_value); }
+
+        constexpr void operator+=(WrappedAngle other) { *this = *this + other; }
+
+        constexpr void operator-=(WrappedAngle other) { *this = *this - other; }
+
+        // the angles are already wrapped, so they can be compared directly
+        constexpr bool operator==(WrappedAngle other) const { return m_value == other.m_value; }
+
+        constexpr bool operator!=(WrappedAngle other) const { return m_value != other.m_value; }
+
+        constexpr bool operator<(WrappedAngle other) const { return m_value < other.m_value; }
+
+        constexpr bool operator<=(WrappedAngle other) const { return m_value <= other.m_value; }
+
+        constexpr bool operator>(WrappedAngle other) const { return m_value > other.m_value; }
+
+        constexpr bool operator>=(WrappedAngle other) const { return m_value >= other.m_value; }
+    private:
+        /**
+         * @brief create a wrapped angle from an angle that is at most one rotation outside of the range
+         *
+         * @param value the angle, in radians, in the range [-3pi, 3pi)
+         * @return WrappedAngle
+         */
+        static constexpr WrappedAngle fromRange(double value) {
+            WrappedAngle angle;
+            if (value >= M_PI) value -= M_TWOPI;
+            else if (value < -M_PI) value += M_TWOPI;
+            angle.m_value = value;
+            return angle;
+        }
+
+        double m_value;
+};
+
 // Angle to/from operators
 // Standard orientation
 constexpr inline Angle from_stRad(Number value) { return Angle(value.internal()); }
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "units/core.hpp"
+
+/**
+ * @file Electrical.hpp
+ * @brief Units of current, voltage, and the other electrical quantities
+ */
+
+NEW_UNIT(Current, amp, 0, 0, 0, 1, 0, 0, 0, 0)
+
+NEW_UNIT(Charge, coulomb, 0, 0, 1, 1, 0, 0, 0, 0)
+
+NEW_UNIT(Voltage, volt, 1, 2, -3, -1, 0, 0, 0, 0)
+NEW_METRIC_PREFIXES(Voltage, volt);
+
+NEW_UNIT(Resistance, ohm, 1, 2, -3, -2, 0, 0, 0, 0)
+NEW_METRIC_PREFIXES(Resistance, ohm)
+
+NEW_UNIT(Conductance, siemen, -1, -2, 3, 2, 0, 0, 0, 0)
+NEW_METRIC_PREFIXES(Conductance, siemen);
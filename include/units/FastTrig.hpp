@@ -0,0 +1,164 @@
+#pragma once
+
+#include "units/Angle.hpp"
+
+/**
+ * Fast approximations of the trigonometric functions in Angle.hpp
+ *
+ * The standard library functions are accurate to the last bit, which the V5 brain pays for with slow double precision
+ * math. These functions use short polynomials instead, and are accurate enough for odometry and path following. They
+ * are opt-in: code that needs exact results keeps using units::sin and friends.
+ *
+ * Maximum absolute errors:
+ * - sin, cos, sincos: 4E-7 for angles within ±1E6 radians. Larger angles, infinity and NaN use the standard library
+ * - tan: relative error of 1E-6, as long as the cosine of the angle is larger than 0.01
+ * - atan2: 5E-8 radians (about 3E-6 degrees)
+ */
+namespace units::fast {
+namespace detail {
+// pi / 2, split into a part with a short mantissa and the remainder, so that reducing an angle by a multiple of it
+// doesn't lose precision
+constexpr double PI_2_HI = 1.57079632673412561417;
+constexpr double PI_2_LO = 6.07710050650619224932E-11;
+constexpr double TWO_PI_INV = 0.63661977236758134308;
+// angles larger than this lose too much precision in the range reduction
+constexpr double MAX_REDUCTION = 1E6;
+
+/**
+ * @brief the sine and cosine of an angle between -pi / 4 and pi / 4
+ *
+ * Taylor polynomials are used, as they are very accurate for small angles
+ *
+ * @param x the angle, in radians
+ * @param sin where to write the sine
+ * @param cos where to write the cosine
+ */
+constexpr void sincosKernel(double x, double& sin, double& cos) {
+    const double x2 = x * x;
+    sin = x + x * x2 * (-1.0 / 6 + x2 * (1.0 / 120 + x2 * (-1.0 / 5040)));
+    cos = 1 + x2 * (-1.0 / 2 + x2 * (1.0 / 24 + x2 * (-1.0 / 720 + x2 * (1.0 / 40320))));
+}
+
+/**
+ * @brief the sine and cosine of any angle
+ *
+ * @param x the angle, in radians
+ * @param sin where to write the sine
+ * @param cos where to write the cosine
+ */
+inline void sincos(double x, double& sin, double& cos) {
+    if (!(std::abs(x) < MAX_REDUCTION)) {
+        sin = std::sin(x);
+        cos = std::cos(x);
+        return;
+    }
+    // find the closest multiple of pi / 2, and the angle from it
+    const double quadrant = std::round(x * TWO_PI_INV);
+    const double r = (x - quadrant * PI_2_HI) - quadrant * PI_2_LO;
+    double s, c;
+    sincosKernel(r, s, c);
+    // rotate the result into the right quadrant
+    switch (int(quadrant) & 3) {
+        case 0: sin = s, cos = c; break;
+        case 1: sin = c, cos = -s; break;
+        case 2: sin = -s, cos = -c; break;
+        default: sin = -c, cos = s; break;
+    }
+}
+
+/**
+ * @brief the arctangent of a number between 0 and 1
+ *
+ * This is the polynomial from Abramowitz and Stegun 4.4.49
+ *
+ * @param x the number
+ * @return double the arctangent, in radians
+ */
+constexpr double atanKernel(double x) {
+    const double x2 = x * x;
+    double result = -0.0040540580;
+    result = result * x2 + 0.0218612288;
+    result = result * x2 - 0.0559098861;
+    result = result * x2 + 0.0964200441;
+    result = result * x2 - 0.1390853351;
+    result = result * x2 + 0.1994653599;
+    result = result * x2 - 0.3332985605;
+    result = result * x2 + 0.9999993329;
+    return x * result;
+}
+} // namespace detail
+
+/**
+ * @brief the sine and cosine of an angle, which are cheaper to compute together than separately
+ */
+struct SinCos {
+        Number sin;
+        Number cos;
+};
+
+/**
+ * @brief find the sine and cosine of an angle
+ *
+ * @b Example:
+ * @code {.cpp}
+ * const units::fast::SinCos sc = units::fast::sincos(pose.orientation);
+ * x += distance * sc.cos;
+ * y += distance * sc.sin;
+ * @endcode
+ *
+ * @param angle the angle
+ * @return SinCos the sine and cosine
+ */
+inline SinCos sincos(Angle angle) {
+    double s, c;
+    detail::sincos(angle.internal(), s, c);
+    return {s, c};
+}
+
+/**
+ * @brief find the sine of an angle
+ *
+ * @param angle the angle
+ * @return Number the sine
+ */
+inline Number sin(Angle angle) { return sincos(angle).sin; }
+
+/**
+ * @brief find the cosine of an angle
+ *
+ * @param angle the angle
+ * @return Number the cosine
+ */
+inline Number cos(Angle angle) { return sincos(angle).cos; }
+
+/**
+ * @brief find the tangent of an angle
+ *
+ * @param angle the angle
+ * @return Number the tangent
+ */
+inline Number tan(Angle angle) {
+    const SinCos sc = sincos(angle);
+    return sc.sin / sc.cos;
+}
+
+/**
+ * @brief find the angle of a point, like std::atan2
+ *
+ * @param y the y component of the point
+ * @param x the x component of the point
+ * @return Angle the angle, between -pi and pi
+ */
+template <isQuantity Q, isQuantity R> inline Angle atan2(const Q& y, const R& x)
+    requires Isomorphic<Q, R>
+{
+    const double ay = std::abs(y.internal());
+    const double ax = std::abs(x.internal());
+    // the polynomial only works from 0 to 1, so the angle is found relative to the closest axis. Infinity and NaN use
+    // the standard library
+    if (!(ax + ay < INFINITY) || (ax == 0 && ay == 0)) return Angle(std::atan2(y.internal(), x.internal()));
+    double angle = ay <= ax ? detail::atanKernel(ay / ax) : M_PI_2 - detail::atanKernel(ax / ay);
+    if (x.internal() < 0) angle = M_PI - angle;
+    return Angle(std::copysign(angle, y.internal()));
+}
+} // namespace units::fast
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "units/Angle.hpp"
+#include <cstdint>
+#include <limits>
+
+namespace units::fixed {
+/**
+ * Units for fixed point quantities. Each one is the size of one count of a raw device reading, so readings can be
+ * stored without any rounding
+ */
+struct Radians {
+        static constexpr Angle value = rad;
+};
+
+struct Degrees {
+        static constexpr Angle value = deg;
+};
+
+// the resolution of the V5 rotation sensor
+struct Centidegrees {
+        static constexpr Angle value = deg / 100;
+};
+
+// one tick of a V5 motor, measured before its cartridge
+struct MotorTicks {
+        static constexpr Angle value = rot / 50;
+};
+
+struct Meters {
+        static constexpr Length value = m;
+};
+
+// the concept for fixed point units
+template <typename Unit>
+concept isUnit = requires { requires isQuantity<std::remove_cv_t<decltype(Unit::value)>>; };
+} // namespace units::fixed
+
+/**
+ * @brief Fixed point quantity class
+ *
+ * A FixedQuantity stores a quantity as an integer number of 2^-FRACTION_BITS units. Adding and subtracting fixed point
+ * quantities is exact, so raw integer device readings, like ticks or centidegrees, can be accumulated forever without
+ * drifting. They are only converted to floating point quantities when they are used.
+ *
+ * Fixed point quantities only mix with quantities with the same unit. Converting to and from floating point quantities
+ * takes a single multiply by a factor computed at compile time.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * Fixed32<units::fixed::Centidegrees> total;
+ * int32_t last = rotation_get_position(port);
+ * while (true) {
+ *     const int32_t position = rotation_get_position(port);
+ *     total += Fixed32<units::fixed::Centidegrees>::fromRaw(position - last);
+ *     last = position;
+ *     Angle angle = total; // only converted to a double here
+ * }
+ * @endcode
+ *
+ * @tparam Unit the unit, one of the units in units::fixed
+ * @tparam FRACTION_BITS the number of bits after the binary point
+ * @tparam Rep the integer type used to store the value
+ */
+template <units::fixed::isUnit Unit, int FRACTION_BITS = 32, typename Rep = std::int64_t> class FixedQuantity {
+        static_assert(std::numeric_limits<Rep>::is_integer && std::numeric_limits<Rep>::is_signed,
+                      "Rep must be a signed integer");
+        static_assert(FRACTION_BITS >= 0 && FRACTION_BITS < std::numeric_limits<Rep>::digits,
+                      "FRACTION_BITS must leave room for the integer part");
+    public:
+        using Q = Named<std::remove_cv_t<decltype(Unit::value)>>; /** the floating point quantity */
+        static constexpr Rep ONE = Rep(1) << FRACTION_BITS; /** the stored value of one unit */
+
+        /**
+         * @brief Construct a new FixedQuantity object
+         *
+         * This constructor initializes the value to 0
+         */
+        constexpr FixedQuantity()
+            : m_value(0) {}
+
+        /**
+         * @brief Construct a new FixedQuantity object from a floating point quantity
+         *
+         * The quantity is rounded to the nearest representable value. Quantities which are too large saturate, and
+         * NaN becomes 0
+         *
+         * @param quantity the quantity to convert
+         */
+        explicit constexpr FixedQuantity(Q quantity)
+            : m_value(fromDouble(quantity.internal() * TO_FIXED)) {}
+
+        /**
+         * @brief create a fixed point quantity from a raw integer reading
+         *
+         * @param counts the number of units
+         * @return FixedQuantity
+         */
+        static constexpr FixedQuantity fromRaw(Rep counts) { return fromInternal(counts * ONE); }
+
+        /**
+         * @brief create a fixed point quantity from its stored value
+         *
+         * @param value the value, in 2^-FRACTION_BITS units
+         * @return FixedQuantity
+         */
+        static constexpr FixedQuantity fromInternal(Rep value) {
+            FixedQuantity quantity;
+            quantity.m_value = value;
+            return quantity;
+        }
+
+        /**
+         * @brief convert the quantity to a floating point quantity
+         *
+         * @return constexpr Q
+         */
+        constexpr operator Q() const { return Q(double(m_value) * TO_DOUBLE); }
+
+        /**
+         * @brief get the stored value
+         *
+         * @return constexpr Rep the value, in 2^-FRACTION_BITS units
+         */
+        constexpr Rep internal() const { return m_value; }
+
+        /**
+         * @brief get the number of whole units, rounded down
+         *
+         * @return constexpr Rep
+         */
+        constexpr Rep counts() const { return m_value >> FRACTION_BITS; }
+
+        constexpr FixedQuantity operator+(FixedQuantity other) const { return fromInternal(m_value + other.m_value); }
+
+        constexpr FixedQuantity operator-(FixedQuantity other) const { return fromInternal(m_value - other.m_value); }
+
+        constexpr FixedQuantity operator-() const { return fromInternal(-m_value); }
+
+        constexpr FixedQuantity operator*(Rep multiple) const { return fromInternal(m_value * multiple); }
+
+        // integer division, rounded towards 0
+        constexpr FixedQuantity operator/(Rep divisor) const { return fromInternal(m_value / divisor); }
+
+        constexpr void operator+=(FixedQuantity other) { m_value += other.m_value; }
+
+        constexpr void operator-=(FixedQuantity other) { m_value -= other.m_value; }
+
+        constexpr bool operator==(FixedQuantity other) const { return m_value == other.m_value; }
+
+        constexpr bool operator!=(FixedQuantity other) const { return m_value != other.m_value; }
+
+        constexpr bool operator<(FixedQuantity other) const { return m_value < other.m_value; }
+
+        constexpr bool operator<=(FixedQuantity other) const { return m_value <= other.m_value; }
+
+        constexpr bool operator>(FixedQuantity other) const { return m_value > other.m_value; }
+
+        constexpr bool operator>=(FixedQuantity other) const { return m_value >= other.m_value; }
+    private:
+        // conversion factors between the stored value and the base unit of Q
+        static constexpr double TO_DOUBLE = Unit::value.internal() / double(ONE);
+        static constexpr double TO_FIXED = double(ONE) / Unit::value.internal();
+
+        /**
+         * @brief round a double to the stored integer type, saturating if it doesn't fit
+         *
+         * @param value the value, in 2^-FRACTION_BITS units
+         * @return constexpr Rep
+         */
+        static constexpr Rep fromDouble(double value) {
+            // the limits are converted to double, which may round them up, so the comparison excludes them
+            constexpr double MAX = double(std::numeric_limits<Rep>::max());
+            constexpr double MIN = double(std::numeric_limits<Rep>::min());
+            if (value != value) return 0;
+            if (value >= MAX) return std::numeric_limits<Rep>::max();
+            if (value <= MIN) return std::numeric_limits<Rep>::min();
+            return Rep(value < 0 ? value - 0.5 : value + 0.5);
+        }
+
+        Rep m_value;
+};
+
+// Q16.16 fixed point, which fits in a single register
+template <units::fixed::isUnit Unit> using Fixed16 = FixedQuantity<Unit, 16, std::int32_t>;
+// Q32.32 fixed point
+template <units::fixed::isUnit Unit> using Fixed32 = FixedQuantity<Unit, 32, std::int64_t>;
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "units/Angle.hpp"
+#include "units/Electrical.hpp"
+#include <cfloat>
+
+/**
+ * @brief Single precision quantity class
+ *
+ * A FloatQuantity has the same dimensions as the Quantity Q, but stores its value as a float instead of a double. The
+ * Cortex-A9 in the V5 brain does float math much faster than double math, and can only vectorize floats, so hot control
+ * loops can use float quantities where the precision is good enough.
+ *
+ * Float quantities never mix with double quantities by accident. Converting a double quantity to a float quantity is
+ * explicit, and values too large to fit in a float become infinity, so the INFINITY error values used by the rest of
+ * the library stay errors. Converting a float quantity back to a double quantity is implicit, as no precision is lost.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * fAngle heading = fAngle(imu.getRotation());
+ * fLength error = 24_fin - fLength(distance);
+ * // float quantities can be passed to functions that take double quantities
+ * Length total = error;
+ * @endcode
+ *
+ * @tparam Q the double precision quantity with the same dimensions
+ */
+template <isQuantity Q> class FloatQuantity {
+    protected:
+        float value; /** the value stored in its base unit type */
+
+        /**
+         * @brief convert a double to a float, without undefined behavior if it doesn't fit
+         *
+         * @param value the double to convert
+         * @return constexpr float the converted value, or infinity if the double is too large
+         */
+        static constexpr float narrow(double value) {
+            if (value > FLT_MAX) return INFINITY;
+            if (value < -FLT_MAX) return -INFINITY;
+            return static_cast<float>(value);
+        }
+    public:
+        using Double = Q; /** the double precision quantity with the same dimensions */
+
+        /**
+         * @brief construct a new FloatQuantity object
+         *
+         * This constructor initializes the value to 0
+         */
+        explicit constexpr FloatQuantity()
+            : value(0) {}
+
+        /**
+         * @brief construct a new FloatQuantity object
+         *
+         * @param value the value to initialize the quantity with, in its base unit type
+         */
+        explicit constexpr FloatQuantity(float value)
+            : value(value) {}
+
+        /**
+         * @brief construct a new FloatQuantity object from a double precision quantity
+         *
+         * @param quantity the quantity to convert. If it is too large to fit in a float, it becomes infinity
+         */
+        explicit constexpr FloatQuantity(Q quantity)
+            : value(narrow(quantity.internal())) {}
+
+        /**
+         * @brief convert the quantity to a double precision quantity
+         *
+         * @return constexpr Q
+         */
+        constexpr operator Q() const { return Q(static_cast<double>(value)); }
+
+        /**
+         * @brief get the value of the quantity in its base unit type
+         *
+         * @return constexpr float
+         */
+        constexpr float internal() const { return value; }
+
+        /**
+         * @brief get the value of the quantity in another unit
+         *
+         * @param quantity the unit to convert to
+         * @return constexpr float
+         */
+        constexpr float convert(Q quantity) const { return narrow(value / quantity.internal()); }
+
+        /**
+         * @brief set the value of this quantity to its current value plus another quantity
+         *
+         * @param other the quantity to add
+         */
+        constexpr void operator+=(FloatQuantity other) { value += other.value; }
+
+        /**
+         * @brief set the value of this quantity to its current value minus another quantity
+         *
+         * @param other the quantity to subtract
+         */
+        constexpr void operator-=(FloatQuantity other) { value -= other.value; }
+
+        /**
+         * @brief set the value of this quantity to its current value times a float
+         *
+         * @param multiple the multiple to multiply by
+         */
+        constexpr void operator*=(float multiple) { value *= multiple; }
+
+        /**
+         * @brief set the value of this quantity to its current value divided by a float
+         *
+         * @param dividend the dividend to divide by
+         */
+        constexpr void operator/=(float dividend) { value /= dividend; }
+
+        // comparisons between quantities with the same dimensions
+        friend constexpr bool operator==(FloatQuantity lhs, FloatQuantity rhs) { return lhs.value == rhs.value; }
+
+        friend constexpr bool operator!=(FloatQuantity lhs, FloatQuantity rhs) { return lhs.value != rhs.value; }
+
+        friend constexpr bool operator<(FloatQuantity lhs, FloatQuantity rhs) { return lhs.value < rhs.value; }
+
+        friend constexpr bool operator<=(FloatQuantity lhs, FloatQuantity rhs) { return lhs.value <= rhs.value; }
+
+        friend constexpr bool operator>(FloatQuantity lhs, FloatQuantity rhs) { return lhs.value > rhs.value; }
+
+        friend constexpr bool operator>=(FloatQuantity lhs, FloatQuantity rhs) { return lhs.value >= rhs.value; }
+};
+
+template <isQuantity Q> constexpr FloatQuantity<Q> operator+(FloatQuantity<Q> rhs) { return rhs; }
+
+template <isQuantity Q> constexpr FloatQuantity<Q> operator-(FloatQuantity<Q> rhs) {
+    return FloatQuantity<Q>(-rhs.internal());
+}
+
+template <isQuantity Q> constexpr FloatQuantity<Q> operator+(FloatQuantity<Q> lhs, FloatQuantity<Q> rhs) {
+    return FloatQuantity<Q>(lhs.internal() + rhs.internal());
+}
+
+template <isQuantity Q> constexpr FloatQuantity<Q> operator-(FloatQuantity<Q> lhs, FloatQuantity<Q> rhs) {
+    return FloatQuantity<Q>(lhs.internal() - rhs.internal());
+}
+
+template <isQuantity Q> constexpr FloatQuantity<Q> operator*(FloatQuantity<Q> quantity, float multiple) {
+    return FloatQuantity<Q>(quantity.internal() * multiple);
+}
+
+template <isQuantity Q> constexpr FloatQuantity<Q> operator*(float multiple, FloatQuantity<Q> quantity) {
+    return FloatQuantity<Q>(quantity.internal() * multiple);
+}
+
+template <isQuantity Q> constexpr FloatQuantity<Q> operator/(FloatQuantity<Q> quantity, float divisor) {
+    return FloatQuantity<Q>(quantity.internal() / divisor);
+}
+
+template <isQuantity Q1, isQuantity Q2, isQuantity Q3 = Multiplied<Q1, Q2>>
+constexpr FloatQuantity<Q3> operator*(FloatQuantity<Q1> lhs, FloatQuantity<Q2> rhs) {
+    return FloatQuantity<Q3>(lhs.internal() * rhs.internal());
+}
+
+template <isQuantity Q1, isQuantity Q2, isQuantity Q3 = Divided<Q1, Q2>>
+constexpr FloatQuantity<Q3> operator/(FloatQuantity<Q1> lhs, FloatQuantity<Q2> rhs) {
+    return FloatQuantity<Q3>(lhs.internal() / rhs.internal());
+}
+
+// define some common float quantity types
+using fNumber = FloatQuantity<Number>;
+using fTime = FloatQuantity<Time>;
+using fLength = FloatQuantity<Length>;
+using fLinearVelocity = FloatQuantity<LinearVelocity>;
+using fLinearAcceleration = FloatQuantity<LinearAcceleration>;
+using fAngle = FloatQuantity<Angle>;
+using fAngularVelocity = FloatQuantity<AngularVelocity>;
+using fAngularAcceleration = FloatQuantity<AngularAcceleration>;
+using fCurvature = FloatQuantity<Curvature>;
+using fCurrent = FloatQuantity<Current>;
+using fVoltage = FloatQuantity<Voltage>;
+
+/**
+ * Float literals have the same suffixes as double literals, prefixed with an f. For example, 90_fstDeg is a float
+ * version of 90_stDeg. A to_ function is defined for each of them, so to_stDeg also works on float angles
+ */
+#define NEW_FLOAT_UNIT_LITERAL(Name, suffix, multiple)                                                                 \
+    constexpr FloatQuantity<Name> operator""_f##suffix(long double value) {                                            \
+        return FloatQuantity<Name>(Name(static_cast<double>(value) * (multiple).internal()));                          \
+    }                                                                                                                  \
+    constexpr FloatQuantity<Name> operator""_f##suffix(unsigned long long value) {                                     \
+        return FloatQuantity<Name>(Name(static_cast<double>(value) * (multiple).internal()));                          \
+    }                                                                                                                  \
+    constexpr inline float to_##suffix(FloatQuantity<Name> quantity) { return quantity.convert(multiple); }
+
+NEW_FLOAT_UNIT_LITERAL(Number, num, num)
+NEW_FLOAT_UNIT_LITERAL(Time, sec, sec)
+NEW_FLOAT_UNIT_LITERAL(Time, msec, msec)
+NEW_FLOAT_UNIT_LITERAL(Length, m, m)
+NEW_FLOAT_UNIT_LITERAL(Length, cm, cm)
+NEW_FLOAT_UNIT_LITERAL(Length, mm, mm)
+NEW_FLOAT_UNIT_LITERAL(Length, in, in)
+NEW_FLOAT_UNIT_LITERAL(Length, ft, ft)
+NEW_FLOAT_UNIT_LITERAL(Length, tile, tile)
+NEW_FLOAT_UNIT_LITERAL(LinearVelocity, mps, mps)
+NEW_FLOAT_UNIT_LITERAL(LinearVelocity, inps, inps)
+NEW_FLOAT_UNIT_LITERAL(LinearAcceleration, mps2, mps2)
+NEW_FLOAT_UNIT_LITERAL(LinearAcceleration, inps2, inps2)
+NEW_FLOAT_UNIT_LITERAL(Angle, stRad, rad)
+NEW_FLOAT_UNIT_LITERAL(Angle, stDeg, deg)
+NEW_FLOAT_UNIT_LITERAL(Angle, stRot, rot)
+NEW_FLOAT_UNIT_LITERAL(AngularVelocity, radps, radps)
+NEW_FLOAT_UNIT_LITERAL(AngularVelocity, degps, degps)
+NEW_FLOAT_UNIT_LITERAL(AngularVelocity, rpm, rpm)
+NEW_FLOAT_UNIT_LITERAL(Current, amp, amp)
+NEW_FLOAT_UNIT_LITERAL(Voltage, volt, volt)
+
+namespace units {
+template <isQuantity Q> constexpr FloatQuantity<Q> abs(FloatQuantity<Q> lhs) {
+    return FloatQuantity<Q>(cmath::abs(lhs.internal()));
+}
+
+template <isQuantity Q, isQuantity S = Exponentiated<Q, std::ratio<2>>>
+constexpr FloatQuantity<S> square(FloatQuantity<Q> lhs) {
+    return FloatQuantity<S>(lhs.internal() * lhs.internal());
+}
+
+template <isQuantity Q, isQuantity S = Rooted<Q, std::ratio<2>>> constexpr FloatQuantity<S> sqrt(FloatQuantity<Q> lhs) {
+    return FloatQuantity<S>(cmath::sqrt(lhs.internal()));
+}
+
+template <isQuantity Q> constexpr FloatQuantity<Q> hypot(FloatQuantity<Q> lhs, FloatQuantity<Q> rhs) {
+    return FloatQuantity<Q>(cmath::hypot(lhs.internal(), rhs.internal()));
+}
+
+template <isQuantity Q>
+constexpr FloatQuantity<Q> clamp(FloatQuantity<Q> lhs, FloatQuantity<Q> lo, FloatQuantity<Q> hi) {
+    return FloatQuantity<Q>(std::clamp(lhs.internal(), lo.internal(), hi.internal()));
+}
+
+constexpr fNumber sin(fAngle rhs) { return fNumber(std::sin(rhs.internal())); }
+
+constexpr fNumber cos(fAngle rhs) { return fNumber(std::cos(rhs.internal())); }
+
+constexpr fNumber tan(fAngle rhs) { return fNumber(std::tan(rhs.internal())); }
+
+template <isQuantity Q> constexpr fAngle atan2(FloatQuantity<Q> lhs, FloatQuantity<Q> rhs) {
+    return fAngle(cmath::atan2(lhs.internal(), rhs.internal()));
+}
+} // namespace units
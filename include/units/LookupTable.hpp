@@ -0,0 +1,177 @@
+#pragma once
+
+#include "units/core.hpp"
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace units {
+namespace detail {
+// not constexpr, so a constexpr lookup table with breakpoints which don't increase fails to compile, and the error
+// names it. Tables built at runtime aren't checked
+inline void invalidLookupTable() {}
+} // namespace detail
+
+/**
+ * @brief A function of one quantity, given by its value at N breakpoints, and linearly interpolated between them
+ *
+ * Drive curves, feedforward non-linearities and battery compensation are all measured at a few points, and need the
+ * value in between. Inputs before the first breakpoint or after the last one get the value of that breakpoint, so a
+ * table never extrapolates past what was measured.
+ *
+ * A table has either uniform breakpoints, which are found with a multiplication, or any increasing breakpoints, which
+ * are found with a binary search whose loop has no data dependent branches, so it takes the same time for every input
+ * and the compiler can unroll it. Either way the size is known at compile time, and a table stored in a constexpr
+ * variable is placed in read-only memory, so it takes no RAM and no time at startup.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * // the extra voltage a drivetrain needs to move, by velocity
+ * constexpr units::LookupTable<LinearVelocity, Voltage, 4> friction({0_mps, 0.1_mps, 0.5_mps, 2_mps},
+ *                                                                   {1.2_volt, 0.9_volt, 0.6_volt, 0.5_volt});
+ * // a cubic drive curve, sampled every 1/16 of the stick
+ * constexpr auto curve = units::LookupTable<Number, Number, 33>::sample(-1, 1, [](Number x) { return x * x * x; });
+ *
+ * void opcontrol() {
+ *     const Voltage voltage = friction(drive.getVelocity()) + curve(stick) * 12_volt;
+ * }
+ * @endcode
+ *
+ * @tparam X the quantity of the input
+ * @tparam Y the quantity of the output
+ * @tparam N the number of breakpoints, at least 2
+ */
+template <isQuantity X, isQuantity Y, size_t N> class LookupTable {
+        static_assert(N >= 2, "a lookup table needs at least 2 breakpoints");
+    public:
+        /**
+         * @brief Construct a new Lookup Table with any breakpoints
+         *
+         * A constexpr table with breakpoints which don't strictly increase, or aren't finite, fails to compile
+         *
+         * @param breakpoints the inputs, in increasing order
+         * @param values the output at every breakpoint
+         */
+        constexpr LookupTable(const std::array<X, N>& breakpoints, const std::array<Y, N>& values)
+            : m_uniform(false),
+              m_first(breakpoints[0].internal()),
+              m_last(breakpoints[N - 1].internal()),
+              m_scale(0) {
+            for (size_t i = 0; i < N; i++) {
+                m_breakpoints[i] = breakpoints[i].internal();
+                m_values[i] = values[i].internal();
+                // infinity minus itself is NaN, so this only holds for finite breakpoints
+                if (!(m_breakpoints[i] - m_breakpoints[i] == 0)) detail::invalidLookupTable();
+                if (i > 0 && !(m_breakpoints[i] > m_breakpoints[i - 1])) detail::invalidLookupTable();
+            }
+        }
+
+        /**
+         * @brief Construct a new Lookup Table with uniform breakpoints
+         *
+         * A constexpr table whose last breakpoint isn't after the first, or whose breakpoints aren't finite, fails to
+         * compile
+         *
+         * @param first the first breakpoint
+         * @param last the last breakpoint
+         * @param values the output at every breakpoint
+         * @return LookupTable the table
+         */
+        static constexpr LookupTable uniform(X first, X last, const std::array<Y, N>& values) {
+            return LookupTable(first, last, values);
+        }
+
+        /**
+         * @brief Construct a new Lookup Table by sampling a function at uniform breakpoints
+         *
+         * @param first the first breakpoint
+         * @param last the last breakpoint
+         * @param function the function, which takes an X and returns a Y. It must be constexpr for the table to be
+         * @return LookupTable the table
+         */
+        template <typename F> static constexpr LookupTable sample(X first, X last, F&& function) {
+            const double step = (last.internal() - first.internal()) / (N - 1);
+            const std::array<Y, N> values = [&]<size_t... I>(std::index_sequence<I...>) {
+                // the last sample is taken at the last breakpoint exactly, so rounding can't move it
+                return std::array<Y, N> {function(I == N - 1 ? last : X(first.internal() + step * I))...};
+            }(std::make_index_sequence<N>());
+            return LookupTable(first, last, values);
+        }
+
+        /**
+         * @brief Interpolate the table
+         *
+         * @param x the input
+         * @return Y the output, interpolated between the breakpoints around the input. Inputs outside of the
+         * breakpoints get the value of the nearest one, and NaN gets NaN
+         */
+        constexpr Y operator()(X x) const {
+            const double input = x.internal();
+            if (!(input > m_first)) return Y(input == input ? m_values[0] : input);
+            if (!(input < m_last)) return Y(m_values[N - 1]);
+            size_t index;
+            double t;
+            if (m_uniform) {
+                const double position = (input - m_first) * m_scale;
+                // rounding can put an input just below the last breakpoint onto it, which would read past the end
+                index = position < N - 1 ? size_t(position) : N - 2;
+                t = position - index;
+            } else {
+                // the largest index whose breakpoint is at or before the input. The loop runs the same number of
+                // times for every input, and the comparison compiles to a conditional move
+                index = 0;
+                for (size_t size = N; size > 1; size -= size / 2) {
+                    const size_t middle = index + size / 2;
+                    index = m_breakpoints[middle] <= input ? middle : index;
+                }
+                index = index < N - 1 ? index : N - 2;
+                t = (input - m_breakpoints[index]) / (m_breakpoints[index + 1] - m_breakpoints[index]);
+            }
+            return Y(m_values[index] + (m_values[index + 1] - m_values[index]) * t);
+        }
+
+        /**
+         * @brief Get whether the breakpoints are uniform
+         *
+         * @return true the table was made by uniform or sample
+         * @return false the table was constructed with its breakpoints
+         */
+        constexpr bool isUniform() const { return m_uniform; }
+
+        /**
+         * @brief Get a breakpoint
+         *
+         * @param index the index of the breakpoint, which must be less than N
+         * @return X the breakpoint
+         */
+        constexpr X breakpoint(size_t index) const {
+            return X(m_uniform ? (index == N - 1 ? m_last : m_first + index / m_scale) : m_breakpoints[index]);
+        }
+
+        /**
+         * @brief Get the value at a breakpoint
+         *
+         * @param index the index of the breakpoint, which must be less than N
+         * @return Y the value
+         */
+        constexpr Y value(size_t index) const { return Y(m_values[index]); }
+    private:
+        constexpr LookupTable(X first, X last, const std::array<Y, N>& values)
+            : m_uniform(true),
+              m_first(first.internal()),
+              m_last(last.internal()),
+              m_scale((N - 1) / (last.internal() - first.internal())) {
+            if (!(m_last > m_first && m_last - m_first - (m_last - m_first) == 0)) detail::invalidLookupTable();
+            for (size_t i = 0; i < N; i++) m_values[i] = values[i].internal();
+        }
+
+        bool m_uniform;
+        double m_first;
+        double m_last;
+        // the number of breakpoints per unit of input, for uniform tables
+        double m_scale;
+        // only used by tables which aren't uniform
+        std::array<double, N> m_breakpoints {};
+        std::array<double, N> m_values {};
+};
+} // namespace units
@@ -0,0 +1,541 @@
+#pragma once
+
+#include "units/Vector2D.hpp"
+#include "units/Vector3D.hpp"
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+namespace units {
+/**
+ * @class Matrix
+ *
+ * @brief a matrix with a fixed number of rows and columns, where every element is a quantity of the same type
+ *
+ * Meant for the small matrices of filters and estimators, from 2x2 to 6x6. The size is known at compile time, so a
+ * matrix never allocates memory, and every loop has a constant trip count the compiler can unroll. The elements are
+ * stored in their base unit as raw doubles, contiguous and row major, so a matrix can be handed to code expecting a
+ * plain array with data(). Every function takes and returns quantities, and the product of two matrices has the
+ * product of their units, so mixing up a matrix of lengths and a matrix of angles doesn't compile.
+ *
+ * A state which mixes units, like a heading and a drift rate, has to be stored in a matrix of Number, with the units
+ * documented by the code using it.
+ *
+ * 2x2 and 3x3 determinants and inverses use closed forms. Larger ones use Gaussian elimination with partial pivoting.
+ *
+ * @tparam T the type of quantity of every element
+ * @tparam R the number of rows
+ * @tparam C the number of columns
+ */
+template <isQuantity T, std::size_t R, std::size_t C> class Matrix {
+        static_assert(R > 0 && C > 0, "A matrix needs at least one row and one column");
+        // matrices of other units and sizes are built from raw values by the operators
+        template <isQuantity, std::size_t, std::size_t> friend class Matrix;
+    public:
+        /**
+         * @brief Construct a new Matrix object
+         *
+         * This constructor initializes every element to 0
+         */
+        constexpr Matrix()
+            : m_data {} {}
+
+        /**
+         * @brief Construct a new Matrix object from every element, row by row
+         *
+         * @b Example:
+         * @code {.cpp}
+         * // a rotation by 90 degrees
+         * units::Matrix<Number, 2, 2> rotation(0, -1,
+         *                                      1, 0);
+         * @endcode
+         *
+         * @param values the R * C elements, row by row
+         */
+        template <typename... Ts>
+            requires(sizeof...(Ts) == R * C && sizeof...(Ts) > 1 && (std::convertible_to<Ts, T> && ...))
+        constexpr Matrix(Ts... values)
+            : m_data {T(values).internal()...} {}
+
+        /**
+         * @brief Construct a new column vector from a Vector2D
+         *
+         * @param vector the vector
+         */
+        constexpr Matrix(const Vector2D<T>& vector)
+            requires(R == 2 && C == 1)
+            : m_data {vector.x.internal(), vector.y.internal()} {}
+
+        /**
+         * @brief Construct a new column vector from a Vector3D
+         *
+         * @param vector the vector
+         */
+        constexpr Matrix(const Vector3D<T>& vector)
+            requires(R == 3 && C == 1)
+            : m_data {vector.x.internal(), vector.y.internal(), vector.z.internal()} {}
+
+        /**
+         * @brief Create a matrix with every element set to 0
+         *
+         * @return Matrix
+         */
+        constexpr static Matrix zero() { return Matrix(); }
+
+        /**
+         * @brief Create a square matrix with the diagonal set to 1, in the base unit of T, and every other element set
+         * to 0
+         *
+         * @return Matrix
+         */
+        constexpr static Matrix identity()
+            requires(R == C)
+        {
+            Matrix result;
+            for (std::size_t i = 0; i < R; i++) result.m_data[i * C + i] = 1;
+            return result;
+        }
+
+        /**
+         * @brief Create a square matrix with the given diagonal, and every other element set to 0
+         *
+         * @param diagonal the diagonal, as a column vector
+         * @return Matrix
+         */
+        constexpr static Matrix diagonal(const Matrix<T, R, 1>& diagonal)
+            requires(R == C)
+        {
+            Matrix result;
+            for (std::size_t i = 0; i < R; i++) result.m_data[i * C + i] = diagonal.m_data[i];
+            return result;
+        }
+
+        /**
+         * @brief get the number of rows
+         *
+         * @return std::size_t
+         */
+        constexpr static std::size_t rows() { return R; }
+
+        /**
+         * @brief get the number of columns
+         *
+         * @return std::size_t
+         */
+        constexpr static std::size_t cols() { return C; }
+
+        /**
+         * @brief get an element
+         *
+         * @param row the row of the element
+         * @param col the column of the element
+         * @return T
+         */
+        constexpr T operator()(std::size_t row, std::size_t col) const { return T(m_data[row * C + col]); }
+
+        /**
+         * @brief get an element of a column vector
+         *
+         * @param row the row of the element
+         * @return T
+         */
+        constexpr T operator[](std::size_t row) const
+            requires(C == 1)
+        {
+            return T(m_data[row]);
+        }
+
+        /**
+         * @brief set an element
+         *
+         * @param row the row of the element
+         * @param col the column of the element
+         * @param value the new value
+         */
+        constexpr void set(std::size_t row, std::size_t col, T value) { m_data[row * C + col] = value.internal(); }
+
+        /**
+         * @brief get the elements in their base unit, row by row
+         *
+         * @return const double* the R * C elements
+         */
+        constexpr const double* data() const { return m_data; }
+
+        /**
+         * @brief + operator overload. Adds every element of two matrices
+         *
+         * @param other matrix to add
+         * @return Matrix
+         */
+        constexpr Matrix operator+(const Matrix& other) const {
+            Matrix result;
+            for (std::size_t i = 0; i < R * C; i++) result.m_data[i] = m_data[i] + other.m_data[i];
+            return result;
+        }
+
+        /**
+         * @brief - operator overload. Subtracts every element of two matrices
+         *
+         * @param other matrix to subtract
+         * @return Matrix
+         */
+        constexpr Matrix operator-(const Matrix& other) const {
+            Matrix result;
+            for (std::size_t i = 0; i < R * C; i++) result.m_data[i] = m_data[i] - other.m_data[i];
+            return result;
+        }
+
+        /**
+         * @brief - operator overload. Negates every element
+         *
+         * @return Matrix
+         */
+        constexpr Matrix operator-() const {
+            Matrix result;
+            for (std::size_t i = 0; i < R * C; i++) result.m_data[i] = -m_data[i];
+            return result;
+        }
+
+        /**
+         * @brief += operator overload. Adds every element of another matrix to this matrix
+         *
+         * @param other matrix to add
+         * @return Matrix&
+         */
+        constexpr Matrix& operator+=(const Matrix& other) {
+            for (std::size_t i = 0; i < R * C; i++) m_data[i] += other.m_data[i];
+            return *this;
+        }
+
+        /**
+         * @brief -= operator overload. Subtracts every element of another matrix from this matrix
+         *
+         * @param other matrix to subtract
+         * @return Matrix&
+         */
+        constexpr Matrix& operator-=(const Matrix& other) {
+            for (std::size_t i = 0; i < R * C; i++) m_data[i] -= other.m_data[i];
+            return *this;
+        }
+
+        /**
+         * @brief * operator overload. Multiplies every element by a number
+         *
+         * @param factor the number to multiply by
+         * @return Matrix
+         */
+        constexpr Matrix operator*(double factor) const {
+            Matrix result;
+            for (std::size_t i = 0; i < R * C; i++) result.m_data[i] = m_data[i] * factor;
+            return result;
+        }
+
+        /**
+         * @brief * operator overload. Multiplies every element by a quantity
+         *
+         * @tparam Q the type of quantity to multiply by
+         * @param factor the quantity to multiply by
+         * @return Matrix<Multiplied<T, Q>, R, C>
+         */
+        template <isQuantity Q> constexpr Matrix<Multiplied<T, Q>, R, C> operator*(Q factor) const {
+            Matrix<Multiplied<T, Q>, R, C> result;
+            for (std::size_t i = 0; i < R * C; i++) result.m_data[i] = m_data[i] * factor.internal();
+            return result;
+        }
+
+        /**
+         * @brief / operator overload. Divides every element by a number
+         *
+         * @param divisor the number to divide by
+         * @return Matrix
+         */
+        constexpr Matrix operator/(double divisor) const {
+            Matrix result;
+            for (std::size_t i = 0; i < R * C; i++) result.m_data[i] = m_data[i] / divisor;
+            return result;
+        }
+
+        /**
+         * @brief / operator overload. Divides every element by a quantity
+         *
+         * @tparam Q the type of quantity to divide by
+         * @param divisor the quantity to divide by
+         * @return Matrix<Divided<T, Q>, R, C>
+         */
+        template <isQuantity Q> constexpr Matrix<Divided<T, Q>, R, C> operator/(Q divisor) const {
+            Matrix<Divided<T, Q>, R, C> result;
+            for (std::size_t i = 0; i < R * C; i++) result.m_data[i] = m_data[i] / divisor.internal();
+            return result;
+        }
+
+        /**
+         * @brief * operator overload. Multiplies two matrices
+         *
+         * The number of columns of this matrix has to be the number of rows of the other, which is checked at compile
+         * time
+         *
+         * @tparam Q the type of quantity of the other matrix
+         * @tparam K the number of columns of the other matrix
+         * @param other the matrix to multiply by
+         * @return Matrix<Multiplied<T, Q>, R, K>
+         */
+        template <isQuantity Q, std::size_t K>
+        constexpr Matrix<Multiplied<T, Q>, R, K> operator*(const Matrix<Q, C, K>& other) const {
+            Matrix<Multiplied<T, Q>, R, K> result;
+            for (std::size_t row = 0; row < R; row++) {
+                for (std::size_t col = 0; col < K; col++) {
+                    double sum = 0;
+                    for (std::size_t i = 0; i < C; i++) sum += m_data[row * C + i] * other.m_data[i * K + col];
+                    result.m_data[row * K + col] = sum;
+                }
+            }
+            return result;
+        }
+
+        /**
+         * @brief == operator overload. Checks if every element of two matrices is equal
+         *
+         * @param other the matrix to compare with
+         * @return true every element is equal
+         * @return false at least one element is different
+         */
+        constexpr bool operator==(const Matrix& other) const {
+            for (std::size_t i = 0; i < R * C; i++) {
+                if (m_data[i] != other.m_data[i]) return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief get the transpose of the matrix
+         *
+         * @return Matrix<T, C, R>
+         */
+        constexpr Matrix<T, C, R> transpose() const {
+            Matrix<T, C, R> result;
+            for (std::size_t row = 0; row < R; row++) {
+                for (std::size_t col = 0; col < C; col++) result.m_data[col * R + row] = m_data[row * C + col];
+            }
+            return result;
+        }
+
+        /**
+         * @brief get the sum of the diagonal of a square matrix
+         *
+         * @return T
+         */
+        constexpr T trace() const
+            requires(R == C)
+        {
+            double sum = 0;
+            for (std::size_t i = 0; i < R; i++) sum += m_data[i * C + i];
+            return T(sum);
+        }
+
+        /**
+         * @brief get the determinant of a square matrix
+         *
+         * @return Exponentiated<T, std::ratio<R>> the determinant, in the unit of T to the power of R
+         */
+        constexpr Exponentiated<T, std::ratio<R>> determinant() const
+            requires(R == C)
+        {
+            return Exponentiated<T, std::ratio<R>>(rawDeterminant());
+        }
+
+        /**
+         * @brief get the inverse of a square matrix
+         *
+         * @return Matrix<Divided<Number, T>, R, C> the inverse, which has the inverse unit of T. Every element is
+         * INFINITY if the matrix is singular
+         */
+        constexpr Matrix<Divided<Number, T>, R, C> inverse() const
+            requires(R == C)
+        {
+            Matrix<Divided<Number, T>, R, C> result;
+            const double* a = m_data;
+            double* out = result.m_data;
+            if constexpr (R == 1) {
+                out[0] = 1 / a[0];
+            } else if constexpr (R == 2) {
+                const double det = rawDeterminant();
+                if (det == 0) return singular<Divided<Number, T>>();
+                out[0] = a[3] / det;
+                out[1] = -a[1] / det;
+                out[2] = -a[2] / det;
+                out[3] = a[0] / det;
+            } else if constexpr (R == 3) {
+                // the transpose of the matrix of cofactors, over the determinant
+                const double c00 = a[4] * a[8] - a[5] * a[7];
+                const double c01 = a[5] * a[6] - a[3] * a[8];
+                const double c02 = a[3] * a[7] - a[4] * a[6];
+                const double det = a[0] * c00 + a[1] * c01 + a[2] * c02;
+                if (det == 0) return singular<Divided<Number, T>>();
+                out[0] = c00 / det;
+                out[1] = (a[2] * a[7] - a[1] * a[8]) / det;
+                out[2] = (a[1] * a[5] - a[2] * a[4]) / det;
+                out[3] = c01 / det;
+                out[4] = (a[0] * a[8] - a[2] * a[6]) / det;
+                out[5] = (a[2] * a[3] - a[0] * a[5]) / det;
+                out[6] = c02 / det;
+                out[7] = (a[1] * a[6] - a[0] * a[7]) / det;
+                out[8] = (a[0] * a[4] - a[1] * a[3]) / det;
+            } else {
+                // Gauss-Jordan elimination on a copy, applying every row operation to the identity as well
+                double work[R * C] = {};
+                for (std::size_t i = 0; i < R * C; i++) work[i] = a[i];
+                for (std::size_t i = 0; i < R; i++) out[i * C + i] = 1;
+                for (std::size_t col = 0; col < C; col++) {
+                    const std::size_t pivot = pivotRow(work, col);
+                    if (work[pivot * C + col] == 0) return singular<Divided<Number, T>>();
+                    swapRows(work, pivot, col);
+                    swapRows(out, pivot, col);
+                    const double scale = 1 / work[col * C + col];
+                    for (std::size_t i = 0; i < C; i++) {
+                        work[col * C + i] *= scale;
+                        out[col * C + i] *= scale;
+                    }
+                    for (std::size_t row = 0; row < R; row++) {
+                        if (row == col) continue;
+                        const double factor = work[row * C + col];
+                        for (std::size_t i = 0; i < C; i++) {
+                            work[row * C + i] -= factor * work[col * C + i];
+                            out[row * C + i] -= factor * out[col * C + i];
+                        }
+                    }
+                }
+            }
+            return result;
+        }
+
+        /**
+         * @brief convert a column vector to a Vector2D
+         *
+         * @return Vector2D<T>
+         */
+        constexpr Vector2D<T> toVector2D() const
+            requires(R == 2 && C == 1)
+        {
+            return Vector2D<T>(T(m_data[0]), T(m_data[1]));
+        }
+
+        /**
+         * @brief convert a column vector to a Vector3D
+         *
+         * @return Vector3D<T>
+         */
+        constexpr Vector3D<T> toVector3D() const
+            requires(R == 3 && C == 1)
+        {
+            return Vector3D<T>(T(m_data[0]), T(m_data[1]), T(m_data[2]));
+        }
+    private:
+        /**
+         * @brief get the determinant in the base unit
+         *
+         * @return double
+         */
+        constexpr double rawDeterminant() const {
+            const double* a = m_data;
+            if constexpr (R == 1) {
+                return a[0];
+            } else if constexpr (R == 2) {
+                return a[0] * a[3] - a[1] * a[2];
+            } else if constexpr (R == 3) {
+                return a[0] * (a[4] * a[8] - a[5] * a[7]) - a[1] * (a[3] * a[8] - a[5] * a[6]) +
+                       a[2] * (a[3] * a[7] - a[4] * a[6]);
+            } else {
+                // the product of the pivots of Gaussian elimination, negated for every swap of rows
+                double work[R * C] = {};
+                for (std::size_t i = 0; i < R * C; i++) work[i] = a[i];
+                double det = 1;
+                for (std::size_t col = 0; col < C; col++) {
+                    const std::size_t pivot = pivotRow(work, col);
+                    if (work[pivot * C + col] == 0) return 0;
+                    if (pivot != col) {
+                        swapRows(work, pivot, col);
+                        det = -det;
+                    }
+                    det *= work[col * C + col];
+                    for (std::size_t row = col + 1; row < R; row++) {
+                        const double factor = work[row * C + col] / work[col * C + col];
+                        for (std::size_t i = col; i < C; i++) work[row * C + i] -= factor * work[col * C + i];
+                    }
+                }
+                return det;
+            }
+        }
+
+        /**
+         * @brief find the row at or below a column's diagonal with the largest element in that column
+         *
+         * @param work the matrix being eliminated
+         * @param col the column
+         * @return std::size_t the row
+         */
+        constexpr static std::size_t pivotRow(const double* work, std::size_t col) {
+            const auto magnitude = [](double value) { return value < 0 ? -value : value; };
+            std::size_t pivot = col;
+            for (std::size_t row = col + 1; row < R; row++) {
+                if (magnitude(work[row * C + col]) > magnitude(work[pivot * C + col])) pivot = row;
+            }
+            return pivot;
+        }
+
+        /**
+         * @brief swap two rows of a matrix being eliminated
+         *
+         * @param work the matrix
+         * @param a the first row
+         * @param b the second row
+         */
+        constexpr static void swapRows(double* work, std::size_t a, std::size_t b) {
+            if (a == b) return;
+            for (std::size_t i = 0; i < C; i++) std::swap(work[a * C + i], work[b * C + i]);
+        }
+
+        /**
+         * @brief create the result of inverting a singular matrix
+         *
+         * @tparam Q the type of quantity of the result
+         * @return Matrix<Q, R, C> a matrix with every element set to INFINITY
+         */
+        template <isQuantity Q> constexpr static Matrix<Q, R, C> singular() {
+            Matrix<Q, R, C> result;
+            for (std::size_t i = 0; i < R * C; i++) result.m_data[i] = INFINITY;
+            return result;
+        }
+
+        double m_data[R * C];
+};
+
+/**
+ * @brief * operator overload. Multiplies every element of a matrix by a number
+ *
+ * @param factor the number to multiply by
+ * @param matrix the matrix
+ * @return Matrix<T, R, C>
+ */
+template <isQuantity T, std::size_t R, std::size_t C>
+constexpr Matrix<T, R, C> operator*(double factor, const Matrix<T, R, C>& matrix) {
+    return matrix * factor;
+}
+
+/**
+ * @brief * operator overload. Multiplies every element of a matrix by a quantity
+ *
+ * @param factor the quantity to multiply by
+ * @param matrix the matrix
+ * @return Matrix<Multiplied<T, Q>, R, C>
+ */
+template <isQuantity Q, isQuantity T, std::size_t R, std::size_t C>
+constexpr Matrix<Multiplied<T, Q>, R, C> operator*(Q factor, const Matrix<T, R, C>& matrix) {
+    return matrix * factor;
+}
+
+/** a matrix with a single column */
+template <isQuantity T, std::size_t N> using ColumnVector = Matrix<T, N, 1>;
+
+/** a matrix with as many rows as columns */
+template <isQuantity T, std::size_t N> using SquareMatrix = Matrix<T, N, N>;
+} // namespace units
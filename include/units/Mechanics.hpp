@@ -0,0 +1,20 @@
+#pragma once
+
+#include "units/core.hpp"
+
+/**
+ * @file Mechanics.hpp
+ * @brief Units of mass, and of the forces and energy acting on it
+ */
+
+NEW_UNIT(Mass, kg, 1, 0, 0, 0, 0, 0, 0, 0)
+NEW_UNIT_LITERAL(Mass, g, kg / 1000)
+NEW_UNIT_LITERAL(Mass, lb, g * 453.6)
+
+NEW_UNIT(Inertia, kgm2, 1, 2, 0, 0, 0, 0, 0, 0)
+
+NEW_UNIT(Force, N, 1, 1, -2, 0, 0, 0, 0, 0)
+
+NEW_UNIT(Torque, Nm, 1, 2, -2, 0, 0, 0, 0, 0)
+
+NEW_UNIT(Power, watt, 1, 2, -3, 0, 0, 0, 0, 0)
@@ -2,7 +2,10 @@
 
 #include "Angle.hpp"
 #include "units/Vector2D.hpp"
-#include "units/units.hpp"
+#include "units/core.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <span>
 
 namespace units {
 /**
@@ -64,6 +67,96 @@ template <typename derivatives> class AbstractPose
          */
         constexpr AbstractPose(Len x, Len y, Divided<Angle, Exponentiated<Time, derivatives>> orientation)
             : Vector(x, y), orientation(orientation) {}
+
+        /**
+         * @brief transform a point from the local frame of this pose to the frame this pose is in
+         *
+         * For example, if the point is relative to the robot, and this is the pose of the robot on the field, the
+         * point becomes relative to the field. The inverse of the pose transforms the other way
+         *
+         * @param point the point, relative to this pose
+         * @return Vector the point, relative to the frame of this pose
+         */
+        constexpr Vector transform(const Vector& point) const
+            requires(std::is_same_v<derivatives, std::ratio<0>>)
+        {
+            const double c = cos(orientation).internal();
+            const double s = sin(orientation).internal();
+            return Vector(Len(c * point.x.internal() - s * point.y.internal() + this->x.internal()),
+                          Len(s * point.x.internal() + c * point.y.internal() + this->y.internal()));
+        }
+
+        /**
+         * @brief transform points from the local frame of this pose to the frame this pose is in
+         *
+         * The sine and cosine of the orientation are calculated once, for every point. To transform points from the
+         * field into the frame of the robot, like the lookahead candidates of pure pursuit, transform them by the
+         * inverse of the pose of the robot
+         *
+         * @b Example:
+         * @code {.cpp}
+         * // reused every cycle, so nothing is allocated
+         * std::array<units::V2Position, 64> local;
+         *
+         * void update(const units::Pose& robot, std::span<const units::V2Position> candidates) {
+         *     const std::size_t count = robot.inverse().transform(candidates, local);
+         * }
+         * @endcode
+         *
+         * @param points the points, relative to this pose
+         * @param out where to write the transformed points. It may be the same array as the points. Only as many
+         * points as fit are written
+         * @return std::size_t the number of points written
+         */
+        std::size_t transform(std::span<const Vector> points, std::span<Vector> out) const
+            requires(std::is_same_v<derivatives, std::ratio<0>>)
+        {
+            const std::size_t count = std::min(points.size(), out.size());
+            const double c = cos(orientation).internal();
+            const double s = sin(orientation).internal();
+            const double px = this->x.internal();
+            const double py = this->y.internal();
+            for (std::size_t i = 0; i < count; i++) {
+                const double x = points[i].x.internal();
+                const double y = points[i].y.internal();
+                out[i] = Vector(Len(c * x - s * y + px), Len(s * x + c * y + py));
+            }
+            return count;
+        }
+
+        /**
+         * @brief compose this pose with a pose relative to it
+         *
+         * For example, if this is the pose of the robot on the field, and the other pose is the pose of a sensor on
+         * the robot, the result is the pose of the sensor on the field
+         *
+         * @param other the pose, relative to this pose
+         * @return AbstractPose the other pose, relative to the frame of this pose
+         */
+        constexpr AbstractPose compose(const AbstractPose& other) const
+            requires(std::is_same_v<derivatives, std::ratio<0>>)
+        {
+            return AbstractPose(transform(Vector(other.x, other.y)), orientation + other.orientation);
+        }
+
+        /**
+         * @brief get the inverse of this pose
+         *
+         * The inverse is the pose of the frame this pose is in, relative to this pose, so composing a pose with its
+         * inverse gives the origin
+         *
+         * @return AbstractPose the inverse
+         */
+        constexpr AbstractPose inverse() const
+            requires(std::is_same_v<derivatives, std::ratio<0>>)
+        {
+            const double c = cos(orientation).internal();
+            const double s = sin(orientation).internal();
+            const double px = this->x.internal();
+            const double py = this->y.internal();
+            // the position is rotated back by the orientation, and negated
+            return AbstractPose(Len(-c * px - s * py), Len(s * px - c * py), -orientation);
+        }
 };
 
 // Position Pose (Length, Angle)
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "units/Pose.hpp"
+#include "units/Vector2DArray.hpp"
+
+namespace units {
+/**
+ * @class PoseArray
+ *
+ * @brief an array of poses, stored as separate arrays of x positions, y positions, and orientations
+ *
+ * Like Vector2DArray, this lets batch operations on many poses, like transforming a path into another frame, run as
+ * tight loops over raw doubles while still taking and returning quantities.
+ */
+class PoseArray {
+    public:
+        /**
+         * @brief Construct a new empty PoseArray object
+         */
+        PoseArray() = default;
+
+        /**
+         * @brief Construct a new PoseArray object
+         *
+         * This constructor initializes every pose to 0
+         *
+         * @param size the number of poses
+         */
+        explicit PoseArray(std::size_t size)
+            : m_position(size),
+              m_orientation(size) {}
+
+        /**
+         * @brief Construct a new PoseArray object from a list of poses
+         *
+         * @param poses the poses
+         */
+        PoseArray(std::initializer_list<Pose> poses) {
+            reserve(poses.size());
+            for (const Pose& pose : poses) push_back(pose);
+        }
+
+        /**
+         * @brief get the number of poses in the array
+         *
+         * @return std::size_t
+         */
+        std::size_t size() const { return m_orientation.size(); }
+
+        /**
+         * @brief check whether the array is empty
+         *
+         * @return true the array has no poses
+         * @return false the array has at least one pose
+         */
+        bool empty() const { return m_orientation.empty(); }
+
+        /**
+         * @brief reserve space for poses, so adding them doesn't allocate memory
+         *
+         * @param capacity the number of poses to reserve space for
+         */
+        void reserve(std::size_t capacity) {
+            m_position.reserve(capacity);
+            m_orientation.reserve(capacity);
+        }
+
+        /**
+         * @brief change the number of poses in the array. New poses are initialized to 0
+         *
+         * @param size the new number of poses
+         */
+        void resize(std::size_t size) {
+            m_position.resize(size);
+            m_orientation.resize(size);
+        }
+
+        /**
+         * @brief remove every pose from the array
+         */
+        void clear() {
+            m_position.clear();
+            m_orientation.clear();
+        }
+
+        /**
+         * @brief add a pose to the end of the array
+         *
+         * @param pose the pose to add
+         */
+        void push_back(const Pose& pose) {
+            m_position.push_back(pose);
+            m_orientation.push_back(pose.orientation.internal());
+        }
+
+        /**
+         * @brief get a pose in the array
+         *
+         * @param index the index of the pose
+         * @return Pose a copy of the pose
+         */
+        Pose operator[](std::size_t index) const { return Pose(m_position[index], Angle(m_orientation[index])); }
+
+        /**
+         * @brief set a pose in the array
+         *
+         * @param index the index of the pose
+         * @param pose the new value of the pose
+         */
+        void set(std::size_t index, const Pose& pose) {
+            m_position.set(index, pose);
+            m_orientation[index] = pose.orientation.internal();
+        }
+
+        /**
+         * @brief get the positions of the poses
+         *
+         * @return Vector2DArray<Length>& the positions
+         */
+        Vector2DArray<Length>& positions() { return m_position; }
+
+        const Vector2DArray<Length>& positions() const { return m_position; }
+
+        /**
+         * @brief get the orientations, in radians
+         *
+         * @return double* the orientations
+         */
+        double* orientationData() { return m_orientation.data(); }
+
+        const double* orientationData() const { return m_orientation.data(); }
+
+        /**
+         * @brief add a vector to the position of every pose
+         *
+         * @param offset the vector to add
+         */
+        void translate(const V2Position& offset) { m_position.translate(offset); }
+
+        /**
+         * @brief rotate every pose in the array around the origin
+         *
+         * The positions are rotated like Vector2D::rotatedBy, and the angle is added to the orientations
+         *
+         * @param angle the angle to rotate by
+         */
+        void rotate(Angle angle) {
+            m_position.rotate(angle);
+            const double a = angle.internal();
+            double* __restrict orientation = m_orientation.data();
+            for (std::size_t i = 0; i < size(); i++) orientation[i] += a;
+        }
+
+        /**
+         * @brief transform every pose from a local frame to the frame the local frame is in
+         *
+         * For example, if the poses are relative to the robot, and the frame is the pose of the robot on the field,
+         * the poses become relative to the field
+         *
+         * @param frame the pose of the local frame
+         */
+        void transformBy(const Pose& frame) {
+            rotate(frame.orientation);
+            translate(frame);
+        }
+
+        /**
+         * @brief find the distance between the position of every pose and a point
+         *
+         * @param point the point
+         * @param out where to write the distances. Only as many distances as fit are written
+         * @return std::size_t the number of distances written
+         */
+        std::size_t distancesTo(const V2Position& point, std::span<Length> out) const {
+            return m_position.distancesTo(point, out);
+        }
+    private:
+        Vector2DArray<Length> m_position;
+        std::vector<double> m_orientation;
+};
+} // namespace units
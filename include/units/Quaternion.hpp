@@ -0,0 +1,242 @@
+#pragma once
+
+#include "units/Angle.hpp"
+#include "units/Vector3D.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace units {
+/**
+ * @class Quaternion
+ *
+ * @brief a rotation in 3D, stored as a unit quaternion
+ *
+ * Euler angles need trig to rotate a vector or to add a small rotation, and lose an axis when the pitch reaches 90
+ * degrees. A quaternion rotates a vector with 15 multiplications, and adds the rotation of a gyro sample with a few
+ * more, without any trig, so an orientation can be integrated at the rate of the sensor. Trig is only needed to turn
+ * it into angles, which only has to happen when the angles are read.
+ *
+ * The quaternion rotates vectors from the axes of a body, like an IMU, into the axes of the world. Rotations follow
+ * the right hand rule, so a positive rotation around a z axis pointing up is counterclockwise.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * units::Quaternion orientation;
+ * while (true) {
+ *     orientation = orientation.integrate(imu.getGyroRates(), 10_msec);
+ *     // how far the robot moved along the field, when it drives 1 cm forwards while climbing a barrier
+ *     const units::V3Position step = orientation.rotate(units::V3Position(1_cm, 0_cm, 0_cm));
+ *     pros::delay(10);
+ * }
+ * @endcode
+ */
+class Quaternion {
+    public:
+        double w; /** real part */
+        double x; /** i component */
+        double y; /** j component */
+        double z; /** k component */
+
+        /**
+         * @brief Construct a new Quaternion object
+         *
+         * This constructor initializes the quaternion to the identity, which doesn't rotate anything
+         */
+        constexpr Quaternion() : w(1), x(0), y(0), z(0) {}
+
+        /**
+         * @brief Construct a new Quaternion object
+         *
+         * This constructor initializes the components to the given values. They should have a norm of 1 to be a
+         * rotation
+         *
+         * @param nw real part
+         * @param nx i component
+         * @param ny j component
+         * @param nz k component
+         */
+        constexpr Quaternion(double nw, double nx, double ny, double nz) : w(nw), x(nx), y(ny), z(nz) {}
+
+        /**
+         * @brief Create a rotation around an axis
+         *
+         * @param axis the axis, which doesn't have to have a length of 1
+         * @param angle the angle, following the right hand rule
+         * @return Quaternion the rotation, or the identity if the axis has a length of 0
+         */
+        static Quaternion fromAxisAngle(const Vector3D<Number>& axis, Angle angle) {
+            const double ax = axis.x.internal(), ay = axis.y.internal(), az = axis.z.internal();
+            const double length = std::sqrt(ax * ax + ay * ay + az * az);
+            if (length == 0) return Quaternion();
+            const double s = std::sin(angle.internal() / 2) / length;
+            return Quaternion(std::cos(angle.internal() / 2), ax * s, ay * s, az * s);
+        }
+
+        /**
+         * @brief Create a rotation from a roll, a pitch and a yaw
+         *
+         * The body is rotated around the z axis by the yaw, then around its new y axis by the pitch, then around its
+         * new x axis by the roll, like aircraft angles
+         *
+         * @param roll the rotation around the x axis
+         * @param pitch the rotation around the y axis
+         * @param yaw the rotation around the z axis
+         * @return Quaternion the rotation
+         */
+        static Quaternion fromEuler(Angle roll, Angle pitch, Angle yaw) {
+            const double cr = std::cos(roll.internal() / 2), sr = std::sin(roll.internal() / 2);
+            const double cp = std::cos(pitch.internal() / 2), sp = std::sin(pitch.internal() / 2);
+            const double cy = std::cos(yaw.internal() / 2), sy = std::sin(yaw.internal() / 2);
+            return Quaternion(cr * cp * cy + sr * sp * sy, sr * cp * cy - cr * sp * sy, cr * sp * cy + sr * cp * sy,
+                              cr * cp * sy - sr * sp * cy);
+        }
+
+        /**
+         * @brief Create the rotation which levels a body, from what its accelerometer measures at rest
+         *
+         * An accelerometer at rest measures gravity pointing up, so the rotation takes that direction to the z axis
+         * of the world. The yaw can't be measured from gravity, so it is 0. No trig is used.
+         *
+         * @param measured the acceleration measured at rest, in the axes of the body
+         * @return Quaternion the rotation, or the identity if the acceleration is 0 or not finite
+         */
+        template <isQuantity T> static constexpr Quaternion fromGravity(const Vector3D<T>& measured) {
+            const double mx = measured.x.internal(), my = measured.y.internal(), mz = measured.z.internal();
+            const double length = cmath::sqrt(mx * mx + my * my + mz * mz);
+            if (!(length > 0 && length < INFINITY)) return Quaternion();
+            const double ux = mx / length, uy = my / length, uz = mz / length;
+            // the half way rotation from the measured direction to the z axis. Upside down, it turns around x instead
+            if (uz < -1 + 1E-9) return Quaternion(0, 1, 0, 0);
+            return Quaternion(1 + uz, uy, -ux, 0).normalized();
+        }
+
+        /**
+         * @brief * operator overload. Combines two rotations
+         *
+         * The result rotates a vector by other first, then by this
+         *
+         * @param other the rotation to apply first
+         * @return Quaternion the combined rotation
+         */
+        constexpr Quaternion operator*(const Quaternion& other) const {
+            return Quaternion(w * other.w - x * other.x - y * other.y - z * other.z,
+                              w * other.x + x * other.w + y * other.z - z * other.y,
+                              w * other.y - x * other.z + y * other.w + z * other.x,
+                              w * other.z + x * other.y - y * other.x + z * other.w);
+        }
+
+        /**
+         * @brief Get the inverse rotation, which for a unit quaternion is its conjugate
+         *
+         * @return Quaternion the rotation from the world back into the body
+         */
+        constexpr Quaternion conjugate() const { return Quaternion(w, -x, -y, -z); }
+
+        /**
+         * @brief Get the squared norm of the quaternion, which is 1 for a rotation
+         *
+         * @return double the squared norm
+         */
+        constexpr double norm2() const { return w * w + x * x + y * y + z * z; }
+
+        /**
+         * @brief Scale the quaternion to a norm of 1 exactly
+         *
+         * @return Quaternion the unit quaternion, or the identity if the norm is 0
+         */
+        constexpr Quaternion normalized() const {
+            const double n2 = norm2();
+            if (n2 == 0) return Quaternion();
+            const double scale = 1 / cmath::sqrt(n2);
+            return Quaternion(w * scale, x * scale, y * scale, z * scale);
+        }
+
+        /**
+         * @brief Scale a quaternion which is close to a norm of 1 back to it, without a square root or a division
+         *
+         * One step of Newton's method for the inverse square root. The error of the norm is squared, so a quaternion
+         * which drifted by 1E-4 while integrating a sample is back within 1E-8
+         *
+         * @return Quaternion the quaternion, with a norm much closer to 1
+         */
+        constexpr Quaternion renormalized() const {
+            const double scale = (3 - norm2()) / 2;
+            return Quaternion(w * scale, x * scale, y * scale, z * scale);
+        }
+
+        /**
+         * @brief Rotate a vector from the axes of the body into the axes of the world
+         *
+         * @param v the vector, in the axes of the body
+         * @return Vector3D<T> the vector, in the axes of the world
+         */
+        template <isQuantity T> constexpr Vector3D<T> rotate(const Vector3D<T>& v) const {
+            const double vx = v.x.internal(), vy = v.y.internal(), vz = v.z.internal();
+            // v + 2w(q x v) + 2q x (q x v), for the vector part q
+            const double tx = 2 * (y * vz - z * vy);
+            const double ty = 2 * (z * vx - x * vz);
+            const double tz = 2 * (x * vy - y * vx);
+            return Vector3D<T>(T(vx + w * tx + y * tz - z * ty), T(vy + w * ty + z * tx - x * tz),
+                               T(vz + w * tz + x * ty - y * tx));
+        }
+
+        /**
+         * @brief Add the rotation of a gyro sample to the orientation
+         *
+         * The rates are held for the whole time step, and the rotation they add is approximated to second order, so
+         * a second of 10 ms samples at 500 degrees per second drifts by less than 1E-4 degrees. The result is
+         * renormalized.
+         *
+         * @param rates the rates around the x, y and z axes of the body, following the right hand rule
+         * @param dt the time step
+         * @return Quaternion the new orientation
+         */
+        constexpr Quaternion integrate(const Vector3D<AngularVelocity>& rates, Time dt) const {
+            const double hx = rates.x.internal() * dt.internal() / 2;
+            const double hy = rates.y.internal() * dt.internal() / 2;
+            const double hz = rates.z.internal() * dt.internal() / 2;
+            const double h2 = hx * hx + hy * hy + hz * hz;
+            // cos and sin of the half angle, as Taylor series. The scale of the vector part is sin(h) / h
+            const double c = 1 - h2 / 2 + h2 * h2 / 24;
+            const double s = 1 - h2 / 6;
+            return (*this * Quaternion(c, hx * s, hy * s, hz * s)).renormalized();
+        }
+
+        /**
+         * @brief Get the cosine of the angle between the z axis of the body and the z axis of the world
+         *
+         * This needs no trig, so it is the cheapest way to check how far a robot is tipped
+         *
+         * @return Number the cosine. 1 when the body is level, 0 when it is on its side
+         */
+        constexpr Number cosTilt() const { return 1 - 2 * (x * x + y * y); }
+
+        /**
+         * @brief Get the angle between the z axis of the body and the z axis of the world
+         *
+         * @return Angle the tilt, from 0 to 180 degrees
+         */
+        Angle tilt() const { return Angle(std::acos(std::clamp(cosTilt().internal(), -1.0, 1.0))); }
+
+        /**
+         * @brief Get the roll, the rotation around the x axis, as in fromEuler
+         *
+         * @return Angle the roll, from -180 to 180 degrees
+         */
+        constexpr Angle roll() const { return Angle(cmath::atan2(2 * (w * x + y * z), 1 - 2 * (x * x + y * y))); }
+
+        /**
+         * @brief Get the pitch, the rotation around the y axis, as in fromEuler
+         *
+         * @return Angle the pitch, from -90 to 90 degrees
+         */
+        Angle pitch() const { return Angle(std::asin(std::clamp(2 * (w * y - x * z), -1.0, 1.0))); }
+
+        /**
+         * @brief Get the yaw, the rotation around the z axis, as in fromEuler
+         *
+         * @return Angle the yaw, from -180 to 180 degrees
+         */
+        constexpr Angle yaw() const { return Angle(cmath::atan2(2 * (w * z + x * y), 1 - 2 * (y * y + z * z))); }
+};
+} // namespace units
@@ -0,0 +1,483 @@
+#pragma once
+
+#include "units/core.hpp"
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/**
+ * Online statistics of quantities, which take O(1) memory no matter how many samples are added
+ *
+ * Instrumentation like jitter, sensor noise and latency needs a distribution, but a control loop can't store every
+ * sample it measures. These accumulate a sample at a time instead, with a handful of doubles and no allocation:
+ * - RunningStats: the exact mean, variance, minimum and maximum of every sample, by Welford's algorithm
+ * - Ewma: an exponentially weighted mean and variance, which follow recent samples
+ * - QuantileEstimator: an estimate of a quantile, like the median or the 99th percentile, by the P² algorithm
+ * - SlidingMedian: the exact median of the latest N samples, which rejects outliers of a noisy sensor
+ *
+ * None of them lock, so each must only be written by one task at a time. Every type is trivially copyable, so a
+ * snapshot can be published through a DoubleBuffer.
+ */
+namespace units {
+/**
+ * @brief The mean, variance, minimum and maximum of every sample added
+ *
+ * Welford's algorithm updates the mean and the sum of squared differences from it with every sample, so it doesn't
+ * lose precision like summing the squares of samples does when the variance is small compared to the mean, which is
+ * the case for the jitter of a loop period.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * units::RunningStats<Time> period;
+ * Time last = from_usec(pros::micros());
+ * while (true) {
+ *     const Time now = from_usec(pros::micros());
+ *     period.add(now - last);
+ *     last = now;
+ *     // the jitter of the loop
+ *     std::cout << to_usec(period.stddev()) << std::endl;
+ *     pros::delay(10);
+ * }
+ * @endcode
+ *
+ * @tparam Q the quantity of the samples
+ */
+template <isQuantity Q> class RunningStats {
+    public:
+        /**
+         * @brief Construct a new RunningStats object, without any samples
+         */
+        constexpr RunningStats() = default;
+
+        /**
+         * @brief add a sample
+         *
+         * @param sample the sample. Samples which aren't finite are ignored, so one bad reading can't poison the
+         * statistics
+         */
+        constexpr void add(Q sample) {
+            const double x = sample.internal();
+            if (!(x - x == 0)) return;
+            m_count++;
+            const double delta = x - m_mean;
+            m_mean += delta / m_count;
+            m_m2 += delta * (x - m_mean);
+            m_min = x < m_min ? x : m_min;
+            m_max = x > m_max ? x : m_max;
+        }
+
+        /**
+         * @brief add every sample of other statistics, as if they were added to these
+         *
+         * @param other the statistics to merge in
+         */
+        constexpr void merge(const RunningStats& other) {
+            if (other.m_count == 0) return;
+            const double count = double(m_count) + other.m_count;
+            const double delta = other.m_mean - m_mean;
+            m_mean += delta * other.m_count / count;
+            m_m2 += other.m_m2 + delta * delta * m_count * other.m_count / count;
+            m_count += other.m_count;
+            m_min = other.m_min < m_min ? other.m_min : m_min;
+            m_max = other.m_max > m_max ? other.m_max : m_max;
+        }
+
+        /**
+         * @brief remove every sample
+         */
+        constexpr void reset() { *this = RunningStats(); }
+
+        /**
+         * @brief get the number of samples
+         *
+         * @return uint32_t the number of samples
+         */
+        constexpr uint32_t count() const { return m_count; }
+
+        /**
+         * @brief get the mean of the samples
+         *
+         * @return Q the mean, or NaN if there are no samples
+         */
+        constexpr Q mean() const { return Q(m_count == 0 ? std::numeric_limits<double>::quiet_NaN() : m_mean); }
+
+        /**
+         * @brief get the sample variance, which divides by one less than the number of samples
+         *
+         * @return Multiplied<Q, Q> the variance, or NaN if there are less than 2 samples
+         */
+        constexpr Multiplied<Q, Q> variance() const {
+            return Multiplied<Q, Q>(m_count < 2 ? std::numeric_limits<double>::quiet_NaN() : m_m2 / (m_count - 1));
+        }
+
+        /**
+         * @brief get the sample standard deviation
+         *
+         * @return Q the standard deviation, or NaN if there are less than 2 samples
+         */
+        Q stddev() const { return Q(std::sqrt(variance().internal())); }
+
+        /**
+         * @brief get the smallest sample
+         *
+         * @return Q the smallest sample, or INFINITY if there are no samples
+         */
+        constexpr Q min() const { return Q(m_min); }
+
+        /**
+         * @brief get the largest sample
+         *
+         * @return Q the largest sample, or -INFINITY if there are no samples
+         */
+        constexpr Q max() const { return Q(m_max); }
+    private:
+        uint32_t m_count = 0;
+        double m_mean = 0;
+        // the sum of the squared differences of every sample from the mean
+        double m_m2 = 0;
+        double m_min = std::numeric_limits<double>::infinity();
+        double m_max = -std::numeric_limits<double>::infinity();
+};
+
+/**
+ * @brief An exponentially weighted moving mean and variance
+ *
+ * Every sample moves the mean towards it by a fixed fraction, so older samples fade away, and the statistics follow
+ * changes like a sensor warming up. The variance is weighted the same way.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * // follows the noise of the last half second of readings taken every 10 ms
+ * auto noise = units::Ewma<AngularVelocity>::fromTimeConstant(500_msec, 10_msec);
+ * while (true) {
+ *     noise.add(imu.getRate());
+ *     std::cout << to_degps(noise.stddev()) << std::endl;
+ *     pros::delay(10);
+ * }
+ * @endcode
+ *
+ * @tparam Q the quantity of the samples
+ */
+template <isQuantity Q> class Ewma {
+    public:
+        /**
+         * @brief Construct a new Ewma object
+         *
+         * @param alpha the weight of every new sample, from 0 to 1. Larger weights follow changes faster, and smooth
+         * less. Weights outside of that range are clamped to it
+         */
+        constexpr explicit Ewma(Number alpha)
+            : m_alpha(alpha.internal() > 1 ? 1 : (alpha.internal() > 0 ? alpha.internal() : 0)) {}
+
+        /**
+         * @brief Create an Ewma which forgets samples with a time constant
+         *
+         * @param timeConstant how long it takes for a sample to fade to 1/e of its weight
+         * @param period how often samples are added
+         * @return Ewma the moving statistics
+         */
+        static Ewma fromTimeConstant(Time timeConstant, Time period) {
+            return Ewma(1 - std::exp(-period.internal() / timeConstant.internal()));
+        }
+
+        /**
+         * @brief add a sample
+         *
+         * The first sample sets the mean
+         *
+         * @param sample the sample. Samples which aren't finite are ignored
+         */
+        constexpr void add(Q sample) {
+            const double x = sample.internal();
+            if (!(x - x == 0)) return;
+            if (!m_initialized) {
+                m_mean = x;
+                m_variance = 0;
+                m_initialized = true;
+                return;
+            }
+            const double delta = x - m_mean;
+            m_mean += m_alpha * delta;
+            m_variance = (1 - m_alpha) * (m_variance + m_alpha * delta * delta);
+        }
+
+        /**
+         * @brief forget every sample
+         */
+        constexpr void reset() { m_initialized = false; }
+
+        /**
+         * @brief get whether a sample has been added
+         *
+         * @return true at least one sample has been added
+         * @return false there are no samples
+         */
+        constexpr bool isInitialized() const { return m_initialized; }
+
+        /**
+         * @brief get the weighted mean
+         *
+         * @return Q the mean, or NaN if there are no samples
+         */
+        constexpr Q mean() const { return Q(m_initialized ? m_mean : std::numeric_limits<double>::quiet_NaN()); }
+
+        /**
+         * @brief get the weighted variance
+         *
+         * @return Multiplied<Q, Q> the variance, or NaN if there are no samples
+         */
+        constexpr Multiplied<Q, Q> variance() const {
+            return Multiplied<Q, Q>(m_initialized ? m_variance : std::numeric_limits<double>::quiet_NaN());
+        }
+
+        /**
+         * @brief get the weighted standard deviation
+         *
+         * @return Q the standard deviation, or NaN if there are no samples
+         */
+        Q stddev() const { return Q(std::sqrt(variance().internal())); }
+    private:
+        double m_alpha;
+        double m_mean = 0;
+        double m_variance = 0;
+        bool m_initialized = false;
+};
+
+/**
+ * @brief An estimate of a quantile of every sample added, like the median or the 99th percentile
+ *
+ * The exact quantile needs every sample. The P² algorithm of Jain and Chlamtac keeps 5 markers instead: the minimum,
+ * the maximum, the quantile and two points half way to it, and moves them with every sample along a parabola fitted
+ * through their neighbours. It is exact for the first 5 samples, and usually within a few percent of the spread of
+ * the samples afterwards. Extreme quantiles, like the 99th percentile, need a few hundred samples to settle.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * units::QuantileEstimator<Time> latency(0.99);
+ * while (true) {
+ *     const Time start = from_usec(pros::micros());
+ *     chassis.update();
+ *     latency.add(from_usec(pros::micros()) - start);
+ *     pros::delay(10);
+ * }
+ * @endcode
+ *
+ * @tparam Q the quantity of the samples
+ */
+template <isQuantity Q> class QuantileEstimator {
+    public:
+        /**
+         * @brief Construct a new QuantileEstimator object
+         *
+         * @param quantile the quantile to estimate, from 0 to 1. 0.5 is the median. Quantiles outside of that range
+         * are clamped to it
+         */
+        constexpr explicit QuantileEstimator(Number quantile)
+            : m_quantile(quantile.internal() > 1 ? 1 : (quantile.internal() > 0 ? quantile.internal() : 0)) {}
+
+        /**
+         * @brief add a sample
+         *
+         * @param sample the sample. Samples which aren't finite are ignored
+         */
+        constexpr void add(Q sample) {
+            const double x = sample.internal();
+            if (!(x - x == 0)) return;
+            if (m_count < MARKERS) {
+                // the first samples are kept sorted, and become the markers
+                uint32_t i = m_count++;
+                for (; i > 0 && m_heights[i - 1] > x; i--) m_heights[i] = m_heights[i - 1];
+                m_heights[i] = x;
+                if (m_count == MARKERS) {
+                    const double p = m_quantile;
+                    for (uint32_t j = 0; j < MARKERS; j++) m_positions[j] = j;
+                    m_desired = {0, 2 * p, 4 * p, 2 + 2 * p, 4};
+                }
+                return;
+            }
+            m_count++;
+            // find the cell of the sample, extending the extremes if it is outside of them
+            uint32_t cell;
+            if (x < m_heights[0]) {
+                m_heights[0] = x;
+                cell = 0;
+            } else if (x >= m_heights[MARKERS - 1]) {
+                m_heights[MARKERS - 1] = x;
+                cell = MARKERS - 2;
+            } else {
+                cell = 0;
+                while (x >= m_heights[cell + 1]) cell++;
+            }
+            for (uint32_t i = cell + 1; i < MARKERS; i++) m_positions[i]++;
+            const double p = m_quantile;
+            const std::array<double, MARKERS> increments = {0, p / 2, p, (1 + p) / 2, 1};
+            for (uint32_t i = 0; i < MARKERS; i++) m_desired[i] += increments[i];
+            // move the middle markers towards where they should be, by at most one position each
+            for (uint32_t i = 1; i < MARKERS - 1; i++) {
+                const double offset = m_desired[i] - m_positions[i];
+                const bool up = offset >= 1 && m_positions[i + 1] - m_positions[i] > 1;
+                const bool down = offset <= -1 && m_positions[i - 1] - m_positions[i] < -1;
+                if (!up && !down) continue;
+                const int32_t step = up ? 1 : -1;
+                const double parabolic = parabola(i, step);
+                if (m_heights[i - 1] < parabolic && parabolic < m_heights[i + 1]) m_heights[i] = parabolic;
+                else {
+                    // the parabola overshot a neighbour, so the marker moves along the line to it instead
+                    const uint32_t neighbour = i + step;
+                    m_heights[i] += step * (m_heights[neighbour] - m_heights[i]) /
+                                    double(m_positions[neighbour] - m_positions[i]);
+                }
+                m_positions[i] += step;
+            }
+        }
+
+        /**
+         * @brief forget every sample
+         */
+        constexpr void reset() { m_count = 0; }
+
+        /**
+         * @brief get the number of samples
+         *
+         * @return uint32_t the number of samples
+         */
+        constexpr uint32_t count() const { return m_count; }
+
+        /**
+         * @brief get the estimate of the quantile
+         *
+         * @return Q the estimate, or NaN if there are no samples
+         */
+        constexpr Q value() const {
+            if (m_count == 0) return Q(std::numeric_limits<double>::quiet_NaN());
+            // until the markers are set up, the samples themselves are kept, so the quantile is picked from them
+            if (m_count < MARKERS) return Q(m_heights[uint32_t(m_quantile * (m_count - 1) + 0.5)]);
+            return Q(m_heights[2]);
+        }
+    private:
+        static constexpr uint32_t MARKERS = 5;
+
+        /**
+         * @brief the height a marker moves to along the parabola through it and its neighbours
+         *
+         * @param i the marker
+         * @param step the direction it moves in, 1 or -1
+         * @return double the height
+         */
+        constexpr double parabola(uint32_t i, int32_t step) const {
+            const double below = m_positions[i] - m_positions[i - 1];
+            const double above = m_positions[i + 1] - m_positions[i];
+            return m_heights[i] + step / (below + above) *
+                                      ((below + step) * (m_heights[i + 1] - m_heights[i]) / above +
+                                       (above - step) * (m_heights[i] - m_heights[i - 1]) / below);
+        }
+
+        double m_quantile;
+        uint32_t m_count = 0;
+        // the heights of the markers, and their positions among the sorted samples so far
+        std::array<double, MARKERS> m_heights {};
+        std::array<int32_t, MARKERS> m_positions {};
+        // where every marker should be
+        std::array<double, MARKERS> m_desired {};
+};
+
+/**
+ * @brief The exact median of the latest N samples
+ *
+ * A median ignores a few outliers completely, where a mean is pulled towards them, so it suits sensors which
+ * sometimes report something far off, like a distance sensor which sees past an object. The window is kept twice: in
+ * the order the samples arrived, to know which one leaves, and sorted. The sample which arrives takes the slot of the
+ * one which leaves in the sorted window, and is moved to its place from there, so adding a sample takes a bounded
+ * number of steps which only depends on N, and the median is a lookup.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * units::SlidingMedian<Length, 5> distance;
+ * while (true) {
+ *     distance.add(sensor.getDistance());
+ *     std::cout << to_in(distance.value()) << std::endl;
+ *     pros::delay(10);
+ * }
+ * @endcode
+ *
+ * @tparam Q the quantity of the samples
+ * @tparam N the number of samples in the window. Windows of 3 to 15 samples are typical
+ */
+template <isQuantity Q, std::size_t N> class SlidingMedian {
+        static_assert(N > 0, "The window needs at least one sample");
+    public:
+        /**
+         * @brief Construct a new SlidingMedian object, without any samples
+         */
+        constexpr SlidingMedian() = default;
+
+        /**
+         * @brief add a sample, which replaces the oldest one once the window is full
+         *
+         * @param sample the sample. Samples which aren't finite are ignored
+         */
+        constexpr void add(Q sample) {
+            const double x = sample.internal();
+            if (!(x - x == 0)) return;
+            std::size_t i;
+            if (m_count < N) {
+                i = m_count++;
+            } else {
+                // the sample which leaves is somewhere in the sorted window, and its slot is reused
+                const double oldest = m_arrivals[m_next];
+                i = 0;
+                while (m_sorted[i] != oldest) i++;
+            }
+            m_arrivals[m_next] = x;
+            m_next = (m_next + 1) % N;
+            // only one of these loops moves the sample, as the rest of the window is still sorted
+            for (; i > 0 && m_sorted[i - 1] > x; i--) m_sorted[i] = m_sorted[i - 1];
+            for (; i + 1 < m_count && m_sorted[i + 1] < x; i++) m_sorted[i] = m_sorted[i + 1];
+            m_sorted[i] = x;
+        }
+
+        /**
+         * @brief forget every sample
+         */
+        constexpr void reset() {
+            m_count = 0;
+            m_next = 0;
+        }
+
+        /**
+         * @brief get the number of samples in the window
+         *
+         * @return std::size_t the number of samples, at most N
+         */
+        constexpr std::size_t count() const { return m_count; }
+
+        /**
+         * @brief get whether the window is full, so the median is over N samples
+         *
+         * @return true the window is full
+         * @return false fewer than N samples have been added since the last reset
+         */
+        constexpr bool full() const { return m_count == N; }
+
+        /**
+         * @brief get the median of the samples in the window
+         *
+         * @return Q the median, which is the mean of the two middle samples if there is an even number of them, or
+         * NaN if there are no samples
+         */
+        constexpr Q value() const {
+            if (m_count == 0) return Q(std::numeric_limits<double>::quiet_NaN());
+            if (m_count % 2 == 1) return Q(m_sorted[m_count / 2]);
+            return Q((m_sorted[m_count / 2 - 1] + m_sorted[m_count / 2]) / 2);
+        }
+    private:
+        // the samples in the order they arrived, as a ring, and sorted
+        std::array<double, N> m_arrivals {};
+        std::array<double, N> m_sorted {};
+        std::size_t m_count = 0;
+        // the slot of the ring the next sample goes in, which holds the oldest sample once the window is full
+        std::size_t m_next = 0;
+};
+} // namespace units
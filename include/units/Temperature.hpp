@@ -1,30 +1,25 @@
 #pragma once
 
-#include "units/units.hpp"
+#include "units/core.hpp"
 
-class Temperature : public Quantity<std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<0>,
-                                    std::ratio<1>, std::ratio<0>, std::ratio<0>> {
+class Temperature : public BasicQuantity<units::Dimension {0, 0, 0, 0, 0, 1, 0, 0}> {
     public:
         explicit constexpr Temperature(double value)
-            : Quantity<std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<1>,
-                       std::ratio<0>, std::ratio<0>>(value) {}
-
-        constexpr Temperature(Quantity<std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<0>,
-                                       std::ratio<1>, std::ratio<0>, std::ratio<0>>
-                                  value)
-            : Quantity<std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<1>,
-                       std::ratio<0>, std::ratio<0>>(value) {};
+            : BasicQuantity<units::Dimension {0, 0, 0, 0, 0, 1, 0, 0}>(value) {}
+
+        constexpr Temperature(BasicQuantity<units::Dimension {0, 0, 0, 0, 0, 1, 0, 0}> value)
+            : BasicQuantity<units::Dimension {0, 0, 0, 0, 0, 1, 0, 0}>(value) {};
 };
 
-template <> struct LookupName<Quantity<std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<0>, std::ratio<0>,
-                                       std::ratio<1>, std::ratio<0>, std::ratio<0>>> {
+template <> struct LookupName<BasicQuantity<units::Dimension {0, 0, 0, 0, 0, 1, 0, 0}>> {
         using Named = Temperature;
 };
 
-inline std::ostream& operator<<(std::ostream& os, const Temperature& quantity) {
-    os << quantity.internal() << " k";
-    return os;
-}
+namespace units {
+template <> struct UnitSuffix<Temperature> {
+        static constexpr std::string_view value = " k";
+};
+} // namespace units
 
 constexpr Temperature kelvin = Temperature(1.0);
 
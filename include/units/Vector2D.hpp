@@ -1,6 +1,7 @@
 #pragma once
 
 #include "units/Angle.hpp"
+#include "units/Mechanics.hpp"
 
 namespace units {
 /**
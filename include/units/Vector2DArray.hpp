@@ -0,0 +1,260 @@
+#pragma once
+
+#include "units/Vector2D.hpp"
+#include <cstddef>
+#include <initializer_list>
+#include <span>
+#include <vector>
+
+namespace units {
+/**
+ * @class Vector2DArray
+ *
+ * @brief an array of 2D vectors, stored as an array of x components and an array of y components
+ *
+ * Storing the components in separate arrays, instead of storing an array of Vector2D objects, lets batch operations
+ * process every vector in a single tight loop the compiler can unroll and vectorize. The components are stored in their
+ * base unit as raw doubles, but every function takes and returns quantities, so the unit checking of Vector2D is kept.
+ *
+ * @tparam T the type of quantity to use for the vector components
+ */
+template <isQuantity T> class Vector2DArray {
+    public:
+        /**
+         * @brief Construct a new empty Vector2DArray object
+         */
+        Vector2DArray() = default;
+
+        /**
+         * @brief Construct a new Vector2DArray object
+         *
+         * This constructor initializes every vector to 0
+         *
+         * @param size the number of vectors
+         */
+        explicit Vector2DArray(std::size_t size)
+            : m_x(size),
+              m_y(size) {}
+
+        /**
+         * @brief Construct a new Vector2DArray object from a list of vectors
+         *
+         * @param vectors the vectors
+         */
+        Vector2DArray(std::initializer_list<Vector2D<T>> vectors) {
+            reserve(vectors.size());
+            for (const Vector2D<T>& vector : vectors) push_back(vector);
+        }
+
+        /**
+         * @brief get the number of vectors in the array
+         *
+         * @return std::size_t
+         */
+        std::size_t size() const { return m_x.size(); }
+
+        /**
+         * @brief check whether the array is empty
+         *
+         * @return true the array has no vectors
+         * @return false the array has at least one vector
+         */
+        bool empty() const { return m_x.empty(); }
+
+        /**
+         * @brief reserve space for vectors, so adding them doesn't allocate memory
+         *
+         * @param capacity the number of vectors to reserve space for
+         */
+        void reserve(std::size_t capacity) {
+            m_x.reserve(capacity);
+            m_y.reserve(capacity);
+        }
+
+        /**
+         * @brief change the number of vectors in the array. New vectors are initialized to 0
+         *
+         * @param size the new number of vectors
+         */
+        void resize(std::size_t size) {
+            m_x.resize(size);
+            m_y.resize(size);
+        }
+
+        /**
+         * @brief remove every vector from the array
+         */
+        void clear() {
+            m_x.clear();
+            m_y.clear();
+        }
+
+        /**
+         * @brief add a vector to the end of the array
+         *
+         * @param vector the vector to add
+         */
+        void push_back(const Vector2D<T>& vector) {
+            m_x.push_back(vector.x.internal());
+            m_y.push_back(vector.y.internal());
+        }
+
+        /**
+         * @brief get a vector in the array
+         *
+         * @param index the index of the vector
+         * @return Vector2D<T> a copy of the vector
+         */
+        Vector2D<T> operator[](std::size_t index) const { return Vector2D<T>(T(m_x[index]), T(m_y[index])); }
+
+        /**
+         * @brief set a vector in the array
+         *
+         * @param index the index of the vector
+         * @param vector the new value of the vector
+         */
+        void set(std::size_t index, const Vector2D<T>& vector) {
+            m_x[index] = vector.x.internal();
+            m_y[index] = vector.y.internal();
+        }
+
+        /**
+         * @brief get the x components, in the base unit of T
+         *
+         * This is meant for code that needs to process the components in ways the batch operations don't cover
+         *
+         * @return double* the x components
+         */
+        double* xData() { return m_x.data(); }
+
+        const double* xData() const { return m_x.data(); }
+
+        /**
+         * @brief get the y components, in the base unit of T
+         *
+         * @return double* the y components
+         */
+        double* yData() { return m_y.data(); }
+
+        const double* yData() const { return m_y.data(); }
+
+        /**
+         * @brief add a vector to every vector in the array
+         *
+         * @param offset the vector to add
+         */
+        void translate(const Vector2D<T>& offset) {
+            const double dx = offset.x.internal();
+            const double dy = offset.y.internal();
+            double* __restrict x = m_x.data();
+            double* __restrict y = m_y.data();
+            for (std::size_t i = 0; i < size(); i++) {
+                x[i] += dx;
+                y[i] += dy;
+            }
+        }
+
+        /**
+         * @brief rotate every vector in the array around the origin, like Vector2D::rotatedBy
+         *
+         * @param angle the angle to rotate by
+         */
+        void rotate(Angle angle) {
+            const double c = std::cos(angle.internal());
+            const double s = std::sin(angle.internal());
+            double* __restrict x = m_x.data();
+            double* __restrict y = m_y.data();
+            for (std::size_t i = 0; i < size(); i++) {
+                const double nx = x[i] * c - y[i] * s;
+                y[i] = x[i] * s + y[i] * c;
+                x[i] = nx;
+            }
+        }
+
+        /**
+         * @brief multiply every vector in the array by a double
+         *
+         * @param factor the double to multiply the vectors by
+         */
+        void scale(double factor) {
+            double* __restrict x = m_x.data();
+            double* __restrict y = m_y.data();
+            for (std::size_t i = 0; i < size(); i++) {
+                x[i] *= factor;
+                y[i] *= factor;
+            }
+        }
+
+        /**
+         * @brief find the distance between every vector in the array and a point
+         *
+         * @param point the point
+         * @param out where to write the distances. Only as many distances as fit are written
+         * @return std::size_t the number of distances written
+         */
+        std::size_t distancesTo(const Vector2D<T>& point, std::span<T> out) const {
+            const std::size_t count = std::min(size(), out.size());
+            const double px = point.x.internal();
+            const double py = point.y.internal();
+            const double* __restrict x = m_x.data();
+            const double* __restrict y = m_y.data();
+            for (std::size_t i = 0; i < count; i++) {
+                const double dx = x[i] - px;
+                const double dy = y[i] - py;
+                out[i] = T(std::sqrt(dx * dx + dy * dy));
+            }
+            return count;
+        }
+
+        /**
+         * @brief find the dot product of every vector in the array and another vector
+         *
+         * @tparam Q the type of quantity to use for the other vector
+         * @tparam R the type of quantity to use for the result
+         * @param other the vector to calculate the dot products with
+         * @param out where to write the dot products. Only as many dot products as fit are written
+         * @return std::size_t the number of dot products written
+         */
+        template <isQuantity Q, isQuantity R = Multiplied<T, Q>>
+        std::size_t dot(const Vector2D<Q>& other, std::span<R> out) const {
+            const std::size_t count = std::min(size(), out.size());
+            const double ox = other.x.internal();
+            const double oy = other.y.internal();
+            const double* __restrict x = m_x.data();
+            const double* __restrict y = m_y.data();
+            for (std::size_t i = 0; i < count; i++) out[i] = R(x[i] * ox + y[i] * oy);
+            return count;
+        }
+
+        /**
+         * @brief find the index of the vector closest to a point
+         *
+         * @param point the point
+         * @return std::size_t the index of the closest vector, or size() if the array is empty
+         */
+        std::size_t nearest(const Vector2D<T>& point) const {
+            const double px = point.x.internal();
+            const double py = point.y.internal();
+            std::size_t best = size();
+            double bestDistance = INFINITY;
+            // squared distances are compared, so no square root is needed
+            for (std::size_t i = 0; i < size(); i++) {
+                const double dx = m_x[i] - px;
+                const double dy = m_y[i] - py;
+                const double distance = dx * dx + dy * dy;
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = i;
+                }
+            }
+            return best;
+        }
+    private:
+        std::vector<double> m_x;
+        std::vector<double> m_y;
+};
+
+// define some common vector array types
+typedef Vector2DArray<Length> V2PositionArray;
+typedef Vector2DArray<LinearVelocity> V2VelocityArray;
+} // namespace units
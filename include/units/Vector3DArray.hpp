@@ -0,0 +1,519 @@
+#pragma once
+
+#include "units/Quaternion.hpp"
+#include "units/Vector3D.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <span>
+#include <vector>
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace units {
+namespace detail {
+/**
+ * @brief Kernels on 3D vectors stored as separate arrays of float components, one vector at a time
+ *
+ * These are plain loops, which the compiler vectorizes on targets where it can. Vector3DKernels finishes the vectors
+ * left over by its NEON loops with them, and they are the reference its NEON loops are checked against.
+ */
+struct Vector3DScalarKernels {
+        /**
+         * @brief the cross product of each pair of vectors. The output may be either input
+         */
+        static void cross(const float* ax, const float* ay, const float* az, const float* bx, const float* by,
+                          const float* bz, float* ox, float* oy, float* oz, std::size_t count) {
+            for (std::size_t i = 0; i < count; i++) {
+                // the inputs are read before any output is written, so the output can alias them
+                const float x = ay[i] * bz[i] - az[i] * by[i];
+                const float y = az[i] * bx[i] - ax[i] * bz[i];
+                const float z = ax[i] * by[i] - ay[i] * bx[i];
+                ox[i] = x;
+                oy[i] = y;
+                oz[i] = z;
+            }
+        }
+
+        /**
+         * @brief the dot product of each pair of vectors
+         */
+        static void dot(const float* __restrict ax, const float* __restrict ay, const float* __restrict az,
+                        const float* __restrict bx, const float* __restrict by, const float* __restrict bz,
+                        float* __restrict out, std::size_t count) {
+            for (std::size_t i = 0; i < count; i++) out[i] = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i];
+        }
+
+        /**
+         * @brief the magnitude of each vector
+         */
+        static void magnitudes(const float* __restrict x, const float* __restrict y, const float* __restrict z,
+                               float* __restrict out, std::size_t count) {
+            for (std::size_t i = 0; i < count; i++) out[i] = std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+        }
+
+        /**
+         * @brief scale each vector to a magnitude of 1. A vector of 0 becomes NaN, like with Vector3D::normalize
+         */
+        static void normalize(float* __restrict x, float* __restrict y, float* __restrict z, std::size_t count) {
+            for (std::size_t i = 0; i < count; i++) {
+                const float scale = 1 / std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+                x[i] *= scale;
+                y[i] *= scale;
+                z[i] *= scale;
+            }
+        }
+
+        /**
+         * @brief rotate each vector by a unit quaternion, like Quaternion::rotate
+         */
+        static void rotate(float* __restrict x, float* __restrict y, float* __restrict z, std::size_t count,
+                           const Quaternion& q) {
+            // the vector part is doubled once, so t = 2 (q x v) doesn't need a multiplication per vector
+            const float w = q.w, qx = q.x, qy = q.y, qz = q.z;
+            const float dx = 2 * qx, dy = 2 * qy, dz = 2 * qz;
+            for (std::size_t i = 0; i < count; i++) {
+                const float tx = dy * z[i] - dz * y[i];
+                const float ty = dz * x[i] - dx * z[i];
+                const float tz = dx * y[i] - dy * x[i];
+                const float nx = x[i] + w * tx + qy * tz - qz * ty;
+                const float ny = y[i] + w * ty + qz * tx - qx * tz;
+                z[i] = z[i] + w * tz + qx * ty - qy * tx;
+                x[i] = nx;
+                y[i] = ny;
+            }
+        }
+};
+
+/**
+ * @brief Kernels on 3D vectors stored as separate arrays of float components
+ *
+ * GCC doesn't vectorize float loops for NEON on 32 bit ARM on its own, as NEON flushes denormals to 0, which breaks
+ * IEEE 754. That doesn't matter for sensor data and geometry, so on the brain the kernels use NEON intrinsics to
+ * process 4 vectors at a time, and finish the last few vectors with Vector3DScalarKernels. Everywhere else the scalar
+ * kernels handle every vector. `make bench` checks both against each other on the brain, and sim/tests/vector3d_neon
+ * runs the NEON loops on the host through a model of the intrinsics.
+ */
+struct Vector3DKernels {
+        /**
+         * @brief the cross product of each pair of vectors. The output may be either input
+         */
+        static void cross(const float* ax, const float* ay, const float* az, const float* bx, const float* by,
+                          const float* bz, float* ox, float* oy, float* oz, std::size_t count) {
+            std::size_t i = 0;
+#ifdef __ARM_NEON
+            for (; i + 4 <= count; i += 4) {
+                const float32x4_t vax = vld1q_f32(ax + i), vay = vld1q_f32(ay + i), vaz = vld1q_f32(az + i);
+                const float32x4_t vbx = vld1q_f32(bx + i), vby = vld1q_f32(by + i), vbz = vld1q_f32(bz + i);
+                vst1q_f32(ox + i, vmlsq_f32(vmulq_f32(vay, vbz), vaz, vby));
+                vst1q_f32(oy + i, vmlsq_f32(vmulq_f32(vaz, vbx), vax, vbz));
+                vst1q_f32(oz + i, vmlsq_f32(vmulq_f32(vax, vby), vay, vbx));
+            }
+#endif
+            Vector3DScalarKernels::cross(ax + i, ay + i, az + i, bx + i, by + i, bz + i, ox + i, oy + i, oz + i,
+                                         count - i);
+        }
+
+        /**
+         * @brief the dot product of each pair of vectors
+         */
+        static void dot(const float* __restrict ax, const float* __restrict ay, const float* __restrict az,
+                        const float* __restrict bx, const float* __restrict by, const float* __restrict bz,
+                        float* __restrict out, std::size_t count) {
+            std::size_t i = 0;
+#ifdef __ARM_NEON
+            for (; i + 4 <= count; i += 4) {
+                float32x4_t sum = vmulq_f32(vld1q_f32(ax + i), vld1q_f32(bx + i));
+                sum = vmlaq_f32(sum, vld1q_f32(ay + i), vld1q_f32(by + i));
+                vst1q_f32(out + i, vmlaq_f32(sum, vld1q_f32(az + i), vld1q_f32(bz + i)));
+            }
+#endif
+            Vector3DScalarKernels::dot(ax + i, ay + i, az + i, bx + i, by + i, bz + i, out + i, count - i);
+        }
+
+        /**
+         * @brief the magnitude of each vector
+         */
+        static void magnitudes(const float* __restrict x, const float* __restrict y, const float* __restrict z,
+                               float* __restrict out, std::size_t count) {
+            std::size_t i = 0;
+#ifdef __ARM_NEON
+            // NEON has no square root, so it is the squared magnitude times its reciprocal square root. A magnitude of
+            // 0 would be 0 times infinity, so it is kept as 0 instead
+            for (; i + 4 <= count; i += 4) {
+                const float32x4_t vx = vld1q_f32(x + i), vy = vld1q_f32(y + i), vz = vld1q_f32(z + i);
+                const float32x4_t squared = vmlaq_f32(vmlaq_f32(vmulq_f32(vx, vx), vy, vy), vz, vz);
+                const float32x4_t root = vmulq_f32(squared, reciprocalSqrt(squared));
+                const uint32x4_t zero = vceqq_f32(squared, vdupq_n_f32(0));
+                vst1q_f32(out + i, vbslq_f32(zero, squared, root));
+            }
+#endif
+            Vector3DScalarKernels::magnitudes(x + i, y + i, z + i, out + i, count - i);
+        }
+
+        /**
+         * @brief scale each vector to a magnitude of 1. A vector of 0 becomes NaN, like with Vector3D::normalize
+         */
+        static void normalize(float* __restrict x, float* __restrict y, float* __restrict z, std::size_t count) {
+            std::size_t i = 0;
+#ifdef __ARM_NEON
+            for (; i + 4 <= count; i += 4) {
+                const float32x4_t vx = vld1q_f32(x + i), vy = vld1q_f32(y + i), vz = vld1q_f32(z + i);
+                const float32x4_t squared = vmlaq_f32(vmlaq_f32(vmulq_f32(vx, vx), vy, vy), vz, vz);
+                const float32x4_t scale = reciprocalSqrt(squared);
+                vst1q_f32(x + i, vmulq_f32(vx, scale));
+                vst1q_f32(y + i, vmulq_f32(vy, scale));
+                vst1q_f32(z + i, vmulq_f32(vz, scale));
+            }
+#endif
+            Vector3DScalarKernels::normalize(x + i, y + i, z + i, count - i);
+        }
+
+        /**
+         * @brief rotate each vector by a unit quaternion, like Quaternion::rotate
+         */
+        static void rotate(float* __restrict x, float* __restrict y, float* __restrict z, std::size_t count,
+                           const Quaternion& q) {
+            std::size_t i = 0;
+#ifdef __ARM_NEON
+            // the same constants as the scalar kernel, so both round the same way
+            const float w = q.w, qx = q.x, qy = q.y, qz = q.z;
+            const float32x4_t vw = vdupq_n_f32(w), vqx = vdupq_n_f32(qx), vqy = vdupq_n_f32(qy), vqz = vdupq_n_f32(qz);
+            const float32x4_t vdx = vdupq_n_f32(2 * qx), vdy = vdupq_n_f32(2 * qy), vdz = vdupq_n_f32(2 * qz);
+            for (; i + 4 <= count; i += 4) {
+                const float32x4_t vx = vld1q_f32(x + i), vy = vld1q_f32(y + i), vz = vld1q_f32(z + i);
+                const float32x4_t tx = vmlsq_f32(vmulq_f32(vdy, vz), vdz, vy);
+                const float32x4_t ty = vmlsq_f32(vmulq_f32(vdz, vx), vdx, vz);
+                const float32x4_t tz = vmlsq_f32(vmulq_f32(vdx, vy), vdy, vx);
+                // v + w t + q x t
+                vst1q_f32(x + i, vmlsq_f32(vmlaq_f32(vmlaq_f32(vx, vw, tx), vqy, tz), vqz, ty));
+                vst1q_f32(y + i, vmlsq_f32(vmlaq_f32(vmlaq_f32(vy, vw, ty), vqz, tx), vqx, tz));
+                vst1q_f32(z + i, vmlsq_f32(vmlaq_f32(vmlaq_f32(vz, vw, tz), vqx, ty), vqy, tx));
+            }
+#endif
+            Vector3DScalarKernels::rotate(x + i, y + i, z + i, count - i, q);
+        }
+#ifdef __ARM_NEON
+    private:
+        /**
+         * @brief the reciprocal square root of 4 floats, from the estimate NEON gives and 2 Newton steps, which is
+         * accurate to about 1e-7
+         */
+        static float32x4_t reciprocalSqrt(float32x4_t value) {
+            float32x4_t estimate = vrsqrteq_f32(value);
+            estimate = vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(value, estimate), estimate));
+            return vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(value, estimate), estimate));
+        }
+#endif
+};
+} // namespace detail
+
+/**
+ * @class Vector3DArray
+ *
+ * @brief an array of 3D vectors, stored as separate arrays of float x, y and z components
+ *
+ * Like Vector2DArray, storing the components in separate arrays lets batch operations process every vector in a tight
+ * loop. The components are stored as floats in their base unit, as the Cortex-A9 in the V5 brain can only vectorize
+ * floats, 4 at a time. That is about 7 significant digits, which is plenty for IMU samples and field geometry, but
+ * not for a position integrated over a whole match. Every function still takes and returns double quantities, so the
+ * unit checking of Vector3D is kept.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * // rotate a window of accelerometer samples into the axes of the field, and find the acceleration along the field
+ * units::Vector3DArray<LinearAcceleration> window(samples);
+ * window.rotate(orientation);
+ * std::array<LinearAcceleration, 64> alongField;
+ * window.dot(units::Vector3D<Number>(1, 0, 0), std::span<LinearAcceleration>(alongField));
+ * @endcode
+ *
+ * @tparam T the type of quantity to use for the vector components
+ */
+template <isQuantity T> class Vector3DArray {
+    public:
+        /**
+         * @brief Construct a new empty Vector3DArray object
+         */
+        Vector3DArray() = default;
+
+        /**
+         * @brief Construct a new Vector3DArray object
+         *
+         * This constructor initializes every vector to 0
+         *
+         * @param size the number of vectors
+         */
+        explicit Vector3DArray(std::size_t size)
+            : m_x(size),
+              m_y(size),
+              m_z(size) {}
+
+        /**
+         * @brief Construct a new Vector3DArray object from a list of vectors
+         *
+         * @param vectors the vectors
+         */
+        Vector3DArray(std::initializer_list<Vector3D<T>> vectors) {
+            reserve(vectors.size());
+            for (const Vector3D<T>& vector : vectors) push_back(vector);
+        }
+
+        /**
+         * @brief Construct a new Vector3DArray object from a span of vectors
+         *
+         * @param vectors the vectors
+         */
+        explicit Vector3DArray(std::span<const Vector3D<T>> vectors) {
+            reserve(vectors.size());
+            for (const Vector3D<T>& vector : vectors) push_back(vector);
+        }
+
+        /**
+         * @brief get the number of vectors in the array
+         *
+         * @return std::size_t
+         */
+        std::size_t size() const { return m_x.size(); }
+
+        /**
+         * @brief check whether the array is empty
+         *
+         * @return true the array has no vectors
+         * @return false the array has at least one vector
+         */
+        bool empty() const { return m_x.empty(); }
+
+        /**
+         * @brief reserve space for vectors, so adding them doesn't allocate memory
+         *
+         * @param capacity the number of vectors to reserve space for
+         */
+        void reserve(std::size_t capacity) {
+            m_x.reserve(capacity);
+            m_y.reserve(capacity);
+            m_z.reserve(capacity);
+        }
+
+        /**
+         * @brief change the number of vectors in the array. New vectors are initialized to 0
+         *
+         * @param size the new number of vectors
+         */
+        void resize(std::size_t size) {
+            m_x.resize(size);
+            m_y.resize(size);
+            m_z.resize(size);
+        }
+
+        /**
+         * @brief remove every vector from the array
+         */
+        void clear() {
+            m_x.clear();
+            m_y.clear();
+            m_z.clear();
+        }
+
+        /**
+         * @brief add a vector to the end of the array
+         *
+         * @param vector the vector to add, which is rounded to float
+         */
+        void push_back(const Vector3D<T>& vector) {
+            m_x.push_back(vector.x.internal());
+            m_y.push_back(vector.y.internal());
+            m_z.push_back(vector.z.internal());
+        }
+
+        /**
+         * @brief get a vector in the array
+         *
+         * @param index the index of the vector
+         * @return Vector3D<T> a copy of the vector
+         */
+        Vector3D<T> operator[](std::size_t index) const {
+            return Vector3D<T>(T(m_x[index]), T(m_y[index]), T(m_z[index]));
+        }
+
+        /**
+         * @brief set a vector in the array
+         *
+         * @param index the index of the vector
+         * @param vector the new value of the vector, which is rounded to float
+         */
+        void set(std::size_t index, const Vector3D<T>& vector) {
+            m_x[index] = vector.x.internal();
+            m_y[index] = vector.y.internal();
+            m_z[index] = vector.z.internal();
+        }
+
+        /**
+         * @brief get the x components, in the base unit of T
+         *
+         * This is meant for code that needs to process the components in ways the batch operations don't cover
+         *
+         * @return float* the x components
+         */
+        float* xData() { return m_x.data(); }
+
+        const float* xData() const { return m_x.data(); }
+
+        /**
+         * @brief get the y components, in the base unit of T
+         *
+         * @return float* the y components
+         */
+        float* yData() { return m_y.data(); }
+
+        const float* yData() const { return m_y.data(); }
+
+        /**
+         * @brief get the z components, in the base unit of T
+         *
+         * @return float* the z components
+         */
+        float* zData() { return m_z.data(); }
+
+        const float* zData() const { return m_z.data(); }
+
+        /**
+         * @brief find the dot product of each vector in the array and the vector at the same index of another array
+         *
+         * @tparam Q the type of quantity to use for the other array
+         * @tparam R the type of quantity to use for the result
+         * @param other the other array
+         * @param out where to write the dot products. Only as many as fit, and as both arrays have, are written
+         * @return std::size_t the number of dot products written
+         */
+        template <isQuantity Q, isQuantity R = Multiplied<T, Q>>
+        std::size_t dot(const Vector3DArray<Q>& other, std::span<R> out) const {
+            const std::size_t count = std::min({size(), other.size(), out.size()});
+            return convertInChunks(count, out, [&](std::size_t start, std::size_t length, float* chunk) {
+                detail::Vector3DKernels::dot(m_x.data() + start, m_y.data() + start, m_z.data() + start,
+                                             other.xData() + start, other.yData() + start, other.zData() + start,
+                                             chunk, length);
+            });
+        }
+
+        /**
+         * @brief find the dot product of every vector in the array and another vector
+         *
+         * @tparam Q the type of quantity to use for the other vector
+         * @tparam R the type of quantity to use for the result
+         * @param other the vector to calculate the dot products with
+         * @param out where to write the dot products. Only as many dot products as fit are written
+         * @return std::size_t the number of dot products written
+         */
+        template <isQuantity Q, isQuantity R = Multiplied<T, Q>>
+        std::size_t dot(const Vector3D<Q>& other, std::span<R> out) const {
+            const std::size_t count = std::min(size(), out.size());
+            const float ox = other.x.internal(), oy = other.y.internal(), oz = other.z.internal();
+            const float* __restrict x = m_x.data();
+            const float* __restrict y = m_y.data();
+            const float* __restrict z = m_z.data();
+            for (std::size_t i = 0; i < count; i++) out[i] = R(x[i] * ox + y[i] * oy + z[i] * oz);
+            return count;
+        }
+
+        /**
+         * @brief find the cross product of each vector in the array and the vector at the same index of another array
+         *
+         * @tparam Q the type of quantity to use for the other array
+         * @tparam R the type of quantity to use for the result
+         * @param other the other array
+         * @param out where to write the cross products. It is resized to the smaller size of the two arrays, and can
+         * be this array when R is T
+         */
+        template <isQuantity Q, isQuantity R = Multiplied<T, Q>>
+        void cross(const Vector3DArray<Q>& other, Vector3DArray<R>& out) const {
+            const std::size_t count = std::min(size(), other.size());
+            // the inputs are read before the output is resized, as it can be this array
+            out.resize(std::max(count, out.size()));
+            detail::Vector3DKernels::cross(m_x.data(), m_y.data(), m_z.data(), other.xData(), other.yData(),
+                                           other.zData(), out.xData(), out.yData(), out.zData(), count);
+            out.resize(count);
+        }
+
+        /**
+         * @brief find the magnitude of every vector in the array
+         *
+         * @param out where to write the magnitudes. Only as many magnitudes as fit are written
+         * @return std::size_t the number of magnitudes written
+         */
+        std::size_t magnitudes(std::span<T> out) const {
+            const std::size_t count = std::min(size(), out.size());
+            return convertInChunks(count, out, [&](std::size_t start, std::size_t length, float* chunk) {
+                detail::Vector3DKernels::magnitudes(m_x.data() + start, m_y.data() + start, m_z.data() + start,
+                                                    chunk, length);
+            });
+        }
+
+        /**
+         * @brief scale every vector in the array to a magnitude of 1, like Vector3D::normalize
+         *
+         * A vector of 0 has no direction, so its components become NaN
+         */
+        void normalize() { detail::Vector3DKernels::normalize(m_x.data(), m_y.data(), m_z.data(), size()); }
+
+        /**
+         * @brief rotate every vector in the array by a quaternion, like Quaternion::rotate
+         *
+         * @param rotation the rotation, from the axes the vectors are in into the axes they should be in
+         */
+        void rotate(const Quaternion& rotation) {
+            detail::Vector3DKernels::rotate(m_x.data(), m_y.data(), m_z.data(), size(), rotation);
+        }
+
+        /**
+         * @brief multiply every vector in the array by a double
+         *
+         * @param factor the double to multiply the vectors by
+         */
+        void scale(double factor) {
+            const float f = factor;
+            float* __restrict x = m_x.data();
+            float* __restrict y = m_y.data();
+            float* __restrict z = m_z.data();
+            for (std::size_t i = 0; i < size(); i++) {
+                x[i] *= f;
+                y[i] *= f;
+                z[i] *= f;
+            }
+        }
+    private:
+        /**
+         * @brief run a kernel which writes floats a chunk at a time, and convert its output to quantities
+         *
+         * The kernels write floats, so they can be vectorized, and the output holds double quantities. A chunk on the
+         * stack holds the floats in between, so nothing is allocated.
+         *
+         * @param count the number of values
+         * @param out where to write the values
+         * @param kernel called with the start and length of a chunk, and the floats to write it to
+         * @return std::size_t the number of values written
+         */
+        template <isQuantity R, typename F>
+        static std::size_t convertInChunks(std::size_t count, std::span<R> out, F&& kernel) {
+            constexpr std::size_t CHUNK_SIZE = 64;
+            float chunk[CHUNK_SIZE];
+            for (std::size_t start = 0; start < count; start += CHUNK_SIZE) {
+                const std::size_t length = std::min(CHUNK_SIZE, count - start);
+                kernel(start, length, chunk);
+                for (std::size_t i = 0; i < length; i++) out[start + i] = R(chunk[i]);
+            }
+            return count;
+        }
+
+        std::vector<float> m_x;
+        std::vector<float> m_y;
+        std::vector<float> m_z;
+};
+
+// define some common vector array types
+typedef Vector3DArray<Length> V3PositionArray;
+typedef Vector3DArray<LinearVelocity> V3VelocityArray;
+typedef Vector3DArray<LinearAcceleration> V3AccelerationArray;
+} // namespace units
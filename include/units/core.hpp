@@ -0,0 +1,1147 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <ratio>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @file core.hpp
+ * @brief The core of the units library, which every other units header builds on
+ *
+ * This header holds Quantity, the operators and math functions on quantities, and the units most code needs: Number,
+ * Time, Length and the linear kinematics built from them. It does not include <ostream>, so headers which only need
+ * to store or pass quantities stay cheap to compile. The rest of the units are in units/Electrical.hpp and
+ * units/Mechanics.hpp, and printing quantities is in units/io.hpp. units/units.hpp includes all of them.
+ */
+
+// define M_PI if not already defined
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace units {
+/**
+ * @brief The exponent of one base unit in a dimension, like the -2 of s^-2
+ *
+ * Exponents are rationals, so roots of quantities keep their units. They are always stored in lowest terms with a
+ * positive denominator, so two equal exponents always compare equal.
+ */
+struct Exponent {
+        std::intmax_t num = 0;
+        std::intmax_t den = 1;
+
+        constexpr Exponent() = default;
+
+        /**
+         * @brief construct a new Exponent, reduced to lowest terms
+         *
+         * @param num the numerator
+         * @param den the denominator, which must not be 0
+         */
+        constexpr Exponent(std::intmax_t num, std::intmax_t den = 1)
+            : num((den < 0 ? -num : num) / std::gcd(num, den)),
+              den((den < 0 ? -den : den) / std::gcd(num, den)) {}
+
+        constexpr bool operator==(const Exponent& other) const = default;
+
+        constexpr Exponent operator-() const { return Exponent(-num, den); }
+
+        friend constexpr Exponent operator+(Exponent lhs, Exponent rhs) {
+            return Exponent(lhs.num * rhs.den + rhs.num * lhs.den, lhs.den * rhs.den);
+        }
+
+        friend constexpr Exponent operator*(Exponent lhs, Exponent rhs) {
+            return Exponent(lhs.num * rhs.num, lhs.den * rhs.den);
+        }
+
+        friend constexpr Exponent operator/(Exponent lhs, Exponent rhs) {
+            return Exponent(lhs.num * rhs.den, lhs.den * rhs.num);
+        }
+};
+
+namespace detail {
+// not constexpr, so a dimension with an exponent which can't be stored fails to compile, and the error names it
+void dimensionExponentOutOfRange();
+} // namespace detail
+
+/**
+ * @brief The dimension of a quantity, as the exponent of each SI base unit
+ *
+ * Every exponent is stored as a 16-bit multiple of 1/12, so square, cube, 4th and 6th roots keep exact units, and the
+ * exponents are packed four to an integer. The dimension is the template parameter of BasicQuantity, so the name of
+ * every quantity type in symbols and debug info is two numbers, and multiplying or dividing quantities computes the new
+ * dimension with two integer additions, instead of instantiating a std::ratio template for every base unit. Exponents
+ * which can't be packed, like the 1/8 of the 8th root of a length, make the quantity use an ExactDimension instead.
+ * Constructing a Dimension from them fails to compile.
+ */
+struct Dimension {
+        /** the exponents of mass, length, time and current, 16 bits each, from the lowest bits up */
+        std::uint64_t low = 0;
+        /** the exponents of angle, temperature, luminosity and moles, 16 bits each, from the lowest bits up */
+        std::uint64_t high = 0;
+
+        /** the base units, in the order of the constructor */
+        static constexpr std::size_t BASE_UNITS = 8;
+        /** exponents are stored as multiples of 1 / DENOMINATOR */
+        static constexpr std::int64_t DENOMINATOR = 12;
+
+        constexpr Dimension() = default;
+
+        /**
+         * @brief construct a new Dimension from the exponent of each base unit
+         */
+        constexpr Dimension(Exponent mass, Exponent length = {}, Exponent time = {}, Exponent current = {},
+                            Exponent angle = {}, Exponent temperature = {}, Exponent luminosity = {},
+                            Exponent moles = {}) {
+            const std::array<Exponent, BASE_UNITS> exponents {mass,  length,      time,       current,
+                                                              angle, temperature, luminosity, moles};
+            for (std::size_t i = 0; i != BASE_UNITS; i++) setLane(i, scale(exponents[i].num, exponents[i].den));
+        }
+
+        /**
+         * @brief get the exponent of a base unit
+         *
+         * @param i the index of the base unit, in the order of the constructor
+         * @return constexpr Exponent the exponent, in lowest terms
+         */
+        constexpr Exponent operator[](std::size_t i) const { return Exponent(lane(i), DENOMINATOR); }
+
+        // the dimension of the product of two quantities
+        constexpr Dimension operator*(Dimension other) const {
+            return fromWords(addLanes(low, other.low), addLanes(high, other.high));
+        }
+
+        // the dimension of the quotient of two quantities
+        constexpr Dimension operator/(Dimension other) const {
+            return fromWords(addLanes(low, negateLanes(other.low)), addLanes(high, negateLanes(other.high)));
+        }
+
+        /**
+         * @brief check whether exponents can be packed into a Dimension
+         *
+         * @param exponents the exponent of each base unit
+         * @return true every exponent is a multiple of 1/12 which fits in 16 bits
+         */
+        static constexpr bool canPack(const std::array<Exponent, BASE_UNITS>& exponents) {
+            for (const Exponent& exponent : exponents) {
+                const std::intmax_t scaled = exponent.num * DENOMINATOR;
+                if (scaled % exponent.den != 0) return false;
+                if (scaled / exponent.den < INT16_MIN || scaled / exponent.den > INT16_MAX) return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief pack exponents into a Dimension
+         *
+         * @param exponents the exponent of each base unit
+         * @return constexpr Dimension the dimension, or a dimensionless one if the exponents can't be packed
+         */
+        static constexpr Dimension pack(const std::array<Exponent, BASE_UNITS>& exponents) {
+            Dimension result;
+            if (!canPack(exponents)) return result;
+            for (std::size_t i = 0; i != BASE_UNITS; i++) {
+                result.setLane(i, exponents[i].num * DENOMINATOR / exponents[i].den);
+            }
+            return result;
+        }
+
+        constexpr bool operator==(const Dimension& other) const = default;
+    private:
+        // the top bit of every lane
+        static constexpr std::uint64_t TOP_BITS = 0x8000800080008000;
+
+        static constexpr Dimension fromWords(std::uint64_t low, std::uint64_t high) {
+            Dimension result;
+            result.low = low;
+            result.high = high;
+            return result;
+        }
+
+        // add every lane of two words, without carrying from one lane into the next
+        static constexpr std::uint64_t addLanes(std::uint64_t lhs, std::uint64_t rhs) {
+            return ((lhs & ~TOP_BITS) + (rhs & ~TOP_BITS)) ^ ((lhs ^ rhs) & TOP_BITS);
+        }
+
+        // negate every lane of a word
+        static constexpr std::uint64_t negateLanes(std::uint64_t word) { return addLanes(~word, 0x0001000100010001); }
+
+        // an exponent as a multiple of 1 / DENOMINATOR
+        static constexpr std::int64_t scale(std::int64_t num, std::int64_t den) {
+            if ((num * DENOMINATOR) % den != 0) detail::dimensionExponentOutOfRange();
+            return num * DENOMINATOR / den;
+        }
+
+        constexpr std::int16_t lane(std::size_t i) const {
+            return std::int16_t((i < 4 ? low : high) >> (16 * (i % 4)));
+        }
+
+        constexpr void setLane(std::size_t i, std::int64_t value) {
+            if (value < INT16_MIN || value > INT16_MAX) detail::dimensionExponentOutOfRange();
+            std::uint64_t& word = i < 4 ? low : high;
+            const std::size_t shift = 16 * (i % 4);
+            word = (word & ~(std::uint64_t(0xFFFF) << shift)) | (std::uint64_t(std::uint16_t(value)) << shift);
+        }
+};
+
+/**
+ * @brief The dimension of a quantity with exponents which can't be packed into a Dimension
+ *
+ * Each exponent is stored as a rational, so any std::ratio can be an exponent, like it could before dimensions were
+ * packed. A quantity only has an ExactDimension when its exponents can't be packed, so every dimension has exactly one
+ * representation, and quantities of the same dimension are always the same type.
+ */
+struct ExactDimension {
+        std::array<Exponent, Dimension::BASE_UNITS> exponents {};
+
+        /**
+         * @brief get the exponent of a base unit
+         *
+         * @param i the index of the base unit, in the order of the constructor of Dimension
+         * @return constexpr Exponent the exponent, in lowest terms
+         */
+        constexpr Exponent operator[](std::size_t i) const { return exponents[i]; }
+
+        constexpr bool operator==(const ExactDimension& other) const = default;
+};
+
+namespace detail {
+// the exponent of every base unit of a Dimension or an ExactDimension
+template <typename D> constexpr std::array<Exponent, Dimension::BASE_UNITS> exponentsOf(const D& dimension) {
+    std::array<Exponent, Dimension::BASE_UNITS> exponents;
+    for (std::size_t i = 0; i != Dimension::BASE_UNITS; i++) exponents[i] = dimension[i];
+    return exponents;
+}
+
+// the product of two dimensions, or their quotient if sign is -1
+template <typename D1, typename D2> constexpr ExactDimension combine(const D1& lhs, const D2& rhs, std::intmax_t sign) {
+    ExactDimension result {exponentsOf(lhs)};
+    for (std::size_t i = 0; i != Dimension::BASE_UNITS; i++) result.exponents[i] = result[i] + rhs[i] * sign;
+    return result;
+}
+
+// a dimension with every exponent multiplied by a factor, which raises a quantity to a power, or takes a root of it
+template <typename D> constexpr ExactDimension scale(const D& dimension, Exponent factor) {
+    ExactDimension result {exponentsOf(dimension)};
+    for (Exponent& exponent : result.exponents) exponent = exponent * factor;
+    return result;
+}
+
+// a dimension with its length and angle exponents swapped, which converts between linear and angular units
+template <typename D> constexpr ExactDimension swapLengthAndAngle(const D& dimension) {
+    ExactDimension result {exponentsOf(dimension)};
+    std::swap(result.exponents[1], result.exponents[4]);
+    return result;
+}
+} // namespace detail
+} // namespace units
+
+/**
+ * @brief BasicQuantity class
+ *
+ * This class is a template class that represents a quantity with a value and units. It is usually named through a
+ * named unit like Length, or through Quantity, which takes the exponents of the base units as std::ratio types.
+ *
+ * @tparam D the dimension of the quantity, a units::Dimension, or a units::ExactDimension if its exponents can't be
+ * packed
+ */
+template <auto D = units::Dimension {}> class BasicQuantity {
+    protected:
+        double value; /** the value stored in its base unit type */
+    public:
+        static constexpr auto dimension = D; /** the exponents of every base unit */
+
+        typedef std::ratio<D[0].num, D[0].den> mass; /** mass unit type */
+        typedef std::ratio<D[1].num, D[1].den> length; /** length unit type */
+        typedef std::ratio<D[2].num, D[2].den> time; /** time unit type */
+        typedef std::ratio<D[3].num, D[3].den> current; /** current unit type */
+        typedef std::ratio<D[4].num, D[4].den> angle; /** angle unit type */
+        typedef std::ratio<D[5].num, D[5].den> temperature; /** temperature unit type */
+        typedef std::ratio<D[6].num, D[6].den> luminosity; /** luminosity unit type */
+        typedef std::ratio<D[7].num, D[7].den> moles; /** moles unit type */
+
+        using Self = BasicQuantity<D>;
+
+        /**
+         * @brief construct a new Quantity object
+         *
+         * This constructor initializes the value to 0
+         */
+        explicit constexpr BasicQuantity()
+            : value(0) {}
+
+        /**
+         * @brief construct a new Quantity object
+         *
+         * @param value the value to initialize the quantity with
+         */
+        explicit constexpr BasicQuantity(double value)
+            : value(value) {}
+
+        /**
+         * @brief construct a new Quantity object
+         *
+         * The copy constructor is defaulted so quantities are trivially copyable, which lets them be passed in
+         * registers and stored in lock-free buffers
+         *
+         * @param other the quantity to copy
+         */
+        constexpr BasicQuantity(Self const& other) = default;
+
+        /**
+         * @brief get the value of the quantity in its base unit type
+         *
+         * @return constexpr double
+         */
+        constexpr double internal() const { return value; }
+
+        // TODO: document this
+        constexpr double convert(Self quantity) const { return value / quantity.value; }
+
+        /**
+         * @brief set the value of this quantity to its current value plus another quantity
+         *
+         * @param other the quantity to add
+         */
+        constexpr void operator+=(Self other) { value += other.value; }
+
+        /**
+         * @brief set the value of this quantity to its current value minus another quantity
+         *
+         * @param other the quantity to subtract
+         */
+        constexpr void operator-=(Self other) { value -= other.value; }
+
+        /**
+         * @brief set the value of this quantity to its current value times a double
+         *
+         * @param multiple the multiple to multiply by
+         */
+        constexpr void operator*=(double multiple) { value *= multiple; }
+
+        /**
+         * @brief set the value of this quantity to its current value divided by a double
+         *
+         * @param dividend the dividend to divide by
+         */
+        constexpr void operator/=(double dividend) { value /= dividend; }
+
+        /**
+         * @brief set the value of this quantity to a double, only if the quantity is a number
+         *
+         * @param rhs the double to assign
+         */
+        constexpr void operator=(const double& rhs) {
+            static_assert(std::is_same_v<std::remove_cv_t<decltype(D)>, units::Dimension> && D == decltype(D) {},
+                          "Cannot assign a double directly to a non-number unit type");
+            value = rhs;
+        }
+};
+
+namespace units::detail {
+// picks the representation of a dimension, so every dimension names exactly one quantity type
+template <ExactDimension E, bool = Dimension::canPack(exponentsOf(E))> struct Canonical {
+        using type = BasicQuantity<Dimension::pack(exponentsOf(E))>;
+};
+
+template <ExactDimension E> struct Canonical<E, false> {
+        using type = BasicQuantity<E>;
+};
+} // namespace units::detail
+
+/**
+ * @brief The quantity of a dimension, which is packed into a Dimension unless its exponents can't be
+ */
+template <units::ExactDimension E> using QuantityWith = typename units::detail::Canonical<E>::type;
+
+/**
+ * @brief A quantity, from the exponent of each base unit as a std::ratio
+ *
+ * This is how quantities were named before dimensions were packed, like Quantity<std::ratio<0>, std::ratio<1>> for a
+ * length, and it names the same type as the named unit. Quantity<> is a Number. As it is an alias, the ratios can't be
+ * deduced from a quantity, so a template which takes any quantity should take an isQuantity, and read the exponents
+ * from its typedefs, like Q::length.
+ */
+template <typename Mass = std::ratio<0>, typename Length = std::ratio<0>, typename Time = std::ratio<0>,
+          typename Current = std::ratio<0>, typename Angle = std::ratio<0>, typename Temperature = std::ratio<0>,
+          typename Luminosity = std::ratio<0>, typename Moles = std::ratio<0>>
+using Quantity = QuantityWith<units::ExactDimension {{units::Exponent(Mass::num, Mass::den),
+                                                      units::Exponent(Length::num, Length::den),
+                                                      units::Exponent(Time::num, Time::den),
+                                                      units::Exponent(Current::num, Current::den),
+                                                      units::Exponent(Angle::num, Angle::den),
+                                                      units::Exponent(Temperature::num, Temperature::den),
+                                                      units::Exponent(Luminosity::num, Luminosity::den),
+                                                      units::Exponent(Moles::num, Moles::den)}}>;
+
+template <typename Q> struct LookupName {
+        using Named = Q;
+};
+
+template <typename Q> using Named = typename LookupName<Q>::Named;
+
+// quantity checker. Used by the isQuantity concept
+template <auto D> void quantityChecker(BasicQuantity<D>) {}
+
+// isQuantity concept
+template <typename Q>
+concept isQuantity = requires(Q q) { quantityChecker(q); };
+
+// Isomorphic concept - used to ensure unit equivalency
+template <typename Q, typename... Quantities>
+concept Isomorphic = ((std::convertible_to<Q, Quantities> && std::convertible_to<Quantities, Q>) && ...);
+
+// Un(type)safely coerce the a unit into a different unit
+template <isQuantity Q1, isQuantity Q2> constexpr inline Q1 unit_cast(Q2 quantity) { return Q1(quantity.internal()); }
+
+namespace units::detail {
+// the product and quotient of two dimensions. Packed dimensions are combined with the words they are packed in
+template <auto D1, auto D2> struct Product {
+        static constexpr ExactDimension dimension = combine(D1, D2, 1);
+        using type = QuantityWith<dimension>;
+};
+
+template <Dimension D1, Dimension D2> struct Product<D1, D2> {
+        using type = BasicQuantity<D1 * D2>;
+};
+
+template <auto D1, auto D2> struct Quotient {
+        static constexpr ExactDimension dimension = combine(D1, D2, -1);
+        using type = QuantityWith<dimension>;
+};
+
+template <Dimension D1, Dimension D2> struct Quotient<D1, D2> {
+        using type = BasicQuantity<D1 / D2>;
+};
+
+// a dimension raised to the power num / den
+template <auto D, std::intmax_t num, std::intmax_t den> struct Power {
+        static constexpr ExactDimension dimension = scale(D, Exponent(num, den));
+        using type = QuantityWith<dimension>;
+};
+
+// a dimension with its length and angle exponents swapped
+template <auto D> struct Swapped {
+        static constexpr ExactDimension dimension = swapLengthAndAngle(D);
+        using type = QuantityWith<dimension>;
+};
+} // namespace units::detail
+
+template <isQuantity Q1, isQuantity Q2> using Multiplied =
+    Named<typename units::detail::Product<Q1::dimension, Q2::dimension>::type>;
+
+template <isQuantity Q1, isQuantity Q2> using Divided =
+    Named<typename units::detail::Quotient<Q1::dimension, Q2::dimension>::type>;
+
+template <isQuantity Q, typename factor> using Exponentiated =
+    Named<typename units::detail::Power<Q::dimension, factor::num, factor::den>::type>;
+
+template <isQuantity Q, typename quotient> using Rooted =
+    Named<typename units::detail::Power<Q::dimension, quotient::den, quotient::num>::type>;
+
+namespace units {
+namespace detail {
+// a unit suffix built at compile time. 8 dimensions of at most "_mol^-99/99" each always fit
+struct SuffixBuffer {
+        std::array<char, 128> chars {};
+        size_t size = 0;
+
+        constexpr void append(const char* text) {
+            while (*text != '\0') chars[size++] = *text++;
+        }
+
+        constexpr void append(intmax_t number) {
+            if (number < 0) {
+                chars[size++] = '-';
+                number = -number;
+            }
+            std::array<char, 20> digits {};
+            size_t count = 0;
+            do {
+                digits[count++] = '0' + number % 10;
+                number /= 10;
+            } while (number != 0);
+            while (count != 0) chars[size++] = digits[--count];
+        }
+};
+
+// the same suffix unit_printer_helper prints, like "_m_s^-1"
+template <isQuantity Q> constexpr SuffixBuffer makeSuffix() {
+    constexpr std::array<const char*, 8> prefixes {"_kg", "_m", "_s", "_A", "_rad", "_K", "_cd", "_mol"};
+    SuffixBuffer suffix;
+    for (size_t i = 0; i != Dimension::BASE_UNITS; i++) {
+        const Exponent exponent = Q::dimension[i];
+        if (exponent.num == 0) continue;
+        suffix.append(prefixes[i]);
+        if (exponent.num != 1 || exponent.den != 1) {
+            suffix.append("^");
+            suffix.append(exponent.num);
+        }
+        if (exponent.den != 1) {
+            suffix.append("/");
+            suffix.append(exponent.den);
+        }
+    }
+    return suffix;
+}
+
+template <isQuantity Q> inline constexpr SuffixBuffer suffixStorage = makeSuffix<Q>();
+} // namespace detail
+
+/**
+ * @brief The suffix printed after the value of a quantity, like " m"
+ *
+ * Named units are specialized with the name of their unit, and every other quantity gets its SI base units, like
+ * "_m_s^-2", the same as operator<< prints. The suffix is built at compile time, so printing it is a single copy.
+ *
+ * @tparam Q the quantity, after LookupName
+ */
+template <isQuantity Q> struct UnitSuffix {
+        static constexpr std::string_view value {detail::suffixStorage<Q>.chars.data(), detail::suffixStorage<Q>.size};
+};
+} // namespace units
+
+template <isQuantity Q> constexpr Q operator+(Q rhs) { return rhs; }
+
+template <isQuantity Q, isQuantity R> constexpr Q operator+(Q lhs, R rhs)
+    requires Isomorphic<Q, R>
+{
+    return Q(lhs.internal() + rhs.internal());
+}
+
+template <isQuantity Q> constexpr Q operator-(Q rhs) { return Q(-rhs.internal()); }
+
+template <isQuantity Q, isQuantity R> constexpr Q operator-(Q lhs, R rhs)
+    requires Isomorphic<Q, R>
+{
+    return Q(lhs.internal() - rhs.internal());
+}
+
+template <isQuantity Q> constexpr Q operator*(Q quantity, double multiple) { return Q(quantity.internal() * multiple); }
+
+template <isQuantity Q> constexpr Q operator*(double multiple, Q quantity) { return Q(quantity.internal() * multiple); }
+
+template <isQuantity Q> constexpr Q operator/(Q quantity, double divisor) { return Q(quantity.internal() / divisor); }
+
+template <isQuantity Q1, isQuantity Q2, isQuantity Q3 = Multiplied<Q1, Q2>> Q3 constexpr operator*(Q1 lhs, Q2 rhs) {
+    return Q3(lhs.internal() * rhs.internal());
+}
+
+template <isQuantity Q1, isQuantity Q2, isQuantity Q3 = Divided<Q1, Q2>> Q3 constexpr operator/(Q1 lhs, Q2 rhs) {
+    return Q3(lhs.internal() / rhs.internal());
+}
+
+template <isQuantity Q, isQuantity R> constexpr bool operator==(const Q& lhs, const R& rhs)
+    requires Isomorphic<Q, R>
+{
+    return (lhs.internal() == rhs.internal());
+}
+
+template <isQuantity Q, isQuantity R> constexpr bool operator!=(const Q& lhs, const R& rhs)
+    requires Isomorphic<Q, R>
+{
+    return (lhs.internal() != rhs.internal());
+}
+
+template <isQuantity Q, isQuantity R> constexpr bool operator<=(const Q& lhs, const R& rhs)
+    requires Isomorphic<Q, R>
+{
+    return (lhs.internal() <= rhs.internal());
+}
+
+template <isQuantity Q, isQuantity R> constexpr bool operator>=(const Q& lhs, const R& rhs)
+    requires Isomorphic<Q, R>
+{
+    return (lhs.internal() >= rhs.internal());
+}
+
+template <isQuantity Q, isQuantity R> constexpr bool operator<(const Q& lhs, const R& rhs)
+    requires Isomorphic<Q, R>
+{
+    return (lhs.internal() < rhs.internal());
+}
+
+template <isQuantity Q, isQuantity R> constexpr bool operator>(const Q& lhs, const R& rhs)
+    requires Isomorphic<Q, R>
+{
+    return (lhs.internal() > rhs.internal());
+}
+
+#define NEW_UNIT(Name, suffix, m, l, t, i, a, o, j, n)                                                                 \
+    class Name : public BasicQuantity<units::Dimension {m, l, t, i, a, o, j, n}> {                                     \
+        public:                                                                                                        \
+            explicit constexpr Name(double value)                                                                      \
+                : BasicQuantity<units::Dimension {m, l, t, i, a, o, j, n}>(value) {}                                   \
+            constexpr Name(BasicQuantity<units::Dimension {m, l, t, i, a, o, j, n}> value)                             \
+                : BasicQuantity<units::Dimension {m, l, t, i, a, o, j, n}>(value) {};                                  \
+    };                                                                                                                 \
+    template <> struct LookupName<BasicQuantity<units::Dimension {m, l, t, i, a, o, j, n}>> {                          \
+            using Named = Name;                                                                                        \
+    };                                                                                                                 \
+    [[maybe_unused]] constexpr Name suffix = Name(1.0);                                                                \
+    constexpr Name operator""_##suffix(long double value) {                                                            \
+        return Name(BasicQuantity<units::Dimension {m, l, t, i, a, o, j, n}>(static_cast<double>(value)));             \
+    }                                                                                                                  \
+    constexpr Name operator""_##suffix(unsigned long long value) {                                                     \
+        return Name(BasicQuantity<units::Dimension {m, l, t, i, a, o, j, n}>(static_cast<double>(value)));             \
+    }                                                                                                                  \
+    namespace units {                                                                                                  \
+    template <> struct UnitSuffix<Name> {                                                                              \
+            static constexpr std::string_view value = " " #suffix;                                                     \
+    };                                                                                                                 \
+    }                                                                                                                  \
+    constexpr inline Name from_##suffix(double value) { return Name(value); }                                          \
+    constexpr inline Name from_##suffix(Number value) { return Name(value.internal()); }                               \
+    constexpr inline double to_##suffix(Name quantity) { return quantity.internal(); }
+
+#define NEW_UNIT_LITERAL(Name, suffix, multiple)                                                                       \
+    [[maybe_unused]] constexpr Name suffix = multiple;                                                                 \
+    constexpr Name operator""_##suffix(long double value) { return static_cast<double>(value) * multiple; }            \
+    constexpr Name operator""_##suffix(unsigned long long value) { return static_cast<double>(value) * multiple; }     \
+    constexpr inline Name from_##suffix(Number value) { return value.internal() * multiple; }                          \
+    constexpr inline double to_##suffix(Name quantity) { return quantity.convert(multiple); }
+
+#define NEW_METRIC_PREFIXES(Name, base)                                                                                \
+    NEW_UNIT_LITERAL(Name, T##base, base * 1E12)                                                                       \
+    NEW_UNIT_LITERAL(Name, G##base, base * 1E9)                                                                        \
+    NEW_UNIT_LITERAL(Name, M##base, base * 1E6)                                                                        \
+    NEW_UNIT_LITERAL(Name, k##base, base * 1E3)                                                                        \
+    NEW_UNIT_LITERAL(Name, c##base, base / 1E2)                                                                        \
+    NEW_UNIT_LITERAL(Name, m##base, base / 1E3)                                                                        \
+    NEW_UNIT_LITERAL(Name, u##base, base / 1E6)                                                                        \
+    NEW_UNIT_LITERAL(Name, n##base, base / 1E9)
+
+/* Number is a special type, because it can be implicitly converted to and from any arithmetic type */
+class Number : public BasicQuantity<> {
+    public:
+        template <typename T> constexpr Number(T value)
+            : BasicQuantity<>(double(value)) {}
+
+        template <typename T> constexpr explicit operator T() { return T(value); }
+
+        constexpr Number(BasicQuantity<> value)
+            : BasicQuantity<>(value) {};
+};
+
+template <> struct LookupName<BasicQuantity<>> {
+        using Named = Number;
+};
+
+[[maybe_unused]] constexpr Number num = Number(1.0);
+
+constexpr Number operator""_num(long double value) {
+    return Number(BasicQuantity<>(static_cast<double>(value)));
+}
+
+constexpr Number operator""_num(unsigned long long value) {
+    return Number(BasicQuantity<>(static_cast<double>(value)));
+}
+
+namespace units {
+// numbers are printed without a suffix
+template <> struct UnitSuffix<Number> {
+        static constexpr std::string_view value = "";
+};
+} // namespace units
+
+constexpr inline Number from_num(double value) { return Number(value); }
+
+constexpr inline double to_num(Number quantity) { return quantity.internal(); }
+
+#define NEW_NUM_TO_DOUBLE_COMPARISON(op)                                                                               \
+    constexpr bool operator op(Number lhs, double rhs) { return (lhs.internal() op rhs); }                             \
+    constexpr bool operator op(double lhs, Number rhs) { return (lhs op rhs.internal()); }
+
+NEW_NUM_TO_DOUBLE_COMPARISON(==)
+NEW_NUM_TO_DOUBLE_COMPARISON(!=)
+NEW_NUM_TO_DOUBLE_COMPARISON(<=)
+NEW_NUM_TO_DOUBLE_COMPARISON(>=)
+NEW_NUM_TO_DOUBLE_COMPARISON(<)
+NEW_NUM_TO_DOUBLE_COMPARISON(>)
+
+#define NEW_NUM_AND_DOUBLE_OPERATION(op)                                                                               \
+    constexpr Number operator op(Number lhs, double rhs) { return (lhs.internal() op rhs); }                           \
+    constexpr Number operator op(double lhs, Number rhs) { return (lhs op rhs.internal()); }
+
+NEW_NUM_AND_DOUBLE_OPERATION(+)
+NEW_NUM_AND_DOUBLE_OPERATION(-)
+NEW_NUM_AND_DOUBLE_OPERATION(*)
+NEW_NUM_AND_DOUBLE_OPERATION(/)
+
+#define NEW_NUM_AND_DOUBLE_ASSIGNMENT(op)                                                                              \
+    constexpr void operator op##=(Number& lhs, double rhs) { lhs = lhs.internal() op rhs; }                            \
+    constexpr void operator op##=(double& lhs, Number rhs) { lhs = lhs op rhs.internal(); }
+
+NEW_NUM_AND_DOUBLE_ASSIGNMENT(+)
+NEW_NUM_AND_DOUBLE_ASSIGNMENT(-)
+NEW_NUM_AND_DOUBLE_ASSIGNMENT(*)
+NEW_NUM_AND_DOUBLE_ASSIGNMENT(/)
+
+constexpr Number& operator++(Number& lhs, int) {
+    lhs += 1;
+    return lhs;
+}
+
+constexpr Number operator++(Number& lhs) {
+    Number copy = lhs;
+    lhs += 1;
+    return copy;
+}
+
+constexpr Number& operator--(Number& lhs, int) {
+    lhs -= 1;
+    return lhs;
+}
+
+constexpr Number operator--(Number& lhs) {
+    Number copy = lhs;
+    lhs -= 1;
+    return copy;
+}
+
+NEW_UNIT_LITERAL(Number, percent, num / 100)
+
+NEW_UNIT(Time, sec, 0, 0, 1, 0, 0, 0, 0, 0)
+NEW_METRIC_PREFIXES(Time, sec)
+NEW_UNIT_LITERAL(Time, min, sec * 60)
+NEW_UNIT_LITERAL(Time, hr, min * 60)
+NEW_UNIT_LITERAL(Time, day, hr * 24)
+
+NEW_UNIT(Length, m, 0, 1, 0, 0, 0, 0, 0, 0)
+NEW_METRIC_PREFIXES(Length, m)
+NEW_UNIT_LITERAL(Length, in, cm * 2.54)
+NEW_UNIT_LITERAL(Length, ft, in * 12)
+NEW_UNIT_LITERAL(Length, yd, ft * 3)
+NEW_UNIT_LITERAL(Length, mi, ft * 5280)
+NEW_UNIT_LITERAL(Length, tile, 600 * mm)
+
+NEW_UNIT(Area, m2, 0, 2, 0, 0, 0, 0, 0, 0)
+NEW_UNIT_LITERAL(Area, Tm2, Tm* Tm);
+NEW_UNIT_LITERAL(Area, Gm2, Gm* Gm);
+NEW_UNIT_LITERAL(Area, Mm2, Mm* Mm);
+NEW_UNIT_LITERAL(Area, km2, km* km);
+NEW_UNIT_LITERAL(Area, cm2, cm* cm);
+NEW_UNIT_LITERAL(Area, mm2, mm* mm);
+NEW_UNIT_LITERAL(Area, um2, um* um);
+NEW_UNIT_LITERAL(Area, nm2, nm* nm);
+NEW_UNIT_LITERAL(Area, in2, in* in)
+
+NEW_UNIT(LinearVelocity, mps, 0, 1, -1, 0, 0, 0, 0, 0)
+NEW_METRIC_PREFIXES(LinearVelocity, mps);
+NEW_UNIT_LITERAL(LinearVelocity, mph, m / hr)
+NEW_METRIC_PREFIXES(LinearVelocity, mph)
+NEW_UNIT_LITERAL(LinearVelocity, inps, in / sec)
+NEW_UNIT_LITERAL(LinearVelocity, miph, mi / hr)
+
+NEW_UNIT(LinearAcceleration, mps2, 0, 1, -2, 0, 0, 0, 0, 0)
+NEW_METRIC_PREFIXES(LinearAcceleration, mps2)
+NEW_UNIT_LITERAL(LinearAcceleration, mph2, m / hr / hr)
+NEW_METRIC_PREFIXES(LinearAcceleration, mph2)
+NEW_UNIT_LITERAL(LinearAcceleration, inps2, in / sec / sec)
+NEW_UNIT_LITERAL(LinearAcceleration, miph2, mi / hr / hr)
+
+NEW_UNIT(LinearJerk, mps3, 0, 1, -3, 0, 0, 0, 0, 0)
+NEW_METRIC_PREFIXES(LinearJerk, mps3)
+NEW_UNIT_LITERAL(LinearJerk, mph3, m / (hr * hr * hr))
+NEW_METRIC_PREFIXES(LinearJerk, mph3)
+NEW_UNIT_LITERAL(LinearJerk, inps3, in / (sec * sec * sec))
+NEW_UNIT_LITERAL(LinearJerk, miph3, mi / (hr * hr * hr))
+
+NEW_UNIT(Curvature, radpm, 0, -1, 0, 0, 0, 0, 0, 0);
+
+namespace units {
+/**
+ * @brief Math on raw floating point values which can be evaluated at compile time
+ *
+ * GCC folds std::sqrt and the other std math functions at compile time as an extension, but the standard doesn't
+ * make them constexpr, so other compilers reject them in constant expressions, and GCC doesn't fold them inside
+ * consteval functions with -fno-builtin. Each function here uses a portable implementation during constant
+ * evaluation, and calls the std function at runtime, so runtime code is unchanged, and still compiles to a single
+ * instruction or libm call. Compile time results are correctly rounded, like the sqrt instruction, except atan2, which
+ * is within a few units in the last place. libm doesn't always round cbrt and hypot correctly, so those can differ
+ * from runtime results in the last bit.
+ */
+namespace cmath {
+template <std::floating_point T> constexpr bool signbit(T x) {
+    if (std::is_constant_evaluated()) {
+        if constexpr (sizeof(T) == sizeof(std::uint64_t)) return std::bit_cast<std::uint64_t>(x) >> 63;
+        else return std::bit_cast<std::uint32_t>(x) >> 31;
+    }
+    return std::signbit(x);
+}
+
+template <std::floating_point T> constexpr T copysign(T magnitude, T sign) {
+    if (std::is_constant_evaluated()) {
+        const bool negative = magnitude < 0 || (magnitude == 0 && signbit(magnitude));
+        return negative == signbit(sign) ? magnitude : -magnitude;
+    }
+    return std::copysign(magnitude, sign);
+}
+
+template <std::floating_point T> constexpr T abs(T x) {
+    if (std::is_constant_evaluated()) return copysign(x, T(1));
+    return std::abs(x);
+}
+
+template <std::floating_point T> constexpr T trunc(T x) {
+    if (std::is_constant_evaluated()) {
+        // every value at least this large is already a whole number, and so are infinity and NaN
+        if (!(abs(x) < T(1) / std::numeric_limits<T>::epsilon())) return x;
+        return copysign(T(std::int64_t(x)), x);
+    }
+    return std::trunc(x);
+}
+
+template <std::floating_point T> constexpr T floor(T x) {
+    if (std::is_constant_evaluated()) {
+        const T whole = trunc(x);
+        return whole > x ? whole - 1 : whole;
+    }
+    return std::floor(x);
+}
+
+template <std::floating_point T> constexpr T ceil(T x) {
+    if (std::is_constant_evaluated()) {
+        const T whole = trunc(x);
+        return whole < x ? whole + 1 : whole;
+    }
+    return std::ceil(x);
+}
+
+// rounds halfway cases away from 0, like std::round
+template <std::floating_point T> constexpr T round(T x) {
+    if (std::is_constant_evaluated()) {
+        const T whole = trunc(x);
+        // x - whole is exact, so this never rounds 0.49999999999999994 up like adding 0.5 would
+        return abs(x - whole) >= T(0.5) ? whole + copysign(T(1), x) : whole;
+    }
+    return std::round(x);
+}
+
+namespace detail {
+// the exact product of two values, as the rounded product and its rounding error, without fma. Only used on values
+// close to 1, so splitting them can't overflow
+template <std::floating_point T> constexpr std::pair<T, T> exactProduct(T a, T b) {
+    constexpr T SPLITTER = T(std::uint64_t(1) << ((std::numeric_limits<T>::digits + 1) / 2)) + 1;
+    const auto split = [](T value) {
+        const T scaled = SPLITTER * value;
+        const T high = scaled - (scaled - value);
+        return std::pair<T, T>(high, value - high);
+    };
+    const auto [aHigh, aLow] = split(a);
+    const auto [bHigh, bLow] = split(b);
+    const T product = a * b;
+    return {product, ((aHigh * bHigh - product) + aHigh * bLow + aLow * bHigh) + aLow * bLow};
+}
+} // namespace detail
+
+template <std::floating_point T> constexpr T sqrt(T x) {
+    if (std::is_constant_evaluated()) {
+        if (x < 0) return std::numeric_limits<T>::quiet_NaN();
+        if (x == 0 || !(x < std::numeric_limits<T>::infinity())) return x;
+        // scale x into [1, 4) by powers of 4, which is exact, so Newton's method starts close to the root
+        T scale = 1;
+        while (x >= 4) x /= 4, scale *= 2;
+        while (x < 1) x *= 4, scale /= 2;
+        T root = 1.5;
+        for (int i = 0; i != 5; i++) root = (root + x / root) / 2;
+        // a last step with the exact square rounds the root correctly, like the hardware instruction
+        const auto [square, error] = detail::exactProduct(root, root);
+        root += ((x - square) - error) / (2 * root);
+        return root * scale;
+    }
+    return std::sqrt(x);
+}
+
+template <std::floating_point T> constexpr T cbrt(T x) {
+    if (std::is_constant_evaluated()) {
+        if (x == 0 || !(abs(x) < std::numeric_limits<T>::infinity())) return x;
+        if (x < 0) return -cbrt(-x);
+        // scale x into [1, 8) by powers of 8, which is exact, so Newton's method starts close to the root
+        T scale = 1;
+        while (x >= 8) x /= 8, scale *= 2;
+        while (x < 1) x *= 8, scale /= 2;
+        T root = 1.5;
+        for (int i = 0; i != 6; i++) root = (2 * root + x / (root * root)) / 3;
+        // a last step with the exact cube, so the root is rounded like std::cbrt
+        const auto [square, squareError] = detail::exactProduct(root, root);
+        const auto [cube, cubeError] = detail::exactProduct(root, square);
+        root += ((x - cube) - (cubeError + root * squareError)) / (3 * square);
+        return root * scale;
+    }
+    return std::cbrt(x);
+}
+
+template <std::floating_point T> constexpr T hypot(T x, T y) {
+    if (std::is_constant_evaluated()) {
+        x = abs(x);
+        y = abs(y);
+        if (x == std::numeric_limits<T>::infinity() || y == std::numeric_limits<T>::infinity()) {
+            return std::numeric_limits<T>::infinity();
+        }
+        if (x < y) std::swap(x, y);
+        if (x == 0 || x != x || y != y) return x + y;
+        // scale both sides by the same power of 2, which is exact, so the larger one is in [1, 2) and the squares can't
+        // overflow
+        T scale = 1;
+        while (x >= 2) x /= 2, y /= 2, scale *= 2;
+        while (x < 1) x *= 2, y *= 2, scale /= 2;
+        // the sum of the squares is kept with its rounding error, so the root can be rounded correctly
+        const auto [xSquare, xError] = detail::exactProduct(x, x);
+        const auto [ySquare, yError] = detail::exactProduct(y, y);
+        const T sum = xSquare + ySquare;
+        const T sumError = ((xSquare - sum) + ySquare) + xError + yError;
+        T root = sqrt(sum);
+        const auto [square, error] = detail::exactProduct(root, root);
+        root += ((sum - square) - error + sumError) / (2 * root);
+        return root * scale;
+    }
+    return std::hypot(x, y);
+}
+
+template <std::floating_point T> constexpr T atan2(T y, T x) {
+    if (std::is_constant_evaluated()) {
+        constexpr T PI = T(3.141592653589793238462643383279502884L);
+        constexpr T INF = std::numeric_limits<T>::infinity();
+        if (x != x || y != y) return x + y;
+        const T ax = abs(x);
+        const T ay = abs(y);
+        T angle = 0;
+        if (ax == INF) angle = ay == INF ? PI / 4 : 0;
+        else if (ay == INF) angle = PI / 2;
+        else if (ay != 0) {
+            // the angle of the ratio of the smaller side to the larger one is at most 45 degrees
+            T t = ay <= ax ? ay / ax : ax / ay;
+            // halve the angle twice, with tan(a / 2) = tan(a) / (1 + sec(a)), so the series converges quickly
+            t = t / (1 + sqrt(1 + t * t));
+            t = t / (1 + sqrt(1 + t * t));
+            const T square = t * t;
+            T series = 0;
+            for (int k = 23; k >= 1; k -= 2) series = T(1) / T(k) - square * series;
+            angle = 4 * t * series;
+            if (ay > ax) angle = PI / 2 - angle;
+        }
+        if (signbit(x)) angle = PI - angle;
+        return copysign(angle, y);
+    }
+    return std::atan2(y, x);
+}
+
+// x raised to a whole power, by repeated squaring. The power is a template parameter, so std::pow is always folded into
+// multiplies at runtime
+template <int R, std::floating_point T> constexpr T pow(T x) {
+    if (std::is_constant_evaluated()) {
+        T result = 1;
+        T base = R < 0 ? 1 / x : x;
+        unsigned remaining = R < 0 ? -unsigned(R) : unsigned(R);
+        while (remaining != 0) {
+            if (remaining % 2 == 1) result *= base;
+            remaining /= 2;
+            // the base isn't squared after the last bit, so it can't overflow when the result doesn't
+            if (remaining != 0) base *= base;
+        }
+        return result;
+    }
+    return std::pow(x, R);
+}
+} // namespace cmath
+
+template <isQuantity Q> constexpr Q abs(const Q& lhs) { return Q(cmath::abs(lhs.internal())); }
+
+template <isQuantity Q, isQuantity R> constexpr Q max(const Q& lhs, const R& rhs)
+    requires Isomorphic<Q, R>
+{
+    return (lhs > rhs ? lhs : rhs);
+}
+
+template <isQuantity Q, isQuantity R> constexpr Q min(const Q& lhs, const R& rhs)
+    requires Isomorphic<Q, R>
+{
+    return (lhs < rhs ? lhs : rhs);
+}
+
+template <isQuantity Q> constexpr Number sgn(const Q& lhs) {
+    if (lhs.internal() > 0) return 1;
+    if (lhs.internal() < 0) return -1;
+    return 0;
+}
+
+template <int R, isQuantity Q, isQuantity S = Exponentiated<Q, std::ratio<R>>> constexpr S pow(const Q& lhs) {
+    return S(cmath::pow<R>(lhs.internal()));
+}
+
+template <isQuantity Q, isQuantity S = Exponentiated<Q, std::ratio<2>>> constexpr S square(const Q& lhs) {
+    return pow<2>(lhs);
+}
+
+template <isQuantity Q, isQuantity S = Exponentiated<Q, std::ratio<3>>> constexpr S cube(const Q& lhs) {
+    return pow<3>(lhs);
+}
+
+template <int R, isQuantity Q, isQuantity S = Rooted<Q, std::ratio<R>>> constexpr S root(const Q& lhs) {
+    return S(std::pow(lhs.internal(), 1.0 / R));
+}
+
+// sqrt and cbrt don't use root, as std::pow can't be replaced with a square root instruction
+template <isQuantity Q, isQuantity S = Rooted<Q, std::ratio<2>>> constexpr S sqrt(const Q& lhs) {
+    return S(cmath::sqrt(lhs.internal()));
+}
+
+template <isQuantity Q, isQuantity S = Rooted<Q, std::ratio<3>>> constexpr S cbrt(const Q& lhs) {
+    return S(cmath::cbrt(lhs.internal()));
+}
+
+template <isQuantity Q, isQuantity R> constexpr Q hypot(const Q& lhs, const R& rhs)
+    requires Isomorphic<Q, R>
+{
+    return Q(cmath::hypot(lhs.internal(), rhs.internal()));
+}
+
+template <isQuantity Q, isQuantity R> constexpr Q mod(const Q& lhs, const R& rhs)
+    requires Isomorphic<Q, R>
+{
+    return Q(std::fmod(lhs.internal(), rhs.internal()));
+}
+
+template <isQuantity Q, isQuantity R> constexpr Q remainder(const Q& lhs, const R& rhs) {
+    return Q(std::remainder(lhs.internal(), rhs.internal()));
+}
+
+template <isQuantity Q1, isQuantity Q2> constexpr Q1 copysign(const Q1& lhs, const Q2& rhs) {
+    return Q1(cmath::copysign(lhs.internal(), rhs.internal()));
+}
+
+template <isQuantity Q> constexpr bool signbit(const Q& lhs) { return cmath::signbit(lhs.internal()); }
+
+template <isQuantity Q, isQuantity R, isQuantity S> constexpr Q clamp(const Q& lhs, const R& lo, const S& hi)
+    requires Isomorphic<Q, R, S>
+{
+    return Q(std::clamp(lhs.internal(), lo.internal(), hi.internal()));
+}
+
+template <isQuantity Q, isQuantity R> constexpr Q ceil(const Q& lhs, const R& rhs)
+    requires Isomorphic<Q, R>
+{
+    return Q(cmath::ceil(lhs.internal() / rhs.internal()) * rhs.internal());
+}
+
+template <isQuantity Q, isQuantity R> constexpr Q floor(const Q& lhs, const R& rhs)
+    requires Isomorphic<Q, R>
+{
+    return Q(cmath::floor(lhs.internal() / rhs.internal()) * rhs.internal());
+}
+
+template <isQuantity Q, isQuantity R> constexpr Q trunc(const Q& lhs, const R& rhs)
+    requires Isomorphic<Q, R>
+{
+    return Q(cmath::trunc(lhs.internal() / rhs.internal()) * rhs.internal());
+}
+
+template <isQuantity Q, isQuantity R> constexpr Q round(const Q& lhs, const R& rhs)
+    requires Isomorphic<Q, R>
+{
+    return Q(cmath::round(lhs.internal() / rhs.internal()) * rhs.internal());
+}
+
+/**
+ * @brief A conversion factor from raw numbers, like device readings, to a quantity
+ *
+ * A scale is created from a unit at compile time, and can be combined with other quantities, like a gear ratio, into
+ * a single factor. Converting a raw number then only takes one multiply, instead of a division and a multiply for
+ * every unit and ratio in the expression.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * // the rotation sensor reports centidegrees
+ * constexpr units::Scale CENTIDEGREES(deg / 100);
+ * Angle angle = CENTIDEGREES(rotation_get_position(port));
+ * // a gear ratio known at runtime is combined once, when it changes
+ * const units::Scale<Angle> output = CENTIDEGREES * ratio;
+ * @endcode
+ *
+ * @tparam Q the quantity raw numbers are converted to
+ */
+namespace detail {
+// the factor of a combined scale, which may only be known at runtime
+struct ScaleFactor {
+        double factor;
+};
+} // namespace detail
+
+template <isQuantity Q> class Scale {
+    public:
+        /**
+         * @brief Construct a new Scale object
+         *
+         * @param unit the quantity a raw value of 1 is converted to
+         */
+        consteval explicit Scale(Q unit)
+            : m_factor(unit.internal()) {}
+
+        /**
+         * @brief convert a raw number to a quantity
+         *
+         * @param raw the raw number
+         * @return constexpr Q
+         */
+        constexpr Q operator()(double raw) const { return Q(raw * m_factor); }
+
+        /**
+         * @brief get the factor raw numbers are multiplied by
+         *
+         * @return constexpr double the quantity a raw value of 1 is converted to, in its base unit
+         */
+        constexpr double factor() const { return m_factor; }
+
+        /**
+         * @brief combine the scale with a quantity it is multiplied by
+         *
+         * @param quantity the quantity, like a gear ratio
+         * @return Scale<Multiplied<Q, R>> the combined scale
+         */
+        template <isQuantity R> constexpr Scale<Multiplied<Q, R>> operator*(R quantity) const {
+            return Scale<Multiplied<Q, R>>(detail::ScaleFactor {m_factor * quantity.internal()});
+        }
+
+        /**
+         * @brief combine the scale with a quantity it is divided by
+         *
+         * @param quantity the quantity, like a gear ratio
+         * @return Scale<Divided<Q, R>> the combined scale
+         */
+        template <isQuantity R> constexpr Scale<Divided<Q, R>> operator/(R quantity) const {
+            return Scale<Divided<Q, R>>(detail::ScaleFactor {m_factor / quantity.internal()});
+        }
+    private:
+        template <isQuantity> friend class Scale;
+
+        constexpr explicit Scale(detail::ScaleFactor factor)
+            : m_factor(factor.factor) {}
+
+        double m_factor;
+};
+} // namespace units
+
+// Convert an angular unit `Q` to a linear unit correctly;
+// mostly useful for velocities
+template <isQuantity Q> typename units::detail::Swapped<Q::dimension>::type
+toLinear(BasicQuantity<Q::dimension> angular, Length diameter) {
+    return unit_cast<typename units::detail::Swapped<Q::dimension>::type>(angular * (diameter / 2.0));
+}
+
+// Convert an linear unit `Q` to a angular unit correctly;
+// mostly useful for velocities
+template <isQuantity Q> typename units::detail::Swapped<Q::dimension>::type
+toAngular(BasicQuantity<Q::dimension> linear, Length diameter) {
+    return unit_cast<typename units::detail::Swapped<Q::dimension>::type>(linear / (diameter / 2.0));
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "units/core.hpp"
+#include "units/Angle.hpp"
+#include "units/Temperature.hpp"
+#include <charconv>
+#include <cstring>
+#include <ostream>
+
+/**
+ * @file io.hpp
+ * @brief Printing and formatting quantities
+ *
+ * Every quantity is printed as its value followed by the suffix of its unit, like "1.5 m". Named units print the name
+ * of their unit, and every other quantity prints its SI base units, like "2_m_s^-1". Numbers are printed without a
+ * suffix.
+ */
+
+template <isQuantity Q> inline std::ostream& operator<<(std::ostream& os, const Q& quantity) {
+    os << quantity.internal() << units::UnitSuffix<Named<Q>>::value;
+    return os;
+}
+
+namespace units {
+/**
+ * @brief Format a quantity into a buffer, without going through std::ostream
+ *
+ * The value is written with std::to_chars, with the same precision operator<< uses by default, followed by the suffix
+ * of its unit. Like snprintf, the text is cut short if it doesn't fit, and is always null terminated.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * char buffer[32];
+ * units::format_to(buffer, sizeof(buffer), 1.5_m); // "1.5 m"
+ * pros::lcd::print(0, "%s", buffer);
+ * @endcode
+ *
+ * @param buffer the buffer to write to
+ * @param size the size of the buffer, including space for the null terminator
+ * @param quantity the quantity to format
+ * @param precision the number of significant digits. Defaults to 6
+ * @return size_t the length of the whole text, without the null terminator. If it is not less than size, the text was
+ * cut short
+ */
+template <isQuantity Q> size_t format_to(char* buffer, size_t size, const Q& quantity, int precision = 6) {
+    constexpr std::string_view suffix = UnitSuffix<Named<Q>>::value;
+    // the longest value with 17 significant digits, like "-1.2345678901234567e-308", fits
+    std::array<char, 32> value;
+    const std::to_chars_result result = std::to_chars(value.data(), value.data() + value.size(), quantity.internal(),
+                                                      std::chars_format::general, std::clamp(precision, 1, 17));
+    const size_t valueSize = result.ptr - value.data();
+    const size_t length = valueSize + suffix.size();
+    if (size == 0) return length;
+    const size_t written = std::min(length, size - 1);
+    const size_t valueWritten = std::min(valueSize, written);
+    std::memcpy(buffer, value.data(), valueWritten);
+    std::memcpy(buffer + valueWritten, suffix.data(), written - valueWritten);
+    buffer[written] = '\0';
+    return length;
+}
+} // namespace units
@@ -0,0 +1,78 @@
+// drives a simulated tank drive with odometry, and unplugs one of its motors along the way
+#include "hardware/hardware.hpp"
+#include "pros/rtos.hpp"
+#include "sim/Sim.hpp"
+#include <chrono>
+#include <cstdio>
+
+int main() {
+    constexpr uint8_t LEFT_PORT = 1;
+    constexpr uint8_t RIGHT_PORT = 2;
+    constexpr uint8_t LEFT_ENCODER_PORT = 3;
+    constexpr uint8_t RIGHT_ENCODER_PORT = 4;
+    constexpr uint8_t IMU_PORT = 5;
+    lemlib::sim::addMotor(LEFT_PORT);
+    lemlib::sim::addMotor(RIGHT_PORT);
+    lemlib::sim::addRotationSensor(LEFT_ENCODER_PORT);
+    lemlib::sim::addRotationSensor(RIGHT_ENCODER_PORT);
+    lemlib::sim::addIMU(IMU_PORT);
+    lemlib::sim::linkRotationSensor(LEFT_ENCODER_PORT, LEFT_PORT);
+    lemlib::sim::linkRotationSensor(RIGHT_ENCODER_PORT, RIGHT_PORT);
+
+    const auto wallStart = std::chrono::steady_clock::now();
+
+    lemlib::Motor left(LEFT_PORT, 200_rpm);
+    lemlib::Motor right(RIGHT_PORT, 200_rpm);
+    lemlib::V5RotationSensor leftEncoder(LEFT_ENCODER_PORT);
+    lemlib::V5RotationSensor rightEncoder(RIGHT_ENCODER_PORT);
+    lemlib::V5InertialSensor imu(IMU_PORT);
+    imu.calibrate();
+    while (imu.isCalibrating()) pros::delay(10);
+
+    lemlib::DevicePoller poller(10_msec);
+    poller.addEncoder(leftEncoder);
+    poller.addEncoder(rightEncoder);
+    poller.addIMU(imu);
+    poller.start();
+
+    lemlib::Odometry odom({{leftEncoder, 2.75_in, 5_in}, {rightEncoder, 2.75_in, -5_in}}, {}, imu);
+    odom.start();
+
+    // drive forward for 2 seconds
+    left.move(1);
+    right.move(1);
+    pros::delay(2000);
+    units::Pose pose = odom.getPose();
+    std::printf("after driving forward: x=%.2f in, y=%.2f in, heading=%.2f deg\n", to_in(pose.x), to_in(pose.y),
+                to_cDeg(pose.orientation));
+
+    // turn in place for 1 second
+    lemlib::sim::setIMURate(IMU_PORT, -90_degps);
+    left.move(0.5);
+    right.move(-0.5);
+    pros::delay(1000);
+    lemlib::sim::setIMURate(IMU_PORT, 0_degps);
+    pose = odom.getPose();
+    std::printf("after turning: x=%.2f in, y=%.2f in, heading=%.2f deg\n", to_in(pose.x), to_in(pose.y),
+                to_cDeg(pose.orientation));
+
+    // unplug the left motor, and plug it back in. Ports are only checked once per scan period of the device registry,
+    // so each change is given a period to be seen
+    lemlib::sim::unplug(LEFT_PORT);
+    pros::delay(10);
+    std::printf("left motor connected while unplugged: %d, move returned %d\n", left.isConnected(),
+                int(left.move(1)));
+    lemlib::sim::plug(LEFT_PORT);
+    pros::delay(10);
+    std::printf("left motor connected after being plugged back in: %d\n", left.isConnected());
+
+    left.brake();
+    right.brake();
+    pros::delay(1000);
+    odom.stop();
+    poller.stop();
+
+    const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    const double simSeconds = to_sec(lemlib::sim::getTime());
+    std::printf("simulated %.2f s in %.3f s (%.0fx real time)\n", simSeconds, wallSeconds, simSeconds / wallSeconds);
+}
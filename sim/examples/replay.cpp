@@ -0,0 +1,86 @@
+// records a simulated drive with TelemetryLogger, then replays the log into a second odometry, stepping through it
+// as fast as it can
+#include "hardware/hardware.hpp"
+#include "pros/rtos.hpp"
+#include "sim/Sim.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+int main() {
+    constexpr uint8_t LEFT_PORT = 1;
+    constexpr uint8_t RIGHT_PORT = 2;
+    constexpr uint8_t LEFT_ENCODER_PORT = 3;
+    constexpr uint8_t RIGHT_ENCODER_PORT = 4;
+    constexpr uint8_t IMU_PORT = 5;
+    constexpr const char* LOG_PATH = "build/replay.bin";
+    lemlib::sim::addMotor(LEFT_PORT);
+    lemlib::sim::addMotor(RIGHT_PORT);
+    lemlib::sim::addRotationSensor(LEFT_ENCODER_PORT);
+    lemlib::sim::addRotationSensor(RIGHT_ENCODER_PORT);
+    lemlib::sim::addIMU(IMU_PORT);
+    lemlib::sim::linkRotationSensor(LEFT_ENCODER_PORT, LEFT_PORT);
+    lemlib::sim::linkRotationSensor(RIGHT_ENCODER_PORT, RIGHT_PORT);
+
+    lemlib::Motor left(LEFT_PORT, 200_rpm);
+    lemlib::Motor right(RIGHT_PORT, 200_rpm);
+    lemlib::V5RotationSensor leftEncoder(LEFT_ENCODER_PORT);
+    lemlib::V5RotationSensor rightEncoder(RIGHT_ENCODER_PORT);
+    lemlib::V5InertialSensor imu(IMU_PORT);
+    imu.calibrate();
+    while (imu.isCalibrating()) pros::delay(10);
+
+    // record a drive forward and a turn, updating the odometry at the same time as the devices are logged
+    lemlib::Odometry odom({{leftEncoder, 2.75_in, 5_in}, {rightEncoder, 2.75_in, -5_in}}, {}, imu);
+    lemlib::TelemetryLogger logger;
+    if (logger.start(LOG_PATH) != 0) {
+        std::printf("could not open %s\n", LOG_PATH);
+        return 1;
+    }
+    for (int i = 0; i < 300; i++) {
+        if (i == 0) {
+            left.move(1);
+            right.move(1);
+        } else if (i == 200) {
+            lemlib::sim::setIMURate(IMU_PORT, -90_degps);
+            left.move(0.5);
+            right.move(-0.5);
+        }
+        odom.update();
+        logger.logEncoder(LEFT_ENCODER_PORT, leftEncoder.getAngle());
+        logger.logEncoder(RIGHT_ENCODER_PORT, rightEncoder.getAngle());
+        logger.logIMU(IMU_PORT, imu.getRotation());
+        pros::delay(10);
+    }
+    logger.stop();
+    const units::Pose live = odom.getPose();
+
+    // replay the log, stepping the playback clock once per recorded update
+    lemlib::ReplayLog log;
+    if (log.load(LOG_PATH) != 0) {
+        std::printf("could not load %s\n", LOG_PATH);
+        return 1;
+    }
+    lemlib::ReplayEncoder leftReplay(log, LEFT_ENCODER_PORT);
+    lemlib::ReplayEncoder rightReplay(log, RIGHT_ENCODER_PORT);
+    lemlib::ReplayIMU imuReplay(log, IMU_PORT);
+    lemlib::Odometry replay({{leftReplay, 2.75_in, 5_in}, {rightReplay, 2.75_in, -5_in}}, {}, imuReplay);
+    const auto wallStart = std::chrono::steady_clock::now();
+    for (Time time = 0_sec; time <= log.getDuration(); time += 10_msec) {
+        log.seek(time);
+        replay.update();
+    }
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    const units::Pose replayed = replay.getPose();
+
+    std::printf("live:     x=%.2f in, y=%.2f in, heading=%.2f deg\n", to_in(live.x), to_in(live.y),
+                to_cDeg(live.orientation));
+    std::printf("replayed: x=%.2f in, y=%.2f in, heading=%.2f deg, %zu records in %.4f s\n", to_in(replayed.x),
+                to_in(replayed.y), to_cDeg(replayed.orientation), log.getSize(), wall);
+    // the log stores floats, so the replay only matches to within rounding
+    if (units::abs(live.x - replayed.x) > 0.1_in || units::abs(live.y - replayed.y) > 0.1_in ||
+        units::abs(live.orientation - replayed.orientation) > 0.1_stDeg) {
+        std::printf("the replayed pose does not match the live pose\n");
+        return 1;
+    }
+}
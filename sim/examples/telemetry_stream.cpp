@@ -0,0 +1,58 @@
+// streams a simulated motor through a telemetry stream and decodes it again, dropping a frame along the way
+#include "hardware/hardware.hpp"
+#include "pros/rtos.hpp"
+#include "sim/Sim.hpp"
+#include <cmath>
+#include <cstdio>
+
+int main() {
+    constexpr uint8_t MOTOR_PORT = 1;
+    lemlib::sim::addMotor(MOTOR_PORT);
+    lemlib::Motor motor(MOTOR_PORT, 200_rpm);
+
+    lemlib::TelemetryStream stream(25);
+    const int32_t angle = stream.addChannel("angle", 0.01_stDeg);
+    const int32_t current = stream.addChannel("current", 0.001_amp);
+    const int32_t temperature = stream.addChannel("temperature", 0.1_kelvin);
+    const int32_t pose = stream.addPose("pose");
+    lemlib::TelemetryStreamDecoder decoder;
+
+    std::array<uint8_t, lemlib::TelemetryStream::MAX_FRAME_SIZE> frame;
+    size_t bytes = 0;
+    size_t frames = 0;
+    size_t decoded = 0;
+    Angle sentAngle = 0_stDeg;
+    motor.move(1);
+    for (int i = 0; i < 100; i++) {
+        const lemlib::MotorTelemetry telemetry = motor.getTelemetry();
+        stream.set(angle, telemetry.angle);
+        sentAngle = telemetry.angle;
+        stream.set(current, telemetry.current);
+        stream.set(temperature, telemetry.temperature);
+        stream.setPose(pose, units::Pose(i * 1_cm, 0_m, i * 1_stDeg));
+        int32_t size;
+        while ((size = stream.encode(pros::c::micros(), frame)) != 0) {
+            bytes += size;
+            frames++;
+            // frame 30 is lost, so the deltas after it can not be decoded until the next key frame
+            if (frames == 30) continue;
+            for (int32_t j = 0; j < size; j++) {
+                const int32_t type = decoder.push(frame[j]);
+                if (type == int32_t(lemlib::StreamFrameType::KEY) || type == int32_t(lemlib::StreamFrameType::DELTA)) {
+                    decoded++;
+                }
+            }
+        }
+        pros::delay(10);
+    }
+
+    // values are rounded to their resolution, so they come back within half of it
+    const Angle error = units::abs(from_stRad(decoder.getValue(angle)) - sentAngle);
+    std::printf("sent %zu frames in %zu bytes (%.1f bytes per frame), decoded %zu, %u lost\n", frames, bytes,
+                double(bytes) / frames, decoded, decoder.getErrors());
+    std::printf("last %s: %.2f m\n", decoder.getName(pose), decoder.getValue(pose));
+    if (decoder.getErrors() != 1 || decoder.getValue(pose) < 0.98 || error > 0.005_stDeg) {
+        std::printf("telemetry stream did not decode as expected\n");
+        return 1;
+    }
+}
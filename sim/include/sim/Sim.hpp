@@ -0,0 +1,328 @@
+#pragma once
+
+#include "units/Angle.hpp"
+#include "units/Pose.hpp"
+#include "units/Temperature.hpp"
+#include "units/Vector3D.hpp"
+#include "units/core.hpp"
+#include "units/Electrical.hpp"
+#include "pros/misc.h"
+#include <cstdint>
+
+/**
+ * @brief Host simulator backend
+ *
+ * The simulator implements the parts of the PROS api used by this library on a desktop computer, so the library and
+ * code which depends on it can be profiled, run under sanitizers, and tested faster than real time. Sources are built
+ * with LEMLIB_SIM defined and linked against the simulator instead of the PROS kernel. See sim/Makefile.
+ *
+ * Time is simulated. It only moves forward when the program calls pros::delay (or pros::c::delay and
+ * pros::c::task_delay_until) from its main thread, or when advance is called. Every time the clock moves forward, the
+ * simulated devices are stepped, and PROS tasks whose delay expired are run until they delay again before the clock
+ * moves any further. This makes simulations deterministic, and as fast as the host can run them.
+ *
+ * Devices must be added before they can be used. Any port without a device behaves like an empty port on a V5 brain.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * int main() {
+ *     lemlib::sim::addMotor(1);
+ *     lemlib::Motor motor(1, 200_rpm);
+ *     motor.move(1);
+ *     pros::delay(1000); // simulates 1 second, as fast as possible
+ *     std::cout << to_stRot(motor.getAngle()) << std::endl;
+ * }
+ * @endcode
+ */
+namespace lemlib::sim {
+/**
+ * @brief The type of a simulated motor
+ */
+enum class SimMotorType { V5, EXP };
+
+/**
+ * @brief Remove every device and reset the clock to 0
+ *
+ * This must not be called while PROS tasks are running.
+ */
+void reset();
+
+/**
+ * @brief Get the simulated time since the program started
+ *
+ * @return Time the simulated time
+ */
+Time getTime();
+
+/**
+ * @brief Move the simulated clock forward
+ *
+ * Devices are stepped in increments of at most 1 ms, and PROS tasks are run whenever their delay expires.
+ *
+ * @param duration how far to move the clock forward
+ */
+void advance(Time duration);
+
+/**
+ * @brief Add a simulated motor
+ *
+ * The motor is modeled as a first order system, which reaches its target velocity with a time constant of 50 ms. The
+ * cartridge defaults to the green (200 rpm) cartridge, like a real motor.
+ *
+ * @param port the port of the motor
+ * @param type the type of the motor. Defaults to a V5 (11W) motor
+ */
+void addMotor(uint8_t port, SimMotorType type = SimMotorType::V5);
+
+/**
+ * @brief Add a simulated V5 Rotation Sensor
+ *
+ * The angle of the sensor only changes when it is set with setRotationSensorAngle, or when it is linked to a motor.
+ *
+ * @param port the port of the rotation sensor
+ */
+void addRotationSensor(uint8_t port);
+
+/**
+ * @brief Add a simulated V5 Inertial Sensor
+ *
+ * Calibrating the simulated IMU takes 2 simulated seconds. The rotation only changes when it is set with setIMURate.
+ *
+ * @param port the port of the IMU
+ */
+void addIMU(uint8_t port);
+
+/**
+ * @brief Add a simulated V5 Distance Sensor
+ *
+ * The sensor doesn't see anything until its reading is set with setDistanceSensorReading.
+ *
+ * @param port the port of the distance sensor
+ */
+void addDistanceSensor(uint8_t port);
+
+/**
+ * @brief Add a simulated V5 GPS
+ *
+ * The sensor reports the center of the field, facing the positive y axis, until its reading is set with setGPSReading.
+ *
+ * @param port the port of the GPS
+ */
+void addGPS(uint8_t port);
+
+/**
+ * @brief Add a simulated V5 Optical Sensor
+ *
+ * The sensor sees nothing until its reading is set with setOpticalReading. Like the real sensor, it starts with an
+ * integration time of 100 ms, and only reports what is in front of it at the end of every integration period.
+ *
+ * @param port the port of the optical sensor
+ */
+void addOpticalSensor(uint8_t port);
+
+/**
+ * @brief Add a simulated V5 Radio
+ *
+ * The radio can only link to a radio it is paired with by pairRadios. Like VEXlink, the end initialized as the
+ * transmitter sends 1040 bytes per second, and the receiver 520.
+ *
+ * @param port the port of the radio
+ */
+void addRadio(uint8_t port);
+
+/**
+ * @brief Pair two simulated radios, so they stand in for the radios of two robots
+ *
+ * Bytes transmitted by one radio arrive at the other once both are initialized with link_init.
+ *
+ * @param a the port of one radio
+ * @param b the port of the other radio
+ */
+void pairRadios(uint8_t a, uint8_t b);
+
+/**
+ * @brief Simulate unplugging a device
+ *
+ * The device is still simulated, but it can't be read or controlled until it is plugged back in.
+ *
+ * @param port the port of the device
+ */
+void unplug(uint8_t port);
+
+/**
+ * @brief Simulate plugging a device back in
+ *
+ * Motors lose their brake mode, cartridge, current limit and position when they are plugged back in, and rotation
+ * sensors lose their position, like real devices that lost power.
+ *
+ * @param port the port of the device
+ */
+void plug(uint8_t port);
+
+/**
+ * @brief Get the angle of the cartridge output of a simulated motor, ignoring reversal
+ *
+ * @param port the port of the motor
+ * @return Angle the angle, or INFINITY if there is no motor on the port
+ */
+Angle getMotorAngle(uint8_t port);
+
+/**
+ * @brief Get the velocity of the cartridge output of a simulated motor, ignoring reversal
+ *
+ * @param port the port of the motor
+ * @return AngularVelocity the velocity, or INFINITY if there is no motor on the port
+ */
+AngularVelocity getMotorVelocity(uint8_t port);
+
+/**
+ * @brief Set the temperature reported by a simulated motor
+ *
+ * @param port the port of the motor
+ * @param temperature the temperature
+ */
+void setMotorTemperature(uint8_t port, Temperature temperature);
+
+/**
+ * @brief Set the voltage reported by the simulated battery
+ *
+ * Motors are simulated as if the battery was always full, so only compensation of power commands sees the voltage
+ *
+ * @param voltage the voltage. Defaults to 12.8 volts, the voltage of a full battery
+ */
+void setBatteryVoltage(Voltage voltage);
+
+/**
+ * @brief Set the angle of a simulated rotation sensor, ignoring reversal
+ *
+ * @param port the port of the rotation sensor
+ * @param angle the angle
+ */
+void setRotationSensorAngle(uint8_t port, Angle angle);
+
+/**
+ * @brief Set what a simulated distance sensor measures
+ *
+ * @param port the port of the distance sensor
+ * @param distance the distance to the object in front of the sensor. Distances over 2 meters, including INFINITY, mean
+ * there is no object in range
+ * @param confidence the confidence of the sensor, from 0 to 1. Defaults to 1
+ */
+void setDistanceSensorReading(uint8_t port, Length distance, Number confidence = 1);
+
+/**
+ * @brief Set what a simulated GPS measures
+ *
+ * @param port the port of the GPS
+ * @param pose the pose of the sensor, in standard position, with the origin in the center of the field
+ * @param error the root mean square error the sensor reports
+ */
+void setGPSReading(uint8_t port, units::Pose pose, Length error);
+
+/**
+ * @brief Set what is in front of a simulated optical sensor
+ *
+ * The sensor reports it at the end of its current integration period.
+ *
+ * @param port the port of the optical sensor
+ * @param hue the hue of the object, wrapped to 0 to 360 degrees
+ * @param saturation the saturation of the object, from 0 to 1
+ * @param proximity how close the object is, from 0 (nothing in front) to 1 (touching the sensor)
+ */
+void setOpticalReading(uint8_t port, Angle hue, Number saturation, Number proximity);
+
+/**
+ * @brief Make a simulated rotation sensor follow a simulated motor
+ *
+ * Every time the simulation is stepped, the rotation sensor turns by how much the motor turned, times the ratio.
+ *
+ * @param rotationPort the port of the rotation sensor
+ * @param motorPort the port of the motor
+ * @param ratio how many times the sensor rotates per rotation of the motor cartridge output
+ */
+void linkRotationSensor(uint8_t rotationPort, uint8_t motorPort, Number ratio = 1);
+
+/**
+ * @brief Set how fast the rotation of a simulated IMU changes
+ *
+ * @param port the port of the IMU
+ * @param rate the rate, counterclockwise positive
+ */
+void setIMURate(uint8_t port, AngularVelocity rate);
+
+/**
+ * @brief Set the bias of the gyro of a simulated IMU
+ *
+ * The bias is added to the rate reported by the gyro, but not to the rotation, which is integrated by the IMU itself
+ *
+ * @param port the port of the IMU
+ * @param bias the bias, counterclockwise positive
+ */
+void setIMUGyroBias(uint8_t port, AngularVelocity bias);
+
+/**
+ * @brief Set the acceleration measured by the accelerometer of a simulated IMU
+ *
+ * A flat IMU at rest measures 1 g along its z axis, which is the default
+ *
+ * @param port the port of the IMU
+ * @param acceleration the acceleration, in the axes of the IMU, including gravity
+ */
+void setIMUAcceleration(uint8_t port, units::Vector3D<LinearAcceleration> acceleration);
+
+/**
+ * @brief Set how far a simulated IMU is tilted
+ *
+ * @param port the port of the IMU
+ * @param roll the rotation around the x axis
+ * @param pitch the rotation around the y axis
+ */
+void setIMUTilt(uint8_t port, Angle roll, Angle pitch);
+
+/**
+ * @brief Set the value of a simulated ADI encoder
+ *
+ * @param smartPort the port of the ADI expander, or 22 for the ports on the brain
+ * @param topPort the top port of the encoder, from 1 to 8
+ * @param ticks the value of the encoder, ignoring reversal
+ */
+void setADIEncoder(uint8_t smartPort, uint8_t topPort, int32_t ticks);
+
+/**
+ * @brief Set the value read from a simulated ADI sensor, like a limit switch or a line tracker
+ *
+ * @param smartPort the port of the ADI expander, or 22 for the ports on the brain
+ * @param port the ADI port, from 1 to 8
+ * @param value the value, 0 or 1 for digital sensors, or from 0 to 4095 for analog sensors
+ */
+void setADIValue(uint8_t smartPort, uint8_t port, int32_t value);
+
+/**
+ * @brief Simulate connecting or disconnecting a controller
+ *
+ * The master controller is connected when the simulator starts, and the partner controller isn't. Connecting or
+ * disconnecting a controller centers its sticks and releases its buttons
+ *
+ * @param id the controller
+ * @param connected whether it is connected
+ */
+void setControllerConnected(pros::controller_id_e_t id, bool connected);
+
+/**
+ * @brief Set the position of an axis of a simulated controller
+ *
+ * @param id the controller
+ * @param channel the axis
+ * @param value the position, from -127 to 127
+ */
+void setControllerAnalog(pros::controller_id_e_t id, pros::controller_analog_e_t channel, int32_t value);
+
+/**
+ * @brief Press or release a button of a simulated controller
+ *
+ * @param id the controller
+ * @param button the button
+ * @param pressed whether it is pressed
+ */
+void setControllerDigital(pros::controller_id_e_t id, pros::controller_digital_e_t button, bool pressed);
+} // namespace lemlib::sim
@@ -0,0 +1,725 @@
+// simulated PROS device api. Only the functions used by this library are implemented
+#include "World.hpp"
+#include "pros/adi.hpp"
+#include "pros/device.h"
+#include "pros/distance.h"
+#include "pros/error.h"
+#include "pros/gps.h"
+#include "pros/imu.h"
+#include "pros/link.h"
+#include "pros/misc.h"
+#include "pros/motors.h"
+#include "pros/optical.h"
+#include "pros/rotation.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <mutex>
+
+using namespace lemlib::sim::detail;
+
+/**
+ * @brief Find the state of a device, and set errno like PROS if it can't be used
+ *
+ * @param w the world. Its mutex has to be locked
+ * @param port the port of the device, which may be negative
+ * @param type the type the device needs to be
+ * @return PortState* the state of the device, or nullptr if it can't be used
+ */
+static PortState* findDevice(World& w, int port, DeviceType type) {
+    port = std::abs(port);
+    if (port < 1 || port > 21) {
+        errno = ENXIO;
+        return nullptr;
+    }
+    PortState& state = w.ports[port];
+    if (state.type != type || !state.plugged) {
+        errno = ENODEV;
+        return nullptr;
+    }
+    return &state;
+}
+
+// motors
+
+/**
+ * @brief Run a function on a motor
+ *
+ * @param port the port of the motor. Negative ports are reversed
+ * @param error the value to return if the motor can't be used
+ * @param f the function, which takes the motor and the direction it spins in (1 or -1)
+ */
+template <typename T, typename F> static T withMotor(int8_t port, T error, F&& f) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState* state = findDevice(w, port, DeviceType::MOTOR);
+    if (state == nullptr) return error;
+    return f(state->motor, port < 0 ? -1.0 : 1.0);
+}
+
+int32_t pros::c::motor_move_voltage(int8_t port, const int32_t voltage) {
+    return withMotor(port, PROS_ERR, [&](MotorState& motor, double direction) {
+        const double maxVoltage = motor.exp ? 7200 : 12000;
+        motor.targetRpm = std::clamp(voltage / maxVoltage, -1.0, 1.0) * INTERNAL_RPM * direction;
+        motor.braking = false;
+        motor.holdingPosition = false;
+        return 1;
+    });
+}
+
+int32_t pros::c::motor_move_velocity(int8_t port, const int32_t velocity) {
+    return withMotor(port, PROS_ERR, [&](MotorState& motor, double direction) {
+        const double max = cartridgeRpm(motor.gearset);
+        motor.targetRpm = std::clamp(velocity / max, -1.0, 1.0) * INTERNAL_RPM * direction;
+        motor.braking = false;
+        motor.holdingPosition = false;
+        return 1;
+    });
+}
+
+int32_t pros::c::motor_move_relative(int8_t port, const double position, const int32_t velocity) {
+    // only counts are simulated, which is the only encoder unit the library uses
+    return withMotor(port, PROS_ERR, [&](MotorState& motor, double direction) {
+        motor.targetRotations = motor.internalRotations + position / TICKS_PER_INTERNAL_ROTATION * direction;
+        motor.maxRpm = std::clamp(std::abs(velocity) / cartridgeRpm(motor.gearset), 0.0, 1.0) * INTERNAL_RPM;
+        motor.holdingPosition = true;
+        motor.braking = false;
+        return 1;
+    });
+}
+
+int32_t pros::c::motor_set_encoder_units(int8_t port, const motor_encoder_units_e_t units) {
+    return withMotor(port, PROS_ERR,
+                     [&](MotorState&, double) { return units == E_MOTOR_ENCODER_COUNTS ? 1 : PROS_ERR; });
+}
+
+int32_t pros::c::motor_brake(int8_t port) {
+    return withMotor(port, PROS_ERR, [&](MotorState& motor, double) {
+        motor.braking = true;
+        motor.holdingPosition = false;
+        return 1;
+    });
+}
+
+double pros::c::motor_get_actual_velocity(int8_t port) {
+    return withMotor(port, PROS_ERR_F, [&](MotorState& motor, double direction) {
+        return motor.internalRpm * cartridgeRpm(motor.gearset) / INTERNAL_RPM * direction;
+    });
+}
+
+int32_t pros::c::motor_get_raw_position(int8_t port, uint32_t* const timestamp) {
+    return withMotor(port, PROS_ERR, [&](MotorState& motor, double direction) {
+        if (timestamp != nullptr) *timestamp = world().time / 1000;
+        return int32_t(std::floor((motor.internalRotations - motor.zeroRotations) * TICKS_PER_INTERNAL_ROTATION * direction));
+    });
+}
+
+int32_t pros::c::motor_get_current_draw(int8_t port) {
+    return withMotor(port, PROS_ERR, [&](MotorState& motor, double) {
+        // current is proportional to how far the motor is from its target velocity
+        const double target = motor.braking ? 0 : motor.targetRpm;
+        const double current = 2500 * std::abs(target - motor.internalRpm) / INTERNAL_RPM;
+        return int32_t(std::min<double>(current, motor.currentLimit));
+    });
+}
+
+double pros::c::motor_get_power(int8_t port) {
+    // the battery voltage times the current, as if the motor were always driven at full voltage
+    const int32_t current = motor_get_current_draw(port);
+    if (current == PROS_ERR) return PROS_ERR_F;
+    return pros::c::battery_get_voltage() / 1000.0 * current / 1000.0;
+}
+
+double pros::c::motor_get_torque(int8_t port) {
+    const int32_t current = motor_get_current_draw(port);
+    if (current == PROS_ERR) return PROS_ERR_F;
+    // a V5 motor stalls at 2.1 Nm and 2.5 A with the 100 rpm cartridge, and torque is inversely proportional to the
+    // speed of the cartridge
+    return withMotor(port, PROS_ERR_F, [&](MotorState& motor, double) {
+        return 2.1 * current / 2500.0 * 100 / cartridgeRpm(motor.gearset);
+    });
+}
+
+double pros::c::motor_get_efficiency(int8_t port) {
+    const double power = motor_get_power(port);
+    const double torque = motor_get_torque(port);
+    const double rpm = motor_get_actual_velocity(port);
+    if (power == PROS_ERR_F || torque == PROS_ERR_F || rpm == PROS_ERR_F) return PROS_ERR_F;
+    if (power <= 0) return 0;
+    return std::clamp(torque * std::abs(rpm) * M_TWOPI / 60 / power * 100, 0.0, 100.0);
+}
+
+double pros::c::motor_get_temperature(int8_t port) {
+    return withMotor(port, PROS_ERR_F, [&](MotorState& motor, double) { return motor.temperature; });
+}
+
+int32_t pros::c::motor_set_brake_mode(int8_t port, const motor_brake_mode_e_t mode) {
+    return withMotor(port, PROS_ERR, [&](MotorState& motor, double) {
+        motor.brakeMode = mode;
+        return 1;
+    });
+}
+
+pros::motor_brake_mode_e_t pros::c::motor_get_brake_mode(int8_t port) {
+    return withMotor(port, pros::E_MOTOR_BRAKE_INVALID, [&](MotorState& motor, double) { return motor.brakeMode; });
+}
+
+int32_t pros::c::motor_set_current_limit(int8_t port, const int32_t limit) {
+    return withMotor(port, PROS_ERR, [&](MotorState& motor, double) {
+        motor.currentLimit = std::clamp(limit, 0, motor.exp ? 1250 : 2500);
+        return 1;
+    });
+}
+
+int32_t pros::c::motor_get_current_limit(int8_t port) {
+    return withMotor(port, PROS_ERR, [&](MotorState& motor, double) { return motor.currentLimit; });
+}
+
+int32_t pros::c::motor_set_gearing(int8_t port, const motor_gearset_e_t gearset) {
+    return withMotor(port, PROS_ERR, [&](MotorState& motor, double) {
+        // EXP motors don't have a cartridge, so their gearing can't be changed
+        if (!motor.exp) motor.gearset = gearset;
+        return 1;
+    });
+}
+
+pros::motor_gearset_e_t pros::c::motor_get_gearing(int8_t port) {
+    return withMotor(port, pros::E_MOTOR_GEARSET_INVALID, [&](MotorState& motor, double) { return motor.gearset; });
+}
+
+// rotation sensors
+
+int32_t pros::c::rotation_get_position(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState* state = findDevice(w, port, DeviceType::ROTATION);
+    if (state == nullptr) return PROS_ERR;
+    const double position = std::round(state->rotation.centidegrees);
+    return int32_t(state->rotation.reversed ? -position : position);
+}
+
+int32_t pros::c::rotation_get_angle(uint8_t port) {
+    const int32_t position = rotation_get_position(port);
+    if (position == PROS_ERR) return PROS_ERR;
+    return ((position % 36000) + 36000) % 36000;
+}
+
+int32_t pros::c::rotation_set_reversed(uint8_t port, bool value) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState* state = findDevice(w, port, DeviceType::ROTATION);
+    if (state == nullptr) return PROS_ERR;
+    state->rotation.reversed = value;
+    return 1;
+}
+
+int32_t pros::c::rotation_get_velocity(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState* state = findDevice(w, port, DeviceType::ROTATION);
+    if (state == nullptr) return PROS_ERR;
+    const double velocity = std::round(state->rotation.velocity);
+    return int32_t(state->rotation.reversed ? -velocity : velocity);
+}
+
+int32_t pros::c::rotation_set_data_rate(uint8_t port, uint32_t rate) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState* state = findDevice(w, port, DeviceType::ROTATION);
+    if (state == nullptr) return PROS_ERR;
+    // like the sensor, the rate is rounded down to a multiple of 5 ms, and is at least 5 ms
+    state->rotation.dataRate = std::max<uint32_t>(5, rate - rate % 5);
+    return 1;
+}
+
+// inertial sensors
+
+/** how long the simulated IMU takes to calibrate, in microseconds */
+constexpr uint64_t IMU_CALIBRATION_TIME = 2000000;
+
+int32_t pros::c::imu_reset(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState* state = findDevice(w, port, DeviceType::IMU);
+    if (state == nullptr) return PROS_ERR;
+    state->imu.calibrationEnd = w.time + IMU_CALIBRATION_TIME;
+    state->imu.rotation = 0;
+    return 1;
+}
+
+int32_t pros::c::imu_set_data_rate(uint8_t port, uint32_t rate) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState* state = findDevice(w, port, DeviceType::IMU);
+    if (state == nullptr) return PROS_ERR;
+    // like the sensor, the rate is rounded down to a multiple of 5 ms, and is at least 5 ms
+    state->imu.dataRate = std::max<uint32_t>(5, rate - rate % 5);
+    return 1;
+}
+
+pros::imu_status_e_t pros::c::imu_get_status(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState* state = findDevice(w, port, DeviceType::IMU);
+    if (state == nullptr) return pros::E_IMU_STATUS_ERROR;
+    return w.time < state->imu.calibrationEnd ? pros::E_IMU_STATUS_CALIBRATING : pros::E_IMU_STATUS_READY;
+}
+
+double pros::c::imu_get_rotation(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState* state = findDevice(w, port, DeviceType::IMU);
+    if (state == nullptr) return PROS_ERR_F;
+    if (w.time < state->imu.calibrationEnd) {
+        errno = EAGAIN;
+        return PROS_ERR_F;
+    }
+    return state->imu.rotation;
+}
+
+pros::imu_gyro_s_t pros::c::imu_get_gyro_rate(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState* state = findDevice(w, port, DeviceType::IMU);
+    if (state == nullptr) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    if (w.time < state->imu.calibrationEnd) {
+        errno = EAGAIN;
+        return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    }
+    // the z axis has the same sign as the rotation
+    return {0, 0, state->imu.rate + state->imu.gyroBias};
+}
+
+pros::imu_accel_s_t pros::c::imu_get_accel(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState* state = findDevice(w, port, DeviceType::IMU);
+    if (state == nullptr) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    if (w.time < state->imu.calibrationEnd) {
+        errno = EAGAIN;
+        return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    }
+    return {state->imu.acceleration[0], state->imu.acceleration[1], state->imu.acceleration[2]};
+}
+
+pros::euler_s_t pros::c::imu_get_euler(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState* state = findDevice(w, port, DeviceType::IMU);
+    if (state == nullptr) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    if (w.time < state->imu.calibrationEnd) {
+        errno = EAGAIN;
+        return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    }
+    // the yaw is the rotation wrapped to [-180, 180)
+    const double yaw = state->imu.rotation - 360 * std::floor((state->imu.rotation + 180) / 360);
+    return {state->imu.pitch, state->imu.roll, yaw};
+}
+
+// distance sensors
+
+int32_t pros::c::distance_get(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState* state = findDevice(w, port, DeviceType::DISTANCE);
+    if (state == nullptr) return PROS_ERR;
+    return state->distance.millimeters;
+}
+
+int32_t pros::c::distance_get_confidence(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState* state = findDevice(w, port, DeviceType::DISTANCE);
+    if (state == nullptr) return PROS_ERR;
+    return state->distance.confidence;
+}
+
+// gps
+
+pros::gps_position_s_t pros::c::gps_get_position(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState* state = findDevice(w, port, DeviceType::GPS);
+    if (state == nullptr) return {PROS_ERR_F, PROS_ERR_F};
+    return {state->gps.x, state->gps.y};
+}
+
+double pros::c::gps_get_heading(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState* state = findDevice(w, port, DeviceType::GPS);
+    if (state == nullptr) return PROS_ERR_F;
+    return state->gps.heading;
+}
+
+double pros::c::gps_get_error(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState* state = findDevice(w, port, DeviceType::GPS);
+    if (state == nullptr) return PROS_ERR_F;
+    return state->gps.error;
+}
+
+// optical sensors
+
+/**
+ * @brief Find the state of an optical sensor, and update what it reports if an integration period has ended
+ *
+ * @param w the world. Its mutex has to be locked
+ * @param port the port of the sensor
+ * @return OpticalState* the state of the sensor, or nullptr if it can't be used
+ */
+static OpticalState* findOptical(World& w, uint8_t port) {
+    PortState* state = findDevice(w, port, DeviceType::OPTICAL);
+    if (state == nullptr) return nullptr;
+    OpticalState& optical = state->optical;
+    const uint64_t now = w.time;
+    if (now >= optical.integrationEnd) {
+        // the sensor only reports the scene as it was at the end of a period, so it lags by up to a period
+        optical.reported = optical.scene;
+        const uint64_t period = uint64_t(optical.integrationTime * 1000);
+        optical.integrationEnd = now + period - now % period;
+    }
+    return &optical;
+}
+
+double pros::c::optical_get_hue(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    OpticalState* state = findOptical(w, port);
+    if (state == nullptr) return PROS_ERR_F;
+    return state->reported.hue;
+}
+
+double pros::c::optical_get_saturation(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    OpticalState* state = findOptical(w, port);
+    if (state == nullptr) return PROS_ERR_F;
+    return state->reported.saturation;
+}
+
+int32_t pros::c::optical_get_proximity(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    OpticalState* state = findOptical(w, port);
+    if (state == nullptr) return PROS_ERR;
+    return state->reported.proximity;
+}
+
+int32_t pros::c::optical_set_led_pwm(uint8_t port, uint8_t value) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    OpticalState* state = findOptical(w, port);
+    if (state == nullptr) return PROS_ERR;
+    state->ledPwm = std::min<int32_t>(value, 100);
+    return 1;
+}
+
+double pros::c::optical_get_integration_time(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    OpticalState* state = findOptical(w, port);
+    if (state == nullptr) return PROS_ERR_F;
+    return state->integrationTime;
+}
+
+int32_t pros::c::optical_set_integration_time(uint8_t port, double time) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    OpticalState* state = findOptical(w, port);
+    if (state == nullptr) return PROS_ERR;
+    state->integrationTime = std::clamp(time, 3.0, 712.0);
+    // the period in progress is cut short
+    state->integrationEnd = std::min<uint64_t>(state->integrationEnd, w.time + uint64_t(state->integrationTime * 1000));
+    return 1;
+}
+
+// radios
+
+// PROS frames every message with a start byte and its size before it, and a checksum after it
+constexpr uint8_t LINK_START_BYTE = 0x33;
+constexpr size_t LINK_PROTOCOL_SIZE = 4;
+
+/**
+ * @brief Find the state of a radio, and set errno like PROS if it has no link
+ *
+ * @param w the world. Its mutex has to be locked
+ * @param port the port of the radio
+ * @return RadioState* the state of the radio, or nullptr if it can't be used
+ */
+static RadioState* findLink(World& w, uint8_t port) {
+    PortState* state = findDevice(w, port, DeviceType::RADIO);
+    if (state == nullptr) return nullptr;
+    if (!state->radio.linked) {
+        errno = ENXIO;
+        return nullptr;
+    }
+    return &state->radio;
+}
+
+/**
+ * @brief Initialize the link of a simulated radio
+ *
+ * @param port the port of the radio
+ * @param type whether this end is the transmitter
+ * @return uint32_t 1 on success, or PROS_ERR
+ */
+static uint32_t initLink(uint8_t port, pros::link_type_e_t type) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState* state = findDevice(w, port, DeviceType::RADIO);
+    if (state == nullptr) return PROS_ERR;
+    state->radio.linked = true;
+    state->radio.transmitter = type == pros::E_LINK_TRANSMITTER;
+    state->radio.outgoing.clear();
+    state->radio.incoming.clear();
+    return 1;
+}
+
+uint32_t pros::c::link_init(uint8_t port, const char*, link_type_e_t type) { return initLink(port, type); }
+
+uint32_t pros::c::link_init_override(uint8_t port, const char*, link_type_e_t type) { return initLink(port, type); }
+
+bool pros::c::link_connected(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    const RadioState* radio = findLink(w, port);
+    if (radio == nullptr || radio->peer == 0) return false;
+    const PortState& peer = w.ports[radio->peer];
+    return peer.type == DeviceType::RADIO && peer.plugged && peer.radio.linked;
+}
+
+uint32_t pros::c::link_raw_receivable_size(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    const RadioState* radio = findLink(w, port);
+    if (radio == nullptr) return PROS_ERR;
+    return radio->incoming.size();
+}
+
+uint32_t pros::c::link_raw_transmittable_size(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    const RadioState* radio = findLink(w, port);
+    if (radio == nullptr) return PROS_ERR;
+    return RADIO_BUFFER_SIZE - std::min(RADIO_BUFFER_SIZE, radio->outgoing.size());
+}
+
+uint32_t pros::c::link_transmit(uint8_t port, void* data, uint16_t data_size) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    RadioState* radio = findLink(w, port);
+    if (radio == nullptr) return PROS_ERR;
+    if (data == nullptr) {
+        errno = EINVAL;
+        return PROS_ERR;
+    }
+    if (radio->outgoing.size() + data_size + LINK_PROTOCOL_SIZE > RADIO_BUFFER_SIZE) {
+        errno = EBUSY;
+        return PROS_ERR;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    const uint8_t header[] = {LINK_START_BYTE, uint8_t(data_size), uint8_t(data_size >> 8)};
+    uint8_t checksum = 0;
+    for (const uint8_t byte : header) checksum ^= byte;
+    for (uint16_t i = 0; i < data_size; i++) checksum ^= bytes[i];
+    radio->outgoing.insert(radio->outgoing.end(), std::begin(header), std::end(header));
+    radio->outgoing.insert(radio->outgoing.end(), bytes, bytes + data_size);
+    radio->outgoing.push_back(checksum);
+    return data_size;
+}
+
+uint32_t pros::c::link_receive(uint8_t port, void* dest, uint16_t data_size) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    RadioState* radio = findLink(w, port);
+    if (radio == nullptr) return PROS_ERR;
+    if (dest == nullptr || data_size + LINK_PROTOCOL_SIZE > RADIO_BUFFER_SIZE) {
+        errno = EINVAL;
+        return PROS_ERR;
+    }
+    std::vector<uint8_t>& incoming = radio->incoming;
+    // nothing is read until the whole message has arrived
+    if (incoming.size() < data_size + LINK_PROTOCOL_SIZE) return 0;
+    // a message which doesn't start where it should is skipped a byte at a time
+    if (incoming[0] != LINK_START_BYTE) {
+        incoming.erase(incoming.begin());
+        errno = EBADMSG;
+        return PROS_ERR;
+    }
+    const size_t size = incoming[1] | incoming[2] << 8;
+    uint8_t checksum = 0;
+    for (size_t i = 0; i < data_size + LINK_PROTOCOL_SIZE; i++) checksum ^= incoming[i];
+    if (size != data_size || checksum != 0) {
+        incoming.erase(incoming.begin(), incoming.begin() + 3);
+        errno = EBADMSG;
+        return PROS_ERR;
+    }
+    std::copy_n(incoming.begin() + 3, data_size, static_cast<uint8_t*>(dest));
+    incoming.erase(incoming.begin(), incoming.begin() + data_size + LINK_PROTOCOL_SIZE);
+    return data_size;
+}
+
+uint32_t pros::c::link_clear_receive_buf(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    RadioState* radio = findLink(w, port);
+    if (radio == nullptr) return PROS_ERR;
+    radio->incoming.clear();
+    return 0;
+}
+
+// generic devices
+
+pros::c::v5_device_e_t pros::c::get_plugged_type(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    if (port < 1 || port > 21) return E_DEVICE_UNDEFINED;
+    const PortState& state = w.ports[port];
+    if (!state.plugged) return E_DEVICE_NONE;
+    switch (state.type) {
+        case DeviceType::MOTOR: return E_DEVICE_MOTOR;
+        case DeviceType::ROTATION: return E_DEVICE_ROTATION;
+        case DeviceType::IMU: return E_DEVICE_IMU;
+        case DeviceType::DISTANCE: return E_DEVICE_DISTANCE;
+        case DeviceType::GPS: return E_DEVICE_GPS;
+        case DeviceType::OPTICAL: return E_DEVICE_OPTICAL;
+        case DeviceType::RADIO: return E_DEVICE_RADIO;
+        default: return E_DEVICE_NONE;
+    }
+}
+
+// battery
+
+int32_t pros::c::battery_get_voltage() {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    return w.batteryMillivolts;
+}
+
+// controllers
+
+/**
+ * @brief Find the state of a controller, and set errno like PROS if the id is invalid
+ *
+ * @param w the world. Its mutex has to be locked
+ * @param id the controller
+ * @return ControllerState* the state of the controller, or nullptr if it isn't connected. PROS reads 0 from
+ * controllers which aren't connected, without setting errno
+ */
+static ControllerState* findController(World& w, pros::controller_id_e_t id) {
+    if (id != pros::E_CONTROLLER_MASTER && id != pros::E_CONTROLLER_PARTNER) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    return w.controllers[id].connected ? &w.controllers[id] : nullptr;
+}
+
+int32_t pros::c::controller_is_connected(controller_id_e_t id) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    if (id != E_CONTROLLER_MASTER && id != E_CONTROLLER_PARTNER) {
+        errno = EINVAL;
+        return PROS_ERR;
+    }
+    return w.controllers[id].connected;
+}
+
+int32_t pros::c::controller_get_analog(controller_id_e_t id, controller_analog_e_t channel) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    const ControllerState* state = findController(w, id);
+    if (state == nullptr || channel < E_CONTROLLER_ANALOG_LEFT_X || channel > E_CONTROLLER_ANALOG_RIGHT_Y) return 0;
+    return state->analog[channel];
+}
+
+int32_t pros::c::controller_get_digital(controller_id_e_t id, controller_digital_e_t button) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    const ControllerState* state = findController(w, id);
+    if (state == nullptr || button < E_CONTROLLER_DIGITAL_L1 || button > E_CONTROLLER_DIGITAL_A) return 0;
+    return state->digital[button - E_CONTROLLER_DIGITAL_L1];
+}
+
+// adi devices
+
+/**
+ * @brief Convert an ADI port to a number from 1 to 8, like PROS does
+ *
+ * @param port the port, either a number or a letter
+ * @return uint8_t the port number
+ */
+static uint8_t adiPortNumber(uint8_t port) {
+    if (port >= 'a' && port <= 'h') return port - 'a' + 1;
+    if (port >= 'A' && port <= 'H') return port - 'A' + 1;
+    return port;
+}
+
+static ADIEncoderState& adiEncoder(World& w, uint8_t smartPort, uint8_t topPort) {
+    return w.adiEncoders[smartPort * 256 + topPort];
+}
+
+namespace pros::adi {
+Port::Port(std::uint8_t adi_port, adi_port_config_e_t)
+    : _smart_port(BRAIN_ADI_PORT),
+      _adi_port(adiPortNumber(adi_port)) {}
+
+Port::Port(ext_adi_port_pair_t port_pair, adi_port_config_e_t)
+    : _smart_port(port_pair.first),
+      _adi_port(adiPortNumber(port_pair.second)) {}
+
+ext_adi_port_tuple_t Port::get_port() const { return {_smart_port, _adi_port, 0}; }
+
+std::int32_t Port::get_value() const {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    // sensors which were never set read 0, like an unpressed switch
+    return w.adiValues[_smart_port * 256 + _adi_port];
+}
+
+DigitalIn::DigitalIn(std::uint8_t adi_port)
+    : Port(adi_port, E_ADI_DIGITAL_IN) {}
+
+DigitalIn::DigitalIn(ext_adi_port_pair_t port_pair)
+    : Port(port_pair, E_ADI_DIGITAL_IN) {}
+
+AnalogIn::AnalogIn(std::uint8_t adi_port)
+    : Port(adi_port, E_ADI_ANALOG_IN) {}
+
+AnalogIn::AnalogIn(ext_adi_port_pair_t port_pair)
+    : Port(port_pair, E_ADI_ANALOG_IN) {}
+
+Encoder::Encoder(std::uint8_t adi_port_top, std::uint8_t adi_port_bottom, bool reversed)
+    : Encoder(ext_adi_port_tuple_t {BRAIN_ADI_PORT, adi_port_top, adi_port_bottom}, reversed) {}
+
+Encoder::Encoder(ext_adi_port_tuple_t port_tuple, bool reversed)
+    : Port(ext_adi_port_pair_t {std::get<0>(port_tuple), std::get<1>(port_tuple)}, E_ADI_LEGACY_ENCODER),
+      _port_pair(adiPortNumber(std::get<1>(port_tuple)), adiPortNumber(std::get<2>(port_tuple))) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    // initializing an encoder resets it
+    ADIEncoderState& state = adiEncoder(w, _smart_port, _adi_port);
+    state.reversed = reversed;
+    state.zero = state.ticks;
+}
+
+std::int32_t Encoder::reset() const {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    ADIEncoderState& state = adiEncoder(w, _smart_port, _adi_port);
+    state.zero = state.ticks;
+    return 1;
+}
+
+std::int32_t Encoder::get_value() const {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    const ADIEncoderState& state = adiEncoder(w, _smart_port, _adi_port);
+    const int32_t value = state.ticks - state.zero;
+    return state.reversed ? -value : value;
+}
+
+ext_adi_port_tuple_t Encoder::get_port() const { return {_smart_port, _port_pair.first, _port_pair.second}; }
+} // namespace pros::adi
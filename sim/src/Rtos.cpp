@@ -0,0 +1,165 @@
+// simulated PROS rtos api. Tasks are host threads, but they only run while the simulated clock is stopped, see Sim.hpp
+#include "World.hpp"
+#include "sim/Sim.hpp"
+#include "pros/rtos.h"
+#include "pros/rtos.hpp"
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace lemlib::sim::detail {
+static thread_local bool t_isTask = false;
+
+/**
+ * @brief A simulated task, which only holds the notification value, the priority and the name, as tasks can't be
+ * suspended or deleted. The priority is only kept, as every task runs on a thread of its own
+ */
+struct TaskState {
+        std::atomic<uint32_t> notifications = 0;
+        std::atomic<uint32_t> priority = TASK_PRIORITY_DEFAULT;
+        // threads which aren't tasks, like the main thread, are named like the main thread of a host program
+        char name[32] = "main";
+};
+
+// the task of the calling thread. The main thread gets one too, so it can be notified like a task
+static thread_local TaskState* t_task = nullptr;
+
+TaskState& currentTask() {
+    // threads which aren't tasks, like the main thread, live as long as their state. It is not allocated, as this is
+    // called from inside operator new when allocations are tracked
+    static thread_local TaskState threadState;
+    if (t_task == nullptr) t_task = &threadState;
+    return *t_task;
+}
+
+bool isTask() { return t_isTask; }
+
+void setBlocked(bool blocked) {
+    if (!t_isTask) return;
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.running += blocked ? -1 : 1;
+    w.changed.notify_all();
+}
+
+void sleepUntil(uint64_t wakeTime) {
+    World& w = world();
+    if (!t_isTask) {
+        const uint64_t now = w.time;
+        if (wakeTime > now) advance(from_usec(wakeTime - now));
+        return;
+    }
+    std::unique_lock lock(w.mutex);
+    if (wakeTime <= w.time) return;
+    Waiter waiter {.wakeTime = wakeTime};
+    w.waiters.push_back(&waiter);
+    w.running--;
+    w.changed.notify_all();
+    // whoever wakes the task counts it as running again
+    w.changed.wait(lock, [&] { return waiter.woken; });
+}
+} // namespace lemlib::sim::detail
+
+using namespace lemlib::sim::detail;
+
+uint32_t pros::c::millis() { return world().time / 1000; }
+
+uint64_t pros::c::micros() { return world().time; }
+
+void pros::c::delay(const uint32_t milliseconds) { sleepUntil(world().time + uint64_t(milliseconds) * 1000); }
+
+void pros::c::task_delay_until(uint32_t* const prev_time, const uint32_t delta) {
+    *prev_time += delta;
+    sleepUntil(uint64_t(*prev_time) * 1000);
+}
+
+pros::task_t pros::c::task_create(task_fn_t function, void* const parameters, uint32_t prio, const uint16_t,
+                                   const char* const name) {
+    World& w = world();
+    {
+        std::lock_guard lock(w.mutex);
+        w.running++;
+    }
+    TaskState* task = new TaskState();
+    task->priority = prio;
+    std::strncpy(task->name, name == nullptr ? "" : name, sizeof(task->name) - 1);
+    std::thread([&w, function, parameters, task] {
+        t_isTask = true;
+        t_task = task;
+        function(parameters);
+        std::lock_guard lock(w.mutex);
+        w.running--;
+        w.changed.notify_all();
+    }).detach();
+    // tasks can only be notified through their handle in the simulator
+    return task;
+}
+
+pros::task_t pros::c::task_get_current() { return &currentTask(); }
+
+char* pros::c::task_get_name(task_t task) {
+    return task == nullptr ? currentTask().name : static_cast<TaskState*>(task)->name;
+}
+
+uint32_t pros::c::task_get_priority(task_t task) {
+    return task == nullptr ? currentTask().priority.load() : static_cast<TaskState*>(task)->priority.load();
+}
+
+void pros::c::task_set_priority(task_t task, uint32_t prio) {
+    (task == nullptr ? currentTask() : *static_cast<TaskState*>(task)).priority = prio;
+}
+
+uint32_t pros::c::task_notify(task_t task) {
+    static_cast<TaskState*>(task)->notifications.fetch_add(1);
+    return 1;
+}
+
+uint32_t pros::c::task_notify_take(bool clear_on_exit, uint32_t timeout) {
+    TaskState& task = currentTask();
+    // notifications are polled every simulated millisecond, like mutexes with a timeout
+    const uint32_t start = pros::c::millis();
+    while (task.notifications.load() == 0) {
+        if (timeout != TIMEOUT_MAX && pros::c::millis() - start >= timeout) return 0;
+        pros::c::delay(1);
+    }
+    return clear_on_exit ? task.notifications.exchange(0) : task.notifications.fetch_sub(1);
+}
+
+namespace pros::rtos {
+Mutex::Mutex()
+    : mutex(std::make_shared<std::mutex>()) {}
+
+bool Mutex::take() {
+    std::mutex& m = *static_cast<std::mutex*>(mutex.get());
+    if (m.try_lock()) return true;
+    // a task waiting for a mutex must not hold back the clock, or the task which holds it could never run
+    setBlocked(true);
+    m.lock();
+    setBlocked(false);
+    return true;
+}
+
+bool Mutex::take(std::uint32_t timeout) {
+    if (timeout == TIMEOUT_MAX) return take();
+    std::mutex& m = *static_cast<std::mutex*>(mutex.get());
+    // the timeout is measured in simulated time, so poll the mutex every simulated millisecond
+    const uint32_t start = pros::c::millis();
+    while (!m.try_lock()) {
+        if (pros::c::millis() - start >= timeout) return false;
+        pros::c::delay(1);
+    }
+    return true;
+}
+
+bool Mutex::give() {
+    static_cast<std::mutex*>(mutex.get())->unlock();
+    return true;
+}
+
+void Mutex::lock() { take(); }
+
+void Mutex::unlock() { give(); }
+
+bool Mutex::try_lock() { return static_cast<std::mutex*>(mutex.get())->try_lock(); }
+} // namespace pros::rtos
@@ -0,0 +1,340 @@
+#include "sim/Sim.hpp"
+#include "World.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace lemlib::sim {
+namespace detail {
+World& world() {
+    static World* w = new World();
+    return *w;
+}
+
+void stepDevices(World& w, double seconds) {
+    // the motor reaches its target velocity with this time constant. Coasting motors slow down much slower
+    constexpr double TIME_CONSTANT = 0.05;
+    constexpr double COAST_TIME_CONSTANT = 0.5;
+    for (PortState& port : w.ports) {
+        if (port.type == DeviceType::MOTOR) {
+            MotorState& motor = port.motor;
+            // the position controller slows down in proportion to the remaining distance
+            if (motor.holdingPosition) {
+                constexpr double POSITION_GAIN = 600; // rpm per internal rotation
+                motor.targetRpm =
+                    std::clamp((motor.targetRotations - motor.internalRotations) * POSITION_GAIN, -motor.maxRpm,
+                               motor.maxRpm);
+            }
+            const bool coasting = motor.braking && motor.brakeMode == pros::E_MOTOR_BRAKE_COAST;
+            const double target = motor.braking ? 0 : motor.targetRpm;
+            const double alpha = 1 - std::exp(-seconds / (coasting ? COAST_TIME_CONSTANT : TIME_CONSTANT));
+            motor.internalRpm += (target - motor.internalRpm) * alpha;
+            motor.internalRotations += motor.internalRpm / 60 * seconds;
+        } else if (port.type == DeviceType::IMU) {
+            port.imu.rotation += port.imu.rate * seconds;
+        }
+    }
+    // rotation sensors are stepped after motors, so they follow the motor in the same step
+    for (PortState& port : w.ports) {
+        if (port.type != DeviceType::ROTATION || port.rotation.linkedMotor == 0) continue;
+        const PortState& motorPort = w.ports[port.rotation.linkedMotor];
+        if (motorPort.type != DeviceType::MOTOR) continue;
+        const MotorState& motor = motorPort.motor;
+        const double rotations = motor.internalRotations * cartridgeRpm(motor.gearset) / INTERNAL_RPM;
+        const double moved = (rotations - port.rotation.lastMotorRotations) * port.rotation.ratio * 36000;
+        port.rotation.centidegrees += moved;
+        port.rotation.velocity = seconds > 0 ? moved / seconds : 0;
+        port.rotation.lastMotorRotations = rotations;
+    }
+    // a link only carries bytes while the radios on both ends are plugged in and initialized
+    for (PortState& port : w.ports) {
+        if (port.type != DeviceType::RADIO) continue;
+        RadioState& radio = port.radio;
+        PortState& peer = w.ports[radio.peer];
+        if (!port.plugged || !radio.linked || radio.peer == 0 || !peer.plugged || !peer.radio.linked ||
+            radio.outgoing.empty()) {
+            radio.credit = 0;
+            continue;
+        }
+        // the transmitter gets twice the bandwidth of the receiver, like VEXlink
+        radio.credit += (radio.transmitter ? 1040 : 520) * seconds;
+        const size_t sent = std::min(radio.outgoing.size(), size_t(radio.credit));
+        radio.credit -= sent;
+        // bytes which don't fit in the buffer of the other end are lost
+        const size_t kept = std::min(sent, RADIO_BUFFER_SIZE - std::min(RADIO_BUFFER_SIZE, peer.radio.incoming.size()));
+        peer.radio.incoming.insert(peer.radio.incoming.end(), radio.outgoing.begin(), radio.outgoing.begin() + kept);
+        radio.outgoing.erase(radio.outgoing.begin(), radio.outgoing.begin() + sent);
+    }
+}
+} // namespace detail
+
+using namespace detail;
+
+void reset() {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.ports = {};
+    w.adiEncoders.clear();
+    w.controllers = {ControllerState {.connected = true}, ControllerState()};
+    w.batteryMillivolts = 12800;
+    w.time = 0;
+}
+
+Time getTime() { return from_usec(world().time.load()); }
+
+void advance(Time duration) {
+    World& w = world();
+    const uint64_t target = w.time + uint64_t(std::max(0.0, std::round(to_usec(duration))));
+    std::unique_lock lock(w.mutex);
+    while (w.time < target) {
+        // step to the next task wake up, but never more than 1 ms at a time
+        uint64_t next = std::min(target, w.time + 1000);
+        for (const Waiter* waiter : w.waiters) next = std::min(next, std::max(w.time.load() + 1, waiter->wakeTime));
+        stepDevices(w, double(next - w.time) / 1E6);
+        w.time = next;
+        // wake every task whose delay expired, and wait for them to delay again
+        for (auto it = w.waiters.begin(); it != w.waiters.end();) {
+            if ((*it)->wakeTime <= w.time) {
+                (*it)->woken = true;
+                w.running++;
+                it = w.waiters.erase(it);
+            } else it++;
+        }
+        w.changed.notify_all();
+        w.changed.wait(lock, [&] { return w.running == 0; });
+    }
+}
+
+void addMotor(uint8_t port, SimMotorType type) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.ports[port] = PortState();
+    w.ports[port].type = DeviceType::MOTOR;
+    w.ports[port].plugged = true;
+    w.ports[port].motor.exp = type == SimMotorType::EXP;
+}
+
+void addRotationSensor(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.ports[port] = PortState();
+    w.ports[port].type = DeviceType::ROTATION;
+    w.ports[port].plugged = true;
+}
+
+void addIMU(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.ports[port] = PortState();
+    w.ports[port].type = DeviceType::IMU;
+    w.ports[port].plugged = true;
+}
+
+void addDistanceSensor(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.ports[port] = PortState();
+    w.ports[port].type = DeviceType::DISTANCE;
+    w.ports[port].plugged = true;
+}
+
+void addGPS(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.ports[port] = PortState();
+    w.ports[port].type = DeviceType::GPS;
+    w.ports[port].plugged = true;
+}
+
+void addOpticalSensor(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.ports[port] = PortState();
+    w.ports[port].type = DeviceType::OPTICAL;
+    w.ports[port].plugged = true;
+}
+
+void addRadio(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.ports[port] = PortState();
+    w.ports[port].type = DeviceType::RADIO;
+    w.ports[port].plugged = true;
+}
+
+void pairRadios(uint8_t a, uint8_t b) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.ports[a].radio.peer = b;
+    w.ports[b].radio.peer = a;
+}
+
+void unplug(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.ports[port].plugged = false;
+}
+
+void plug(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    PortState& state = w.ports[port];
+    if (state.plugged) return;
+    state.plugged = true;
+    // devices lose their configuration and position when they lose power
+    if (state.type == DeviceType::MOTOR) {
+        const MotorState old = state.motor;
+        state.motor = MotorState();
+        state.motor.exp = old.exp;
+        state.motor.internalRpm = old.internalRpm;
+        state.motor.internalRotations = old.internalRotations;
+        state.motor.zeroRotations = old.internalRotations;
+        state.motor.temperature = old.temperature;
+    } else if (state.type == DeviceType::ROTATION) {
+        state.rotation.centidegrees = 0;
+        state.rotation.velocity = 0;
+        state.rotation.reversed = false;
+        state.rotation.dataRate = 10;
+    } else if (state.type == DeviceType::IMU) {
+        state.imu.dataRate = 10;
+    } else if (state.type == DeviceType::OPTICAL) {
+        state.optical.integrationTime = 100;
+        state.optical.integrationEnd = 0;
+        state.optical.ledPwm = 0;
+    }
+}
+
+Angle getMotorAngle(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    const PortState& state = w.ports[port];
+    if (state.type != DeviceType::MOTOR) return from_stRot(INFINITY);
+    return from_stRot(state.motor.internalRotations * cartridgeRpm(state.motor.gearset) / INTERNAL_RPM);
+}
+
+AngularVelocity getMotorVelocity(uint8_t port) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    const PortState& state = w.ports[port];
+    if (state.type != DeviceType::MOTOR) return from_rpm(INFINITY);
+    return from_rpm(state.motor.internalRpm * cartridgeRpm(state.motor.gearset) / INTERNAL_RPM);
+}
+
+void setMotorTemperature(uint8_t port, Temperature temperature) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.ports[port].motor.temperature = units::to_celsius(temperature);
+}
+
+void setBatteryVoltage(Voltage voltage) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.batteryMillivolts = int32_t(std::round(to_mvolt(voltage)));
+}
+
+void setRotationSensorAngle(uint8_t port, Angle angle) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.ports[port].rotation.centidegrees = to_stDeg(angle) * 100;
+}
+
+void setDistanceSensorReading(uint8_t port, Length distance, Number confidence) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    DistanceState& state = w.ports[port].distance;
+    // like the sensor, nothing further away than 2 meters is detected. Written so NaN is out of range too
+    state.millimeters = !(distance <= 2_m) ? 9999 : int32_t(std::round(to_mm(distance)));
+    state.confidence = int32_t(std::round(std::clamp(confidence.internal(), 0.0, 1.0) * 63));
+}
+
+void setGPSReading(uint8_t port, units::Pose pose, Length error) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    GPSState& state = w.ports[port].gps;
+    state.x = to_m(pose.x);
+    state.y = to_m(pose.y);
+    // the sensor reports its heading clockwise from the positive y axis, from 0 to 360 degrees
+    const double heading = 90 - to_stDeg(pose.orientation);
+    state.heading = heading - 360 * std::floor(heading / 360);
+    state.error = to_m(error);
+}
+
+void setOpticalReading(uint8_t port, Angle hue, Number saturation, Number proximity) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    OpticalColor& scene = w.ports[port].optical.scene;
+    const double degrees = to_stDeg(hue);
+    scene.hue = degrees - 360 * std::floor(degrees / 360);
+    scene.saturation = std::clamp(saturation.internal(), 0.0, 1.0);
+    scene.proximity = int32_t(std::round(std::clamp(proximity.internal(), 0.0, 1.0) * 255));
+}
+
+void linkRotationSensor(uint8_t rotationPort, uint8_t motorPort, Number ratio) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    RotationState& rotation = w.ports[rotationPort].rotation;
+    const MotorState& motor = w.ports[motorPort].motor;
+    rotation.linkedMotor = motorPort;
+    rotation.ratio = ratio.internal();
+    rotation.lastMotorRotations = motor.internalRotations * cartridgeRpm(motor.gearset) / INTERNAL_RPM;
+}
+
+void setIMURate(uint8_t port, AngularVelocity rate) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    // PROS measures rotation clockwise positive
+    w.ports[port].imu.rate = -to_degps(rate);
+}
+
+void setIMUGyroBias(uint8_t port, AngularVelocity bias) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    // PROS measures rotation clockwise positive
+    w.ports[port].imu.gyroBias = -to_degps(bias);
+}
+
+void setIMUAcceleration(uint8_t port, units::Vector3D<LinearAcceleration> acceleration) {
+    constexpr double STANDARD_GRAVITY = 9.80665;
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.ports[port].imu.acceleration[0] = to_mps2(acceleration.x) / STANDARD_GRAVITY;
+    w.ports[port].imu.acceleration[1] = to_mps2(acceleration.y) / STANDARD_GRAVITY;
+    w.ports[port].imu.acceleration[2] = to_mps2(acceleration.z) / STANDARD_GRAVITY;
+}
+
+void setIMUTilt(uint8_t port, Angle roll, Angle pitch) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.ports[port].imu.roll = to_stDeg(roll);
+    w.ports[port].imu.pitch = to_stDeg(pitch);
+}
+
+void setADIEncoder(uint8_t smartPort, uint8_t topPort, int32_t ticks) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.adiEncoders[smartPort * 256 + topPort].ticks = ticks;
+}
+
+void setADIValue(uint8_t smartPort, uint8_t port, int32_t value) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.adiValues[smartPort * 256 + port] = value;
+}
+
+void setControllerConnected(pros::controller_id_e_t id, bool connected) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.controllers[id] = {.connected = connected};
+}
+
+void setControllerAnalog(pros::controller_id_e_t id, pros::controller_analog_e_t channel, int32_t value) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.controllers[id].analog[channel] = std::clamp(value, -127, 127);
+}
+
+void setControllerDigital(pros::controller_id_e_t id, pros::controller_digital_e_t button, bool pressed) {
+    World& w = world();
+    std::lock_guard lock(w.mutex);
+    w.controllers[id].digital[button - pros::E_CONTROLLER_DIGITAL_L1] = pressed;
+}
+} // namespace lemlib::sim
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "pros/motors.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Internal state of the simulator, shared by the simulated PROS api and the simulator api
+ */
+namespace lemlib::sim::detail {
+/** the port PROS uses for the ADI ports on the brain */
+constexpr uint8_t BRAIN_ADI_PORT = 22;
+/** the speed of the motor inside every V5 and EXP motor, before the cartridge */
+constexpr double INTERNAL_RPM = 3600;
+/** the number of encoder ticks per rotation of the motor inside every V5 and EXP motor */
+constexpr double TICKS_PER_INTERNAL_ROTATION = 50;
+/** the size of the transmit and receive buffers of a radio, in bytes */
+constexpr size_t RADIO_BUFFER_SIZE = 512;
+
+/**
+ * @brief Get the speed of the output of a cartridge
+ *
+ * @param gearset the cartridge
+ * @return double the speed in rpm
+ */
+inline double cartridgeRpm(pros::motor_gearset_e_t gearset) {
+    switch (gearset) {
+        case pros::E_MOTOR_GEARSET_06: return 600;
+        case pros::E_MOTOR_GEARSET_36: return 100;
+        default: return 200;
+    }
+}
+
+enum class DeviceType { NONE, MOTOR, ROTATION, IMU, DISTANCE, GPS, OPTICAL, RADIO };
+
+struct MotorState {
+        bool exp = false;
+        pros::motor_gearset_e_t gearset = pros::E_MOTOR_GEARSET_18;
+        pros::motor_brake_mode_e_t brakeMode = pros::E_MOTOR_BRAKE_COAST;
+        int32_t currentLimit = 2500; // mA
+        // the motor targets a velocity of the internal motor, in rpm
+        double targetRpm = 0;
+        bool braking = false;
+        // whether the motor is following a position target, at up to maxRpm of the internal motor
+        bool holdingPosition = false;
+        double targetRotations = 0;
+        double maxRpm = 0;
+        double internalRpm = 0;
+        double internalRotations = 0;
+        // the position reported by the motor is relative to this. It is reset when the motor loses power
+        double zeroRotations = 0;
+        double temperature = 25; // celsius
+};
+
+struct RotationState {
+        double centidegrees = 0;
+        double velocity = 0; // centidegrees per second, measured over the last step
+        bool reversed = false;
+        uint32_t dataRate = 10; // milliseconds
+        // the motor the sensor follows, or 0 if it doesn't follow a motor
+        uint8_t linkedMotor = 0;
+        double ratio = 1;
+        double lastMotorRotations = 0;
+};
+
+struct IMUState {
+        // PROS measures rotation clockwise positive
+        double rotation = 0; // degrees
+        double rate = 0; // degrees per second, clockwise positive
+        double gyroBias = 0; // degrees per second, added to the gyro rate but not to the rotation
+        uint64_t calibrationEnd = 0; // microseconds
+        uint32_t dataRate = 10; // milliseconds
+        // the acceleration measured by the accelerometer, in multiples of gravity. A flat sensor at rest measures
+        // gravity along its z axis
+        double acceleration[3] = {0, 0, 1};
+        double roll = 0; // degrees
+        double pitch = 0; // degrees
+};
+
+struct DistanceState {
+        // the reading of the sensor, in millimeters. 9999 means there is no object in range
+        int32_t millimeters = 9999;
+        int32_t confidence = 63; // from 0 to 63
+};
+
+struct GPSState {
+        double x = 0; // meters, from the center of the field
+        double y = 0; // meters, from the center of the field
+        double heading = 0; // degrees, clockwise from the positive y axis, from 0 to 360
+        double error = 0.02; // meters
+};
+
+struct OpticalColor {
+        double hue = 0; // degrees, from 0 to 360
+        double saturation = 0; // from 0 to 1
+        int32_t proximity = 0; // from 0 to 255
+};
+
+struct OpticalState {
+        // what is in front of the sensor
+        OpticalColor scene;
+        // what the sensor reports, which is the scene at the end of its latest integration period
+        OpticalColor reported;
+        double integrationTime = 100; // milliseconds, from 3 to 712
+        uint64_t integrationEnd = 0; // microseconds
+        int32_t ledPwm = 0; // from 0 to 100
+};
+
+struct RadioState {
+        // whether link_init was called, and whether this end of the link is the transmitter
+        bool linked = false;
+        bool transmitter = false;
+        // the port of the radio on the other end of the link, or 0 if it isn't paired
+        uint8_t peer = 0;
+        // bytes which were transmitted but haven't gone over the air yet, and bytes which arrived but weren't read
+        std::vector<uint8_t> outgoing;
+        std::vector<uint8_t> incoming;
+        // the fraction of a byte the link could already have sent
+        double credit = 0;
+};
+
+struct PortState {
+        DeviceType type = DeviceType::NONE;
+        bool plugged = false;
+        MotorState motor;
+        RotationState rotation;
+        IMUState imu;
+        DistanceState distance;
+        GPSState gps;
+        OpticalState optical;
+        RadioState radio;
+};
+
+struct ADIEncoderState {
+        int32_t ticks = 0;
+        int32_t zero = 0;
+        bool reversed = false;
+};
+
+struct ControllerState {
+        bool connected = false;
+        // indexed by pros::controller_analog_e_t, from -127 to 127
+        std::array<int32_t, 4> analog {};
+        // indexed by pros::controller_digital_e_t - pros::E_CONTROLLER_DIGITAL_L1
+        std::array<bool, 12> digital {};
+};
+
+/**
+ * @brief A task sleeping until the clock reaches a certain time
+ */
+struct Waiter {
+        uint64_t wakeTime;
+        bool woken = false;
+};
+
+struct World {
+        // protects every member, except for time
+        std::mutex mutex;
+        // signalled whenever a task starts waiting, stops running, or is woken
+        std::condition_variable changed;
+        // the simulated time, in microseconds
+        std::atomic<uint64_t> time = 0;
+        // index 0 is unused, so ports can be used as indices
+        std::array<PortState, 22> ports;
+        // ADI encoders, indexed by smart port * 256 + top port
+        std::map<uint32_t, ADIEncoderState> adiEncoders;
+        // the values of other ADI sensors, indexed by smart port * 256 + ADI port
+        std::map<uint32_t, int32_t> adiValues;
+        // the master controller is connected by default, like at a match
+        std::array<ControllerState, 2> controllers {ControllerState {.connected = true}, ControllerState()};
+        // the voltage of the battery, in millivolts
+        int32_t batteryMillivolts = 12800;
+        // the number of tasks which are running, and not waiting for the clock
+        int running = 0;
+        std::vector<Waiter*> waiters;
+};
+
+/**
+ * @brief Get the simulated world
+ *
+ * The world is never destroyed, so tasks which are still blocked when the program exits never access a destroyed
+ * mutex
+ *
+ * @return World& the world
+ */
+World& world();
+
+/**
+ * @brief Simulate every device for a period of time
+ *
+ * The world mutex has to be locked before this function is called
+ *
+ * @param w the world
+ * @param seconds how long to simulate for
+ */
+void stepDevices(World& w, double seconds);
+
+/**
+ * @brief Block the calling PROS task until the clock reaches a certain time
+ *
+ * If this is called from a thread which isn't a PROS task, the clock is advanced instead
+ *
+ * @param wakeTime the time to wake up at, in microseconds
+ */
+void sleepUntil(uint64_t wakeTime);
+
+/**
+ * @brief Whether the calling thread is a PROS task created by the simulator
+ *
+ * @return true if it is a PROS task
+ */
+bool isTask();
+
+/**
+ * @brief Mark the calling PROS task as blocked or running
+ *
+ * Tasks which are blocked, for example on a mutex, don't hold back the clock
+ *
+ * @param blocked whether the task is blocked
+ */
+void setBlocked(bool blocked);
+} // namespace lemlib::sim::detail
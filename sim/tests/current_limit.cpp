@@ -0,0 +1,41 @@
+// checks that the current limit of a motor group is split between its motors, and that setting a limit of INFINITY
+// lifts it again, back to the largest current each motor takes. The exit code is the number of checks which failed
+#include "hardware/hardware.hpp"
+#include "pros/motors.h"
+#include "pros/rtos.hpp"
+#include "sim/Sim.hpp"
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+
+int main() {
+    constexpr uint8_t PORTS[] = {1, 2, 3};
+    for (uint8_t port : PORTS) lemlib::sim::addMotor(port);
+    lemlib::MotorGroup group({1, -2, 3}, 200_rpm);
+    int failed = 0;
+    const auto limitsAre = [&](int32_t milliamps) {
+        for (uint8_t port : PORTS) {
+            if (pros::c::motor_get_current_limit(port) != milliamps) return false;
+        }
+        return true;
+    };
+
+    // a group which was never limited doesn't write to its motors
+    if (group.move(0) != 0 || !limitsAre(2500)) failed++;
+    if (group.setCurrentLimit(6_amp) != 0 || !limitsAre(2000)) failed++;
+    if (group.setCurrentLimit(from_amp(INFINITY)) != 0 || !limitsAre(2500)) failed++;
+    // limiting again after lifting the limit works the same way
+    if (group.setCurrentLimit(3_amp) != 0 || !limitsAre(1000)) failed++;
+
+    // until the registry scans the ports again, the unplugged motors look connected but don't take their share
+    for (uint8_t port : PORTS) lemlib::sim::unplug(port);
+    errno = 0;
+    if (group.setCurrentLimit(6_amp) != INT_MAX || errno != EIO) failed++;
+    // once it has, there is no motor to limit
+    pros::delay(20);
+    errno = 0;
+    if (group.setCurrentLimit(6_amp) != INT_MAX || errno != ENODEV) failed++;
+
+    std::printf("current limit: %d failed\n", failed);
+    return failed;
+}
@@ -0,0 +1,119 @@
+// checks that a reader of a DoubleBuffer never accepts a torn value, in the interleaving where it is most likely. The
+// reader loads the sequence and picks the published slot, then waits while the writer publishes a value to the other
+// slot and starts writing the next value into the slot the reader is on. A timer signal interrupts the writer in
+// the middle of that write, and lets the reader finish and check the sequence before the write is done. Every field
+// of a value holds the same number, so a reader that reads part of the old and part of the new value sees mixed
+// fields. Interrupting the writer from a signal makes the interleaving happen even on a single core. The exit code is
+// the number of rounds in which the reader accepted a torn value
+#include "hardware/DoubleBuffer.hpp"
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <semaphore.h>
+#include <sys/time.h>
+#include <thread>
+
+namespace {
+constexpr int ROUNDS = 200;
+// how often the writer is interrupted. A write takes several times as long, so most writes are interrupted
+constexpr suseconds_t INTERRUPT_MICROS = 20;
+
+// large enough that copying it takes much longer than the interval of the timer
+struct Record {
+        std::array<uint32_t, 1 << 18> fields;
+};
+
+lemlib::DoubleBuffer<Record> buffer;
+Record first;
+Record second;
+sem_t paused;
+sem_t resumed;
+sem_t done;
+// set while the writer is on the slot the reader is paused on, and cleared by whichever lets the reader go first
+std::atomic<bool> armed = false;
+std::atomic<int> interrupted = 0;
+
+void wait(sem_t* semaphore) {
+    while (sem_wait(semaphore) != 0 && errno == EINTR);
+}
+
+// lets the paused reader finish, and waits until it has
+void releaseReader() {
+    sem_post(&resumed);
+    wait(&done);
+}
+
+void onInterrupt(int) {
+    if (!armed.exchange(false)) return;
+    interrupted++;
+    releaseReader();
+}
+
+void writer() {
+    // only the writer is interrupted
+    sigset_t alarm;
+    sigemptyset(&alarm);
+    sigaddset(&alarm, SIGALRM);
+    pthread_sigmask(SIG_UNBLOCK, &alarm, nullptr);
+    for (int round = 0; round < ROUNDS; round++) {
+        first.fields.fill(2 * round + 1);
+        second.fields.fill(2 * round + 2);
+        wait(&paused);
+        buffer.write(first);
+        armed = true;
+        buffer.write(second);
+        // the write finished before the timer fired
+        if (armed.exchange(false)) releaseReader();
+    }
+}
+} // namespace
+
+int main() {
+    sem_init(&paused, 0, 0);
+    sem_init(&resumed, 0, 0);
+    sem_init(&done, 0, 0);
+    // the reader and main inherit the blocked signal, so it is always delivered to the writer
+    sigset_t alarm;
+    sigemptyset(&alarm);
+    sigaddset(&alarm, SIGALRM);
+    pthread_sigmask(SIG_BLOCK, &alarm, nullptr);
+    struct sigaction action = {};
+    action.sa_handler = onInterrupt;
+    sigaction(SIGALRM, &action, nullptr);
+    const itimerval interval = {{0, INTERRUPT_MICROS}, {0, INTERRUPT_MICROS}};
+    setitimer(ITIMER_REAL, &interval, nullptr);
+
+    int torn = 0;
+    std::thread reader([&] {
+        for (int round = 0; round < ROUNDS; round++) {
+            bool pause = true;
+            const bool whole = buffer.read([&](const Record& record) {
+                // only the first attempt pauses, a retry reads straight through
+                if (pause) {
+                    pause = false;
+                    sem_post(&paused);
+                    wait(&resumed);
+                }
+                for (uint32_t field : record.fields) {
+                    if (field != record.fields[0]) return false;
+                }
+                return true;
+            });
+            if (!whole) torn++;
+            sem_post(&done);
+        }
+    });
+    std::thread writing(writer);
+    writing.join();
+    reader.join();
+
+    const itimerval stop = {};
+    setitimer(ITIMER_REAL, &stop, nullptr);
+    const bool latest = buffer.getSequence() == 2 * ROUNDS && buffer.read().fields[0] == 2 * ROUNDS;
+    std::printf("%d rounds, %d with the writer interrupted mid-write, %d torn reads accepted, latest value %s\n",
+                ROUNDS, interrupted.load(), torn, latest ? "ok" : "wrong");
+    return torn + int(!latest);
+}
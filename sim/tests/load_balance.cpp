@@ -0,0 +1,43 @@
+// checks that a motor group balances its load without the program reading its telemetry, and that the total output
+// of the group stays the same when a trim is at its limit. One of three free spinning motors runs hot, so the group
+// trims it down to the maximum trim and trims the others up. A free spinning motor turns at a velocity proportional to
+// its voltage, so the velocities show the trims. The exit code is the number of checks which failed
+#include "hardware/hardware.hpp"
+#include "pros/rtos.hpp"
+#include "sim/Sim.hpp"
+#include <cmath>
+#include <cstdio>
+
+int main() {
+    constexpr uint8_t PORTS[] = {1, 2, 3};
+    for (uint8_t port : PORTS) {
+        lemlib::sim::addMotor(port);
+        lemlib::sim::setMotorTemperature(port, units::from_celsius(30));
+    }
+    lemlib::MotorGroup group({1, 2, 3}, 200_rpm);
+
+    // the velocity of every motor with an even share
+    group.move(0.5);
+    pros::delay(2000);
+    double even = 0;
+    for (uint8_t port : PORTS) even += to_rpm(lemlib::sim::getMotorVelocity(port));
+    even /= 3;
+
+    lemlib::sim::setMotorTemperature(1, units::from_celsius(90));
+    group.setLoadBalancing({.enabled = true, .temperatureGain = 0.01, .currentGain = 0, .maxTrim = 0.1});
+    group.move(0.5);
+    pros::delay(2000);
+    group.move(0.5);
+    pros::delay(2000);
+    double velocities[3];
+    for (int i = 0; i < 3; i++) velocities[i] = to_rpm(lemlib::sim::getMotorVelocity(PORTS[i]));
+
+    int failed = 0;
+    // the hot motor is held at the maximum trim, and the others make up for it
+    if (std::abs(velocities[0] / even - 0.9) > 0.01) failed++;
+    if (std::abs(velocities[1] / even - 1.05) > 0.01 || std::abs(velocities[2] / even - 1.05) > 0.01) failed++;
+    if (std::abs((velocities[0] + velocities[1] + velocities[2]) / (3 * even) - 1) > 0.01) failed++;
+    std::printf("even share %.1f rpm, balanced %.1f %.1f %.1f rpm, %d failed\n", even, velocities[0], velocities[1],
+                velocities[2], failed);
+    return failed;
+}
@@ -0,0 +1,127 @@
+// a model of the NEON intrinsics the library uses, so NEON code can be built and run on the host. Each intrinsic works
+// lane by lane the way the Cortex-A9 does: denormal inputs and results are flushed to 0, multiply-accumulates round
+// the product before adding it, and the reciprocal square root estimate follows the lookup of the ARM architecture
+// reference manual, to 8 bits. Only the tests include it, and only with __ARM_NEON defined on the command line
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+struct float32x4_t {
+        float lanes[4];
+};
+
+struct uint32x4_t {
+        uint32_t lanes[4];
+};
+
+namespace neon_model {
+inline float flush(float value) { return std::fpclassify(value) == FP_SUBNORMAL ? std::copysign(0.0f, value) : value; }
+
+template <typename F> float32x4_t map(F&& f) {
+    float32x4_t result;
+    for (int i = 0; i < 4; i++) result.lanes[i] = flush(f(i));
+    return result;
+}
+
+inline uint32_t bits(float value) {
+    uint32_t result;
+    std::memcpy(&result, &value, sizeof(result));
+    return result;
+}
+
+inline float fromBits(uint32_t value) {
+    float result;
+    std::memcpy(&result, &value, sizeof(result));
+    return result;
+}
+
+// RecipSqrtEstimate of the reference manual, on a fixed point value in [0.25, 1) in steps of 1/512
+inline uint32_t recipSqrtEstimate(uint32_t a) {
+    if (a < 256) {
+        a = a * 2 + 1;
+    } else {
+        a = (a >> 1) << 1;
+        a = (a + 1) * 2;
+    }
+    uint32_t b = 512;
+    while (uint64_t(a) * (b + 1) * (b + 1) < (uint64_t(1) << 28)) b++;
+    return (b + 1) / 2;
+}
+
+inline float rsqrtEstimate(float value) {
+    value = flush(value);
+    if (std::isnan(value) || value < 0) return NAN;
+    if (value == 0) return std::copysign(INFINITY, value);
+    if (std::isinf(value)) return 0;
+    const uint32_t raw = bits(value);
+    const uint32_t exponent = raw >> 23;
+    const uint32_t fraction = raw & 0x7fffff;
+    // an even exponent scales the value into [0.5, 1), and an odd one into [0.25, 0.5)
+    const uint32_t scaled = exponent % 2 == 0 ? (0x100 | fraction >> 15) : (0x80 | fraction >> 16);
+    const uint32_t resultExponent = (380 - exponent) / 2;
+    return fromBits(resultExponent << 23 | (recipSqrtEstimate(scaled) & 0xff) << 15);
+}
+} // namespace neon_model
+
+inline float32x4_t vld1q_f32(const float* p) {
+    return neon_model::map([&](int i) { return p[i]; });
+}
+
+inline void vst1q_f32(float* p, float32x4_t v) {
+    for (int i = 0; i < 4; i++) p[i] = v.lanes[i];
+}
+
+inline float32x4_t vdupq_n_f32(float value) {
+    return neon_model::map([&](int) { return value; });
+}
+
+inline float32x4_t vmulq_f32(float32x4_t a, float32x4_t b) {
+    return neon_model::map([&](int i) { return neon_model::flush(a.lanes[i]) * neon_model::flush(b.lanes[i]); });
+}
+
+// a + b * c, with the product rounded first, like VMLA
+inline float32x4_t vmlaq_f32(float32x4_t a, float32x4_t b, float32x4_t c) {
+    const float32x4_t product = vmulq_f32(b, c);
+    return neon_model::map([&](int i) { return neon_model::flush(a.lanes[i]) + product.lanes[i]; });
+}
+
+// a - b * c, with the product rounded first, like VMLS
+inline float32x4_t vmlsq_f32(float32x4_t a, float32x4_t b, float32x4_t c) {
+    const float32x4_t product = vmulq_f32(b, c);
+    return neon_model::map([&](int i) { return neon_model::flush(a.lanes[i]) - product.lanes[i]; });
+}
+
+inline float32x4_t vrsqrteq_f32(float32x4_t v) {
+    return neon_model::map([&](int i) { return neon_model::rsqrtEstimate(v.lanes[i]); });
+}
+
+// (3 - a * b) / 2, the Newton step of the reciprocal square root, where 0 times infinity gives 1.5
+inline float32x4_t vrsqrtsq_f32(float32x4_t a, float32x4_t b) {
+    return neon_model::map([&](int i) {
+        const float x = neon_model::flush(a.lanes[i]);
+        const float y = neon_model::flush(b.lanes[i]);
+        if ((x == 0 && std::isinf(y)) || (std::isinf(x) && y == 0)) return 1.5f;
+        return (3 - neon_model::flush(x * y)) / 2;
+    });
+}
+
+inline uint32x4_t vceqq_f32(float32x4_t a, float32x4_t b) {
+    uint32x4_t result;
+    for (int i = 0; i < 4; i++) {
+        result.lanes[i] = neon_model::flush(a.lanes[i]) == neon_model::flush(b.lanes[i]) ? 0xffffffff : 0;
+    }
+    return result;
+}
+
+// the bits of a where the mask is set, and of b elsewhere
+inline float32x4_t vbslq_f32(uint32x4_t mask, float32x4_t a, float32x4_t b) {
+    float32x4_t result;
+    for (int i = 0; i < 4; i++) {
+        const uint32_t selected = (mask.lanes[i] & neon_model::bits(a.lanes[i])) |
+                                  (~mask.lanes[i] & neon_model::bits(b.lanes[i]));
+        result.lanes[i] = neon_model::fromBits(selected);
+    }
+    return result;
+}
@@ -0,0 +1,59 @@
+// checks that quantities can still be named and used the way they were before dimensions were packed: with a std::ratio
+// for the exponent of each base unit, through the ratio typedefs of a quantity, and with exponents which aren't a
+// multiple of 1/12. Most checks are static, so a regression fails to compile. The exit code is the number of runtime
+// checks which failed
+#include "units/units.hpp"
+#include <cmath>
+#include <cstdio>
+#include <ratio>
+#include <string_view>
+#include <type_traits>
+
+namespace {
+using Zero = std::ratio<0>;
+using One = std::ratio<1>;
+
+// the old spelling names the same types as the named units
+static_assert(std::is_same_v<Named<Quantity<Zero, One>>, Length>);
+static_assert(std::is_same_v<Named<Quantity<Zero, One, std::ratio<-1>>>, LinearVelocity>);
+static_assert(std::is_same_v<Named<Quantity<>>, Number>);
+static_assert(std::is_base_of_v<Quantity<Zero, Zero, One>, Time>);
+static_assert(std::is_same_v<Named<Quantity<Zero, std::ratio<2, 4>>>, Named<Quantity<Zero, std::ratio<1, 2>>>>);
+
+// the ratio typedefs are back, in lowest terms
+static_assert(std::is_same_v<LinearVelocity::length, One>);
+static_assert(std::is_same_v<LinearVelocity::time, std::ratio<-1>>);
+static_assert(std::is_same_v<LinearVelocity::mass, Zero>);
+static_assert(std::is_same_v<Quantity<Zero, std::ratio<3, 6>>::length, std::ratio<1, 2>>);
+
+// exponents which aren't a multiple of 1/12 keep exact units, and come back to the named unit once they add up
+using FifthRootLength = Quantity<Zero, std::ratio<1, 5>>;
+static_assert(std::is_same_v<FifthRootLength::length, std::ratio<1, 5>>);
+static_assert(std::is_same_v<Named<decltype(FifthRootLength(1) * FifthRootLength(1) * FifthRootLength(1) *
+                                            FifthRootLength(1) * FifthRootLength(1))>,
+                             Length>);
+static_assert(std::is_same_v<decltype(units::root<8>(1_m))::length, std::ratio<1, 8>>);
+static_assert(std::is_same_v<decltype(units::pow<8>(units::root<8>(1_m))), Length>);
+static_assert(std::is_same_v<decltype(units::root<8>(1_m) / units::root<8>(1_m)), Number>);
+static_assert(units::UnitSuffix<decltype(units::root<8>(1_m))>::value == "_m^1/8");
+
+// a template of the old spelling, with dependent ratios
+template <typename L> using PerSecond = Quantity<Zero, L, std::ratio<-1>>;
+static_assert(std::is_same_v<Named<PerSecond<One>>, LinearVelocity>);
+static_assert(std::is_same_v<PerSecond<std::ratio<1, 7>>::length, std::ratio<1, 7>>);
+
+// a generic function which reads the exponents of any quantity through its typedefs
+template <isQuantity Q> constexpr double lengthExponent(Q) { return double(Q::length::num) / Q::length::den; }
+} // namespace
+
+int main() {
+    int failed = 0;
+    const Quantity<Zero, One> length = Quantity<Zero, One>(2.5);
+    if (to_m(Length(length)) != 2.5) failed++;
+    const auto root = units::root<8>(from_m(256));
+    if (std::abs(root.internal() - 2) > 1e-12) failed++;
+    if (std::abs(to_m(units::pow<8>(root)) - 256) > 1e-9) failed++;
+    if (lengthExponent(root) != 0.125 || lengthExponent(1_mps) != 1) failed++;
+    std::printf("units compatibility: %d failed\n", failed);
+    return failed;
+}
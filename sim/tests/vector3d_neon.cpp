@@ -0,0 +1,115 @@
+// checks the NEON kernels of Vector3DArray against the scalar kernels they replace on the brain. This file is built
+// with __ARM_NEON defined and tests/neon on the include path, so the NEON loops run through a model of the intrinsics
+// which rounds like the Cortex-A9. Products and sums are rounded the same way in both, so cross, dot and rotate have
+// to match exactly. Magnitudes and normalize use the reciprocal square root estimate and 2 Newton steps instead of a
+// square root, so they only have to match to a few units in the last place. Counts which aren't a multiple of 4
+// check the scalar tail. `make bench` runs the same comparison on the brain. The exit code is the number of checks
+// which failed
+#include "units/Vector3DArray.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#ifndef __ARM_NEON
+#error "this test has to be built with __ARM_NEON defined, see sim/Makefile"
+#endif
+
+namespace {
+using units::detail::Vector3DKernels;
+using units::detail::Vector3DScalarKernels;
+
+// the largest relative error the reciprocal square root is allowed, about 4 units in the last place
+constexpr float TOLERANCE = 5e-7f;
+
+struct Vectors {
+        std::vector<float> x, y, z;
+
+        Vectors(std::size_t count, std::mt19937& random, float scale) : x(count), y(count), z(count) {
+            std::uniform_real_distribution<float> component(-scale, scale);
+            for (std::size_t i = 0; i < count; i++) {
+                x[i] = component(random);
+                y[i] = component(random);
+                z[i] = component(random);
+            }
+        }
+};
+
+int failed = 0;
+
+void check(bool ok, const char* kernel, std::size_t count) {
+    if (ok) return;
+    failed++;
+    std::printf("%s differs from the scalar kernel for %zu vectors\n", kernel, count);
+}
+
+bool same(const std::vector<float>& a, const std::vector<float>& b) { return a == b; }
+
+bool close(const std::vector<float>& a, const std::vector<float>& b) {
+    for (std::size_t i = 0; i < a.size(); i++) {
+        if (std::isnan(a[i]) != std::isnan(b[i])) return false;
+        if (!std::isnan(a[i]) && std::abs(a[i] - b[i]) > TOLERANCE * std::abs(b[i])) return false;
+    }
+    return true;
+}
+
+void checkCount(std::size_t count, std::mt19937& random, float scale) {
+    const Vectors a(count, random, scale);
+    const Vectors b(count, random, scale);
+
+    Vectors neon = a, scalar = a;
+    Vector3DKernels::cross(a.x.data(), a.y.data(), a.z.data(), b.x.data(), b.y.data(), b.z.data(), neon.x.data(),
+                           neon.y.data(), neon.z.data(), count);
+    Vector3DScalarKernels::cross(a.x.data(), a.y.data(), a.z.data(), b.x.data(), b.y.data(), b.z.data(),
+                                 scalar.x.data(), scalar.y.data(), scalar.z.data(), count);
+    check(same(neon.x, scalar.x) && same(neon.y, scalar.y) && same(neon.z, scalar.z), "cross", count);
+    // the output may alias an input
+    neon = a;
+    Vector3DKernels::cross(neon.x.data(), neon.y.data(), neon.z.data(), b.x.data(), b.y.data(), b.z.data(),
+                           neon.x.data(), neon.y.data(), neon.z.data(), count);
+    check(same(neon.x, scalar.x) && same(neon.y, scalar.y) && same(neon.z, scalar.z), "cross in place", count);
+
+    std::vector<float> neonOut(count), scalarOut(count);
+    Vector3DKernels::dot(a.x.data(), a.y.data(), a.z.data(), b.x.data(), b.y.data(), b.z.data(), neonOut.data(),
+                         count);
+    Vector3DScalarKernels::dot(a.x.data(), a.y.data(), a.z.data(), b.x.data(), b.y.data(), b.z.data(),
+                               scalarOut.data(), count);
+    check(same(neonOut, scalarOut), "dot", count);
+
+    Vector3DKernels::magnitudes(a.x.data(), a.y.data(), a.z.data(), neonOut.data(), count);
+    Vector3DScalarKernels::magnitudes(a.x.data(), a.y.data(), a.z.data(), scalarOut.data(), count);
+    check(close(neonOut, scalarOut), "magnitudes", count);
+
+    neon = a, scalar = a;
+    Vector3DKernels::normalize(neon.x.data(), neon.y.data(), neon.z.data(), count);
+    Vector3DScalarKernels::normalize(scalar.x.data(), scalar.y.data(), scalar.z.data(), count);
+    check(close(neon.x, scalar.x) && close(neon.y, scalar.y) && close(neon.z, scalar.z), "normalize", count);
+
+    const units::Quaternion rotation = units::Quaternion::fromEuler(10_stDeg, -20_stDeg, 30_stDeg);
+    neon = a, scalar = a;
+    Vector3DKernels::rotate(neon.x.data(), neon.y.data(), neon.z.data(), count, rotation);
+    Vector3DScalarKernels::rotate(scalar.x.data(), scalar.y.data(), scalar.z.data(), count, rotation);
+    check(same(neon.x, scalar.x) && same(neon.y, scalar.y) && same(neon.z, scalar.z), "rotate", count);
+}
+
+// a vector of 0 has a magnitude of 0 and normalizes to NaN in both, even though NEON computes it from infinity
+void checkZero() {
+    std::vector<float> x(4, 0), y(4, 0), z(4, 0), out(4, 1);
+    Vector3DKernels::magnitudes(x.data(), y.data(), z.data(), out.data(), 4);
+    check(out == std::vector<float>(4, 0), "magnitudes of 0", 4);
+    Vector3DKernels::normalize(x.data(), y.data(), z.data(), 4);
+    check(std::isnan(x[0]) && std::isnan(y[3]) && std::isnan(z[2]), "normalize of 0", 4);
+}
+} // namespace
+
+int main() {
+    std::mt19937 random(143);
+    // every tail length, and a batch like an IMU window, at the scale of field geometry and of sensor readings
+    for (std::size_t count = 0; count <= 9; count++) checkCount(count, random, 2);
+    checkCount(1001, random, 2);
+    checkCount(1001, random, 1e4f);
+    checkCount(1001, random, 1e-3f);
+    checkZero();
+    std::printf("NEON kernels of Vector3DArray: %d failed\n", failed);
+    return failed;
+}
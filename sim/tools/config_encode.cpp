@@ -0,0 +1,52 @@
+// encodes a robot configuration written as text into a device config file, which the brain loads without parsing.
+// `./build/tools/config_encode robot.lcfg < robot.txt` reads a record per line from stdin: `ports`, the name and the
+// signed ports, or `numbers`, the name and the numbers, separated by spaces, like
+//     ports drive.left 1 -2 3
+//     numbers imu.scalar 1.0021
+// Blank lines and lines starting with # are skipped. The file is checked like the brain checks it before it is written
+#include "hardware/DeviceConfig.hpp"
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s output.lcfg < config.txt\n", argv[0]);
+        return 1;
+    }
+    std::vector<lemlib::ConfigRecord> records;
+    char line[256];
+    size_t lineNumber = 0;
+    while (std::fgets(line, sizeof(line), stdin) != nullptr) {
+        lineNumber++;
+        const char* type = std::strtok(line, " \t\r\n");
+        if (type == nullptr || type[0] == '#') continue;
+        const char* name = std::strtok(nullptr, " \t\r\n");
+        std::vector<double> values;
+        for (const char* token; (token = std::strtok(nullptr, " \t\r\n")) != nullptr;) {
+            values.push_back(std::atof(token));
+        }
+        lemlib::ConfigRecord record;
+        int32_t result = INT_MAX;
+        if (name != nullptr && std::strcmp(type, "numbers") == 0) {
+            result = lemlib::makeConfigRecord(record, name, values);
+        } else if (name != nullptr && std::strcmp(type, "ports") == 0) {
+            std::vector<lemlib::ReversibleSmartPort> ports;
+            for (const double value : values) ports.emplace_back(int64_t(value), lemlib::runtime_check_port);
+            result = lemlib::makeConfigRecord(record, name, ports);
+        }
+        if (result == INT_MAX) {
+            std::fprintf(stderr, "invalid record on line %zu\n", lineNumber);
+            return 1;
+        }
+        records.push_back(record);
+    }
+    if (lemlib::saveDeviceConfig(argv[1], records) == INT_MAX) {
+        std::perror(argv[1]);
+        return 1;
+    }
+    std::fprintf(stderr, "wrote %zu records, %zu bytes\n", records.size(),
+                 16 + records.size() * sizeof(lemlib::ConfigRecord));
+}
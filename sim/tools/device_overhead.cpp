@@ -0,0 +1,67 @@
+// measures how much of the cost of reading an encoder or an IMU is the virtual call, and how much is the SDK.
+// `./build/tools/device_overhead` reads a mock device through its own type, where the read is inlined, through the
+// Encoder or IMU interface, which adds only the virtual call, and a simulated device through its own type and through
+// the interface, which adds the SDK call, and prints the time per read of each
+#include "hardware/Encoder/MockEncoder.hpp"
+#include "hardware/Encoder/V5RotationSensor.hpp"
+#include "hardware/IMU/MockIMU.hpp"
+#include "hardware/IMU/V5InertialSensor.hpp"
+#include "sim/Sim.hpp"
+#include <chrono>
+#include <cstdio>
+
+namespace {
+constexpr int READS = 10000000;
+
+template <typename F> void measure(const char* name, F&& read) {
+    double sum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < READS; i++) sum += read(i);
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    // the sum is printed so the reads can't be optimized out
+    std::printf("%-32s %7.2f ns per read (%g)\n", name, elapsed.count() / READS, sum);
+}
+
+// the reads through a device's own type go through these, like odometry templated on the device would
+template <lemlib::EncoderLike E> double readAngle(const E& encoder) { return to_stDeg(encoder.getAngle()); }
+
+template <lemlib::IMULike I> double readRotation(const I& imu) { return to_stDeg(imu.getRotation()); }
+} // namespace
+
+int main() {
+    constexpr uint8_t ENCODER_PORT = 1;
+    constexpr uint8_t IMU_PORT = 2;
+    lemlib::sim::addRotationSensor(ENCODER_PORT);
+    lemlib::sim::addIMU(IMU_PORT);
+
+    lemlib::MockEncoder mockEncoder;
+    lemlib::V5RotationSensor rotationSensor(ENCODER_PORT);
+    // the interfaces are read through volatile pointers, so the compiler can't see the type and devirtualize the calls
+    lemlib::Encoder* volatile mockEncoderInterface = &mockEncoder;
+    lemlib::Encoder* volatile rotationSensorInterface = &rotationSensor;
+    measure("mock encoder", [&](int i) {
+        mockEncoder.setReading(from_stDeg(i));
+        return readAngle(mockEncoder);
+    });
+    measure("mock encoder through Encoder", [&](int i) {
+        mockEncoder.setReading(from_stDeg(i));
+        return to_stDeg(mockEncoderInterface->getAngle());
+    });
+    measure("rotation sensor", [&](int) { return readAngle(rotationSensor); });
+    measure("rotation sensor through Encoder", [&](int) { return to_stDeg(rotationSensorInterface->getAngle()); });
+
+    lemlib::MockIMU mockIMU;
+    lemlib::V5InertialSensor inertialSensor(IMU_PORT);
+    lemlib::IMU* volatile mockIMUInterface = &mockIMU;
+    lemlib::IMU* volatile inertialSensorInterface = &inertialSensor;
+    measure("mock imu", [&](int i) {
+        mockIMU.setReading(i);
+        return readRotation(mockIMU);
+    });
+    measure("mock imu through IMU", [&](int i) {
+        mockIMU.setReading(i);
+        return to_stDeg(mockIMUInterface->getRotation());
+    });
+    measure("inertial sensor", [&](int) { return readRotation(inertialSensor); });
+    measure("inertial sensor through IMU", [&](int) { return to_stDeg(inertialSensorInterface->getRotation()); });
+}
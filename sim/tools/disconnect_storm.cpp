@@ -0,0 +1,122 @@
+// stresses the reconnect handling of MotorGroup by unplugging and plugging its motors at random, far more often than a
+// failing cable does, and measures what it costs the calls a control loop makes.
+// `./build/tools/disconnect_storm` runs a group of four motors for 60 simulated seconds, with every motor toggled 20
+// times a second on average, and calls move and getAngle every millisecond. Optional arguments set the duration in
+// seconds, the toggles per motor per second and the seed, like `disconnect_storm 120 50 7`.
+//
+// It prints the host time per call of move and getAngle, the longest time the group went without using a motor which
+// was plugged in, the getAngle calls which failed while a motor was plugged in, and the heap allocations made during
+// the storm, which are only counted when built with `make TRACK_ALLOCATIONS=1`
+#include "hardware/AllocationTracker.hpp"
+#include "hardware/Motor/MotorGroup.hpp"
+#include "pros/rtos.hpp"
+#include "sim/Sim.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+constexpr std::array<uint8_t, 4> PORTS = {1, 2, 3, 4};
+
+/**
+ * @brief Print the distribution of the host time of a call
+ *
+ * @param name the name of the call
+ * @param samples the time of every call, in nanoseconds. They are sorted
+ */
+void report(const char* name, std::vector<double>& samples) {
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (const double sample : samples) sum += sample;
+    const auto percentile = [&](double p) { return samples[std::min(samples.size() - 1, size_t(p * samples.size()))]; };
+    std::printf("%-9s mean %8.0f ns  p50 %8.0f ns  p99 %8.0f ns  p99.9 %8.0f ns  max %8.0f ns\n", name,
+                sum / samples.size(), percentile(0.5), percentile(0.99), percentile(0.999), samples.back());
+}
+
+/**
+ * @brief Run a call, and record how long it took
+ *
+ * @param samples the time of every call, in nanoseconds
+ * @param call the call
+ * @return the result of the call
+ */
+template <typename F> auto timed(std::vector<double>& samples, F&& call) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto result = call();
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    samples.push_back(elapsed.count());
+    return result;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const double duration = argc > 1 ? std::atof(argv[1]) : 60;
+    const double toggleRate = argc > 2 ? std::atof(argv[2]) : 20;
+    const unsigned seed = argc > 3 ? std::atoi(argv[3]) : 1;
+    if (!(duration > 0) || !(toggleRate >= 0)) {
+        std::fprintf(stderr, "usage: disconnect_storm [seconds] [toggles per motor per second] [seed]\n");
+        return 1;
+    }
+    for (const uint8_t port : PORTS) lemlib::sim::addMotor(port);
+    lemlib::MotorGroup group({1, -2, 3, -4}, 600_rpm);
+    group.setCurrentLimit(8_amp);
+    // the first calls configure the motors and start the maintenance task, which isn't part of the storm
+    group.move(0.5);
+    pros::delay(20);
+
+    const size_t ticks = std::llround(duration * 1000);
+    std::vector<double> moveTimes;
+    std::vector<double> angleTimes;
+    moveTimes.reserve(ticks);
+    angleTimes.reserve(ticks);
+    std::mt19937 random(seed);
+    // the chance a motor is toggled in a tick of 1 ms
+    std::bernoulli_distribution toggle(std::min(1.0, toggleRate / 1000));
+    std::array<bool, PORTS.size()> plugged;
+    plugged.fill(true);
+    std::array<Angle, PORTS.size()> angles {0_stDeg, 0_stDeg, 0_stDeg, 0_stDeg};
+    uint32_t toggles = 0;
+    uint32_t failedReads = 0;
+    uint32_t degradedTicks = 0;
+    uint32_t longestDegraded = 0;
+
+    const lemlib::AllocationStats before = lemlib::getAllocationStats();
+    for (size_t tick = 0; tick < ticks; tick++) {
+        for (size_t i = 0; i < PORTS.size(); i++) {
+            if (!toggle(random)) continue;
+            plugged[i] = !plugged[i];
+            if (plugged[i]) lemlib::sim::plug(PORTS[i]);
+            else lemlib::sim::unplug(PORTS[i]);
+            toggles++;
+        }
+        const size_t pluggedCount = std::count(plugged.begin(), plugged.end(), true);
+        timed(moveTimes, [&] { return group.move(0.5); });
+        const Angle angle = timed(angleTimes, [&] { return group.getAngle(); });
+        if (pluggedCount > 0 && !std::isfinite(to_stDeg(angle))) failedReads++;
+        // a motor which is plugged in but not used by the group is still being recovered
+        const size_t used = std::max(0, group.getAngles(angles));
+        degradedTicks = used < pluggedCount ? degradedTicks + 1 : 0;
+        longestDegraded = std::max(longestDegraded, degradedTicks);
+        pros::delay(1);
+    }
+    const lemlib::AllocationStats after = lemlib::getAllocationStats();
+
+    std::printf("%u toggles of %zu motors over %g s\n", toggles, PORTS.size(), duration);
+    report("move", moveTimes);
+    report("getAngle", angleTimes);
+    std::printf("longest recovery %u ms, %u failed reads with a motor plugged in\n", longestDegraded, failedReads);
+    if (lemlib::isTrackingAllocations()) {
+        std::printf("%u allocations, %llu bytes during the storm\n", after.allocations - before.allocations,
+                    (unsigned long long)(after.bytes - before.bytes));
+    } else {
+        std::printf("allocations not tracked, build with `make TRACK_ALLOCATIONS=1`\n");
+    }
+    std::fflush(stdout);
+    // the maintenance task is still running, and is never joined
+    std::_Exit(0);
+}
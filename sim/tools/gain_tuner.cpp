@@ -0,0 +1,176 @@
+// tunes the gains of a VelocityController against targets logged in a match, by replaying them on a simulated motor
+// group thousands of times with different gains.
+// `./build/tools/gain_tuner 600 < targets.csv` reads a line per target from stdin, with the time in seconds and the
+// target velocity in rpm separated by a comma, and tunes a group of two motors with an output velocity of 600 rpm.
+// Optional arguments set the number of generations, the gains tried per generation and the number of workers, like
+// `gain_tuner 600 30 64 8`. Each trial is scored by the integral of the squared velocity error, in rpm^2 s.
+//
+// The simulator and the device registry are global to a process, so every worker is a forked process with its own
+// simulated world. The trials of a generation are kept in shared memory, and each worker takes the next trial which
+// hasn't been taken until there are none left, so a worker which draws short trials takes more of them
+#include "hardware/Motor/MotorGroup.hpp"
+#include "hardware/Motor/VelocityController.hpp"
+#include "pros/rtos.hpp"
+#include "sim/Sim.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+struct Target {
+        double time;
+        double rpm;
+};
+
+struct Trial {
+        lemlib::VelocityControllerGains gains;
+        double cost;
+};
+
+// lives in memory shared by every worker, followed by the trials
+struct Generation {
+        std::atomic<size_t> next;
+        size_t size;
+        Trial* trials;
+};
+
+/**
+ * @brief Replay the targets on a simulated motor group with a set of gains
+ *
+ * @param targets the targets, in order of time
+ * @param outputVelocity the output velocity of the group
+ * @param gains the gains
+ * @return double the integral of the squared velocity error, in rpm^2 s
+ */
+double evaluate(const std::vector<Target>& targets, AngularVelocity outputVelocity,
+                const lemlib::VelocityControllerGains& gains) {
+    // adding the motors again puts them back at rest
+    lemlib::sim::addMotor(1);
+    lemlib::sim::addMotor(2);
+    lemlib::MotorGroup group({1, -2}, outputVelocity);
+    lemlib::VelocityController controller(group, gains);
+    controller.start();
+    const double start = to_sec(lemlib::sim::getTime());
+    double cost = 0;
+    for (size_t i = 0; i < targets.size(); i++) {
+        const double end = i + 1 < targets.size() ? targets[i + 1].time : targets[i].time + 0.5;
+        const double acceleration =
+            i + 1 < targets.size() ? (targets[i + 1].rpm - targets[i].rpm) / (end - targets[i].time) : 0;
+        controller.setTarget(from_rpm(targets[i].rpm), from_rpm(acceleration) / 1_sec);
+        // the error is measured every 10 ms, like the controller runs
+        while (to_sec(lemlib::sim::getTime()) - start < end) {
+            pros::delay(10);
+            const double error = targets[i].rpm - to_rpm(group.getVelocity());
+            cost += error * error * 0.01;
+        }
+    }
+    controller.stop();
+    return std::isfinite(cost) ? cost : INFINITY;
+}
+
+/**
+ * @brief Run a generation of trials, in parallel
+ *
+ * @param generation the trials, in shared memory
+ * @param workers the number of worker processes
+ * @param targets the targets
+ * @param outputVelocity the output velocity of the group
+ */
+void run(Generation& generation, size_t workers, const std::vector<Target>& targets, AngularVelocity outputVelocity) {
+    generation.next = 0;
+    std::vector<pid_t> children;
+    for (size_t i = 0; i < workers; i++) {
+        const pid_t pid = fork();
+        if (pid == 0) {
+            for (size_t trial = generation.next++; trial < generation.size; trial = generation.next++) {
+                generation.trials[trial].cost = evaluate(targets, outputVelocity, generation.trials[trial].gains);
+            }
+            // the simulated tasks are still blocked, so the worker exits without running destructors
+            std::fflush(stdout);
+            _exit(0);
+        }
+        if (pid > 0) children.push_back(pid);
+    }
+    for (pid_t child : children) waitpid(child, nullptr, 0);
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 5) {
+        std::fprintf(stderr, "usage: %s outputVelocity [generations [population [workers]]] < targets.csv\n",
+                     argv[0]);
+        return 1;
+    }
+    const double outputRpm = std::atof(argv[1]);
+    const size_t generations = argc > 2 ? std::atoi(argv[2]) : 20;
+    const size_t population = argc > 3 ? std::atoi(argv[3]) : 64;
+    const size_t workers = argc > 4 ? std::atoi(argv[4]) : std::max(1u, std::thread::hardware_concurrency());
+    if (!(outputRpm > 0) || generations == 0 || population < 2 || workers == 0) {
+        std::fprintf(stderr, "the output velocity, generations, population and workers must be positive\n");
+        return 1;
+    }
+    const AngularVelocity outputVelocity = from_rpm(outputRpm);
+
+    std::vector<Target> targets;
+    char line[256];
+    while (std::fgets(line, sizeof(line), stdin) != nullptr) {
+        Target target;
+        // blank lines and a header line are skipped
+        if (std::sscanf(line, "%lf,%lf", &target.time, &target.rpm) == 2) targets.push_back(target);
+    }
+    if (targets.empty()) {
+        std::fprintf(stderr, "no targets were read\n");
+        return 1;
+    }
+    std::sort(targets.begin(), targets.end(), [](const Target& a, const Target& b) { return a.time < b.time; });
+
+    const size_t bytes = sizeof(Generation) + population * sizeof(Trial);
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        std::perror("mmap");
+        return 1;
+    }
+    // the memory is mapped before forking, so the trials are at the same address in every worker
+    Generation& generation = *new (memory) Generation {
+        .next = 0, .size = population, .trials = reinterpret_cast<Trial*>(static_cast<Generation*>(memory) + 1)};
+
+    // start from a feedforward which reaches the output velocity at full power, and a small PID
+    Trial best {.gains = {.kS = 0.01, .kV = 1 / outputRpm, .kA = 0.05 / outputRpm, .kP = 0.001, .kI = 0.0001,
+                          .kD = 0.00001},
+                .cost = INFINITY};
+    std::mt19937 random(1);
+    std::normal_distribution<double> normal;
+    // every gain is multiplied by a log-normal factor, so gains of every scale are searched alike
+    double spread = 1;
+    for (size_t g = 0; g < generations; g++) {
+        generation.trials[0] = best;
+        for (size_t i = 1; i < population; i++) {
+            lemlib::VelocityControllerGains gains = best.gains;
+            for (double* gain : {&gains.kS, &gains.kV, &gains.kA, &gains.kP, &gains.kI, &gains.kD}) {
+                *gain *= std::exp(spread * normal(random));
+            }
+            generation.trials[i] = {.gains = gains, .cost = INFINITY};
+        }
+        run(generation, std::min(workers, population), targets, outputVelocity);
+        const Trial* winner = std::min_element(generation.trials, generation.trials + population,
+                                               [](const Trial& a, const Trial& b) { return a.cost < b.cost; });
+        // the search narrows down once it stops improving
+        if (!(winner->cost < best.cost)) spread *= 0.6;
+        else best = *winner;
+        std::fprintf(stderr, "generation %zu: cost %.1f rpm^2 s\n", g + 1, best.cost);
+    }
+    std::printf("{.kS = %g, .kV = %g, .kA = %g, .kP = %g, .kI = %g, .kD = %g}\n", best.gains.kS, best.gains.kV,
+                best.gains.kA, best.gains.kP, best.gains.kI, best.gains.kD);
+    std::fflush(stdout);
+    // the motor group maintenance task of the simulator is still running, so skip the destructors
+    _exit(0);
+}
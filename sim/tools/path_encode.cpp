@@ -0,0 +1,53 @@
+// encodes a path generated offline into a path file, which the brain loads without parsing anything.
+// `./build/tools/path_encode auton.lpth < auton.csv` reads a line per point from stdin, with the x and y position in
+// meters, the velocity in meters per second and the curvature in radians per meter, separated by commas.
+// `./build/tools/path_encode auton.lpth 1.5 3 2 < auton.csv` calculates the curvatures and velocities instead, with a
+// maximum velocity of 1.5 m/s, acceleration of 3 m/s^2 and lateral acceleration of 2 m/s^2, so only positions are
+// needed
+#include "hardware/Motion/PathProfile.hpp"
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+int main(int argc, char** argv) {
+    if (argc != 2 && argc != 5) {
+        std::fprintf(stderr, "usage: %s output.lpth [maxVelocity maxAcceleration maxLateralAcceleration] < path.csv\n",
+                     argv[0]);
+        return 1;
+    }
+    std::vector<lemlib::PathSample> samples;
+    char line[256];
+    size_t lineNumber = 0;
+    while (std::fgets(line, sizeof(line), stdin) != nullptr) {
+        lineNumber++;
+        double x, y, velocity = 0, curvature = 0;
+        // blank lines and a header line are skipped
+        if (std::sscanf(line, "%lf,%lf,%lf,%lf", &x, &y, &velocity, &curvature) < 2) {
+            const bool blank = line[std::strspn(line, " \t\r\n")] == '\0';
+            if (!blank && lineNumber > 1) std::fprintf(stderr, "skipped line %zu\n", lineNumber);
+            continue;
+        }
+        samples.push_back({.position = units::V2Position(from_m(x), from_m(y)),
+                           .velocity = from_mps(velocity),
+                           .curvature = from_radpm(curvature)});
+    }
+    if (argc == 5) {
+        const lemlib::PathConstraints constraints {.maxVelocity = from_mps(std::atof(argv[2])),
+                                                   .maxAcceleration = from_mps2(std::atof(argv[3])),
+                                                   .maxLateralAcceleration = from_mps2(std::atof(argv[4]))};
+        if (lemlib::profilePath(samples, constraints) == INT_MAX) {
+            std::perror("profilePath");
+            return 1;
+        }
+    }
+    std::vector<lemlib::PathRecord> records;
+    for (const lemlib::PathSample& sample : samples) records.push_back(lemlib::encodePathSample(sample));
+    if (lemlib::savePath(argv[1], records) == INT_MAX) {
+        std::perror(argv[1]);
+        return 1;
+    }
+    std::fprintf(stderr, "wrote %zu points, %zu bytes\n", records.size(),
+                 16 + records.size() * sizeof(lemlib::PathRecord));
+}
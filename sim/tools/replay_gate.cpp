@@ -0,0 +1,101 @@
+// replays recorded match logs through odometry, a RAMSETE controller and a simulated drive, and fails if the commands
+// drifted from their baselines or a stage got slower. `./build/tools/replay_gate logs/qual12 logs/skills` replays
+// logs/qual12.bin, tracking the trajectory in logs/qual12.lpth if there is one, and compares the run with
+// logs/qual12.base, and the same for every other log. Runs are deterministic, so the same logs on the same code always
+// produce the same commands. `--update` saves every run as its baseline instead, after a change which is meant to
+// change the commands. `--ids=3,4,5` sets the ids the left and right tracking wheels and the IMU were logged with,
+// which default to 1, 2 and 3. The exit code is the number of logs which failed
+#include "hardware/Motion/PathFile.hpp"
+#include "hardware/ReplayGate.hpp"
+#include "sim/Sim.hpp"
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr uint8_t LEFT_PORT = 1;
+constexpr uint8_t RIGHT_PORT = 2;
+// the most records a trajectory can have
+constexpr size_t MAX_RECORDS = 8192;
+
+// load the trajectory of a log, or a single point at rest if it has none
+std::vector<lemlib::PathSample> loadTrajectory(const std::string& path) {
+    static std::vector<lemlib::PathRecord> records(MAX_RECORDS);
+    const int32_t count = lemlib::loadPath(path.c_str(), records);
+    if (count == INT_MAX) return {lemlib::PathSample()};
+    std::vector<lemlib::PathSample> samples;
+    for (int32_t i = 0; i < count; i++) samples.push_back(lemlib::decodePathRecord(records[i]));
+    if (samples.empty()) samples.emplace_back();
+    return samples;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    bool update = false;
+    lemlib::ReplayRobot robot;
+    std::vector<const char*> logs;
+    for (int i = 1; i < argc; i++) {
+        unsigned left, right, imu;
+        if (std::strcmp(argv[i], "--update") == 0) {
+            update = true;
+        } else if (std::sscanf(argv[i], "--ids=%u,%u,%u", &left, &right, &imu) == 3) {
+            robot.leftEncoder = left;
+            robot.rightEncoder = right;
+            robot.imu = imu;
+        } else {
+            logs.push_back(argv[i]);
+        }
+    }
+    if (logs.empty()) {
+        std::fprintf(stderr, "usage: %s [--update] [--ids=left,right,imu] log...\n", argv[0]);
+        return 1;
+    }
+    lemlib::sim::addMotor(LEFT_PORT);
+    lemlib::sim::addMotor(RIGHT_PORT);
+    lemlib::DifferentialDrive drive({LEFT_PORT}, {RIGHT_PORT}, 450_rpm);
+
+    int failed = 0;
+    for (const char* name : logs) {
+        const std::string stem = name;
+        lemlib::ReplayLog log;
+        if (log.load((stem + ".bin").c_str()) != 0) {
+            std::printf("%s: could not load the log (%s)\n", name, std::strerror(errno));
+            failed++;
+            continue;
+        }
+        const std::vector<lemlib::PathSample> trajectory = loadTrajectory(stem + ".lpth");
+        lemlib::ReplayGate gate(log, trajectory, robot, &drive);
+        const int32_t steps = gate.run();
+        if (steps == INT_MAX) {
+            std::printf("%s: could not replay the log (%s)\n", name, std::strerror(errno));
+            failed++;
+            continue;
+        }
+        gate.print(name);
+        const std::string baseline = stem + ".base";
+        if (update) {
+            if (gate.saveBaseline(baseline.c_str()) != 0) {
+                std::printf("%s: could not save the baseline (%s)\n", name, std::strerror(errno));
+                failed++;
+            } else {
+                std::printf("%s: saved %d steps\n", name, int(steps));
+            }
+            continue;
+        }
+        lemlib::ReplayReport report;
+        const int32_t result = gate.compare(baseline.c_str(), {}, &report);
+        if (result != 0 && errno != ERANGE && errno != ETIMEDOUT) {
+            std::printf("%s: could not compare with the baseline (%s)\n", name, std::strerror(errno));
+            failed++;
+            continue;
+        }
+        std::printf("%s: %s, position %.4f in, orientation %.4f deg, command %.5f m/s, slowdown %.2f %.2f %.2f\n", name,
+                    report.passed ? "passed" : "FAILED", to_in(report.position), to_stDeg(report.orientation),
+                    to_mps(report.command), report.slowdown[0], report.slowdown[1], report.slowdown[2]);
+        if (!report.passed) failed++;
+    }
+    return failed;
+}
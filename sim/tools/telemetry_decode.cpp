@@ -0,0 +1,29 @@
+// decodes a telemetry stream read from stdin, like a serial port or a capture of one, and prints it as csv.
+// `./build/tools/telemetry_decode < /dev/ttyACM1` prints a line per frame, with values in SI units
+#include "hardware/TelemetryStream.hpp"
+#include <cmath>
+#include <cstdio>
+
+int main() {
+    lemlib::TelemetryStreamDecoder decoder;
+    int byte;
+    while ((byte = std::getchar()) != EOF) {
+        const int32_t type = decoder.push(byte);
+        if (type == int32_t(lemlib::StreamFrameType::SCHEMA)) {
+            // the header is printed again whenever the schema is, since channels may have been added
+            std::printf("timestamp_us");
+            for (size_t i = 0; i < decoder.getChannelCount(); i++) std::printf(",%s", decoder.getName(i));
+            std::printf("\n");
+        } else if (type == int32_t(lemlib::StreamFrameType::KEY) || type == int32_t(lemlib::StreamFrameType::DELTA)) {
+            std::printf("%u", decoder.getTimestamp());
+            // missing values are left empty
+            for (size_t i = 0; i < decoder.getChannelCount(); i++) {
+                const double value = decoder.getValue(i);
+                if (value == INFINITY) std::printf(",");
+                else std::printf(",%.9g", value);
+            }
+            std::printf("\n");
+        }
+    }
+    std::fprintf(stderr, "%u frames lost or malformed\n", decoder.getErrors());
+}
@@ -0,0 +1,269 @@
+// records the telemetry streams of several robots at once into column files, and shows their latest values live.
+// `./build/tools/telemetry_record practice/ left=/dev/ttyACM1 right=/dev/ttyACM3` reads each stream, like a serial port
+// or a capture of one, on its own thread, and writes practice/left.ltc and practice/right.ltc. It stops at the end of
+// every input, or on ctrl-c. While it runs, and stderr is a terminal, the frame rate, the data rate, the frames lost
+// and the first values of every stream are redrawn once a second.
+//
+// Frames are decoded straight out of the read buffer, and every frame becomes a row of per-channel columns, which are
+// written as a block once BLOCK_ROWS rows are buffered, or the stream ends. A column file is a sequence of blocks, in
+// host byte order, which can be memory mapped and read without parsing, like with numpy.memmap:
+//     char magic[4]                        "LTCB"
+//     uint32_t channels, rows, reserved
+//     char names[channels][32]             0 terminated
+//     uint32_t timestamps[rows]            in microseconds, padded with a 0 when rows is odd, so values are aligned
+//     double values[channels][rows]        in SI units, a column per channel. Missing values are NaN
+// A block holds the schema it was recorded with, so a schema which changes starts a new block
+#include "hardware/DoubleBuffer.hpp"
+#include "hardware/TelemetryStream.hpp"
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+constexpr size_t BLOCK_ROWS = 4096;
+constexpr size_t NAME_SIZE = lemlib::TelemetryStream::MAX_NAME_LENGTH + 1;
+constexpr size_t READ_SIZE = 65536;
+// the dashboard shows at most this many values of each stream
+constexpr size_t SHOWN_CHANNELS = 4;
+
+std::atomic<bool> g_stop = false;
+
+using Names = std::array<std::array<char, NAME_SIZE>, lemlib::TelemetryStream::MAX_CHANNELS>;
+
+// the latest row of a stream, published for the dashboard without locking the reader
+struct Latest {
+        size_t channels = 0;
+        uint32_t timestamp = 0;
+        Names names {};
+        std::array<double, lemlib::TelemetryStream::MAX_CHANNELS> values {};
+};
+
+struct Recording {
+        std::string name;
+        std::string input;
+        std::string output;
+        std::atomic<uint32_t> frames = 0;
+        std::atomic<uint64_t> bytes = 0;
+        std::atomic<uint32_t> errors = 0;
+        std::atomic<bool> done = false;
+        lemlib::DoubleBuffer<Latest> latest;
+        std::string result;
+};
+
+/**
+ * @brief Buffers the rows of a stream in columns, and writes them to the column file a block at a time
+ */
+class ColumnWriter {
+    public:
+        explicit ColumnWriter(FILE* file)
+            : m_file(file) {}
+
+        /**
+         * @brief Start a new schema, writing the rows of the previous one first
+         *
+         * @param decoder the decoder which just decoded a schema frame
+         */
+        void setSchema(const lemlib::TelemetryStreamDecoder& decoder) {
+            Names names {};
+            const size_t channels = decoder.getChannelCount();
+            for (size_t i = 0; i < channels; i++) std::strncpy(names[i].data(), decoder.getName(i), NAME_SIZE - 1);
+            // a stream sends its schema again every few seconds, which only starts a new block if it changed
+            if (channels == m_channels && names == m_names) return;
+            flush();
+            m_channels = channels;
+            m_names = names;
+            for (size_t i = 0; i < channels; i++) m_columns[i].reserve(BLOCK_ROWS);
+        }
+
+        /**
+         * @brief Add the row of the frame the decoder just decoded
+         *
+         * @param decoder the decoder
+         */
+        void addRow(const lemlib::TelemetryStreamDecoder& decoder) {
+            m_timestamps.push_back(decoder.getTimestamp());
+            for (size_t i = 0; i < m_channels; i++) {
+                const double value = decoder.getValue(i);
+                m_columns[i].push_back(value == INFINITY ? NAN : value);
+            }
+            if (m_timestamps.size() == BLOCK_ROWS) flush();
+        }
+
+        /**
+         * @brief Write the buffered rows as a block
+         *
+         * @return true the block was written, or there were no rows
+         * @return false the file could not be written
+         */
+        bool flush() {
+            const uint32_t rows = m_timestamps.size();
+            if (rows == 0) return true;
+            const uint32_t header[4] = {0x4243544c, uint32_t(m_channels), rows, 0};
+            bool ok = std::fwrite(header, sizeof(header), 1, m_file) == 1;
+            for (size_t i = 0; i < m_channels; i++) ok &= std::fwrite(m_names[i].data(), NAME_SIZE, 1, m_file) == 1;
+            if (rows % 2 != 0) m_timestamps.push_back(0);
+            ok &= std::fwrite(m_timestamps.data(), sizeof(uint32_t), m_timestamps.size(), m_file) ==
+                  m_timestamps.size();
+            for (size_t i = 0; i < m_channels; i++) {
+                ok &= std::fwrite(m_columns[i].data(), sizeof(double), rows, m_file) == rows;
+                m_columns[i].clear();
+            }
+            m_timestamps.clear();
+            return ok;
+        }
+    private:
+        FILE* m_file;
+        size_t m_channels = 0;
+        Names m_names {};
+        std::vector<uint32_t> m_timestamps;
+        std::array<std::vector<double>, lemlib::TelemetryStream::MAX_CHANNELS> m_columns;
+};
+
+/**
+ * @brief Record a stream until it ends or the recorder is stopped
+ *
+ * @param recording the stream. Its result is set to a line describing what was recorded, or what failed
+ */
+void record(Recording& recording) {
+    const int input = open(recording.input.c_str(), O_RDONLY);
+    FILE* output = std::fopen(recording.output.c_str(), "wb");
+    if (input < 0 || output == nullptr) {
+        recording.result = recording.name + ": could not open " + (input < 0 ? recording.input : recording.output);
+        if (input >= 0) close(input);
+        if (output != nullptr) std::fclose(output);
+        recording.done = true;
+        return;
+    }
+    lemlib::TelemetryStreamDecoder decoder;
+    ColumnWriter writer(output);
+    Latest latest;
+    // a frame which didn't end in the last read is moved to the start, so every frame is contiguous in the buffer
+    std::vector<uint8_t> buffer(READ_SIZE + lemlib::TelemetryStream::MAX_FRAME_SIZE);
+    size_t kept = 0;
+    while (!g_stop) {
+        // waits with a timeout, so a serial port which went quiet still notices ctrl-c
+        pollfd fd {.fd = input, .events = POLLIN, .revents = 0};
+        if (poll(&fd, 1, 100) == 0) continue;
+        const ssize_t count = read(input, buffer.data() + kept, READ_SIZE);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) break;
+        recording.bytes += count;
+        const uint8_t* start = buffer.data();
+        const uint8_t* const end = buffer.data() + kept + count;
+        const uint8_t* delimiter;
+        while ((delimiter = static_cast<const uint8_t*>(std::memchr(start, 0, end - start))) != nullptr) {
+            // two 0 bytes in a row end an empty frame, which is skipped
+            const int32_t type = delimiter == start ? 0 : decoder.decode(std::span(start, delimiter));
+            start = delimiter + 1;
+            if (type == int32_t(lemlib::StreamFrameType::SCHEMA)) {
+                writer.setSchema(decoder);
+                latest.channels = decoder.getChannelCount();
+                for (size_t i = 0; i < latest.channels; i++)
+                    std::strncpy(latest.names[i].data(), decoder.getName(i), NAME_SIZE - 1);
+            } else if (type == int32_t(lemlib::StreamFrameType::KEY) ||
+                       type == int32_t(lemlib::StreamFrameType::DELTA)) {
+                writer.addRow(decoder);
+                // the dashboard only needs the latest row now and then
+                if (++recording.frames % 16 == 0) {
+                    latest.timestamp = decoder.getTimestamp();
+                    for (size_t i = 0; i < latest.channels; i++) latest.values[i] = decoder.getValue(i);
+                    recording.latest.write(latest);
+                }
+            }
+        }
+        kept = end - start;
+        // a frame longer than any valid frame is dropped, and the decoder counts it once it ends
+        if (kept > lemlib::TelemetryStream::MAX_FRAME_SIZE) kept = 0;
+        std::memmove(buffer.data(), start, kept);
+        recording.errors = decoder.getErrors();
+    }
+    const bool written = writer.flush();
+    close(input);
+    recording.result = recording.name + ": " + std::to_string(recording.frames) + " frames, " +
+                       std::to_string(decoder.getErrors()) + " lost or malformed" +
+                       (written && std::fclose(output) == 0 ? "" : ", could not write " + recording.output);
+    recording.done = true;
+}
+
+/**
+ * @brief Redraw the rate and the latest values of every stream
+ *
+ * @param recordings the streams
+ * @param lastFrames the number of frames of each stream at the last redraw, which is updated
+ * @param lastBytes the number of bytes of each stream at the last redraw, which is updated
+ */
+void draw(std::vector<Recording>& recordings, std::vector<uint32_t>& lastFrames, std::vector<uint64_t>& lastBytes) {
+    // moves the cursor up over the previous dashboard, and clears it
+    static bool drawn = false;
+    if (drawn) std::fprintf(stderr, "\033[%zuA\033[J", recordings.size());
+    drawn = true;
+    for (size_t i = 0; i < recordings.size(); i++) {
+        Recording& recording = recordings[i];
+        const uint32_t frames = recording.frames;
+        const uint64_t bytes = recording.bytes;
+        const Latest latest = recording.latest.read();
+        std::fprintf(stderr, "%-10s %5u fps %7.1f kB/s %5u lost  t=%8.2fs", recording.name.c_str(),
+                     frames - lastFrames[i], (bytes - lastBytes[i]) / 1000.0, recording.errors.load(),
+                     latest.timestamp / 1e6);
+        for (size_t j = 0; j < std::min(latest.channels, SHOWN_CHANNELS); j++)
+            std::fprintf(stderr, "  %s=%.4g", latest.names[j].data(), latest.values[j]);
+        std::fprintf(stderr, "\n");
+        lastFrames[i] = frames;
+        lastBytes[i] = bytes;
+    }
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s <directory> <name>=<input>...\n", argv[0]);
+        return 1;
+    }
+    std::vector<Recording> recordings(argc - 2);
+    for (int i = 2; i < argc; i++) {
+        const char* separator = std::strchr(argv[i], '=');
+        if (separator == nullptr || separator == argv[i]) {
+            std::fprintf(stderr, "expected <name>=<input>, got %s\n", argv[i]);
+            return 1;
+        }
+        Recording& recording = recordings[i - 2];
+        recording.name.assign(argv[i], separator - argv[i]);
+        recording.input = separator + 1;
+        recording.output = std::string(argv[1]) + "/" + recording.name + ".ltc";
+    }
+    std::signal(SIGINT, [](int) { g_stop = true; });
+
+    std::vector<std::thread> readers;
+    for (Recording& recording : recordings) readers.emplace_back(record, std::ref(recording));
+    const bool live = isatty(STDERR_FILENO);
+    std::vector<uint32_t> lastFrames(recordings.size(), 0);
+    std::vector<uint64_t> lastBytes(recordings.size(), 0);
+    auto running = [&] {
+        for (const Recording& recording : recordings)
+            if (!recording.done) return true;
+        return false;
+    };
+    while (running()) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        if (live) draw(recordings, lastFrames, lastBytes);
+    }
+    for (std::thread& reader : readers) reader.join();
+
+    bool ok = true;
+    for (const Recording& recording : recordings) {
+        std::printf("%s\n", recording.result.c_str());
+        ok &= recording.result.find("could not") == std::string::npos;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+// generates every path of a routine offline, so the brain loads finished trajectories instead of profiling them when
+// autonomous starts.
+// `./build/tools/trajectory_gen < routine.txt` reads a line per path from stdin, with the output file, the maximum
+// velocity in m/s, acceleration in m/s^2 and lateral acceleration in m/s^2, then two or more waypoints as x,y,heading
+// in meters and degrees, counterclockwise from the positive x axis, separated by spaces:
+//     intake.lpth 1.5 3 2 0,0,0 0.6,0.6,90 1.2,1.2,0
+// Consecutive waypoints are joined by cubic Hermite splines, sampled at even distances along them, 1 cm apart unless
+// a spacing in meters is passed like `trajectory_gen 0.02 < routine.txt`. Each path is then given a time-optimal
+// velocity profile by profilePath, and written as a path file. Paths are generated in parallel, one per core.
+// Each path is generated by generateTrajectory, like a TrajectoryCache on the brain, and the name its file has in a
+// cache is printed with it, so a cache can be filled by copying the files to the SD card under those names
+#include "hardware/Motion/TrajectoryCache.hpp"
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+struct Job {
+        std::string output;
+        lemlib::PathConstraints constraints {.maxVelocity = 0_mps, .maxAcceleration = 0_mps2,
+                                             .maxLateralAcceleration = 0_mps2};
+        std::vector<lemlib::Waypoint> waypoints;
+        // filled in by the worker which generates the path
+        std::string result;
+        bool ok = false;
+};
+
+/**
+ * @brief Parse a line of the routine
+ *
+ * @param line the line
+ * @param job the job to fill in
+ * @return true the line describes a path
+ * @return false the line is malformed
+ */
+bool parse(const std::string& line, Job& job) {
+    std::istringstream stream(line);
+    double velocity, acceleration, lateral;
+    if (!(stream >> job.output >> velocity >> acceleration >> lateral)) return false;
+    job.constraints = {.maxVelocity = from_mps(velocity),
+                       .maxAcceleration = from_mps2(acceleration),
+                       .maxLateralAcceleration = from_mps2(lateral)};
+    std::string token;
+    while (stream >> token) {
+        double x, y, heading;
+        if (std::sscanf(token.c_str(), "%lf,%lf,%lf", &x, &y, &heading) != 3) return false;
+        job.waypoints.push_back({.position = {from_m(x), from_m(y)}, .heading = from_stDeg(heading)});
+    }
+    return job.waypoints.size() >= 2;
+}
+
+/**
+ * @brief Generate, profile and save a path
+ *
+ * @param job the path. Its result is set to a line describing what was written, or what failed
+ * @param spacing the distance between samples, in meters
+ */
+void generate(Job& job, double spacing) {
+    const Length step = from_m(spacing);
+    const int32_t size = lemlib::countTrajectorySamples(job.waypoints, step);
+    std::vector<lemlib::PathSample> samples(size == INT_MAX ? 0 : size);
+    if (size == INT_MAX || lemlib::generateTrajectory(job.waypoints, job.constraints, step, samples) == INT_MAX) {
+        job.result = job.output + ": generateTrajectory: " + std::strerror(errno);
+        return;
+    }
+    std::vector<lemlib::PathRecord> records;
+    records.reserve(samples.size());
+    for (const lemlib::PathSample& sample : samples) records.push_back(lemlib::encodePathSample(sample));
+    if (lemlib::savePath(job.output.c_str(), records) == INT_MAX) {
+        job.result = job.output + ": " + std::strerror(errno);
+        return;
+    }
+    // the time to follow the profile, with the velocity changing linearly with time between samples
+    double time = 0;
+    for (size_t i = 1; i < samples.size(); i++) {
+        const double distance = to_m(samples[i - 1].position.distanceTo(samples[i].position));
+        const double velocity = to_mps(samples[i - 1].velocity + samples[i].velocity) / 2;
+        if (velocity > 0) time += distance / velocity;
+    }
+    char summary[128];
+    std::snprintf(summary, sizeof(summary), ": %zu points, %.2f s, cached as %016llx.lpth", records.size(), time,
+                  (unsigned long long)lemlib::hashTrajectory(job.waypoints, job.constraints, step));
+    job.result = job.output + summary;
+    job.ok = true;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc > 2) {
+        std::fprintf(stderr, "usage: %s [spacing] < routine.txt\n", argv[0]);
+        return 1;
+    }
+    const double spacing = argc == 2 ? std::atof(argv[1]) : 0.01;
+    if (!(spacing > 0)) {
+        std::fprintf(stderr, "the spacing must be positive\n");
+        return 1;
+    }
+    std::vector<Job> jobs;
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(std::cin, line)) {
+        lineNumber++;
+        // blank lines and comments are skipped
+        const size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') continue;
+        Job job;
+        if (!parse(line, job)) {
+            std::fprintf(stderr, "skipped line %zu\n", lineNumber);
+            continue;
+        }
+        jobs.push_back(std::move(job));
+    }
+    // every worker takes the next path until there are none left, so a long path doesn't hold up the others
+    std::atomic<size_t> next = 0;
+    const size_t workers = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), jobs.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < workers; i++) {
+        threads.emplace_back([&] {
+            for (size_t job = next++; job < jobs.size(); job = next++) generate(jobs[job], spacing);
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    bool failed = false;
+    for (const Job& job : jobs) {
+        std::fprintf(stderr, "%s\n", job.result.c_str());
+        failed = failed || !job.ok;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,174 @@
+#!/bin/sh
+# breaks the size of a linked program down by module, from the map the linker wrote for it. Every module of the library
+# is a directory of src/hardware, like hardware/Motor, or a file directly in it, like hardware/DevicePoller. Functions
+# and data in namespace units which weren't inlined are counted as units, wherever they were instantiated. Everything
+# else is counted by the archive it came from, like pros or stdc++, and the objects of the program itself as project.
+#
+# image is the bytes the program uploads: its code, read-only data and initialized data. ram is its initialized and
+# zeroed data, which stays allocated for as long as the program runs.
+#
+# The report is also written to a tab separated file. If that file already exists, it is kept next to it with a .prev
+# suffix, and every module shows how much it changed since then
+if [ $# -ne 3 ]; then
+    echo "usage: $0 <linker map> <source directory> <report file>" >&2
+    exit 2
+fi
+map=$1
+src=$2
+report=$3
+if [ ! -f "$map" ]; then
+    echo "$0: $map not found. Link the program first" >&2
+    exit 1
+fi
+if [ -f "$report" ]; then
+    mv "$report" "$report.prev"
+fi
+# objects are matched to their source by name, as archives only keep the names of their members
+find "$src" -name '*.c' -o -name '*.cpp' | awk '
+{
+    path = substr($0, length("'"$src"'") + 2)
+    count = split(path, parts, "/")
+    name = parts[count]
+    stem = name
+    sub(/\.[^.]*$/, "", stem)
+    if (parts[1] != "hardware") module = "project"
+    else if (count > 2) module = "hardware/" parts[2]
+    else module = "hardware/" stem
+    print name ".o\t" module
+}' > "$report.modules"
+
+awk -v modulesFile="$report.modules" -v previousFile="$report.prev" -v reportFile="$report" '
+function category(section) {
+    if (section ~ /^\.(text|init|fini)$/) return "code"
+    if (section ~ /^\.(rodata|hot_init|ARM\.exidx|ARM\.extab|eh_frame|eh_framehdr|gcc_except_table|got|fixup)$/) {
+        return "rodata"
+    }
+    if (section ~ /^\.(ctors|dtors|preinit_array|init_array|fini_array)$/) return "rodata"
+    if (section ~ /^\.(data|sdata|tdata)$/) return "data"
+    if (section ~ /^\.(bss|sbss|tbss)$/) return "bss"
+    return ""
+}
+
+function moduleOf(input, file,    object, archive, count, parts) {
+    if (input ~ /\._Z(Z|TV|TI|TS)?NK?5units/) return "units"
+    if (file ~ /\(.*\)$/) {
+        object = file
+        sub(/^.*\(/, "", object)
+        sub(/\)$/, "", object)
+        if (object in modules) return modules[object]
+        archive = file
+        sub(/\(.*$/, "", archive)
+        sub(/^.*\//, "", archive)
+        sub(/^lib/, "", archive)
+        sub(/\.a$/, "", archive)
+        return archive
+    }
+    count = split(file, parts, "/")
+    if (parts[count] in modules) return modules[parts[count]]
+    if (file ~ /(^|\/)bin\//) return "project"
+    return "startup"
+}
+
+# strtonum is only in gawk
+function hex(text,    value, i) {
+    text = tolower(text)
+    sub(/^0x/, "", text)
+    value = 0
+    for (i = 1; i <= length(text); i++) value = value * 16 + index("0123456789abcdef", substr(text, i, 1)) - 1
+    return value
+}
+
+function add(input, size, file,    module) {
+    size = hex(size)
+    if (current == "" || size == 0) return
+    module = moduleOf(input, file)
+    sizes[module, current] += size
+    seen[module] = 1
+}
+
+function delta(now, before) {
+    if (now == before) return ""
+    return sprintf("%+d", now - before)
+}
+
+BEGIN {
+    while ((getline line < modulesFile) > 0) {
+        split(line, fields, "\t")
+        modules[fields[1]] = fields[2]
+    }
+    while ((getline line < previousFile) > 0) {
+        if (line ~ /^module\t/) continue
+        split(line, fields, "\t")
+        previous[fields[1], "image"] = fields[2] + fields[3] + fields[4]
+        previous[fields[1], "ram"] = fields[4] + fields[5]
+        seen[fields[1]] = 1
+        hasPrevious = 1
+    }
+}
+
+/^Linker script and memory map/ { mapped = 1; next }
+!mapped { next }
+
+# an output section, which decides what its input sections count as
+/^\.[^ \t]/ { current = category($1); next }
+/^[^ \t]/ { current = ""; next }
+
+# an input section, with its address, size and file on the same line, or on the next one when its name is long
+/^ [.A-Z]/ && $1 != "*fill*" {
+    if (NF >= 4 && $2 ~ /^0x/ && $3 ~ /^0x/) add($1, $3, $4)
+    else if (NF == 1) pending = $1
+    next
+}
+pending != "" && NF >= 3 && $1 ~ /^0x/ && $2 ~ /^0x/ { add(pending, $2, $3) }
+{ pending = "" }
+
+END {
+    printf "%-28s %8s %8s %8s %8s %8s %8s", "module", "code", "rodata", "data", "bss", "image", "ram"
+    if (hasPrevious) printf " %8s %8s", "image +/-", "ram +/-"
+    printf "\n"
+    print "module\tcode\trodata\tdata\tbss" > reportFile
+    # sorted by image size, largest first, with a selection sort as there are only a few dozen modules
+    count = 0
+    for (module in seen) names[++count] = module
+    for (i = 1; i <= count; i++) {
+        for (j = i + 1; j <= count; j++) {
+            a = sizes[names[i], "code"] + sizes[names[i], "rodata"] + sizes[names[i], "data"]
+            b = sizes[names[j], "code"] + sizes[names[j], "rodata"] + sizes[names[j], "data"]
+            if (b > a || (b == a && names[j] < names[i])) {
+                swap = names[i]
+                names[i] = names[j]
+                names[j] = swap
+            }
+        }
+    }
+    for (i = 1; i <= count; i++) {
+        module = names[i]
+        code = sizes[module, "code"] + 0
+        rodata = sizes[module, "rodata"] + 0
+        data = sizes[module, "data"] + 0
+        bss = sizes[module, "bss"] + 0
+        image = code + rodata + data
+        ram = data + bss
+        totals["code"] += code
+        totals["rodata"] += rodata
+        totals["data"] += data
+        totals["bss"] += bss
+        totals["image"] += image
+        totals["ram"] += ram
+        totals["previousImage"] += previous[module, "image"]
+        totals["previousRam"] += previous[module, "ram"]
+        printf "%-28s %8d %8d %8d %8d %8d %8d", module, code, rodata, data, bss, image, ram
+        if (hasPrevious) printf " %9s %8s", delta(image, previous[module, "image"]), delta(ram, previous[module, "ram"])
+        printf "\n"
+        if (image + bss > 0) printf "%s\t%d\t%d\t%d\t%d\n", module, code, rodata, data, bss > reportFile
+    }
+    printf "%-28s %8d %8d %8d %8d %8d %8d", "total", totals["code"], totals["rodata"], totals["data"], totals["bss"],
+           totals["image"], totals["ram"]
+    if (hasPrevious) {
+        printf " %9s %8s", delta(totals["image"], totals["previousImage"]), delta(totals["ram"], totals["previousRam"])
+    }
+    printf "\n"
+}' "$map"
+status=$?
+rm -f "$report.modules"
+exit $status
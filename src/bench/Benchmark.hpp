@@ -0,0 +1,281 @@
+#pragma once
+
+#include "pros/rtos.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <malloc.h>
+#include <span>
+
+namespace lemlib::bench {
+/**
+ * @brief The maximum number of times a single benchmark can be run
+ *
+ * Durations are stored in a static buffer, so running a benchmark never allocates memory and doesn't affect the heap
+ * usage it measures
+ */
+constexpr size_t MAX_ITERATIONS = 1000;
+
+/**
+ * @brief Get a percentile of sorted samples
+ *
+ * @param sorted the samples, sorted in ascending order. There must be at least one
+ * @param count the number of samples
+ * @param percent the percentile, from 0 to 100
+ * @return uint32_t the sample at the percentile
+ */
+inline uint32_t percentile(const uint32_t* sorted, size_t count, size_t percent) {
+    return sorted[std::min(count - 1, (count * percent) / 100)];
+}
+
+/**
+ * @brief Get the number of bytes currently allocated on the heap
+ *
+ * @return size_t allocated bytes
+ */
+inline size_t heapUsed() { return mallinfo().uordblks; }
+
+/**
+ * @brief The timing of a benchmark, returned by run
+ */
+struct Summary {
+        uint32_t medianMicros;
+        // the mean resolves calls which are shorter than the 1 us resolution of the timer
+        double meanMicros;
+};
+
+/**
+ * @brief Time a function and print the results over the serial port
+ *
+ * Every result is printed on its own line, starting with "BENCH", followed by a JSON object:
+ *
+ * BENCH {"name":"Motor::move","n":200,"min_us":41,"median_us":44,"p99_us":61,"max_us":75,"heap_bytes":0}
+ *
+ * heap_bytes is the change in heap usage over every run of the function, so a function which allocates and frees
+ * memory every time reports 0, while a function which leaks memory reports a positive value.
+ *
+ * @param name the name of the benchmark
+ * @param iterations how many times to run the function. Clamped to MAX_ITERATIONS
+ * @param function the function to time
+ * @return Summary the median and the mean duration
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::bench::run("Motor::getAngle", 200, [&] { motor.getAngle(); });
+ * @endcode
+ */
+template <typename F> Summary run(const char* name, size_t iterations, F&& function) {
+    static uint32_t durations[MAX_ITERATIONS];
+    iterations = std::clamp<size_t>(iterations, 1, MAX_ITERATIONS);
+    // run once before timing, so one-time costs like detecting the motor type are not part of the results
+    function();
+    const size_t heapBefore = heapUsed();
+    for (size_t i = 0; i < iterations; i++) {
+        const uint64_t start = pros::c::micros();
+        function();
+        durations[i] = pros::c::micros() - start;
+    }
+    const long heapDelta = long(heapUsed()) - long(heapBefore);
+    uint64_t total = 0;
+    for (size_t i = 0; i < iterations; i++) total += durations[i];
+    std::sort(durations, durations + iterations);
+    const size_t p99 = std::min(iterations - 1, (iterations * 99) / 100);
+    std::printf("BENCH {\"name\":\"%s\",\"n\":%u,\"min_us\":%lu,\"median_us\":%lu,\"p99_us\":%lu,\"max_us\":%lu,"
+                "\"heap_bytes\":%ld}\n",
+                name, unsigned(iterations), (unsigned long)durations[0], (unsigned long)durations[iterations / 2],
+                (unsigned long)durations[p99], (unsigned long)durations[iterations - 1], heapDelta);
+    // flush, so results show up even if a later benchmark hangs
+    std::fflush(stdout);
+    return {durations[iterations / 2], double(total) / iterations};
+}
+
+/**
+ * @brief Time the same workload through the library and through the raw PROS api, and print the overhead
+ *
+ * Both functions are timed with run, as "<name> (lemlib)" and "<name> (pros)", and then a line starting with
+ * "OVERHEAD" is printed, followed by a JSON object:
+ *
+ * OVERHEAD {"name":"Motor::move","lemlib_mean_us":3.12,"pros_mean_us":2.05,"ratio":1.52}
+ *
+ * The ratio is the mean duration through the library divided by the mean duration through PROS, so 1 means the
+ * library costs nothing on top of PROS.
+ *
+ * @param name the name of the operation
+ * @param iterations how many times to run each function. Clamped to MAX_ITERATIONS
+ * @param library the workload through the library
+ * @param raw the same workload through the PROS api
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::bench::compare("Motor::getAngle", 200, [&] { motor.getAngle(); }, [&] { prosMotor.get_position(); });
+ * @endcode
+ */
+template <typename F, typename G> void compare(const char* name, size_t iterations, F&& library, G&& raw) {
+    // the names are built in a static buffer, so comparing never allocates memory
+    static char label[96];
+    std::snprintf(label, sizeof(label), "%s (lemlib)", name);
+    const Summary lemlib = run(label, iterations, library);
+    std::snprintf(label, sizeof(label), "%s (pros)", name);
+    const Summary pros = run(label, iterations, raw);
+    // a raw call which is too fast to measure has no meaningful ratio
+    const double ratio = pros.meanMicros > 0 ? lemlib.meanMicros / pros.meanMicros : 0;
+    std::printf("OVERHEAD {\"name\":\"%s\",\"lemlib_mean_us\":%.2f,\"pros_mean_us\":%.2f,\"ratio\":%.2f}\n", name,
+                lemlib.meanMicros, pros.meanMicros, ratio);
+    std::fflush(stdout);
+}
+
+/**
+ * @brief Check that two implementations of a kernel computed the same values, and print the largest difference
+ *
+ * The result is printed on a line starting with "CHECK", followed by a JSON object:
+ *
+ * CHECK {"name":"Vector3DKernels::rotate","n":1001,"max_error":0,"tolerance":0,"ok":true}
+ *
+ * The error of a value is its difference from the expected value, relative to the expected value. Two NaNs are equal,
+ * and a NaN which was expected to be a number fails the check.
+ *
+ * @param name the name of the kernel
+ * @param actual the values of the implementation under test
+ * @param expected the values of the reference implementation, the same size as actual
+ * @param tolerance the largest relative error which passes. 0 requires the values to be identical
+ * @return true if every value is within the tolerance
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::bench::check("Vector3DKernels::dot", neonDots, scalarDots, 0);
+ * @endcode
+ */
+inline bool check(const char* name, std::span<const float> actual, std::span<const float> expected, float tolerance) {
+    float maxError = 0;
+    bool ok = actual.size() == expected.size();
+    for (size_t i = 0; ok && i < actual.size(); i++) {
+        if (std::isnan(actual[i]) || std::isnan(expected[i])) {
+            ok = std::isnan(actual[i]) && std::isnan(expected[i]);
+            continue;
+        }
+        const float difference = std::abs(actual[i] - expected[i]);
+        const float error = expected[i] == 0 ? difference : difference / std::abs(expected[i]);
+        maxError = std::max(maxError, error);
+    }
+    ok = ok && maxError <= tolerance;
+    std::printf("CHECK {\"name\":\"%s\",\"n\":%u,\"max_error\":%g,\"tolerance\":%g,\"ok\":%s}\n", name,
+                unsigned(actual.size()), maxError, tolerance, ok ? "true" : "false");
+    std::fflush(stdout);
+    return ok;
+}
+
+/**
+ * @brief Measure the latency from a command to the first motion a sensor sees, and print its distribution
+ *
+ * Every trial first calls rest, untimed, which has to leave the mechanism still. The clock is then read, step sends
+ * the command, and moved is polled every millisecond until it reports motion, or the timeout elapses. The latency of
+ * a trial is the time from just before step until moved first returns true, so it includes the time the command
+ * takes to reach the motor, the response of the motor, and the time until the sensor reports a new sample. Polling
+ * every millisecond adds up to 1 ms, which is well below the 5 ms a sensor takes to measure.
+ *
+ * The result is printed on a line starting with "LATENCY", followed by a JSON object:
+ *
+ * LATENCY {"name":"Motor::move","n":20,"missed":0,"min_us":11023,"median_us":14310,"p90_us":16890,"p99_us":17950,
+ * "max_us":17950}
+ *
+ * missed counts the trials in which no motion was seen before the timeout, like when a device is unplugged. They are
+ * left out of the distribution.
+ *
+ * @param name the name of the benchmark
+ * @param trials how many trials to run. Clamped to MAX_ITERATIONS
+ * @param timeoutMicros how long to wait for motion in a trial, in microseconds
+ * @param rest called with the index of the trial before it starts, to bring the mechanism to rest
+ * @param step called with the index of the trial, to send the command
+ * @param moved called with the index of the trial, returns whether the sensor has seen motion
+ *
+ * @b Example:
+ * @code {.cpp}
+ * lemlib::bench::latency("Motor::move", 20, 500000, [&](size_t) { motor.move(0); pros::delay(500); },
+ *                        [&](size_t) { motor.move(1); }, [&](size_t) { return sensor.getVelocity() > 0_rpm; });
+ * @endcode
+ */
+template <typename Rest, typename Step, typename Moved>
+void latency(const char* name, size_t trials, uint32_t timeoutMicros, Rest&& rest, Step&& step, Moved&& moved) {
+    static uint32_t latencies[MAX_ITERATIONS];
+    trials = std::clamp<size_t>(trials, 1, MAX_ITERATIONS);
+    size_t count = 0;
+    size_t missed = 0;
+    for (size_t i = 0; i < trials; i++) {
+        rest(i);
+        const uint64_t start = pros::c::micros();
+        step(i);
+        while (true) {
+            const bool detected = moved(i);
+            // the clock is read after the sensor, so the latency covers the read which saw the motion
+            const uint64_t elapsed = pros::c::micros() - start;
+            if (detected) latencies[count++] = elapsed;
+            if (detected || elapsed >= timeoutMicros) {
+                missed += !detected;
+                break;
+            }
+            pros::c::delay(1);
+        }
+    }
+    if (count == 0) {
+        std::printf("LATENCY {\"name\":\"%s\",\"n\":0,\"missed\":%u}\n", name, unsigned(missed));
+        std::fflush(stdout);
+        return;
+    }
+    std::sort(latencies, latencies + count);
+    std::printf("LATENCY {\"name\":\"%s\",\"n\":%u,\"missed\":%u,\"min_us\":%lu,\"median_us\":%lu,\"p90_us\":%lu,"
+                "\"p99_us\":%lu,\"max_us\":%lu}\n",
+                name, unsigned(count), unsigned(missed), (unsigned long)latencies[0],
+                (unsigned long)percentile(latencies, count, 50), (unsigned long)percentile(latencies, count, 90),
+                (unsigned long)percentile(latencies, count, 99), (unsigned long)latencies[count - 1]);
+    std::fflush(stdout);
+}
+
+/**
+ * @brief Print how far the times a periodic loop woke up strayed from its period
+ *
+ * The jitter of a wakeup is how much longer or shorter the time since the previous wakeup was than the period. The
+ * result is printed on a line starting with "JITTER", followed by a JSON object:
+ *
+ * JITTER {"name":"ControlScheduler","n":199,"period_us":10000,"mean_period_us":10000.4,"median_us":3,"p99_us":41,
+ * "max_us":112,"late":0}
+ *
+ * The percentiles are of the absolute jitter, and late counts the wakeups which came more than half a period late.
+ *
+ * @param name the name of the loop
+ * @param periodMicros the period of the loop, in microseconds
+ * @param wakeups the times the loop woke up, from pros::micros, in order. At most MAX_ITERATIONS are used
+ *
+ * @b Example:
+ * @code {.cpp}
+ * static uint64_t wakeups[200];
+ * uint32_t now = pros::millis();
+ * for (uint64_t& wakeup : wakeups) {
+ *     pros::c::task_delay_until(&now, 10);
+ *     wakeup = pros::micros();
+ * }
+ * lemlib::bench::jitter("task_delay_until", 10000, wakeups);
+ * @endcode
+ */
+inline void jitter(const char* name, uint32_t periodMicros, std::span<const uint64_t> wakeups) {
+    static uint32_t deviations[MAX_ITERATIONS];
+    const size_t count = std::min(wakeups.size(), MAX_ITERATIONS) - std::min<size_t>(wakeups.size(), 1);
+    if (count == 0) return;
+    size_t late = 0;
+    for (size_t i = 0; i < count; i++) {
+        const int64_t interval = wakeups[i + 1] - wakeups[i];
+        const int64_t deviation = interval - int64_t(periodMicros);
+        late += deviation > periodMicros / 2;
+        deviations[i] = deviation < 0 ? -deviation : deviation;
+    }
+    const double meanPeriod = double(wakeups[count] - wakeups[0]) / count;
+    std::sort(deviations, deviations + count);
+    std::printf("JITTER {\"name\":\"%s\",\"n\":%u,\"period_us\":%lu,\"mean_period_us\":%.1f,\"median_us\":%lu,"
+                "\"p99_us\":%lu,\"max_us\":%lu,\"late\":%u}\n",
+                name, unsigned(count), (unsigned long)periodMicros, meanPeriod,
+                (unsigned long)percentile(deviations, count, 50), (unsigned long)percentile(deviations, count, 99),
+                (unsigned long)deviations[count - 1], unsigned(late));
+    std::fflush(stdout);
+}
+} // namespace lemlib::bench
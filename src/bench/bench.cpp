@@ -0,0 +1,469 @@
+// on-brain benchmark program. Build it with `make bench` and upload bin/bench/monolith.bin. Results are printed over
+// the serial port, one line per benchmark. See Benchmark.hpp for the format
+#ifdef LEMLIB_BENCH
+
+#include "main.h"
+#include "Benchmark.hpp"
+#include "hardware/hardware.hpp"
+#include "units/FastTrig.hpp"
+#include "units/LookupTable.hpp"
+#include "units/PoseArray.hpp"
+#include "units/Vector3DArray.hpp"
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <errno.h>
+#include <vector>
+
+// the ports of the devices used in the benchmark. Benchmarks still run if devices are missing, which measures the cost
+// of the error paths instead. The latency benchmark needs the rotation sensor on the shaft of the motor, free to spin
+constexpr int8_t MOTOR_PORT = 1;
+constexpr int8_t GROUP_PORT_A = 2;
+constexpr int8_t GROUP_PORT_B = -3;
+constexpr int8_t ROTATION_PORT = 4;
+constexpr int8_t IMU_PORT = 5;
+constexpr char ADI_TOP_PORT = 'A';
+constexpr char ADI_BOTTOM_PORT = 'B';
+constexpr size_t ITERATIONS = 200;
+// the number of waypoints transformed by the path benchmarks
+constexpr size_t WAYPOINTS = 500;
+// the number of steps the latency benchmark times for each command, and how long the motor rests before each
+constexpr size_t LATENCY_TRIALS = 20;
+constexpr uint32_t REST_MSEC = 300;
+// how far the shaft has to turn for the motion to count as started. A still rotation sensor reads within a few
+// centidegrees, so this is well above its noise
+constexpr double ONSET_DEG = 0.5;
+// the period of the loops the jitter benchmark times, in milliseconds
+constexpr uint32_t JITTER_PERIOD = 10;
+
+using lemlib::bench::compare;
+using lemlib::bench::run;
+
+void benchMotor() {
+    lemlib::Motor motor(MOTOR_PORT, 200_rpm);
+    run("Motor::move", ITERATIONS, [&] { motor.move(0); });
+    run("Motor::moveVelocity", ITERATIONS, [&] { motor.moveVelocity(0_rpm); });
+    run("Motor::brake", ITERATIONS, [&] { motor.brake(); });
+    run("Motor::setBrakeMode", ITERATIONS, [&] { motor.setBrakeMode(lemlib::BrakeMode::COAST); });
+    run("Motor::getBrakeMode", ITERATIONS, [&] { motor.getBrakeMode(); });
+    run("Motor::isConnected", ITERATIONS, [&] { motor.isConnected(); });
+    run("Motor::getAngle", ITERATIONS, [&] { motor.getAngle(); });
+    // getAngle reads raw ticks and converts them with one multiply-add. These compare the two ways the SDK can report
+    // the position: raw ticks, and a position it converts to the configured encoder units itself
+    run("motor_get_raw_position", ITERATIONS, [&] { pros::c::motor_get_raw_position(MOTOR_PORT, NULL); });
+    pros::c::motor_set_encoder_units(MOTOR_PORT, pros::E_MOTOR_ENCODER_ROTATIONS);
+    run("motor_get_position (rotations)", ITERATIONS, [&] { pros::c::motor_get_position(MOTOR_PORT); });
+    // moveToAngle expects counts
+    pros::c::motor_set_encoder_units(MOTOR_PORT, pros::E_MOTOR_ENCODER_COUNTS);
+    run("Motor::setAngle", ITERATIONS, [&] { motor.setAngle(0_stDeg); });
+    run("Motor::getOffset", ITERATIONS, [&] { motor.getOffset(); });
+    run("Motor::setOffset", ITERATIONS, [&] { motor.setOffset(0_stDeg); });
+    run("Motor::getType", ITERATIONS, [&] { motor.getType(); });
+    run("Motor::isReversed", ITERATIONS, [&] { motor.isReversed(); });
+    run("Motor::setReversed", ITERATIONS, [&] { motor.setReversed(false); });
+    run("Motor::getPort", ITERATIONS, [&] { motor.getPort(); });
+    run("Motor::getCurrentLimit", ITERATIONS, [&] { motor.getCurrentLimit(); });
+    run("Motor::setCurrentLimit", ITERATIONS, [&] { motor.setCurrentLimit(2.5_amp); });
+    run("Motor::getTemperature", ITERATIONS, [&] { motor.getTemperature(); });
+    run("Motor::getCurrent", ITERATIONS, [&] { motor.getCurrent(); });
+    run("Motor::setOutputVelocity", ITERATIONS, [&] { motor.setOutputVelocity(200_rpm); });
+    run("Motor::getOutputVelocity", ITERATIONS, [&] { motor.getOutputVelocity(); });
+    run("Motor::getTelemetry", ITERATIONS, [&] { motor.getTelemetry(); });
+}
+
+void benchMotorGroup() {
+    lemlib::MotorGroup group({GROUP_PORT_A, GROUP_PORT_B}, 200_rpm);
+    std::array<lemlib::MotorTelemetry, 2> telemetry;
+    std::array<Temperature, 2> temperatures {0_celsius, 0_celsius};
+    std::array<Angle, 2> angles {0_stDeg, 0_stDeg};
+    std::array<AngularVelocity, 2> velocities {0_rpm, 0_rpm};
+    std::array<Current, 2> currents {0_amp, 0_amp};
+    run("MotorGroup::move", ITERATIONS, [&] { group.move(0); });
+    run("MotorGroup::moveVelocity", ITERATIONS, [&] { group.moveVelocity(0_rpm); });
+    run("MotorGroup::brake", ITERATIONS, [&] { group.brake(); });
+    run("MotorGroup::setBrakeMode", ITERATIONS, [&] { group.setBrakeMode(lemlib::BrakeMode::COAST); });
+    run("MotorGroup::getBrakeMode", ITERATIONS, [&] { group.getBrakeMode(); });
+    run("MotorGroup::isConnected", ITERATIONS, [&] { group.isConnected(); });
+    run("MotorGroup::getAngle", ITERATIONS, [&] { group.getAngle(); });
+    run("MotorGroup::setAngle", ITERATIONS, [&] { group.setAngle(0_stDeg); });
+    run("MotorGroup::getCurrentLimit", ITERATIONS, [&] { group.getCurrentLimit(); });
+    run("MotorGroup::setCurrentLimit", ITERATIONS, [&] { group.setCurrentLimit(5_amp); });
+    run("MotorGroup::getTemperatures", ITERATIONS, [&] { group.getTemperatures(); });
+    run("MotorGroup::getTemperatures(span)", ITERATIONS, [&] { group.getTemperatures(temperatures); });
+    run("MotorGroup::getAngles", ITERATIONS, [&] { group.getAngles(angles); });
+    run("MotorGroup::getVelocities", ITERATIONS, [&] { group.getVelocities(velocities); });
+    run("MotorGroup::getCurrents", ITERATIONS, [&] { group.getCurrents(currents); });
+    run("MotorGroup::setOutputVelocity", ITERATIONS, [&] { group.setOutputVelocity(200_rpm); });
+    run("MotorGroup::getOutputVelocity", ITERATIONS, [&] { group.getOutputVelocity(); });
+    run("MotorGroup::getSize", ITERATIONS, [&] { group.getSize(); });
+    run("MotorGroup::getTelemetry", ITERATIONS, [&] { group.getTelemetry(telemetry); });
+}
+
+void benchStaticMotorGroup() {
+    lemlib::StaticMotorGroup<GROUP_PORT_A, GROUP_PORT_B> group(200_rpm);
+    run("StaticMotorGroup::move", ITERATIONS, [&] { group.move(0); });
+    run("StaticMotorGroup::moveVelocity", ITERATIONS, [&] { group.moveVelocity(0_rpm); });
+    run("StaticMotorGroup::brake", ITERATIONS, [&] { group.brake(); });
+    run("StaticMotorGroup::getAngle", ITERATIONS, [&] { group.getAngle(); });
+    run("StaticMotorGroup::setAngle", ITERATIONS, [&] { group.setAngle(0_stDeg); });
+    run("StaticMotorGroup::getSize", ITERATIONS, [&] { group.getSize(); });
+    run("StaticMotorGroup::getTelemetry", ITERATIONS, [&] { group.getTelemetry(); });
+}
+
+void benchEncoders() {
+    lemlib::V5RotationSensor rotation(ROTATION_PORT);
+    run("V5RotationSensor::isConnected", ITERATIONS, [&] { rotation.isConnected(); });
+    run("V5RotationSensor::getAngle", ITERATIONS, [&] { rotation.getAngle(); });
+    run("V5RotationSensor::setAngle", ITERATIONS, [&] { rotation.setAngle(0_stDeg); });
+    run("V5RotationSensor::isReversed", ITERATIONS, [&] { rotation.isReversed(); });
+    run("V5RotationSensor::setReversed", ITERATIONS, [&] { rotation.setReversed(false); });
+
+    lemlib::ADIEncoder adi({ADI_TOP_PORT, ADI_BOTTOM_PORT}, false);
+    run("ADIEncoder::getAngle", ITERATIONS, [&] { adi.getAngle(); });
+    run("ADIEncoder::setAngle", ITERATIONS, [&] { adi.setAngle(0_stDeg); });
+}
+
+void benchIMU() {
+    lemlib::V5InertialSensor imu(IMU_PORT);
+    run("V5InertialSensor::isConnected", ITERATIONS, [&] { imu.isConnected(); });
+    run("V5InertialSensor::isCalibrated", ITERATIONS, [&] { imu.isCalibrated(); });
+    run("V5InertialSensor::isCalibrating", ITERATIONS, [&] { imu.isCalibrating(); });
+    run("V5InertialSensor::getRotation", ITERATIONS, [&] { imu.getRotation(); });
+    run("V5InertialSensor::setRotation", ITERATIONS, [&] { imu.setRotation(0_stDeg); });
+    run("V5InertialSensor::getGyroScalar", ITERATIONS, [&] { imu.getGyroScalar(); });
+    run("V5InertialSensor::setGyroScalar", ITERATIONS, [&] { imu.setGyroScalar(1); });
+}
+
+void benchOverhead() {
+    // the same workloads through the library and through the PROS classes, on the same ports. The PROS objects are
+    // made after the library objects, so the motors keep the brake mode and encoder units the library configured
+    lemlib::Motor motor(MOTOR_PORT, 200_rpm);
+    pros::Motor prosMotor(MOTOR_PORT);
+    compare("Motor::move", ITERATIONS, [&] { motor.move(0); }, [&] { prosMotor.move(0); });
+    compare("Motor::moveVelocity", ITERATIONS, [&] { motor.moveVelocity(0_rpm); },
+            [&] { prosMotor.move_velocity(0); });
+    compare("Motor::brake", ITERATIONS, [&] { motor.brake(); }, [&] { prosMotor.brake(); });
+    compare("Motor::getAngle", ITERATIONS, [&] { motor.getAngle(); }, [&] { prosMotor.get_position(); });
+    compare("Motor::getVelocity", ITERATIONS, [&] { motor.getVelocity(); },
+            [&] { prosMotor.get_actual_velocity(); });
+    compare("Motor::getTemperature", ITERATIONS, [&] { motor.getTemperature(); },
+            [&] { prosMotor.get_temperature(); });
+    compare("Motor::getCurrent", ITERATIONS, [&] { motor.getCurrent(); }, [&] { prosMotor.get_current_draw(); });
+
+    lemlib::MotorGroup group({GROUP_PORT_A, GROUP_PORT_B}, 200_rpm);
+    pros::MotorGroup prosGroup({GROUP_PORT_A, GROUP_PORT_B});
+    std::array<Angle, 2> angles {0_stDeg, 0_stDeg};
+    compare("MotorGroup::move", ITERATIONS, [&] { group.move(0); }, [&] { prosGroup.move(0); });
+    compare("MotorGroup::moveVelocity", ITERATIONS, [&] { group.moveVelocity(0_rpm); },
+            [&] { prosGroup.move_velocity(0); });
+    compare("MotorGroup::brake", ITERATIONS, [&] { group.brake(); }, [&] { prosGroup.brake(); });
+    // the group averages every motor, while PROS reads one motor. Reading every motor in PROS returns a new vector
+    compare("MotorGroup::getAngle", ITERATIONS, [&] { group.getAngle(); }, [&] { prosGroup.get_position(); });
+    compare("MotorGroup::getAngles", ITERATIONS, [&] { group.getAngles(angles); },
+            [&] { prosGroup.get_position_all(); });
+
+    lemlib::V5RotationSensor rotation(ROTATION_PORT);
+    pros::Rotation prosRotation(ROTATION_PORT);
+    compare("V5RotationSensor::getAngle", ITERATIONS, [&] { rotation.getAngle(); },
+            [&] { prosRotation.get_position(); });
+    compare("V5RotationSensor::getVelocity", ITERATIONS, [&] { rotation.getVelocity(); },
+            [&] { prosRotation.get_velocity(); });
+    compare("V5RotationSensor::isConnected", ITERATIONS, [&] { rotation.isConnected(); },
+            [&] { prosRotation.is_installed(); });
+
+    lemlib::V5InertialSensor imu(IMU_PORT);
+    pros::Imu prosImu(IMU_PORT);
+    compare("V5InertialSensor::getRotation", ITERATIONS, [&] { imu.getRotation(); }, [&] { prosImu.get_rotation(); });
+    compare("V5InertialSensor::isCalibrating", ITERATIONS, [&] { imu.isCalibrating(); },
+            [&] { prosImu.is_calibrating(); });
+}
+
+void benchPoses() {
+    const units::Pose frame(12_in, -6_in, 30_stDeg);
+    // transforming poses one at a time, the way it was done before PoseArray existed
+    std::vector<units::Pose> poses(WAYPOINTS, units::Pose(1_in, 2_in, 0_stDeg));
+    run("Pose transform", ITERATIONS, [&] {
+        for (units::Pose& pose : poses) {
+            pose = units::Pose(pose.rotatedBy(frame.orientation) + frame, pose.orientation + frame.orientation);
+        }
+    });
+    // transforming points with a single sin/cos for the whole batch
+    std::vector<units::V2Position> points(WAYPOINTS, units::V2Position(1_in, 2_in));
+    run("Pose::transform", ITERATIONS, [&] { frame.transform(points, points); });
+    units::PoseArray array(WAYPOINTS);
+    run("PoseArray::transformBy", ITERATIONS, [&] { array.transformBy(frame); });
+    std::vector<Length> distances(WAYPOINTS, 0_m);
+    run("V2PositionArray::distancesTo", ITERATIONS, [&] { array.positions().distancesTo(frame, distances); });
+    run("V2PositionArray::nearest", ITERATIONS, [&] { array.positions().nearest(frame); });
+}
+
+void benchVectors() {
+    const units::Quaternion rotation = units::Quaternion::fromEuler(10_stDeg, 20_stDeg, 30_stDeg);
+    // rotating vectors one at a time, the way it was done before Vector3DArray existed
+    std::vector<units::V3Position> vectors(WAYPOINTS, units::V3Position(1_in, 2_in, 3_in));
+    run("Quaternion::rotate", ITERATIONS, [&] {
+        for (units::V3Position& vector : vectors) vector = rotation.rotate(vector);
+    });
+    units::V3PositionArray array {std::span<const units::V3Position>(vectors)};
+    const units::V3PositionArray other = array;
+    units::Vector3DArray<Area> crosses(WAYPOINTS);
+    std::vector<Area> dots(WAYPOINTS, Area(0));
+    run("V3PositionArray::rotate", ITERATIONS, [&] { array.rotate(rotation); });
+    run("V3PositionArray::cross", ITERATIONS, [&] { array.cross(other, crosses); });
+    run("V3PositionArray::dot", ITERATIONS, [&] { array.dot(other, std::span<Area>(dots)); });
+    run("V3PositionArray::normalize", ITERATIONS, [&] { array.normalize(); });
+}
+
+// the number of vectors the kernel check compares, which isn't a multiple of 4, so the scalar tail of the NEON kernels
+// is checked too
+constexpr size_t KERNEL_VECTORS = 1001;
+
+void benchVectorKernels() {
+    using units::detail::Vector3DKernels;
+    using units::detail::Vector3DScalarKernels;
+    // the same vectors on every run, spread over every direction and a range of lengths
+    std::vector<float> ax(KERNEL_VECTORS), ay(KERNEL_VECTORS), az(KERNEL_VECTORS);
+    std::vector<float> bx(KERNEL_VECTORS), by(KERNEL_VECTORS), bz(KERNEL_VECTORS);
+    for (size_t i = 0; i < KERNEL_VECTORS; i++) {
+        ax[i] = std::sin(i * 0.7f) * (1 + i % 7);
+        ay[i] = std::cos(i * 1.3f) * (1 + i % 5);
+        az[i] = std::sin(i * 2.9f + 1) * 0.01f * (1 + i % 11);
+        bx[i] = std::cos(i * 0.3f);
+        by[i] = std::sin(i * 1.9f) * 3;
+        bz[i] = std::cos(i * 2.3f + 2) * 0.5f;
+    }
+    std::vector<float> x, y, z, sx, sy, sz;
+    const auto reset = [&] { x = ax, y = ay, z = az, sx = ax, sy = ay, sz = az; };
+    const units::Quaternion rotation = units::Quaternion::fromEuler(10_stDeg, 20_stDeg, 30_stDeg);
+
+    // products and sums round the same way in both, so only the reciprocal square root may differ, by a few units in
+    // the last place
+    reset();
+    Vector3DKernels::cross(ax.data(), ay.data(), az.data(), bx.data(), by.data(), bz.data(), x.data(), y.data(),
+                           z.data(), KERNEL_VECTORS);
+    Vector3DScalarKernels::cross(ax.data(), ay.data(), az.data(), bx.data(), by.data(), bz.data(), sx.data(),
+                                 sy.data(), sz.data(), KERNEL_VECTORS);
+    lemlib::bench::check("Vector3DKernels::cross x", x, sx, 0);
+    lemlib::bench::check("Vector3DKernels::cross z", z, sz, 0);
+    Vector3DKernels::dot(ax.data(), ay.data(), az.data(), bx.data(), by.data(), bz.data(), x.data(), KERNEL_VECTORS);
+    Vector3DScalarKernels::dot(ax.data(), ay.data(), az.data(), bx.data(), by.data(), bz.data(), sx.data(),
+                               KERNEL_VECTORS);
+    lemlib::bench::check("Vector3DKernels::dot", x, sx, 0);
+    Vector3DKernels::magnitudes(ax.data(), ay.data(), az.data(), x.data(), KERNEL_VECTORS);
+    Vector3DScalarKernels::magnitudes(ax.data(), ay.data(), az.data(), sx.data(), KERNEL_VECTORS);
+    lemlib::bench::check("Vector3DKernels::magnitudes", x, sx, 5e-7f);
+    reset();
+    Vector3DKernels::normalize(x.data(), y.data(), z.data(), KERNEL_VECTORS);
+    Vector3DScalarKernels::normalize(sx.data(), sy.data(), sz.data(), KERNEL_VECTORS);
+    lemlib::bench::check("Vector3DKernels::normalize x", x, sx, 5e-7f);
+    reset();
+    Vector3DKernels::rotate(x.data(), y.data(), z.data(), KERNEL_VECTORS, rotation);
+    Vector3DScalarKernels::rotate(sx.data(), sy.data(), sz.data(), KERNEL_VECTORS, rotation);
+    lemlib::bench::check("Vector3DKernels::rotate x", x, sx, 0);
+    lemlib::bench::check("Vector3DKernels::rotate z", z, sz, 0);
+
+    // how much faster the NEON loops are than the scalar loops they replace
+    reset();
+    run("Vector3DKernels::rotate", ITERATIONS,
+        [&] { Vector3DKernels::rotate(x.data(), y.data(), z.data(), KERNEL_VECTORS, rotation); });
+    run("Vector3DScalarKernels::rotate", ITERATIONS,
+        [&] { Vector3DScalarKernels::rotate(sx.data(), sy.data(), sz.data(), KERNEL_VECTORS, rotation); });
+    run("Vector3DKernels::normalize", ITERATIONS,
+        [&] { Vector3DKernels::normalize(x.data(), y.data(), z.data(), KERNEL_VECTORS); });
+    run("Vector3DScalarKernels::normalize", ITERATIONS,
+        [&] { Vector3DScalarKernels::normalize(sx.data(), sy.data(), sz.data(), KERNEL_VECTORS); });
+}
+
+void benchPath() {
+    // a straight path, which the tracker walks along one waypoint per cycle, like a robot following it
+    std::vector<units::V2Position> waypoints;
+    for (size_t i = 0; i < WAYPOINTS; i++) waypoints.push_back(units::V2Position(i * 1_in, 0_in));
+    const lemlib::Path path(waypoints);
+    lemlib::PathTracker tracker(path);
+    size_t step = 0;
+    run("PathTracker::lookahead", ITERATIONS, [&] {
+        if (step % WAYPOINTS == 0) tracker.reset();
+        tracker.lookahead(units::V2Position((step++ % WAYPOINTS) * 1_in, 1_in), 12_in);
+    });
+    run("Path::closest", ITERATIONS, [&] { path.closest(units::V2Position(250_in, 1_in)); });
+}
+
+void benchTrig() {
+    // a single call is shorter than the timer resolution, so each run makes a batch of calls. The results are written to
+    // a volatile, so the compiler can't remove the calls
+    constexpr int BATCH = 100;
+    volatile double sink = 0;
+    const auto batch = [&](auto&& function) {
+        return [&, function] {
+            for (int i = 0; i < BATCH; i++) sink = function(from_stDeg(i));
+        };
+    };
+    run("units::sin + units::cos x100", ITERATIONS,
+        batch([](Angle angle) { return (units::sin(angle) + units::cos(angle)).internal(); }));
+    run("units::fast::sincos x100", ITERATIONS, batch([](Angle angle) {
+            const units::fast::SinCos sc = units::fast::sincos(angle);
+            return (sc.sin + sc.cos).internal();
+        }));
+    run("units::atan2 x100", ITERATIONS, batch([](Angle angle) { return units::atan2(angle, 1_stRad).internal(); }));
+    run("units::fast::atan2 x100", ITERATIONS,
+        batch([](Angle angle) { return units::fast::atan2(angle, 1_stRad).internal(); }));
+}
+
+void benchLookup() {
+    // a batch of lookups per run, written to a volatile, like the trig benchmarks
+    constexpr int BATCH = 100;
+    constexpr auto uniform =
+        units::LookupTable<Number, Number, 33>::sample(-1, 1, [](Number x) { return x * x * x; });
+    constexpr units::LookupTable<Number, Number, 8> breakpoints({-1, -0.5, -0.2, -0.05, 0.05, 0.2, 0.5, 1},
+                                                                {-1, -0.3, -0.05, 0, 0, 0.05, 0.3, 1});
+    volatile double sink = 0;
+    run("LookupTable uniform x100", ITERATIONS, [&] {
+        for (int i = 0; i < BATCH; i++) sink = uniform(i / 50.0 - 1).internal();
+    });
+    run("LookupTable breakpoints x100", ITERATIONS, [&] {
+        for (int i = 0; i < BATCH; i++) sink = breakpoints(i / 50.0 - 1).internal();
+    });
+}
+
+void benchQueues() {
+    // a message pushed and popped per run, without a waiting consumer, so this is the cost of the ring alone
+    static lemlib::SpscQueue<uint32_t, 64> spsc;
+    static lemlib::MpscQueue<uint32_t, 64> mpsc;
+    uint32_t message = 0;
+    run("SpscQueue push + pop", ITERATIONS, [&] {
+        spsc.push(message);
+        spsc.tryPop(message);
+    });
+    run("MpscQueue push + pop", ITERATIONS, [&] {
+        mpsc.push(message);
+        mpsc.tryPop(message);
+    });
+}
+
+void benchReplay() {
+    // the logs the regression gate replays. Each one is a log written by TelemetryLogger, with the trajectory of the
+    // match next to it. The first run of a log saves its baseline, and later runs compare with it
+    static constexpr const char* LOGS[] = {"/usd/replay/0", "/usd/replay/1", "/usd/replay/2", "/usd/replay/3"};
+    static std::array<lemlib::PathRecord, 2048> records;
+    lemlib::DifferentialDrive drive({GROUP_PORT_A}, {GROUP_PORT_B}, 450_rpm);
+    for (const char* name : LOGS) {
+        char path[32];
+        std::snprintf(path, sizeof(path), "%s.bin", name);
+        lemlib::ReplayLog log;
+        if (log.load(path) != 0) continue;
+        std::snprintf(path, sizeof(path), "%s.lpth", name);
+        const int32_t count = lemlib::loadPath(path, records);
+        std::vector<lemlib::PathSample> trajectory;
+        for (int32_t i = 0; count != INT_MAX && i < count; i++) {
+            trajectory.push_back(lemlib::decodePathRecord(records[i]));
+        }
+        // a log without a trajectory is tracked against a single point at rest
+        if (trajectory.empty()) trajectory.emplace_back();
+        lemlib::ReplayGate gate(log, trajectory, {}, &drive);
+        if (gate.run() == INT_MAX) continue;
+        gate.print(name);
+        std::snprintf(path, sizeof(path), "%s.base", name);
+        lemlib::ReplayReport report;
+        if (gate.compare(path, {}, &report) == INT_MAX && errno != ERANGE && errno != ETIMEDOUT) {
+            gate.saveBaseline(path);
+            std::printf("REPLAY_GATE {\"log\":\"%s\",\"baseline\":\"saved\"}\n", name);
+            continue;
+        }
+        std::printf("REPLAY_GATE {\"log\":\"%s\",\"passed\":%s,\"position_in\":%.4f,\"orientation_deg\":%.4f,"
+                    "\"command_mps\":%.5f,\"slowdown\":[%.2f,%.2f,%.2f]}\n",
+                    name, report.passed ? "true" : "false", to_in(report.position), to_stDeg(report.orientation),
+                    to_mps(report.command), report.slowdown[0], report.slowdown[1], report.slowdown[2]);
+    }
+    std::fflush(stdout);
+}
+
+void benchLatency() {
+    lemlib::Motor motor(MOTOR_PORT, 200_rpm);
+    lemlib::V5RotationSensor sensor(ROTATION_PORT);
+    // the fastest the sensor measures, so the time until its next sample adds as little as possible
+    sensor.setDataRate(5_msec);
+    double start = INFINITY;
+    const auto rest = [&](size_t) {
+        motor.move(0);
+        pros::delay(REST_MSEC);
+        start = to_stDeg(sensor.getAngle());
+    };
+    const auto moved = [&](size_t) {
+        const double turned = std::abs(to_stDeg(sensor.getAngle()) - start);
+        // an angle which could not be read is INFINITY, and never counts as motion
+        return turned > ONSET_DEG && turned < INFINITY;
+    };
+    // the direction alternates, so the shaft stays near where it started
+    lemlib::bench::latency("Motor::move", LATENCY_TRIALS, 500000, rest,
+                           [&](size_t trial) { motor.move(trial % 2 == 0 ? 0.5 : -0.5); }, moved);
+    lemlib::bench::latency("Motor::moveVelocity", LATENCY_TRIALS, 500000, rest,
+                           [&](size_t trial) { motor.moveVelocity(trial % 2 == 0 ? 100_rpm : -100_rpm); }, moved);
+    motor.move(0);
+}
+
+// set while the jitter benchmark wants a user task to keep the CPU busy
+std::atomic<bool> spinning = false;
+
+void spin(void*) {
+    while (spinning.load()) {}
+}
+
+void benchJitter() {
+    static std::array<uint64_t, ITERATIONS> wakeups;
+    // a bare task_delay_until loop is the best any periodic task can do
+    uint32_t now = pros::millis();
+    for (uint64_t& wakeup : wakeups) {
+        pros::c::task_delay_until(&now, JITTER_PERIOD);
+        wakeup = pros::micros();
+    }
+    lemlib::bench::jitter("task_delay_until", JITTER_PERIOD * 1000, wakeups);
+    // a callback of the ControlScheduler, with the CPU idle, and with a user task at the default priority which never
+    // sleeps, like a driver control loop which doesn't delay
+    for (const bool busy : {false, true}) {
+        std::atomic<size_t> ticks = 0;
+        lemlib::ControlScheduler scheduler;
+        scheduler.add(
+            [&] {
+                const size_t tick = ticks.load();
+                if (tick < wakeups.size()) wakeups[tick] = pros::micros();
+                ticks = tick + 1;
+            },
+            from_msec(JITTER_PERIOD));
+        spinning = busy;
+        if (busy) pros::c::task_create(spin, nullptr, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_MIN, "bench spinner");
+        scheduler.start();
+        while (ticks.load() < wakeups.size()) pros::delay(JITTER_PERIOD);
+        scheduler.stop();
+        // the spinner returns once it sees the flag, which deletes its task
+        spinning = false;
+        lemlib::bench::jitter(busy ? "ControlScheduler (busy user task)" : "ControlScheduler", JITTER_PERIOD * 1000,
+                              wakeups);
+    }
+}
+
+void initialize() {
+    // give vexos time to report every connected device
+    pros::delay(500);
+    std::printf("BENCH_START\n");
+    benchMotor();
+    benchMotorGroup();
+    benchStaticMotorGroup();
+    benchEncoders();
+    benchIMU();
+    benchOverhead();
+    benchPoses();
+    benchVectors();
+    benchVectorKernels();
+    benchPath();
+    benchTrig();
+    benchLookup();
+    benchQueues();
+    benchReplay();
+    benchJitter();
+    benchLatency();
+    std::printf("BENCH_END\n");
+    std::fflush(stdout);
+}
+
+#endif
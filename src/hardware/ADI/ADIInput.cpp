@@ -0,0 +1,45 @@
+#include "hardware/ADI/ADIInput.hpp"
+#include "hardware/SdkCallTracker.hpp"
+#include <climits>
+#include <errno.h>
+
+namespace lemlib {
+ADIDigitalInput::ADIDigitalInput(ADIPort port)
+    : ADIInput(DeviceRegistry::BRAIN_ADI_PORT, port),
+      m_input(port) {}
+
+ADIDigitalInput::ADIDigitalInput(SmartPort expanderPort, ADIPort port)
+    : ADIInput(expanderPort, port),
+      m_input(pros::adi::ext_adi_port_pair_t {expanderPort, port}) {}
+
+int32_t ADIDigitalInput::read() const {
+    const int32_t value = LEMLIB_SDK_CALL(m_expanderPort, m_input.get_value());
+    if (value == INT_MAX) {
+        errno = ENODEV;
+        return INT_MAX;
+    }
+    return value != 0;
+}
+
+ADILineTracker::ADILineTracker(ADIPort port, int32_t threshold)
+    : ADIInput(DeviceRegistry::BRAIN_ADI_PORT, port),
+      m_input(port),
+      m_threshold(threshold) {}
+
+ADILineTracker::ADILineTracker(SmartPort expanderPort, ADIPort port, int32_t threshold)
+    : ADIInput(expanderPort, port),
+      m_input(pros::adi::ext_adi_port_pair_t {expanderPort, port}),
+      m_threshold(threshold) {}
+
+int32_t ADILineTracker::read() const {
+    const int32_t value = getValue();
+    if (value == INT_MAX) return INT_MAX;
+    return value < m_threshold;
+}
+
+int32_t ADILineTracker::getValue() const {
+    const int32_t value = LEMLIB_SDK_CALL(m_expanderPort, m_input.get_value());
+    if (value == INT_MAX) errno = ENODEV;
+    return value;
+}
+} // namespace lemlib
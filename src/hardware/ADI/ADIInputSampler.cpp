@@ -0,0 +1,161 @@
+#include "hardware/ADI/ADIInputSampler.hpp"
+#include "hardware/BootTrace.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+ADIInputSampler::ADIInputSampler(Time period)
+    : m_period(period) {}
+
+ADIInputSampler::~ADIInputSampler() { stop(); }
+
+int32_t ADIInputSampler::addInput(ADIInput& input) {
+    std::lock_guard lock(m_mutex);
+    const size_t index = m_inputCount.load(std::memory_order_relaxed);
+    if (index == MAX_INPUTS) {
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    m_inputs[index].input = &input;
+    // publish the entry only after it has been filled in
+    m_inputCount.store(index + 1, std::memory_order_release);
+    return index;
+}
+
+int32_t ADIInputSampler::getLevel(int32_t index) const {
+    if (index < 0 || size_t(index) >= m_inputCount.load(std::memory_order_acquire)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    const int32_t level = m_inputs[index].level.load(std::memory_order_acquire);
+    if (level == INT_MAX) errno = ENODEV;
+    return level;
+}
+
+InputEdge ADIInputSampler::getLastEdge(int32_t index) const {
+    if (index < 0 || size_t(index) >= m_inputCount.load(std::memory_order_acquire)) {
+        errno = EINVAL;
+        return {};
+    }
+    return m_inputs[index].edge.read();
+}
+
+InputEdge ADIInputSampler::waitForEdge(int32_t index, EdgeKind kind, Time timeout) {
+    if (index < 0 || size_t(index) >= m_inputCount.load(std::memory_order_acquire)) {
+        errno = EINVAL;
+        return {};
+    }
+    LEMLIB_BOOT_EVENT("create lemlib adi input sampler task", 0);
+    const pros::task_t task = pros::c::task_get_current();
+    Waiter* waiter = nullptr;
+    {
+        std::lock_guard lock(m_waiterMutex);
+        for (Waiter& slot : m_waiters) {
+            if (slot.task != nullptr) continue;
+            slot = {.task = task, .index = size_t(index), .kind = kind, .woken = false, .edge = {}};
+            waiter = &slot;
+            break;
+        }
+        if (waiter == nullptr) {
+            errno = EBUSY;
+            return {};
+        }
+        m_waiterCount.fetch_add(1, std::memory_order_release);
+    }
+    // a notification left over from an earlier wait would end this one early, so it is cleared first
+    pros::c::task_notify_take(true, 0);
+    const uint32_t start = pros::c::millis();
+    const bool forever = timeout == from_sec(INFINITY);
+    const uint32_t milliseconds = forever ? 0 : std::max(0.0, std::round(to_msec(timeout)));
+    InputEdge result;
+    while (true) {
+        {
+            std::lock_guard lock(m_waiterMutex);
+            if (waiter->woken) {
+                result = waiter->edge;
+                break;
+            }
+        }
+        const uint32_t elapsed = pros::c::millis() - start;
+        if (!forever && elapsed >= milliseconds) break;
+        pros::c::task_notify_take(true, forever ? TIMEOUT_MAX : milliseconds - elapsed);
+    }
+    {
+        std::lock_guard lock(m_waiterMutex);
+        waiter->task = nullptr;
+        m_waiterCount.fetch_sub(1, std::memory_order_release);
+    }
+    if (result.count == 0) errno = ETIMEDOUT;
+    return result;
+}
+
+void ADIInputSampler::notifyWaiters(size_t index, const InputEdge& edge) {
+    std::lock_guard lock(m_waiterMutex);
+    for (Waiter& waiter : m_waiters) {
+        if (waiter.task == nullptr || waiter.woken || waiter.index != index) continue;
+        if (waiter.kind == EdgeKind::RISING && !edge.rising) continue;
+        if (waiter.kind == EdgeKind::FALLING && edge.rising) continue;
+        waiter.woken = true;
+        waiter.edge = edge;
+        pros::c::task_notify(waiter.task);
+    }
+}
+
+void ADIInputSampler::update() {
+    // the count is only read once, so inputs registered during the update are read in the next one
+    const size_t count = m_inputCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
+        InputEntry& entry = m_inputs[i];
+        const int32_t level = entry.input->read();
+        const Time timestamp = from_usec(pros::c::micros());
+        const int32_t previous = entry.level.exchange(level, std::memory_order_acq_rel);
+        // errors aren't edges, and neither is the first successful read after one
+        if (level == INT_MAX || previous == INT_MAX || level == previous) continue;
+        // only this task writes the edges, so the count can be read back from the buffer
+        const InputEdge edge {.timestamp = timestamp, .rising = level == 1, .count = entry.edge.read().count + 1};
+        entry.edge.write(edge);
+        if (m_waiterCount.load(std::memory_order_acquire) != 0) notifyWaiters(i, edge);
+    }
+}
+
+int32_t ADIInputSampler::start(uint32_t priority) {
+    std::lock_guard lock(m_mutex);
+    if (m_running.load() || !m_taskExited.load()) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    m_running = true;
+    m_taskExited = false;
+    const pros::task_t task =
+        pros::c::task_create(taskFunction, this, priority, TASK_STACK_DEPTH_DEFAULT, "lemlib adi input sampler");
+    if (task == nullptr) {
+        m_running = false;
+        m_taskExited = true;
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+void ADIInputSampler::stop() {
+    m_running = false;
+    // wait for the task to finish its current update, so the sampler can be safely destroyed afterwards
+    while (!m_taskExited.load()) pros::c::delay(1);
+}
+
+void ADIInputSampler::taskFunction(void* sampler) {
+    ADIInputSampler& self = *static_cast<ADIInputSampler*>(sampler);
+    const uint32_t period = std::max(1.0, std::round(to_msec(self.m_period)));
+    uint32_t now = pros::c::millis();
+    while (self.m_running.load()) {
+        self.update();
+        pros::c::task_delay_until(&now, period);
+    }
+    // PROS deletes the task once this function returns
+    self.m_taskExited = true;
+}
+} // namespace lemlib
@@ -0,0 +1,179 @@
+#include "hardware/AllocationTracker.hpp"
+#include <array>
+#include <atomic>
+#include <cinttypes>
+#include <cstdlib>
+#include <new>
+
+namespace lemlib {
+namespace {
+/**
+ * @brief The allocations of a single task
+ */
+struct TaskEntry {
+        std::atomic<pros::task_t> task = nullptr;
+        std::atomic<uint32_t> allocations = 0;
+        std::atomic<uint32_t> frees = 0;
+        std::atomic<uint64_t> bytes = 0;
+        // only the task itself reads and writes its scope
+        const char* scope = nullptr;
+};
+
+constexpr size_t MAX_TASKS = 32;
+
+// everything is constant initialized, so allocations made by static initializers are tracked too
+std::array<TaskEntry, MAX_TASKS> entries {};
+std::atomic<uint32_t> totalAllocations = 0;
+std::atomic<uint32_t> totalFrees = 0;
+std::atomic<uint64_t> totalBytes = 0;
+
+void defaultFailureHandler(const char* scope, size_t size) {
+    std::fprintf(stderr, "lemlib: %zu byte allocation inside allocation-free scope %s\n", size, scope);
+    std::abort();
+}
+
+std::atomic<AllocationFailureHandler> failureHandler = defaultFailureHandler;
+
+/**
+ * @brief Find the entry of a task
+ *
+ * @param task the task
+ * @param create whether to claim a free entry if the task doesn't have one yet
+ * @return TaskEntry* the entry, or nullptr if the task has none, and none could be claimed
+ */
+TaskEntry* findEntry(pros::task_t task, bool create) {
+    // allocations made before the scheduler starts have no task
+    if (task == nullptr) return nullptr;
+    for (TaskEntry& entry : entries) {
+        pros::task_t current = entry.task.load(std::memory_order_acquire);
+        if (current == task) return &entry;
+        if (current != nullptr) continue;
+        if (!create) return nullptr;
+        // entries are claimed in order and never released, so the first free entry ends the search
+        if (entry.task.compare_exchange_strong(current, task, std::memory_order_acq_rel) || current == task) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+} // namespace
+
+#ifdef LEMLIB_TRACK_ALLOCATIONS
+namespace {
+void* trackedAllocate(size_t size, size_t alignment) {
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    totalBytes.fetch_add(size, std::memory_order_relaxed);
+    TaskEntry* entry = findEntry(pros::c::task_get_current(), true);
+    if (entry != nullptr) {
+        entry->allocations.fetch_add(1, std::memory_order_relaxed);
+        entry->bytes.fetch_add(size, std::memory_order_relaxed);
+        if (entry->scope != nullptr) failureHandler.load()(entry->scope, size);
+    }
+    if (size == 0) size = 1;
+    if (alignment <= alignof(std::max_align_t)) return std::malloc(size);
+    // aligned_alloc needs the size to be a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void trackedFree(void* pointer) {
+    if (pointer == nullptr) return;
+    totalFrees.fetch_add(1, std::memory_order_relaxed);
+    TaskEntry* entry = findEntry(pros::c::task_get_current(), false);
+    if (entry != nullptr) entry->frees.fetch_add(1, std::memory_order_relaxed);
+    std::free(pointer);
+}
+
+void* allocateOrThrow(size_t size, size_t alignment) {
+    void* pointer = trackedAllocate(size, alignment);
+    if (pointer == nullptr) throw std::bad_alloc();
+    return pointer;
+}
+} // namespace
+#endif
+
+bool isTrackingAllocations() {
+#ifdef LEMLIB_TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+AllocationStats getAllocationStats() {
+    return {.allocations = totalAllocations.load(), .frees = totalFrees.load(), .bytes = totalBytes.load()};
+}
+
+AllocationStats getTaskAllocationStats(pros::task_t task) {
+    const TaskEntry* entry = findEntry(task, false);
+    if (entry == nullptr) return {};
+    return {.allocations = entry->allocations.load(), .frees = entry->frees.load(), .bytes = entry->bytes.load()};
+}
+
+int32_t dumpAllocations(FILE* file) {
+    std::fprintf(file, "task,allocations,frees,bytes\n");
+    for (const TaskEntry& entry : entries) {
+        const pros::task_t task = entry.task.load(std::memory_order_acquire);
+        if (task == nullptr) break;
+        std::fprintf(file, "%p,%" PRIu32 ",%" PRIu32 ",%" PRIu64 "\n", task, entry.allocations.load(),
+                     entry.frees.load(), entry.bytes.load());
+    }
+    std::fflush(file);
+    return 0;
+}
+
+void setAllocationFailureHandler(AllocationFailureHandler handler) {
+    failureHandler.store(handler == nullptr ? defaultFailureHandler : handler);
+}
+
+AllocationFreeScope::AllocationFreeScope(const char* name)
+    : m_previous(nullptr) {
+    TaskEntry* entry = findEntry(pros::c::task_get_current(), true);
+    if (entry == nullptr) return;
+    m_previous = entry->scope;
+    entry->scope = name;
+}
+
+AllocationFreeScope::~AllocationFreeScope() {
+    TaskEntry* entry = findEntry(pros::c::task_get_current(), false);
+    if (entry != nullptr) entry->scope = m_previous;
+}
+} // namespace lemlib
+
+// the replacements of the global operator new and operator delete, which every allocation goes through
+#ifdef LEMLIB_TRACK_ALLOCATIONS
+void* operator new(size_t size) { return lemlib::allocateOrThrow(size, 0); }
+
+void* operator new[](size_t size) { return lemlib::allocateOrThrow(size, 0); }
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return lemlib::allocateOrThrow(size, size_t(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return lemlib::allocateOrThrow(size, size_t(alignment));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return lemlib::trackedAllocate(size, 0); }
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return lemlib::trackedAllocate(size, 0); }
+
+void operator delete(void* pointer) noexcept { lemlib::trackedFree(pointer); }
+
+void operator delete[](void* pointer) noexcept { lemlib::trackedFree(pointer); }
+
+void operator delete(void* pointer, size_t) noexcept { lemlib::trackedFree(pointer); }
+
+void operator delete[](void* pointer, size_t) noexcept { lemlib::trackedFree(pointer); }
+
+void operator delete(void* pointer, std::align_val_t) noexcept { lemlib::trackedFree(pointer); }
+
+void operator delete[](void* pointer, std::align_val_t) noexcept { lemlib::trackedFree(pointer); }
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { lemlib::trackedFree(pointer); }
+
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { lemlib::trackedFree(pointer); }
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { lemlib::trackedFree(pointer); }
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { lemlib::trackedFree(pointer); }
+#endif
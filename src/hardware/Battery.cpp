@@ -0,0 +1,48 @@
+#include "hardware/Battery.hpp"
+#include "hardware/SdkCallTracker.hpp"
+#include "pros/misc.h"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+
+namespace lemlib {
+Battery& Battery::get() {
+    static Battery battery;
+    return battery;
+}
+
+Voltage Battery::getVoltage() {
+    const uint32_t now = pros::c::millis();
+    if (!m_updated.load(std::memory_order_acquire) ||
+        now - m_updateTime.load(std::memory_order_relaxed) >= m_updatePeriod.load(std::memory_order_relaxed)) {
+        update();
+    }
+    // the first reading can still be in progress in another task, in which case the battery is read directly
+    const int32_t millivolts =
+        m_updated.load(std::memory_order_acquire) ? m_millivolts.load(std::memory_order_relaxed)
+                                                  : LEMLIB_SDK_CALL(0, pros::c::battery_get_voltage());
+    if (millivolts == INT32_MAX) { // error checking
+        errno = EACCES;
+        return from_volt(INFINITY);
+    }
+    return from_volt(millivolts / 1000.0);
+}
+
+void Battery::update() {
+    // only one task reads the battery. The others use the previous reading, which is at most one period older
+    if (m_updating.exchange(true, std::memory_order_acquire)) return;
+    m_millivolts.store(LEMLIB_SDK_CALL(0, pros::c::battery_get_voltage()), std::memory_order_relaxed);
+    m_updateTime.store(pros::c::millis(), std::memory_order_relaxed);
+    m_updated.store(true, std::memory_order_release);
+    m_updating.store(false, std::memory_order_release);
+}
+
+int32_t Battery::setUpdatePeriod(Time period) {
+    m_updatePeriod = std::max(0.0, std::round(to_msec(period)));
+    return 0;
+}
+
+Time Battery::getUpdatePeriod() const { return from_msec(m_updatePeriod.load()); }
+} // namespace lemlib
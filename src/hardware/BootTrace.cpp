@@ -0,0 +1,99 @@
+#include "hardware/BootTrace.hpp"
+#include "hardware/Trace.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cinttypes>
+#include <climits>
+
+namespace lemlib {
+namespace {
+// the duration of a span which hasn't ended yet
+constexpr uint32_t UNFINISHED = UINT32_MAX;
+// the duration of an instant
+constexpr uint32_t INSTANT = UINT32_MAX - 1;
+
+struct BootEvent {
+        // written last, so an event is complete once its name isn't nullptr
+        std::atomic<const char*> name;
+        uint32_t start;
+        std::atomic<uint32_t> duration;
+        uint8_t port;
+        uint8_t track;
+};
+
+std::array<BootEvent, LEMLIB_BOOT_TRACE_SIZE> events {};
+// the number of events which were claimed, including dropped ones
+std::atomic<size_t> claimed = 0;
+
+/**
+ * @brief Claim and fill in the next event
+ *
+ * @return size_t the index of the event, or SIZE_MAX if the trace is full
+ */
+size_t record(const char* name, uint8_t port, uint32_t duration) {
+    const size_t index = claimed.fetch_add(1, std::memory_order_relaxed);
+    if (index >= events.size()) return SIZE_MAX;
+    BootEvent& event = events[index];
+    event.start = pros::c::micros();
+    event.port = port;
+    event.track = detail::getTraceTrack();
+    event.duration.store(duration, std::memory_order_relaxed);
+    event.name.store(name, std::memory_order_release);
+    return index;
+}
+} // namespace
+
+size_t beginBootSpan(const char* name, uint8_t port) { return record(name, port, UNFINISHED); }
+
+void endBootSpan(size_t index) {
+    if (index >= events.size()) return;
+    BootEvent& event = events[index];
+    event.duration.store(pros::c::micros() - event.start, std::memory_order_relaxed);
+}
+
+void recordBootEvent(const char* name, uint8_t port) { record(name, port, INSTANT); }
+
+int32_t dumpBootTrace(FILE* file) {
+    const size_t count = std::min(claimed.load(std::memory_order_relaxed), events.size());
+    const uint32_t now = pros::c::micros();
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"V5 brain\"}}");
+    detail::writeTraceTracks(file);
+    for (size_t i = 0; i < count; i++) {
+        const BootEvent& event = events[i];
+        // an event which is still being recorded is left out
+        const char* const name = event.name.load(std::memory_order_acquire);
+        if (name == nullptr) continue;
+        const uint32_t duration = event.duration.load(std::memory_order_relaxed);
+        std::fprintf(file, ",\n{\"name\":");
+        detail::writeJsonString(file, name);
+        std::fprintf(file, ",\"cat\":\"boot\",\"pid\":1,\"tid\":%u,\"ts\":%" PRIu32, event.track + 1u, event.start);
+        if (duration == INSTANT) {
+            std::fprintf(file, ",\"ph\":\"i\",\"s\":\"t\"");
+        } else {
+            const uint32_t elapsed = duration == UNFINISHED ? now - event.start : duration;
+            std::fprintf(file, ",\"ph\":\"X\",\"dur\":%" PRIu32, elapsed);
+        }
+        if (event.port != 0) std::fprintf(file, ",\"args\":{\"port\":%u}", event.port);
+        std::fprintf(file, "}");
+    }
+    std::fprintf(file, "\n]}\n");
+    std::fflush(file);
+    return 0;
+}
+
+int32_t dumpBootTrace(const char* path) {
+    FILE* file = std::fopen(path, "w");
+    // fopen has already set errno
+    if (file == nullptr) return INT_MAX;
+    dumpBootTrace(file);
+    std::fclose(file);
+    return 0;
+}
+
+size_t getDroppedBootEvents() {
+    const size_t total = claimed.load(std::memory_order_relaxed);
+    return total > events.size() ? total - events.size() : 0;
+}
+} // namespace lemlib
@@ -0,0 +1,247 @@
+#include "hardware/ControlScheduler.hpp"
+#include "hardware/BootTrace.hpp"
+#include "hardware/TaskManager.hpp"
+#include "hardware/TaskMonitor.hpp"
+#include "hardware/TelemetryLogger.hpp"
+#include "hardware/Trace.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <mutex>
+#include <numeric>
+
+namespace lemlib {
+namespace {
+// phases are only balanced over this many ticks, so periods with a huge least common multiple don't take forever
+constexpr uint32_t MAX_HYPERPERIOD = 1000;
+} // namespace
+
+ControlScheduler::ControlScheduler(Time tick)
+    : m_tick(tick) {}
+
+ControlScheduler::~ControlScheduler() { stop(); }
+
+int32_t ControlScheduler::add(std::function<void()> callback, Time period, CallbackPriority priority) {
+    if (!callback) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    std::lock_guard lock(m_mutex);
+    const size_t index = m_count.load(std::memory_order_relaxed);
+    if (index == MAX_CALLBACKS) {
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    const uint32_t ticks = std::max(1.0, std::round(to_sec(period) / to_sec(m_tick)));
+    Entry& entry = m_entries[index];
+    entry.callback = std::move(callback);
+    entry.ticks = ticks;
+    entry.phase = findPhase(ticks);
+    entry.priority = priority;
+    entry.timing.write({.period = m_tick * ticks, .phase = entry.phase});
+    // publish the entry only after it has been filled in
+    m_count.store(index + 1, std::memory_order_release);
+    return index;
+}
+
+uint32_t ControlScheduler::findPhase(uint32_t ticks) const {
+    const size_t count = m_count.load(std::memory_order_relaxed);
+    // the schedule repeats every least common multiple of the periods. Phases past the end of a capped schedule
+    // count as empty
+    uint32_t hyperperiod = std::min(ticks, MAX_HYPERPERIOD);
+    for (size_t i = 0; i < count; i++) {
+        hyperperiod = std::min<uint64_t>(std::lcm<uint64_t>(hyperperiod, m_entries[i].ticks), MAX_HYPERPERIOD);
+    }
+    // the number of callbacks already running on each tick of the schedule
+    std::array<uint8_t, MAX_HYPERPERIOD> load {};
+    for (size_t i = 0; i < count; i++) {
+        for (uint32_t t = m_entries[i].phase; t < hyperperiod; t += m_entries[i].ticks) load[t]++;
+    }
+    // the phase whose busiest tick is the least busy, breaking ties with the total work on its ticks
+    uint32_t best = 0;
+    uint32_t bestPeak = UINT32_MAX;
+    uint32_t bestTotal = UINT32_MAX;
+    for (uint32_t phase = 0; phase < ticks; phase++) {
+        uint32_t peak = 0;
+        uint32_t total = 0;
+        for (uint32_t t = phase; t < hyperperiod; t += ticks) {
+            peak = std::max<uint32_t>(peak, load[t]);
+            total += load[t];
+        }
+        if (peak < bestPeak || (peak == bestPeak && total < bestTotal)) {
+            best = phase;
+            bestPeak = peak;
+            bestTotal = total;
+        }
+    }
+    return best;
+}
+
+CallbackTiming ControlScheduler::getTiming(int32_t index) const {
+    if (index < 0 || size_t(index) >= m_count.load(std::memory_order_acquire)) {
+        errno = EINVAL;
+        return {};
+    }
+    return m_entries[index].timing.read();
+}
+
+uint32_t ControlScheduler::getLateTicks() const { return m_lateTicks.load(); }
+
+int32_t ControlScheduler::setOverrunPolicy(OverrunPolicy policy) {
+    if (policy.overrunLimit == 0 || policy.recoveryTicks == 0 || policy.stepCount == 0 ||
+        policy.stepCount > OverrunPolicy::MAX_STEPS) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    std::lock_guard lock(m_mutex);
+    m_policy.write(policy);
+    m_policyChanged = true;
+    return 0;
+}
+
+OverrunPolicy ControlScheduler::getOverrunPolicy() const { return m_policy.read(); }
+
+uint32_t ControlScheduler::getDegradationLevel() const { return m_level.load(); }
+
+int32_t ControlScheduler::getDegradationEvents(std::span<DegradationEvent> buffer) const {
+    const DegradationLog log = m_log.read();
+    const size_t kept = std::min<size_t>(log.count, MAX_EVENTS);
+    const size_t count = std::min(kept, buffer.size());
+    // the latest events are the most useful, so the oldest are the ones left out
+    for (size_t i = 0; i < count; i++) buffer[i] = log.events[(log.count - count + i) % MAX_EVENTS];
+    return count;
+}
+
+void ControlScheduler::update() {
+    LEMLIB_TRACE_SCOPE("ControlScheduler::update");
+    // the count is only read once, so callbacks added during the tick start in the next one
+    const size_t count = m_count.load(std::memory_order_acquire);
+    const uint32_t tick = m_tickCount.load(std::memory_order_relaxed);
+    const uint32_t level = m_level.load(std::memory_order_relaxed);
+    const OverrunPolicy policy = level == 0 ? OverrunPolicy() : m_policy.read();
+    const DegradationStep* step = level == 0 ? nullptr : &policy.steps[std::min(level, policy.stepCount) - 1];
+    // critical callbacks run first, so slow callbacks which share their tick don't delay them
+    runCallbacks(count, tick, true, step);
+    runCallbacks(count, tick, false, step);
+    m_tickCount.store(tick + 1, std::memory_order_relaxed);
+}
+
+void ControlScheduler::runCallbacks(size_t count, uint32_t tick, bool critical, const DegradationStep* step) {
+    const uint64_t tickMicros = std::round(to_usec(m_tick));
+    for (size_t i = 0; i < count; i++) {
+        Entry& entry = m_entries[i];
+        if ((entry.priority == CallbackPriority::CRITICAL) != critical) continue;
+        if (tick % entry.ticks != entry.phase) continue;
+        if (step != nullptr && !critical) {
+            const uint32_t divider =
+                entry.priority == CallbackPriority::BACKGROUND ? step->backgroundDivider : step->normalDivider;
+            // counting the runs the callback would have had keeps its phase, so degraded callbacks stay spread out
+            if (divider == 0 || (tick / entry.ticks) % divider != 0) continue;
+        }
+        const uint64_t start = pros::c::micros();
+        entry.callback();
+        const uint64_t elapsed = pros::c::micros() - start;
+        // only the scheduler task writes the timing, so it can be updated in place
+        CallbackTiming timing = entry.timing.read();
+        timing.lastExecution = from_usec(elapsed);
+        timing.maxExecution = std::max(timing.maxExecution, timing.lastExecution);
+        timing.runs++;
+        if (elapsed > tickMicros) timing.overruns++;
+        entry.execution.add(timing.lastExecution);
+        entry.p99Execution.add(timing.lastExecution);
+        timing.meanExecution = entry.execution.mean();
+        // a single run has no spread
+        timing.executionStdDev = entry.execution.count() < 2 ? 0_sec : entry.execution.stddev();
+        timing.p99Execution = entry.p99Execution.value();
+        entry.timing.write(timing);
+    }
+}
+
+void ControlScheduler::watchdog(bool late) {
+    if (m_policyChanged.exchange(false)) {
+        m_level = 0;
+        m_consecutiveLate = 0;
+        m_consecutiveOnTime = 0;
+    }
+    const OverrunPolicy policy = m_policy.read();
+    if (!policy.enabled) return;
+    uint32_t level = m_level.load(std::memory_order_relaxed);
+    if (late) {
+        m_consecutiveOnTime = 0;
+        if (++m_consecutiveLate < policy.overrunLimit || level == policy.stepCount) return;
+        level++;
+    } else {
+        m_consecutiveLate = 0;
+        if (++m_consecutiveOnTime < policy.recoveryTicks || level == 0) return;
+        level--;
+    }
+    // each step gets a fresh count, so the scheduler changes at most one level per overrun limit or recovery period
+    const uint32_t consecutive = late ? m_consecutiveLate : m_consecutiveOnTime;
+    m_consecutiveLate = 0;
+    m_consecutiveOnTime = 0;
+    m_level = level;
+
+    const DegradationEvent event {
+        .time = from_usec(pros::c::micros()), .level = level, .lateTicks = m_lateTicks.load()};
+    DegradationLog log = m_log.read();
+    log.events[log.count % MAX_EVENTS] = event;
+    log.count++;
+    m_log.write(log);
+    if (policy.logger != nullptr) {
+        policy.logger->push({.timestamp = uint32_t(pros::c::micros()),
+                             .device = policy.device,
+                             .kind = TelemetryKind::CUSTOM,
+                             .error = 0,
+                             .values = {float(level), float(event.lateTicks), float(consecutive), float(late)}});
+    }
+}
+
+int32_t ControlScheduler::start(uint32_t priority) {
+    std::lock_guard lock(m_mutex);
+    if (m_running.load() || !m_taskExited.load()) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    m_running = true;
+    m_taskExited = false;
+    LEMLIB_BOOT_EVENT("create lemlib control scheduler task", 0);
+    const pros::task_t task = TaskManager::get().create(TaskRole::CONTROL_SCHEDULER, taskFunction, this, priority,
+                                                        "lemlib control scheduler");
+    if (task == nullptr) {
+        m_running = false;
+        m_taskExited = true;
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+void ControlScheduler::stop() {
+    m_running = false;
+    // wait for the task to finish its current tick, so the scheduler can be safely destroyed afterwards
+    while (!m_taskExited.load()) pros::c::delay(1);
+}
+
+void ControlScheduler::taskFunction(void* scheduler) {
+    ControlScheduler& self = *static_cast<ControlScheduler*>(scheduler);
+    const uint32_t period = std::max(1.0, std::round(to_msec(self.m_tick)));
+    uint32_t now = pros::c::millis();
+    const int32_t slot = TaskManager::get().attach(TaskRole::CONTROL_SCHEDULER, "lemlib control scheduler");
+    while (self.m_running.load()) {
+        {
+            TaskMonitor::Work work(slot);
+            self.update();
+        }
+        // task_delay_until wakes up on the next deadline, or straight away if it has already passed
+        const bool late = pros::c::millis() - now >= period;
+        if (late) self.m_lateTicks++;
+        self.watchdog(late);
+        pros::c::task_delay_until(&now, period);
+    }
+    TaskMonitor::get().detach(slot);
+    // PROS deletes the task once this function returns
+    self.m_taskExited = true;
+}
+} // namespace lemlib
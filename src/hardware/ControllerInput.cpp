@@ -0,0 +1,113 @@
+#include "hardware/ControllerInput.hpp"
+#include "hardware/AllocationTracker.hpp"
+#include "hardware/SdkCallTracker.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+namespace {
+constexpr size_t BUTTON_COUNT = pros::E_CONTROLLER_DIGITAL_A - pros::E_CONTROLLER_DIGITAL_L1 + 1;
+
+/**
+ * @brief Fill the lookup table of a curve
+ *
+ * @param curve the curve
+ * @param table the table, indexed by the raw position plus 127
+ */
+void fillTable(const AxisCurve& curve, std::array<float, 255>& table) {
+    const double expo = curve.expo.internal();
+    const double scale = curve.scale.internal();
+    for (int32_t raw = -127; raw <= 127; raw++) {
+        // the output starts from 0 at the edge of the deadband, so it doesn't jump
+        const double x = std::max(0, std::abs(raw) - curve.deadband) / double(127 - curve.deadband);
+        const double y = (1 - expo) * x + expo * x * x * x;
+        table[raw + 127] = std::copysign(y * scale, raw);
+    }
+}
+} // namespace
+
+ControllerInput::ControllerInput(pros::controller_id_e_t id)
+    : m_id(id) {
+    for (CurveTable& table : m_tables) fillTable(AxisCurve(), table);
+}
+
+int32_t ControllerInput::setCurve(pros::controller_analog_e_t axis, AxisCurve curve) {
+    if (axis < pros::E_CONTROLLER_ANALOG_LEFT_X || axis > pros::E_CONTROLLER_ANALOG_RIGHT_Y || curve.deadband < 0 ||
+        curve.deadband > 126 || !(curve.expo >= 0 && curve.expo <= 1) || !std::isfinite(curve.scale.internal())) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    CurveTable table;
+    fillTable(curve, table);
+    std::lock_guard lock(m_mutex);
+    m_tables[axis] = table;
+    return 0;
+}
+
+int32_t ControllerInput::subscribe(std::function<void(const ControllerSnapshot&)> callback) {
+    if (!callback) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    std::lock_guard lock(m_mutex);
+    const size_t index = m_subscriberCount.load(std::memory_order_relaxed);
+    if (index == MAX_SUBSCRIBERS) {
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    m_subscribers[index] = std::move(callback);
+    // publish the subscriber only after it has been filled in
+    m_subscriberCount.store(index + 1, std::memory_order_release);
+    return 0;
+}
+
+int32_t ControllerInput::update() {
+    ControllerSnapshot snapshot;
+    {
+        LEMLIB_ALLOCATION_FREE("ControllerInput::update");
+        snapshot.timestamp = from_usec(pros::c::micros());
+        // a controller which isn't connected reads 0 everywhere, so its other channels aren't read at all
+        snapshot.connected = LEMLIB_SDK_CALL(0, pros::c::controller_is_connected(m_id)) == 1;
+        if (snapshot.connected) {
+            for (size_t axis = 0; axis < snapshot.raw.size(); axis++) {
+                const int32_t raw = LEMLIB_SDK_CALL(
+                    0, pros::c::controller_get_analog(m_id, pros::controller_analog_e_t(axis)));
+                snapshot.raw[axis] = std::clamp(raw, -127, 127);
+            }
+            for (size_t button = 0; button < BUTTON_COUNT; button++) {
+                const auto id = pros::controller_digital_e_t(pros::E_CONTROLLER_DIGITAL_L1 + button);
+                if (LEMLIB_SDK_CALL(0, pros::c::controller_get_digital(m_id, id)) == 1) {
+                    snapshot.buttons |= 1u << button;
+                }
+            }
+            std::lock_guard lock(m_mutex);
+            for (size_t axis = 0; axis < snapshot.axes.size(); axis++) {
+                snapshot.axes[axis] = m_tables[axis][snapshot.raw[axis] + 127];
+            }
+        }
+        snapshot.pressed = snapshot.buttons & ~m_previous.buttons;
+        snapshot.released = m_previous.buttons & ~snapshot.buttons;
+    }
+    // moving a stick within its deadband doesn't change the snapshot, and neither does a tick without presses after
+    // one with presses
+    const bool changed = m_first || snapshot.connected != m_previous.connected || snapshot.axes != m_previous.axes ||
+                         snapshot.buttons != m_previous.buttons;
+    m_first = false;
+    m_previous = snapshot;
+    m_snapshot.write(snapshot);
+    if (changed) {
+        const size_t count = m_subscriberCount.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; i++) m_subscribers[i](snapshot);
+    }
+    if (!snapshot.connected) {
+        errno = ENODEV;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+ControllerSnapshot ControllerInput::getSnapshot() const { return m_snapshot.read(); }
+} // namespace lemlib
@@ -0,0 +1,241 @@
+#include "hardware/DeviceConfig.hpp"
+#include "hardware/BootTrace.hpp"
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <errno.h>
+
+namespace lemlib {
+namespace {
+/**
+ * @brief CRC-32 with the reflected polynomial 0xEDB88320, like zlib
+ *
+ * @param data the data to check
+ * @return uint32_t the checksum
+ */
+uint32_t crc32(std::span<const uint8_t> data) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (const uint8_t byte : data) {
+        crc ^= byte;
+        for (int i = 0; i < 8; i++) crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Get the checksum of a list of records
+ *
+ * @param records the records
+ * @return uint32_t the checksum
+ */
+uint32_t checksum(std::span<const ConfigRecord> records) {
+    return crc32({reinterpret_cast<const uint8_t*>(records.data()), records.size_bytes()});
+}
+
+/**
+ * @brief Copy a name into a record, padded with 0 bytes
+ *
+ * @param record the record
+ * @param name the name
+ * @return true the name fits
+ * @return false the name is too long or empty
+ */
+bool setName(ConfigRecord& record, const char* name) {
+    const size_t length = std::strlen(name);
+    if (length == 0 || length > ConfigRecord::MAX_NAME_LENGTH) return false;
+    std::memset(record.name, 0, sizeof(record.name));
+    std::memcpy(record.name, name, length);
+    return true;
+}
+
+/**
+ * @brief Check a list of records
+ *
+ * Ports are checked with the runtime constructor of ReversibleSmartPort, which applies the same rules as the consteval
+ * one, and makes an invalid port 0.
+ *
+ * @param records the records
+ * @return true every record is valid, and no port is used by two records
+ * @return false a record is invalid
+ */
+bool validate(std::span<const ConfigRecord> records) {
+    // a bit per smart port
+    uint32_t used = 0;
+    for (const ConfigRecord& record : records) {
+        // the name has to end within the record, so it can be compared as a string
+        if (record.name[0] == '\0' || record.name[ConfigRecord::MAX_NAME_LENGTH] != '\0') return false;
+        if (record.count > ConfigRecord::MAX_VALUES) return false;
+        if (record.type != ConfigRecordType::PORTS && record.type != ConfigRecordType::NUMBERS) return false;
+        for (size_t i = 0; i < record.count; i++) {
+            const float value = record.values[i];
+            if (!std::isfinite(value)) return false;
+            if (record.type != ConfigRecordType::PORTS) continue;
+            if (value != std::trunc(value) || std::abs(value) > 127) return false;
+            const uint8_t port = std::abs(int8_t(ReversibleSmartPort(int64_t(value), runtime_check_port)));
+            if (port == 0 || (used & (1u << port))) return false;
+            used |= 1u << port;
+        }
+    }
+    return true;
+}
+} // namespace
+
+int32_t makeConfigRecord(ConfigRecord& record, const char* name, std::span<const ReversibleSmartPort> ports) {
+    if (ports.size() > ConfigRecord::MAX_VALUES || !setName(record, name)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    record.type = ConfigRecordType::PORTS;
+    record.count = ports.size();
+    std::fill(std::begin(record.values), std::end(record.values), 0.0f);
+    for (size_t i = 0; i < ports.size(); i++) {
+        // the runtime constructor makes a port which is out of range 0
+        if (int8_t(ports[i]) == 0) {
+            errno = EINVAL;
+            return INT_MAX;
+        }
+        record.values[i] = int8_t(ports[i]);
+    }
+    return 0;
+}
+
+int32_t makeConfigRecord(ConfigRecord& record, const char* name, std::span<const double> values) {
+    // written so NaN fails the check
+    const bool finite = std::all_of(values.begin(), values.end(), [](double value) { return std::isfinite(value); });
+    if (values.size() > ConfigRecord::MAX_VALUES || !finite || !setName(record, name)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    record.type = ConfigRecordType::NUMBERS;
+    record.count = values.size();
+    std::fill(std::begin(record.values), std::end(record.values), 0.0f);
+    std::copy(values.begin(), values.end(), record.values);
+    return 0;
+}
+
+int32_t saveDeviceConfig(const char* path, std::span<const ConfigRecord> records) {
+    if (!validate(records) || records.size() > INT32_MAX) {
+        errno = EPROTO;
+        return INT_MAX;
+    }
+    FILE* file = std::fopen(path, "wb");
+    // fopen has already set errno
+    if (file == nullptr) return INT_MAX;
+    std::array<uint8_t, 16> header {'L', 'C', 'F', 'G'};
+    const uint16_t version = CONFIG_FORMAT_VERSION;
+    const uint16_t recordSize = sizeof(ConfigRecord);
+    const uint32_t count = records.size();
+    const uint32_t crc = checksum(records);
+    std::memcpy(&header[4], &version, sizeof(version));
+    std::memcpy(&header[6], &recordSize, sizeof(recordSize));
+    std::memcpy(&header[8], &count, sizeof(count));
+    std::memcpy(&header[12], &crc, sizeof(crc));
+    bool written = std::fwrite(header.data(), 1, header.size(), file) == header.size();
+    written = written && std::fwrite(records.data(), sizeof(ConfigRecord), records.size(), file) == records.size();
+    // the records may only reach the card when the file is closed
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        errno = EIO;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+DeviceConfigBase::DeviceConfigBase(ConfigRecord* storage, size_t capacity)
+    : m_storage(storage),
+      m_capacity(capacity) {}
+
+int32_t DeviceConfigBase::load(const char* path) {
+    LEMLIB_BOOT_SPAN("load device config", 0);
+    // a config which fails to load is empty, so nothing reads a half loaded file
+    m_size = 0;
+    FILE* file = std::fopen(path, "rb");
+    // fopen has already set errno
+    if (file == nullptr) return INT_MAX;
+    std::array<uint8_t, 16> header;
+    uint16_t version = 0;
+    uint16_t recordSize = 0;
+    uint32_t count = 0;
+    uint32_t crc = 0;
+    const bool valid = std::fread(header.data(), 1, header.size(), file) == header.size() &&
+                       std::memcmp(header.data(), "LCFG", 4) == 0;
+    std::memcpy(&version, &header[4], sizeof(version));
+    std::memcpy(&recordSize, &header[6], sizeof(recordSize));
+    std::memcpy(&count, &header[8], sizeof(count));
+    std::memcpy(&crc, &header[12], sizeof(crc));
+    if (!valid || version != CONFIG_FORMAT_VERSION || recordSize != sizeof(ConfigRecord)) {
+        std::fclose(file);
+        errno = EPROTO;
+        return INT_MAX;
+    }
+    if (count > m_capacity) {
+        std::fclose(file);
+        errno = ENOBUFS;
+        return INT_MAX;
+    }
+    // the records are read straight into the storage, in one read
+    const size_t read = std::fread(m_storage, sizeof(ConfigRecord), count, file);
+    std::fclose(file);
+    const std::span<const ConfigRecord> records(m_storage, count);
+    if (read != count || checksum(records) != crc || !validate(records)) {
+        errno = EPROTO;
+        return INT_MAX;
+    }
+    m_size = count;
+    return count;
+}
+
+size_t DeviceConfigBase::size() const { return m_size; }
+
+const ConfigRecord* DeviceConfigBase::find(const char* name, ConfigRecordType type) const {
+    for (const ConfigRecord& record : std::span(m_storage, m_size)) {
+        if (record.type == type && std::strncmp(record.name, name, sizeof(record.name)) == 0) return &record;
+    }
+    return nullptr;
+}
+
+Number DeviceConfigBase::getNumber(const char* name, Number fallback, size_t index) const {
+    const ConfigRecord* record = find(name, ConfigRecordType::NUMBERS);
+    if (record == nullptr || index >= record->count) return fallback;
+    return record->values[index];
+}
+
+int32_t DeviceConfigBase::getNumbers(const char* name, std::span<double> buffer) const {
+    const ConfigRecord* record = find(name, ConfigRecordType::NUMBERS);
+    if (record == nullptr) {
+        errno = ENOENT;
+        return INT_MAX;
+    }
+    const size_t count = std::min<size_t>(record->count, buffer.size());
+    std::copy_n(record->values, count, buffer.begin());
+    return count;
+}
+
+ReversibleSmartPort DeviceConfigBase::getPort(const char* name, ReversibleSmartPort fallback) const {
+    const ConfigRecord* record = find(name, ConfigRecordType::PORTS);
+    if (record == nullptr || record->count == 0) return fallback;
+    return ReversibleSmartPort(int64_t(record->values[0]), runtime_check_port);
+}
+
+int32_t DeviceConfigBase::addMotors(const char* name, MotorGroup& group,
+                                    std::initializer_list<ReversibleSmartPort> fallback) const {
+    const ConfigRecord* record = find(name, ConfigRecordType::PORTS);
+    if (record == nullptr) {
+        for (const ReversibleSmartPort port : fallback) {
+            // addMotor has already set errno
+            if (group.addMotor(port) == INT_MAX) return INT_MAX;
+        }
+        return 0;
+    }
+    for (size_t i = 0; i < record->count; i++) {
+        // addMotor has already set errno
+        if (group.addMotor(ReversibleSmartPort(int64_t(record->values[i]), runtime_check_port)) == INT_MAX) {
+            return INT_MAX;
+        }
+    }
+    return 0;
+}
+} // namespace lemlib
@@ -0,0 +1,380 @@
+#include "hardware/DevicePoller.hpp"
+#include "hardware/BootTrace.hpp"
+#include "hardware/DeviceRegistry.hpp"
+#include "hardware/TaskManager.hpp"
+#include "hardware/TaskMonitor.hpp"
+#include "hardware/Trace.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <mutex>
+#include <utility>
+
+namespace lemlib {
+namespace {
+/**
+ * @brief Create an array with every element set to the same value, for quantities which can't be default constructed
+ *
+ * @param value the value of every element
+ * @return std::array<T, N> the array
+ */
+template <typename T, size_t N> std::array<T, N> filledArray(T value) {
+    return [&]<size_t... I>(std::index_sequence<I...>) {
+        return std::array<T, N> {(static_cast<void>(I), value)...};
+    }(std::make_index_sequence<N>());
+}
+
+/**
+ * @brief Read the temperature and current of every connected motor of a motor group, without allocating
+ *
+ * @param group the motor group
+ * @return MotorGroupSample the sample
+ */
+MotorGroupSample sampleMotorGroup(const MotorGroup& group) {
+    auto temperatures = filledArray<Temperature, DevicePoller::MAX_GROUP_MOTORS>(units::from_celsius(INFINITY));
+    auto currents = filledArray<Current, DevicePoller::MAX_GROUP_MOTORS>(from_amp(INFINITY));
+    MotorGroupSample sample;
+    sample.timestamp = from_usec(pros::c::micros());
+    const int32_t count = std::min(group.getTemperatures(temperatures), group.getCurrents(currents));
+    for (int32_t i = 0; i < count; i++) {
+        // motors which were unplugged between the two reads are skipped
+        if (temperatures[i].internal() == INFINITY || currents[i].internal() == INFINITY) continue;
+        if (sample.motors == 0 || temperatures[i] > sample.maxTemperature) sample.maxTemperature = temperatures[i];
+        sample.current += currents[i];
+        sample.motors++;
+    }
+    sample.connected = sample.motors != 0;
+    return sample;
+}
+} // namespace
+
+DevicePoller::DevicePoller(Time period)
+    : m_period(period) {}
+
+DevicePoller::~DevicePoller() { stop(); }
+
+int32_t DevicePoller::addEncoder(Encoder& encoder) {
+    std::lock_guard lock(m_mutex);
+    return addEncoderEntry(encoder, nullptr);
+}
+
+int32_t DevicePoller::addEncoder(Encoder& encoder, EncoderHistoryBase& history) {
+    std::lock_guard lock(m_mutex);
+    return addEncoderEntry(encoder, &history);
+}
+
+int32_t DevicePoller::addEncoderEntry(Encoder& encoder, EncoderHistoryBase* history) {
+    const size_t index = m_encoderCount.load(std::memory_order_relaxed);
+    if (index == MAX_ENCODERS) {
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    m_encoders[index].encoder = &encoder;
+    m_encoders[index].history = history;
+    // publish the entry only after it has been filled in
+    m_encoderCount.store(index + 1, std::memory_order_release);
+    return index;
+}
+
+int32_t DevicePoller::addIMU(IMU& imu) { return addIMUEntry(imu, nullptr); }
+
+int32_t DevicePoller::addOrientationIMU(V5InertialSensor& imu) { return addIMUEntry(imu, &imu); }
+
+int32_t DevicePoller::addIMUEntry(IMU& imu, V5InertialSensor* orientationImu) {
+    std::lock_guard lock(m_mutex);
+    const size_t index = m_imuCount.load(std::memory_order_relaxed);
+    if (index == MAX_IMUS) {
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    m_imus[index].imu = &imu;
+    m_imus[index].orientationImu = orientationImu;
+    // publish the entry only after it has been filled in
+    m_imuCount.store(index + 1, std::memory_order_release);
+    return index;
+}
+
+int32_t DevicePoller::levelOrientation(int32_t index) {
+    if (index < 0 || size_t(index) >= m_imuCount.load(std::memory_order_acquire) ||
+        m_imus[index].orientationImu == nullptr) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    m_imus[index].level = true;
+    return 0;
+}
+
+int32_t DevicePoller::addMotorGroup(MotorGroup& group) {
+    std::lock_guard lock(m_mutex);
+    const size_t index = m_motorGroupCount.load(std::memory_order_relaxed);
+    if (index == MAX_MOTOR_GROUPS) {
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    m_motorGroups[index].group = &group;
+    // publish the entry only after it has been filled in
+    m_motorGroupCount.store(index + 1, std::memory_order_release);
+    return index;
+}
+
+int32_t DevicePoller::addMotor(Motor& motor) {
+    std::lock_guard lock(m_mutex);
+    const size_t index = m_motorCount.load(std::memory_order_relaxed);
+    if (index == MAX_MOTORS) {
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    m_motors[index] = &motor;
+    // publish the entry only after it has been filled in
+    m_motorCount.store(index + 1, std::memory_order_release);
+    return index;
+}
+
+int32_t DevicePoller::addGPS(V5GPS& gps) {
+    std::lock_guard lock(m_mutex);
+    const size_t index = m_gpsCount.load(std::memory_order_relaxed);
+    if (index == MAX_GPS) {
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    m_gps[index].gps = &gps;
+    // publish the entry only after it has been filled in
+    m_gpsCount.store(index + 1, std::memory_order_release);
+    return index;
+}
+
+int32_t DevicePoller::addOpticalSensor(V5OpticalSensor& sensor) {
+    std::lock_guard lock(m_mutex);
+    const size_t index = m_opticalCount.load(std::memory_order_relaxed);
+    if (index == MAX_OPTICAL) {
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    m_optical[index].sensor = &sensor;
+    // publish the entry only after it has been filled in
+    m_opticalCount.store(index + 1, std::memory_order_release);
+    return index;
+}
+
+int32_t DevicePoller::addDistanceSensor(V5DistanceSensor& sensor) {
+    std::lock_guard lock(m_mutex);
+    const size_t index = m_distanceCount.load(std::memory_order_relaxed);
+    if (index == MAX_DISTANCE_SENSORS) {
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    m_distanceSensors[index].sensor = &sensor;
+    // publish the entry only after it has been filled in
+    m_distanceCount.store(index + 1, std::memory_order_release);
+    return index;
+}
+
+EncoderSample DevicePoller::getEncoderSample(int32_t index) const {
+    if (index < 0 || size_t(index) >= m_encoderCount.load(std::memory_order_acquire)) {
+        errno = EINVAL;
+        return {};
+    }
+    return m_encoders[index].sample.read();
+}
+
+IMUSample DevicePoller::getIMUSample(int32_t index) const {
+    if (index < 0 || size_t(index) >= m_imuCount.load(std::memory_order_acquire)) {
+        errno = EINVAL;
+        return {};
+    }
+    return m_imus[index].sample.read();
+}
+
+MotorGroupSample DevicePoller::getMotorGroupSample(int32_t index) const {
+    if (index < 0 || size_t(index) >= m_motorGroupCount.load(std::memory_order_acquire)) {
+        errno = EINVAL;
+        return {};
+    }
+    return m_motorGroups[index].sample.read();
+}
+
+GPSReading DevicePoller::getGPSSample(int32_t index) const {
+    if (index < 0 || size_t(index) >= m_gpsCount.load(std::memory_order_acquire)) {
+        errno = EINVAL;
+        return {};
+    }
+    return m_gps[index].sample.read();
+}
+
+OpticalReading DevicePoller::getOpticalSample(int32_t index) const {
+    if (index < 0 || size_t(index) >= m_opticalCount.load(std::memory_order_acquire)) {
+        errno = EINVAL;
+        return {};
+    }
+    return m_optical[index].sample.read();
+}
+
+DistanceSample DevicePoller::getDistanceSample(int32_t index) const {
+    if (index < 0 || size_t(index) >= m_distanceCount.load(std::memory_order_acquire)) {
+        errno = EINVAL;
+        return {};
+    }
+    return m_distanceSensors[index].sample.read();
+}
+
+void DevicePoller::update() {
+    LEMLIB_TRACE_SCOPE("DevicePoller::update");
+    // the counts are only read once, so devices registered during the update are sampled in the next one
+    const size_t encoderCount = m_encoderCount.load(std::memory_order_acquire);
+    const size_t imuCount = m_imuCount.load(std::memory_order_acquire);
+    const size_t motorGroupCount = m_motorGroupCount.load(std::memory_order_acquire);
+    const size_t motorCount = m_motorCount.load(std::memory_order_acquire);
+    const size_t gpsCount = m_gpsCount.load(std::memory_order_acquire);
+    const size_t opticalCount = m_opticalCount.load(std::memory_order_acquire);
+    const size_t distanceCount = m_distanceCount.load(std::memory_order_acquire);
+    // keeps the snapshot of plugged devices fresh, so tasks waiting for a device to be plugged in are woken
+    DeviceRegistry::get().refresh();
+    for (size_t i = 0; i < encoderCount; i++) {
+        EncoderSample sample;
+        sample.timestamp = from_usec(pros::c::micros());
+        const Result<Angle> angle = m_encoders[i].encoder->tryGetAngle();
+        sample.angle = angle.valueOr(from_stDeg(INFINITY));
+        sample.connected = angle.ok();
+        m_encoders[i].sample.write(sample);
+        if (sample.connected && m_encoders[i].history != nullptr) m_encoders[i].history->push(sample);
+    }
+    for (size_t i = 0; i < imuCount; i++) {
+        IMUSample sample;
+        sample.timestamp = from_usec(pros::c::micros());
+        const Result<Angle> rotation = m_imus[i].imu->tryGetRotation();
+        sample.rotation = rotation.valueOr(from_stDeg(INFINITY));
+        sample.connected = rotation.ok();
+        if (m_imus[i].orientationImu != nullptr) integrateOrientation(m_imus[i], sample);
+        m_imus[i].sample.write(sample);
+    }
+    for (size_t i = 0; i < motorGroupCount; i++) {
+        m_motorGroups[i].sample.write(sampleMotorGroup(*m_motorGroups[i].group));
+        m_motorGroups[i].group->updateMotion();
+    }
+    for (size_t i = 0; i < motorCount; i++) m_motors[i]->updateMotion();
+    for (size_t i = 0; i < gpsCount; i++) m_gps[i].sample.write(m_gps[i].gps->getReading());
+    for (size_t i = 0; i < opticalCount; i++) m_optical[i].sample.write(m_optical[i].sensor->getReading());
+    for (size_t i = 0; i < distanceCount; i++) {
+        DistanceEntry& entry = m_distanceSensors[i];
+        DistanceSample sample = entry.sensor->getSample();
+        // distances out of range aren't finite, so the median skips them
+        if (sample.connected) entry.median.add(sample.distance);
+        else entry.median.reset();
+        if (entry.median.count() != 0) sample.median = entry.median.value();
+        entry.sample.write(sample);
+    }
+}
+
+void DevicePoller::integrateOrientation(IMUEntry& entry, IMUSample& sample) {
+    const IMUReadout readout = entry.orientationImu->getReadout();
+    const units::Vector3D<AngularVelocity>& rates = readout.gyroRates;
+    const bool valid = rates.x != from_radps(INFINITY) && readout.acceleration.x != from_mps2(INFINITY);
+    if (!valid || sample.rotation == from_stDeg(INFINITY)) {
+        // the sensor is disconnected or calibrating, so its orientation is leveled again once it can be read
+        entry.level = true;
+        entry.lastReadout = from_sec(INFINITY);
+        return;
+    }
+    if (entry.level.exchange(false)) {
+        // the only trig of the orientation, once when it is leveled
+        entry.orientation = units::Quaternion::fromAxisAngle(units::Vector3D<Number>(0, 0, 1), sample.rotation) *
+                            units::Quaternion::fromGravity(readout.acceleration);
+    } else if (readout.timestamp > entry.lastReadout) {
+        // the sensor reports the z rate clockwise positive, like its rotation, so it is flipped to follow the right
+        // hand rule. The readout is cached, so the same readout isn't integrated twice
+        const units::Vector3D<AngularVelocity> rightHanded(rates.x, rates.y, -rates.z);
+        entry.orientation = entry.orientation.integrate(rightHanded, readout.timestamp - entry.lastReadout);
+    }
+    entry.lastReadout = readout.timestamp;
+    sample.orientation = entry.orientation;
+    sample.hasOrientation = true;
+}
+
+int32_t DevicePoller::setPeriod(Time period) {
+    // written so NaN fails the comparison
+    if (!(period >= 1_msec) || period == from_sec(INFINITY)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    m_period.store(period);
+    return 0;
+}
+
+Time DevicePoller::getPeriod() const { return m_period.load(); }
+
+int32_t DevicePoller::syncToIMU(int32_t index) {
+    if (index < -1 || (index != -1 && size_t(index) >= m_imuCount.load(std::memory_order_acquire))) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    m_syncIMU.store(index);
+    return 0;
+}
+
+void DevicePoller::waitForIMUUpdate(uint32_t period) {
+    const int32_t index = m_syncIMU.load();
+    if (index < 0) return;
+    const IMU& imu = *m_imus[index].imu;
+    const Angle first = imu.getRotation();
+    // a disconnected IMU never changes, so there is nothing to align with
+    if (first == from_stDeg(INFINITY)) return;
+    for (uint32_t waited = 0; waited < 2 * period; waited++) {
+        pros::c::delay(1);
+        if (imu.getRotation() != first) return;
+    }
+}
+
+int32_t DevicePoller::start(uint32_t priority) {
+    std::lock_guard lock(m_mutex);
+    if (m_running.load() || !m_taskExited.load()) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    m_running = true;
+    m_taskExited = false;
+    LEMLIB_BOOT_EVENT("create lemlib device poller task", 0);
+    const pros::task_t task =
+        TaskManager::get().create(TaskRole::DEVICE_POLLER, taskFunction, this, priority, "lemlib device poller");
+    if (task == nullptr) {
+        m_running = false;
+        m_taskExited = true;
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+void DevicePoller::stop() {
+    m_running = false;
+    // wait for the task to finish its current update, so the poller can be safely destroyed afterwards
+    while (!m_taskExited.load()) pros::c::delay(1);
+}
+
+void DevicePoller::taskFunction(void* poller) {
+    DevicePoller& self = *static_cast<DevicePoller*>(poller);
+    // how often the task is aligned with the IMU again, in milliseconds
+    constexpr uint32_t SYNC_INTERVAL = 1000;
+    uint32_t now = pros::c::millis();
+    uint32_t lastSync = now - SYNC_INTERVAL;
+    const int32_t slot = TaskManager::get().attach(TaskRole::DEVICE_POLLER, "lemlib device poller");
+    while (self.m_running.load()) {
+        const uint32_t period = std::max(1.0, std::round(to_msec(self.m_period.load())));
+        if (self.m_syncIMU.load() >= 0 && now - lastSync >= SYNC_INTERVAL) {
+            self.waitForIMUUpdate(period);
+            // the schedule continues from the moment the IMU updated
+            now = pros::c::millis();
+            lastSync = now;
+        }
+        {
+            TaskMonitor::Work work(slot);
+            self.update();
+        }
+        pros::c::task_delay_until(&now, period);
+    }
+    TaskMonitor::get().detach(slot);
+    // PROS deletes the task once this function returns
+    self.m_taskExited = true;
+}
+} // namespace lemlib
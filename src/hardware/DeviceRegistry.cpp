@@ -0,0 +1,344 @@
+#include "hardware/DeviceRegistry.hpp"
+#include "hardware/SdkCallTracker.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <utility>
+
+namespace lemlib {
+namespace {
+constexpr uint32_t COUNT_MASK = 0xFFFF;
+constexpr uint32_t SHARED_BIT = 1 << 16;
+constexpr int TYPE_SHIFT = 24;
+
+/**
+ * @brief Convert an ADI port to a number from 1 to 8, like PROS does
+ *
+ * @param port the port, either a number or a letter
+ * @return uint8_t the port number, or 0 if it is out of range
+ */
+uint8_t adiPortNumber(uint8_t port) {
+    if (port >= 'a' && port <= 'h') return port - 'a' + 1;
+    if (port >= 'A' && port <= 'H') return port - 'A' + 1;
+    if (port < 1 || port > DeviceRegistry::ADI_PORTS) return 0;
+    return port;
+}
+
+/**
+ * @brief Find the slot index of an ADI port
+ *
+ * @param expanderPort the smart port of the ADI expander, or BRAIN_ADI_PORT
+ * @param adiPort the ADI port, either a number from 1 to 8 or a letter
+ * @return int the index, or -1 if either port is out of range
+ */
+int adiSlot(uint8_t expanderPort, uint8_t adiPort) {
+    const uint8_t number = adiPortNumber(adiPort);
+    if (number == 0) return -1;
+    if (expanderPort == DeviceRegistry::BRAIN_ADI_PORT) return number - 1;
+    if (expanderPort < 1 || expanderPort > DeviceRegistry::SMART_PORTS) return -1;
+    return expanderPort * DeviceRegistry::ADI_PORTS + number - 1;
+}
+
+/**
+ * @brief Find the bit of a port in a port mask
+ *
+ * @param port the smart port, or BRAIN_ADI_PORT
+ * @return uint32_t the bit
+ */
+uint32_t portBit(uint8_t port) { return uint32_t(1) << (port - 1); }
+} // namespace
+
+DeviceRegistry& DeviceRegistry::get() {
+    static DeviceRegistry registry;
+    return registry;
+}
+
+bool DeviceRegistry::claimSlot(std::atomic<uint32_t>& slot, uint8_t type, bool shared) {
+    uint32_t current = slot.load();
+    bool conflict;
+    uint32_t next;
+    do {
+        const uint32_t count = current & COUNT_MASK;
+        if (count == 0) {
+            conflict = false;
+            next = (uint32_t(type) << TYPE_SHIFT) | (shared ? SHARED_BIT : 0) | 1;
+        } else {
+            // a port can only be shared if every claim of it can be shared, and they are all the same type of device.
+            // Copies of a device are retained instead, so they never get here
+            conflict = !shared || !(current & SHARED_BIT) || (current >> TYPE_SHIFT) != type;
+            // the first claim keeps the port, so the slot stays consistent with it
+            next = current + 1;
+        }
+    } while (!slot.compare_exchange_weak(current, next));
+    return conflict;
+}
+
+void DeviceRegistry::releaseSlot(std::atomic<uint32_t>& slot) {
+    uint32_t current = slot.load();
+    uint32_t next;
+    do {
+        const uint32_t count = current & COUNT_MASK;
+        if (count == 0) return;
+        // the last claim frees the port for any type of device
+        next = count == 1 ? 0 : current - 1;
+    } while (!slot.compare_exchange_weak(current, next));
+}
+
+int32_t DeviceRegistry::claim(uint8_t port, pros::c::v5_device_e_t type, bool shared) {
+    if (port < 1 || port > SMART_PORTS) return 0;
+    if (!claimSlot(m_smartClaims[port - 1], type, shared)) return 0;
+    m_conflicts.fetch_or(portBit(port));
+    errno = EADDRINUSE;
+    return INT_MAX;
+}
+
+void DeviceRegistry::retain(uint8_t port) {
+    if (port < 1 || port > SMART_PORTS) return;
+    m_smartClaims[port - 1].fetch_add(1);
+}
+
+void DeviceRegistry::release(uint8_t port) {
+    if (port < 1 || port > SMART_PORTS) return;
+    releaseSlot(m_smartClaims[port - 1]);
+}
+
+int32_t DeviceRegistry::claimADI(uint8_t expanderPort, uint8_t adiPort) {
+    const int slot = adiSlot(expanderPort, adiPort);
+    if (slot < 0) return 0;
+    bool conflict = claimSlot(m_adiClaims[slot], pros::c::E_DEVICE_ADI, false);
+    if (conflict) m_conflicts.fetch_or(portBit(expanderPort));
+    // every ADI device on an expander shares its smart port
+    if (expanderPort != BRAIN_ADI_PORT && claim(expanderPort, pros::c::E_DEVICE_ADI, true) != 0) conflict = true;
+    if (!conflict) return 0;
+    errno = EADDRINUSE;
+    return INT_MAX;
+}
+
+void DeviceRegistry::retainADI(uint8_t expanderPort, uint8_t adiPort) {
+    const int slot = adiSlot(expanderPort, adiPort);
+    if (slot < 0) return;
+    m_adiClaims[slot].fetch_add(1);
+    if (expanderPort != BRAIN_ADI_PORT) retain(expanderPort);
+}
+
+void DeviceRegistry::releaseADI(uint8_t expanderPort, uint8_t adiPort) {
+    const int slot = adiSlot(expanderPort, adiPort);
+    if (slot < 0) return;
+    releaseSlot(m_adiClaims[slot]);
+    if (expanderPort != BRAIN_ADI_PORT) release(expanderPort);
+}
+
+uint32_t DeviceRegistry::getConflicts() const { return m_conflicts.load(); }
+
+void DeviceRegistry::refresh() {
+    const uint32_t now = pros::c::millis();
+    if (!m_scanned.load(std::memory_order_acquire) ||
+        now - m_scanTime.load(std::memory_order_relaxed) >= m_scanPeriod.load(std::memory_order_relaxed)) {
+        scan();
+    }
+}
+
+pros::c::v5_device_e_t DeviceRegistry::getPluggedType(uint8_t port) {
+    if (port < 1 || port > SMART_PORTS) return pros::c::E_DEVICE_UNDEFINED;
+    refresh();
+    // the first snapshot can still be in progress in another task, in which case the port is read directly
+    if (!m_scanned.load(std::memory_order_acquire)) return LEMLIB_SDK_CALL(port, pros::c::get_plugged_type(port));
+    return m_pluggedTypes[port - 1].load(std::memory_order_relaxed);
+}
+
+uint32_t DeviceRegistry::getPluggedPorts(pros::c::v5_device_e_t type) {
+    refresh();
+    if (m_scanned.load(std::memory_order_acquire)) {
+        for (std::size_t i = 0; i < MASKED_TYPES.size(); i++) {
+            if (MASKED_TYPES[i] == type) return m_pluggedMasks[i].load(std::memory_order_relaxed);
+        }
+    }
+    uint32_t mask = type == pros::c::E_DEVICE_ADI ? portBit(BRAIN_ADI_PORT) : 0;
+    for (uint8_t port = 1; port <= SMART_PORTS; port++) {
+        if (getPluggedType(port) == type) mask |= portBit(port);
+    }
+    return mask;
+}
+
+bool DeviceRegistry::isPlugged(uint8_t port, pros::c::v5_device_e_t type) {
+    if (port < 1 || port > BRAIN_ADI_PORT) return false;
+    return hasPort(getPluggedPorts(type), port);
+}
+
+void DeviceRegistry::scan() {
+    // only one task takes the snapshot. The others use the previous one, which is at most one period older
+    if (m_scanning.exchange(true, std::memory_order_acquire)) return;
+    const bool first = !m_scanned.load(std::memory_order_relaxed);
+    std::array<uint32_t, MASKED_TYPES.size()> masks {};
+    std::array<pros::c::v5_device_e_t, SMART_PORTS> previous;
+    uint32_t changed = 0;
+    for (uint8_t port = 1; port <= SMART_PORTS; port++) {
+        const pros::c::v5_device_e_t type = LEMLIB_SDK_CALL(port, pros::c::get_plugged_type(port));
+        previous[port - 1] = m_pluggedTypes[port - 1].exchange(type, std::memory_order_relaxed);
+        if (previous[port - 1] != type) {
+            // a device which was unplugged or replaced is detected again from scratch
+            m_portStates[port].invalidate();
+            if (!first) changed |= portBit(port);
+        }
+        for (std::size_t i = 0; i < MASKED_TYPES.size(); i++) {
+            if (MASKED_TYPES[i] == type) masks[i] |= portBit(port);
+        }
+    }
+    for (std::size_t i = 0; i < MASKED_TYPES.size(); i++) {
+        // the ADI ports on the brain can't be unplugged
+        if (MASKED_TYPES[i] == pros::c::E_DEVICE_ADI) masks[i] |= portBit(BRAIN_ADI_PORT);
+        m_pluggedMasks[i].store(masks[i], std::memory_order_relaxed);
+    }
+    m_scanTime.store(pros::c::millis(), std::memory_order_relaxed);
+    // the sequence is incremented after the snapshot is stored, so a task which sees the new sequence sees the new
+    // snapshot too
+    if (changed != 0) m_plugSequence.fetch_add(1, std::memory_order_release);
+    m_scanned.store(true, std::memory_order_release);
+    // subscribers are called before the next snapshot can be taken, so they are told of every change in order
+    if (changed != 0) {
+        notify(changed, previous);
+        m_plugSignal.notify();
+    }
+    m_scanning.store(false, std::memory_order_release);
+}
+
+void DeviceRegistry::notify(uint32_t changed, const std::array<pros::c::v5_device_e_t, SMART_PORTS>& previous) {
+    const std::size_t slots = std::min(m_subscriberSlots.load(std::memory_order_acquire), MAX_SUBSCRIBERS);
+    for (std::size_t i = 0; i < slots; i++) {
+        Subscriber& subscriber = m_subscribers[i];
+        if (!subscriber.enabled.load(std::memory_order_acquire)) continue;
+        const uint32_t ports = changed & subscriber.ports;
+        for (uint8_t port = 1; port <= SMART_PORTS; port++) {
+            if (!hasPort(ports, port)) continue;
+            subscriber.callback(port, previous[port - 1], m_pluggedTypes[port - 1].load(std::memory_order_relaxed));
+        }
+    }
+}
+
+uint32_t DeviceRegistry::getPlugSequence() {
+    refresh();
+    return m_plugSequence.load(std::memory_order_acquire);
+}
+
+int32_t DeviceRegistry::waitForPlugged(uint8_t port, pros::c::v5_device_e_t type, Time timeout) {
+    if (port < 1 || port > SMART_PORTS) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    // the device may already be plugged in, and the snapshot is only refreshed by other tasks while this one sleeps
+    refresh();
+    const auto plugged = [&] { return m_pluggedTypes[port - 1].load(std::memory_order_relaxed) == type; };
+    if (!m_plugSignal.waitUntil(plugged, timeout)) {
+        errno = ETIMEDOUT;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+int32_t DeviceRegistry::subscribe(PlugCallback callback, uint32_t ports) {
+    if (!callback) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    // the count can go past the number of slots, which notify ignores
+    const std::size_t index = m_subscriberSlots.fetch_add(1);
+    if (index >= MAX_SUBSCRIBERS) {
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    Subscriber& subscriber = m_subscribers[index];
+    subscriber.callback = std::move(callback);
+    subscriber.ports = ports;
+    subscriber.enabled.store(true, std::memory_order_release);
+    return index;
+}
+
+int32_t DeviceRegistry::unsubscribe(int32_t index) {
+    if (index < 0 || std::size_t(index) >= MAX_SUBSCRIBERS ||
+        !m_subscribers[index].enabled.exchange(false, std::memory_order_relaxed)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+int32_t DeviceRegistry::initializeAll(std::initializer_list<Device*> devices, Time timeout) {
+    // every device is started before any of them is waited for
+    int error = 0;
+    for (Device* device : devices) {
+        if (device->startInitialization() == INT_MAX && error == 0) error = errno;
+    }
+    const auto initializing = [&] {
+        return std::any_of(devices.begin(), devices.end(), [](const Device* device) {
+            return device->isInitializing() == 1;
+        });
+    };
+    const uint32_t start = pros::c::millis();
+    const uint32_t limit = std::max(0.0, std::round(to_msec(timeout)));
+    while (initializing()) {
+        if (pros::c::millis() - start >= limit) {
+            errno = ETIMEDOUT;
+            return INT_MAX;
+        }
+        pros::c::delay(10);
+    }
+    if (error != 0) {
+        errno = error;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+int32_t DeviceRegistry::setScanPeriod(Time period) {
+    m_scanPeriod = std::max(0.0, std::round(to_msec(period)));
+    return 0;
+}
+
+Time DeviceRegistry::getScanPeriod() const { return from_msec(m_scanPeriod.load()); }
+
+PortClaim::PortClaim(uint8_t port, pros::c::v5_device_e_t type)
+    : m_port(port),
+      m_adiPort(0),
+      m_type(type) {
+    DeviceRegistry::get().claim(m_port, m_type);
+}
+
+PortClaim::PortClaim(uint8_t expanderPort, uint8_t adiPort)
+    : m_port(expanderPort),
+      m_adiPort(adiPort),
+      m_type(pros::c::E_DEVICE_ADI) {
+    DeviceRegistry::get().claimADI(m_port, m_adiPort);
+}
+
+PortClaim::PortClaim(const PortClaim& other)
+    : m_port(other.m_port),
+      m_adiPort(other.m_adiPort),
+      m_type(other.m_type) {
+    retain();
+}
+
+PortClaim& PortClaim::operator=(const PortClaim& other) {
+    if (this == &other) return *this;
+    // the new port is shared before the old one is released, so assigning a claim to a copy never frees the port
+    other.retain();
+    release();
+    m_port = other.m_port;
+    m_adiPort = other.m_adiPort;
+    m_type = other.m_type;
+    return *this;
+}
+
+PortClaim::~PortClaim() { release(); }
+
+void PortClaim::retain() const {
+    if (m_adiPort == 0) DeviceRegistry::get().retain(m_port);
+    else DeviceRegistry::get().retainADI(m_port, m_adiPort);
+}
+
+void PortClaim::release() const {
+    if (m_adiPort == 0) DeviceRegistry::get().release(m_port);
+    else DeviceRegistry::get().releaseADI(m_port, m_adiPort);
+}
+} // namespace lemlib
@@ -0,0 +1,58 @@
+#include "hardware/Distance/V5DistanceSensor.hpp"
+#include "hardware/SdkCallTracker.hpp"
+#include "pros/distance.h"
+#include "pros/rtos.h"
+#include <cmath>
+#include <errno.h>
+#include <limits.h>
+
+namespace lemlib {
+V5DistanceSensor::V5DistanceSensor(SmartPort port)
+    : m_port(port),
+      m_claim(m_port, pros::c::E_DEVICE_DISTANCE),
+      m_readCache(DeviceRegistry::get().getPortState(m_port).reading) {}
+
+#ifndef LEMLIB_SIM
+V5DistanceSensor V5DistanceSensor::from_pros_dist(pros::Distance sensor) {
+    return V5DistanceSensor({sensor.get_port(), runtime_check_port});
+}
+#endif
+
+int32_t V5DistanceSensor::isConnected() const {
+    return DeviceRegistry::get().isPlugged(m_port, pros::c::E_DEVICE_DISTANCE);
+}
+
+Result<Length> V5DistanceSensor::tryGetDistance() const {
+    const int32_t raw = m_readCache.get([&] { return LEMLIB_SDK_CALL(m_port, pros::c::distance_get(m_port)); });
+    if (raw == INT_MAX) [[unlikely]]
+        return Result<Length>::failure(errno);
+    if (raw == NO_OBJECT) return Result<Length>::failure(ERANGE);
+    return from_mm(raw);
+}
+
+Number V5DistanceSensor::getConfidence() const {
+    const int32_t raw = LEMLIB_SDK_CALL(m_port, pros::c::distance_get_confidence(m_port));
+    if (raw == INT_MAX) return Number(INFINITY);
+    return Number(double(raw) / MAX_CONFIDENCE);
+}
+
+DistanceSample V5DistanceSensor::getSample() const {
+    const RawReading raw =
+        m_readCache.getReading([&] { return LEMLIB_SDK_CALL(m_port, pros::c::distance_get(m_port)); });
+    DistanceSample sample;
+    sample.timestamp = from_usec(raw.timestamp);
+    if (raw.value == INT_MAX) return sample;
+    sample.connected = true;
+    if (raw.value != NO_OBJECT) sample.distance = from_mm(raw.value);
+    return sample;
+}
+
+int32_t V5DistanceSensor::setReadCacheWindow(Time window) {
+    m_readCache.setWindow(window);
+    return 0;
+}
+
+Time V5DistanceSensor::getReadCacheWindow() const { return m_readCache.getWindow(); }
+
+uint8_t V5DistanceSensor::getPort() const { return m_port; }
+} // namespace lemlib
@@ -1,27 +1,37 @@
 #include "hardware/Encoder/ADIEncoder.hpp"
 #include "hardware/Port.hpp"
+#include "hardware/SdkCallTracker.hpp"
+#include "pros/rtos.h"
 #include <cmath>
 #include <limits.h>
 #include <mutex>
+#include <tuple>
 
 namespace lemlib {
 ADIEncoder::ADIEncoder(pros::adi::Encoder encoder)
-    : m_encoder(encoder) {}
+    : m_encoder(encoder),
+      // the ports are read back from the encoder, so every constructor claims them the same way
+      m_topClaim(std::get<0>(m_encoder.get_port()), std::get<1>(m_encoder.get_port())),
+      m_bottomClaim(std::get<0>(m_encoder.get_port()), std::get<2>(m_encoder.get_port())) {}
 
 ADIEncoder::ADIEncoder(ADIPair ports, bool reversed)
-    : m_encoder(pros::adi::Encoder(ports.first(), ports.second(), reversed)) {}
+    : ADIEncoder(pros::adi::Encoder(ports.first(), ports.second(), reversed)) {}
 
 ADIEncoder::ADIEncoder(SmartPort expanderPort, ADIPair ports, bool reversed)
-    : m_encoder({expanderPort, ports.first(), ports.second()}, reversed) {}
+    : ADIEncoder(pros::adi::Encoder({expanderPort, ports.first(), ports.second()}, reversed)) {}
 
 ADIEncoder::ADIEncoder(const ADIEncoder& other)
     : m_encoder(other.m_encoder),
-      m_offset(other.m_offset) {}
+      m_offset(other.m_offset.load(std::memory_order_acquire)),
+      m_ticks(other.m_ticks),
+      m_velocityEstimator(1_stDeg, other.getVelocityEstimation()),
+      m_topClaim(other.m_topClaim),
+      m_bottomClaim(other.m_bottomClaim) {}
 
 int32_t ADIEncoder::isConnected() const {
     // it's not possible to check if the ADIEncoder is connected, so we just return 1 to indicate that it is
-    // we do run a simple test however to check if the ports are valid
-    if (m_encoder.get_value() == INT_MAX) {
+    // we do check the expander however, which is a lookup instead of a full read of the encoder
+    if (!DeviceRegistry::get().isPlugged(std::get<0>(m_encoder.get_port()), pros::c::E_DEVICE_ADI)) {
         errno = ENODEV;
         return INT_MAX;
     }
@@ -30,23 +40,56 @@ int32_t ADIEncoder::isConnected() const {
 }
 
 Angle ADIEncoder::getAngle() const {
-    std::unique_lock lock(m_mutex);
-    const int raw = m_encoder.get_value();
+    const int raw = LEMLIB_SDK_CALL(std::get<0>(m_encoder.get_port()), m_encoder.get_value());
     // check for errors
     if (raw == INT_MAX) {
         errno = ENODEV;
         return Angle(INFINITY);
     }
     // return the angle
-    return from_stDeg(raw) + m_offset;
+    return from_stDeg(m_ticks.update(raw)) + m_offset.load(std::memory_order_acquire);
+}
+
+RawReading ADIEncoder::getRaw() const {
+    const RawReading reading {.value = LEMLIB_SDK_CALL(std::get<0>(m_encoder.get_port()), m_encoder.get_value()),
+                              .timestamp = uint32_t(pros::c::micros())};
+    if (reading.value == INT_MAX) errno = ENODEV;
+    return reading;
+}
+
+EncoderPosition ADIEncoder::getPosition() const {
+    // the encoder counts degrees
+    constexpr units::Scale DEGREES(deg);
+    const RawReading reading = getRaw();
+    const Angle offset = m_offset.load(std::memory_order_acquire);
+    if (reading.value == INT_MAX) return EncoderPosition(reading, DEGREES, offset);
+    // the offset is relative to the extended count, so the wraparounds of the raw count are moved into it
+    return EncoderPosition(reading, DEGREES, offset + DEGREES(m_ticks.update(reading.value) - reading.value));
 }
 
 int32_t ADIEncoder::setAngle(Angle angle) {
     std::unique_lock lock(m_mutex);
-    // the Vex SDK does not support setting the relative angle of an ADI encoder to a specific value
-    // but we can overcome this limitation by resetting the relative angle to zero and saving an offset
-    m_offset = angle;
-    const int result = m_encoder.reset();
+    // requestedAngle = count + offset
+    // offset = requestedAngle - count
+    // the count keeps running, so no ticks are lost and the velocity estimate stays valid
+    const int raw = LEMLIB_SDK_CALL(std::get<0>(m_encoder.get_port()), m_encoder.get_value());
+    if (raw == INT_MAX) {
+        errno = ENODEV;
+        return INT_MAX;
+    }
+    m_offset.store(angle - from_stDeg(m_ticks.update(raw)), std::memory_order_release);
+    return 0;
+}
+
+int32_t ADIEncoder::resetCount(Angle angle) {
+    std::unique_lock lock(m_mutex);
+    // the offset is published after the reset, so a reader running in between can see the new raw angle with the
+    // old offset for a single read
+    const int result = LEMLIB_SDK_CALL(std::get<0>(m_encoder.get_port()), m_encoder.reset());
+    m_ticks.reset();
+    m_offset.store(angle, std::memory_order_release);
+    // the raw angle jumped back to zero
+    m_velocityEstimator.reset();
     // check for errors
     if (result == INT_MAX) {
         errno = ENODEV;
@@ -55,4 +98,28 @@ int32_t ADIEncoder::setAngle(Angle angle) {
     // return 0 on success
     return 0;
 }
+
+AngularVelocity ADIEncoder::getVelocity() const {
+    std::lock_guard lock(m_mutex);
+    const int raw = LEMLIB_SDK_CALL(std::get<0>(m_encoder.get_port()), m_encoder.get_value());
+    // check for errors
+    if (raw == INT_MAX) {
+        m_velocityEstimator.reset();
+        errno = ENODEV;
+        return from_rpm(INFINITY);
+    }
+    m_velocityEstimator.update(from_usec(pros::c::micros()), from_stDeg(m_ticks.update(raw)));
+    return m_velocityEstimator.getVelocity();
+}
+
+int32_t ADIEncoder::setVelocityEstimation(TickVelocitySettings settings) {
+    std::lock_guard lock(m_mutex);
+    m_velocityEstimator.setSettings(settings);
+    return 0;
+}
+
+TickVelocitySettings ADIEncoder::getVelocityEstimation() const {
+    std::lock_guard lock(m_mutex);
+    return m_velocityEstimator.getSettings();
+}
 } // namespace lemlib
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "hardware/Encoder/ADIExpanderGroup.hpp"
+#include "hardware/SdkCallTracker.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+ADIExpanderGroup::ADIExpanderGroup(SmartPort expanderPort)
+    : m_expanderPort(expanderPort) {}
+
+int32_t ADIExpanderGroup::addEncoder(ADIPair ports, bool reversed) {
+    std::lock_guard lock(m_mutex);
+    const size_t count = m_count.load(std::memory_order_relaxed);
+    // pairs are always A&B, C&D, E&F or G&H, so the lower port identifies the pair
+    const uint8_t lowerPort = std::min(uint8_t(ports.first()), uint8_t(ports.second()));
+    for (size_t i = 0; i < count; i++) {
+        if (m_channels[i].topPort == lowerPort) {
+            errno = EADDRINUSE;
+            return INT_MAX;
+        }
+    }
+    if (count == MAX_ENCODERS) {
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    Channel& channel = m_channels[count];
+    channel.encoder.emplace(pros::adi::ext_adi_port_tuple_t {m_expanderPort, ports.first(), ports.second()},
+                            reversed);
+    channel.topClaim.emplace(m_expanderPort, ports.first());
+    channel.bottomClaim.emplace(m_expanderPort, ports.second());
+    channel.topPort = lowerPort;
+    channel.velocityEstimator.setSettings(m_velocitySettings.read());
+    m_count.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+ADIExpanderGroup::Sweep ADIExpanderGroup::refresh() {
+    const uint32_t now = pros::c::millis();
+    if (!m_updated.load(std::memory_order_acquire) ||
+        now - m_updateTime.load(std::memory_order_relaxed) >= m_updatePeriod.load(std::memory_order_relaxed)) {
+        update();
+    }
+    // the first sweep can still be in progress in another task, in which case it is waited for, as the encoders
+    // can't be read outside of a sweep without desynchronizing their velocity estimates
+    while (!m_updated.load(std::memory_order_acquire)) pros::c::delay(1);
+    return m_sweep.read();
+}
+
+Angle ADIExpanderGroup::getAngle(int32_t index) {
+    if (index < 0 || size_t(index) >= m_count.load(std::memory_order_acquire)) {
+        errno = EINVAL;
+        return from_stDeg(INFINITY);
+    }
+    const Reading reading = refresh().readings[index];
+    // check for errors
+    if (reading.ticks == INT32_MAX) {
+        errno = ENODEV;
+        return from_stDeg(INFINITY);
+    }
+    return from_stDeg(reading.ticks);
+}
+
+AngularVelocity ADIExpanderGroup::getVelocity(int32_t index) {
+    if (index < 0 || size_t(index) >= m_count.load(std::memory_order_acquire)) {
+        errno = EINVAL;
+        return from_rpm(INFINITY);
+    }
+    const Reading reading = refresh().readings[index];
+    // check for errors
+    if (reading.ticks == INT32_MAX) {
+        errno = ENODEV;
+        return from_rpm(INFINITY);
+    }
+    return reading.velocity;
+}
+
+int32_t ADIExpanderGroup::isConnected() const {
+    if (!DeviceRegistry::get().isPlugged(m_expanderPort, pros::c::E_DEVICE_ADI)) {
+        errno = ENODEV;
+        return INT_MAX;
+    }
+    return 1;
+}
+
+void ADIExpanderGroup::update() {
+    // only one task sweeps the group. The others use the previous sweep, which is at most one period older
+    if (m_updating.exchange(true, std::memory_order_acquire)) return;
+    const size_t count = m_count.load(std::memory_order_acquire);
+    const TickVelocitySettings settings = m_velocitySettings.read();
+    Sweep sweep;
+    // read every encoder back to back first, so they are as close together in time as possible
+    for (size_t i = 0; i < count; i++) {
+        sweep.readings[i].ticks = LEMLIB_SDK_CALL(m_expanderPort, m_channels[i].encoder->get_value());
+    }
+    const Time timestamp = from_usec(pros::c::micros());
+    for (size_t i = 0; i < count; i++) {
+        Reading& reading = sweep.readings[i];
+        TickVelocityEstimator& estimator = m_channels[i].velocityEstimator;
+        estimator.setSettings(settings);
+        if (reading.ticks == INT32_MAX) {
+            // the count may have jumped while the encoder couldn't be read
+            estimator.reset();
+            continue;
+        }
+        estimator.update(timestamp, from_stDeg(reading.ticks));
+        reading.velocity = estimator.getVelocity();
+    }
+    m_sweep.write(sweep);
+    m_updateTime.store(pros::c::millis(), std::memory_order_relaxed);
+    m_updated.store(true, std::memory_order_release);
+    m_updating.store(false, std::memory_order_release);
+}
+
+int32_t ADIExpanderGroup::setUpdatePeriod(Time period) {
+    m_updatePeriod = std::max(0.0, std::round(to_msec(period)));
+    return 0;
+}
+
+Time ADIExpanderGroup::getUpdatePeriod() const { return from_msec(m_updatePeriod.load()); }
+
+int32_t ADIExpanderGroup::setVelocityEstimation(TickVelocitySettings settings) {
+    std::lock_guard lock(m_mutex);
+    m_velocitySettings.write(settings);
+    return 0;
+}
+
+TickVelocitySettings ADIExpanderGroup::getVelocityEstimation() const { return m_velocitySettings.read(); }
+
+ADIExpanderEncoder::ADIExpanderEncoder(ADIExpanderGroup& group, ADIPair ports, bool reversed)
+    : m_group(group),
+      m_index(group.addEncoder(ports, reversed)) {
+    if (m_index == INT_MAX) m_error = errno;
+}
+
+ADIExpanderEncoder::ADIExpanderEncoder(const ADIExpanderEncoder& other)
+    : m_group(other.m_group),
+      m_index(other.m_index),
+      m_error(other.m_error),
+      m_offset(other.m_offset.load(std::memory_order_acquire)) {}
+
+int32_t ADIExpanderEncoder::isConnected() const {
+    if (m_index == INT_MAX) {
+        errno = m_error;
+        return INT_MAX;
+    }
+    return m_group.isConnected();
+}
+
+Angle ADIExpanderEncoder::getAngle() const {
+    if (m_index == INT_MAX) {
+        errno = m_error;
+        return from_stDeg(INFINITY);
+    }
+    const Angle raw = m_group.getAngle(m_index);
+    // check for errors
+    if (raw.internal() == INFINITY) return raw;
+    return raw + m_offset.load(std::memory_order_acquire);
+}
+
+int32_t ADIExpanderEncoder::setAngle(Angle angle) {
+    if (m_index == INT_MAX) {
+        errno = m_error;
+        return INT_MAX;
+    }
+    // the encoder is shared by the whole group, and maybe by copies of this encoder, so it can't be reset. The offset
+    // is taken from the latest sweep instead, which is what getAngle reads too
+    const Angle raw = m_group.getAngle(m_index);
+    // check for errors
+    if (raw.internal() == INFINITY) return INT_MAX;
+    m_offset.store(angle - raw, std::memory_order_release);
+    return 0;
+}
+
+AngularVelocity ADIExpanderEncoder::getVelocity() const {
+    if (m_index == INT_MAX) {
+        errno = m_error;
+        return from_rpm(INFINITY);
+    }
+    return m_group.getVelocity(m_index);
+}
+} // namespace lemlib
@@ -0,0 +1,48 @@
+#include "hardware/Encoder/AlphaBetaFilter.hpp"
+
+namespace lemlib {
+AlphaBetaFilter::AlphaBetaFilter(AlphaBetaGains gains)
+    : m_gains(gains) {}
+
+void AlphaBetaFilter::update(Time timestamp, Angle angle) {
+    if (!m_initialized) {
+        m_initialized = true;
+        m_timestamp = timestamp;
+        m_angle = angle;
+        m_velocity = 0_radps;
+        m_acceleration = 0_radps2;
+        return;
+    }
+    const Time dt = timestamp - m_timestamp;
+    if (dt <= 0_sec) return;
+    m_timestamp = timestamp;
+    // predict the angle and velocity, assuming the acceleration is constant
+    const Angle predicted = m_angle + m_velocity * dt + m_acceleration * dt * dt / 2;
+    m_velocity += m_acceleration * dt;
+    // correct every estimate by a fraction of the error of the prediction
+    const Angle error = angle - predicted;
+    m_angle = predicted + error * m_gains.alpha;
+    m_velocity += error * m_gains.beta / dt;
+    m_acceleration += error * (2 * m_gains.gamma) / (dt * dt);
+}
+
+void AlphaBetaFilter::reset() { m_initialized = false; }
+
+void AlphaBetaFilter::rescale(Number factor) {
+    m_angle *= factor.internal();
+    m_velocity *= factor.internal();
+    m_acceleration *= factor.internal();
+}
+
+void AlphaBetaFilter::setGains(AlphaBetaGains gains) { m_gains = gains; }
+
+AlphaBetaGains AlphaBetaFilter::getGains() const { return m_gains; }
+
+bool AlphaBetaFilter::isInitialized() const { return m_initialized; }
+
+Angle AlphaBetaFilter::getAngle() const { return m_initialized ? m_angle : 0_stDeg; }
+
+AngularVelocity AlphaBetaFilter::getVelocity() const { return m_initialized ? m_velocity : 0_radps; }
+
+AngularAcceleration AlphaBetaFilter::getAcceleration() const { return m_initialized ? m_acceleration : 0_radps2; }
+} // namespace lemlib
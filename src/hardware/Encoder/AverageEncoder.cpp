@@ -0,0 +1,13 @@
+#include "hardware/Encoder/AverageEncoder.hpp"
+
+namespace lemlib {
+AverageEncoder::AverageEncoder(std::initializer_list<Encoder*> encoders)
+    : CompositeEncoder(encoders) {}
+
+Angle AverageEncoder::combine(std::span<const Angle> angles) const {
+    if (angles.empty()) return 0_stDeg;
+    Angle sum = 0_stDeg;
+    for (const Angle angle : angles) sum += angle;
+    return sum / angles.size();
+}
+} // namespace lemlib
@@ -0,0 +1,66 @@
+#include "hardware/Encoder/CompositeEncoder.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+CompositeEncoder::CompositeEncoder(std::initializer_list<Encoder*> encoders)
+    : m_encoders(encoders),
+      m_angles(m_encoders.size(), 0_stDeg) {}
+
+CompositeEncoder::CompositeEncoder(const CompositeEncoder& other)
+    : m_encoders(other.m_encoders),
+      m_angles(m_encoders.size(), 0_stDeg),
+      m_updatePeriod(other.m_updatePeriod.load()),
+      m_offset(other.m_offset.load(std::memory_order_acquire)) {}
+
+int32_t CompositeEncoder::isConnected() const {
+    for (const Encoder* encoder : m_encoders) {
+        if (encoder->isConnected() != 1) return 0;
+    }
+    return 1;
+}
+
+Angle CompositeEncoder::readCombined(bool force) const {
+    std::lock_guard lock(m_mutex);
+    const uint32_t now = pros::c::millis();
+    if (force || !m_read || now - m_readTime >= m_updatePeriod.load(std::memory_order_relaxed)) {
+        // read every encoder back to back, before doing any math, so they are as close together in time as possible
+        for (size_t i = 0; i < m_encoders.size(); i++) m_angles[i] = m_encoders[i]->getAngle();
+        m_error = 0;
+        for (const Angle angle : m_angles) {
+            if (angle.internal() == INFINITY) m_error = ENODEV;
+        }
+        m_combined = m_error == 0 ? combine(m_angles) : from_stDeg(INFINITY);
+        m_readTime = now;
+        m_read = true;
+    }
+    // check for errors
+    if (m_error != 0) errno = m_error;
+    return m_combined;
+}
+
+Angle CompositeEncoder::getAngle() const {
+    const Angle combined = readCombined(false);
+    if (combined.internal() == INFINITY) return combined;
+    return combined + m_offset.load(std::memory_order_acquire);
+}
+
+int32_t CompositeEncoder::setAngle(Angle angle) {
+    // the offset has to match the encoders as they are now, not a reading from earlier in the cycle
+    const Angle combined = readCombined(true);
+    if (combined.internal() == INFINITY) return INT_MAX;
+    m_offset.store(angle - combined, std::memory_order_release);
+    return 0;
+}
+
+int32_t CompositeEncoder::setUpdatePeriod(Time period) {
+    m_updatePeriod = std::max(0.0, std::round(to_msec(period)));
+    return 0;
+}
+
+Time CompositeEncoder::getUpdatePeriod() const { return from_msec(m_updatePeriod.load()); }
+} // namespace lemlib
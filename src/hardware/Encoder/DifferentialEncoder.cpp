@@ -0,0 +1,15 @@
+#include "hardware/Encoder/DifferentialEncoder.hpp"
+
+namespace lemlib {
+DifferentialEncoder::DifferentialEncoder(Encoder& left, Encoder& right, double scale)
+    : CompositeEncoder({&left, &right}),
+      m_scale(scale) {}
+
+DifferentialEncoder::DifferentialEncoder(Encoder& left, Encoder& right, Length wheelDiameter, Length trackWidth)
+    // each wheel travels its angle in radians times the radius, and the heading is the difference over the track width
+    : DifferentialEncoder(left, right, to_m(wheelDiameter) / (2 * to_m(trackWidth))) {}
+
+double DifferentialEncoder::getScale() const { return m_scale; }
+
+Angle DifferentialEncoder::combine(std::span<const Angle> angles) const { return (angles[1] - angles[0]) * m_scale; }
+} // namespace lemlib
@@ -0,0 +1,109 @@
+#include "hardware/Encoder/EncoderHistory.hpp"
+#include <cmath>
+#include <errno.h>
+
+namespace lemlib {
+EncoderHistoryBase::EncoderHistoryBase(EncoderSample* storage, size_t capacity)
+    : m_storage(storage),
+      m_capacity(capacity) {}
+
+void EncoderHistoryBase::push(const EncoderSample& sample) {
+    const uint32_t head = m_head.load(std::memory_order_relaxed);
+    m_storage[head % m_capacity] = sample;
+    m_head.store(head + 1, std::memory_order_release);
+}
+
+bool EncoderHistoryBase::readLatest(EncoderSample* out, size_t count) const {
+    while (true) {
+        const uint32_t head = m_head.load(std::memory_order_acquire);
+        if (head < count) return false;
+        for (size_t i = 0; i < count; i++) out[i] = m_storage[(head - 1 - i) % m_capacity];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // the writer is never writing to the slot of the oldest sample copied until it wraps around to it
+        if (m_head.load(std::memory_order_relaxed) - head < m_capacity - count) return true;
+    }
+}
+
+EncoderSample EncoderHistoryBase::getSample(size_t age) const {
+    if (age >= getCapacity()) {
+        errno = EINVAL;
+        return {};
+    }
+    while (true) {
+        const uint32_t head = m_head.load(std::memory_order_acquire);
+        if (head <= age) {
+            errno = EINVAL;
+            return {};
+        }
+        const EncoderSample sample = m_storage[(head - 1 - age) % m_capacity];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // the writer is never writing to the slot of the sample until it wraps around to it
+        if (m_head.load(std::memory_order_relaxed) - head < m_capacity - age - 1) return sample;
+    }
+}
+
+Angle EncoderHistoryBase::getAngle(Time timestamp) const {
+    while (true) {
+        const uint32_t head = m_head.load(std::memory_order_acquire);
+        const size_t size = head < getCapacity() ? head : getCapacity();
+        if (size == 0) {
+            errno = EINVAL;
+            return from_stDeg(INFINITY);
+        }
+        // walk back from the latest sample, as the time is almost always between the latest two
+        EncoderSample newer = m_storage[(head - 1) % m_capacity];
+        Angle angle = from_stDeg(INFINITY);
+        // the age of the oldest sample read
+        size_t oldest = 0;
+        if (timestamp == newer.timestamp) angle = newer.angle;
+        while (timestamp < newer.timestamp && oldest + 1 < size) {
+            const EncoderSample older = m_storage[(head - 2 - oldest++) % m_capacity];
+            if (older.timestamp <= timestamp) {
+                const Number t = (timestamp - older.timestamp) / (newer.timestamp - older.timestamp);
+                angle = older.angle + (newer.angle - older.angle) * to_num(t);
+                break;
+            }
+            newer = older;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // the writer is never writing to the slot of the oldest sample read until it wraps around to it
+        if (m_head.load(std::memory_order_relaxed) - head >= m_capacity - oldest - 1) continue;
+        if (angle == from_stDeg(INFINITY)) errno = ERANGE;
+        return angle;
+    }
+}
+
+size_t EncoderHistoryBase::getSize() const {
+    const uint32_t head = m_head.load(std::memory_order_acquire);
+    return head < getCapacity() ? head : getCapacity();
+}
+
+// one slot is always reserved for the writer, so it never writes to a slot which can be read
+size_t EncoderHistoryBase::getCapacity() const { return m_capacity - 1; }
+
+AngularVelocity EncoderHistoryBase::getVelocity() const {
+    EncoderSample samples[2];
+    if (!readLatest(samples, 2)) {
+        errno = EINVAL;
+        return from_radps(INFINITY);
+    }
+    const Time dt = samples[0].timestamp - samples[1].timestamp;
+    if (dt == 0_sec) return from_radps(INFINITY);
+    return (samples[0].angle - samples[1].angle) / dt;
+}
+
+AngularAcceleration EncoderHistoryBase::getAcceleration() const {
+    EncoderSample samples[3];
+    if (!readLatest(samples, 3)) {
+        errno = EINVAL;
+        return from_radps2(INFINITY);
+    }
+    const Time dt1 = samples[0].timestamp - samples[1].timestamp;
+    const Time dt2 = samples[1].timestamp - samples[2].timestamp;
+    if (dt1 == 0_sec || dt2 == 0_sec) return from_radps2(INFINITY);
+    // the velocities are measured halfway between each pair of samples
+    const AngularVelocity v1 = (samples[0].angle - samples[1].angle) / dt1;
+    const AngularVelocity v2 = (samples[1].angle - samples[2].angle) / dt2;
+    return (v1 - v2) / ((dt1 + dt2) / 2);
+}
+} // namespace lemlib
@@ -0,0 +1,44 @@
+#include "hardware/Encoder/ReplayEncoder.hpp"
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+ReplayEncoder::ReplayEncoder(const ReplayLog& log, uint16_t device)
+    : m_log(log),
+      m_device(device) {}
+
+ReplayEncoder::ReplayEncoder(const ReplayEncoder& other)
+    : m_log(other.m_log),
+      m_device(other.m_device),
+      m_offset(other.m_offset.load(std::memory_order_acquire)) {}
+
+int32_t ReplayEncoder::isConnected() const {
+    const TelemetryRecord* record = m_log.find(m_device, TelemetryKind::ENCODER);
+    return record != nullptr && record->error == 0;
+}
+
+Angle ReplayEncoder::readAngle() const {
+    const TelemetryRecord* record = m_log.find(m_device, TelemetryKind::ENCODER);
+    if (record == nullptr || record->error != 0) {
+        errno = ENODEV;
+        return from_stDeg(INFINITY);
+    }
+    return from_stDeg(record->values[0]);
+}
+
+Angle ReplayEncoder::getAngle() const {
+    const Angle angle = readAngle();
+    if (angle.internal() == INFINITY) return angle;
+    return angle + m_offset.load(std::memory_order_acquire);
+}
+
+int32_t ReplayEncoder::setAngle(Angle angle) {
+    std::lock_guard lock(m_mutex);
+    const Angle recorded = readAngle();
+    if (recorded.internal() == INFINITY) return INT_MAX;
+    m_offset.store(angle - recorded, std::memory_order_release);
+    return 0;
+}
+} // namespace lemlib
@@ -0,0 +1,56 @@
+#include "hardware/Encoder/TickVelocityEstimator.hpp"
+#include <cmath>
+
+namespace lemlib {
+TickVelocityEstimator::TickVelocityEstimator(Angle tick, TickVelocitySettings settings)
+    : m_tick(units::abs(tick)),
+      m_settings(settings) {}
+
+void TickVelocityEstimator::update(Time timestamp, Angle angle) {
+    if (!m_initialized) {
+        m_initialized = true;
+        m_sampleTime = timestamp;
+        m_sampleAngle = angle;
+        m_edgeKnown = false;
+        m_velocity = 0_radps;
+        return;
+    }
+    const Time dt = timestamp - m_sampleTime;
+    if (dt <= 0_sec) return;
+    const Angle delta = angle - m_sampleAngle;
+    const double ticks = std::round(to_stRot(delta) / to_stRot(m_tick));
+    if (ticks != 0) {
+        // the count changed some time since the previous sample, so halfway between them is the best guess of when
+        const Time edgeTime = m_sampleTime + dt / 2;
+        const Angle sinceEdge = angle - m_edgeAngle;
+        // fast enough that a single sample measures it well, or the first change, or a change of direction
+        if (std::abs(ticks) >= m_settings.highSpeedTicks || !m_edgeKnown ||
+            units::sgn(sinceEdge) != units::sgn(delta)) {
+            m_velocity = delta / dt;
+        } else {
+            m_velocity = sinceEdge / (edgeTime - m_edgeTime);
+        }
+        m_edgeKnown = true;
+        m_edgeTime = edgeTime;
+        m_edgeAngle = angle;
+    } else if (m_edgeKnown) {
+        const Time sinceEdge = timestamp - m_edgeTime;
+        if (sinceEdge >= m_settings.timeout) {
+            m_velocity = 0_radps;
+        } else if (units::abs(m_velocity) * sinceEdge > m_tick) {
+            // the next tick hasn't arrived yet, so the encoder is turning at most a tick over the time since the last
+            m_velocity = units::sgn(m_velocity) * m_tick / sinceEdge;
+        }
+    }
+    m_sampleTime = timestamp;
+    m_sampleAngle = angle;
+}
+
+void TickVelocityEstimator::reset() { m_initialized = false; }
+
+void TickVelocityEstimator::setSettings(TickVelocitySettings settings) { m_settings = settings; }
+
+TickVelocitySettings TickVelocityEstimator::getSettings() const { return m_settings; }
+
+AngularVelocity TickVelocityEstimator::getVelocity() const { return m_initialized ? m_velocity : 0_radps; }
+} // namespace lemlib
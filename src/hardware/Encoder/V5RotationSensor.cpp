@@ -1,64 +1,110 @@
 #include "hardware/Encoder/V5RotationSensor.hpp"
+#include "hardware/BootTrace.hpp"
 #include "hardware/Port.hpp"
-#include "hardware/util.hpp"
+#include "hardware/SdkCallTracker.hpp"
 #include "pros/rotation.hpp"
+#include <cmath>
+#include <errno.h>
 #include <limits.h>
 #include <mutex>
 
 namespace lemlib {
+// the limit is the size on the host the simulator runs on, which the brain, with 4 byte pointers, is always within
+static_assert(sizeof(V5RotationSensor) <= 96, "V5RotationSensor grew. Keep its small members together");
+
 V5RotationSensor::V5RotationSensor(ReversibleSmartPort port)
-    : m_port(abs(port)),
-      m_reversed(port < 0) {
-    pros::c::rotation_set_reversed(m_port, m_reversed);
+    : V5RotationSensor(port, deferred_init) {
+    initialize();
+}
+
+int32_t V5RotationSensor::initialize() {
+    LEMLIB_BOOT_SPAN("configure rotation sensor", m_port);
+    m_mutex.initialize();
+    m_claim = PortClaim(m_port, pros::c::E_DEVICE_ROTATION);
+    m_readCache = ReadCache(DeviceRegistry::get().getPortState(m_port).reading);
+    // reversal is handled in software by negating the position, so the sensor itself is never reversed. This only
+    // has to be done once, as the sensor is not reversed by default after it reconnects
+    if (LEMLIB_SDK_CALL(m_port, pros::c::rotation_set_reversed(m_port, false)) == INT_MAX) return INT_MAX;
+    return 0;
 }
 
 V5RotationSensor::V5RotationSensor(const V5RotationSensor& other)
     : m_port(other.m_port),
-      m_reversed(other.m_reversed),
-      m_offset(other.m_offset) {}
+      m_dataRate(other.m_dataRate.load()),
+      m_config(other.m_config.read()),
+      m_claim(other.m_claim),
+      m_readCache(other.m_readCache) {}
 
+#ifndef LEMLIB_SIM
 V5RotationSensor V5RotationSensor::from_pros_rot(pros::Rotation encoder) {
     if (encoder.get_reversed()) return V5RotationSensor {{-encoder.get_port(), runtime_check_port}};
     else return V5RotationSensor {{encoder.get_port(), runtime_check_port}};
 }
 
-int32_t V5RotationSensor::isConnected() const {
-    if (pros::c::rotation_set_reversed(m_port, m_reversed) == INT_MAX) return 0;
-    if (pros::c::rotation_get_angle(m_port) == INT_MAX) return 0;
-    else return 1;
+std::vector<V5RotationSensor> V5RotationSensor::from_pros_rots(std::span<const pros::Rotation> encoders) {
+    std::vector<V5RotationSensor> result;
+    result.reserve(encoders.size());
+    for (const pros::Rotation& encoder : encoders) {
+        const int port = encoder.get_port();
+        result.emplace_back(ReversibleSmartPort {encoder.get_reversed() ? -port : port, runtime_check_port});
+    }
+    return result;
 }
+#endif
 
-Angle V5RotationSensor::getAngle() const {
-    std::lock_guard lock(m_mutex);
-    if (pros::c::rotation_set_reversed(m_port, m_reversed) == INT_MAX) return from_stRot(INFINITY);
-    const int32_t raw = pros::c::rotation_get_position(m_port);
-    if (raw == INT_MAX) return from_stRot(INFINITY);
-    // the rotation sensor returns centidegrees, so we have to convert to degrees
-    const Angle angle = from_stDeg(double(raw) / 100);
-    return angle + m_offset;
+int32_t V5RotationSensor::isConnected() const {
+    return DeviceRegistry::get().isPlugged(m_port, pros::c::E_DEVICE_ROTATION);
 }
 
 int32_t V5RotationSensor::setAngle(Angle angle) {
     std::lock_guard lock(m_mutex);
-    if (pros::c::rotation_set_reversed(m_port, m_reversed) == INT_MAX) return INT_MAX;
     // requestedAngle = pos + offset
     // offset = requestedAngle - raw
-    const int32_t raw = pros::c::rotation_get_position(m_port);
+    Config config = m_config.read();
+    const int32_t raw = LEMLIB_SDK_CALL(m_port, pros::c::rotation_get_position(m_port));
     if (raw == INT_MAX) return INT_MAX;
-    // the rotation sensor returns centidegrees, so we have to convert to degrees
-    const Angle position = from_stDeg(double(raw) / 100);
-    m_offset = angle - position;
+    config.offset = angle - rawToAngle(raw, config.reversed);
+    m_config.write(config);
     return 0;
 }
 
-int32_t V5RotationSensor::isReversed() const {
-    std::lock_guard lock(m_mutex);
-    return m_reversed;
-}
+int32_t V5RotationSensor::isReversed() const { return m_config.read().reversed; }
 
 int32_t V5RotationSensor::setReversed(bool reversed) {
     std::lock_guard lock(m_mutex);
-    m_reversed = reversed;
-    return convertStatus(pros::c::rotation_set_reversed(m_port, m_reversed));
+    // reversal is handled in software, so the sensor doesn't need to be updated
+    Config config = m_config.read();
+    config.reversed = reversed;
+    m_config.write(config);
+    return 0;
 }
+
+AngularVelocity V5RotationSensor::getVelocity() const {
+    const int32_t raw = LEMLIB_SDK_CALL(m_port, pros::c::rotation_get_velocity(m_port));
+    if (raw == INT_MAX) return from_rpm(INFINITY);
+    // the sensor reports centidegrees per second
+    const AngularVelocity velocity = from_degps(raw / 100.0);
+    return m_config.read().reversed ? -velocity : velocity;
+}
+
+int32_t V5RotationSensor::setDataRate(Time rate) {
+    // written so NaN fails the comparison
+    if (!(rate >= 5_msec) || rate == from_sec(INFINITY)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    const uint32_t milliseconds = std::floor(to_msec(rate));
+    if (LEMLIB_SDK_CALL(m_port, pros::c::rotation_set_data_rate(m_port, milliseconds)) == INT_MAX) return INT_MAX;
+    m_dataRate = milliseconds - milliseconds % 5;
+    return 0;
+}
+
+Time V5RotationSensor::getDataRate() const { return from_msec(m_dataRate.load()); }
+
+int32_t V5RotationSensor::setReadCacheWindow(Time window) {
+    m_readCache.setWindow(window);
+    return 0;
+}
+
+Time V5RotationSensor::getReadCacheWindow() const { return m_readCache.getWindow(); }
 } // namespace lemlib
\ No newline at end of file
@@ -0,0 +1,299 @@
+#include "hardware/FileService.hpp"
+#include "hardware/AllocationTracker.hpp"
+#include "hardware/BootTrace.hpp"
+#include "hardware/TaskManager.hpp"
+#include "hardware/TaskMonitor.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <errno.h>
+
+namespace lemlib {
+FileOperation::FileOperation(Callback callback, void* context)
+    : m_callback(callback),
+      m_context(context) {}
+
+FileOperationState FileOperation::getState() const { return m_state.load(std::memory_order_acquire); }
+
+bool FileOperation::isDone() const {
+    const FileOperationState state = getState();
+    return state == FileOperationState::DONE || state == FileOperationState::FAILED;
+}
+
+FileOperationState FileOperation::wait(Time timeout) {
+    FileOperationState state = getState();
+    // an operation which was never submitted has no service to wait on
+    if (m_finished == nullptr) return state;
+    m_finished->waitUntil(
+        [&] {
+            state = getState();
+            return state != FileOperationState::PENDING;
+        },
+        timeout);
+    return state;
+}
+
+int32_t FileOperation::getResult() const {
+    switch (getState()) {
+        case FileOperationState::DONE: return m_result;
+        case FileOperationState::FAILED: errno = m_error; return INT_MAX;
+        default: errno = EBUSY; return INT_MAX;
+    }
+}
+
+FileService::FileService(Time period)
+    : m_period(period) {}
+
+FileService::~FileService() {
+    stop();
+    if (m_stream == nullptr) return;
+    // the producer is gone, so its partly filled buffer can be written too
+    writeBuffers();
+    handOver();
+    writeBuffers();
+    std::fclose(m_stream);
+}
+
+int32_t FileService::submit(const Request& request) {
+    FileOperation& operation = *request.operation;
+    operation.m_finished = &m_finished;
+    operation.m_state.store(FileOperationState::PENDING, std::memory_order_relaxed);
+    // push has already set errno
+    if (m_requests.push(request) == INT_MAX) {
+        operation.m_state.store(FileOperationState::IDLE, std::memory_order_relaxed);
+        return INT_MAX;
+    }
+    return 0;
+}
+
+int32_t FileService::read(const char* path, std::span<uint8_t> buffer, FileOperation& operation, size_t offset) {
+    if (operation.getState() == FileOperationState::PENDING) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    return submit({.type = RequestType::READ,
+                   .path = path,
+                   .data = buffer.data(),
+                   .size = buffer.size(),
+                   .offset = offset,
+                   .operation = &operation});
+}
+
+int32_t FileService::write(const char* path, std::span<const uint8_t> data, FileOperation& operation, bool append) {
+    if (operation.getState() == FileOperationState::PENDING) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    return submit({.type = RequestType::WRITE,
+                   .path = path,
+                   .data = const_cast<uint8_t*>(data.data()),
+                   .size = data.size(),
+                   .append = append,
+                   .operation = &operation});
+}
+
+int32_t FileService::openStream(const char* path, FileOperation& operation) {
+    if (operation.getState() == FileOperationState::PENDING) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    return submit({.type = RequestType::OPEN, .path = path, .operation = &operation});
+}
+
+bool FileService::handOver() {
+    if (m_filled == 0) return true;
+    const uint8_t other = m_active ^ 1;
+    if (m_full[other].load(std::memory_order_acquire)) return false;
+    m_sizes[m_active] = m_filled;
+    // publish the buffer only after its size has been written
+    m_full[m_active].store(true, std::memory_order_release);
+    m_active = other;
+    m_filled = 0;
+    return true;
+}
+
+int32_t FileService::append(std::span<const uint8_t> data) {
+    LEMLIB_ALLOCATION_FREE("FileService::append");
+    // a buffer which filled while the other one was being written is handed over as soon as the other one is free
+    if (m_filled == BUFFER_SIZE) handOver();
+    const bool otherFree = !m_full[m_active ^ 1].load(std::memory_order_acquire);
+    const size_t room = BUFFER_SIZE - m_filled + (otherFree ? BUFFER_SIZE : 0);
+    if (data.size() > room) {
+        m_dropped.fetch_add(data.size(), std::memory_order_relaxed);
+        errno = ENOBUFS;
+        return INT_MAX;
+    }
+    const size_t first = std::min(data.size(), BUFFER_SIZE - m_filled);
+    std::memcpy(m_buffers[m_active] + m_filled, data.data(), first);
+    m_filled += first;
+    if (first < data.size()) {
+        // the other buffer was free when the room was checked, and only this task can fill it, so this can't fail
+        handOver();
+        std::memcpy(m_buffers[m_active], data.data() + first, data.size() - first);
+        m_filled = data.size() - first;
+    }
+    if (m_filled == BUFFER_SIZE) handOver();
+    return 0;
+}
+
+int32_t FileService::flushStream(FileOperation& operation) {
+    if (operation.getState() == FileOperationState::PENDING) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    if (!handOver()) {
+        errno = EAGAIN;
+        return INT_MAX;
+    }
+    return submit({.type = RequestType::FLUSH, .operation = &operation});
+}
+
+int32_t FileService::closeStream(FileOperation& operation) {
+    if (operation.getState() == FileOperationState::PENDING) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    if (!handOver()) {
+        errno = EAGAIN;
+        return INT_MAX;
+    }
+    return submit({.type = RequestType::CLOSE, .operation = &operation});
+}
+
+uint32_t FileService::getDropped() const { return m_dropped.load(); }
+
+void FileService::writeBuffers() {
+    // buffers appended before the stream is open wait for it
+    if (m_stream == nullptr) return;
+    for (int i = 0; i < 2; i++) {
+        if (!m_full[i].load(std::memory_order_acquire)) continue;
+        const size_t written = std::fwrite(m_buffers[i], 1, m_sizes[i], m_stream);
+        m_dropped.fetch_add(m_sizes[i] - written, std::memory_order_relaxed);
+        // free the buffer only after it has been written
+        m_full[i].store(false, std::memory_order_release);
+    }
+}
+
+void FileService::finish(FileOperation& operation, int32_t result, int error) {
+    operation.m_result = result;
+    operation.m_error = error;
+    if (operation.m_callback != nullptr) {
+        errno = error;
+        operation.m_callback(result, operation.m_context);
+    }
+    // the operation may be destroyed by its owner as soon as it is marked as finished, so it isn't touched after
+    operation.m_state.store(result == INT_MAX ? FileOperationState::FAILED : FileOperationState::DONE,
+                            std::memory_order_release);
+    m_finished.notify();
+}
+
+void FileService::handle(const Request& request) {
+    FileOperation& operation = *request.operation;
+    switch (request.type) {
+        case RequestType::READ: {
+            FILE* file = std::fopen(request.path, "rb");
+            if (file == nullptr) return finish(operation, INT_MAX, errno);
+            if (request.offset != 0 && std::fseek(file, request.offset, SEEK_SET) != 0) {
+                const int error = errno;
+                std::fclose(file);
+                return finish(operation, INT_MAX, error);
+            }
+            const size_t count = std::fread(request.data, 1, request.size, file);
+            const bool failed = std::ferror(file);
+            std::fclose(file);
+            if (failed) return finish(operation, INT_MAX, EIO);
+            return finish(operation, count, 0);
+        }
+        case RequestType::WRITE: {
+            FILE* file = std::fopen(request.path, request.append ? "ab" : "wb");
+            if (file == nullptr) return finish(operation, INT_MAX, errno);
+            const size_t written = std::fwrite(request.data, 1, request.size, file);
+            // the data may only reach the card when the file is closed
+            if (std::fclose(file) != 0 || written != request.size) return finish(operation, INT_MAX, EIO);
+            return finish(operation, written, 0);
+        }
+        case RequestType::OPEN: {
+            if (m_stream != nullptr) {
+                writeBuffers();
+                std::fclose(m_stream);
+            }
+            m_stream = std::fopen(request.path, "wb");
+            if (m_stream == nullptr) {
+                const int error = errno;
+                // nothing will ever write the buffers appended so far, so they are dropped to make room
+                for (int i = 0; i < 2; i++) {
+                    if (!m_full[i].load(std::memory_order_acquire)) continue;
+                    m_dropped.fetch_add(m_sizes[i], std::memory_order_relaxed);
+                    m_full[i].store(false, std::memory_order_release);
+                }
+                return finish(operation, INT_MAX, error);
+            }
+            // the buffers are already large, so a second copy in the C library would only cost time
+            std::setvbuf(m_stream, nullptr, _IONBF, 0);
+            writeBuffers();
+            return finish(operation, 0, 0);
+        }
+        case RequestType::FLUSH:
+        case RequestType::CLOSE: {
+            if (m_stream == nullptr) return finish(operation, INT_MAX, EBADF);
+            writeBuffers();
+            if (request.type == RequestType::FLUSH) {
+                if (std::fflush(m_stream) != 0) return finish(operation, INT_MAX, EIO);
+                return finish(operation, 0, 0);
+            }
+            const bool closed = std::fclose(m_stream) == 0;
+            m_stream = nullptr;
+            if (!closed) return finish(operation, INT_MAX, EIO);
+            return finish(operation, 0, 0);
+        }
+    }
+}
+
+int32_t FileService::start(uint32_t priority) {
+    if (m_running.load() || !m_taskExited.load()) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    m_running = true;
+    m_taskExited = false;
+    LEMLIB_BOOT_EVENT("create lemlib file service task", 0);
+    const pros::task_t task =
+        TaskManager::get().create(TaskRole::FILE_SERVICE, taskFunction, this, priority, "lemlib file service");
+    if (task == nullptr) {
+        m_running = false;
+        m_taskExited = true;
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+void FileService::stop() {
+    m_running = false;
+    // wait for the task to finish its current request, so the rest can be handled here without racing it
+    while (!m_taskExited.load()) pros::c::delay(1);
+    Request request;
+    while (m_requests.tryPop(request)) {
+        writeBuffers();
+        handle(request);
+    }
+    writeBuffers();
+}
+
+void FileService::taskFunction(void* service) {
+    FileService& self = *static_cast<FileService*>(service);
+    const int32_t slot = TaskManager::get().attach(TaskRole::FILE_SERVICE, "lemlib file service");
+    Request request;
+    while (self.m_running.load()) {
+        // the task sleeps until a request arrives, and wakes every period to write a buffer the stream filled
+        const bool received = self.m_requests.pop(request, self.m_period);
+        TaskMonitor::Work work(slot);
+        self.writeBuffers();
+        if (received) self.handle(request);
+    }
+    TaskMonitor::get().detach(slot);
+    // PROS deletes the task once this function returns
+    self.m_taskExited = true;
+}
+} // namespace lemlib
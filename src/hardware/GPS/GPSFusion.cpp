@@ -0,0 +1,68 @@
+#include "hardware/GPS/GPSFusion.hpp"
+#include <climits>
+#include <cmath>
+#include <errno.h>
+
+namespace lemlib {
+GPSFusion::GPSFusion(Odometry& odometry, V5GPS& gps, const GPSFusionSettings& settings)
+    : m_odometry(odometry),
+      m_gps(gps),
+      m_settings(settings),
+      m_variance(to_m(settings.initialError) * to_m(settings.initialError)),
+      m_lastReading(from_in(INFINITY), from_in(INFINITY), from_stDeg(INFINITY)) {}
+
+int32_t GPSFusion::update() {
+    const GPSReading reading = m_gps.getReading();
+    if (reading.pose.x == from_in(INFINITY)) return INT_MAX;
+    return fuse(reading);
+}
+
+int32_t GPSFusion::fuse(const GPSReading& reading) {
+    // written so NaN fails the comparison
+    if (!(reading.error >= 0_in) || reading.pose.x == from_in(INFINITY) || reading.error == from_in(INFINITY)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    if (reading.pose.x == m_lastReading.x && reading.pose.y == m_lastReading.y &&
+        reading.pose.orientation == m_lastReading.orientation) {
+        return 0;
+    }
+    m_lastReading = reading.pose;
+    // odometry gets less certain with the distance it travelled since the last reading
+    const units::Pose odometry = m_odometry.getPose();
+    const double travelled = m_hasLastOdometry ? to_m(odometry.distanceTo(m_lastOdometry)) : 0;
+    m_lastOdometry = odometry;
+    m_hasLastOdometry = true;
+    const double drift = m_settings.odometryDrift.internal() * travelled + to_m(m_settings.minDrift);
+    double variance = m_variance.load() + drift * drift;
+
+    const Time taken = reading.timestamp - m_settings.latency;
+    const units::Pose past = m_odometry.getPose(taken);
+    if (past.x == from_in(INFINITY)) {
+        m_variance.store(variance);
+        return INT_MAX;
+    }
+    const double measurementVariance = to_m(reading.error) * to_m(reading.error);
+    const double dx = to_m(reading.pose.x - past.x);
+    const double dy = to_m(reading.pose.y - past.y);
+    const double gate = m_settings.gate.internal();
+    if (dx * dx + dy * dy > gate * gate * (variance + measurementVariance)) {
+        m_variance.store(variance);
+        return 0;
+    }
+    const double gain = variance / (variance + measurementVariance);
+    const units::Pose blended(past.x + from_m(gain * dx), past.y + from_m(gain * dy),
+                              past.orientation +
+                                  m_settings.headingGain * units::angleError(reading.pose.orientation, past.orientation));
+    if (m_odometry.correctPose(taken, blended) == INT_MAX) {
+        m_variance.store(variance);
+        return INT_MAX;
+    }
+    m_variance.store(variance * (1 - gain));
+    return 0;
+}
+
+void GPSFusion::reset(Length error) { m_variance.store(to_m(error) * to_m(error)); }
+
+Length GPSFusion::getError() const { return from_m(std::sqrt(m_variance.load())); }
+} // namespace lemlib
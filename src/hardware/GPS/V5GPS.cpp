@@ -0,0 +1,50 @@
+#include "hardware/GPS/V5GPS.hpp"
+#include "hardware/SdkCallTracker.hpp"
+#include "pros/error.h"
+#include "pros/gps.h"
+#include "pros/rtos.h"
+#include <errno.h>
+
+namespace lemlib {
+V5GPS::V5GPS(SmartPort port, units::Pose offset)
+    : m_port(port),
+      m_offset(offset),
+      m_claim(m_port, pros::c::E_DEVICE_GPS) {}
+
+V5GPS::V5GPS(const V5GPS& other)
+    : m_port(other.m_port),
+      m_offset(other.m_offset.read()),
+      m_claim(other.m_claim) {}
+
+#ifndef LEMLIB_SIM
+V5GPS V5GPS::from_pros_gps(pros::Gps gps, units::Pose offset) {
+    return V5GPS({gps.get_port(), runtime_check_port}, offset);
+}
+#endif
+
+int32_t V5GPS::isConnected() const { return DeviceRegistry::get().isPlugged(m_port, pros::c::E_DEVICE_GPS); }
+
+GPSReading V5GPS::getReading() const {
+    GPSReading reading;
+    reading.timestamp = from_usec(pros::c::micros());
+    const pros::gps_position_s_t position = LEMLIB_SDK_CALL(m_port, pros::c::gps_get_position(m_port));
+    if (position.x == PROS_ERR_F) return reading;
+    const double heading = LEMLIB_SDK_CALL(m_port, pros::c::gps_get_heading(m_port));
+    if (heading == PROS_ERR_F) return reading;
+    const double error = LEMLIB_SDK_CALL(m_port, pros::c::gps_get_error(m_port));
+    if (error == PROS_ERR_F) return reading;
+    // the GPS measures heading clockwise from the positive y axis, in degrees
+    const units::Pose sensor(from_m(position.x), from_m(position.y), from_stDeg(90 - heading));
+    // the pose of the sensor is the pose of the robot composed with the offset, so the offset is undone
+    reading.pose = sensor.compose(m_offset.read().inverse());
+    reading.error = from_m(error);
+    return reading;
+}
+
+int32_t V5GPS::setOffset(units::Pose offset) {
+    m_offset.write(offset);
+    return 0;
+}
+
+units::Pose V5GPS::getOffset() const { return m_offset.read(); }
+} // namespace lemlib
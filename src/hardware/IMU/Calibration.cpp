@@ -0,0 +1,96 @@
+#include "hardware/IMU/Calibration.hpp"
+#include "hardware/BootTrace.hpp"
+#include <climits>
+#include <errno.h>
+
+namespace lemlib {
+namespace {
+// how often the monitoring task checks the IMUs, in milliseconds
+constexpr uint32_t CALIBRATION_POLL_PERIOD = 10;
+
+/**
+ * @brief Wait for every IMU to finish calibrating, then report the result
+ *
+ * @param parameter a heap allocated shared pointer to the state of the calibration, which is deleted by this task
+ */
+void calibrationTaskFunction(void* parameter) {
+    const std::unique_ptr<std::shared_ptr<detail::CalibrationState>> owner(
+        static_cast<std::shared_ptr<detail::CalibrationState>*>(parameter));
+    detail::CalibrationState& state = **owner;
+    // the span covers the whole calibration, from when the IMUs started calibrating until they all finished
+    LEMLIB_BOOT_SPAN("imu calibration", 0);
+    const uint32_t start = pros::c::millis();
+    bool calibrating = true;
+    while (calibrating && from_msec(pros::c::millis() - start) < state.timeout) {
+        calibrating = false;
+        for (const IMU* imu : state.imus) {
+            if (imu->isCalibrating()) calibrating = true;
+        }
+        if (calibrating) pros::c::delay(CALIBRATION_POLL_PERIOD);
+    }
+    int32_t calibrated = 0;
+    for (const IMU* imu : state.imus) calibrated += imu->isCalibrated() == 1;
+    state.calibrated = calibrated;
+    // an IMU which couldn't start calibrating has already saved its error
+    if (calibrating) state.error = ETIMEDOUT;
+    else if (calibrated != int32_t(state.imus.size()) && state.error == 0) state.error = ENODEV;
+    const int32_t result = state.error == 0 ? 0 : INT_MAX;
+    state.result = result;
+    state.done.store(true, std::memory_order_release);
+    state.finished.notify();
+    if (state.callback) state.callback(result);
+    if (state.notify != nullptr) pros::c::task_notify(state.notify);
+}
+} // namespace
+
+CalibrationHandle::CalibrationHandle(std::shared_ptr<detail::CalibrationState> state)
+    : m_state(std::move(state)) {}
+
+int32_t CalibrationHandle::isDone() const { return m_state->done.load(std::memory_order_acquire); }
+
+int32_t CalibrationHandle::getResult() const {
+    if (!m_state->done.load(std::memory_order_acquire)) {
+        errno = EAGAIN;
+        return INT_MAX;
+    }
+    const int32_t result = m_state->result.load();
+    if (result != 0) errno = m_state->error.load();
+    return result;
+}
+
+int32_t CalibrationHandle::getCalibratedCount() const { return m_state->calibrated.load(); }
+
+int32_t CalibrationHandle::wait(Time timeout) const {
+    if (!m_state->finished.waitUntil([&] { return m_state->done.load(std::memory_order_acquire); }, timeout)) {
+        errno = EAGAIN;
+        return INT_MAX;
+    }
+    return getResult();
+}
+
+CalibrationHandle calibrateIMUs(std::initializer_list<IMU*> imus, std::function<void(int32_t)> callback,
+                                pros::task_t notify, Time timeout) {
+    auto state = std::make_shared<detail::CalibrationState>();
+    state->imus = imus;
+    state->callback = std::move(callback);
+    state->notify = notify;
+    state->timeout = timeout;
+    // calibrating is non-blocking, so every IMU starts calibrating before any of them is checked
+    for (IMU* imu : imus) {
+        if (imu->calibrate() != 0) state->error = errno;
+    }
+    auto* parameter = new std::shared_ptr<detail::CalibrationState>(state);
+    LEMLIB_BOOT_EVENT("create lemlib imu calibration task", 0);
+    const pros::task_t task = pros::c::task_create(calibrationTaskFunction, parameter, TASK_PRIORITY_DEFAULT,
+                                                   TASK_STACK_DEPTH_DEFAULT, "lemlib imu calibration");
+    if (task == nullptr) {
+        delete parameter;
+        // without a task, the calibration can't be monitored, so it is reported as failed straight away
+        state->error = ENOMEM;
+        state->done = true;
+        if (state->callback) state->callback(INT_MAX);
+        if (notify != nullptr) pros::c::task_notify(notify);
+    }
+    return CalibrationHandle(state);
+}
+} // namespace lemlib
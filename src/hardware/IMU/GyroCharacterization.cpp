@@ -0,0 +1,216 @@
+#include "hardware/IMU/GyroCharacterization.hpp"
+#include "hardware/AllocationTracker.hpp"
+#include "hardware/BootTrace.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+namespace {
+/**
+ * @brief Read the next gyro scalar of a file written by saveGyroScalars
+ *
+ * @param file the file
+ * @param scalar set to the scalar
+ * @return true a finite positive scalar was read
+ * @return false the file ended, or the next scalar is invalid
+ */
+bool readScalar(FILE* file, double& scalar) {
+    // written so NaN fails the comparison
+    return std::fscanf(file, "%lf", &scalar) == 1 && scalar > 0 && scalar < INFINITY;
+}
+} // namespace
+
+GyroCharacterization::GyroCharacterization(DifferentialDrive& drive, const TrackingWheel& a, const TrackingWheel& b,
+                                           std::initializer_list<IMU*> imus,
+                                           const GyroCharacterizationSettings& settings)
+    : m_drive(drive),
+      m_a(a),
+      m_b(b),
+      m_settings(settings),
+      m_count(std::min(imus.size(), MAX_IMUS)) {
+    for (size_t i = 0; i < m_count; i++) m_fits[i].imu = imus.begin()[i];
+}
+
+GyroCharacterization::~GyroCharacterization() { stop(); }
+
+double GyroCharacterization::wheelHeading() const {
+    const Length a = m_a.getDistance();
+    const Length b = m_b.getDistance();
+    // a wheel reads the forward motion minus its offset times the change in heading
+    const double heading = to_m(b - a) / to_m(m_a.getOffset() - m_b.getOffset());
+    return std::isfinite(heading) ? heading : INFINITY;
+}
+
+int32_t GyroCharacterization::update() {
+    LEMLIB_ALLOCATION_FREE("GyroCharacterization::update");
+    const uint64_t now = pros::c::micros();
+    GyroCharacterizationPhase phase = m_phase.load();
+    if (phase == GyroCharacterizationPhase::DONE) return 0;
+    if (phase == GyroCharacterizationPhase::IDLE) {
+        m_start = now;
+        m_phaseStart = now;
+        phase = GyroCharacterizationPhase::SPINNING;
+    }
+
+    const double heading = wheelHeading();
+    double spun = 0;
+    {
+        std::lock_guard lock(m_mutex);
+        // an interval where the wheels or an IMU couldn't be read is left out of the fit
+        const double reference = heading - m_lastHeading;
+        for (Fit& fit : std::span(m_fits.data(), m_count)) {
+            const double scalar = fit.imu->getGyroScalar().internal();
+            const double raw = to_stRad(fit.imu->getRotation()) / scalar;
+            const double x = raw - fit.last;
+            if (std::isfinite(x) && std::isfinite(reference)) {
+                fit.xx += x * x;
+                fit.xy += x * reference;
+            }
+            fit.last = std::isfinite(raw) ? raw : INFINITY;
+        }
+        if (m_firstHeading == INFINITY) m_firstHeading = heading;
+        m_lastHeading = heading;
+        if (std::isfinite(heading - m_firstHeading)) spun = std::abs(heading - m_firstHeading);
+    }
+
+    const Time elapsed = from_usec(now - m_phaseStart);
+    if (phase == GyroCharacterizationPhase::SPINNING &&
+        (spun >= to_stRad(m_settings.rotation) || from_usec(now - m_start) >= m_settings.timeout)) {
+        m_phaseStart = now;
+        phase = GyroCharacterizationPhase::SETTLING;
+    } else if (phase == GyroCharacterizationPhase::SETTLING && elapsed >= m_settings.settleDuration) {
+        phase = GyroCharacterizationPhase::DONE;
+    }
+    double power = 0;
+    if (phase == GyroCharacterizationPhase::SPINNING) {
+        const double ramp = std::min(1.0, to_sec(elapsed) / to_sec(m_settings.rampDuration));
+        power = (m_settings.reverse ? -1 : 1) * m_settings.power.internal() * (std::isfinite(ramp) ? ramp : 1.0);
+    }
+    m_phase = phase;
+    // counterclockwise is the left side backwards and the right side forwards
+    return m_drive.move(-power, power);
+}
+
+int32_t GyroCharacterization::start(Time period, uint32_t priority) {
+    std::lock_guard lock(m_mutex);
+    if (m_running.load() || !m_taskExited.load()) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    for (Fit& fit : m_fits) fit = {.imu = fit.imu};
+    m_firstHeading = INFINITY;
+    m_lastHeading = INFINITY;
+    m_phase = GyroCharacterizationPhase::IDLE;
+    m_period = period;
+    m_running = true;
+    m_taskExited = false;
+    LEMLIB_BOOT_EVENT("create lemlib gyro characterization task", 0);
+    const pros::task_t task = pros::c::task_create(taskFunction, this, priority, TASK_STACK_DEPTH_DEFAULT,
+                                                   "lemlib gyro characterization");
+    if (task == nullptr) {
+        m_running = false;
+        m_taskExited = true;
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+void GyroCharacterization::stop() {
+    const bool wasRunning = m_running.exchange(false);
+    // wait for the task to finish its current update, so the characterization can be safely destroyed afterwards
+    while (!m_taskExited.load()) pros::c::delay(1);
+    if (wasRunning) {
+        m_drive.move(0, 0);
+        m_phase = GyroCharacterizationPhase::DONE;
+    }
+}
+
+GyroCharacterizationPhase GyroCharacterization::getPhase() const { return m_phase.load(); }
+
+Angle GyroCharacterization::getReferenceRotation() const {
+    std::lock_guard lock(m_mutex);
+    const double rotation = m_lastHeading - m_firstHeading;
+    return from_stRad(std::isfinite(rotation) ? rotation : 0);
+}
+
+Result<Number> GyroCharacterization::getScalar(size_t index) const {
+    if (index >= m_count) return Result<Number>::failure(EINVAL);
+    if (units::abs(getReferenceRotation()) < 360_stDeg) return Result<Number>::failure(EAGAIN);
+    std::lock_guard lock(m_mutex);
+    const Fit& fit = m_fits[index];
+    // written so NaN fails the comparison
+    if (!(fit.xx > 0)) return Result<Number>::failure(EDOM);
+    // the least squares fit of wheels = scalar * IMU, through the origin
+    return Number(fit.xy / fit.xx);
+}
+
+int32_t GyroCharacterization::apply() {
+    int32_t error = 0;
+    for (size_t i = 0; i < m_count; i++) {
+        const Result<Number> scalar = getScalar(i);
+        if (scalar.ok()) m_fits[i].imu->setGyroScalar(scalar.value());
+        else error = scalar.error();
+    }
+    if (error == 0) return 0;
+    errno = error;
+    return INT_MAX;
+}
+
+void GyroCharacterization::taskFunction(void* characterization) {
+    GyroCharacterization& self = *static_cast<GyroCharacterization*>(characterization);
+    const uint32_t period = std::max(1.0, std::round(to_msec(self.m_period)));
+    uint32_t now = pros::c::millis();
+    while (self.m_running.load() && self.getPhase() != GyroCharacterizationPhase::DONE) {
+        self.update();
+        pros::c::task_delay_until(&now, period);
+    }
+    // the spin finished on its own, and left the drive stopped
+    self.m_running = false;
+    // PROS deletes the task once this function returns
+    self.m_taskExited = true;
+}
+
+int32_t saveGyroScalars(const char* path, std::initializer_list<const IMU*> imus) {
+    FILE* file = std::fopen(path, "w");
+    // fopen has already set errno
+    if (file == nullptr) return INT_MAX;
+    bool written = true;
+    for (const IMU* imu : imus) written = written && std::fprintf(file, "%.9g\n", imu->getGyroScalar().internal()) > 0;
+    // the scalars may only reach the card when the file is closed
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        errno = EIO;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+int32_t loadGyroScalars(const char* path, std::initializer_list<IMU*> imus) {
+    LEMLIB_BOOT_SPAN("load gyro scalars", 0);
+    FILE* file = std::fopen(path, "r");
+    // fopen has already set errno
+    if (file == nullptr) return INT_MAX;
+    // every scalar is checked before any is set, so a corrupt file doesn't leave the IMUs half set
+    double scalar = 0;
+    bool valid = true;
+    for (size_t i = 0; i < imus.size(); i++) valid = valid && readScalar(file, scalar);
+    valid = valid && std::fseek(file, 0, SEEK_SET) == 0;
+    for (IMU* imu : imus) {
+        if (!valid) break;
+        readScalar(file, scalar);
+        imu->setGyroScalar(scalar);
+    }
+    std::fclose(file);
+    if (!valid) {
+        errno = EPROTO;
+        return INT_MAX;
+    }
+    return 0;
+}
+} // namespace lemlib
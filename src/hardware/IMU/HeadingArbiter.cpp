@@ -0,0 +1,238 @@
+#include "hardware/IMU/HeadingArbiter.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+// a source is only frozen if the heading moved at least this far, in radians, while its reading didn't change. Below
+// that, a robot which sits still would make every source look frozen
+constexpr double FROZEN_MOTION = 1 * M_PI / 180;
+
+HeadingArbiter::HeadingArbiter(HeadingArbiterSettings settings)
+    : m_settings(settings) {}
+
+int32_t HeadingArbiter::add(SourceKind kind, Device* device, Angle noise) {
+    std::lock_guard lock(m_mutex);
+    if (m_sources.full()) {
+        errno = ENOSPC;
+        return INT_MAX;
+    }
+    m_sources.push_back({.kind = kind, .device = device, .noise = std::abs(to_stRad(noise))});
+    return m_sources.size() - 1;
+}
+
+int32_t HeadingArbiter::addSource(IMU& imu, Angle noise) { return add(SourceKind::IMU, &imu, noise); }
+
+int32_t HeadingArbiter::addSource(Encoder& heading, Angle noise) { return add(SourceKind::ENCODER, &heading, noise); }
+
+int32_t HeadingArbiter::addSource(V5GPS& gps, Angle noise) { return add(SourceKind::GPS, &gps, noise); }
+
+int32_t HeadingArbiter::calibrate() {
+    std::lock_guard lock(m_mutex);
+    bool hasIMU = false;
+    bool success = false;
+    for (Source& source : m_sources) {
+        // every source is measured from the new rotation, as the IMUs start over
+        source.last = INFINITY;
+        source.frozenSince = INFINITY;
+        if (source.kind != SourceKind::IMU) continue;
+        hasIMU = true;
+        if (static_cast<IMU*>(source.device)->calibrate() == 0) success = true;
+    }
+    m_heading = 0;
+    if (hasIMU && !success) {
+        errno = ENODEV;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+int32_t HeadingArbiter::isCalibrated() const {
+    std::lock_guard lock(m_mutex);
+    bool hasIMU = false;
+    for (const Source& source : m_sources) {
+        if (source.kind != SourceKind::IMU) continue;
+        hasIMU = true;
+        if (static_cast<IMU*>(source.device)->isCalibrated() == 1) return 1;
+    }
+    return !hasIMU;
+}
+
+int32_t HeadingArbiter::isCalibrating() const {
+    std::lock_guard lock(m_mutex);
+    for (const Source& source : m_sources) {
+        if (source.kind == SourceKind::IMU && static_cast<IMU*>(source.device)->isCalibrating() == 1) return 1;
+    }
+    return 0;
+}
+
+int32_t HeadingArbiter::isConnected() const {
+    std::lock_guard lock(m_mutex);
+    for (const Source& source : m_sources) {
+        if (source.device->isConnected() == 1) return 1;
+    }
+    return 0;
+}
+
+double HeadingArbiter::read(Source& source) {
+    Angle reading = from_stRad(INFINITY);
+    // V5 devices check the snapshot of the DeviceRegistry, so a source which is unplugged costs a single load
+    bool connected = false;
+    switch (source.kind) {
+        case SourceKind::IMU: {
+            IMU& imu = *static_cast<IMU*>(source.device);
+            connected = imu.isConnected() == 1;
+            if (connected) reading = imu.getRotation();
+            break;
+        }
+        case SourceKind::ENCODER: {
+            Encoder& encoder = *static_cast<Encoder*>(source.device);
+            connected = encoder.isConnected() == 1;
+            if (connected) reading = encoder.getAngle();
+            break;
+        }
+        case SourceKind::GPS: {
+            V5GPS& gps = *static_cast<V5GPS*>(source.device);
+            connected = gps.isConnected() == 1;
+            if (connected) reading = gps.getReading().pose.orientation;
+            break;
+        }
+    }
+    if (!connected) {
+        source.health = HeadingSourceHealth::DISCONNECTED;
+        return INFINITY;
+    }
+    if (!std::isfinite(reading.internal())) {
+        source.health = HeadingSourceHealth::UNREADABLE;
+        return INFINITY;
+    }
+    return to_stRad(reading);
+}
+
+Angle HeadingArbiter::getRotation() const {
+    std::lock_guard lock(m_mutex);
+    const double time = pros::c::micros() / 1e6;
+    const double outlier = to_stRad(m_settings.outlierThreshold);
+    bool anyRead = false;
+    // the sources which measured a turn this update, in the order of their turns
+    std::array<Source*, MAX_SOURCES> candidates;
+    size_t count = 0;
+    double totalWeight = 0;
+    std::array<bool, MAX_SOURCES> wasHealthy;
+    for (size_t i = 0; i < m_sources.size(); i++) wasHealthy[i] = m_sources[i].health == HeadingSourceHealth::HEALTHY;
+    for (Source& source : m_sources) {
+        source.turn = INFINITY;
+        source.weight = 0;
+        const double reading = read(source);
+        if (!std::isfinite(reading)) {
+            // the source is measured from scratch once it is back, as it may have been reset in between
+            source.last = INFINITY;
+            source.frozenSince = INFINITY;
+            continue;
+        }
+        anyRead = true;
+        source.health = HeadingSourceHealth::HEALTHY;
+        if (reading != source.last) {
+            source.frozenSince = INFINITY;
+        } else if (!std::isfinite(source.frozenSince)) {
+            source.frozenSince = time;
+            source.headingWhenFrozen = m_heading;
+        } else if (time - source.frozenSince > to_sec(m_settings.staleTime) &&
+                   std::abs(m_heading - source.headingWhenFrozen) > FROZEN_MOTION) {
+            source.health = HeadingSourceHealth::STALE;
+        }
+        if (std::isfinite(source.last) && source.health == HeadingSourceHealth::HEALTHY) {
+            // a GPS reports an orientation which wraps around, so the turn is the shortest way between readings
+            source.turn = to_stRad(units::wrapAngle180(from_stRad(reading - source.last)));
+            source.weight = 1 / (source.noise * source.noise + source.variance);
+            // insertion sort, as there are only a few sources
+            size_t i = count++;
+            for (; i > 0 && candidates[i - 1]->turn > source.turn; i--) candidates[i] = candidates[i - 1];
+            candidates[i] = &source;
+            totalWeight += source.weight;
+        }
+        source.last = reading;
+    }
+    if (!anyRead) {
+        errno = ENODEV;
+        return from_stRad(INFINITY);
+    }
+    if (count > 0) {
+        // the weighted median is the consensus, so a single source which slips can't drag it along
+        double consensus = candidates[0]->turn;
+        double cumulative = 0;
+        for (size_t i = 0; i < count; i++) {
+            cumulative += candidates[i]->weight;
+            consensus = candidates[i]->turn;
+            if (cumulative >= totalWeight / 2) break;
+        }
+        double blendedWeight = 0;
+        double blended = 0;
+        for (size_t i = 0; i < count; i++) {
+            Source& source = *candidates[i];
+            if (std::abs(source.turn - consensus) > outlier) {
+                source.health = HeadingSourceHealth::OUTLIER;
+                source.weight = 0;
+                // an outlier still counts towards the noise, clamped so a single glitch doesn't bury the source
+                source.variance += m_settings.smoothing * (outlier * outlier - source.variance);
+                continue;
+            }
+            blendedWeight += source.weight;
+            blended += source.weight * source.turn;
+        }
+        blended /= blendedWeight;
+        for (size_t i = 0; i < count; i++) {
+            Source& source = *candidates[i];
+            if (source.health != HeadingSourceHealth::HEALTHY) continue;
+            const double disagreement = source.turn - blended;
+            source.variance += m_settings.smoothing * (disagreement * disagreement - source.variance);
+            source.weight /= blendedWeight;
+        }
+        m_heading += blended;
+    }
+    for (size_t i = 0; i < m_sources.size(); i++) {
+        if (wasHealthy[i] != (m_sources[i].health == HeadingSourceHealth::HEALTHY)) m_switches++;
+    }
+    return from_stRad(m_heading);
+}
+
+int32_t HeadingArbiter::setRotation(Angle rotation) {
+    std::lock_guard lock(m_mutex);
+    m_heading = to_stRad(rotation);
+    for (Source& source : m_sources) {
+        source.last = INFINITY;
+        source.frozenSince = INFINITY;
+    }
+    return 0;
+}
+
+int32_t HeadingArbiter::setGyroScalar(Number scalar) {
+    std::lock_guard lock(m_mutex);
+    IMU::setGyroScalar(scalar);
+    int32_t result = 0;
+    for (Source& source : m_sources) {
+        if (source.kind != SourceKind::IMU) continue;
+        // setGyroScalar has already set errno
+        if (static_cast<IMU*>(source.device)->setGyroScalar(scalar) == INT_MAX) result = INT_MAX;
+    }
+    return result;
+}
+
+HeadingSourceStatus HeadingArbiter::getSourceStatus(size_t index) const {
+    std::lock_guard lock(m_mutex);
+    if (index >= m_sources.size()) return {};
+    const Source& source = m_sources[index];
+    return {.health = source.health,
+            .noise = from_stRad(std::sqrt(source.noise * source.noise + source.variance)),
+            .weight = source.weight};
+}
+
+uint32_t HeadingArbiter::getSwitchCount() const {
+    std::lock_guard lock(m_mutex);
+    return m_switches;
+}
+} // namespace lemlib
@@ -9,15 +9,13 @@ IMU::IMU(const IMU& other)
     : m_gyroScalar(other.getGyroScalar()) {}
 
 int32_t IMU::setGyroScalar(Number scalar) {
-    std::lock_guard lock(m_mutex);
-    m_gyroScalar = scalar;
+    m_gyroScalar.store(scalar, std::memory_order_release);
     // Always returns 0 because the scalar setter is not dependent on hardware
     return 0;
 }
 
 Number IMU::getGyroScalar() const {
-    std::lock_guard lock(m_mutex);
     // Never returns an error because the scalar getter is not dependent on hardware
-    return m_gyroScalar;
+    return m_gyroScalar.load(std::memory_order_acquire);
 }
 } // namespace lemlib
\ No newline at end of file
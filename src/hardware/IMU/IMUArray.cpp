@@ -0,0 +1,167 @@
+#include "hardware/IMU/IMUArray.hpp"
+#include <algorithm>
+#include <climits>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+IMUArray::IMUArray(std::initializer_list<SmartPort> ports, Number scalar)
+    : IMU(scalar) {
+    m_sensors.reserve(ports.size());
+    for (const SmartPort port : ports) {
+        m_sensors.push_back(
+            {.imu = V5InertialSensor(port, scalar), .connectedLastRead = true, .variance = INITIAL_VARIANCE});
+    }
+    m_readings.reserve(m_sensors.size());
+    m_sorted.reserve(m_sensors.size());
+}
+
+IMUArray::IMUArray(const IMUArray& other)
+    : IMU(other.getGyroScalar()),
+      m_sensors([&] {
+          std::lock_guard lock(other.m_mutex);
+          return other.m_sensors;
+      }()),
+      m_outlierThreshold(other.m_outlierThreshold) {
+    m_readings.reserve(m_sensors.size());
+    m_sorted.reserve(m_sensors.size());
+}
+
+int32_t IMUArray::calibrate() {
+    std::lock_guard lock(m_mutex);
+    bool success = false;
+    // calibrating is non-blocking, so every sensor calibrates at the same time
+    for (SensorInfo& info : m_sensors) {
+        if (info.imu.calibrate() == 0) success = true;
+        // the sensors start over, so none of them should keep the weight it had
+        info.variance = INITIAL_VARIANCE;
+        info.connectedLastRead = true;
+    }
+    if (!success) errno = ENODEV;
+    return success ? 0 : INT_MAX;
+}
+
+int32_t IMUArray::isCalibrated() const {
+    std::lock_guard lock(m_mutex);
+    bool calibrated = false;
+    for (const SensorInfo& info : m_sensors) {
+        if (info.imu.isCalibrating()) return false;
+        if (info.imu.isCalibrated()) calibrated = true;
+    }
+    return calibrated;
+}
+
+int32_t IMUArray::isCalibrating() const {
+    std::lock_guard lock(m_mutex);
+    for (const SensorInfo& info : m_sensors) {
+        if (info.imu.isCalibrating()) return true;
+    }
+    return false;
+}
+
+int32_t IMUArray::isConnected() const {
+    std::lock_guard lock(m_mutex);
+    for (const SensorInfo& info : m_sensors) {
+        if (info.imu.isConnected()) return true;
+    }
+    return false;
+}
+
+Angle IMUArray::getRotation() const {
+    std::lock_guard lock(m_mutex);
+    // read every sensor once
+    m_readings.clear();
+    bool hasReference = false;
+    for (const SensorInfo& info : m_sensors) {
+        m_readings.push_back(info.imu.getRotation());
+        if (m_readings.back() != from_stDeg(INFINITY) && info.connectedLastRead) hasReference = true;
+    }
+    // sensors which reconnected are only used once their rotation has been set to the others. If there are no others,
+    // they are used as they are
+    const auto isCandidate = [&](std::size_t i) {
+        return m_readings[i] != from_stDeg(INFINITY) && (m_sensors[i].connectedLastRead || !hasReference);
+    };
+    m_sorted.clear();
+    for (std::size_t i = 0; i < m_sensors.size(); i++) {
+        if (isCandidate(i)) m_sorted.push_back(m_readings[i]);
+    }
+    if (m_sorted.empty()) {
+        for (SensorInfo& info : m_sensors) info.connectedLastRead = false;
+        m_used = 0;
+        errno = ENODEV;
+        return from_stDeg(INFINITY);
+    }
+    // the median can't be pulled away by a single sensor, so outliers are found relative to it
+    std::sort(m_sorted.begin(), m_sorted.end());
+    const std::size_t middle = m_sorted.size() / 2;
+    const Angle median = m_sorted.size() % 2 == 1 ? m_sorted[middle] : (m_sorted[middle - 1] + m_sorted[middle]) / 2;
+    // average the sensors which agree with the median, weighted by the inverse of their variance
+    Angle total = 0_stDeg;
+    double totalWeight = 0;
+    int32_t used = 0;
+    std::size_t best = 0;
+    for (std::size_t i = 0; i < m_sensors.size(); i++) {
+        if (!isCandidate(i)) continue;
+        if (!isCandidate(best) || m_sensors[i].variance < m_sensors[best].variance) best = i;
+        if (units::abs(m_readings[i] - median) > m_outlierThreshold) continue;
+        const double weight = 1 / m_sensors[i].variance.internal();
+        total += m_readings[i] * weight;
+        totalWeight += weight;
+        used++;
+    }
+    // if every sensor disagrees with the median, which can happen with two sensors, trust the least noisy one
+    const Angle rotation = used == 0 ? m_readings[best] : total / totalWeight;
+    m_used = used == 0 ? 1 : used;
+    for (std::size_t i = 0; i < m_sensors.size(); i++) {
+        SensorInfo& info = m_sensors[i];
+        const bool connected = m_readings[i] != from_stDeg(INFINITY);
+        if (isCandidate(i)) {
+            const Angle error = m_readings[i] - rotation;
+            info.variance = std::max(info.variance + (error * error - info.variance) * VARIANCE_GAIN, MIN_VARIANCE);
+        } else if (connected) {
+            // the sensor reconnected, so it is set to the combined rotation before it is used again
+            if (info.imu.setRotation(rotation) != 0) continue;
+            info.variance = INITIAL_VARIANCE;
+        }
+        info.connectedLastRead = connected;
+    }
+    return rotation;
+}
+
+int32_t IMUArray::setRotation(Angle rotation) {
+    std::lock_guard lock(m_mutex);
+    bool success = false;
+    for (SensorInfo& info : m_sensors) {
+        const bool set = info.imu.setRotation(rotation) == 0;
+        info.connectedLastRead = set;
+        if (set) success = true;
+    }
+    return success ? 0 : INT_MAX;
+}
+
+int32_t IMUArray::setGyroScalar(Number scalar) {
+    std::lock_guard lock(m_mutex);
+    IMU::setGyroScalar(scalar);
+    for (SensorInfo& info : m_sensors) info.imu.setGyroScalar(scalar);
+    return 0;
+}
+
+int32_t IMUArray::setOutlierThreshold(Angle threshold) {
+    std::lock_guard lock(m_mutex);
+    m_outlierThreshold = threshold;
+    return 0;
+}
+
+std::vector<AngleVariance> IMUArray::getVariances() const {
+    std::lock_guard lock(m_mutex);
+    std::vector<AngleVariance> variances;
+    variances.reserve(m_sensors.size());
+    for (const SensorInfo& info : m_sensors) variances.push_back(info.variance);
+    return variances;
+}
+
+int32_t IMUArray::getSize() const {
+    std::lock_guard lock(m_mutex);
+    return m_used;
+}
+} // namespace lemlib
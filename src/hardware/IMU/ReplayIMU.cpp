@@ -0,0 +1,52 @@
+#include "hardware/IMU/ReplayIMU.hpp"
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+ReplayIMU::ReplayIMU(const ReplayLog& log, uint16_t device, Number scalar)
+    : IMU(scalar),
+      m_log(log),
+      m_device(device) {}
+
+ReplayIMU::ReplayIMU(const ReplayIMU& other)
+    : IMU(other.getGyroScalar()),
+      m_log(other.m_log),
+      m_device(other.m_device),
+      m_offset(other.m_offset.load(std::memory_order_acquire)) {}
+
+int32_t ReplayIMU::calibrate() { return setRotation(0_stDeg); }
+
+int32_t ReplayIMU::isCalibrated() const { return 1; }
+
+int32_t ReplayIMU::isCalibrating() const { return 0; }
+
+int32_t ReplayIMU::isConnected() const {
+    const TelemetryRecord* record = m_log.find(m_device, TelemetryKind::IMU);
+    return record != nullptr && record->error == 0;
+}
+
+Angle ReplayIMU::readRotation() const {
+    const TelemetryRecord* record = m_log.find(m_device, TelemetryKind::IMU);
+    if (record == nullptr || record->error != 0) {
+        errno = ENODEV;
+        return from_stDeg(INFINITY);
+    }
+    return from_stDeg(record->values[0] * m_gyroScalar.load(std::memory_order_acquire));
+}
+
+Angle ReplayIMU::getRotation() const {
+    const Angle rotation = readRotation();
+    if (rotation.internal() == INFINITY) return rotation;
+    return rotation + m_offset.load(std::memory_order_acquire);
+}
+
+int32_t ReplayIMU::setRotation(Angle rotation) {
+    std::lock_guard lock(m_mutex);
+    const Angle recorded = readRotation();
+    if (recorded.internal() == INFINITY) return INT_MAX;
+    m_offset.store(rotation - recorded, std::memory_order_release);
+    return 0;
+}
+} // namespace lemlib
@@ -1,49 +1,330 @@
 #include "hardware/IMU/V5InertialSensor.hpp"
+#include "hardware/BootTrace.hpp"
 #include "hardware/Port.hpp"
-#include "pros/imu.hpp"
+#include "hardware/Probe.hpp"
+#include "hardware/SdkCallTracker.hpp"
+#include "hardware/util.hpp"
+#include "pros/device.h"
+#include "pros/imu.h"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <cmath>
+#include <errno.h>
 #include <mutex>
 
 namespace lemlib {
+// the limit is the size on the host the simulator runs on, which the brain, with 4 byte pointers, is always within
+static_assert(sizeof(V5InertialSensor) <= 368, "V5InertialSensor grew. Keep its small members together");
+
+namespace {
+/** the acceleration of gravity, in meters per second squared. The accelerometer measures in multiples of it */
+constexpr double STANDARD_GRAVITY = 9.80665;
+} // namespace
+
 V5InertialSensor::V5InertialSensor(SmartPort port, Number scalar)
     : IMU(scalar),
-      m_imu(port) {}
+      m_port(port),
+      m_claim(m_port, pros::c::E_DEVICE_IMU) {}
 
 V5InertialSensor::V5InertialSensor(const V5InertialSensor& other)
     : IMU(other.getGyroScalar()),
-      m_imu(other.m_imu),
-      m_offset(other.m_offset) {}
+      m_offset(other.m_offset.load(std::memory_order_acquire)),
+      m_port(other.m_port),
+      m_claim(other.m_claim),
+      m_readoutPeriod(other.m_readoutPeriod.load()),
+      m_dataRate(other.m_dataRate.load()) {}
 
+V5InertialSensor::~V5InertialSensor() { stopRateIntegration(); }
+
+#ifndef LEMLIB_SIM
 V5InertialSensor V5InertialSensor::from_pros_imu(pros::IMU imu, Number scalar) {
     return V5InertialSensor({imu.get_port(), runtime_check_port}, scalar);
 }
 
+std::vector<V5InertialSensor> V5InertialSensor::from_pros_imus(std::span<const pros::Imu> imus, Number scalar) {
+    std::vector<V5InertialSensor> result;
+    result.reserve(imus.size());
+    for (const pros::Imu& imu : imus) result.emplace_back(SmartPort {imu.get_port(), runtime_check_port}, scalar);
+    return result;
+}
+#endif
+
 int32_t V5InertialSensor::calibrate() {
     std::lock_guard lock(m_mutex);
-    m_offset = 0_stRot;
-    return m_imu.reset();
+    LEMLIB_BOOT_EVENT("start imu calibration", m_port);
+    m_offset.store(0_stRot, std::memory_order_release);
+    // the integrated rotation is reset too, once the sensor can be read again
+    m_resetRequested.store(true, std::memory_order_release);
+    return convertStatus(LEMLIB_SDK_CALL(m_port, pros::c::imu_reset(m_port)));
 }
 
-int32_t V5InertialSensor::isCalibrated() const { return !m_imu.is_calibrating(); }
+int32_t V5InertialSensor::isCalibrated() const {
+    const pros::imu_status_e_t status = LEMLIB_SDK_CALL(m_port, pros::c::imu_get_status(m_port));
+    // any failure is interpreted as the IMU not being calibrated
+    if (status == pros::E_IMU_STATUS_ERROR) return false;
+    return !(status & pros::E_IMU_STATUS_CALIBRATING);
+}
 
-int32_t V5InertialSensor::isCalibrating() const { return m_imu.is_calibrating(); }
+int32_t V5InertialSensor::isCalibrating() const {
+    const pros::imu_status_e_t status = LEMLIB_SDK_CALL(m_port, pros::c::imu_get_status(m_port));
+    // any failure is interpreted as the IMU not calibrating
+    if (status == pros::E_IMU_STATUS_ERROR) return false;
+    return (status & pros::E_IMU_STATUS_CALIBRATING) != 0;
+}
 
-int32_t V5InertialSensor::isConnected() const { return m_imu.is_installed(); }
+int32_t V5InertialSensor::isConnected() const {
+    return DeviceRegistry::get().isPlugged(m_port, pros::c::E_DEVICE_IMU);
+}
+
+double V5InertialSensor::readRotation() const {
+    if (!m_integrating.load(std::memory_order_acquire)) {
+        return LEMLIB_SDK_CALL(m_port, pros::c::imu_get_rotation(m_port));
+    }
+    const RateSample sample = m_rateSample.read();
+    if (!sample.valid) {
+        errno = EAGAIN;
+        return INFINITY;
+    }
+    return sample.rotation;
+}
 
 Angle V5InertialSensor::getRotation() const {
-    std::lock_guard lock(m_mutex);
-    const double result = m_imu.get_rotation();
-    // check for errors
-    if (result == INFINITY) return from_stDeg(INFINITY);
-    return from_cDeg(result * m_gyroScalar) + m_offset;
+    LEMLIB_PROBE("V5InertialSensor::getRotation");
+    return tryGetRotation().orSentinel(from_stDeg(INFINITY));
+}
+
+Result<Angle> V5InertialSensor::tryGetRotation() const {
+    // the gyro scalar and offset are atomic, so reading the rotation never waits for a task changing them
+    const double result = readRotation();
+    // the SDK reports errors as INFINITY, so this is the only place the rotation is compared with it
+    if (result == INFINITY) [[unlikely]]
+        return Result<Angle>::failure(errno);
+    return from_cDeg(result * m_gyroScalar.load(std::memory_order_acquire)) +
+           m_offset.load(std::memory_order_acquire);
 }
 
 int32_t V5InertialSensor::setRotation(Angle rotation) {
     std::lock_guard lock(m_mutex);
-    Angle raw = this->getRotation();
-    if (to_stRot(raw) == INFINITY) return INT32_MAX;
+    const double result = readRotation();
+    if (result == INFINITY) return INT32_MAX;
     else {
-        m_offset = rotation - raw;
+        const Angle offset = rotation - from_cDeg(result * m_gyroScalar.load(std::memory_order_acquire));
+        m_offset.store(offset, std::memory_order_release);
         return 0;
     }
 }
+
+int32_t V5InertialSensor::startRateIntegration(RateIntegrationSettings settings, uint32_t priority) {
+    std::lock_guard lock(m_mutex);
+    if (m_integrating.load() || !m_taskExited.load()) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    m_integrator = RateIntegrator {.settings = settings};
+    m_resetRequested = false;
+    // read the sensor once before the rotation is switched over, so there is a sample to read straight away
+    integrateRate();
+    m_integrating = true;
+    m_taskExited = false;
+    LEMLIB_BOOT_EVENT("create lemlib imu integration task", 0);
+    const pros::task_t task =
+        pros::c::task_create(rateTaskFunction, this, priority, TASK_STACK_DEPTH_DEFAULT, "lemlib imu integration");
+    if (task == nullptr) {
+        m_integrating = false;
+        m_taskExited = true;
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+void V5InertialSensor::stopRateIntegration() {
+    m_integrating = false;
+    // wait for the task to finish its current reading, so the sensor can be safely destroyed afterwards
+    while (!m_taskExited.load()) pros::c::delay(1);
+}
+
+int32_t V5InertialSensor::isIntegratingRate() const { return m_integrating.load(std::memory_order_acquire); }
+
+AngularVelocity V5InertialSensor::getRate() const {
+    const Number scalar = m_gyroScalar.load(std::memory_order_acquire);
+    // PROS measures rotation clockwise positive, so the rate is negated
+    if (m_integrating.load(std::memory_order_acquire)) {
+        const RateSample sample = m_rateSample.read();
+        if (!sample.valid) {
+            errno = EAGAIN;
+            return from_radps(INFINITY);
+        }
+        return -from_degps(sample.rate * scalar);
+    }
+    const double rate = LEMLIB_SDK_CALL(m_port, pros::c::imu_get_gyro_rate(m_port)).z;
+    if (rate == INFINITY) return from_radps(INFINITY);
+    return -from_degps(rate * scalar);
+}
+
+GyroState V5InertialSensor::getGyroState() const {
+    if (!m_integrating.load(std::memory_order_acquire)) {
+        errno = EINVAL;
+        return {};
+    }
+    const RateSample sample = m_rateSample.read();
+    const Number scalar = m_gyroScalar.load(std::memory_order_acquire);
+    GyroState state;
+    state.timestamp = sample.timestamp;
+    state.bias = -from_degps(sample.bias);
+    state.stationary = sample.stationary;
+    if (!sample.valid) {
+        errno = EAGAIN;
+        return state;
+    }
+    state.rotation = from_cDeg(sample.rotation * scalar) + m_offset.load(std::memory_order_acquire);
+    state.rate = -from_degps(sample.rate * scalar);
+    const AngularVelocity unit = from_degps(scalar.internal());
+    state.rateVariance = unit * unit * sample.rateVariance;
+    return state;
+}
+
+IMUReadout V5InertialSensor::getReadout() const {
+    std::lock_guard lock(m_mutex);
+    const uint32_t now = pros::c::millis();
+    if (m_readoutRead && now - m_readoutTime < m_readoutPeriod.load(std::memory_order_relaxed)) {
+        if (m_readoutError != 0) errno = m_readoutError;
+        return m_readout;
+    }
+    // every channel is read back to back, so they describe the same moment. errno is cleared first, so an error of
+    // any channel can be kept for the copies of the readout
+    errno = 0;
+    const pros::imu_accel_s_t acceleration = LEMLIB_SDK_CALL(m_port, pros::c::imu_get_accel(m_port));
+    const pros::imu_gyro_s_t rates = LEMLIB_SDK_CALL(m_port, pros::c::imu_get_gyro_rate(m_port));
+    const pros::euler_s_t orientation = LEMLIB_SDK_CALL(m_port, pros::c::imu_get_euler(m_port));
+    const int error = errno;
+    IMUReadout readout;
+    readout.timestamp = from_usec(pros::c::micros());
+    // check for errors
+    if (acceleration.x != INFINITY) {
+        readout.acceleration = units::Vector3D<LinearAcceleration>(from_mps2(acceleration.x * STANDARD_GRAVITY),
+                                                                   from_mps2(acceleration.y * STANDARD_GRAVITY),
+                                                                   from_mps2(acceleration.z * STANDARD_GRAVITY));
+    }
+    if (rates.x != INFINITY) {
+        readout.gyroRates =
+            units::Vector3D<AngularVelocity>(from_degps(rates.x), from_degps(rates.y), from_degps(rates.z));
+    }
+    if (orientation.pitch != INFINITY) {
+        readout.orientation = units::Vector3D<Angle>(from_stDeg(orientation.roll), from_stDeg(orientation.pitch),
+                                                     from_stDeg(orientation.yaw));
+    }
+    m_readout = readout;
+    m_readoutError = error;
+    m_readoutRead = true;
+    m_readoutTime = now;
+    return readout;
+}
+
+units::Vector3D<LinearAcceleration> V5InertialSensor::getAcceleration() const { return getReadout().acceleration; }
+
+units::Vector3D<AngularVelocity> V5InertialSensor::getGyroRates() const { return getReadout().gyroRates; }
+
+units::Vector3D<Angle> V5InertialSensor::getOrientation() const { return getReadout().orientation; }
+
+int32_t V5InertialSensor::setReadoutPeriod(Time period) {
+    m_readoutPeriod = std::max(0.0, std::round(to_msec(period)));
+    return 0;
+}
+
+Time V5InertialSensor::getReadoutPeriod() const { return from_msec(m_readoutPeriod.load()); }
+
+int32_t V5InertialSensor::setDataRate(Time rate) {
+    // written so NaN fails the comparison
+    if (!(rate >= MIN_DATA_RATE) || rate == from_sec(INFINITY)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    const uint32_t milliseconds = std::floor(to_msec(rate));
+    if (LEMLIB_SDK_CALL(m_port, pros::c::imu_set_data_rate(m_port, milliseconds)) == INT_MAX) return INT_MAX;
+    m_dataRate = milliseconds - milliseconds % 5;
+    // a readout kept for longer than the data rate would hide updates
+    m_readoutPeriod = m_dataRate.load();
+    return 0;
+}
+
+Time V5InertialSensor::getDataRate() const { return from_msec(m_dataRate.load()); }
+
+void V5InertialSensor::integrateRate() {
+    RateIntegrator& integrator = m_integrator;
+    const RateIntegrationSettings& settings = integrator.settings;
+    const Time now = from_usec(pros::c::micros());
+    // calibrating zeroes the sensor, so the integration starts again from 0, with no bias
+    if (m_resetRequested.exchange(false, std::memory_order_acq_rel)) {
+        integrator.initialized = false;
+        integrator.synced = true;
+        integrator.rotation.reset();
+        integrator.bias = 0;
+    }
+    const double rate = LEMLIB_SDK_CALL(m_port, pros::c::imu_get_gyro_rate(m_port)).z;
+    if (rate == INFINITY) {
+        // the sensor is calibrating or disconnected. The rotation is kept, but time spent without readings is not
+        // integrated
+        integrator.initialized = false;
+        RateSample sample = m_rateSample.read();
+        sample.valid = false;
+        m_rateSample.write(sample);
+        return;
+    }
+    if (!integrator.initialized) {
+        // start from the rotation the sensor measured itself, so switching modes doesn't make the rotation jump
+        if (!integrator.synced) {
+            const double rotation = LEMLIB_SDK_CALL(m_port, pros::c::imu_get_rotation(m_port));
+            if (rotation == INFINITY) return;
+            integrator.rotation.reset(Number(rotation));
+            integrator.synced = true;
+        }
+        integrator.initialized = true;
+        integrator.lastTimestamp = now;
+        integrator.lastRate = rate - integrator.bias;
+        integrator.mean = rate;
+        integrator.variance = 0;
+        integrator.stationaryFor = 0_sec;
+    } else {
+        const Time dt = now - integrator.lastTimestamp;
+        integrator.lastTimestamp = now;
+        const double seconds = to_sec(dt);
+        // exponentially weighted mean and variance of the measured rate
+        const double noiseGain = seconds / (to_sec(settings.noiseTimeConstant) + seconds);
+        const double deviation = rate - integrator.mean;
+        integrator.mean += noiseGain * deviation;
+        integrator.variance = (1 - noiseGain) * (integrator.variance + noiseGain * deviation * deviation);
+        // the sensor is only assumed to be stationary once the rate has been small for a while, so slow turns don't
+        // become part of the bias
+        if (std::abs(rate - integrator.bias) < to_degps(settings.stationaryThreshold)) integrator.stationaryFor += dt;
+        else integrator.stationaryFor = 0_sec;
+        if (integrator.stationaryFor >= settings.stationaryTime) {
+            const double biasGain = seconds / (to_sec(settings.biasTimeConstant) + seconds);
+            integrator.bias += biasGain * (rate - integrator.bias);
+        }
+        // trapezoidal integration of the bias corrected rate
+        const double corrected = rate - integrator.bias;
+        integrator.rotation += Number((corrected + integrator.lastRate) / 2 * seconds);
+        integrator.lastRate = corrected;
+    }
+    m_rateSample.write({.timestamp = now,
+                        .rotation = integrator.rotation.value().internal(),
+                        .rate = integrator.lastRate,
+                        .rateVariance = integrator.variance,
+                        .bias = integrator.bias,
+                        .stationary = integrator.stationaryFor >= settings.stationaryTime,
+                        .valid = true});
+}
+
+void V5InertialSensor::rateTaskFunction(void* imu) {
+    V5InertialSensor& self = *static_cast<V5InertialSensor*>(imu);
+    const uint32_t period = std::max(1.0, std::round(to_msec(self.m_integrator.settings.period)));
+    uint32_t now = pros::c::millis();
+    while (self.m_integrating.load()) {
+        self.integrateRate();
+        pros::c::task_delay_until(&now, period);
+    }
+    // PROS deletes the task once this function returns
+    self.m_taskExited = true;
+}
 } // namespace lemlib
\ No newline at end of file
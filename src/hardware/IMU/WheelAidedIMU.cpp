@@ -0,0 +1,152 @@
+#include "hardware/IMU/WheelAidedIMU.hpp"
+#include "pros/rtos.h"
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+// how far off the drift of the IMU is expected to be before it has been measured, in radians per second. The V5
+// Inertial Sensor typically drifts by about a degree per minute
+constexpr double INITIAL_DRIFT_DEVIATION = 0.05 * M_PI / 180;
+// the wheels measure the heading, which is the first element of the state
+constexpr units::Matrix<Number, 1, 2> MEASUREMENT(1, 0);
+
+WheelAidedIMU::WheelAidedIMU(IMU& imu, Encoder& wheelHeading, WheelAidedIMUSettings settings)
+    : IMU(imu.getGyroScalar()),
+      m_imu(imu),
+      m_wheelHeading(wheelHeading),
+      m_settings(settings) {}
+
+WheelAidedIMU::WheelAidedIMU(const WheelAidedIMU& other)
+    : IMU(other.getGyroScalar()),
+      m_imu(other.m_imu),
+      m_wheelHeading(other.m_wheelHeading),
+      m_settings(other.getSettings()) {}
+
+int32_t WheelAidedIMU::calibrate() {
+    std::lock_guard lock(m_mutex);
+    // the rotation of the IMU starts over, and so does its drift
+    m_started = false;
+    return m_imu.calibrate();
+}
+
+int32_t WheelAidedIMU::isCalibrated() const { return m_imu.isCalibrated(); }
+
+int32_t WheelAidedIMU::isCalibrating() const { return m_imu.isCalibrating(); }
+
+int32_t WheelAidedIMU::isConnected() const { return m_imu.isConnected() == 1 || m_wheelHeading.isConnected() == 1; }
+
+void WheelAidedIMU::restart(double rotation, double imu, double wheels, double time, bool keepDrift) const {
+    m_heading = rotation;
+    // the heading is exactly what it was set to, but nothing is known about how it correlates with the drift
+    if (!keepDrift || !m_started) {
+        m_drift = 0;
+        m_covariance = units::SquareMatrix<Number, 2>(0, 0, 0, INITIAL_DRIFT_DEVIATION * INITIAL_DRIFT_DEVIATION);
+    } else {
+        m_covariance = units::SquareMatrix<Number, 2>(0, 0, 0, m_covariance(1, 1));
+    }
+    m_lastIMU = imu;
+    m_lastTime = time;
+    m_wheelsAnchored = std::isfinite(wheels);
+    if (m_wheelsAnchored) m_wheelOffset = rotation - wheels;
+    m_started = true;
+}
+
+Angle WheelAidedIMU::getRotation() const {
+    std::lock_guard lock(m_mutex);
+    // read both sources back to back, so they measure the same moment
+    const Angle imuAngle = m_imu.getRotation();
+    const Angle wheelAngle = m_wheelHeading.getAngle();
+    const double time = pros::c::micros() / 1e6;
+    const double imu = imuAngle.internal() == INFINITY ? INFINITY : to_stRad(imuAngle);
+    const double wheels = wheelAngle.internal() == INFINITY ? INFINITY : to_stRad(wheelAngle);
+    if (!std::isfinite(imu) && !std::isfinite(wheels)) {
+        errno = ENODEV;
+        return from_stRad(INFINITY);
+    }
+    if (!m_started) {
+        restart(std::isfinite(imu) ? imu : wheels, imu, wheels, time, false);
+        return from_stRad(m_heading);
+    }
+    const double dt = std::max(time - m_lastTime, 0.0);
+    m_lastTime = time;
+    // predict: the heading moves with the IMU, minus its drift, and both become less certain over time
+    const double gyroVariance = std::pow(to_stRad(m_settings.gyroNoise), 2);
+    const double driftVariance = std::pow(to_radps(m_settings.driftNoise), 2);
+    if (std::isfinite(imu) && std::isfinite(m_lastIMU)) {
+        m_heading += (imu - m_lastIMU) - m_drift * dt;
+        const units::SquareMatrix<Number, 2> transition(1, -dt, 0, 1);
+        const units::SquareMatrix<Number, 2> noise(gyroVariance * dt, 0, 0, driftVariance * dt);
+        m_covariance = transition * m_covariance * transition.transpose() + noise;
+    }
+    m_lastIMU = imu;
+    // correct: the wheels measure the heading directly
+    if (!std::isfinite(wheels)) {
+        // the wheels may have been reset while they couldn't be read
+        m_wheelsAnchored = false;
+    } else if (!m_wheelsAnchored) {
+        m_wheelOffset = m_heading - wheels;
+        m_wheelsAnchored = true;
+    } else if (!std::isfinite(imu)) {
+        // without the IMU, the wheels are all there is
+        m_heading = wheels + m_wheelOffset;
+    } else {
+        const double innovation = wheels + m_wheelOffset - m_heading;
+        const double innovationVariance =
+            (MEASUREMENT * m_covariance * MEASUREMENT.transpose())(0, 0).internal() +
+            std::pow(to_stRad(m_settings.wheelNoise), 2);
+        if (innovation * innovation > std::pow(m_settings.slipThreshold, 2) * innovationVariance) {
+            // the wheels slipped, so they are measured from the heading of the filter from now on
+            m_wheelOffset -= innovation;
+            m_slips++;
+        } else {
+            const units::ColumnVector<Number, 2> gain = m_covariance * MEASUREMENT.transpose() / innovationVariance;
+            m_heading += gain[0].internal() * innovation;
+            m_drift += gain[1].internal() * innovation;
+            m_covariance = (units::SquareMatrix<Number, 2>::identity() - gain * MEASUREMENT) * m_covariance;
+        }
+    }
+    return from_stRad(m_heading);
+}
+
+int32_t WheelAidedIMU::setRotation(Angle rotation) {
+    std::lock_guard lock(m_mutex);
+    const Angle imuAngle = m_imu.getRotation();
+    const Angle wheelAngle = m_wheelHeading.getAngle();
+    if (imuAngle.internal() == INFINITY && wheelAngle.internal() == INFINITY) {
+        errno = ENODEV;
+        return INT_MAX;
+    }
+    restart(to_stRad(rotation), imuAngle.internal() == INFINITY ? INFINITY : to_stRad(imuAngle),
+            wheelAngle.internal() == INFINITY ? INFINITY : to_stRad(wheelAngle), pros::c::micros() / 1e6, true);
+    return 0;
+}
+
+int32_t WheelAidedIMU::setGyroScalar(Number scalar) {
+    std::lock_guard lock(m_mutex);
+    IMU::setGyroScalar(scalar);
+    return m_imu.setGyroScalar(scalar);
+}
+
+int32_t WheelAidedIMU::setSettings(WheelAidedIMUSettings settings) {
+    std::lock_guard lock(m_mutex);
+    m_settings = settings;
+    return 0;
+}
+
+WheelAidedIMUSettings WheelAidedIMU::getSettings() const {
+    std::lock_guard lock(m_mutex);
+    return m_settings;
+}
+
+AngularVelocity WheelAidedIMU::getDrift() const {
+    std::lock_guard lock(m_mutex);
+    return from_radps(m_drift);
+}
+
+int32_t WheelAidedIMU::getSlipCount() const {
+    std::lock_guard lock(m_mutex);
+    return m_slips;
+}
+} // namespace lemlib
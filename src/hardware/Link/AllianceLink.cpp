@@ -0,0 +1,175 @@
+#include "hardware/Link/AllianceLink.hpp"
+#include "hardware/AllocationTracker.hpp"
+#include "hardware/BootTrace.hpp"
+#include "hardware/SdkCallTracker.hpp"
+#include "pros/error.h"
+#include "pros/link.h"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <limits>
+
+namespace lemlib {
+namespace {
+// the resolution of a position, in meters
+constexpr double POSITION_RESOLUTION = 1e-3;
+// a position which isn't known
+constexpr int16_t UNKNOWN = std::numeric_limits<int16_t>::min();
+
+/**
+ * @brief Round a coordinate of a position to a millimeter
+ *
+ * @param value the coordinate, in meters
+ * @return int16_t the coordinate in millimeters, clamped to the range where it isn't UNKNOWN
+ */
+int16_t toMillimeters(double value) {
+    return std::clamp(std::round(value / POSITION_RESOLUTION), UNKNOWN + 1.0, double(INT16_MAX));
+}
+
+/**
+ * @brief Convert a rounded coordinate back into meters
+ *
+ * @param value the coordinate in millimeters
+ * @return double the coordinate in meters, or INFINITY if it is UNKNOWN
+ */
+double fromMillimeters(int16_t value) { return value == UNKNOWN ? INFINITY : value * POSITION_RESOLUTION; }
+} // namespace
+
+PoseRecord encodePose(const units::Pose& pose) {
+    const double theta = to_stRot(pose.orientation);
+    if (!std::isfinite(to_m(pose.x)) || !std::isfinite(to_m(pose.y)) || !std::isfinite(theta)) {
+        return {.x = UNKNOWN, .y = UNKNOWN, .theta = 0};
+    }
+    // the orientation wraps around, so a whole turn is 65536, which is 0
+    const double fraction = theta - std::floor(theta);
+    return {.x = toMillimeters(to_m(pose.x)),
+            .y = toMillimeters(to_m(pose.y)),
+            .theta = uint16_t(uint32_t(std::round(fraction * 65536)))};
+}
+
+units::Pose decodePoseRecord(const PoseRecord& record) {
+    if (record.x == UNKNOWN) return units::Pose(from_m(INFINITY), from_m(INFINITY), from_stRad(INFINITY));
+    return units::Pose(from_m(record.x * POSITION_RESOLUTION), from_m(record.y * POSITION_RESOLUTION),
+                       from_stRot(record.theta / 65536.0));
+}
+
+AllianceLink::AllianceLink(uint8_t port, const char* id, bool transmitter, const Topic<units::Pose>& pose)
+    : m_port(port),
+      m_id(id),
+      m_transmitter(transmitter),
+      m_pose(pose) {}
+
+AllianceLink::~AllianceLink() { stop(); }
+
+void AllianceLink::setIntent(const AllianceIntent& intent) { m_intent.publish(intent); }
+
+const Topic<PartnerState>& AllianceLink::getPartnerTopic() const { return m_partner; }
+
+bool AllianceLink::isConnected() const { return LEMLIB_SDK_CALL(m_port, pros::c::link_connected(m_port)); }
+
+uint32_t AllianceLink::getLost() const { return m_lost.load(); }
+
+void AllianceLink::receive() {
+    Message message;
+    Message latest;
+    bool received = false;
+    // a few messages can pile up when the task is delayed. Only the latest one is published, and the loop is bounded
+    // so a flood of corrupt bytes can't hold the task
+    for (int i = 0; i < 8; i++) {
+        const uint32_t size = LEMLIB_SDK_CALL(m_port, pros::c::link_receive(m_port, &message, sizeof(message)));
+        // nothing more has arrived, or the radio can't be read
+        if (size == 0 || (size == PROS_ERR && errno != EBADMSG)) break;
+        // a message which can't be decoded is counted by the gap it leaves in the sequence numbers
+        if (size != sizeof(message) || message.version != FORMAT_VERSION) continue;
+        // the sequence numbers wrap around, so the gap is counted modulo 256
+        if (m_received) m_lost += uint8_t(message.sequence - m_lastReceived - 1);
+        m_lastReceived = message.sequence;
+        m_received = true;
+        received = true;
+        latest = message;
+    }
+    if (!received) return;
+    m_partner.publish({.pose = decodePoseRecord(latest.pose),
+                       .intent = {.code = latest.code,
+                                  .target = units::V2Position(from_m(fromMillimeters(latest.targetX)),
+                                                              from_m(fromMillimeters(latest.targetY)))},
+                       .timestamp = uint32_t(pros::c::micros())});
+}
+
+int32_t AllianceLink::update() {
+    LEMLIB_ALLOCATION_FREE("AllianceLink::update");
+    receive();
+    const AllianceIntent intent = m_intent.read();
+    const bool hasTarget = std::isfinite(to_m(intent.target.x)) && std::isfinite(to_m(intent.target.y));
+    Message message = {.version = FORMAT_VERSION,
+                       .sequence = m_sequence,
+                       .code = intent.code,
+                       .pose = encodePose(m_pose.read()),
+                       .targetX = hasTarget ? toMillimeters(to_m(intent.target.x)) : UNKNOWN,
+                       .targetY = hasTarget ? toMillimeters(to_m(intent.target.y)) : UNKNOWN};
+    // the link is checked first, so a full buffer drops the message instead of waiting for room
+    const uint32_t room = LEMLIB_SDK_CALL(m_port, pros::c::link_raw_transmittable_size(m_port));
+    // link_raw_transmittable_size has already set errno
+    if (room == PROS_ERR) return INT_MAX;
+    if (room < sizeof(message) + PROTOCOL_SIZE) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    // link_transmit has already set errno
+    if (LEMLIB_SDK_CALL(m_port, pros::c::link_transmit(m_port, &message, sizeof(message))) == PROS_ERR) {
+        return INT_MAX;
+    }
+    m_sequence++;
+    return 0;
+}
+
+int32_t AllianceLink::start(Time period, uint32_t priority) {
+    // the transmitter sends 1040 bytes per second, and the receiver 520
+    const double bandwidth = m_transmitter ? 1040 : 520;
+    // written so NaN fails the comparison
+    if (!((MESSAGE_SIZE + PROTOCOL_SIZE) / to_sec(period) <= bandwidth)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    if (m_running.load() || !m_taskExited.load()) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    const pros::link_type_e_t type = m_transmitter ? pros::E_LINK_TRANSMITTER : pros::E_LINK_RECIEVER;
+    // link_init has already set errno
+    if (LEMLIB_SDK_CALL(m_port, pros::c::link_init(m_port, m_id, type)) == PROS_ERR) return INT_MAX;
+    m_period = period;
+    m_running = true;
+    m_taskExited = false;
+    LEMLIB_BOOT_EVENT("create lemlib alliance link task", 0);
+    const pros::task_t task =
+        pros::c::task_create(taskFunction, this, priority, TASK_STACK_DEPTH_DEFAULT, "lemlib alliance link");
+    if (task == nullptr) {
+        m_running = false;
+        m_taskExited = true;
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+void AllianceLink::stop() {
+    m_running = false;
+    // wait for the task to finish its current update, so the link can be safely destroyed afterwards
+    while (!m_taskExited.load()) pros::c::delay(1);
+}
+
+void AllianceLink::taskFunction(void* link) {
+    AllianceLink& self = *static_cast<AllianceLink*>(link);
+    const uint32_t period = std::max(1.0, std::round(to_msec(self.m_period)));
+    uint32_t now = pros::c::millis();
+    while (self.m_running.load()) {
+        self.update();
+        pros::c::task_delay_until(&now, period);
+    }
+    // PROS deletes the task once this function returns
+    self.m_taskExited = true;
+}
+} // namespace lemlib
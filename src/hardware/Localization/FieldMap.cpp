@@ -0,0 +1,61 @@
+#include "hardware/Localization/FieldMap.hpp"
+#include <cmath>
+
+namespace lemlib {
+FieldMap::FieldMap(units::V2Position min, units::V2Position max, std::span<const FieldObstacle> obstacles,
+                   Length resolution)
+    : m_minX(to_m(min.x)),
+      m_minY(to_m(min.y)),
+      m_inverseResolution(1 / to_m(resolution)),
+      m_columns(std::max(1.0, std::ceil(to_m(max.x - min.x) / to_m(resolution)))),
+      m_rows(std::max(1.0, std::ceil(to_m(max.y - min.y) / to_m(resolution)))),
+      m_cells(size_t(m_columns) * m_rows) {
+    const double cell = to_m(resolution);
+    // the distance from the center of a cell to its corners, so steps are safe from anywhere in the cell
+    const double margin = cell * std::sqrt(0.5);
+    for (int32_t row = 0; row < m_rows; row++) {
+        for (int32_t column = 0; column < m_columns; column++) {
+            const double x = to_m(min.x) + (column + 0.5) * cell;
+            const double y = to_m(min.y) + (row + 0.5) * cell;
+            // the walls along the edges of the field
+            double distance = std::min({x - to_m(min.x), to_m(max.x) - x, y - to_m(min.y), to_m(max.y) - y});
+            for (const FieldObstacle& obstacle : obstacles) {
+                // the distance to a rectangle, which is 0 inside it
+                const double outsideX = std::max({to_m(obstacle.min.x) - x, 0.0, x - to_m(obstacle.max.x)});
+                const double outsideY = std::max({to_m(obstacle.min.y) - y, 0.0, y - to_m(obstacle.max.y)});
+                distance = std::min(distance, std::hypot(outsideX, outsideY));
+            }
+            m_cells[size_t(row) * m_columns + column] = std::max(0.0, distance - margin);
+        }
+    }
+}
+
+Length FieldMap::getDistance(units::V2Position point) const { return from_m(lookup(to_m(point.x), to_m(point.y))); }
+
+Length FieldMap::castRay(units::V2Position origin, Angle direction, Length maxRange) const {
+    const float x = to_m(origin.x);
+    const float y = to_m(origin.y);
+    const float dx = std::cos(to_stRad(direction));
+    const float dy = std::sin(to_stRad(direction));
+    float distance;
+    castRays(&x, &y, &dx, &dy, &distance, 1, to_m(maxRange));
+    return from_m(distance);
+}
+
+void FieldMap::castRays(const float* __restrict x, const float* __restrict y, const float* __restrict dx,
+                        const float* __restrict dy, float* __restrict out, size_t count, float maxRange) const {
+    // a millimeter, in meters. Beams which moved less than this have stopped at a wall
+    constexpr float CONVERGED = 0.001;
+    for (size_t i = 0; i < count; i++) out[i] = 0;
+    for (size_t step = 0; step < MAX_STEPS; step++) {
+        float longestStep = 0;
+        for (size_t i = 0; i < count; i++) {
+            const float distance = lookup(x[i] + out[i] * dx[i], y[i] + out[i] * dy[i]);
+            const float next = std::min(out[i] + distance, maxRange);
+            longestStep = std::max(longestStep, next - out[i]);
+            out[i] = next;
+        }
+        if (longestStep < CONVERGED) break;
+    }
+}
+} // namespace lemlib
@@ -0,0 +1,268 @@
+#include "hardware/Localization/ParticleFilter.hpp"
+#include "hardware/AllocationTracker.hpp"
+#include "hardware/BootTrace.hpp"
+#include "hardware/Probe.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <mutex>
+#include <utility>
+
+namespace lemlib {
+namespace {
+/** errors are counted as at most this many standard deviations, so a robot blocking a sensor can't wipe out the
+ * particles which are right */
+constexpr float MAX_SIGMAS = 3;
+/** the V5 Distance Sensor only reports its confidence for objects further away than this, in meters */
+constexpr float CONFIDENCE_RANGE = 0.2;
+} // namespace
+
+ParticleFilterBase::ParticleFilterBase(Odometry& odometry, const FieldMap& field, float* storage, size_t count,
+                                       const ParticleFilterSettings& settings)
+    : m_odometry(odometry),
+      m_field(field),
+      m_count(count),
+      m_settings(settings),
+      m_x(storage),
+      m_y(storage + count),
+      m_theta(storage + 2 * count),
+      m_nextX(storage + 3 * count),
+      m_nextY(storage + 4 * count),
+      m_nextTheta(storage + 5 * count),
+      m_weight(storage + 6 * count),
+      m_logLikelihood(storage + 7 * count),
+      m_beamX(storage + 8 * count),
+      m_beamY(storage + 9 * count),
+      m_beamDx(storage + 10 * count),
+      m_beamDy(storage + 11 * count) {}
+
+ParticleFilterBase::~ParticleFilterBase() { stop(); }
+
+int32_t ParticleFilterBase::addSensor(DistanceSensor& sensor, units::Pose offset) {
+    std::lock_guard lock(m_mutex);
+    if (m_sensorCount == MAX_SENSORS) {
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    m_sensors[m_sensorCount++] = {.sensor = &sensor,
+                                  .x = float(to_m(offset.x)),
+                                  .y = float(to_m(offset.y)),
+                                  .cos = float(std::cos(to_stRad(offset.orientation))),
+                                  .sin = float(std::sin(to_stRad(offset.orientation)))};
+    return 0;
+}
+
+void ParticleFilterBase::setPose(units::Pose pose, Length spread, Angle angularSpread) {
+    std::lock_guard lock(m_mutex);
+    const float x = to_m(pose.x);
+    const float y = to_m(pose.y);
+    const float theta = to_stRad(pose.orientation);
+    const float positionSigma = to_m(spread);
+    const float angleSigma = to_stRad(angularSpread);
+    for (size_t i = 0; i < m_count; i++) {
+        m_x[i] = x + positionSigma * gaussian();
+        m_y[i] = y + positionSigma * gaussian();
+        m_theta[i] = theta + angleSigma * gaussian();
+        m_weight[i] = 1.0f / m_count;
+    }
+    m_lastOdometry = m_odometry.getPose();
+    m_hasLastOdometry = true;
+    m_estimate.write(pose);
+}
+
+units::Pose ParticleFilterBase::getPose() const { return m_estimate.read(); }
+
+size_t ParticleFilterBase::getParticleCount() const { return m_count; }
+
+float ParticleFilterBase::uniform() {
+    // xorshift32, which is fast and good enough to add noise
+    m_random ^= m_random << 13;
+    m_random ^= m_random >> 17;
+    m_random ^= m_random << 5;
+    // the top 24 bits fit in a float exactly
+    return (m_random >> 8) * (1.0f / (1 << 24));
+}
+
+float ParticleFilterBase::gaussian() {
+    // the sum of 4 uniform numbers is close to normal, with a variance of 1/3
+    return (uniform() + uniform() + uniform() + uniform() - 2) * 1.7320508f;
+}
+
+void ParticleFilterBase::predict(const units::Pose& motion) {
+    const float dx = to_m(motion.x);
+    const float dy = to_m(motion.y);
+    const float dtheta = to_stRad(motion.orientation);
+    const float translationSigma =
+        m_settings.translationNoise.internal() * std::hypot(dx, dy) + to_m(m_settings.minTranslationNoise);
+    const float rotationSigma =
+        m_settings.rotationNoise.internal() * std::abs(dtheta) + to_stRad(m_settings.minRotationNoise);
+    for (size_t i = 0; i < m_count; i++) {
+        // the motion is measured relative to the robot, so it is rotated into the frame of every particle
+        const float forward = dx + translationSigma * gaussian();
+        const float left = dy + translationSigma * gaussian();
+        const float c = std::cos(m_theta[i]);
+        const float s = std::sin(m_theta[i]);
+        m_x[i] += c * forward - s * left;
+        m_y[i] += s * forward + c * left;
+        m_theta[i] += dtheta + rotationSigma * gaussian();
+    }
+}
+
+void ParticleFilterBase::weigh(const Sensor& sensor, float reading) {
+    // filled in by update, and only overwritten by resample
+    const float* __restrict c = m_nextX;
+    const float* __restrict s = m_nextY;
+    float* __restrict expected = m_nextTheta;
+    const float* __restrict x = m_x;
+    const float* __restrict y = m_y;
+    float* __restrict beamX = m_beamX;
+    float* __restrict beamY = m_beamY;
+    float* __restrict beamDx = m_beamDx;
+    float* __restrict beamDy = m_beamDy;
+    float* __restrict logLikelihood = m_logLikelihood;
+    // the sensor is transformed into the frame of every particle
+    for (size_t i = 0; i < m_count; i++) {
+        beamX[i] = x[i] + c[i] * sensor.x - s[i] * sensor.y;
+        beamY[i] = y[i] + s[i] * sensor.x + c[i] * sensor.y;
+        beamDx[i] = c[i] * sensor.cos - s[i] * sensor.sin;
+        beamDy[i] = s[i] * sensor.cos + c[i] * sensor.sin;
+    }
+    m_field.castRays(beamX, beamY, beamDx, beamDy, expected, m_count, to_m(MAX_RANGE));
+    const float sigma = std::max<float>(to_m(m_settings.sensorError), m_settings.sensorErrorRatio.internal() * reading);
+    const float inverseSigma = 1 / sigma;
+    for (size_t i = 0; i < m_count; i++) {
+        const float z = (expected[i] - reading) * inverseSigma;
+        logLikelihood[i] -= 0.5f * std::min(z * z, MAX_SIGMAS * MAX_SIGMAS);
+    }
+}
+
+float ParticleFilterBase::normalize() {
+    // the log likelihoods are shifted so the best is 0, so the exponentials don't underflow
+    float best = -INFINITY;
+    for (size_t i = 0; i < m_count; i++) best = std::max(best, m_logLikelihood[i]);
+    float sum = 0;
+    for (size_t i = 0; i < m_count; i++) {
+        m_weight[i] *= std::exp(m_logLikelihood[i] - best);
+        sum += m_weight[i];
+    }
+    // written so NaN fails the comparison
+    if (!(sum > 0) || sum == INFINITY) {
+        for (size_t i = 0; i < m_count; i++) m_weight[i] = 1.0f / m_count;
+        return m_count;
+    }
+    const float inverseSum = 1 / sum;
+    float sumOfSquares = 0;
+    for (size_t i = 0; i < m_count; i++) {
+        m_weight[i] *= inverseSum;
+        sumOfSquares += m_weight[i] * m_weight[i];
+    }
+    return 1 / sumOfSquares;
+}
+
+void ParticleFilterBase::resample() {
+    // one random offset, then evenly spaced picks, so every particle is drawn in proportion to its weight with less
+    // variance than independent picks
+    const float step = 1.0f / m_count;
+    float target = uniform() * step;
+    float cumulative = m_weight[0];
+    size_t source = 0;
+    for (size_t i = 0; i < m_count; i++) {
+        while (target > cumulative && source < m_count - 1) cumulative += m_weight[++source];
+        m_nextX[i] = m_x[source];
+        m_nextY[i] = m_y[source];
+        m_nextTheta[i] = m_theta[source];
+        target += step;
+    }
+    std::swap(m_x, m_nextX);
+    std::swap(m_y, m_nextY);
+    std::swap(m_theta, m_nextTheta);
+    for (size_t i = 0; i < m_count; i++) m_weight[i] = step;
+}
+
+void ParticleFilterBase::publishEstimate() {
+    const Angle reference = from_stRad(m_theta[0]);
+    double x = 0;
+    double y = 0;
+    double theta = 0;
+    for (size_t i = 0; i < m_count; i++) {
+        x += m_weight[i] * m_x[i];
+        y += m_weight[i] * m_y[i];
+        theta += m_weight[i] * to_stRad(units::angleError(from_stRad(m_theta[i]), reference));
+    }
+    m_estimate.write({from_m(x), from_m(y), reference + from_stRad(theta)});
+}
+
+int32_t ParticleFilterBase::update() {
+    LEMLIB_PROBE("ParticleFilter::update");
+    LEMLIB_ALLOCATION_FREE("ParticleFilter::update");
+    std::lock_guard lock(m_mutex);
+    const units::Pose odometry = m_odometry.getPose();
+    if (m_hasLastOdometry) predict(m_lastOdometry.inverse().compose(odometry));
+    m_lastOdometry = odometry;
+    m_hasLastOdometry = true;
+
+    // the next arrays are free until resample, so they hold the sine and cosine used by every sensor
+    for (size_t i = 0; i < m_count; i++) {
+        m_nextX[i] = std::cos(m_theta[i]);
+        m_nextY[i] = std::sin(m_theta[i]);
+        m_logLikelihood[i] = 0;
+    }
+    bool weighed = false;
+    for (size_t i = 0; i < m_sensorCount; i++) {
+        const Result<Length> distance = m_sensors[i].sensor->tryGetDistance();
+        if (!distance.ok()) continue;
+        const float reading = to_m(distance.value());
+        if (reading > CONFIDENCE_RANGE) {
+            const Number confidence = m_sensors[i].sensor->getConfidence();
+            // written so NaN fails the comparison
+            if (!(confidence >= m_settings.minConfidence) || confidence == Number(INFINITY)) continue;
+        }
+        weigh(m_sensors[i], reading);
+        weighed = true;
+    }
+    if (weighed && normalize() < m_settings.resampleThreshold.internal() * m_count) resample();
+    publishEstimate();
+    return 0;
+}
+
+int32_t ParticleFilterBase::start(Time period, uint32_t priority) {
+    std::lock_guard lock(m_mutex);
+    if (m_running.load() || !m_taskExited.load()) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    m_period = period;
+    m_running = true;
+    m_taskExited = false;
+    LEMLIB_BOOT_EVENT("create lemlib particle filter task", 0);
+    const pros::task_t task =
+        pros::c::task_create(taskFunction, this, priority, TASK_STACK_DEPTH_DEFAULT, "lemlib particle filter");
+    if (task == nullptr) {
+        m_running = false;
+        m_taskExited = true;
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+void ParticleFilterBase::stop() {
+    m_running = false;
+    // wait for the task to finish its current update, so the filter can be safely destroyed afterwards
+    while (!m_taskExited.load()) pros::c::delay(1);
+}
+
+void ParticleFilterBase::taskFunction(void* filter) {
+    ParticleFilterBase& self = *static_cast<ParticleFilterBase*>(filter);
+    const uint32_t period = std::max(1.0, std::round(to_msec(self.m_period)));
+    uint32_t now = pros::c::millis();
+    while (self.m_running.load()) {
+        self.update();
+        pros::c::task_delay_until(&now, period);
+    }
+    // PROS deletes the task once this function returns
+    self.m_taskExited = true;
+}
+} // namespace lemlib
@@ -0,0 +1,96 @@
+#include "hardware/Motion/MotionFuture.hpp"
+#include "pros/rtos.h"
+#include <cmath>
+
+namespace lemlib {
+namespace {
+// the ids which fit in a packed result, next to the 3 bits of the state
+constexpr uint32_t ID_MASK = UINT32_MAX >> 3;
+} // namespace
+
+MotionFuture MotionStatus::begin(Angle target, MotionSettings settings) {
+    cancel();
+    uint32_t id = (m_id.load(std::memory_order_relaxed) + 1) & ID_MASK;
+    // 0 means there is no motion
+    if (id == 0) id = 1;
+    m_target.write({.angle = target, .settings = settings, .id = id, .startTime = pros::c::millis()});
+    // publish the id only after the target, so update never checks the new motion against the old target
+    m_id.store(id, std::memory_order_release);
+    return MotionFuture(this, id);
+}
+
+void MotionStatus::fail(const MotionFuture& future) {
+    if (future.m_status == this) finish(future.m_id, MotionState::FAILED);
+}
+
+void MotionStatus::cancel() {
+    if (!isPending()) return;
+    finish(m_id.load(std::memory_order_acquire), MotionState::CANCELLED);
+}
+
+bool MotionStatus::isPending() const {
+    const uint32_t id = m_id.load(std::memory_order_acquire);
+    return id != 0 && (m_result.load(std::memory_order_acquire) >> 3) != id;
+}
+
+void MotionStatus::update(Angle angle) {
+    if (!isPending()) return;
+    const Target target = m_target.read();
+    // a motion was started since the id was loaded, so it is checked in the next update
+    if (target.id != m_id.load(std::memory_order_acquire)) return;
+    const uint32_t now = pros::c::millis();
+    if (target.id != m_trackedId) {
+        m_trackedId = target.id;
+        m_inTolerance = false;
+    }
+    // an angle which could not be read is never within the tolerance
+    if (units::abs(angle - target.angle) <= target.settings.tolerance) {
+        if (!m_inTolerance) m_inToleranceSince = now;
+        m_inTolerance = true;
+        if (from_msec(now - m_inToleranceSince) >= target.settings.settleTime) {
+            finish(target.id, MotionState::SETTLED);
+            return;
+        }
+    } else m_inTolerance = false;
+    if (from_msec(now - target.startTime) >= target.settings.timeout) finish(target.id, MotionState::TIMED_OUT);
+}
+
+void MotionStatus::finish(uint32_t id, MotionState state) {
+    uint32_t result = m_result.load(std::memory_order_relaxed);
+    // the first result wins, so a motion which settled can't be cancelled afterwards, or the other way around
+    while ((result >> 3) != id) {
+        if (m_result.compare_exchange_weak(result, pack(id, state), std::memory_order_release)) {
+            m_finished.notify();
+            return;
+        }
+    }
+}
+
+MotionState MotionFuture::getState() const {
+    if (m_status == nullptr) return MotionState::FAILED;
+    const uint32_t result = m_status->m_result.load(std::memory_order_acquire);
+    if ((result >> 3) == m_id) return MotionState(result & 0b111);
+    // a newer motion finished, so the result of this one is gone. It was superseded, so it was cancelled
+    if (m_status->m_id.load(std::memory_order_acquire) != m_id) return MotionState::CANCELLED;
+    return MotionState::PENDING;
+}
+
+bool MotionFuture::isDone() const { return getState() != MotionState::PENDING; }
+
+MotionState MotionFuture::wait(Time timeout) const {
+    // a future of a motion which failed to start has no status to wait on
+    if (m_status == nullptr) return MotionState::FAILED;
+    MotionState state = MotionState::PENDING;
+    m_status->m_finished.waitUntil(
+        [&] {
+            state = getState();
+            return state != MotionState::PENDING;
+        },
+        timeout);
+    return state;
+}
+
+RoutineWait MotionFuture::operator co_await() const {
+    return waitUntil([future = *this] { return future.isDone(); });
+}
+} // namespace lemlib
@@ -0,0 +1,165 @@
+#include "hardware/Motion/MotionProfile.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+
+namespace lemlib {
+namespace {
+/**
+ * @brief A part of a profile with constant jerk
+ */
+struct Phase {
+        double duration;
+        double startAcceleration;
+        double jerk;
+};
+
+/**
+ * @brief Find how long it takes to accelerate from rest to a velocity, and back down to the peak acceleration
+ *
+ * @param velocity the velocity to reach, in meters per second
+ * @param acceleration the maximum acceleration, in meters per second squared
+ * @param jerk the maximum jerk, in meters per second cubed. Can be infinite
+ * @return double the time to reach the velocity, in seconds
+ */
+double accelerationTime(double velocity, double acceleration, double jerk) {
+    // if the velocity is reached before the jerk can ramp up to the maximum acceleration, the acceleration peaks lower
+    if (velocity * jerk <= acceleration * acceleration) return 2 * std::sqrt(velocity / jerk);
+    return velocity / acceleration + acceleration / jerk;
+}
+
+/**
+ * @brief Find the highest velocity a profile over a distance can reach
+ *
+ * Accelerating to a velocity and back takes a distance which grows with the velocity, so the velocity is found by
+ * bisection. This only runs when the profile is generated.
+ *
+ * @param distance the distance of the profile, in meters
+ * @param acceleration the maximum acceleration, in meters per second squared
+ * @param jerk the maximum jerk, in meters per second cubed. Can be infinite
+ * @param velocity the maximum velocity, in meters per second
+ * @return double the peak velocity, in meters per second
+ */
+double peakVelocity(double distance, double acceleration, double jerk, double velocity) {
+    // accelerating from rest to a velocity is symmetric, so it covers the velocity times half the time it takes
+    const auto rampDistance = [&](double v) { return v * accelerationTime(v, acceleration, jerk); };
+    if (rampDistance(velocity) <= distance) return velocity;
+    double low = 0;
+    double high = velocity;
+    for (int i = 0; i < 64; i++) {
+        const double mid = (low + high) / 2;
+        if (rampDistance(mid) <= distance) low = mid;
+        else high = mid;
+    }
+    return low;
+}
+} // namespace
+
+MotionProfileBase::MotionProfileBase(ProfilePoint* storage, size_t capacity, Time step)
+    : m_storage(storage),
+      m_capacity(capacity),
+      m_step(step) {}
+
+int32_t MotionProfileBase::generate(Length distance, ProfileConstraints constraints) {
+    const double d = distance.internal();
+    const double maxV = constraints.maxVelocity.internal();
+    const double maxA = constraints.maxAcceleration.internal();
+    const double maxJ = constraints.maxJerk.internal();
+    // NaN fails every comparison, so it is caught here too
+    if (!std::isfinite(d) || !(maxV > 0) || !std::isfinite(maxV) || !(maxA > 0) || !std::isfinite(maxA) ||
+        !(maxJ > 0) || !(m_step.internal() > 0)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    const double sign = d < 0 ? -1 : 1;
+    const double length = std::abs(d);
+    // the kinematics of the profile
+    const double v = peakVelocity(length, maxA, maxJ, maxV);
+    // the time spent changing the acceleration, and the time spent at the peak acceleration
+    double jerkTime = std::isinf(maxJ) ? 0 : maxA / maxJ;
+    double holdTime = v / maxA - jerkTime;
+    if (holdTime < 0) {
+        jerkTime = std::sqrt(v / maxJ);
+        holdTime = 0;
+    }
+    const double a = jerkTime == 0 ? maxA : maxJ * jerkTime;
+    const double rampTime = 2 * jerkTime + holdTime;
+    const double cruiseTime = v == 0 ? 0 : std::max(0.0, (length - v * rampTime) / v);
+    const std::array<Phase, 7> phases = {{{jerkTime, 0, maxJ},
+                                          {holdTime, a, 0},
+                                          {jerkTime, a, -maxJ},
+                                          {cruiseTime, 0, 0},
+                                          {jerkTime, 0, -maxJ},
+                                          {holdTime, -a, 0},
+                                          {jerkTime, -a, maxJ}}};
+    const double duration = 2 * rampTime + cruiseTime;
+    const double step = m_step.internal();
+    // one setpoint at the start, and enough after it to reach the end
+    const size_t size = size_t(std::ceil(duration / step - 1E-9)) + 1;
+    if (size > m_capacity) {
+        errno = ERANGE;
+        return INT_MAX;
+    }
+    // walk through the phases, evaluating the setpoints which fall in each one
+    double position = 0;
+    double velocity = 0;
+    double phaseStart = 0;
+    size_t phase = 0;
+    for (size_t i = 0; i < size; i++) {
+        const double t = std::min(i * step, duration);
+        // phases which take no time are skipped, so an infinite jerk is never multiplied by 0
+        while (phase < phases.size() - 1 && t > phaseStart + phases[phase].duration) {
+            const Phase& p = phases[phase];
+            if (p.duration > 0) {
+                const double dt = p.duration;
+                position += velocity * dt + p.startAcceleration * dt * dt / 2 + p.jerk * dt * dt * dt / 6;
+                velocity += p.startAcceleration * dt + p.jerk * dt * dt / 2;
+            }
+            phaseStart += p.duration;
+            phase++;
+        }
+        const Phase& p = phases[phase];
+        const double dt = t - phaseStart;
+        ProfilePoint point;
+        if (dt > 0) {
+            point.position = from_m(sign * (position + velocity * dt + p.startAcceleration * dt * dt / 2 +
+                                            p.jerk * dt * dt * dt / 6));
+            point.velocity = from_mps(sign * (velocity + p.startAcceleration * dt + p.jerk * dt * dt / 2));
+            point.acceleration = from_mps2(sign * (p.startAcceleration + p.jerk * dt));
+        } else {
+            point.position = from_m(sign * position);
+            point.velocity = from_mps(sign * velocity);
+            point.acceleration = from_mps2(sign * p.startAcceleration);
+        }
+        m_storage[i] = point;
+    }
+    // the profile always ends exactly at rest at the distance, without the error of integrating the phases
+    m_storage[size - 1] = {.position = distance, .velocity = 0_mps, .acceleration = 0_mps2};
+    m_size = size;
+    m_duration = from_sec(duration);
+    return 0;
+}
+
+ProfilePoint MotionProfileBase::sample(Time time) const {
+    if (m_size == 0) return {};
+    if (time <= 0_sec) return m_storage[0];
+    if (time >= m_duration) return m_storage[m_size - 1];
+    const double index = to_sec(time) / m_step.internal();
+    const size_t i = std::min(size_t(index), m_size - 2);
+    const double frac = std::min(index - i, 1.0);
+    const ProfilePoint& a = m_storage[i];
+    const ProfilePoint& b = m_storage[i + 1];
+    return {.position = a.position + (b.position - a.position) * frac,
+            .velocity = a.velocity + (b.velocity - a.velocity) * frac,
+            .acceleration = a.acceleration + (b.acceleration - a.acceleration) * frac};
+}
+
+Time MotionProfileBase::getDuration() const { return m_duration; }
+
+Time MotionProfileBase::getStep() const { return m_step; }
+
+size_t MotionProfileBase::getSize() const { return m_size; }
+
+size_t MotionProfileBase::getCapacity() const { return m_capacity; }
+} // namespace lemlib
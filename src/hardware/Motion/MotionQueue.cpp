@@ -0,0 +1,145 @@
+#include "hardware/Motion/MotionQueue.hpp"
+#include "hardware/AllocationTracker.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+MotionQueueBase::MotionQueueBase(PathSample* storage, size_t capacity, DifferentialDrive& drive, Odometry& odometry,
+                                 RamseteController controller, Length wheelDiameter, PathConstraints constraints)
+    : m_storage(storage),
+      m_capacity(capacity),
+      m_drive(drive),
+      m_odometry(odometry),
+      m_controller(controller),
+      m_wheelDiameter(wheelDiameter),
+      m_constraints(constraints),
+      m_sampler(std::span<const PathSample>()) {}
+
+int32_t MotionQueueBase::enqueue(std::span<const PathSample> samples) {
+    bool valid = !samples.empty();
+    for (const PathSample& sample : samples) {
+        valid = valid && std::isfinite(to_m(sample.position.x)) && std::isfinite(to_m(sample.position.y));
+    }
+    if (!valid) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    std::lock_guard lock(m_mutex);
+    // the robot stopped at the end of the last run, so the storage starts over
+    if (!m_running) {
+        m_size = 0;
+        m_motions = 0;
+        m_passed = 0;
+    }
+    const size_t oldSize = m_size;
+    // a path which starts where the previous one ends would repeat the point, which is a segment of length 0
+    size_t first = 0;
+    if (oldSize > 0 && samples[0].position.x == m_storage[oldSize - 1].position.x &&
+        samples[0].position.y == m_storage[oldSize - 1].position.y) {
+        first = 1;
+    }
+    if (m_motions == MAX_MOTIONS || oldSize + samples.size() - first > m_capacity) {
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    for (size_t i = first; i < samples.size(); i++) m_storage[m_size++] = {.position = samples[i].position};
+    if (reprofile() == INT_MAX) {
+        // the profile failed before it changed any sample, so dropping the new ones restores the queue
+        m_size = oldSize;
+        return INT_MAX;
+    }
+    m_ends[m_motions++] = m_size - 1;
+    const uint64_t now = pros::c::micros();
+    if (!m_running) {
+        m_running = true;
+        m_start = now;
+    }
+    // the sampler is rebuilt over the longer profile, and walked back to where the robot is. Every segment behind the
+    // robot kept its velocities, so the walk ends on the same segment
+    m_sampler = TrajectorySampler({m_storage, m_size});
+    m_sampler.sample(from_usec(now - m_start));
+    return int32_t(m_queued++);
+}
+
+int32_t MotionQueueBase::reprofile() {
+    // the robot is heading to the end of its segment at the velocity it was profiled with, so the profile is blended
+    // from there
+    const size_t from = m_running ? std::min(m_sampler.getSegment() + 1, m_size - 1) : 0;
+    const PathSample kept = m_storage[from];
+    PathConstraints constraints = m_constraints;
+    constraints.startVelocity = m_running ? kept.velocity : 0_mps;
+    constraints.endVelocity = 0_mps;
+    if (profilePath({m_storage + from, m_size - from}, constraints) == INT_MAX) return INT_MAX;
+    // the curvature of the first sample was found from only one neighbour, and its velocity may have been capped
+    if (m_running) m_storage[from] = kept;
+    return 0;
+}
+
+int32_t MotionQueueBase::clear() {
+    std::lock_guard lock(m_mutex);
+    m_completed += m_motions - m_passed;
+    m_size = 0;
+    m_motions = 0;
+    m_passed = 0;
+    m_running = false;
+    m_sampler = TrajectorySampler(std::span<const PathSample>());
+    return m_drive.brake();
+}
+
+uint32_t MotionQueueBase::getCompleted() const { return m_completed.load(); }
+
+bool MotionQueueBase::isBusy() const {
+    std::lock_guard lock(m_mutex);
+    return m_running;
+}
+
+TrajectoryState MotionQueueBase::getReference() const {
+    std::lock_guard lock(m_mutex);
+    return m_reference;
+}
+
+int32_t MotionQueueBase::setLatency(Time latency) {
+    // written so NaN fails the comparison
+    if (!(latency >= 0_sec) || latency == from_sec(INFINITY)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    std::lock_guard lock(m_mutex);
+    m_latency = latency;
+    return 0;
+}
+
+Time MotionQueueBase::getLatency() const {
+    std::lock_guard lock(m_mutex);
+    return m_latency;
+}
+
+int32_t MotionQueueBase::update() {
+    LEMLIB_ALLOCATION_FREE("MotionQueue::update");
+    std::lock_guard lock(m_mutex);
+    if (!m_running) return 0;
+    // the trajectory and the pose are both taken at the time the command takes effect
+    m_reference = m_sampler.sample(from_usec(pros::c::micros() - m_start) + m_latency);
+    // a path is completed once the reference passes its last sample
+    while (m_passed < m_motions && m_ends[m_passed] <= m_sampler.getSegment()) {
+        m_passed++;
+        m_completed++;
+    }
+    if (m_sampler.done()) {
+        m_running = false;
+        return m_drive.brake();
+    }
+    units::Pose pose = m_odometry.getPose();
+    if (m_latency > 0_sec) {
+        const units::Pose predicted = m_odometry.predictPose(m_latency);
+        // odometry without a history can't predict, so the latest pose is tracked
+        if (predicted.x != from_in(INFINITY)) pose = predicted;
+    }
+    const DriveVelocities velocities = m_controller.calculate(pose, m_reference);
+    return m_drive.moveVelocity(velocities, m_wheelDiameter);
+}
+} // namespace lemlib
@@ -0,0 +1,223 @@
+#include "hardware/Motion/Path.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace lemlib {
+Path::Path(std::span<const units::V2Position> waypoints, Length cellSize) {
+    m_waypoints.reserve(waypoints.size());
+    for (const units::V2Position& waypoint : waypoints) {
+        // duplicates would be segments with no direction
+        if (!m_waypoints.empty() && m_waypoints.back().x == waypoint.x && m_waypoints.back().y == waypoint.y) continue;
+        m_waypoints.push_back(waypoint);
+    }
+    build(to_m(cellSize));
+}
+
+Path::Path(std::initializer_list<units::V2Position> waypoints, Length cellSize)
+    : Path(std::span<const units::V2Position>(waypoints.begin(), waypoints.size()), cellSize) {}
+
+Path::Path(std::span<const PathRecord> records, Length cellSize) {
+    m_waypoints.reserve(records.size());
+    for (size_t i = 0; i < records.size(); i++) {
+        // duplicates would be segments with no direction
+        if (i > 0 && records[i].x == records[i - 1].x && records[i].y == records[i - 1].y) continue;
+        m_waypoints.push_back(decodePathRecord(records[i]).position);
+    }
+    build(to_m(cellSize));
+}
+
+void Path::build(double cellSize) {
+    m_distances.resize(m_waypoints.size(), 0);
+    for (size_t i = 1; i < m_waypoints.size(); i++) {
+        m_distances[i] = m_distances[i - 1] + to_m(m_waypoints[i - 1].distanceTo(m_waypoints[i]));
+    }
+    if (segments() == 0) return;
+    // the grid covers the bounding box of the waypoints
+    double minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY;
+    for (const units::V2Position& waypoint : m_waypoints) {
+        minX = std::min(minX, to_m(waypoint.x));
+        minY = std::min(minY, to_m(waypoint.y));
+        maxX = std::max(maxX, to_m(waypoint.x));
+        maxY = std::max(maxY, to_m(waypoint.y));
+    }
+    m_originX = minX;
+    m_originY = minY;
+    m_cellSize = cellSize > 0 && std::isfinite(cellSize) ? cellSize : 1;
+    while (true) {
+        m_cols = size_t((maxX - minX) / m_cellSize) + 1;
+        m_rows = size_t((maxY - minY) / m_cellSize) + 1;
+        if (m_cols * m_rows <= MAX_CELLS) break;
+        m_cellSize *= 2;
+    }
+    // every segment is added to every cell its bounding box overlaps. Counting first lets the cells be stored in a
+    // single array
+    const auto forEachCell = [&](size_t segment, auto&& function) {
+        size_t col0, row0, col1, row1;
+        cellOf(to_m(m_waypoints[segment].x), to_m(m_waypoints[segment].y), col0, row0);
+        cellOf(to_m(m_waypoints[segment + 1].x), to_m(m_waypoints[segment + 1].y), col1, row1);
+        for (size_t row = std::min(row0, row1); row <= std::max(row0, row1); row++) {
+            for (size_t col = std::min(col0, col1); col <= std::max(col0, col1); col++) function(row * m_cols + col);
+        }
+    };
+    m_cellStart.assign(m_cols * m_rows + 1, 0);
+    for (size_t segment = 0; segment < segments(); segment++) {
+        forEachCell(segment, [&](size_t cell) { m_cellStart[cell + 1]++; });
+    }
+    for (size_t cell = 0; cell < m_cols * m_rows; cell++) m_cellStart[cell + 1] += m_cellStart[cell];
+    m_cellSegments.resize(m_cellStart.back());
+    std::vector<uint32_t> filled(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (size_t segment = 0; segment < segments(); segment++) {
+        forEachCell(segment, [&](size_t cell) { m_cellSegments[filled[cell]++] = segment; });
+    }
+}
+
+void Path::cellOf(double x, double y, size_t& col, size_t& row) const {
+    const double fx = std::floor((x - m_originX) / m_cellSize);
+    const double fy = std::floor((y - m_originY) / m_cellSize);
+    col = fx < 0 ? 0 : std::min(size_t(fx), m_cols - 1);
+    row = fy < 0 ? 0 : std::min(size_t(fy), m_rows - 1);
+}
+
+size_t Path::size() const { return m_waypoints.size(); }
+
+size_t Path::segments() const { return m_waypoints.size() < 2 ? 0 : m_waypoints.size() - 1; }
+
+units::V2Position Path::getWaypoint(size_t index) const { return m_waypoints[index]; }
+
+Length Path::getDistance(size_t index) const { return from_m(m_distances[index]); }
+
+Length Path::getLength() const { return m_distances.empty() ? 0_m : from_m(m_distances.back()); }
+
+PathPoint Path::closestOnSegment(size_t segment, units::V2Position position) const {
+    const double ax = to_m(m_waypoints[segment].x), ay = to_m(m_waypoints[segment].y);
+    const double dx = to_m(m_waypoints[segment + 1].x) - ax, dy = to_m(m_waypoints[segment + 1].y) - ay;
+    const double length = m_distances[segment + 1] - m_distances[segment];
+    // how far along the segment the position projects, from 0 at the start to 1 at the end
+    const double t =
+        std::clamp(((to_m(position.x) - ax) * dx + (to_m(position.y) - ay) * dy) / (length * length), 0.0, 1.0);
+    return {.position = units::V2Position(from_m(ax + t * dx), from_m(ay + t * dy)),
+            .segment = segment,
+            .distance = from_m(m_distances[segment] + t * length)};
+}
+
+PathPoint Path::closest(units::V2Position position, size_t firstSegment) const {
+    if (segments() == 0) {
+        return {.position = m_waypoints.empty() ? units::V2Position(0_m, 0_m) : m_waypoints.front()};
+    }
+    if (firstSegment >= segments()) return closestOnSegment(segments() - 1, position);
+    const double x = to_m(position.x), y = to_m(position.y);
+    size_t col, row;
+    cellOf(x, y, col, row);
+    PathPoint best;
+    double bestDistance = INFINITY;
+    // after every cell within a ring has been searched, every other cell is at least that many cells away
+    for (size_t ring = 0; ring <= std::max(m_cols, m_rows); ring++) {
+        if (ring > 0 && bestDistance <= (ring - 1) * m_cellSize) break;
+        const ptrdiff_t r = ring;
+        for (ptrdiff_t dr = -r; dr <= r; dr++) {
+            const ptrdiff_t cellRow = ptrdiff_t(row) + dr;
+            if (cellRow < 0 || cellRow >= ptrdiff_t(m_rows)) continue;
+            // only the outline of the ring, the inside was searched already
+            const ptrdiff_t step = (dr == -r || dr == r) ? 1 : std::max<ptrdiff_t>(2 * r, 1);
+            for (ptrdiff_t dc = -r; dc <= r; dc += step) {
+                const ptrdiff_t cellCol = ptrdiff_t(col) + dc;
+                if (cellCol < 0 || cellCol >= ptrdiff_t(m_cols)) continue;
+                const size_t cell = cellRow * m_cols + cellCol;
+                for (uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; i++) {
+                    const size_t segment = m_cellSegments[i];
+                    if (segment < firstSegment) continue;
+                    const PathPoint candidate = closestOnSegment(segment, position);
+                    const double distance = to_m(candidate.position.distanceTo(position));
+                    // the earlier segment wins a tie, like it would walking along the path
+                    if (distance < bestDistance || (distance == bestDistance && segment < best.segment)) {
+                        best = candidate;
+                        bestDistance = distance;
+                    }
+                }
+            }
+        }
+    }
+    return best;
+}
+
+PathTracker::PathTracker(const Path& path, size_t window, Length relocalizeDistance)
+    : m_path(path),
+      m_window(window),
+      m_relocalizeDistance(relocalizeDistance) {}
+
+void PathTracker::reset() {
+    m_started = false;
+    m_segment = 0;
+    m_lookahead = PathPoint();
+}
+
+PathPoint PathTracker::closest(units::V2Position position) {
+    if (m_path.segments() == 0) return m_path.closest(position);
+    if (!m_started) {
+        m_started = true;
+        m_lookahead = m_path.closestOnSegment(0, m_path.getWaypoint(0));
+        const PathPoint first = m_path.closest(position);
+        m_segment = first.segment;
+        return first;
+    }
+    PathPoint best = m_path.closestOnSegment(m_segment, position);
+    Length bestDistance = best.position.distanceTo(position);
+    // walk forwards while the path gets closer, giving up after a window of segments which are all further away
+    size_t misses = 0;
+    for (size_t segment = m_segment + 1; segment < m_path.segments() && misses < m_window; segment++) {
+        const PathPoint candidate = m_path.closestOnSegment(segment, position);
+        const Length distance = candidate.position.distanceTo(position);
+        if (distance < bestDistance) {
+            best = candidate;
+            bestDistance = distance;
+            misses = 0;
+        } else {
+            misses++;
+        }
+    }
+    if (bestDistance > m_relocalizeDistance) {
+        const PathPoint relocalized = m_path.closest(position, m_segment);
+        if (relocalized.position.distanceTo(position) < bestDistance) best = relocalized;
+    }
+    m_segment = best.segment;
+    return best;
+}
+
+PathPoint PathTracker::lookahead(units::V2Position position, Length radius) {
+    const PathPoint nearest = closest(position);
+    if (m_path.segments() == 0) return nearest;
+    const double r = to_m(radius);
+    const double px = to_m(position.x), py = to_m(position.y);
+    const size_t last = m_path.size() - 1;
+    PathPoint result = m_lookahead.distance > nearest.distance ? m_lookahead : nearest;
+    const units::V2Position end = m_path.getWaypoint(last);
+    if (end.distanceTo(position) <= radius) {
+        result = {.position = end, .segment = last - 1, .distance = m_path.getLength()};
+    } else {
+        for (size_t segment = std::max(nearest.segment, result.segment); segment < m_path.segments(); segment++) {
+            const units::V2Position a = m_path.getWaypoint(segment);
+            const units::V2Position b = m_path.getWaypoint(segment + 1);
+            // once a segment starts outside the circle, the path left the circle on an earlier segment
+            if (segment > nearest.segment && a.distanceTo(position) > radius) break;
+            // where the segment leaves the circle is the larger root of |a + t * (b - a) - position| = r
+            const double dx = to_m(b.x) - to_m(a.x), dy = to_m(b.y) - to_m(a.y);
+            const double fx = to_m(a.x) - px, fy = to_m(a.y) - py;
+            const double qa = dx * dx + dy * dy;
+            const double qb = 2 * (fx * dx + fy * dy);
+            const double qc = fx * fx + fy * fy - r * r;
+            const double discriminant = qb * qb - 4 * qa * qc;
+            if (discriminant < 0) continue;
+            const double t = (-qb + std::sqrt(discriminant)) / (2 * qa);
+            if (t < 0 || t > 1) continue;
+            const Length distance = m_path.getDistance(segment) + t * (m_path.getDistance(segment + 1) -
+                                                                       m_path.getDistance(segment));
+            if (distance < result.distance) continue;
+            result = {.position = units::V2Position(from_m(to_m(a.x) + t * dx), from_m(to_m(a.y) + t * dy)),
+                      .segment = segment,
+                      .distance = distance};
+        }
+    }
+    m_lookahead = result;
+    return result;
+}
+} // namespace lemlib
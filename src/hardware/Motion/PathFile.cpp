@@ -0,0 +1,197 @@
+#include "hardware/Motion/PathFile.hpp"
+#include "hardware/BootTrace.hpp"
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <errno.h>
+#include <limits>
+
+namespace lemlib {
+namespace {
+// the resolution of every value of a record, in SI units
+constexpr double POSITION_RESOLUTION = 1e-4;
+constexpr double VELOCITY_RESOLUTION = 1e-3;
+constexpr double CURVATURE_RESOLUTION = 1e-3;
+
+template <typename T> T toFixed(double value, double resolution) {
+    constexpr double min = std::numeric_limits<T>::min();
+    constexpr double max = std::numeric_limits<T>::max();
+    // NaN is stored as 0, rather than as whatever the cast makes of it
+    if (std::isnan(value)) return 0;
+    return T(std::clamp(std::round(value / resolution), min, max));
+}
+
+/**
+ * @brief Read and check the header of a path file
+ *
+ * @param file the file, at its start
+ * @param size set to the number of records
+ * @return true the header is valid
+ * @return false the file is not a path file of this version
+ */
+bool readHeader(FILE* file, uint32_t& size) {
+    std::array<uint8_t, 16> header;
+    uint16_t version = 0;
+    uint16_t recordSize = 0;
+    const bool valid = std::fread(header.data(), 1, header.size(), file) == header.size() &&
+                       std::memcmp(header.data(), "LPTH", 4) == 0;
+    std::memcpy(&version, &header[4], sizeof(version));
+    std::memcpy(&recordSize, &header[6], sizeof(recordSize));
+    std::memcpy(&size, &header[8], sizeof(size));
+    return valid && version == PATH_FORMAT_VERSION && recordSize == sizeof(PathRecord);
+}
+
+/**
+ * @brief Write a path file
+ *
+ * @param path the path of the file
+ * @param size the number of records
+ * @param writeRecords writes the records after the header, returning whether every one was written
+ * @return int32_t 0 on success
+ * @return INT_MAX on failure, setting errno
+ */
+template <typename F> int32_t writePath(const char* path, size_t size, F&& writeRecords) {
+    if (size > INT32_MAX) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    FILE* file = std::fopen(path, "wb");
+    // fopen has already set errno
+    if (file == nullptr) return INT_MAX;
+    std::array<uint8_t, 16> header {'L', 'P', 'T', 'H'};
+    const uint16_t version = PATH_FORMAT_VERSION;
+    const uint16_t recordSize = sizeof(PathRecord);
+    const uint32_t count = size;
+    std::memcpy(&header[4], &version, sizeof(version));
+    std::memcpy(&header[6], &recordSize, sizeof(recordSize));
+    std::memcpy(&header[8], &count, sizeof(count));
+    bool written = std::fwrite(header.data(), 1, header.size(), file) == header.size();
+    written = written && writeRecords(file);
+    // the records may only reach the card when the file is closed
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        errno = EIO;
+        return INT_MAX;
+    }
+    return 0;
+}
+} // namespace
+
+PathRecord encodePathSample(const PathSample& sample) {
+    return {.x = toFixed<int32_t>(to_m(sample.position.x), POSITION_RESOLUTION),
+            .y = toFixed<int32_t>(to_m(sample.position.y), POSITION_RESOLUTION),
+            .velocity = toFixed<int16_t>(to_mps(sample.velocity), VELOCITY_RESOLUTION),
+            .curvature = toFixed<int16_t>(to_radpm(sample.curvature), CURVATURE_RESOLUTION)};
+}
+
+PathSample decodePathRecord(const PathRecord& record) {
+    return {.position = units::V2Position(from_m(record.x * POSITION_RESOLUTION),
+                                          from_m(record.y * POSITION_RESOLUTION)),
+            .velocity = from_mps(record.velocity * VELOCITY_RESOLUTION),
+            .curvature = from_radpm(record.curvature * CURVATURE_RESOLUTION)};
+}
+
+int32_t loadPath(const char* path, std::span<PathRecord> buffer) {
+    LEMLIB_BOOT_SPAN("load path", 0);
+    FILE* file = std::fopen(path, "rb");
+    // fopen has already set errno
+    if (file == nullptr) return INT_MAX;
+    uint32_t size = 0;
+    if (!readHeader(file, size) || size > INT32_MAX) {
+        std::fclose(file);
+        errno = EPROTO;
+        return INT_MAX;
+    }
+    if (size > buffer.size()) {
+        std::fclose(file);
+        errno = ENOBUFS;
+        return INT_MAX;
+    }
+    const size_t count = std::fread(buffer.data(), sizeof(PathRecord), size, file);
+    std::fclose(file);
+    if (count != size) {
+        errno = EPROTO;
+        return INT_MAX;
+    }
+    return size;
+}
+
+int32_t savePath(const char* path, std::span<const PathRecord> records) {
+    return writePath(path, records.size(), [&](FILE* file) {
+        return std::fwrite(records.data(), sizeof(PathRecord), records.size(), file) == records.size();
+    });
+}
+
+int32_t savePath(const char* path, std::span<const PathSample> samples) {
+    return writePath(path, samples.size(), [&](FILE* file) {
+        std::array<PathRecord, 32> chunk;
+        for (size_t start = 0; start < samples.size(); start += chunk.size()) {
+            const size_t count = std::min(chunk.size(), samples.size() - start);
+            for (size_t i = 0; i < count; i++) chunk[i] = encodePathSample(samples[start + i]);
+            if (std::fwrite(chunk.data(), sizeof(PathRecord), count, file) != count) return false;
+        }
+        return true;
+    });
+}
+
+int32_t PathReader::open(const char* path) {
+    close();
+    FILE* file = std::fopen(path, "rb");
+    // fopen has already set errno
+    if (file == nullptr) return INT_MAX;
+    uint32_t size = 0;
+    if (!readHeader(file, size) || size > INT32_MAX) {
+        std::fclose(file);
+        errno = EPROTO;
+        return INT_MAX;
+    }
+    m_file = file;
+    m_size = size;
+    m_position = 0;
+    return 0;
+}
+
+void PathReader::close() {
+    if (m_file != nullptr) std::fclose(m_file);
+    m_file = nullptr;
+    m_size = 0;
+    m_position = 0;
+}
+
+bool PathReader::isOpen() const { return m_file != nullptr; }
+
+int32_t PathReader::read(std::span<PathRecord> chunk) {
+    if (m_file == nullptr) {
+        errno = EBADF;
+        return INT_MAX;
+    }
+    // anything after the last record is ignored
+    const size_t wanted = std::min<size_t>(chunk.size(), m_size - m_position);
+    const size_t count = std::fread(chunk.data(), sizeof(PathRecord), wanted, m_file);
+    m_position += count;
+    if (count != wanted) {
+        errno = EPROTO;
+        return INT_MAX;
+    }
+    return count;
+}
+
+int32_t PathReader::rewind() {
+    if (m_file == nullptr) {
+        errno = EBADF;
+        return INT_MAX;
+    }
+    // fseek has already set errno
+    if (std::fseek(m_file, 16, SEEK_SET) != 0) return INT_MAX;
+    m_position = 0;
+    return 0;
+}
+
+uint32_t PathReader::getSize() const { return m_size; }
+
+uint32_t PathReader::getPosition() const { return m_position; }
+
+PathReader::~PathReader() { close(); }
+} // namespace lemlib
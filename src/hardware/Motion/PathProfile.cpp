@@ -0,0 +1,71 @@
+#include "hardware/Motion/PathProfile.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+
+namespace lemlib {
+namespace {
+/**
+ * @brief Interpolate between the ends of a segment
+ *
+ * @param path the path
+ * @param start the sample at the start of the segment
+ * @param end the sample at the end of the segment
+ * @param point the point on the segment
+ * @return PathSample the sample at the point
+ */
+PathSample interpolate(const Path& path, const PathSample& start, const PathSample& end, const PathPoint& point) {
+    const double length = to_m(path.getDistance(point.segment + 1) - path.getDistance(point.segment));
+    const double t = length > 0 ? std::clamp(to_m(point.distance - path.getDistance(point.segment)) / length, 0.0, 1.0)
+                                : 0.0;
+    const double v0 = to_mps(start.velocity);
+    const double v1 = to_mps(end.velocity);
+    // the profile accelerates at a constant rate between points, so the square of the velocity is linear in distance
+    const double squared = v0 * std::abs(v0) + (v1 * std::abs(v1) - v0 * std::abs(v0)) * t;
+    return {.position = point.position,
+            .velocity = from_mps(std::copysign(std::sqrt(std::abs(squared)), squared)),
+            .curvature = t < 0.5 ? start.curvature : end.curvature};
+}
+} // namespace
+
+int32_t profilePath(std::span<PathSample> samples, PathConstraints constraints) {
+    const double maxVelocity = to_mps(constraints.maxVelocity);
+    const double maxAcceleration = to_mps2(constraints.maxAcceleration);
+    const double maxLateral = to_mps2(constraints.maxLateralAcceleration);
+    const double startVelocity = to_mps(constraints.startVelocity);
+    const double endVelocity = to_mps(constraints.endVelocity);
+    // the comparisons are written so NaN fails them
+    bool valid = maxVelocity > 0 && maxAcceleration > 0 && maxLateral > 0 && startVelocity >= 0 && endVelocity >= 0;
+    for (const PathSample& sample : samples) {
+        valid = valid && std::isfinite(to_m(sample.position.x)) && std::isfinite(to_m(sample.position.y));
+    }
+    if (!valid) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    detail::profileSamples(samples, constraints);
+    return 0;
+}
+
+PathSample samplePath(const Path& path, std::span<const PathSample> samples, const PathPoint& point) {
+    if (samples.size() < path.size() || path.size() == 0) return {.position = point.position};
+    if (point.segment + 1 >= path.size()) {
+        PathSample sample = samples[path.size() - 1];
+        sample.position = point.position;
+        return sample;
+    }
+    return interpolate(path, samples[point.segment], samples[point.segment + 1], point);
+}
+
+PathSample samplePath(const Path& path, std::span<const PathRecord> records, const PathPoint& point) {
+    if (records.size() < path.size() || path.size() == 0) return {.position = point.position};
+    if (point.segment + 1 >= path.size()) {
+        PathSample sample = decodePathRecord(records[path.size() - 1]);
+        sample.position = point.position;
+        return sample;
+    }
+    return interpolate(path, decodePathRecord(records[point.segment]), decodePathRecord(records[point.segment + 1]),
+                       point);
+}
+} // namespace lemlib
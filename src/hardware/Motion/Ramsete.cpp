@@ -0,0 +1,102 @@
+#include "hardware/Motion/Ramsete.hpp"
+#include "hardware/AllocationTracker.hpp"
+#include "hardware/Probe.hpp"
+#include "units/FastTrig.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace lemlib {
+TrajectorySampler::TrajectorySampler(std::span<const PathSample> samples)
+    : m_samples(samples) {}
+
+double TrajectorySampler::segmentTime(size_t segment) const {
+    const PathSample& a = m_samples[segment];
+    const PathSample& b = m_samples[segment + 1];
+    const double speed = to_mps(a.velocity + b.velocity) / 2;
+    // written so NaN fails the comparison
+    if (!(speed > 0)) return 0;
+    return to_m(a.position.distanceTo(b.position)) / speed;
+}
+
+TrajectoryState TrajectorySampler::sample(Time time) {
+    const double t = to_sec(time);
+    if (t < m_segmentStart) reset();
+    if (m_samples.empty()) {
+        m_done = true;
+        return {};
+    }
+    while (m_segment + 1 < m_samples.size()) {
+        const double duration = segmentTime(m_segment);
+        if (t < m_segmentStart + duration) break;
+        m_segmentStart += duration;
+        m_segment++;
+    }
+    const size_t last = m_samples.size() - 1;
+    if (m_segment == last) {
+        m_done = true;
+        const PathSample& end = m_samples[last];
+        const Angle heading = last > 0 ? units::fast::atan2(end.position.y - m_samples[last - 1].position.y,
+                                                            end.position.x - m_samples[last - 1].position.x)
+                                       : 0_stRad;
+        return {.pose = units::Pose(end.position.x, end.position.y, heading)};
+    }
+    m_done = false;
+    const PathSample& a = m_samples[m_segment];
+    const PathSample& b = m_samples[m_segment + 1];
+    const double dx = to_m(b.position.x - a.position.x);
+    const double dy = to_m(b.position.y - a.position.y);
+    const double length = std::hypot(dx, dy);
+    const double v0 = to_mps(a.velocity);
+    const double v1 = to_mps(b.velocity);
+    // the acceleration is constant along the segment, so v1^2 = v0^2 + 2 * a * d
+    const double acceleration = (v1 * v1 - v0 * v0) / (2 * length);
+    const double elapsed = t - m_segmentStart;
+    const double velocity = std::max(0.0, v0 + acceleration * elapsed);
+    const double fraction = std::clamp((v0 * elapsed + acceleration * elapsed * elapsed / 2) / length, 0.0, 1.0);
+    const double curvature = to_radpm(a.curvature) + (to_radpm(b.curvature) - to_radpm(a.curvature)) * fraction;
+    return {.pose = units::Pose(a.position.x + from_m(dx * fraction), a.position.y + from_m(dy * fraction),
+                                units::fast::atan2(from_m(dy), from_m(dx))),
+            .velocity = from_mps(velocity),
+            .angularVelocity = from_radps(velocity * curvature)};
+}
+
+bool TrajectorySampler::done() const { return m_done; }
+
+size_t TrajectorySampler::getSegment() const { return m_segment; }
+
+void TrajectorySampler::reset() {
+    m_segment = 0;
+    m_segmentStart = 0;
+    m_done = false;
+}
+
+RamseteController::RamseteController(Length trackWidth, RamseteGains gains)
+    : m_halfTrackWidth(to_m(trackWidth) / 2),
+      m_b(gains.b.internal()),
+      m_zeta(gains.zeta.internal()) {}
+
+DriveVelocities RamseteController::calculate(const units::Pose& current, const TrajectoryState& reference) const {
+    LEMLIB_PROBE("RamseteController::calculate");
+    LEMLIB_ALLOCATION_FREE("RamseteController::calculate");
+    // the error, rotated into the frame of the robot
+    const units::fast::SinCos robot = units::fast::sincos(current.orientation);
+    const double dx = to_m(reference.pose.x - current.x);
+    const double dy = to_m(reference.pose.y - current.y);
+    const double errorX = robot.cos.internal() * dx + robot.sin.internal() * dy;
+    const double errorY = -robot.sin.internal() * dx + robot.cos.internal() * dy;
+    const Angle headingError = units::angleError(reference.pose.orientation, current.orientation);
+    const double errorTheta = to_stRad(headingError);
+    const units::fast::SinCos error = units::fast::sincos(headingError);
+    // sin(x) / x, which is 1 - x^2 / 6 to well past double precision near 0
+    const double sinc =
+        std::abs(errorTheta) < 1e-4 ? 1 - errorTheta * errorTheta / 6 : error.sin.internal() / errorTheta;
+
+    const double v = to_mps(reference.velocity);
+    const double omega = to_radps(reference.angularVelocity);
+    const double k = 2 * m_zeta * std::sqrt(omega * omega + m_b * v * v);
+    const double linear = v * error.cos.internal() + k * errorX;
+    const double angular = omega + k * errorTheta + m_b * v * sinc * errorY;
+    return {.left = from_mps(linear - angular * m_halfTrackWidth),
+            .right = from_mps(linear + angular * m_halfTrackWidth)};
+}
+} // namespace lemlib
@@ -0,0 +1,203 @@
+#include "hardware/Motion/Spline.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace lemlib {
+namespace {
+/** Stirling numbers of the second kind, times k!, which are the k-th forward differences of t^j at 0 with a step of 1 */
+constexpr double POWER_DIFFERENCES[6][6] = {
+    {1, 0, 0, 0, 0, 0},   {0, 1, 0, 0, 0, 0},     {0, 1, 2, 0, 0, 0},
+    {0, 1, 6, 6, 0, 0},   {0, 1, 14, 36, 24, 0},  {0, 1, 30, 150, 240, 120},
+};
+
+/**
+ * @brief Evaluate a polynomial with Horner's method
+ *
+ * @param coefficients the coefficients, lowest power first
+ * @param t the value of the variable
+ * @return double the value of the polynomial
+ */
+template <size_t N> double evaluate(const std::array<double, N>& coefficients, double t) {
+    double result = 0;
+    for (size_t i = N; i-- > 0;) result = result * t + coefficients[i];
+    return result;
+}
+
+/**
+ * @brief Differentiate a polynomial
+ *
+ * @param coefficients the coefficients, lowest power first
+ * @return std::array<double, N> the coefficients of the derivative. The highest one is 0
+ */
+template <size_t N> std::array<double, N> derivative(const std::array<double, N>& coefficients) {
+    std::array<double, N> result {};
+    for (size_t i = 1; i < N; i++) result[i - 1] = i * coefficients[i];
+    return result;
+}
+
+/**
+ * @brief Find the heading and curvature of a curve from its derivatives
+ *
+ * @param position the position
+ * @param dx the first derivative of x
+ * @param dy the first derivative of y
+ * @param ddx the second derivative of x
+ * @param ddy the second derivative of y
+ * @return SplineSample the sample
+ */
+SplineSample makeSample(units::V2Position position, double dx, double dy, double ddx, double ddy) {
+    const double speedSquared = dx * dx + dy * dy;
+    const double curvature =
+        speedSquared == 0 ? INFINITY : (dx * ddy - dy * ddx) / (speedSquared * std::sqrt(speedSquared));
+    return {.position = position, .heading = from_stRad(std::atan2(dy, dx)), .curvature = from_radpm(curvature)};
+}
+} // namespace
+
+Spline::Spline(const Coefficients& x, const Coefficients& y, size_t degree)
+    : m_x(x),
+      m_y(y),
+      m_degree(degree) {}
+
+Spline Spline::cubicHermite(units::V2Position start, units::V2Position startTangent, units::V2Position end,
+                            units::V2Position endTangent) {
+    auto axis = [](double p0, double v0, double p1, double v1) -> Coefficients {
+        return {p0, v0, -3 * p0 - 2 * v0 + 3 * p1 - v1, 2 * p0 + v0 - 2 * p1 + v1, 0, 0};
+    };
+    return Spline(axis(to_m(start.x), to_m(startTangent.x), to_m(end.x), to_m(endTangent.x)),
+                  axis(to_m(start.y), to_m(startTangent.y), to_m(end.y), to_m(endTangent.y)), 3);
+}
+
+Spline Spline::quinticHermite(units::V2Position start, units::V2Position startTangent,
+                              units::V2Position startAcceleration, units::V2Position end, units::V2Position endTangent,
+                              units::V2Position endAcceleration) {
+    auto axis = [](double p0, double v0, double a0, double p1, double v1, double a1) -> Coefficients {
+        return {p0,
+                v0,
+                a0 / 2,
+                -10 * p0 - 6 * v0 - 1.5 * a0 + 10 * p1 - 4 * v1 + 0.5 * a1,
+                15 * p0 + 8 * v0 + 1.5 * a0 - 15 * p1 + 7 * v1 - a1,
+                -6 * p0 - 3 * v0 - 0.5 * a0 + 6 * p1 - 3 * v1 + 0.5 * a1};
+    };
+    return Spline(axis(to_m(start.x), to_m(startTangent.x), to_m(startAcceleration.x), to_m(end.x),
+                       to_m(endTangent.x), to_m(endAcceleration.x)),
+                  axis(to_m(start.y), to_m(startTangent.y), to_m(startAcceleration.y), to_m(end.y),
+                       to_m(endTangent.y), to_m(endAcceleration.y)),
+                  5);
+}
+
+Spline Spline::cubicBezier(units::V2Position p0, units::V2Position p1, units::V2Position p2, units::V2Position p3) {
+    auto axis = [](double p0, double p1, double p2, double p3) -> Coefficients {
+        return {p0, 3 * (p1 - p0), 3 * (p0 - 2 * p1 + p2), -p0 + 3 * p1 - 3 * p2 + p3, 0, 0};
+    };
+    return Spline(axis(to_m(p0.x), to_m(p1.x), to_m(p2.x), to_m(p3.x)),
+                  axis(to_m(p0.y), to_m(p1.y), to_m(p2.y), to_m(p3.y)), 3);
+}
+
+Spline Spline::quinticBezier(const std::array<units::V2Position, 6>& points) {
+    // the coefficient of t^j is C(5, j) times the j-th forward difference of the control points
+    constexpr double BINOMIAL[6] = {1, 5, 10, 10, 5, 1};
+    Coefficients x {};
+    Coefficients y {};
+    for (size_t j = 0; j <= 5; j++) {
+        double choose = 1; // C(j, i)
+        for (size_t i = 0; i <= j; i++) {
+            const double sign = (j - i) % 2 == 0 ? 1 : -1;
+            x[j] += BINOMIAL[j] * sign * choose * to_m(points[i].x);
+            y[j] += BINOMIAL[j] * sign * choose * to_m(points[i].y);
+            choose = choose * (j - i) / (i + 1);
+        }
+    }
+    return Spline(x, y, 5);
+}
+
+units::V2Position Spline::position(Number t) const {
+    return {from_m(evaluate(m_x, t.internal())), from_m(evaluate(m_y, t.internal()))};
+}
+
+SplineSample Spline::sample(Number t) const {
+    const Coefficients dx = derivative(m_x);
+    const Coefficients dy = derivative(m_y);
+    return makeSample(position(t), evaluate(dx, t.internal()), evaluate(dy, t.internal()),
+                      evaluate(derivative(dx), t.internal()), evaluate(derivative(dy), t.internal()));
+}
+
+size_t Spline::degree() const { return m_degree; }
+
+SplineStepper::SplineStepper(const Spline& spline, size_t steps)
+    : m_remaining(std::max<size_t>(steps, 1) + 1) {
+    const double h = 1.0 / std::max<size_t>(steps, 1);
+    const std::array<Spline::Coefficients, SERIES> series = {
+        spline.m_x, spline.m_y, derivative(spline.m_x), derivative(spline.m_y), derivative(derivative(spline.m_x)),
+        derivative(derivative(spline.m_y))};
+    for (size_t s = 0; s < SERIES; s++) {
+        // substitute t = h * i, so every step of i is a step of 1
+        Spline::Coefficients scaled {};
+        double power = 1;
+        for (size_t j = 0; j <= Spline::MAX_DEGREE; j++) {
+            scaled[j] = series[s][j] * power;
+            power *= h;
+        }
+        for (size_t k = 0; k <= Spline::MAX_DEGREE; k++) {
+            m_differences[s][k] = 0;
+            for (size_t j = k; j <= Spline::MAX_DEGREE; j++) m_differences[s][k] += scaled[j] * POWER_DIFFERENCES[j][k];
+        }
+    }
+}
+
+bool SplineStepper::done() const { return m_remaining == 0; }
+
+void SplineStepper::step() {
+    for (Spline::Coefficients& differences : m_differences) {
+        // each difference takes the step of the one above it, which hasn't been stepped yet
+        for (size_t k = 0; k < Spline::MAX_DEGREE; k++) differences[k] += differences[k + 1];
+    }
+}
+
+SplineSample SplineStepper::next() {
+    const SplineSample sample = makeSample({from_m(m_differences[0][0]), from_m(m_differences[1][0])},
+                                           m_differences[2][0], m_differences[3][0], m_differences[4][0],
+                                           m_differences[5][0]);
+    if (m_remaining > 1) step();
+    if (m_remaining > 0) m_remaining--;
+    return sample;
+}
+
+units::V2Position SplineStepper::nextPosition() {
+    const units::V2Position position(from_m(m_differences[0][0]), from_m(m_differences[1][0]));
+    if (m_remaining > 1) step();
+    if (m_remaining > 0) m_remaining--;
+    return position;
+}
+
+ArcLengthTable::ArcLengthTable(const Spline& spline, size_t steps) {
+    SplineStepper stepper(spline, steps);
+    units::V2Position last = stepper.nextPosition();
+    m_distances.reserve(std::max<size_t>(steps, 1) + 1);
+    m_distances.push_back(0);
+    while (!stepper.done()) {
+        const units::V2Position position = stepper.nextPosition();
+        m_distances.push_back(m_distances.back() + to_m(last.distanceTo(position)));
+        last = position;
+    }
+}
+
+Length ArcLengthTable::getLength() const { return from_m(m_distances.back()); }
+
+Number ArcLengthTable::getParameter(Length distance) const {
+    const size_t steps = m_distances.size() - 1;
+    const double d = std::clamp(to_m(distance), 0.0, m_distances.back());
+    // the first step which ends after the distance
+    const size_t i = std::min<size_t>(
+        std::upper_bound(m_distances.begin() + 1, m_distances.end(), d) - m_distances.begin(), steps);
+    const double length = m_distances[i] - m_distances[i - 1];
+    const double fraction = length == 0 ? 0 : (d - m_distances[i - 1]) / length;
+    return Number((i - 1 + fraction) / steps);
+}
+
+Length ArcLengthTable::getDistance(Number t) const {
+    const size_t steps = m_distances.size() - 1;
+    const double scaled = std::clamp(t.internal(), 0.0, 1.0) * steps;
+    const size_t i = std::min<size_t>(scaled, steps - 1);
+    return from_m(m_distances[i] + (m_distances[i + 1] - m_distances[i]) * (scaled - i));
+}
+} // namespace lemlib
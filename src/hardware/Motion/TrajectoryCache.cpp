@@ -0,0 +1,162 @@
+#include "hardware/Motion/TrajectoryCache.hpp"
+#include "hardware/BootTrace.hpp"
+#include "hardware/Motion/Spline.hpp"
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <errno.h>
+
+namespace lemlib {
+namespace {
+/**
+ * @brief Build the spline between two waypoints
+ *
+ * @param a the first waypoint
+ * @param b the second waypoint
+ * @return Spline the spline
+ */
+Spline segmentSpline(const Waypoint& a, const Waypoint& b) {
+    // tangents as long as the chord keep the spline close to it without a cusp
+    const Length chord = a.position.distanceTo(b.position);
+    const units::V2Position startTangent(chord * units::cos(a.heading), chord * units::sin(a.heading));
+    const units::V2Position endTangent(chord * units::cos(b.heading), chord * units::sin(b.heading));
+    return Spline::cubicHermite(a.position, startTangent, b.position, endTangent);
+}
+
+/**
+ * @brief Get the number of samples a segment is split into
+ *
+ * @param table the arc length table of the segment
+ * @param spacing the distance between samples
+ * @return size_t the number of samples, without the end of the segment
+ */
+size_t segmentSteps(const ArcLengthTable& table, Length spacing) {
+    return std::max(1.0, std::ceil(to_m(table.getLength()) / to_m(spacing)));
+}
+
+/**
+ * @brief Add a value to a 64 bit FNV-1a hash
+ *
+ * @param hash the hash so far
+ * @param value the value, whose bytes are hashed
+ * @return uint64_t the new hash
+ */
+template <typename T> uint64_t fnv1a(uint64_t hash, const T& value) {
+    std::array<uint8_t, sizeof(T)> bytes;
+    std::memcpy(bytes.data(), &value, sizeof(T));
+    for (const uint8_t byte : bytes) hash = (hash ^ byte) * 0x100000001b3;
+    return hash;
+}
+} // namespace
+
+int32_t countTrajectorySamples(std::span<const Waypoint> waypoints, Length spacing) {
+    if (waypoints.size() < 2 || !(spacing > 0_m)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    // the end of every segment is the start of the next one, so only the last segment adds its end
+    size_t count = 1;
+    for (size_t i = 0; i + 1 < waypoints.size(); i++) {
+        count += segmentSteps(ArcLengthTable(segmentSpline(waypoints[i], waypoints[i + 1])), spacing);
+    }
+    return count;
+}
+
+int32_t generateTrajectory(std::span<const Waypoint> waypoints, const PathConstraints& constraints, Length spacing,
+                           std::span<PathSample> samples) {
+    if (waypoints.size() < 2 || !(spacing > 0_m)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    size_t count = 0;
+    for (size_t i = 0; i + 1 < waypoints.size(); i++) {
+        const Spline spline = segmentSpline(waypoints[i], waypoints[i + 1]);
+        const ArcLengthTable table(spline);
+        const size_t steps = segmentSteps(table, spacing);
+        // one more for the end of the last segment
+        if (count + steps + 1 > samples.size()) {
+            errno = ENOBUFS;
+            return INT_MAX;
+        }
+        for (size_t step = 0; step < steps; step++) {
+            const Number t = table.getParameter(table.getLength() * (double(step) / steps));
+            samples[count++] = {.position = spline.position(t)};
+        }
+        if (i + 2 == waypoints.size()) samples[count++] = {.position = spline.position(1)};
+    }
+    // profilePath has already set errno
+    if (profilePath(samples.first(count), constraints) == INT_MAX) return INT_MAX;
+    return count;
+}
+
+uint64_t hashTrajectory(std::span<const Waypoint> waypoints, const PathConstraints& constraints, Length spacing) {
+    uint64_t hash = 0xcbf29ce484222325;
+    hash = fnv1a(hash, TrajectoryCache::GENERATOR_VERSION);
+    hash = fnv1a(hash, PATH_FORMAT_VERSION);
+    hash = fnv1a(hash, uint64_t(waypoints.size()));
+    for (const Waypoint& waypoint : waypoints) {
+        hash = fnv1a(hash, to_m(waypoint.position.x));
+        hash = fnv1a(hash, to_m(waypoint.position.y));
+        hash = fnv1a(hash, to_stRad(waypoint.heading));
+    }
+    hash = fnv1a(hash, to_mps(constraints.maxVelocity));
+    hash = fnv1a(hash, to_mps2(constraints.maxAcceleration));
+    hash = fnv1a(hash, to_mps2(constraints.maxLateralAcceleration));
+    hash = fnv1a(hash, to_mps(constraints.startVelocity));
+    hash = fnv1a(hash, to_mps(constraints.endVelocity));
+    return fnv1a(hash, to_m(spacing));
+}
+
+TrajectoryCache::TrajectoryCache(const char* directory)
+    : m_directory(directory) {}
+
+int32_t TrajectoryCache::get(std::span<const Waypoint> waypoints, const PathConstraints& constraints, Length spacing,
+                             std::span<PathSample> samples) {
+    std::array<char, 128> path;
+    std::snprintf(path.data(), path.size(), "%s/%016llx.lpth", m_directory,
+                  (unsigned long long)hashTrajectory(waypoints, constraints, spacing));
+    const int32_t loaded = load(path.data(), samples);
+    if (loaded != INT_MAX) {
+        m_hits++;
+        return loaded;
+    }
+    // generating it again wouldn't fit either
+    if (errno == ENOBUFS) return INT_MAX;
+    m_misses++;
+    LEMLIB_BOOT_SPAN("generate trajectory", 0);
+    const int32_t count = generateTrajectory(waypoints, constraints, spacing, samples);
+    if (count == INT_MAX) return INT_MAX;
+    // rounded like the file, so this boot follows the same trajectory as the ones which load it
+    for (PathSample& sample : samples.first(count)) sample = decodePathRecord(encodePathSample(sample));
+    // the trajectory is usable without the file, which is only needed to skip generating it next time
+    savePath(path.data(), std::span<const PathSample>(samples.first(count)));
+    return count;
+}
+
+uint32_t TrajectoryCache::getHits() const { return m_hits.load(); }
+
+uint32_t TrajectoryCache::getMisses() const { return m_misses.load(); }
+
+int32_t TrajectoryCache::load(const char* path, std::span<PathSample> samples) {
+    LEMLIB_BOOT_SPAN("load trajectory", 0);
+    PathReader reader;
+    // open has already set errno
+    if (reader.open(path) == INT_MAX) return INT_MAX;
+    if (reader.getSize() > samples.size()) {
+        errno = ENOBUFS;
+        return INT_MAX;
+    }
+    std::array<PathRecord, 32> chunk;
+    size_t count = 0;
+    int32_t read;
+    while ((read = reader.read(chunk)) > 0) {
+        // read has already set errno
+        if (read == INT_MAX) return INT_MAX;
+        for (int32_t i = 0; i < read; i++) samples[count++] = decodePathRecord(chunk[i]);
+    }
+    return count;
+}
+} // namespace lemlib
@@ -0,0 +1,217 @@
+#include "hardware/Motor/Characterization.hpp"
+#include "hardware/AllocationTracker.hpp"
+#include "hardware/Battery.hpp"
+#include "hardware/BootTrace.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+template <typename T> int32_t CharacterizationBase::moveTarget(Encoder& target, Number power) {
+    return static_cast<T&>(target).move(power);
+}
+
+template <typename T> AngularVelocity CharacterizationBase::measureVelocity(const Encoder& target) {
+    return static_cast<const T&>(target).getVelocity();
+}
+
+template <typename T> AngularAcceleration CharacterizationBase::measureAcceleration(const Encoder& target) {
+    return static_cast<const T&>(target).getAcceleration();
+}
+
+template <> Current CharacterizationBase::measureCurrent<Motor>(const Encoder& target) {
+    return static_cast<const Motor&>(target).getCurrent();
+}
+
+template <> Current CharacterizationBase::measureCurrent<MotorGroup>(const Encoder& target) {
+    // Current has no default constructor, so the buffer is filled in by hand
+    static_assert(MotorGroup::MAX_MOTORS == 8, "fill in a current for every motor");
+    std::array<Current, MotorGroup::MAX_MOTORS> currents {0_amp, 0_amp, 0_amp, 0_amp, 0_amp, 0_amp, 0_amp, 0_amp};
+    const int32_t count = static_cast<const MotorGroup&>(target).getCurrents(currents);
+    if (count == INT_MAX) return from_amp(INFINITY);
+    Current total = 0_amp;
+    for (int32_t i = 0; i < count; i++) total += currents[i];
+    return total;
+}
+
+CharacterizationBase::CharacterizationBase(Motor& motor, const CharacterizationSettings& settings,
+                                           CharacterizationSample* storage, size_t capacity)
+    : m_target(motor),
+      m_move(moveTarget<Motor>),
+      m_measureVelocity(measureVelocity<Motor>),
+      m_measureAcceleration(measureAcceleration<Motor>),
+      m_measureCurrent(measureCurrent<Motor>),
+      m_settings(settings),
+      m_storage(storage),
+      m_capacity(capacity) {}
+
+CharacterizationBase::CharacterizationBase(MotorGroup& motors, const CharacterizationSettings& settings,
+                                           CharacterizationSample* storage, size_t capacity)
+    : m_target(motors),
+      m_move(moveTarget<MotorGroup>),
+      m_measureVelocity(measureVelocity<MotorGroup>),
+      m_measureAcceleration(measureAcceleration<MotorGroup>),
+      m_measureCurrent(measureCurrent<MotorGroup>),
+      m_settings(settings),
+      m_storage(storage),
+      m_capacity(capacity) {}
+
+CharacterizationBase::~CharacterizationBase() { stop(); }
+
+void CharacterizationBase::reset() {
+    m_size.store(0, std::memory_order_release);
+    m_phase = CharacterizationPhase::IDLE;
+    m_power = 0;
+    m_xx = {};
+    m_xy = {};
+    m_y = 0;
+    m_yy = 0;
+    m_fitted = 0;
+}
+
+void CharacterizationBase::fit(const CharacterizationSample& sample) {
+    const double x[3] = {std::copysign(1.0, to_rpm(sample.velocity)), to_rpm(sample.velocity),
+                         to_rpm(sample.acceleration * 1_sec)};
+    const double y = sample.power.internal();
+    std::lock_guard lock(m_mutex);
+    for (size_t row = 0, index = 0; row < 3; row++) {
+        for (size_t column = row; column < 3; column++) m_xx[index++] += x[row] * x[column];
+        m_xy[row] += x[row] * y;
+    }
+    m_y += y;
+    m_yy += y * y;
+    m_fitted++;
+}
+
+int32_t CharacterizationBase::update() {
+    LEMLIB_ALLOCATION_FREE("Characterization::update");
+    const uint64_t now = pros::c::micros();
+    CharacterizationPhase phase = m_phase.load();
+    if (phase == CharacterizationPhase::DONE) return 0;
+    if (phase == CharacterizationPhase::IDLE) {
+        m_start = now;
+        m_phaseStart = now;
+        phase = CharacterizationPhase::QUASISTATIC;
+    }
+
+    // the measurements respond to the power sent in the last update, so they are logged with it
+    const CharacterizationSample sample {.time = from_usec(now - m_start),
+                                         .power = m_power,
+                                         .voltage = m_power * Battery::get().getVoltage(),
+                                         .velocity = m_measureVelocity(m_target),
+                                         .acceleration = m_measureAcceleration(m_target),
+                                         .current = m_measureCurrent(m_target)};
+    const size_t size = m_size.load(std::memory_order_relaxed);
+    if (size < m_capacity) {
+        m_storage[size] = sample;
+        m_size.store(size + 1, std::memory_order_release);
+    }
+    // the motors coast while settling, so the voltage across them isn't the power they were sent
+    const double speed = std::abs(to_rpm(sample.velocity));
+    if (phase != CharacterizationPhase::SETTLING && speed >= to_rpm(m_settings.minVelocity) && speed < INFINITY &&
+        std::isfinite(to_rps2(sample.acceleration))) {
+        fit(sample);
+    }
+
+    const Time elapsed = from_usec(now - m_phaseStart);
+    const Time duration = phase == CharacterizationPhase::QUASISTATIC ? m_settings.rampDuration
+                          : phase == CharacterizationPhase::SETTLING  ? m_settings.settleDuration
+                                                                      : m_settings.stepDuration;
+    if (elapsed >= duration) {
+        m_phaseStart = now;
+        phase = phase == CharacterizationPhase::QUASISTATIC ? CharacterizationPhase::SETTLING
+                : phase == CharacterizationPhase::SETTLING  ? CharacterizationPhase::DYNAMIC
+                                                            : CharacterizationPhase::DONE;
+    }
+    const double direction = m_settings.reverse ? -1 : 1;
+    switch (phase) {
+        case CharacterizationPhase::QUASISTATIC:
+            m_power = direction * m_settings.rampPower.internal() * to_sec(elapsed) / to_sec(m_settings.rampDuration);
+            break;
+        case CharacterizationPhase::DYNAMIC: m_power = direction * m_settings.stepPower.internal(); break;
+        default: m_power = 0; break;
+    }
+    m_phase = phase;
+    return m_move(m_target, m_power);
+}
+
+int32_t CharacterizationBase::start(Time period, uint32_t priority) {
+    std::lock_guard lock(m_mutex);
+    if (m_running.load() || !m_taskExited.load()) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    reset();
+    m_period = period;
+    m_running = true;
+    m_taskExited = false;
+    LEMLIB_BOOT_EVENT("create lemlib characterization task", 0);
+    const pros::task_t task =
+        pros::c::task_create(taskFunction, this, priority, TASK_STACK_DEPTH_DEFAULT, "lemlib characterization");
+    if (task == nullptr) {
+        m_running = false;
+        m_taskExited = true;
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+void CharacterizationBase::stop() {
+    const bool wasRunning = m_running.exchange(false);
+    // wait for the task to finish its current update, so the characterization can be safely destroyed afterwards
+    while (!m_taskExited.load()) pros::c::delay(1);
+    if (wasRunning) {
+        m_move(m_target, 0);
+        m_phase = CharacterizationPhase::DONE;
+    }
+}
+
+CharacterizationPhase CharacterizationBase::getPhase() const { return m_phase.load(); }
+
+Result<CharacterizationResult> CharacterizationBase::getResult() const {
+    std::lock_guard lock(m_mutex);
+    if (m_fitted < 3) return Result<CharacterizationResult>::failure(EAGAIN);
+    // the normal equations, solved with Cramer's rule
+    const double a = m_xx[0], b = m_xx[1], c = m_xx[2], d = m_xx[3], e = m_xx[4], f = m_xx[5];
+    const double det = a * (d * f - e * e) - b * (b * f - c * e) + c * (b * e - c * d);
+    // relative to the diagonal, so it doesn't depend on the units of the samples. Written so NaN fails the comparison
+    if (!(std::abs(det) > 1E-9 * a * d * f)) return Result<CharacterizationResult>::failure(EDOM);
+    const double p = m_xy[0], q = m_xy[1], r = m_xy[2];
+    const double kS = (p * (d * f - e * e) - b * (q * f - r * e) + c * (q * e - r * d)) / det;
+    const double kV = (a * (q * f - r * e) - p * (b * f - c * e) + c * (b * r - c * q)) / det;
+    const double kA = (a * (d * r - e * q) - b * (b * r - c * q) + p * (b * e - c * d)) / det;
+    // the residual, from the normal equations, so the samples themselves aren't needed
+    const double fitted = kS * p + kV * q + kA * r;
+    const double residual = m_yy - fitted;
+    const double total = m_yy - m_y * m_y / m_fitted;
+    CharacterizationResult result;
+    result.gains.kS = kS;
+    result.gains.kV = kV;
+    result.gains.kA = kA;
+    result.rSquared = total > 0 ? std::clamp(1 - residual / total, 0.0, 1.0) : 0;
+    result.samples = m_fitted;
+    return result;
+}
+
+std::span<const CharacterizationSample> CharacterizationBase::getSamples() const {
+    return {m_storage, m_size.load(std::memory_order_acquire)};
+}
+
+void CharacterizationBase::taskFunction(void* characterization) {
+    CharacterizationBase& self = *static_cast<CharacterizationBase*>(characterization);
+    const uint32_t period = std::max(1.0, std::round(to_msec(self.m_period)));
+    uint32_t now = pros::c::millis();
+    while (self.m_running.load() && self.getPhase() != CharacterizationPhase::DONE) {
+        self.update();
+        pros::c::task_delay_until(&now, period);
+    }
+    // the tests finished on their own, and left the motors stopped
+    self.m_running = false;
+    // PROS deletes the task once this function returns
+    self.m_taskExited = true;
+}
+} // namespace lemlib
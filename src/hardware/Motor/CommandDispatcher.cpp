@@ -0,0 +1,139 @@
+#include "hardware/Motor/CommandDispatcher.hpp"
+#include "hardware/DeviceRegistry.hpp"
+#include "hardware/SdkCallTracker.hpp"
+#include "hardware/util.hpp"
+#include "pros/motors.h"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+
+namespace lemlib {
+CommandDispatcher& CommandDispatcher::get() {
+    static CommandDispatcher dispatcher;
+    return dispatcher;
+}
+
+int32_t CommandDispatcher::submit(const MotorCommand& command, uint8_t priority) {
+    priority = std::max(priority, command.priority);
+    const uint8_t port = std::abs(command.port);
+    // commands are kept in the forward direction, so commands from objects reversed either way replace each other
+    const int32_t value = command.port < 0 ? -command.value : command.value;
+    const uint64_t packed = PortState::packCommand(uint8_t(command.kind), value, pros::c::millis());
+    if (command.kind == MotorCommand::Kind::NONE || port < 1 || port > DeviceRegistry::SMART_PORTS || packed == 0) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    if (!claim(command.port, priority)) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    std::atomic<uint64_t>& pending = DeviceRegistry::get().getPortState(port).pending;
+    uint64_t previous = pending.load(std::memory_order_relaxed);
+    do {
+        if (previous != 0 && PortState::commandPriority(previous) > priority) {
+            errno = EBUSY;
+            return INT_MAX;
+        }
+    } while (!pending.compare_exchange_weak(previous, packed | (uint64_t(priority) << 56), std::memory_order_relaxed));
+    if (previous != 0) m_skipped.fetch_add(1, std::memory_order_relaxed);
+    return 0;
+}
+
+int32_t CommandDispatcher::flush() {
+    DeviceRegistry& registry = DeviceRegistry::get();
+    const uint32_t refreshPeriod = m_refreshPeriod.load(std::memory_order_relaxed);
+    bool failed = false;
+    for (uint8_t port = 1; port <= DeviceRegistry::SMART_PORTS; port++) {
+        PortState& state = registry.getPortState(port);
+        // a load first, so ports without a pending command aren't written
+        if (state.pending.load(std::memory_order_relaxed) == 0) continue;
+        const uint64_t pending = state.pending.exchange(0, std::memory_order_relaxed);
+        if (pending == 0) continue;
+        // a source with a higher priority may have moved the motor directly since the command was submitted
+        if (!claim(port, PortState::commandPriority(pending))) continue;
+        const uint8_t kind = PortState::commandKind(pending);
+        const int32_t value = PortState::commandValue(pending);
+        // the motor is still following the same command, sent by the dispatcher or by a motor which isn't reversed
+        const uint64_t last = state.command.load(std::memory_order_relaxed);
+        const uint32_t now = pros::c::millis();
+        if (PortState::commandKind(last) == kind && PortState::commandValue(last) == value &&
+            now - PortState::commandTime(last) < refreshPeriod) {
+            m_skipped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        int32_t result = INT_MAX;
+        switch (MotorCommand::Kind(kind)) {
+            case (MotorCommand::Kind::VOLTAGE):
+                result = convertStatus(LEMLIB_SDK_CALL(port, pros::c::motor_move_voltage(port, value)));
+                break;
+            case (MotorCommand::Kind::VELOCITY):
+                result = convertStatus(LEMLIB_SDK_CALL(port, pros::c::motor_move_velocity(port, value)));
+                break;
+            case (MotorCommand::Kind::BRAKE):
+                result = convertStatus(LEMLIB_SDK_CALL(port, pros::c::motor_brake(port)));
+                break;
+            default: break;
+        }
+        m_sent.fetch_add(1, std::memory_order_relaxed);
+        if (result == 0) {
+            state.command.store(PortState::packCommand(kind, value, now), std::memory_order_relaxed);
+        } else {
+            // the motor was most likely unplugged, and could be replaced by a different one
+            state.invalidate();
+            failed = true;
+        }
+    }
+    if (failed) {
+        errno = ENODEV;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+bool CommandDispatcher::claim(int8_t port, uint8_t priority) {
+    const uint8_t index = std::abs(port);
+    // invalid ports are left for the SDK to reject
+    if (index < 1 || index > DeviceRegistry::SMART_PORTS) return true;
+    std::atomic<uint64_t>& owner = DeviceRegistry::get().getPortState(index).owner;
+    uint64_t current = owner.load(std::memory_order_relaxed);
+    // priority 0 never owns a port, so motors which aren't arbitrated never write the owner
+    if (current == 0 && priority == 0) return true;
+    const uint32_t now = pros::c::millis();
+    const uint32_t timeout = m_ownershipTimeout.load(std::memory_order_relaxed);
+    const uint64_t claimed = priority == 0 ? 0 : (uint64_t(priority) << 32) | now;
+    do {
+        if (current != 0 && uint8_t(current >> 32) > priority && now - uint32_t(current) < timeout) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (current == claimed) return true;
+    } while (!owner.compare_exchange_weak(current, claimed, std::memory_order_relaxed));
+    return true;
+}
+
+void CommandDispatcher::release(int8_t port, uint8_t priority) {
+    const uint8_t index = std::abs(port);
+    if (index < 1 || index > DeviceRegistry::SMART_PORTS || priority == 0) return;
+    std::atomic<uint64_t>& owner = DeviceRegistry::get().getPortState(index).owner;
+    uint64_t current = owner.load(std::memory_order_relaxed);
+    // a source which took the port over since is left alone
+    while (current != 0 && uint8_t(current >> 32) == priority &&
+           !owner.compare_exchange_weak(current, 0, std::memory_order_relaxed)) {}
+}
+
+void CommandDispatcher::setOwnershipTimeout(Time timeout) {
+    m_ownershipTimeout.store(std::max(0.0, std::round(to_msec(timeout))), std::memory_order_relaxed);
+}
+
+void CommandDispatcher::setRefreshPeriod(Time period) {
+    m_refreshPeriod.store(std::max(0.0, std::round(to_msec(period))), std::memory_order_relaxed);
+}
+
+uint32_t CommandDispatcher::getSent() const { return m_sent.load(std::memory_order_relaxed); }
+
+uint32_t CommandDispatcher::getSkipped() const { return m_skipped.load(std::memory_order_relaxed); }
+
+uint32_t CommandDispatcher::getDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+} // namespace lemlib
@@ -0,0 +1,89 @@
+#include "hardware/Motor/DifferentialDrive.hpp"
+#include "hardware/AllocationTracker.hpp"
+#include "hardware/DeviceRegistry.hpp"
+#include "hardware/Probe.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <mutex>
+
+namespace lemlib {
+namespace {
+/**
+ * @brief Scale down the power of both sides by the same amount, so neither is past full power
+ *
+ * @param left the power of the left side
+ * @param right the power of the right side
+ * @return DrivePowers the scaled powers
+ */
+DrivePowers desaturate(double left, double right) {
+    const double largest = std::max({std::abs(left), std::abs(right), 1.0});
+    return {left / largest, right / largest};
+}
+} // namespace
+
+DifferentialDrive::DifferentialDrive(const std::initializer_list<ReversibleSmartPort>& leftPorts,
+                                     const std::initializer_list<ReversibleSmartPort>& rightPorts,
+                                     AngularVelocity outputVelocity)
+    : m_left(leftPorts, outputVelocity),
+      m_right(rightPorts, outputVelocity) {}
+
+MotorGroup& DifferentialDrive::getLeft() { return m_left; }
+
+MotorGroup& DifferentialDrive::getRight() { return m_right; }
+
+template <typename PrepareLeft, typename PrepareRight>
+int32_t DifferentialDrive::dispatch(PrepareLeft prepareLeft, PrepareRight prepareRight) {
+    // both groups are locked together, so this can never deadlock with another task locking them one at a time
+    std::scoped_lock lock(m_left.m_mutex, m_right.m_mutex);
+    // both sides are checked against the same snapshot of the ports
+    const uint32_t plugged = DeviceRegistry::get().getPluggedPorts(pros::c::E_DEVICE_MOTOR);
+    m_left.prepareCommands(plugged, prepareLeft);
+    m_right.prepareCommands(plugged, prepareRight);
+    Motor::sendCommands(m_left.m_commands);
+    Motor::sendCommands(m_right.m_commands);
+    // both sides are finished, even if the first one succeeded
+    const bool left = m_left.finishCommands();
+    const bool right = m_right.finishCommands();
+    // as long as one motor gets its command, return 0 (success)
+    return left || right ? 0 : INT_MAX;
+}
+
+int32_t DifferentialDrive::move(Number left, Number right) {
+    LEMLIB_PROBE("DifferentialDrive::move");
+    LEMLIB_ALLOCATION_FREE("DifferentialDrive::move");
+    return dispatch([&](Motor& motor) { return motor.prepareMoveImpl(left); },
+                    [&](Motor& motor) { return motor.prepareMoveImpl(right); });
+}
+
+int32_t DifferentialDrive::move(DrivePowers powers) { return move(powers.left, powers.right); }
+
+int32_t DifferentialDrive::moveVelocity(AngularVelocity left, AngularVelocity right) {
+    return dispatch([&](Motor& motor) { return motor.prepareMoveVelocityImpl(left); },
+                    [&](Motor& motor) { return motor.prepareMoveVelocityImpl(right); });
+}
+
+int32_t DifferentialDrive::moveVelocity(DriveVelocities velocities, Length wheelDiameter) {
+    const double radius = to_m(wheelDiameter) / 2;
+    return moveVelocity(from_radps(to_mps(velocities.left) / radius), from_radps(to_mps(velocities.right) / radius));
+}
+
+int32_t DifferentialDrive::arcade(Number throttle, Number turn) { return move(arcadeMix(throttle, turn)); }
+
+int32_t DifferentialDrive::curvature(Number throttle, Number curvature) {
+    return move(curvatureMix(throttle, curvature));
+}
+
+int32_t DifferentialDrive::brake() {
+    return dispatch([](Motor& motor) { return motor.prepareBrakeImpl(); },
+                    [](Motor& motor) { return motor.prepareBrakeImpl(); });
+}
+
+DrivePowers DifferentialDrive::arcadeMix(Number throttle, Number turn) {
+    return desaturate(throttle.internal() + turn.internal(), throttle.internal() - turn.internal());
+}
+
+DrivePowers DifferentialDrive::curvatureMix(Number throttle, Number curvature) {
+    return arcadeMix(throttle, std::abs(throttle.internal()) * curvature.internal());
+}
+} // namespace lemlib
@@ -0,0 +1,175 @@
+#include "hardware/Motor/FlywheelController.hpp"
+#include "hardware/AllocationTracker.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <mutex>
+
+namespace lemlib {
+namespace {
+/**
+ * @brief Clamp the number of velocity samples of the settings to the range the controller supports
+ *
+ * @param settings the settings
+ * @return FlywheelSettings the clamped settings
+ */
+FlywheelSettings clampSettings(FlywheelSettings settings) {
+    settings.velocitySamples = std::clamp<size_t>(settings.velocitySamples, 2, FlywheelController::MAX_SAMPLES);
+    return settings;
+}
+} // namespace
+
+FlywheelController::FlywheelController(Motor& motor, FlywheelSettings settings)
+    : m_target(motor),
+      m_move(moveTarget<Motor>),
+      m_sample(sampleTarget<Motor>),
+      m_settings(clampSettings(settings)),
+      m_targetVelocity(0_rpm),
+      m_state(FlywheelState {}) {}
+
+FlywheelController::FlywheelController(MotorGroup& motors, FlywheelSettings settings)
+    : m_target(motors),
+      m_move(moveTarget<MotorGroup>),
+      m_sample(sampleTarget<MotorGroup>),
+      m_settings(clampSettings(settings)),
+      m_targetVelocity(0_rpm),
+      m_state(FlywheelState {}) {}
+
+template <typename T> int32_t FlywheelController::moveTarget(Encoder& target, Number power) {
+    return static_cast<T&>(target).move(power);
+}
+
+template <typename T> EncoderSample FlywheelController::sampleTarget(const Encoder& target) {
+    return static_cast<const T&>(target).getSample();
+}
+
+int32_t FlywheelController::setTarget(AngularVelocity velocity) {
+    // the buffer only supports one writer at a time
+    std::lock_guard lock(m_mutex);
+    m_targetVelocity.write(velocity);
+    return 0;
+}
+
+AngularVelocity FlywheelController::getTarget() const { return m_targetVelocity.read(); }
+
+int32_t FlywheelController::setSettings(FlywheelSettings settings) {
+    std::lock_guard lock(m_mutex);
+    m_settings.write(clampSettings(settings));
+    m_reseed = true;
+    return 0;
+}
+
+FlywheelSettings FlywheelController::getSettings() const { return m_settings.read(); }
+
+FlywheelState FlywheelController::getState() const { return m_state.read(); }
+
+bool FlywheelController::isReady() const { return m_state.read().ready; }
+
+double FlywheelController::fitVelocity(size_t count) const {
+    count = std::min(count, m_samples);
+    if (count < 2) return 0;
+    // the samples are measured from the newest one, which keeps the sums precise however long the program runs
+    const auto sample = [&](size_t age) { return (m_newest + MAX_SAMPLES - age) % MAX_SAMPLES; };
+    double meanTime = 0;
+    double meanAngle = 0;
+    for (size_t i = 0; i < count; i++) {
+        meanTime += m_times[sample(i)] - m_times[m_newest];
+        meanAngle += m_angles[sample(i)] - m_angles[m_newest];
+    }
+    meanTime /= count;
+    meanAngle /= count;
+    // the least squares slope, which averages out the quantization of every sample instead of only using two
+    double covariance = 0;
+    double variance = 0;
+    for (size_t i = 0; i < count; i++) {
+        const double time = m_times[sample(i)] - m_times[m_newest] - meanTime;
+        covariance += time * (m_angles[sample(i)] - m_angles[m_newest] - meanAngle);
+        variance += time * time;
+    }
+    // rotations per second to rpm
+    return variance == 0 ? 0 : covariance / variance * 60;
+}
+
+int32_t FlywheelController::update() {
+    LEMLIB_ALLOCATION_FREE("FlywheelController::update");
+    const uint64_t now = pros::c::micros();
+    const FlywheelSettings settings = m_settings.read();
+    const double target = to_rpm(m_targetVelocity.read());
+    FlywheelState state = m_state.read();
+    state.target = from_rpm(target);
+    const EncoderSample sample = m_sample(m_target);
+    if (!sample.connected) {
+        // the fit starts over once the motors can be read again, so it doesn't span the gap. getSample sets errno
+        m_samples = 0;
+        m_reseed = true;
+        state.ready = false;
+        m_state.write(state);
+        return INT_MAX;
+    }
+    // the motors only measure their position every 10 ms, so a sample which was already used is skipped
+    const double time = to_sec(sample.timestamp);
+    if (m_samples == 0 || time > m_times[m_newest]) {
+        m_newest = (m_newest + 1) % MAX_SAMPLES;
+        m_times[m_newest] = time;
+        m_angles[m_newest] = to_stRot(sample.angle);
+        m_samples = std::min(m_samples + 1, MAX_SAMPLES);
+    }
+    const double velocity = fitVelocity(settings.velocitySamples);
+    state.velocity = from_rpm(velocity);
+
+    if (target == 0) {
+        m_reseed = true;
+        m_timingRecovery = false;
+        state.output = 0;
+        state.recovering = false;
+        state.ready = false;
+        m_state.write(state);
+        return m_move(m_target, 0);
+    }
+    // the controller works in the direction of the target, so a flywheel can spin either way
+    const double direction = target > 0 ? 1 : -1;
+    const double error = (target - velocity) * direction;
+    const double feedforward = std::clamp(settings.kS + settings.kV * target * direction, 0.0, 1.0);
+    // take back half starts over from the feedforward whenever the target or the settings change
+    if (m_reseed.exchange(false) || target != m_lastTarget) {
+        m_output = feedforward;
+        m_takeBack = feedforward;
+        m_lastError = error;
+        m_lastUpdate = 0;
+    }
+    m_lastTarget = target;
+    // the time since the last update is measured, so a late update doesn't throw off the integral
+    const double dt = m_lastUpdate == 0 ? 0 : (now - m_lastUpdate) / 1E6;
+    m_lastUpdate = now;
+
+    if (error > to_rpm(settings.recoveryThreshold)) {
+        if (!state.recovering) state.recoveries++;
+        if (!m_timingRecovery) m_recoveryStart = now;
+        m_timingRecovery = true;
+        state.recovering = true;
+        // once the flywheel is back near the target, take back half holds it from the feedforward
+        m_output = feedforward;
+        m_takeBack = feedforward;
+        state.output = 1;
+    } else {
+        state.recovering = false;
+        m_output = std::clamp(m_output + settings.kTBH * error * dt, 0.0, 1.0);
+        // the error crossed zero, so the output which holds the target is between this output and the last crossing
+        if ((error > 0) != (m_lastError > 0)) {
+            m_output = (m_output + m_takeBack) / 2;
+            m_takeBack = m_output;
+        }
+        state.output = m_output;
+    }
+    m_lastError = error;
+    state.ready = !state.recovering && std::abs(error) <= to_rpm(settings.readyTolerance);
+    if (state.ready && m_timingRecovery) {
+        state.lastRecovery = from_usec(now - m_recoveryStart);
+        m_timingRecovery = false;
+    }
+    state.output *= direction;
+    m_state.write(state);
+    return m_move(m_target, state.output);
+}
+} // namespace lemlib
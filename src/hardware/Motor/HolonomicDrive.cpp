@@ -0,0 +1,117 @@
+#include "hardware/Motor/HolonomicDrive.hpp"
+#include "hardware/AllocationTracker.hpp"
+#include "hardware/DeviceRegistry.hpp"
+#include "hardware/Probe.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <mutex>
+
+namespace lemlib {
+namespace {
+// the rows of the matrix, for the front left, front right, back left and back right wheels
+enum Wheel { FRONT_LEFT, FRONT_RIGHT, BACK_LEFT, BACK_RIGHT };
+} // namespace
+
+HolonomicDrive::HolonomicDrive(const std::initializer_list<ReversibleSmartPort>& frontLeftPorts,
+                               const std::initializer_list<ReversibleSmartPort>& frontRightPorts,
+                               const std::initializer_list<ReversibleSmartPort>& backLeftPorts,
+                               const std::initializer_list<ReversibleSmartPort>& backRightPorts,
+                               AngularVelocity outputVelocity, HolonomicGeometry geometry)
+    : m_wheels {MotorGroup(frontLeftPorts, outputVelocity), MotorGroup(frontRightPorts, outputVelocity),
+                MotorGroup(backLeftPorts, outputVelocity), MotorGroup(backRightPorts, outputVelocity)},
+      m_wheelRadius(to_m(geometry.wheelDiameter) / 2) {
+    m_maxVelocity = to_radps(outputVelocity) * m_wheelRadius;
+    const double halfTrack = to_m(geometry.trackWidth) / 2;
+    const double halfBase = to_m(geometry.wheelBase) / 2;
+    if (geometry.layout == HolonomicLayout::MECANUM) {
+        // the rollers push each wheel sideways as much as forwards, and turning moves every wheel by the sum of the
+        // distances to the center along both axes
+        const double lever = halfTrack + halfBase;
+        m_forward = {1, 1, 1, 1};
+        m_strafe = {-1, 1, 1, -1};
+        m_turn = {-lever, lever, -lever, lever};
+    } else {
+        // every wheel rolls along the diagonal, so it only sees the component of the velocity along it, and turning
+        // moves it by its distance to the center
+        const double lever = std::hypot(halfTrack, halfBase);
+        m_forward = {M_SQRT1_2, M_SQRT1_2, M_SQRT1_2, M_SQRT1_2};
+        m_strafe = {-M_SQRT1_2, M_SQRT1_2, M_SQRT1_2, -M_SQRT1_2};
+        m_turn = {-lever, lever, -lever, lever};
+    }
+}
+
+MotorGroup& HolonomicDrive::getFrontLeft() { return m_wheels[FRONT_LEFT]; }
+
+MotorGroup& HolonomicDrive::getFrontRight() { return m_wheels[FRONT_RIGHT]; }
+
+MotorGroup& HolonomicDrive::getBackLeft() { return m_wheels[BACK_LEFT]; }
+
+MotorGroup& HolonomicDrive::getBackRight() { return m_wheels[BACK_RIGHT]; }
+
+std::array<double, HolonomicDrive::WHEELS> HolonomicDrive::mix(double x, double y, double omega, double limit) const {
+    std::array<double, WHEELS> wheels;
+    for (size_t i = 0; i < WHEELS; i++) wheels[i] = m_forward[i] * x + m_strafe[i] * y + m_turn[i] * omega;
+    const double largest = std::max({std::abs(wheels[0]), std::abs(wheels[1]), std::abs(wheels[2]),
+                                     std::abs(wheels[3]), limit});
+    const double scale = limit / largest;
+    for (double& wheel : wheels) wheel *= scale;
+    return wheels;
+}
+
+HolonomicVelocities HolonomicDrive::inverseKinematics(units::V2Velocity velocity,
+                                                      AngularVelocity angularVelocity) const {
+    const std::array<double, WHEELS> wheels =
+        mix(to_mps(velocity.x), to_mps(velocity.y), to_radps(angularVelocity), m_maxVelocity);
+    return {.frontLeft = from_mps(wheels[FRONT_LEFT]),
+            .frontRight = from_mps(wheels[FRONT_RIGHT]),
+            .backLeft = from_mps(wheels[BACK_LEFT]),
+            .backRight = from_mps(wheels[BACK_RIGHT])};
+}
+
+template <typename Prepare> int32_t HolonomicDrive::dispatch(Prepare prepare) {
+    // every group is locked together, so this can never deadlock with another task locking them one at a time
+    std::scoped_lock lock(m_wheels[FRONT_LEFT].m_mutex, m_wheels[FRONT_RIGHT].m_mutex, m_wheels[BACK_LEFT].m_mutex,
+                          m_wheels[BACK_RIGHT].m_mutex);
+    // every wheel is checked against the same snapshot of the ports
+    const uint32_t plugged = DeviceRegistry::get().getPluggedPorts(pros::c::E_DEVICE_MOTOR);
+    for (size_t i = 0; i < WHEELS; i++) {
+        m_wheels[i].prepareCommands(plugged, [&](Motor& motor) { return prepare(i, motor); });
+    }
+    for (MotorGroup& wheel : m_wheels) Motor::sendCommands(wheel.m_commands);
+    // every wheel is finished, even if the first ones succeeded
+    bool success = false;
+    for (MotorGroup& wheel : m_wheels) success = wheel.finishCommands() || success;
+    // as long as one motor gets its command, return 0 (success)
+    return success ? 0 : INT_MAX;
+}
+
+int32_t HolonomicDrive::moveVelocity(units::V2Velocity velocity, AngularVelocity angularVelocity) {
+    return moveVelocity(inverseKinematics(velocity, angularVelocity));
+}
+
+int32_t HolonomicDrive::moveVelocity(HolonomicVelocities velocities) {
+    LEMLIB_PROBE("HolonomicDrive::moveVelocity");
+    LEMLIB_ALLOCATION_FREE("HolonomicDrive::moveVelocity");
+    const std::array<AngularVelocity, WHEELS> targets = {
+        from_radps(to_mps(velocities.frontLeft) / m_wheelRadius),
+        from_radps(to_mps(velocities.frontRight) / m_wheelRadius),
+        from_radps(to_mps(velocities.backLeft) / m_wheelRadius),
+        from_radps(to_mps(velocities.backRight) / m_wheelRadius)};
+    return dispatch([&](size_t wheel, Motor& motor) { return motor.prepareMoveVelocityImpl(targets[wheel]); });
+}
+
+int32_t HolonomicDrive::move(Number forward, Number strafe, Number turn) {
+    LEMLIB_PROBE("HolonomicDrive::move");
+    LEMLIB_ALLOCATION_FREE("HolonomicDrive::move");
+    // each input is scaled so that on its own, full power drives the wheels at full power
+    const std::array<double, WHEELS> powers =
+        mix(forward.internal() / m_forward[0], strafe.internal() / std::abs(m_strafe[0]),
+            turn.internal() / std::abs(m_turn[0]), 1);
+    return dispatch([&](size_t wheel, Motor& motor) { return motor.prepareMoveImpl(powers[wheel]); });
+}
+
+int32_t HolonomicDrive::brake() {
+    return dispatch([](size_t, Motor& motor) { return motor.prepareBrakeImpl(); });
+}
+} // namespace lemlib
@@ -1,28 +1,131 @@
 #include "hardware/Motor/Motor.hpp"
+#include "hardware/Battery.hpp"
+#include "hardware/Motor/CommandDispatcher.hpp"
 #include "hardware/Port.hpp"
+#include "hardware/SdkCallTracker.hpp"
 #include "hardware/util.hpp"
 #include "units/Angle.hpp"
 #include "pros/device.h"
 #include "pros/motors.h"
 #include "units/Temperature.hpp"
-#include "units/units.hpp"
+#include "units/Electrical.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
 #include <cstdint>
+#include <errno.h>
 #include <mutex>
 
 namespace lemlib {
+// motors are copied into every motor group, so their size is kept in check. The limit is the size on the host the
+// simulator runs on, where pointers are 8 bytes. On the brain they are 4, so a motor is always smaller there
+static_assert(sizeof(Motor) <= 400, "Motor grew. Keep its small members together so they aren't padded");
+
 Motor::Motor(ReversibleSmartPort port, AngularVelocity outputVelocity)
-    : m_port(port),
-      m_outputVelocity(outputVelocity) {}
+    : m_config({.port = port,
+                .outputVelocity = outputVelocity,
+                .tickScale = tickScale(outputVelocity),
+                .offset = 0_stDeg}),
+      m_state(&DeviceRegistry::get().getPortState(abs(port))),
+      m_claim(abs(port), pros::c::E_DEVICE_MOTOR),
+      m_readCache(m_state->reading) {}
+
+Motor::Motor(ReversibleSmartPort port, AngularVelocity outputVelocity, MotorType type)
+    : m_config({.port = port,
+                .outputVelocity = outputVelocity,
+                .tickScale = tickScale(outputVelocity),
+                .offset = 0_stDeg}),
+      m_state(&DeviceRegistry::get().getPortState(abs(port))),
+      m_fixedType(type),
+      m_claim(abs(port), pros::c::E_DEVICE_MOTOR),
+      m_readCache(m_state->reading) {}
 
 Motor::Motor(const Motor& other)
-    : m_port(other.m_port),
-      m_outputVelocity(other.m_outputVelocity),
-      m_offset(other.m_offset) {}
+    : m_config(other.m_config.read()),
+      m_state(other.m_state),
+      m_fixedType(other.m_fixedType),
+      m_commandCacheEnabled(other.m_commandCacheEnabled.load()),
+      m_commandPriority(other.m_commandPriority.load()),
+      m_compensationVoltage(other.m_compensationVoltage.load()),
+      m_powerTolerance(other.m_powerTolerance),
+      m_velocityTolerance(other.m_velocityTolerance),
+      m_refreshPeriod(other.m_refreshPeriod),
+      m_velocityFilter(other.m_velocityFilter),
+      m_claim(other.m_claim),
+      m_readCache(other.m_readCache),
+      m_ticks(other.m_ticks) {}
+
+Motor::Motor(Motor&& other) noexcept
+    : m_mutex(std::move(other.m_mutex)),
+      m_config(other.m_config.read()),
+      m_state(other.m_state),
+      m_fixedType(other.m_fixedType),
+      m_commandCacheEnabled(other.m_commandCacheEnabled.load()),
+      m_commandPriority(other.m_commandPriority.load()),
+      m_compensationVoltage(other.m_compensationVoltage.load()),
+      m_powerTolerance(other.m_powerTolerance),
+      m_velocityTolerance(other.m_velocityTolerance),
+      m_refreshPeriod(other.m_refreshPeriod),
+      m_velocityFilter(other.m_velocityFilter),
+      m_claim(other.m_claim),
+      m_readCache(other.m_readCache),
+      m_ticks(other.m_ticks) {}
+
+Motor& Motor::operator=(const Motor& other) {
+    if (this == &other) return *this;
+    std::lock_guard lock(m_mutex);
+    m_config.write(other.m_config.read());
+    m_state = other.m_state;
+    m_fixedType = other.m_fixedType;
+    m_velocityFilter = other.m_velocityFilter;
+    m_claim = other.m_claim;
+    m_powerTolerance = other.m_powerTolerance;
+    m_velocityTolerance = other.m_velocityTolerance;
+    m_refreshPeriod = other.m_refreshPeriod;
+    m_readCache = other.m_readCache;
+    m_ticks = other.m_ticks;
+    m_commandCacheEnabled = other.m_commandCacheEnabled.load();
+    m_commandPriority = other.m_commandPriority.load();
+    m_compensationVoltage = other.m_compensationVoltage.load();
+    m_motion.cancel();
+    return *this;
+}
 
+Motor& Motor::operator=(Motor&& other) noexcept {
+    if (this == &other) return *this;
+    m_mutex = std::move(other.m_mutex);
+    m_config.write(other.m_config.read());
+    m_state = other.m_state;
+    m_fixedType = other.m_fixedType;
+    m_velocityFilter = other.m_velocityFilter;
+    m_claim = other.m_claim;
+    m_powerTolerance = other.m_powerTolerance;
+    m_velocityTolerance = other.m_velocityTolerance;
+    m_refreshPeriod = other.m_refreshPeriod;
+    m_readCache = other.m_readCache;
+    m_ticks = other.m_ticks;
+    m_commandCacheEnabled = other.m_commandCacheEnabled.load();
+    m_commandPriority = other.m_commandPriority.load();
+    m_compensationVoltage = other.m_compensationVoltage.load();
+    m_motion.cancel();
+    return *this;
+}
+
+#ifndef LEMLIB_SIM
 Motor Motor::from_pros_motor(const pros::Motor motor, AngularVelocity outputVelocity) {
     return Motor {{motor.get_port(), runtime_check_port}, outputVelocity};
 }
 
+std::vector<Motor> Motor::from_pros_motors(std::span<const pros::Motor> motors, AngularVelocity outputVelocity) {
+    std::vector<Motor> result;
+    result.reserve(motors.size());
+    for (const pros::Motor& motor : motors) {
+        result.push_back(Motor {{motor.get_port(), runtime_check_port}, outputVelocity});
+    }
+    return result;
+}
+#endif
+
 pros::motor_brake_mode_e_t brakeModeToMotorBrake(BrakeMode mode) {
     // MotorBrake is identical to lemlib::BrakeMode, except for its name and lemlib uses an enum class for type
     // safety
@@ -45,173 +148,615 @@ BrakeMode motorBrakeToBrakeMode(pros::motor_brake_mode_e_t mode) {
     }
 }
 
+AngularVelocity gearsetToCartridge(pros::motor_gearset_e_t gearset) {
+    // pros uses an enum to represent the cartridge of the motor
+    switch (gearset) {
+        case (pros::E_MOTOR_GEARSET_06): return 600_rpm;
+        case (pros::E_MOTOR_GEARSET_18): return 200_rpm;
+        case (pros::E_MOTOR_GEARSET_36): return 100_rpm;
+        default: return 0_rpm;
+    }
+}
+
+void Motor::invalidateCache() const {
+    // a motor which reconnects has lost its last command too
+    m_state->invalidate();
+}
+
+namespace {
+// the kind of a cached command has the direction of the port it was sent through in its high bit, so an object on the
+// same port which is reversed the other way never skips a command because of it
+uint8_t commandKind(MotorCommand::Kind kind, ReversibleSmartPort port) {
+    return uint8_t(kind) | (port.is_reversed() ? 0x80 : 0);
+}
+
+// the cached position is shared by every object on the port, so it is read and cached in the forward direction, and
+// each object reverses it on its own
+int32_t reverseTicks(int32_t ticks, ReversibleSmartPort port) {
+    return ticks == INT_MAX || !port.is_reversed() ? ticks : -ticks;
+}
+
+// the motor rounds a reversed position the other way, so positions are always read forward and reversed here, like
+// getRaw does. Otherwise the offsets and velocity samples shared by every object on the port would mix both roundings
+int32_t readReversibleTicks(ReversibleSmartPort port, uint32_t* timestamp = nullptr) {
+    const ReversibleSmartPort forward = port.set_reversed(false);
+    return reverseTicks(LEMLIB_SDK_CALL(forward, pros::c::motor_get_raw_position(forward, timestamp)), port);
+}
+} // namespace
+
+bool Motor::skipCommand(Command command, int32_t value, int32_t tolerance) const {
+    if (!m_commandCacheEnabled.load(std::memory_order_relaxed)) return false;
+    const uint64_t last = m_state->command.load(std::memory_order_relaxed);
+    if (PortState::commandKind(last) != commandKind(command, m_config.read().port)) return false;
+    if (std::abs(value - PortState::commandValue(last)) > tolerance) return false;
+    // the command is sent again every refresh period, in case the motor didn't get it
+    return from_msec(pros::c::millis() - PortState::commandTime(last)) < Time(m_refreshPeriod);
+}
+
+void Motor::recordCommand(Command command, int32_t value, int32_t result) {
+    if (!m_commandCacheEnabled.load(std::memory_order_relaxed)) return;
+    // a failed command leaves the state of the motor unknown
+    const uint64_t packed =
+        result == 0 ? PortState::packCommand(commandKind(command, m_config.read().port), value, pros::c::millis()) : 0;
+    m_state->command.store(packed, std::memory_order_relaxed);
+}
+
+AngularVelocity Motor::getCartridge(ReversibleSmartPort port) const {
+    // the cartridge can't change while the motor is plugged in, so it only needs to be read once
+    const uint16_t cached = m_state->cartridge.load(std::memory_order_relaxed);
+    if (cached != 0) return from_rpm(cached);
+    const AngularVelocity cartridge =
+        gearsetToCartridge(LEMLIB_SDK_CALL(port, pros::c::motor_get_gearing(port)));
+    m_state->cartridge.store(std::round(to_rpm(cartridge)), std::memory_order_relaxed);
+    return cartridge;
+}
+
+// PROS counts 50 ticks per rotation of the motor before the cartridge, which spins at 3600 rpm. Dividing by 3600 rpm
+// here means converting ticks only takes a multiply by the output velocity when it is set, and by the scale when read
+constexpr auto TICK_SCALE_PER_VELOCITY = units::Scale(rot / 50) / 3600_rpm;
+
+units::Scale<Angle> Motor::tickScale(AngularVelocity outputVelocity) {
+    return TICK_SCALE_PER_VELOCITY * outputVelocity;
+}
+
 int32_t Motor::move(Number percent) {
+    MotorCommand command = prepareMove(percent);
+    sendCommands({&command, 1});
+    return finishCommand(command);
+}
+
+int32_t Motor::moveVelocity(AngularVelocity velocity) {
+    MotorCommand command = prepareMoveVelocity(velocity);
+    sendCommands({&command, 1});
+    return finishCommand(command);
+}
+
+int32_t Motor::brake() {
+    MotorCommand command = prepareBrake();
+    sendCommands({&command, 1});
+    return finishCommand(command);
+}
+
+MotionFuture Motor::moveToAngle(Angle angle, AngularVelocity velocity, MotionSettings settings) {
+    std::lock_guard lock(m_mutex);
+    return moveToAngleImpl(angle, velocity, settings);
+}
+
+MotionFuture Motor::moveToAngleImpl(Angle angle, AngularVelocity velocity, MotionSettings settings) {
+    const Config config = m_config.read();
+    MotionFuture future = m_motion.begin(angle, settings);
+    const AngularVelocity cartridge = getCartridge(config.port);
+    const int ticks = readReversibleTicks(config.port);
+    if (cartridge == 0_rpm || ticks == INT_MAX) {
+        m_motion.fail(future);
+        return future;
+    }
+    const int64_t count = m_ticks.update(ticks);
+    // in counts, the position of the motor is measured in the same raw ticks as getAngle. The target is sent relative
+    // to the current position, so it doesn't depend on where the motor was zeroed
+    const double target = (angle - config.offset).internal() / config.tickScale.factor();
+    const int32_t maxVelocity = std::abs(to_rpm(units::round(velocity * (cartridge / config.outputVelocity), rpm)));
+    const ReversibleSmartPort port = config.port;
+    if (!CommandDispatcher::get().claim(port, m_commandPriority.load(std::memory_order_relaxed))) {
+        m_motion.fail(future);
+        errno = EBUSY;
+        return future;
+    }
+    if (LEMLIB_SDK_CALL(port, pros::c::motor_set_encoder_units(port, pros::E_MOTOR_ENCODER_COUNTS)) == INT_MAX ||
+        LEMLIB_SDK_CALL(port, pros::c::motor_move_relative(port, std::round(target - count), maxVelocity)) == INT_MAX) {
+        m_motion.fail(future);
+        return future;
+    }
+    // the motor is no longer following the last command the cache knows about
+    m_state->command.store(0, std::memory_order_relaxed);
+    return future;
+}
+
+void Motor::updateMotion() {
+    if (!m_motion.isPending()) return;
+    m_motion.update(getAngle());
+}
+
+MotorCommand Motor::prepareMove(Number percent) {
+    std::lock_guard lock(m_mutex);
+    return prepareMoveImpl(percent);
+}
+
+MotorCommand Motor::prepareMoveImpl(Number percent) {
+    m_motion.cancel();
     // the V5 and EXP motors have different voltage caps, so we need to scale based on the motor type
     // V5 motors have their voltage capped at 12v, while EXP motors have their voltage capped at 7.2v
     // but they have the same max velocity, so we can scale the percent power based on the motor type
-    switch (getType()) {
-        case (MotorType::V5): return convertStatus(pros::c::motor_move_voltage(m_port, percent.internal() * 12000));
-        case (MotorType::EXP): return convertStatus(pros::c::motor_move_voltage(m_port, percent.internal() * 7200));
-        default: return INT_MAX;
+    double maxVoltage;
+    switch (getTypeImpl()) {
+        case (MotorType::V5): maxVoltage = 12000; break;
+        case (MotorType::EXP): maxVoltage = 7200; break;
+        default: return {};
     }
+    double voltage = percent.internal() * maxVoltage;
+    // compensation is read without the mutex, so motors which don't use it don't pay for it
+    const int32_t compensation = m_compensationVoltage.load(std::memory_order_relaxed);
+    if (compensation != 0) {
+        // the battery is shared by every motor, so its voltage is only read once per update period
+        const double battery = to_mvolt(Battery::get().getVoltage());
+        // if the battery can't be read, the command is sent uncompensated
+        if (std::isfinite(battery) && battery > 0) {
+            voltage = std::clamp(voltage * compensation / battery, -maxVoltage, maxVoltage);
+        }
+    }
+    MotorCommand command {.kind = Command::VOLTAGE,
+                          .port = m_config.read().port,
+                          .value = int32_t(voltage),
+                          .send = true,
+                          .priority = m_commandPriority.load(std::memory_order_relaxed)};
+    command.send = !skipCommand(command.kind, command.value, m_powerTolerance * maxVoltage);
+    return command;
 }
 
-int32_t Motor::moveVelocity(AngularVelocity velocity) {
+MotorCommand Motor::prepareMoveVelocity(AngularVelocity velocity) {
     std::lock_guard lock(m_mutex);
+    return prepareMoveVelocityImpl(velocity);
+}
+
+MotorCommand Motor::prepareMoveVelocityImpl(AngularVelocity velocity) {
+    m_motion.cancel();
+    const Config config = m_config.read();
+    const ReversibleSmartPort port = config.port;
     // vexos will behave differently depending on the cartridge of the motor
-    // pros uses an integer value to represent the rpm of the motor
-    const pros::motor_gearset_e_t mode = pros::c::motor_get_gearing(m_port);
-    AngularVelocity motorCartridge = 0_rpm;
-    switch (mode) {
-        case (pros::E_MOTOR_GEARSET_06): {
-            motorCartridge = 600_rpm;
-            break;
-        }
-        case (pros::E_MOTOR_GEARSET_18): {
-            motorCartridge = 200_rpm;
-            break;
+    const AngularVelocity cartridge = getCartridge(port);
+    if (cartridge == 0_rpm) return {};
+    const Number ratio = cartridge / config.outputVelocity;
+    MotorCommand command {.kind = Command::VELOCITY,
+                          .port = port,
+                          .value = int32_t(to_rpm(units::round(velocity * ratio, rpm))),
+                          .send = true,
+                          .priority = m_commandPriority.load(std::memory_order_relaxed)};
+    const int32_t tolerance = to_rpm(AngularVelocity(m_velocityTolerance) * ratio);
+    command.send = !skipCommand(command.kind, command.value, tolerance);
+    return command;
+}
+
+MotorCommand Motor::prepareBrake() {
+    // the mutex is only needed by the command cache, so motors which don't use it don't lock
+    if (!m_commandCacheEnabled.load(std::memory_order_relaxed)) {
+        m_motion.cancel();
+        return {.kind = Command::BRAKE,
+                .port = m_config.read().port,
+                .send = true,
+                .priority = m_commandPriority.load(std::memory_order_relaxed)};
+    }
+    std::lock_guard lock(m_mutex);
+    return prepareBrakeImpl();
+}
+
+MotorCommand Motor::prepareBrakeImpl() {
+    m_motion.cancel();
+    MotorCommand command {.kind = Command::BRAKE,
+                          .port = m_config.read().port,
+                          .send = true,
+                          .priority = m_commandPriority.load(std::memory_order_relaxed)};
+    command.send = !skipCommand(command.kind, 0, 0);
+    return command;
+}
+
+void Motor::sendCommands(std::span<MotorCommand> commands) {
+    CommandDispatcher& dispatcher = CommandDispatcher::get();
+    for (MotorCommand& command : commands) {
+        if (!command.send) continue;
+        const int8_t port = command.port;
+        // a command which loses the port is finished like a skipped one, so it doesn't touch the cached state
+        if (!dispatcher.claim(port, command.priority)) {
+            command.send = false;
+            command.dropped = true;
+            continue;
         }
-        case (pros::E_MOTOR_GEARSET_36): {
-            motorCartridge = 100_rpm;
-            break;
+        switch (command.kind) {
+            case (Command::VOLTAGE):
+                command.result = convertStatus(LEMLIB_SDK_CALL(port, pros::c::motor_move_voltage(port, command.value)));
+                break;
+            case (Command::VELOCITY):
+                command.result = convertStatus(LEMLIB_SDK_CALL(port, pros::c::motor_move_velocity(port, command.value)));
+                break;
+            case (Command::BRAKE): command.result = convertStatus(LEMLIB_SDK_CALL(port, pros::c::motor_brake(port))); break;
+            default: break;
         }
-        default: return INT_MAX;
     }
-    const int out = to_rpm(units::round(velocity * (motorCartridge / m_outputVelocity), rpm));
-    return convertStatus(pros::c::motor_move_velocity(m_port, out));
 }
 
-int32_t Motor::brake() {
+int32_t Motor::finishCommand(const MotorCommand& command) {
+    // commands which don't change the cached state are finished without the mutex
+    if (command.kind == Command::NONE || !command.send ||
+        (command.result == 0 && !m_commandCacheEnabled.load(std::memory_order_relaxed))) {
+        return finishCommandImpl(command);
+    }
     std::lock_guard lock(m_mutex);
-    return convertStatus(pros::c::motor_brake(m_port));
+    return finishCommandImpl(command);
+}
+
+int32_t Motor::finishCommandImpl(const MotorCommand& command) {
+    // commands which could not be prepared have already set errno
+    if (command.kind == Command::NONE) return INT_MAX;
+    if (command.dropped) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    if (!command.send) return 0;
+    if (command.result == 0 && !m_commandCacheEnabled.load(std::memory_order_relaxed)) return 0;
+    // if the motor could not be moved, it was most likely unplugged, and could be replaced by a different type of
+    // motor. So the motor type and cartridge need to be detected again
+    if (command.result != 0) invalidateCache();
+    recordCommand(command.kind, command.value, command.result);
+    return command.result;
 }
 
 int32_t Motor::setBrakeMode(BrakeMode mode) {
-    std::lock_guard lock(m_mutex);
     if (mode == BrakeMode::INVALID) {
         errno = EINVAL;
         return INT_MAX;
     }
-    return convertStatus(pros::c::motor_set_brake_mode(m_port, brakeModeToMotorBrake(mode)));
+    const ReversibleSmartPort port = m_config.read().port;
+    return convertStatus(LEMLIB_SDK_CALL(port, pros::c::motor_set_brake_mode(port, brakeModeToMotorBrake(mode))));
 }
 
 BrakeMode Motor::getBrakeMode() const {
-    std::lock_guard lock(m_mutex);
-    return motorBrakeToBrakeMode(pros::c::motor_get_brake_mode(m_port));
+    const ReversibleSmartPort port = m_config.read().port;
+    return motorBrakeToBrakeMode(LEMLIB_SDK_CALL(port, pros::c::motor_get_brake_mode(port)));
 }
 
 int32_t Motor::isConnected() const {
-    return pros::c::get_plugged_type(abs(m_port)) == pros::c::v5_device_e_t::E_DEVICE_MOTOR;
+    return isConnectedImpl();
 }
 
-Angle Motor::getAngle() const {
-    std::lock_guard lock(m_mutex);
-    // get the number of encoder ticks
-    const int ticks = pros::c::motor_get_raw_position(m_port, NULL);
+int32_t Motor::isConnectedImpl() const {
+    const bool connected = DeviceRegistry::get().isPlugged(abs(m_config.read().port), pros::c::E_DEVICE_MOTOR);
+    // a different type of motor may be plugged in when the motor reconnects, so the motor type is detected again
+    if (!connected) invalidateCache();
+    return connected;
+}
+
+Angle Motor::getAngle() const { return ticksToAngle(readTicks()); }
+
+Result<Angle> Motor::tryGetAngle() const {
+    const int32_t ticks = readTicks();
+    if (ticks == INT_MAX) [[unlikely]]
+        return Result<Angle>::failure(errno);
+    return ticksToAngle(ticks);
+}
+
+int32_t Motor::readTicks() const { return getRaw().value; }
+
+RawReading Motor::getRaw() const {
+    const ReversibleSmartPort port = m_config.read().port;
+    // the ticks may be cached, as the motor only measures its position every 10 ms. The motor reports when it measured
+    // them, in milliseconds, which is kept instead of the time of the call
+    RawReading reading = m_readCache.getSample([&](uint32_t& timestamp) {
+        const ReversibleSmartPort forward = port.set_reversed(false);
+        uint32_t measured = 0;
+        const int32_t ticks = LEMLIB_SDK_CALL(forward, pros::c::motor_get_raw_position(forward, &measured));
+        timestamp = measured * 1000;
+        return ticks;
+    });
+    reading.value = reverseTicks(reading.value, port);
+    return reading;
+}
+
+EncoderSample Motor::getSample() const {
+    const RawReading reading = getRaw();
+    return {.timestamp = from_usec(reading.timestamp),
+            .angle = ticksToAngle(reading.value),
+            .connected = reading.value != INT_MAX};
+}
+
+EncoderPosition Motor::getPosition() const {
+    const RawReading reading = getRaw();
+    const Config config = m_config.read();
+    if (reading.value == INT_MAX) return EncoderPosition(reading, config.tickScale, config.offset);
+    // the offset is relative to the extended position, so the wraparounds of the raw position are moved into it
+    const int64_t wraps = m_ticks.update(reading.value) - reading.value;
+    return EncoderPosition(reading, config.tickScale, config.offset + config.tickScale(wraps));
+}
+
+Angle Motor::ticksToAngle(int32_t ticks) const {
     if (ticks == INT_MAX) return from_stRot(INFINITY);
-    // get the number of times the motor rotated
-    const Angle raw = from_stRot(ticks / 50.0);
-    // calculate position after using the gear ratio
-    const Angle position = raw * (m_outputVelocity / 3600_rpm);
-    // return position + offset
-    return position + m_offset;
+    // the config is read once, so the offset always matches the output velocity it was calculated with
+    const Config config = m_config.read();
+    // return position + offset. The scale already includes the cartridge and the output velocity, so this is a single
+    // multiply-add. The motor isn't configured to report its position in other encoder units instead, as the SDK
+    // converts them from the same ticks with a division, and moveToAngle needs the motor to use counts. The
+    // "motor_get_raw_position" and "motor_get_position (rotations)" benchmarks compare the two reads
+    return config.tickScale(m_ticks.update(ticks)) + config.offset;
 }
 
 int32_t Motor::setAngle(Angle angle) {
     std::lock_guard lock(m_mutex);
-    // get the raw position
-    const int ticks = pros::c::motor_get_raw_position(m_port, NULL);
+    return setAngleImpl(angle);
+}
+
+int32_t Motor::setAngleImpl(Angle angle) { return setAngleAtTicks(angle, readTicksUncached()); }
+
+int32_t Motor::readTicksUncached() const { return readReversibleTicks(m_config.read().port); }
+
+int32_t Motor::setAngleAtTicks(Angle angle, int32_t ticks) {
     if (ticks == INT_MAX) return INT_MAX;
-    // get the number of times the internal motor rotated
-    const Angle raw = from_stRot(ticks / 50.0);
-    // calculate position after using the gear ratio
-    const Angle position = raw * (m_outputVelocity / 3600_rpm);
+    Config config = m_config.read();
     // calculate offset
-    m_offset = angle - position;
+    config.offset = angle - config.tickScale(m_ticks.update(ticks));
+    m_config.write(config);
     return 0;
 }
 
-Angle Motor::getOffset() const {
-    std::lock_guard lock(m_mutex);
-    return m_offset;
-}
-
 int32_t Motor::setOffset(Angle offset) {
     std::lock_guard lock(m_mutex);
-    m_offset = offset;
+    Config config = m_config.read();
+    config.offset = offset;
+    m_config.write(config);
     return 0;
 }
 
 MotorType Motor::getType() const {
     std::lock_guard lock(m_mutex);
+    return getTypeImpl();
+}
+
+int32_t Motor::startInitialization() { return getType() == MotorType::INVALID ? INT_MAX : 0; }
+
+MotorType Motor::getTypeImpl() const {
+    if (m_fixedType != MotorType::INVALID) return m_fixedType;
+    // the type of the motor can't change unless it is unplugged, so we only need to detect it once per port
+    const uint8_t cached = m_state->motorType.load(std::memory_order_relaxed);
+    if (cached != PortState::UNKNOWN_TYPE) return MotorType(cached);
+    const ReversibleSmartPort port = m_config.read().port;
     // there is no exposed api to get the motor type
     // while the memory address of the function has been found through reverse engineering,
     // it may break between VEXos updates. Instead, we see if we can change the cartridge to something other
     // than the green cartridge, which is only possible on the V5 motor
-    const pros::motor_gearset_e_t oldCart = pros::c::motor_get_gearing(m_port);
-    const int result = pros::c::motor_set_gearing(m_port, pros::motor_gearset_e_t::E_MOTOR_GEAR_RED);
+    const pros::motor_gearset_e_t oldCart = LEMLIB_SDK_CALL(port, pros::c::motor_get_gearing(port));
+    const int result =
+        LEMLIB_SDK_CALL(port, pros::c::motor_set_gearing(port, pros::motor_gearset_e_t::E_MOTOR_GEAR_RED));
     // check for errors
     if (oldCart == pros::motor_gearset_e_t::E_MOTOR_GEARSET_INVALID) return MotorType::INVALID;
     if (result == INT_MAX) return MotorType::INVALID;
+    // save the cartridge while we know it, so moveVelocity doesn't have to read it again
+    m_state->cartridge.store(std::round(to_rpm(gearsetToCartridge(oldCart))), std::memory_order_relaxed);
     // check if the gearing changed or not
-    const pros::motor_gearset_e_t newCart = pros::c::motor_get_gearing(m_port);
+    const pros::motor_gearset_e_t newCart = LEMLIB_SDK_CALL(port, pros::c::motor_get_gearing(port));
     if (newCart == pros::motor_gearset_e_t::E_MOTOR_GEARSET_INVALID) return MotorType::INVALID;
     if (newCart != pros::motor_gearset_e_t::E_MOTOR_GEAR_GREEN) {
         // set the cartridge back to its original value
-        if (pros::c::motor_set_gearing(m_port, oldCart) == INT_MAX) return MotorType::INVALID;
-        else return MotorType::V5;
-    } else return MotorType::EXP;
-}
-
-int32_t Motor::isReversed() const {
-    std::lock_guard lock(m_mutex);
-    // technically this returns an int, but as long as you only pass 0 to the index its impossible for it to return an
-    // error. This is because we keep track of whether the motor is reversed or not through the sign of its port
-    return m_port < 0;
+        if (LEMLIB_SDK_CALL(port, pros::c::motor_set_gearing(port, oldCart)) == INT_MAX) return MotorType::INVALID;
+        m_state->motorType.store(uint8_t(MotorType::V5), std::memory_order_relaxed);
+        return MotorType::V5;
+    }
+    m_state->motorType.store(uint8_t(MotorType::EXP), std::memory_order_relaxed);
+    return MotorType::EXP;
 }
 
 int32_t Motor::setReversed(bool reversed) {
     std::lock_guard lock(m_mutex);
     // technically this returns an int, but as long as you only pass 0 to the index its impossible for it to return an
     // error. This is because we keep track of whether the motor is reversed or not through the sign of its port
-    m_port = m_port.set_reversed(reversed);
+    Config config = m_config.read();
+    config.port = config.port.set_reversed(reversed);
+    m_config.write(config);
+    // the physical direction of the next command changes even if its value doesn't, so it is always sent. Cached
+    // positions are read forward, so they don't have to be discarded
+    m_state->command.store(0, std::memory_order_relaxed);
     return 0;
 }
 
-ReversibleSmartPort Motor::getPort() const {
-    std::lock_guard lock(m_mutex);
-    return m_port;
-}
-
 Current Motor::getCurrentLimit() const {
-    std::lock_guard lock(m_mutex);
-    const Current result = from_amp(pros::c::motor_get_current_limit(m_port));
+    const ReversibleSmartPort port = m_config.read().port;
+    const Current result = from_amp(LEMLIB_SDK_CALL(port, pros::c::motor_get_current_limit(port)));
     if (result.internal() == INT32_MAX) return from_amp(INFINITY); // error checking
     return result;
 }
 
 int32_t Motor::setCurrentLimit(Current limit) {
-    std::lock_guard lock(m_mutex);
-    return pros::c::motor_set_current_limit(m_port, to_amp(limit) * 1000);
+    const ReversibleSmartPort port = m_config.read().port;
+    return LEMLIB_SDK_CALL(port, pros::c::motor_set_current_limit(port, to_amp(limit) * 1000));
 }
 
 Temperature Motor::getTemperature() const {
-    const Temperature result = units::from_celsius(pros::c::motor_get_temperature(m_port));
+    const ReversibleSmartPort port = m_config.read().port;
+    const Temperature result = units::from_celsius(LEMLIB_SDK_CALL(port, pros::c::motor_get_temperature(port)));
     if (result.internal() == INFINITY) return result; // error checking
     return result;
 }
 
+Current Motor::getCurrent() const {
+    const ReversibleSmartPort port = m_config.read().port;
+    const int32_t current = LEMLIB_SDK_CALL(port, pros::c::motor_get_current_draw(port));
+    if (current == INT_MAX) return from_amp(INFINITY); // error checking
+    return from_amp(current / 1000.0);
+}
+
 // Always returns 0 because the velocity setter is not dependent on hardware and should never fail
 int32_t Motor::setOutputVelocity(AngularVelocity outputVelocity) {
     std::lock_guard lock(m_mutex);
-    Angle angle = getAngle();
-    m_outputVelocity = outputVelocity;
-    setAngle(angle);
+    return setOutputVelocityImpl(outputVelocity);
+}
+
+int32_t Motor::setOutputVelocityImpl(AngularVelocity outputVelocity) {
+    Config config = m_config.read();
+    // the offset is recalculated so the angle stays the same, and published together with the new output velocity
+    // so readers never combine the new velocity with the old offset. The angle can't be preserved if the motor is
+    // not connected
+    const int ticks = readReversibleTicks(config.port);
+    if (ticks != INT_MAX) {
+        const int64_t count = m_ticks.update(ticks);
+        const Angle angle = config.tickScale(count) + config.offset;
+        config.offset = angle - tickScale(outputVelocity)(count);
+    }
+    // the filtered positions don't include the offset, so they only have to be scaled to the new output velocity
+    m_velocityFilter.rescale(outputVelocity / config.outputVelocity);
+    config.outputVelocity = outputVelocity;
+    config.tickScale = tickScale(outputVelocity);
+    m_config.write(config);
     return 0;
 }
 
-AngularVelocity Motor::getOutputVelocity() const {
+int32_t Motor::updateVelocityFilter() const {
+    const Config config = m_config.read();
+    // the timestamp is when the motor measured the position, so readings which weren't updated yet are ignored
+    uint32_t timestamp = 0;
+    const int ticks = readReversibleTicks(config.port, &timestamp);
+    if (ticks == INT_MAX) {
+        // the motor was most likely unplugged, so the old estimates don't say anything about it when it reconnects
+        m_velocityFilter.reset();
+        invalidateCache();
+        return INT_MAX;
+    }
+    m_velocityFilter.update(from_msec(timestamp), config.tickScale(m_ticks.update(ticks)));
+    return 0;
+}
+
+AngularVelocity Motor::getVelocity() const {
+    std::lock_guard lock(m_mutex);
+    return getVelocityImpl();
+}
+
+AngularVelocity Motor::getVelocityImpl() const {
+    if (updateVelocityFilter() != 0) return from_rpm(INFINITY);
+    return m_velocityFilter.getVelocity();
+}
+
+AngularAcceleration Motor::getAcceleration() const {
     std::lock_guard lock(m_mutex);
-    return m_outputVelocity;
+    return getAccelerationImpl();
+}
+
+AngularAcceleration Motor::getAccelerationImpl() const {
+    if (updateVelocityFilter() != 0) return from_rps2(INFINITY);
+    return m_velocityFilter.getAcceleration();
+}
+
+int32_t Motor::setVelocityFilter(AlphaBetaGains gains) {
+    std::lock_guard lock(m_mutex);
+    return setVelocityFilterImpl(gains);
+}
+
+int32_t Motor::setVelocityFilterImpl(AlphaBetaGains gains) {
+    m_velocityFilter.setGains(gains);
+    return 0;
+}
+
+AlphaBetaGains Motor::getVelocityFilter() const {
+    std::lock_guard lock(m_mutex);
+    return m_velocityFilter.getGains();
+}
+
+int32_t Motor::setCommandCache(CommandCacheSettings settings) {
+    std::lock_guard lock(m_mutex);
+    return setCommandCacheImpl(settings);
+}
+
+int32_t Motor::setCommandCacheImpl(CommandCacheSettings settings) {
+    m_powerTolerance = settings.powerTolerance.internal();
+    m_velocityTolerance = settings.velocityTolerance.internal();
+    m_refreshPeriod = settings.refreshPeriod.internal();
+    m_commandCacheEnabled = settings.enabled;
+    // the next command is always sent, so the cache starts from a command the motor is known to have
+    m_state->command.store(0, std::memory_order_relaxed);
+    return 0;
+}
+
+CommandCacheSettings Motor::getCommandCache() const {
+    std::lock_guard lock(m_mutex);
+    return getCommandCacheImpl();
+}
+
+CommandCacheSettings Motor::getCommandCacheImpl() const {
+    return {.enabled = m_commandCacheEnabled.load(),
+            .powerTolerance = m_powerTolerance,
+            .velocityTolerance = AngularVelocity(m_velocityTolerance),
+            .refreshPeriod = Time(m_refreshPeriod)};
+}
+
+int32_t Motor::setCommandPriority(uint8_t priority) {
+    const uint8_t previous = m_commandPriority.exchange(priority, std::memory_order_relaxed);
+    // the port isn't held at a priority this object no longer commands with
+    if (previous != priority) CommandDispatcher::get().release(m_config.read().port, previous);
+    return 0;
+}
+
+uint8_t Motor::getCommandPriority() const { return m_commandPriority.load(std::memory_order_relaxed); }
+
+int32_t Motor::releaseCommands() {
+    CommandDispatcher::get().release(m_config.read().port, m_commandPriority.load(std::memory_order_relaxed));
+    return 0;
+}
+
+int32_t Motor::setReadCacheWindow(Time window) {
+    m_readCache.setWindow(window);
+    return 0;
+}
+
+Time Motor::getReadCacheWindow() const { return m_readCache.getWindow(); }
+
+int32_t Motor::setVoltageCompensation(Voltage nominal) {
+    if (!(nominal >= 0_volt) || nominal.internal() == INFINITY) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    m_compensationVoltage = std::round(to_mvolt(nominal));
+    return 0;
+}
+
+Voltage Motor::getVoltageCompensation() const { return from_mvolt(m_compensationVoltage.load()); }
+
+MotorTelemetry Motor::getTelemetry() const {
+    std::lock_guard lock(m_mutex);
+    return getTelemetryImpl();
+}
+
+MotorTelemetry Motor::getTelemetryImpl() const {
+    const Config config = m_config.read();
+    const ReversibleSmartPort port = config.port;
+    MotorTelemetry telemetry;
+    telemetry.timestamp = from_usec(pros::micros());
+    // angle
+    const int ticks = readReversibleTicks(port);
+    telemetry.angle =
+        ticks == INT_MAX ? from_stRot(INFINITY) : config.tickScale(m_ticks.update(ticks)) + config.offset;
+    // velocity. PROS reports the velocity of the motor before the output gearing, in terms of the cartridge
+    const AngularVelocity cartridge = getCartridge(port);
+    const double rpm = LEMLIB_SDK_CALL(port, pros::c::motor_get_actual_velocity(port));
+    if (rpm == INFINITY || cartridge == 0_rpm) telemetry.velocity = from_rpm(INFINITY);
+    else telemetry.velocity = from_rpm(rpm) / (cartridge / config.outputVelocity);
+    // current
+    const int32_t current = LEMLIB_SDK_CALL(port, pros::c::motor_get_current_draw(port));
+    telemetry.current = current == INT_MAX ? from_amp(INFINITY) : from_amp(current / 1000.0);
+    // power, torque and efficiency. PROS reports the efficiency as a percentage
+    telemetry.power = from_watt(LEMLIB_SDK_CALL(port, pros::c::motor_get_power(port)));
+    telemetry.torque = from_Nm(LEMLIB_SDK_CALL(port, pros::c::motor_get_torque(port)));
+    const double efficiency = LEMLIB_SDK_CALL(port, pros::c::motor_get_efficiency(port));
+    telemetry.efficiency = efficiency == INFINITY ? efficiency : efficiency / 100;
+    // temperature
+    telemetry.temperature = units::from_celsius(LEMLIB_SDK_CALL(port, pros::c::motor_get_temperature(port)));
+    // brake mode
+    telemetry.brakeMode = motorBrakeToBrakeMode(LEMLIB_SDK_CALL(port, pros::c::motor_get_brake_mode(port)));
+    // if nothing could be read, the motor was most likely unplugged
+    if (ticks == INT_MAX) invalidateCache();
+    return telemetry;
 }
-} // namespace lemlib
\ No newline at end of file
+} // namespace lemlib
@@ -1,332 +1,1004 @@
 #include "hardware/Motor/MotorGroup.hpp"
+#include "hardware/AllocationTracker.hpp"
+#include "hardware/BootTrace.hpp"
 #include "hardware/Port.hpp"
+#include "hardware/Probe.hpp"
+#include "hardware/Trace.hpp"
 #include "hardware/Motor/Motor.hpp"
 #include "units/Angle.hpp"
 #include "units/Temperature.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <climits>
 #include <cmath>
 #include <cstdint>
 #include <errno.h>
 #include <mutex>
+#include <vector>
 
 namespace lemlib {
+namespace {
+/**
+ * @brief Every motor group, so the maintenance task can find the motors it needs to configure
+ *
+ * The maintenance task locks the mutex while it uses motor groups, and motor groups lock it to add and remove
+ * themselves, so a motor group can't be destroyed while the task is using it
+ */
+struct MaintenanceRegistry {
+        pros::Mutex mutex;
+        std::vector<MotorGroup*> groups;
+        std::atomic<bool> taskStarted = false;
+};
+
+MaintenanceRegistry& getMaintenanceRegistry() {
+    // constructed on first use, so motor groups can be constructed in other global constructors
+    static MaintenanceRegistry registry;
+    return registry;
+}
+
+void registerGroup(MotorGroup* group) {
+    MaintenanceRegistry& registry = getMaintenanceRegistry();
+    std::lock_guard lock(registry.mutex);
+    registry.groups.push_back(group);
+}
+
+/**
+ * @brief Combine the angles of the working motors of a group
+ *
+ * @param angles the angles, which are reordered to find the median. There must be at least one
+ * @param aggregate how the angles are combined
+ * @return Angle the combined angle
+ */
+Angle aggregateAngles(std::span<Angle> angles, AngleAggregate aggregate) {
+    if (aggregate == AngleAggregate::MEDIAN) {
+        // nth_element only partially sorts the angles, so this is O(n)
+        const auto middle = angles.begin() + angles.size() / 2;
+        std::nth_element(angles.begin(), middle, angles.end());
+        if (angles.size() % 2 == 1) return *middle;
+        // with an even number of angles, the median is halfway between the two middle ones
+        return (*std::max_element(angles.begin(), middle) + *middle) / 2;
+    }
+    Angle total = 0_stDeg;
+    for (const Angle angle : angles) total += angle;
+    return total / angles.size();
+}
+
+// the bit of a motor in the flags of a group
+constexpr std::uint8_t bitOf(std::size_t index) { return std::uint8_t(1u << index); }
+
+// remove the bit of a motor from flags, moving the bits of the motors after it down, like the motors themselves
+constexpr std::uint8_t removeBit(std::uint8_t flags, std::size_t index) {
+    const std::uint8_t below = bitOf(index) - 1;
+    return (flags & below) | ((flags >> 1) & ~below);
+}
+
+// the layout of MotorGroup::m_summary. Ports are stored as bits from port 1, like the masks of the DeviceRegistry
+constexpr int SUMMARY_PLUGGED_SHIFT = 22;
+constexpr int SUMMARY_COUNTED_SHIFT = 44;
+constexpr uint64_t SUMMARY_PORTS = (uint64_t(1) << SUMMARY_PLUGGED_SHIFT) - 1;
+constexpr uint64_t SUMMARY_VALID = uint64_t(1) << 63;
+
+// the number of motors a summary counted, or -1 if it is invalid, or a motor of the group was plugged in or unplugged
+// since it was published
+int32_t summarizedSize(uint64_t summary, uint32_t plugged) {
+    if (!(summary & SUMMARY_VALID)) return -1;
+    const uint64_t ports = summary & SUMMARY_PORTS;
+    if (((summary >> SUMMARY_PLUGGED_SHIFT) & SUMMARY_PORTS) != (plugged & ports)) return -1;
+    return std::popcount(std::uint8_t(summary >> SUMMARY_COUNTED_SHIFT));
+}
+
+/**
+ * @brief Read a value of every connected motor into a buffer
+ *
+ * @param motors the connected motors
+ * @param buffer the buffer to write to. Only as many motors as fit in it are read
+ * @param read the function which reads the value of a motor
+ * @return int32_t the number of motors written to the buffer
+ */
+template <typename T, typename Read>
+int32_t readEach(const StaticVector<Motor*, MotorGroup::MAX_MOTORS>& motors, std::span<T> buffer, Read read) {
+    const size_t count = std::min(motors.size(), buffer.size());
+    for (size_t i = 0; i < count; i++) buffer[i] = read(*motors[i]);
+    return count;
+}
+} // namespace
+
 MotorGroup::MotorGroup(const std::initializer_list<ReversibleSmartPort>& ports, AngularVelocity outputVelocity)
-    : m_outputVelocity(outputVelocity) {
-    for (const auto port : ports) { m_motors.push_back({.port = port, .connectedLastCycle = true, .offset = 0_stDeg}); }
+    : m_settings(Settings {.outputVelocity = outputVelocity,
+                           .velocityFilterGains = AlphaBetaGains(),
+                           .commandCache = CommandCacheSettings(),
+                           .slewLimits = SlewLimits(),
+                           .loadBalance = LoadBalanceSettings()}) {
+    for (const auto port : ports) {
+        if (m_state.motors.full()) break;
+        appendMotor(Motor(port, outputVelocity), true);
+    }
+    registerGroup(this);
 }
 
 MotorGroup::MotorGroup(const MotorGroup& other)
-    : m_brakeMode(other.getBrakeMode()),
-      m_outputVelocity(other.getOutputVelocity()),
-      m_motors(other.getMotorInfo()) {}
+    : m_settings(other.m_settings.read()),
+      m_state(other.getMotorStates()) {
+    registerGroup(this);
+}
 
+MotorGroup::~MotorGroup() {
+    MaintenanceRegistry& registry = getMaintenanceRegistry();
+    std::lock_guard lock(registry.mutex);
+    std::erase(registry.groups, this);
+}
+
+#ifndef LEMLIB_SIM
 MotorGroup MotorGroup::from_pros_group(pros::MotorGroup group, AngularVelocity outputVelocity) {
     MotorGroup motor_group {{}, outputVelocity};
-    const std::vector<std::int8_t> ports = group.get_port_all();
-    for (const int port : ports) {
-        motor_group.m_motors.push_back(
-            {.port = ReversibleSmartPort {port, runtime_check_port}, .connectedLastCycle = true, .offset = 0_stDeg});
+    // the ports are read one at a time, so no vector of ports is allocated
+    const int count = group.size();
+    for (int i = 0; i < count && !motor_group.m_state.motors.full(); i++) {
+        const ReversibleSmartPort port {group.get_port(i), runtime_check_port};
+        motor_group.appendMotor(Motor(port, outputVelocity), true);
     }
     return motor_group;
 }
+#endif
 
-int32_t MotorGroup::move(Number percent) {
-    std::lock_guard lock(m_mutex);
-    const std::vector<Motor> motors = getMotors();
+template <typename Prepare> int32_t MotorGroup::dispatch(Prepare prepare) {
+    prepareCommands(DeviceRegistry::get().getPluggedPorts(pros::c::E_DEVICE_MOTOR), prepare);
+    Motor::sendCommands(m_commands);
+    // as long as one motor gets its command, return 0 (success)
+    return finishCommands() ? 0 : INT_MAX;
+}
+
+bool MotorGroup::finishCommands() {
+    // m_connectedMotors is in the same order as m_commands, as they were filled together
     bool success = false;
-    for (Motor motor : motors) {
-        const int result = motor.move(percent);
-        if (result == 0) success = true;
+    for (std::size_t i = 0; i < m_commands.size(); i++) {
+        if (m_connectedMotors[i]->finishCommandImpl(m_commands[i]) == 0) success = true;
     }
-    // as long as one motor moves successfully, return 0 (success)
-    return success ? 0 : INT_MAX;
+    return success;
+}
+
+double MotorGroup::slew(double target, const SlewLimits& limits) {
+    const double dt = to_sec(limits.period);
+    const double maxAcceleration = to_mps2(limits.maxAcceleration);
+    const double maxJerk = to_mps3(limits.maxJerk);
+    const double error = target - m_slewVelocity;
+    // invalid targets are left for the motors to reject
+    if (!std::isfinite(target)) return target;
+    if (error == 0) {
+        m_slewAcceleration = 0;
+        return target;
+    }
+    // the acceleration which can still be brought back to 0 by the time the velocity reaches the target, so it
+    // doesn't overshoot. It is never more than it takes to reach the target within this step
+    const double desired = std::copysign(
+        std::min({maxAcceleration, std::sqrt(2 * maxJerk * std::abs(error)), std::abs(error) / dt}), error);
+    m_slewAcceleration = std::clamp(desired, m_slewAcceleration - maxJerk * dt, m_slewAcceleration + maxJerk * dt);
+    const double velocity = m_slewVelocity + m_slewAcceleration * dt;
+    // the acceleration from before the target moved closer can carry the velocity past it
+    if ((target - velocity) * error <= 0) {
+        m_slewVelocity = target;
+        m_slewAcceleration = 0;
+    } else {
+        m_slewVelocity = velocity;
+    }
+    return m_slewVelocity;
+}
+
+int32_t MotorGroup::move(Number percent) {
+    LEMLIB_PROBE("MotorGroup::move");
+    LEMLIB_TRACE_SCOPE("MotorGroup::move");
+    LEMLIB_ALLOCATION_FREE("MotorGroup::move");
+    std::lock_guard lock(m_mutex);
+    m_motion.cancel();
+    const Settings settings = m_settings.read();
+    // the limiter runs on the velocity of the wheel, so power and velocity commands share the same state
+    const double scale = to_radps(settings.outputVelocity) * to_m(settings.slewLimits.wheelDiameter) / 2;
+    if (scale > 0) percent = slew(percent.internal() * scale, settings.slewLimits) / scale;
+    if (!settings.loadBalance.enabled) return dispatch([&](Motor& motor) { return motor.prepareMoveImpl(percent); });
+    return dispatch([&](Motor& motor) {
+        const double trim = m_state.loadTrims[&motor - m_state.motors.data()];
+        return motor.prepareMoveImpl(std::clamp(percent.internal() * trim, -1.0, 1.0));
+    });
 }
 
 int32_t MotorGroup::moveVelocity(AngularVelocity velocity) {
+    LEMLIB_PROBE("MotorGroup::moveVelocity");
+    LEMLIB_TRACE_SCOPE("MotorGroup::moveVelocity");
+    LEMLIB_ALLOCATION_FREE("MotorGroup::moveVelocity");
     std::lock_guard lock(m_mutex);
-    const std::vector<Motor> motors = getMotors();
-    bool success = false;
-    for (Motor motor : motors) {
-        const int result = motor.moveVelocity(velocity);
-        if (result == 0) success = true;
-    }
-    // as long as one motor moves successfully, return 0 (success)
-    return success ? 0 : INT_MAX;
+    m_motion.cancel();
+    const SlewLimits limits = m_settings.read().slewLimits;
+    const double radius = to_m(limits.wheelDiameter) / 2;
+    if (radius > 0) velocity = from_radps(slew(to_radps(velocity) * radius, limits) / radius);
+    return dispatch([&](Motor& motor) { return motor.prepareMoveVelocityImpl(velocity); });
 }
 
 int32_t MotorGroup::brake() {
+    LEMLIB_PROBE("MotorGroup::brake");
+    LEMLIB_TRACE_SCOPE("MotorGroup::brake");
+    LEMLIB_ALLOCATION_FREE("MotorGroup::brake");
     std::lock_guard lock(m_mutex);
-    const std::vector<Motor> motors = getMotors();
-    bool success = false;
-    for (Motor motor : motors) {
-        const int result = motor.brake();
-        if (result == 0) success = true;
+    m_motion.cancel();
+    m_slewVelocity = 0;
+    m_slewAcceleration = 0;
+    return dispatch([](Motor& motor) { return motor.prepareBrakeImpl(); });
+}
+
+MotionFuture MotorGroup::moveToAngle(Angle angle, AngularVelocity velocity, MotionSettings settings) {
+    std::lock_guard lock(m_mutex);
+    m_slewVelocity = 0;
+    m_slewAcceleration = 0;
+    MotionFuture future = m_motion.begin(angle, settings);
+    // every motor is configured to measure the angle of the group, so they all move to the same angle
+    bool started = false;
+    for (Motor* motor : getMotors()) {
+        if (motor->moveToAngleImpl(angle, velocity, MotionSettings()).getState() != MotionState::FAILED) started = true;
     }
-    // as long as one motor brakes successfully, return 0 (success)
-    return success ? 0 : INT_MAX;
+    if (!started) {
+        errno = ENODEV;
+        m_motion.fail(future);
+    }
+    return future;
+}
+
+void MotorGroup::updateMotion() {
+    if (!m_motion.isPending()) return;
+    m_motion.update(getAngle());
 }
 
 int32_t MotorGroup::setBrakeMode(BrakeMode mode) {
     std::lock_guard lock(m_mutex);
-    m_brakeMode = mode;
-    getMotors(); // even though we don't use this, we call it anyway for brake mode setting and disconnect handling
+    updateSettings([&](Settings& settings) { settings.brakeMode = mode; });
+    // even though we don't use this, we call it anyway for brake mode setting and disconnect handling
+    checkMotors(DeviceRegistry::get().getPluggedPorts(pros::c::E_DEVICE_MOTOR));
     return 0;
 }
 
-BrakeMode MotorGroup::getBrakeMode() const {
+// the brake mode is applied by commands and by the maintenance task, so reading it doesn't have to lock
+BrakeMode MotorGroup::getBrakeMode() const { return m_settings.read().brakeMode; }
+
+int32_t MotorGroup::isConnected() const {
+    const uint32_t plugged = DeviceRegistry::get().getPluggedPorts(pros::c::E_DEVICE_MOTOR);
+    const int32_t size = summarizedSize(m_summary.load(std::memory_order_acquire), plugged);
+    if (size >= 0) return size > 0;
     std::lock_guard lock(m_mutex);
-    getMotors(); // even though we don't use this, we call it anyway for brake mode setting and disconnect handling
-    return m_brakeMode;
+    // getMotors only returns motors which are connected
+    return !getMotors(plugged).empty();
 }
 
-int32_t MotorGroup::isConnected() const {
+int32_t MotorGroup::startInitialization() {
     std::lock_guard lock(m_mutex);
-    const std::vector<Motor> motors = getMotors();
-    for (Motor motor : motors) {
-        const int result = motor.isConnected();
-        if (result == 1) return true;
-    }
-    // if no motors are connected, return 0
-    return 0;
+    bool detected = false;
+    for (Motor& motor : m_state.motors) detected |= motor.startInitialization() == 0;
+    return detected ? 0 : INT_MAX;
 }
 
-Angle MotorGroup::getAngle() const {
+Angle MotorGroup::getAngle() const { return tryGetAngle().orSentinel(from_stDeg(INFINITY)); }
+
+Result<Angle> MotorGroup::tryGetAngle() const {
     std::lock_guard lock(m_mutex);
-    const std::vector<Motor> motors = getMotors();
-    // get the average angle of all motors in the group
-    Angle angle = 0_stDeg;
-    int errors = 0;
-    for (Motor motor : motors) {
-        // get angle
-        const Angle result = motor.getAngle();
-        if (result == from_stDeg(INFINITY)) {
-            errors++;
-            continue;
-        };
-        // add to sum
-        angle += result;
+    return readAngle(nullptr);
+}
+
+EncoderSample MotorGroup::getSample() const {
+    std::lock_guard lock(m_mutex);
+    uint32_t timestamp = pros::c::micros();
+    const Result<Angle> angle = readAngle(&timestamp);
+    if (!angle.ok()) errno = angle.error();
+    return {.timestamp = from_usec(timestamp),
+            .angle = angle.orSentinel(from_stDeg(INFINITY)),
+            .connected = angle.ok()};
+}
+
+Result<Angle> MotorGroup::readAngle(uint32_t* timestamp) const {
+    const StaticVector<Motor*, MAX_MOTORS>& motors = getMotors();
+    // read every motor back to back first, so the samples are taken as close together as possible
+    m_readings.clear();
+    for (const Motor* motor : motors) m_readings.push_back(motor->getRaw());
+    // then convert them
+    m_angles.clear();
+    for (std::size_t i = 0; i < motors.size(); i++) m_angles.push_back(motors[i]->ticksToAngle(m_readings[i].value));
+    const Settings settings = m_settings.read();
+    updateOutliers(settings.outlierThreshold);
+    // combine the working motors which aren't outliers
+    m_samples.clear();
+    const Motor* reference = nullptr;
+    Angle referenceAngle = 0_stDeg;
+    uint32_t referenceTime = 0;
+    int64_t timeOffsets = 0;
+    for (std::size_t i = 0; i < motors.size(); i++) {
+        // motors which couldn't be read are skipped with an integer test, instead of comparing their angle
+        if (m_readings[i].value == INT_MAX) continue;
+        // the first working motor is the reference for configuring motors which reconnect
+        if (reference == nullptr) {
+            reference = motors[i];
+            referenceAngle = m_angles[i];
+            referenceTime = m_readings[i].timestamp;
+        }
+        // the timestamps are averaged relative to the reference, so the average is right when they wrap around
+        timeOffsets += int32_t(m_readings[i].timestamp - referenceTime);
+        m_samples.push_back(m_angles[i]);
     }
-    // if no motors are connected, return INFINITY
-    if (errors == motors.size()) return from_stDeg(INFINITY);
-    // otherwise, return the average angle
-    return angle / (motors.size() - errors);
+    // if no motors are connected, fail
+    if (m_samples.empty()) return Result<Angle>::failure(ENODEV);
+    if (timestamp != nullptr) *timestamp = referenceTime + timeOffsets / int64_t(m_samples.size());
+    const Angle angle = aggregateAngles(m_samples, settings.angleAggregate);
+    m_referencePort = std::abs(reference->getPort());
+    m_referenceOffset = angle - referenceAngle;
+    return angle;
 }
 
 int32_t MotorGroup::setAngle(Angle angle) {
     std::lock_guard lock(m_mutex);
-    const std::vector<Motor> motors = getMotors();
+    const StaticVector<Motor*, MAX_MOTORS>& motors = getMotors();
+    // read every motor back to back first, like getAngle, so every motor is zeroed at the same moment
+    m_readings.clear();
+    for (const Motor* motor : motors) m_readings.push_back({.value = motor->readTicksUncached()});
     bool success = false;
-    for (Motor motor : motors) {
-        const int result = motor.setAngle(angle);
-        if (result == 0) success = true;
-        const Angle offset = motor.getOffset();
-        // set the offset of that motor
-        for (MotorInfo& info : m_motors) {
-            if (info.port == motor.getPort()) info.offset = offset;
-        }
-    }
+    forEachConnected([&](std::size_t index, std::size_t i) {
+        // the offset is saved by the motor itself, as motor objects persist between calls
+        if (m_state.motors[index].setAngleAtTicks(angle, m_readings[i].value) != 0) return;
+        success = true;
+        // the motor agrees with the rest of the group again
+        m_state.outliers &= ~bitOf(index);
+    });
+    // every motor measures the same angle now
+    m_referenceOffset = 0_stDeg;
     // as long as one motor sets the angle successfully, return 0 (success)
     return success ? 0 : INT_MAX;
 }
 
+AngularVelocity MotorGroup::getVelocity() const {
+    std::lock_guard lock(m_mutex);
+    const StaticVector<Motor*, MAX_MOTORS>& motors = getMotors();
+    AngularVelocity total = 0_rpm;
+    int count = 0;
+    for (const Motor* motor : motors) {
+        const AngularVelocity result = motor->getVelocityImpl();
+        if (result.internal() == INFINITY) continue;
+        total += result;
+        count++;
+    }
+    // if no motors are connected, return INFINITY
+    if (count == 0) return from_rpm(INFINITY);
+    return total / count;
+}
+
+AngularAcceleration MotorGroup::getAcceleration() const {
+    std::lock_guard lock(m_mutex);
+    const StaticVector<Motor*, MAX_MOTORS>& motors = getMotors();
+    AngularAcceleration total = 0_rps2;
+    int count = 0;
+    for (const Motor* motor : motors) {
+        const AngularAcceleration result = motor->getAccelerationImpl();
+        if (result.internal() == INFINITY) continue;
+        total += result;
+        count++;
+    }
+    // if no motors are connected, return INFINITY
+    if (count == 0) return from_rps2(INFINITY);
+    return total / count;
+}
+
+int32_t MotorGroup::setVelocityFilter(AlphaBetaGains gains) {
+    std::lock_guard lock(m_mutex);
+    updateSettings([&](Settings& settings) { settings.velocityFilterGains = gains; });
+    // disconnected motors get the gains too, so they don't have to be applied when they reconnect
+    for (Motor& motor : m_state.motors) motor.setVelocityFilterImpl(gains);
+    return 0;
+}
+
+AlphaBetaGains MotorGroup::getVelocityFilter() const { return m_settings.read().velocityFilterGains; }
+
+int32_t MotorGroup::setCommandCache(CommandCacheSettings settings) {
+    std::lock_guard lock(m_mutex);
+    updateSettings([&](Settings& group) { group.commandCache = settings; });
+    for (Motor& motor : m_state.motors) motor.setCommandCacheImpl(settings);
+    return 0;
+}
+
+CommandCacheSettings MotorGroup::getCommandCache() const { return m_settings.read().commandCache; }
+
+int32_t MotorGroup::setCommandPriority(uint8_t priority) {
+    std::lock_guard lock(m_mutex);
+    updateSettings([&](Settings& settings) { settings.commandPriority = priority; });
+    for (Motor& motor : m_state.motors) motor.setCommandPriority(priority);
+    return 0;
+}
+
+uint8_t MotorGroup::getCommandPriority() const { return m_settings.read().commandPriority; }
+
+int32_t MotorGroup::releaseCommands() {
+    std::lock_guard lock(m_mutex);
+    for (Motor& motor : m_state.motors) motor.releaseCommands();
+    return 0;
+}
+
+int32_t MotorGroup::setReadCacheWindow(Time window) {
+    std::lock_guard lock(m_mutex);
+    updateSettings([&](Settings& settings) { settings.readCacheWindow = window; });
+    for (Motor& motor : m_state.motors) motor.setReadCacheWindow(window);
+    return 0;
+}
+
+Time MotorGroup::getReadCacheWindow() const { return m_settings.read().readCacheWindow; }
+
+int32_t MotorGroup::setVoltageCompensation(Voltage nominal) {
+    if (!(nominal >= 0_volt) || nominal.internal() == INFINITY) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    std::lock_guard lock(m_mutex);
+    updateSettings([&](Settings& settings) { settings.compensationVoltage = nominal; });
+    for (Motor& motor : m_state.motors) motor.setVoltageCompensation(nominal);
+    return 0;
+}
+
+Voltage MotorGroup::getVoltageCompensation() const { return m_settings.read().compensationVoltage; }
+
+int32_t MotorGroup::setAngleAggregate(AngleAggregate aggregate) {
+    std::lock_guard lock(m_mutex);
+    updateSettings([&](Settings& settings) { settings.angleAggregate = aggregate; });
+    return 0;
+}
+
+AngleAggregate MotorGroup::getAngleAggregate() const { return m_settings.read().angleAggregate; }
+
+int32_t MotorGroup::setOutlierThreshold(Angle threshold) {
+    if (!(threshold > 0_stDeg)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    std::lock_guard lock(m_mutex);
+    updateSettings([&](Settings& settings) { settings.outlierThreshold = threshold; });
+    return 0;
+}
+
+Angle MotorGroup::getOutlierThreshold() const { return m_settings.read().outlierThreshold; }
+
+int32_t MotorGroup::setTrusted(bool trusted) {
+    std::lock_guard lock(m_mutex);
+    updateSettings([&](Settings& settings) { settings.trusted = trusted; });
+    // the motors trusted commands use are found now, instead of at the first audit
+    checkMotors(DeviceRegistry::get().getPluggedPorts(pros::c::E_DEVICE_MOTOR));
+    return 0;
+}
+
+// only the flag is copied out of the settings, as commands call this
+bool MotorGroup::isTrusted() const {
+    return m_settings.read([](const Settings& settings) { return settings.trusted; });
+}
+
+int32_t MotorGroup::setSlewLimits(SlewLimits limits) {
+    // written so NaN fails the checks. The wheel diameter only matters once a limit is set
+    const bool limited = limits.maxAcceleration.internal() < INFINITY || limits.maxJerk.internal() < INFINITY;
+    if (!(limits.maxAcceleration > 0_mps2) || !(limits.maxJerk > 0_mps3) || !(limits.period > 0_sec) ||
+        (limited && !(limits.wheelDiameter > 0_m))) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    // without a limit, the group doesn't need to know how its commands turn into the velocity of a wheel
+    if (!limited) limits.wheelDiameter = 0_m;
+    std::lock_guard lock(m_mutex);
+    updateSettings([&](Settings& settings) { settings.slewLimits = limits; });
+    return 0;
+}
+
+SlewLimits MotorGroup::getSlewLimits() const { return m_settings.read().slewLimits; }
+
+int32_t MotorGroup::setLoadBalancing(LoadBalanceSettings settings) {
+    // written so NaN fails the checks
+    if (!(settings.temperatureGain >= 0) || !(settings.currentGain >= 0) || !(settings.maxTrim >= 0) ||
+        !(settings.maxTrim < 1)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    std::lock_guard lock(m_mutex);
+    updateSettings([&](Settings& group) { group.loadBalance = settings; });
+    if (!settings.enabled) std::fill(m_state.loadTrims.begin(), m_state.loadTrims.end(), 1.0);
+    return 0;
+}
+
+LoadBalanceSettings MotorGroup::getLoadBalancing() const { return m_settings.read().loadBalance; }
+
+void MotorGroup::updateLoadTrims() {
+    // most groups don't balance their load, so the maintenance task doesn't lock them. The settings are read again
+    // once locked, so trims reset by setLoadBalancing aren't overwritten
+    if (!m_settings.read().loadBalance.enabled) return;
+    std::lock_guard lock(m_mutex);
+    const LoadBalanceSettings settings = m_settings.read().loadBalance;
+    if (!settings.enabled) return;
+    const StaticVector<Motor*, MAX_MOTORS>& motors = getMotors();
+    const size_t count = motors.size();
+    // the averages only include motors whose temperature and current could both be read
+    std::array<double, MAX_MOTORS> celsius;
+    std::array<double, MAX_MOTORS> amps;
+    double temperature = 0;
+    double current = 0;
+    size_t valid = 0;
+    for (size_t i = 0; i < count; i++) {
+        celsius[i] = units::to_celsius(motors[i]->getTemperature());
+        amps[i] = to_amp(motors[i]->getCurrent());
+        if (!std::isfinite(celsius[i]) || !std::isfinite(amps[i])) continue;
+        temperature += celsius[i];
+        current += amps[i];
+        valid++;
+    }
+    if (valid < 2) return;
+    temperature /= valid;
+    current /= valid;
+    // each motor takes a small step away from its excess load, within the range of the trims
+    const double maxTrim = settings.maxTrim.internal();
+    std::array<double, MAX_MOTORS> trims;
+    forEachConnected([&](std::size_t index, std::size_t i) {
+        double trim = m_state.loadTrims[index];
+        if (std::isfinite(celsius[i]) && std::isfinite(amps[i])) {
+            trim -= settings.temperatureGain * (celsius[i] - temperature) + settings.currentGain * (amps[i] - current);
+        }
+        trims[i] = std::clamp(trim, 1 - maxTrim, 1 + maxTrim);
+    });
+    // then the trims are scaled back to an average of 1, so the total output of the group stays the same. A trim the
+    // scaling pushes out of range is held at its limit, and the others are scaled again to make up for it. Each pass
+    // holds at least one more trim, and an average of 1 is always within the range, so this ends within count passes
+    uint8_t held = 0;
+    for (size_t pass = 0; pass < count; pass++) {
+        double heldTotal = 0;
+        double freeTotal = 0;
+        for (size_t i = 0; i < count; i++) (held & bitOf(i) ? heldTotal : freeTotal) += trims[i];
+        const double scale = (count - heldTotal) / freeTotal;
+        const uint8_t before = held;
+        for (size_t i = 0; i < count; i++) {
+            if (held & bitOf(i)) continue;
+            trims[i] *= scale;
+            if (trims[i] < 1 - maxTrim || trims[i] > 1 + maxTrim) {
+                trims[i] = std::clamp(trims[i], 1 - maxTrim, 1 + maxTrim);
+                held |= bitOf(i);
+            }
+        }
+        if (held == before) break;
+    }
+    forEachConnected([&](std::size_t index, std::size_t i) { m_state.loadTrims[index] = trims[i]; });
+}
+
+void MotorGroup::updateOutliers(Angle threshold) const {
+    // the median of the working motors. With fewer than 3 of them, there is no majority to compare against
+    m_samples.clear();
+    for (const Angle angle : m_angles) {
+        if (angle != from_stDeg(INFINITY)) m_samples.push_back(angle);
+    }
+    const bool enabled = threshold.internal() != INFINITY && m_samples.size() >= 3;
+    const Angle median = enabled ? aggregateAngles(m_samples, AngleAggregate::MEDIAN) : 0_stDeg;
+    if (!enabled) {
+        m_state.outliers = 0;
+        return;
+    }
+    forEachConnected([&](std::size_t index, std::size_t i) {
+        const std::uint8_t bit = bitOf(index);
+        if (m_angles[i] == from_stDeg(INFINITY)) {
+            m_state.outliers &= ~bit;
+            return;
+        }
+        // a motor has to come back well within the threshold before it is used again, so it doesn't flicker in and
+        // out of the angle of the group while it is near the threshold
+        const Angle error = units::abs(m_angles[i] - median);
+        if (error > threshold) m_state.outliers |= bit;
+        else if (error <= threshold / 2) m_state.outliers &= ~bit;
+        if (m_state.outliers & bit) m_angles[i] = from_stDeg(INFINITY);
+    });
+}
+
 Current MotorGroup::getCurrentLimit() const {
     std::lock_guard lock(m_mutex);
-    const std::vector<Motor> motors = getMotors();
+    const StaticVector<Motor*, MAX_MOTORS>& motors = getMotors();
     Current total = 0_amp;
     int errors = 0;
     // find the total current limit
-    for (Motor motor : motors) {
-        Current result = motor.getCurrentLimit();
+    for (const Motor* motor : motors) {
+        Current result = motor->getCurrentLimit();
         if (result.internal() == INFINITY) { // error checking
             errors += 1;
             continue;
         }
         total += result;
     }
-    if (errors == motors.size()) return from_amp(INFINITY); // error checking
+    if (errors == int(motors.size())) return from_amp(INFINITY); // error checking
     return total;
 }
 
 int32_t MotorGroup::setCurrentLimit(Current limit) {
     std::lock_guard lock(m_mutex);
-    const std::vector<Motor> motors = getMotors();
-    if (motors.size() == 0) return INT_MAX; // error handling
-    // set current limits
-    for (Motor motor : motors) {
-        int result = motor.setCurrentLimit(limit / motors.size());
-        if (result == INT_MAX) return setCurrentLimit(limit); // redo if there was a failure
+    updateSettings([&](Settings& settings) { settings.currentLimit = limit; });
+    // checking the motors splits the new limit between the connected motors
+    const StaticVector<Motor*, MAX_MOTORS>& motors =
+        checkMotors(DeviceRegistry::get().getPluggedPorts(pros::c::E_DEVICE_MOTOR));
+    if (motors.size() == 0) { // error handling
+        errno = ENODEV;
+        return INT_MAX;
+    }
+    // check that every connected motor got its share. Motors which failed are tried again by the next getMotors call
+    for (std::size_t i = 0; i < m_state.motors.size(); i++) {
+        if ((m_state.connected & bitOf(i)) && !hasCurrentLimitShare(i)) {
+            errno = EIO;
+            return INT_MAX;
+        }
     }
     return 0;
 }
 
 std::vector<Temperature> MotorGroup::getTemperatures() const {
     std::lock_guard lock(m_mutex);
-    std::vector<Motor> motors = getMotors();
+    const StaticVector<Motor*, MAX_MOTORS>& motors = getMotors();
     std::vector<Temperature> temperatures;
-    for (const Motor motor : motors) { temperatures.push_back(motor.getTemperature()); }
+    temperatures.reserve(motors.size());
+    for (const Motor* motor : motors) { temperatures.push_back(motor->getTemperature()); }
     return temperatures;
 }
 
+int32_t MotorGroup::getTemperatures(std::span<Temperature> buffer) const {
+    std::lock_guard lock(m_mutex);
+    return readEach(getMotors(), buffer, [](const Motor& motor) { return motor.getTemperature(); });
+}
+
+int32_t MotorGroup::getAngles(std::span<Angle> buffer) const {
+    std::lock_guard lock(m_mutex);
+    return readEach(getMotors(), buffer, [](const Motor& motor) { return motor.getAngle(); });
+}
+
+int32_t MotorGroup::getVelocities(std::span<AngularVelocity> buffer) const {
+    std::lock_guard lock(m_mutex);
+    return readEach(getMotors(), buffer, [](const Motor& motor) { return motor.getVelocityImpl(); });
+}
+
+int32_t MotorGroup::getCurrents(std::span<Current> buffer) const {
+    std::lock_guard lock(m_mutex);
+    return readEach(getMotors(), buffer, [](const Motor& motor) { return motor.getCurrent(); });
+}
+
+std::vector<MotorTelemetry> MotorGroup::getTelemetry() const {
+    std::lock_guard lock(m_mutex);
+    const StaticVector<Motor*, MAX_MOTORS>& motors = getMotors();
+    std::vector<MotorTelemetry> telemetry;
+    telemetry.reserve(motors.size());
+    for (const Motor* motor : motors) telemetry.push_back(motor->getTelemetryImpl());
+    forEachConnected([&](std::size_t index, std::size_t i) { telemetry[i].outlier = m_state.outliers & bitOf(index); });
+    return telemetry;
+}
+
+int32_t MotorGroup::getTelemetry(std::span<MotorTelemetry> buffer) const {
+    std::lock_guard lock(m_mutex);
+    const StaticVector<Motor*, MAX_MOTORS>& motors = getMotors();
+    // only write as many motors as fit in the buffer
+    const size_t count = std::min(motors.size(), buffer.size());
+    for (size_t i = 0; i < count; i++) buffer[i] = motors[i]->getTelemetryImpl();
+    forEachConnected([&](std::size_t index, std::size_t i) {
+        if (i < count) buffer[i].outlier = m_state.outliers & bitOf(index);
+    });
+    return count;
+}
+
 // Always returns 0 because the velocity setter is not dependent on hardware and should never fail
 int32_t MotorGroup::setOutputVelocity(AngularVelocity outputVelocity) {
     std::lock_guard lock(m_mutex);
-    Angle angle = getAngle();
-    m_outputVelocity = outputVelocity;
-    setAngle(angle);
+    updateSettings([&](Settings& settings) { settings.outputVelocity = outputVelocity; });
+    // every motor keeps the angle it measured before the output velocity was changed
+    for (Motor& motor : m_state.motors) motor.setOutputVelocityImpl(outputVelocity);
     return 0;
 }
 
-AngularVelocity MotorGroup::getOutputVelocity() const {
-    std::lock_guard lock(m_mutex);
-    return m_outputVelocity;
-}
+AngularVelocity MotorGroup::getOutputVelocity() const { return m_settings.read().outputVelocity; }
 
 int32_t MotorGroup::getSize() const {
+    const uint32_t plugged = DeviceRegistry::get().getPluggedPorts(pros::c::E_DEVICE_MOTOR);
+    // nothing the last check depended on changed, so it would find the same motors again
+    const int32_t size = summarizedSize(m_summary.load(std::memory_order_acquire), plugged);
+    if (size >= 0) return size;
     std::lock_guard lock(m_mutex);
-    const std::vector<Motor> motors = getMotors();
-    int size = 0;
-    for (Motor motor : motors)
-        if (motor.isConnected()) size++;
-    return size;
+    // getMotors only returns motors which are connected
+    return getMotors(plugged).size();
 }
 
 int32_t MotorGroup::addMotor(ReversibleSmartPort port) {
     std::lock_guard lock(m_mutex);
     // check that the motor isn't already part of the group
-    for (const MotorInfo& info : m_motors) {
+    for (const Motor& motor : m_state.motors) {
         // return an error if the motor is already added to the group
-        if (std::abs(info.port) == std::abs(port)) {
+        if (std::abs(motor.getPort()) == std::abs(port)) {
             errno = EEXIST;
             return INT_MAX;
         }
     }
+    if (m_state.motors.full()) {
+        errno = ENOSPC;
+        return INT_MAX;
+    }
+    // add the motor to the group. The motor is moved into the vector, so no extra mutex is created
+    const Settings settings = m_settings.read();
+    appendMotor(Motor(port, settings.outputVelocity), false);
+    const std::size_t index = m_state.motors.size() - 1;
+    Motor& motor = m_state.motors.back();
+    motor.setVelocityFilterImpl(settings.velocityFilterGains);
+    motor.setCommandCacheImpl(settings.commandCache);
+    motor.setReadCacheWindow(settings.readCacheWindow);
+    motor.setVoltageCompensation(settings.compensationVoltage);
+    motor.setCommandPriority(settings.commandPriority);
     // configure the motor
-    const Angle offset = configureMotor(port);
-    // add the motor to the group
-    MotorInfo info {.port = port, .connectedLastCycle = offset == from_stRot(INFINITY), .offset = offset};
-    m_motors.push_back(info);
-    if (offset == from_stRot(INFINITY)) return INT_MAX;
-    return 0;
+    const int32_t result = configureMotor(index);
+    if (result == 0) m_state.connected |= bitOf(index);
+    m_summary.store(0, std::memory_order_release);
+    // a trusted group checks its motors again, so the new motor is commanded
+    m_motorsChecked = false;
+    return result;
 }
 
-int32_t MotorGroup::addMotor(Motor motor) {
-    std::lock_guard lock(m_mutex);
-    return addMotor(motor.getPort());
-}
+// the mutex is not locked here, as it is locked by the overload that takes a port
+int32_t MotorGroup::addMotor(const Motor& motor) { return addMotor(motor.getPort()); }
 
-int32_t MotorGroup::addMotor(Motor motor, bool reversed) {
-    std::lock_guard lock(m_mutex);
+int32_t MotorGroup::addMotor(const Motor& motor, bool reversed) {
     // set the motor reversal
-    motor.setReversed(reversed);
-    return addMotor(motor);
+    return addMotor(motor.getPort().set_reversed(reversed));
 }
 
 void MotorGroup::removeMotor(ReversibleSmartPort port) {
     std::lock_guard lock(m_mutex);
-    // remove the motor with the specified port
-    const auto iterator = std::remove_if(m_motors.begin(), m_motors.end(), [&](MotorInfo m) { return m.port == port; });
-    m_motors.erase(iterator);
+    // remove the motor with the specified port. Ports are unique, so there is at most one
+    const auto motor = std::find_if(m_state.motors.begin(), m_state.motors.end(),
+                                    [&](const Motor& m) { return m.getPort() == port; });
+    if (motor == m_state.motors.end()) return;
+    const std::size_t index = motor - m_state.motors.begin();
+    m_state.motors.erase(motor, motor + 1);
+    m_state.appliedBrakeModes.erase(m_state.appliedBrakeModes.begin() + index,
+                                    m_state.appliedBrakeModes.begin() + index + 1);
+    m_state.appliedCurrentLimits.erase(m_state.appliedCurrentLimits.begin() + index,
+                                       m_state.appliedCurrentLimits.begin() + index + 1);
+    m_state.loadTrims.erase(m_state.loadTrims.begin() + index, m_state.loadTrims.begin() + index + 1);
+    m_state.connected = removeBit(m_state.connected, index);
+    m_state.outliers = removeBit(m_state.outliers, index);
+    m_summary.store(0, std::memory_order_release);
+    // the saved pointers may no longer be valid. They are found again the next time getMotors is called
+    m_connectedMotors.clear();
+    m_motorsChecked = false;
+}
+
+void MotorGroup::removeMotor(const Motor& motor) { removeMotor(motor.getPort()); }
+
+const StaticVector<Motor*, MotorGroup::MAX_MOTORS>& MotorGroup::getMotors() const {
+    // a trusted group doesn't need the snapshot
+    if (m_motorsChecked && isTrusted()) return m_connectedMotors;
+    // every motor is checked against the same snapshot of the ports, which is a single load
+    return getMotors(DeviceRegistry::get().getPluggedPorts(pros::c::E_DEVICE_MOTOR));
 }
 
-void MotorGroup::removeMotor(Motor motor) { removeMotor(motor.getPort()); }
+const StaticVector<Motor*, MotorGroup::MAX_MOTORS>& MotorGroup::getMotors(uint32_t plugged) const {
+    if (m_motorsChecked && isTrusted()) return m_connectedMotors;
+    return checkMotors(plugged);
+}
 
-const std::vector<Motor> MotorGroup::getMotors() const {
-    std::vector<Motor> motors;
-    for (int i = 0; i < m_motors.size(); i++) {
-        // create a temporary motor
-        Motor motor(m_motors.at(i).port, m_outputVelocity);
-        // set motor offset
-        motor.setOffset(m_motors.at(i).offset);
-        // check if the motor is connected
-        const bool connected = motor.isConnected();
+const StaticVector<Motor*, MotorGroup::MAX_MOTORS>& MotorGroup::checkMotors(uint32_t plugged) const {
+    startMaintenanceTask();
+    const BrakeMode brakeMode = m_settings.read().brakeMode;
+    // the vector of connected motors is reused between calls. It is stored inside the group, so clearing and refilling
+    // it never allocates memory
+    m_connectedMotors.clear();
+    uint64_t ports = 0;
+    uint64_t counted = 0;
+    // whether every motor is either counted or unplugged, so the result only changes when a port does
+    bool settled = true;
+    for (std::size_t i = 0; i < m_state.motors.size(); i++) {
+        Motor& motor = m_state.motors[i];
+        ports |= uint64_t(1) << (abs(motor.getPort()) - 1);
+        const bool connectedLastCycle = m_state.connected & bitOf(i);
+        // check if the motor is connected. A motor which was just unplugged is checked again, so it discards its
+        // cached state. Motors which stay unplugged are only checked against the snapshot
+        const bool connected = DeviceRegistry::hasPort(plugged, abs(motor.getPort())) ||
+                               (connectedLastCycle && motor.isConnectedImpl());
         // don't add the motor if it is not connected
         if (!connected) {
-            m_motors.at(i).connectedLastCycle = false;
+            markDisconnected(i);
             continue;
         }
-        // if the motor is connected, but wasn't the last time we checked, then configure it to prevent side
-        // effects of reconnecting
-        // don't add the motor if configuration fails
-        if (!m_motors.at(i).connectedLastCycle) {
-            if (std::isinf(to_stRot(configureMotor(m_motors.at(i).port)))) continue;
+        // if the motor is connected, but wasn't the last time we checked, then it has to be configured to prevent
+        // side effects of reconnecting. That is left to the maintenance task, so the motor is skipped until then
+        if (!connectedLastCycle) {
+            m_reconnectPending = true;
+            settled = false;
+            continue;
+        }
+        // only apply the brake mode if it changed. The maintenance task makes sure it stays applied
+        if (m_state.appliedBrakeModes[i] != brakeMode) {
+            if (motor.setBrakeMode(brakeMode) != 0) {
+                settled = false;
+                continue;
+            }
+            m_state.appliedBrakeModes[i] = brakeMode;
         }
-        // check that the brake mode of the motor is correct
-        BrakeMode mode = motor.getBrakeMode();
-        if (mode != m_brakeMode) {
-            if (motor.setBrakeMode(m_brakeMode) != 0) continue;
-        } else if (mode == BrakeMode::INVALID) continue;
-        // add the motor and set save it as connected
-        m_motors.at(i).connectedLastCycle = true;
-        motors.push_back(motor);
+        m_connectedMotors.push_back(&motor);
+        counted |= bitOf(i);
     }
-    return motors;
+    applyCurrentLimit();
+    m_motorsChecked = true;
+    // a motor which is skipped until it is configured is counted without a port changing, so the summary is only
+    // published once every motor settled
+    const uint64_t summary = SUMMARY_VALID | ports | (uint64_t(plugged & ports) << SUMMARY_PLUGGED_SHIFT) |
+                             (counted << SUMMARY_COUNTED_SHIFT);
+    m_summary.store(settled ? summary : 0, std::memory_order_release);
+    return m_connectedMotors;
 }
 
-const std::vector<MotorGroup::MotorInfo> MotorGroup::getMotorInfo() const {
+Current MotorGroup::currentLimitShare() const {
+    const Current currentLimit = m_settings.read().currentLimit;
+    // without a limit, every motor gets the largest limit there is. The 5.5W motor lowers it to its own maximum
+    if (currentLimit.internal() == INFINITY) return MAX_MOTOR_CURRENT;
+    return currentLimit / m_connectedMotors.size();
+}
+
+bool MotorGroup::hasCurrentLimitShare(std::size_t index) const {
+    const Current applied = m_state.appliedCurrentLimits[index];
+    // a motor the group hasn't limited since it joined or reconnected still has its default limit, which is already
+    // the most it can draw, so a group without a limit only writes to motors it limited before
+    if (applied.internal() == INFINITY && m_settings.read().currentLimit.internal() == INFINITY) return true;
+    return applied == currentLimitShare();
+}
+
+void MotorGroup::applyCurrentLimit() const {
+    if (m_connectedMotors.empty()) return;
+    const Current share = currentLimitShare();
+    forEachConnected([&](std::size_t index, std::size_t) {
+        if (!hasCurrentLimitShare(index) && m_state.motors[index].setCurrentLimit(share) != INT_MAX) {
+            m_state.appliedCurrentLimits[index] = share;
+        }
+    });
+}
+
+MotorGroup::MotorStates MotorGroup::getMotorStates() const {
     std::lock_guard lock(m_mutex);
-    return m_motors;
+    return m_state;
 }
 
-Angle MotorGroup::configureMotor(ReversibleSmartPort port) const {
-    // since this function is called in other MotorGroup member functions, this function can't call any other member
-    // function, otherwise it would cause a recursion loop. This means that this function is ugly and complex, but at
-    // least it means that the other functions can stay simple
+void MotorGroup::appendMotor(Motor&& motor, bool connected) {
+    const std::size_t index = m_state.motors.size();
+    m_state.motors.push_back(std::move(motor));
+    m_state.appliedBrakeModes.push_back(BrakeMode::INVALID);
+    m_state.appliedCurrentLimits.push_back(from_amp(INFINITY));
+    m_state.loadTrims.push_back(1);
+    m_state.outliers &= ~bitOf(index);
+    if (connected) m_state.connected |= bitOf(index);
+    else m_state.connected &= ~bitOf(index);
+    m_summary.store(0, std::memory_order_release);
+}
 
-    // this function does not return immediately when something goes wrong. Instead it will continue with the process to
-    // add the motor, and the motor will automatically be reconfigured when it is working properly again
-    // whether there was a failure or not is kept track of with this boolean
-    bool success = true;
-    Motor motor(port, m_outputVelocity);
-    // set the motor's brake mode to whatever the first working motor's brake mode is
-    for (MotorInfo info : m_motors) {
-        Motor m(info.port, m_outputVelocity);
-        const BrakeMode mode = m.getBrakeMode();
-        if (mode == BrakeMode::INVALID) continue;
-        if (m.setBrakeMode(mode) == 0) break;
-        else {
-            success = false;
-            break;
+void MotorGroup::markDisconnected(std::size_t index) const {
+    m_state.connected &= ~bitOf(index);
+    m_summary.store(0, std::memory_order_release);
+    m_state.appliedBrakeModes[index] = BrakeMode::INVALID;
+    m_state.appliedCurrentLimits[index] = from_amp(INFINITY);
+}
+
+void MotorGroup::configureReconnectedMotors() {
+    std::lock_guard lock(m_mutex);
+    // the flag is cleared first, so a reconnect noticed while configuring is handled next time
+    m_reconnectPending = false;
+    for (std::size_t i = 0; i < m_state.motors.size(); i++) {
+        const bool connected = m_state.motors[i].isConnectedImpl();
+        // the motor may have been unplugged and plugged back in since the group was last used, so an unplug is
+        // recorded here too, and the motor is configured once it is plugged back in
+        if (!connected && (m_state.connected & bitOf(i))) markDisconnected(i);
+        if ((m_state.connected & bitOf(i)) || !connected) continue;
+        // getMotors adds the motor back to the group once it is configured
+        if (configureMotor(i) == 0) {
+            m_state.connected |= bitOf(i);
+            m_summary.store(0, std::memory_order_release);
+        } else {
+            m_reconnectPending = true;
         }
     }
+}
 
-    Angle angle = 0_stDeg;
-    {
-        // find all the working motors
-        std::vector<Motor> motors;
-        for (int i = 0; i < m_motors.size(); i++) {
-            // temporary motor object
-            Motor m(m_motors.at(i).port, m_outputVelocity);
-            // set the offset of the motor
-            m.setOffset(m_motors.at(i).offset);
-            // check if the motor is connected
-            const bool connected = m.isConnected();
-            // check that the motor is not the motor we are configuring
-            if (std::abs(m.getPort()) == std::abs(port)) continue;
-            // don't add the motor if it is not connected
-            if (!connected) continue;
-            else motors.push_back(m);
-        }
+void MotorGroup::auditBrakeModes() {
+    std::lock_guard lock(m_mutex);
+    const BrakeMode brakeMode = m_settings.read().brakeMode;
+    for (std::size_t i = 0; i < m_state.motors.size(); i++) {
+        if (!(m_state.connected & bitOf(i))) continue;
+        Motor& motor = m_state.motors[i];
+        const BrakeMode mode = motor.getBrakeMode();
+        if (mode == brakeMode) continue;
+        // getMotors applies the brake mode again if it can't be fixed now
+        if (mode == BrakeMode::INVALID || motor.setBrakeMode(brakeMode) != 0) {
+            m_state.appliedBrakeModes[i] = BrakeMode::INVALID;
+        } else m_state.appliedBrakeModes[i] = brakeMode;
+    }
+}
 
-        // get the average angle of all motors in the group
-        Angle tempAngle = 0_stDeg;
-        int errors = 0;
-        for (Motor m : motors) {
-            // get angle
-            const Angle result = m.getAngle();
-            if (result == from_stDeg(INFINITY)) { // check for errors
-                errors++;
-                continue;
+void MotorGroup::auditTrusted() {
+    std::lock_guard lock(m_mutex);
+    checkMotors(DeviceRegistry::get().getPluggedPorts(pros::c::E_DEVICE_MOTOR));
+}
+
+void MotorGroup::startMaintenanceTask() {
+    MaintenanceRegistry& registry = getMaintenanceRegistry();
+    // this is called by every command, so the flag is only written if the task hasn't been started
+    if (registry.taskStarted.load(std::memory_order_relaxed) || registry.taskStarted.exchange(true)) return;
+    LEMLIB_BOOT_EVENT("create lemlib motor group maintenance task", 0);
+    const pros::task_t task = pros::c::task_create(maintenanceTaskFunction, nullptr, MAINTENANCE_TASK_PRIORITY,
+                                                   TASK_STACK_DEPTH_DEFAULT, "lemlib motor group maintenance");
+    // try again the next time a motor group is used
+    if (task == nullptr) registry.taskStarted = false;
+}
+
+void MotorGroup::maintenanceTaskFunction(void*) {
+    MaintenanceRegistry& registry = getMaintenanceRegistry();
+    uint32_t now = pros::c::millis();
+    uint32_t lastAudit = now;
+    uint32_t plugSequence = DeviceRegistry::get().getPlugSequence();
+    while (true) {
+        const bool audit = now - lastAudit >= BRAKE_MODE_AUDIT_PERIOD;
+        if (audit) lastAudit = now;
+        // a device was plugged in or unplugged since the last check, so motors which reconnected are configured even if
+        // no command was sent to their group in between
+        const uint32_t latestPlugSequence = DeviceRegistry::get().getPlugSequence();
+        const bool plugged = latestPlugSequence != plugSequence;
+        plugSequence = latestPlugSequence;
+        {
+            std::lock_guard lock(registry.mutex);
+            for (MotorGroup* group : registry.groups) {
+                if (plugged || group->m_reconnectPending.load()) group->configureReconnectedMotors();
+                if (audit) group->auditBrakeModes();
+                if (group->isTrusted()) group->auditTrusted();
+                group->updateLoadTrims();
             }
-            tempAngle += result;
         }
-        // prevent divide by zero if all motors failed
-        if (motors.size() != errors) angle = tempAngle / (motors.size() - errors);
+        pros::c::task_delay_until(&now, MAINTENANCE_TASK_PERIOD);
+    }
+}
+
+const Motor* MotorGroup::getReferenceMotor(ReversibleSmartPort port) const {
+    const Motor* fallback = nullptr;
+    for (std::size_t i = 0; i < m_state.motors.size(); i++) {
+        const Motor& motor = m_state.motors[i];
+        const std::uint8_t motorPort = std::abs(motor.getPort());
+        if (motorPort == std::abs(port) || !(m_state.connected & bitOf(i))) continue;
+        // the saved reference is preferred, as the saved offset is only valid for it
+        if (motorPort == m_referencePort) return &motor;
+        if (fallback == nullptr) fallback = &motor;
+    }
+    // the saved offset doesn't apply to a different reference motor
+    if (fallback != nullptr) {
+        m_referencePort = std::abs(fallback->getPort());
+        m_referenceOffset = 0_stDeg;
+    }
+    return fallback;
+}
+
+int32_t MotorGroup::configureMotor(std::size_t index) const {
+    Motor& motor = m_state.motors[index];
+    LEMLIB_BOOT_SPAN("configure motor", std::abs(motor.getPort()));
+    // since this function is called in other MotorGroup member functions, this function can't call any other public
+    // member function, otherwise it would cause a recursion loop
+
+    // this function does not return immediately when something goes wrong. Instead it will continue with the process to
+    // add the motor, and the motor will automatically be reconfigured when it is working properly again
+    // whether there was a failure or not is kept track of with this boolean
+    bool success = true;
+    // set the brake mode of the motor to the brake mode of the group
+    const BrakeMode brakeMode = m_settings.read().brakeMode;
+    if (motor.setBrakeMode(brakeMode) != 0) {
+        success = false;
+        m_state.appliedBrakeModes[index] = BrakeMode::INVALID;
+    } else m_state.appliedBrakeModes[index] = brakeMode;
+
+    // estimate the average angle of the other working motors in the group from the reference motor. This only reads
+    // one motor, no matter how big the group is
+    Angle angle = 0_stDeg;
+    const Motor* reference = getReferenceMotor(motor.getPort());
+    if (reference != nullptr) {
+        const Angle result = reference->getAngle();
+        if (result != from_stDeg(INFINITY)) angle = result + m_referenceOffset;
     }
 
-    // set the angle of the new motor
-    const int result = motor.setAngle(angle);
-    if (result == INT_MAX) return from_stRot(INFINITY); // check for errors
-    if (success == true) return motor.getOffset();
-    return from_stRot(INFINITY);
+    // set the angle of the motor. It measures the same angle as the group afterwards, so it isn't an outlier anymore
+    if (motor.setAngleImpl(angle) == INT_MAX) return INT_MAX; // check for errors
+    m_state.outliers &= ~bitOf(index);
+    return success ? 0 : INT_MAX;
 }
-}; // namespace lemlib
\ No newline at end of file
+}; // namespace lemlib
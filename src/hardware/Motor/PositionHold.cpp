@@ -0,0 +1,94 @@
+#include "hardware/Motor/PositionHold.hpp"
+#include "hardware/AllocationTracker.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+PositionHold::PositionHold(MotorGroup& motors, PositionHoldSettings settings, Time period)
+    : m_motors(motors),
+      m_settings(settings),
+      m_period(period) {}
+
+int32_t PositionHold::hold() {
+    const Angle angle = m_motors.getAngle();
+    if (!std::isfinite(to_stDeg(angle))) {
+        errno = ENODEV;
+        return INT_MAX;
+    }
+    return hold(angle);
+}
+
+int32_t PositionHold::hold(Angle angle) {
+    std::lock_guard lock(m_mutex);
+    if (!m_holding && m_settings.currentLimit.internal() < INFINITY) {
+        m_savedLimit = m_motors.getCurrentLimit();
+        m_motors.setCurrentLimit(m_settings.currentLimit);
+    }
+    m_holding = true;
+    // the group may still be moving from its last command, so the hold corrects until it is within the deadband
+    m_correcting = true;
+    m_target = angle;
+    m_integral = 0;
+    return 0;
+}
+
+int32_t PositionHold::release() {
+    std::lock_guard lock(m_mutex);
+    if (m_holding && m_settings.currentLimit.internal() < INFINITY && m_savedLimit.internal() < INFINITY) {
+        m_motors.setCurrentLimit(m_savedLimit);
+    }
+    m_holding = false;
+    m_correcting = false;
+    return 0;
+}
+
+bool PositionHold::isHolding() const {
+    std::lock_guard lock(m_mutex);
+    return m_holding;
+}
+
+bool PositionHold::isCorrecting() const {
+    std::lock_guard lock(m_mutex);
+    return m_correcting;
+}
+
+Angle PositionHold::getTarget() const {
+    std::lock_guard lock(m_mutex);
+    return m_target;
+}
+
+int32_t PositionHold::update() {
+    LEMLIB_ALLOCATION_FREE("PositionHold::update");
+    std::lock_guard lock(m_mutex);
+    if (!m_holding) return 0;
+    const double error = to_stDeg(m_target - m_motors.getAngle());
+    if (!std::isfinite(error)) {
+        errno = ENODEV;
+        return INT_MAX;
+    }
+    const double distance = std::abs(error);
+    const PositionHoldGains& gains = m_settings.gains;
+    if (m_correcting && distance <= to_stDeg(m_settings.deadband)) {
+        // back within the deadband, so the motors are left to rest until the error grows past the threshold again
+        m_correcting = false;
+        m_integral = 0;
+        return gains.kG == 0 ? m_motors.brake() : m_motors.move(gains.kG);
+    }
+    if (!m_correcting) {
+        if (distance <= to_stDeg(m_settings.threshold)) return 0;
+        m_correcting = true;
+    }
+
+    const double velocity = to_degps(m_motors.getVelocity());
+    const double maxPower = m_settings.maxPower.internal();
+    const double unclamped = gains.kG + gains.kP * error + gains.kI * m_integral - gains.kD * velocity;
+    // the integral is not accumulated while the output is saturated, so it doesn't wind up
+    if (std::abs(unclamped) < maxPower) m_integral += error * to_sec(m_period);
+    const double power = std::clamp(unclamped, -maxPower, maxPower);
+    // a velocity which can't be read doesn't stop the correction, it just isn't damped
+    return m_motors.move(std::isfinite(power) ? power : std::clamp(gains.kG + gains.kP * error, -maxPower, maxPower));
+}
+} // namespace lemlib
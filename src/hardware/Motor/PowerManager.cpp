@@ -0,0 +1,177 @@
+#include "hardware/Motor/PowerManager.hpp"
+#include "hardware/AllocationTracker.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+namespace {
+using Amps = std::array<double, PowerManager::MAX_GROUPS>;
+
+/**
+ * @brief Split a budget between groups by weight, without giving any group more than it has room for
+ *
+ * Groups which get less room than their share of the budget get all of their room, and the rest of their share is
+ * split between the other groups, until the budget runs out or every group is full.
+ *
+ * @param budget the current to split, in amps
+ * @param room how much more current each group can take, in amps
+ * @param weights the weight of each group
+ * @param count the number of groups
+ * @param allocation the current of each group, in amps, which the split is added to
+ * @return double the current left over once every group is full, in amps
+ */
+double splitBudget(double budget, const Amps& room, const Amps& weights, size_t count, Amps& allocation) {
+    std::array<bool, PowerManager::MAX_GROUPS> full {};
+    for (size_t i = 0; i < count; i++) full[i] = room[i] <= 0;
+    // every pass fills at least one group, or splits the rest of the budget, so this takes at most count passes
+    while (budget > 0) {
+        double totalWeight = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!full[i]) totalWeight += weights[i];
+        }
+        if (totalWeight == 0) break;
+        // fill every group which has less room than its share
+        double filled = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (full[i] || budget * weights[i] / totalWeight < room[i]) continue;
+            allocation[i] += room[i];
+            filled += room[i];
+            full[i] = true;
+        }
+        if (filled != 0) {
+            budget -= filled;
+            continue;
+        }
+        // every group has room for its share
+        for (size_t i = 0; i < count; i++) {
+            if (!full[i]) allocation[i] += budget * weights[i] / totalWeight;
+        }
+        return 0;
+    }
+    return std::max(budget, 0.0);
+}
+
+/**
+ * @brief The fraction of its maximum limit a group is allowed at a temperature
+ *
+ * @param policy the policy
+ * @param temperature the temperature of the hottest motor of the group
+ * @return double the fraction, from minimumScale to 1
+ */
+double thermalScale(const PowerPolicy& policy, Temperature temperature) {
+    if (temperature <= policy.deratingStart) return 1;
+    if (temperature >= policy.deratingEnd) return policy.minimumScale;
+    const double progress = units::to_kelvin(temperature - policy.deratingStart) /
+                            units::to_kelvin(policy.deratingEnd - policy.deratingStart);
+    return 1 - (1 - policy.minimumScale) * progress;
+}
+} // namespace
+
+PowerManager::PowerManager(DevicePoller& poller, PowerPolicy policy)
+    : m_poller(poller),
+      m_policy(policy) {}
+
+int32_t PowerManager::addGroup(MotorGroup& group, Current maxLimit, double weight) {
+    if (!(maxLimit > 0_amp) || !(weight > 0)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    std::lock_guard lock(m_mutex);
+    const size_t index = m_groupCount.load(std::memory_order_relaxed);
+    if (index == MAX_GROUPS) {
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    const int32_t pollerIndex = m_poller.addMotorGroup(group);
+    if (pollerIndex == INT_MAX) return INT_MAX; // the poller sets errno
+    GroupEntry& entry = m_groups[index];
+    entry.group = &group;
+    entry.pollerIndex = pollerIndex;
+    entry.maxLimit = maxLimit;
+    entry.weight = weight;
+    // publish the entry only after it has been filled in
+    m_groupCount.store(index + 1, std::memory_order_release);
+    return index;
+}
+
+int32_t PowerManager::setPolicy(PowerPolicy policy) {
+    if (!(policy.budget >= 0_amp) || !(policy.deratingEnd > policy.deratingStart) || !(policy.minimumScale >= 0) ||
+        !(policy.minimumScale <= 1) || !(policy.throttleLookahead >= 0_sec) || !(policy.thermal.timeConstant > 0_sec)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    std::lock_guard lock(m_mutex);
+    m_policy.write(policy);
+    return 0;
+}
+
+PowerPolicy PowerManager::getPolicy() const { return m_policy.read(); }
+
+PowerGroupState PowerManager::getGroupState(int32_t index) const {
+    if (index < 0 || size_t(index) >= m_groupCount.load(std::memory_order_acquire)) {
+        errno = EINVAL;
+        return {};
+    }
+    return m_groups[index].state.read();
+}
+
+int32_t PowerManager::update() {
+    LEMLIB_ALLOCATION_FREE("PowerManager::update");
+    const PowerPolicy policy = m_policy.read();
+    // the count is only read once, so groups added during the update are managed in the next one
+    const size_t count = m_groupCount.load(std::memory_order_acquire);
+    std::array<PowerGroupState, MAX_GROUPS> states {};
+    Amps caps {};
+    Amps needs {};
+    Amps weights {};
+    for (size_t i = 0; i < count; i++) {
+        GroupEntry& entry = m_groups[i];
+        const MotorGroupSample sample = m_poller.getMotorGroupSample(entry.pollerIndex);
+        PowerGroupState& state = states[i];
+        state.connected = sample.connected;
+        state.current = sample.current;
+        state.maxTemperature = sample.maxTemperature;
+        // groups without connected motors don't take any of the budget
+        if (!sample.connected) continue;
+        // the motors of a group share its load, so the hottest motor is modeled as drawing the mean current
+        const Current current = sample.current / double(sample.motors);
+        entry.thermal.setParameters(policy.thermal);
+        entry.thermal.update(current, sample.maxTemperature, sample.timestamp - entry.lastSample);
+        entry.lastSample = sample.timestamp;
+        state.predictedTemperature = entry.thermal.predict(current, policy.throttleLookahead);
+        state.timeToThrottle = entry.thermal.timeToThrottle(current);
+        state.thermalScale = thermalScale(policy, std::max(sample.maxTemperature, state.predictedTemperature));
+        caps[i] = to_amp(entry.maxLimit) * state.thermalScale;
+        // a group only needs a little more than it is drawing, so the rest can be lent to other groups
+        needs[i] = std::min(caps[i], to_amp(sample.current + policy.headroom * sample.motors));
+        weights[i] = entry.weight;
+    }
+    // first give every group what it needs, then split what is left between the groups which could use more
+    Amps limits {};
+    const double spare = splitBudget(to_amp(policy.budget), needs, weights, count, limits);
+    Amps room {};
+    for (size_t i = 0; i < count; i++) room[i] = caps[i] - limits[i];
+    splitBudget(spare, room, weights, count, limits);
+
+    int32_t result = 0;
+    for (size_t i = 0; i < count; i++) {
+        GroupEntry& entry = m_groups[i];
+        PowerGroupState& state = states[i];
+        if (state.connected) {
+            const Current limit = from_amp(limits[i]);
+            // limits are only sent when they change enough to matter, as every motor is configured over the SDK
+            if (entry.applied.internal() == INFINITY || units::abs(limit - entry.applied) > policy.deadband) {
+                if (entry.group->setCurrentLimit(limit) == 0) entry.applied = limit;
+                else result = INT_MAX;
+            }
+        }
+        state.limit = entry.applied.internal() == INFINITY ? 0_amp : entry.applied;
+        entry.state.write(state);
+    }
+    if (result == INT_MAX) errno = ENODEV;
+    return result;
+}
+} // namespace lemlib
@@ -0,0 +1,51 @@
+#include "hardware/Motor/ThermalModel.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace lemlib {
+namespace {
+// the current at which the motor settles fullCurrentRise above ambient
+constexpr double FULL_CURRENT = 2.5;
+} // namespace
+
+void ThermalModel::update(Current current, Temperature measured, Time dt) {
+    const double reading = units::to_kelvin(measured);
+    if (!std::isfinite(reading)) return;
+    const double step = units::to_kelvin(m_parameters.resolution);
+    if (!m_initialized) {
+        m_temperature = units::from_kelvin(reading + step / 2);
+        m_initialized = true;
+        return;
+    }
+    if (std::isfinite(to_amp(current)) && to_sec(dt) > 0) {
+        // the exact solution of the model over dt, so it is stable however long the update takes
+        const double decay = std::exp(-to_sec(dt) / to_sec(m_parameters.timeConstant));
+        m_temperature = steadyState(current) + (m_temperature - steadyState(current)) * decay;
+    }
+    // the motor can only be between the reading and the next step
+    m_temperature = units::from_kelvin(std::clamp(units::to_kelvin(m_temperature), reading, reading + step));
+}
+
+Temperature ThermalModel::getTemperature() const { return m_initialized ? m_temperature : units::from_kelvin(NAN); }
+
+Temperature ThermalModel::predict(Current current, Time horizon) const {
+    if (!m_initialized) return units::from_kelvin(NAN);
+    const double decay = std::exp(-to_sec(horizon) / to_sec(m_parameters.timeConstant));
+    return steadyState(current) + (m_temperature - steadyState(current)) * decay;
+}
+
+Time ThermalModel::timeToThrottle(Current current) const {
+    if (!m_initialized) return from_sec(INFINITY);
+    if (m_temperature >= m_parameters.throttle) return 0_sec;
+    const Temperature settled = steadyState(current);
+    if (settled <= m_parameters.throttle) return from_sec(INFINITY);
+    // solve predict(current, t) = throttle for t
+    const double ratio = units::to_kelvin(settled - m_temperature) / units::to_kelvin(settled - m_parameters.throttle);
+    return m_parameters.timeConstant * std::log(ratio);
+}
+
+Temperature ThermalModel::steadyState(Current current) const {
+    const double load = to_amp(current) / FULL_CURRENT;
+    return m_parameters.ambient + m_parameters.fullCurrentRise * (load * load);
+}
+} // namespace lemlib
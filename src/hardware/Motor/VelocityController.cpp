@@ -0,0 +1,141 @@
+#include "hardware/Motor/VelocityController.hpp"
+#include "hardware/AllocationTracker.hpp"
+#include "hardware/BootTrace.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+VelocityController::VelocityController(Motor& motor, VelocityControllerGains gains, Time period)
+    : m_target(motor),
+      m_move(moveTarget<Motor>),
+      m_measure(measureTarget<Motor>),
+      m_period(period),
+      m_gains(gains),
+      m_setpoint(Setpoint {}),
+      m_timing(VelocityControllerTiming {}) {}
+
+VelocityController::VelocityController(MotorGroup& motors, VelocityControllerGains gains, Time period)
+    : m_target(motors),
+      m_move(moveTarget<MotorGroup>),
+      m_measure(measureTarget<MotorGroup>),
+      m_period(period),
+      m_gains(gains),
+      m_setpoint(Setpoint {}),
+      m_timing(VelocityControllerTiming {}) {}
+
+VelocityController::~VelocityController() { stop(); }
+
+template <typename T> int32_t VelocityController::moveTarget(Encoder& target, Number power) {
+    return static_cast<T&>(target).move(power);
+}
+
+template <typename T> AngularVelocity VelocityController::measureTarget(const Encoder& target) {
+    return static_cast<const T&>(target).getVelocity();
+}
+
+int32_t VelocityController::setTarget(AngularVelocity velocity, AngularAcceleration acceleration) {
+    // the buffer only supports one writer at a time
+    std::lock_guard lock(m_mutex);
+    m_setpoint.write({.velocity = velocity, .acceleration = acceleration});
+    return 0;
+}
+
+AngularVelocity VelocityController::getTarget() const { return m_setpoint.read().velocity; }
+
+int32_t VelocityController::setGains(VelocityControllerGains gains) {
+    std::lock_guard lock(m_mutex);
+    m_gains.write(gains);
+    m_resetIntegral = true;
+    return 0;
+}
+
+VelocityControllerGains VelocityController::getGains() const { return m_gains.read(); }
+
+VelocityControllerTiming VelocityController::getTiming() const { return m_timing.read(); }
+
+int32_t VelocityController::update() {
+    LEMLIB_ALLOCATION_FREE("VelocityController::update");
+    const uint64_t start = pros::c::micros();
+    const VelocityControllerGains gains = m_gains.read();
+    const Setpoint setpoint = m_setpoint.read();
+    const AngularVelocity measured = m_measure(m_target);
+    if (measured == from_rpm(INFINITY)) {
+        // the PID starts over once the target can be measured again, so the gap isn't integrated
+        m_resetIntegral = true;
+        return INT_MAX;
+    }
+    const double target = to_rpm(setpoint.velocity);
+    const double error = target - to_rpm(measured);
+    // the time since the last update is measured, so a late update doesn't throw off the integral and derivative
+    const double dt = (start - m_lastUpdate) / 1E6;
+    const bool reset = m_resetIntegral.exchange(false) || m_lastUpdate == 0 || dt <= 0;
+    if (reset) m_integral = 0;
+    const double derivative = reset ? 0 : (error - m_lastError) / dt;
+    const double staticFriction = target == 0 ? 0 : std::copysign(gains.kS, target);
+    const double feedforward = staticFriction + gains.kV * target + gains.kA * to_rpm(setpoint.acceleration * 1_sec);
+    const double unclamped = feedforward + gains.kP * error + gains.kI * m_integral + gains.kD * derivative;
+    const double output = std::clamp(unclamped, -1.0, 1.0);
+    // the integral only grows while the output can still respond to it, which keeps it from winding up
+    if (!reset && (output == unclamped || (unclamped > 0) != (error > 0))) m_integral += error * dt;
+    m_lastError = error;
+    const int32_t result = m_move(m_target, output);
+    // the period is only measured between updates of the same run, not across a stop and start
+    VelocityControllerTiming timing = m_timing.read();
+    const uint64_t end = pros::c::micros();
+    if (m_lastUpdate != 0) {
+        timing.lastPeriod = from_usec(start - m_lastUpdate);
+        timing.maxJitter = std::max(timing.maxJitter, units::abs(timing.lastPeriod - m_period));
+    }
+    timing.lastExecution = from_usec(end - start);
+    timing.maxExecution = std::max(timing.maxExecution, timing.lastExecution);
+    timing.updates++;
+    m_timing.write(timing);
+    m_lastUpdate = start;
+    return result;
+}
+
+int32_t VelocityController::start(uint32_t priority) {
+    std::lock_guard lock(m_mutex);
+    if (m_running.load() || !m_taskExited.load()) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    m_running = true;
+    m_taskExited = false;
+    m_lastUpdate = 0;
+    m_timing.write({});
+    LEMLIB_BOOT_EVENT("create lemlib velocity controller task", 0);
+    const pros::task_t task =
+        pros::c::task_create(taskFunction, this, priority, TASK_STACK_DEPTH_DEFAULT, "lemlib velocity controller");
+    if (task == nullptr) {
+        m_running = false;
+        m_taskExited = true;
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+void VelocityController::stop() {
+    const bool wasRunning = m_running.exchange(false);
+    // wait for the task to finish its current update, so the controller can be safely destroyed afterwards
+    while (!m_taskExited.load()) pros::c::delay(1);
+    if (wasRunning) m_move(m_target, 0);
+}
+
+void VelocityController::taskFunction(void* controller) {
+    VelocityController& self = *static_cast<VelocityController*>(controller);
+    const uint32_t period = std::max(1.0, std::round(to_msec(self.m_period)));
+    uint32_t now = pros::c::millis();
+    while (self.m_running.load()) {
+        self.update();
+        pros::c::task_delay_until(&now, period);
+    }
+    // PROS deletes the task once this function returns
+    self.m_taskExited = true;
+}
+} // namespace lemlib
@@ -0,0 +1,126 @@
+#include "hardware/MutexPool.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <new>
+
+namespace lemlib {
+namespace {
+enum class SlotState : uint8_t { EMPTY, CREATING, FREE, USED };
+
+constexpr size_t POOL_SIZE = LEMLIB_MUTEX_POOL_SIZE;
+
+// the pool is constant initialized, so devices which are constructed as globals can lease mutexes before any other
+// static initializer has run
+alignas(pros::Mutex) unsigned char storage[POOL_SIZE][sizeof(pros::Mutex)];
+std::array<std::atomic<SlotState>, POOL_SIZE> states {};
+std::atomic<size_t> created = 0;
+std::atomic<size_t> inUse = 0;
+std::atomic<size_t> peak = 0;
+std::atomic<size_t> overflows = 0;
+
+pros::Mutex* slotMutex(size_t slot) { return std::launder(reinterpret_cast<pros::Mutex*>(storage[slot])); }
+
+/**
+ * @brief Create the RTOS mutex of an empty slot
+ *
+ * @param slot the index of the slot
+ * @param state the state of the slot once the mutex exists
+ * @return true the mutex was created
+ * @return false another task claimed the slot first
+ */
+bool createSlot(size_t slot, SlotState state) {
+    SlotState expected = SlotState::EMPTY;
+    if (!states[slot].compare_exchange_strong(expected, SlotState::CREATING)) return false;
+    new (storage[slot]) pros::Mutex();
+    created.fetch_add(1);
+    states[slot].store(state, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Lease a slot of the pool, creating its mutex if it is the first time the slot is used
+ *
+ * @return size_t the index of the slot, or SIZE_MAX if every slot is in use
+ */
+size_t leaseSlot() {
+    // reusing a mutex is preferred, so new mutexes are only created when the pool runs out of free ones
+    for (size_t slot = 0; slot < POOL_SIZE; slot++) {
+        SlotState expected = SlotState::FREE;
+        if (states[slot].compare_exchange_strong(expected, SlotState::USED, std::memory_order_acquire)) return slot;
+    }
+    for (size_t slot = 0; slot < POOL_SIZE; slot++) {
+        if (createSlot(slot, SlotState::USED)) return slot;
+    }
+    return SIZE_MAX;
+}
+} // namespace
+
+PooledMutex::PooledMutex() { initialize(); }
+
+void PooledMutex::initialize() {
+    if (m_mutex != nullptr) return;
+    m_slot = leaseSlot();
+    if (m_slot == SIZE_MAX) {
+        overflows.fetch_add(1);
+        m_mutex = new pros::Mutex();
+        return;
+    }
+    m_mutex = slotMutex(m_slot);
+    const size_t count = inUse.fetch_add(1) + 1;
+    size_t highest = peak.load();
+    while (count > highest && !peak.compare_exchange_weak(highest, count)) {}
+}
+
+PooledMutex::PooledMutex(PooledMutex&& other) noexcept
+    : m_mutex(other.m_mutex),
+      m_slot(other.m_slot) {
+    other.m_mutex = nullptr;
+    other.m_slot = SIZE_MAX;
+}
+
+PooledMutex& PooledMutex::operator=(PooledMutex&& other) noexcept {
+    if (this == &other) return *this;
+    release();
+    m_mutex = other.m_mutex;
+    m_slot = other.m_slot;
+    other.m_mutex = nullptr;
+    other.m_slot = SIZE_MAX;
+    return *this;
+}
+
+PooledMutex::~PooledMutex() { release(); }
+
+void PooledMutex::release() {
+    if (m_mutex == nullptr) return;
+    if (m_slot == SIZE_MAX) {
+        delete m_mutex;
+    } else {
+        // the mutex stays in the slot, so the next device to lease it doesn't have to create one
+        inUse.fetch_sub(1);
+        states[m_slot].store(SlotState::FREE, std::memory_order_release);
+    }
+    m_mutex = nullptr;
+    m_slot = SIZE_MAX;
+}
+
+void PooledMutex::lock() { m_mutex->lock(); }
+
+void PooledMutex::unlock() { m_mutex->unlock(); }
+
+bool PooledMutex::try_lock() { return m_mutex->try_lock(); }
+
+size_t reserveMutexes(size_t count) {
+    count = std::min(count, POOL_SIZE);
+    for (size_t slot = 0; slot < POOL_SIZE && created.load() < count; slot++) createSlot(slot, SlotState::FREE);
+    return created.load();
+}
+
+MutexPoolStats getMutexPoolStats() {
+    return {.capacity = POOL_SIZE,
+            .created = created.load(),
+            .inUse = inUse.load(),
+            .peak = peak.load(),
+            .overflows = overflows.load()};
+}
+} // namespace lemlib
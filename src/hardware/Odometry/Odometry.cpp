@@ -0,0 +1,406 @@
+#include "hardware/Odometry/Odometry.hpp"
+#include "hardware/AllocationTracker.hpp"
+#include "hardware/BootTrace.hpp"
+#include "hardware/DevicePoller.hpp"
+#include "hardware/Odometry/SlipDetector.hpp"
+#include "hardware/Probe.hpp"
+#include "hardware/Trace.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+// a history whose latest sample is older than this has stopped being filled, so its wheel is read directly
+constexpr Time MAX_SAMPLE_AGE = 50_msec;
+
+TrackingWheel::TrackingWheel(Encoder& encoder, Length diameter, Length offset)
+    : m_encoder(&encoder),
+      m_diameter(diameter),
+      m_offset(offset) {}
+
+Length TrackingWheel::getDistance() const {
+    const Result<Angle> angle = m_encoder->tryGetAngle();
+    if (!angle.ok()) [[unlikely]]
+        return from_in(INFINITY); // error checking
+    // arc length = angle * radius
+    return m_diameter * to_stRad(angle.value()) / 2;
+}
+
+TrackingWheel::TrackingWheel(Encoder& encoder, Length diameter, Length offset, const SlipDetector& slipDetector)
+    : m_encoder(&encoder),
+      m_diameter(diameter),
+      m_offset(offset),
+      m_slipDetector(&slipDetector) {}
+
+TrackingWheel::TrackingWheel(Encoder& encoder, Length diameter, Length offset, const EncoderHistoryBase& history)
+    : m_encoder(&encoder),
+      m_diameter(diameter),
+      m_offset(offset),
+      m_history(&history) {}
+
+TrackingWheel::TrackingWheel(Encoder& encoder, Length diameter, Length offset, const EncoderHistoryBase& history,
+                             const SlipDetector& slipDetector)
+    : m_encoder(&encoder),
+      m_diameter(diameter),
+      m_offset(offset),
+      m_slipDetector(&slipDetector),
+      m_history(&history) {}
+
+Length TrackingWheel::getDistance(Time timestamp) const {
+    if (m_history == nullptr) return getDistance();
+    const Angle angle = m_history->getAngle(timestamp);
+    if (angle == from_stDeg(INFINITY)) [[unlikely]]
+        return from_in(INFINITY); // error checking
+    return m_diameter * to_stRad(angle) / 2;
+}
+
+Time TrackingWheel::getLatestTimestamp() const {
+    if (m_history == nullptr || m_history->getSize() == 0) return from_sec(INFINITY);
+    return m_history->getSample(0).timestamp;
+}
+
+Length TrackingWheel::getOffset() const { return m_offset; }
+
+bool TrackingWheel::isSlipping() const { return m_slipDetector != nullptr && m_slipDetector->isSlipping(); }
+
+Odometry::Odometry(const std::vector<TrackingWheel>& verticals, const std::vector<TrackingWheel>& horizontals,
+                   IMU& imu)
+    : Odometry(verticals, horizontals) {
+    m_imu = &imu;
+}
+
+Odometry::Odometry(const std::vector<TrackingWheel>& verticals, const std::vector<TrackingWheel>& horizontals)
+    : m_verticalDeltas(verticals.size(), 0_in),
+      m_horizontalDeltas(horizontals.size(), 0_in),
+      m_imu(nullptr) {
+    m_verticals.reserve(verticals.size());
+    for (const TrackingWheel& wheel : verticals) m_verticals.push_back({.wheel = wheel});
+    m_horizontals.reserve(horizontals.size());
+    for (const TrackingWheel& wheel : horizontals) m_horizontals.push_back({.wheel = wheel});
+}
+
+Odometry::~Odometry() { stop(); }
+
+units::Pose Odometry::getPose() const { return m_publishedPose.read(); }
+
+const Topic<units::Pose>& Odometry::getPoseTopic() const { return m_publishedPose; }
+
+units::Pose Odometry::getPose(Time timestamp) const {
+    std::lock_guard lock(m_mutex);
+    if (m_history == nullptr) {
+        errno = EINVAL;
+        return {from_in(INFINITY), from_in(INFINITY), from_stDeg(INFINITY)};
+    }
+    return m_history->getPose(timestamp);
+}
+
+units::Pose Odometry::predictPose(Time latency, Time window) const {
+    std::lock_guard lock(m_mutex);
+    if (m_history == nullptr) {
+        errno = EINVAL;
+        return {from_in(INFINITY), from_in(INFINITY), from_stDeg(INFINITY)};
+    }
+    return m_history->predictPose(from_usec(pros::c::micros()) + latency, window);
+}
+
+void Odometry::setPose(units::Pose pose) {
+    std::lock_guard lock(m_mutex);
+    setIntegratedPose(pose);
+    if (m_history != nullptr) {
+        m_history->clear();
+        m_history->push(from_usec(pros::c::micros()), pose);
+    }
+}
+
+void Odometry::setHistory(PoseHistoryBase& history) {
+    std::lock_guard lock(m_mutex);
+    m_history = &history;
+}
+
+int32_t Odometry::setTiltSource(const DevicePoller& poller, int32_t index) {
+    if (index < 0) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    std::lock_guard lock(m_mutex);
+    m_tiltPoller = &poller;
+    m_tiltIndex = index;
+    return 0;
+}
+
+int32_t Odometry::correctPose(Time timestamp, units::Pose measured) {
+    std::lock_guard lock(m_mutex);
+    if (m_history == nullptr) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    const units::Pose past = m_history->getPose(timestamp);
+    if (past.x == from_in(INFINITY)) return INT_MAX; // error checking
+    // the motion since the measurement, relative to where the robot was
+    const units::Pose motion = past.inverse().compose(getIntegratedPose());
+    const units::Pose corrected = measured.compose(motion);
+    setIntegratedPose(corrected);
+    m_history->clear();
+    m_history->push(from_usec(pros::c::micros()), corrected);
+    return 0;
+}
+
+Length Odometry::readDelta(WheelState& state, Time timestamp) {
+    // a wheel whose history stopped before the instant is read directly
+    const bool interpolate = timestamp != from_sec(INFINITY) && state.wheel.getLatestTimestamp() >= timestamp;
+    const Length distance = interpolate ? state.wheel.getDistance(timestamp) : state.wheel.getDistance();
+    // the wheel is read again next update if it failed, and is not used until it has a valid previous reading
+    if (distance == from_in(INFINITY)) {
+        state.valid = false;
+        return from_in(INFINITY);
+    }
+    const bool wasValid = state.valid;
+    const Length delta = distance - state.lastDistance;
+    state.lastDistance = distance;
+    state.valid = true;
+    return wasValid ? delta : from_in(INFINITY);
+}
+
+Time Odometry::findCommonTimestamp(uint64_t now) const {
+    Time common = from_sec(INFINITY);
+    const auto include = [&](const WheelState& state) {
+        const Time latest = state.wheel.getLatestTimestamp();
+        // a history stops being filled while its encoder is unplugged, and would hold every other wheel back with it
+        if (from_usec(now) - latest <= MAX_SAMPLE_AGE) common = units::min(common, latest);
+    };
+    for (const WheelState& state : m_verticals) include(state);
+    for (const WheelState& state : m_horizontals) include(state);
+    return common;
+}
+
+Angle Odometry::wheelHeadingDelta(const WheelState& a, const WheelState& b, Length deltaA, Length deltaB) {
+    if (deltaA == from_in(INFINITY) || deltaB == from_in(INFINITY)) return from_stRad(INFINITY);
+    // a slipping wheel would turn the heading along with it
+    if (a.slipping || b.slipping) return from_stRad(INFINITY);
+    const Length spacing = a.wheel.getOffset() - b.wheel.getOffset();
+    if (spacing == 0_in) return from_stRad(INFINITY);
+    // a wheel with offset d reads forward - d * dTheta, so the difference between two wheels is proportional to the
+    // change in heading
+    return from_stRad(((deltaB - deltaA) / spacing).internal());
+}
+
+int32_t Odometry::update() {
+    LEMLIB_PROBE("Odometry::update");
+    LEMLIB_TRACE_SCOPE("Odometry::update");
+    LEMLIB_ALLOCATION_FREE("Odometry::update");
+    std::lock_guard lock(m_mutex);
+    // read every tracking wheel, interpolating the ones with a history to the same instant
+    const Time common = findCommonTimestamp(pros::c::micros());
+    for (size_t i = 0; i < m_verticals.size(); i++) m_verticalDeltas[i] = readDelta(m_verticals[i], common);
+    for (size_t i = 0; i < m_horizontals.size(); i++) m_horizontalDeltas[i] = readDelta(m_horizontals[i], common);
+    // slipping wheels are only used when every other wheel in the same direction is slipping or failed too
+    bool verticalsGrip = false;
+    for (size_t i = 0; i < m_verticals.size(); i++) {
+        m_verticals[i].slipping = m_verticals[i].wheel.isSlipping();
+        verticalsGrip = verticalsGrip || (!m_verticals[i].slipping && m_verticalDeltas[i] != from_in(INFINITY));
+    }
+    bool horizontalsGrip = false;
+    for (size_t i = 0; i < m_horizontals.size(); i++) {
+        m_horizontals[i].slipping = m_horizontals[i].wheel.isSlipping();
+        horizontalsGrip =
+            horizontalsGrip || (!m_horizontals[i].slipping && m_horizontalDeltas[i] != from_in(INFINITY));
+    }
+
+    // find the change in heading, preferring the IMU
+    Angle deltaTheta = from_stRad(INFINITY);
+    if (m_imu != nullptr) {
+        const Result<Angle> rotation = m_imu->tryGetRotation();
+        const uint64_t readTime = pros::c::micros();
+        Angle synced = rotation.valueOr(from_stRad(INFINITY));
+        Angle previous = m_lastSyncedImuRotation;
+        bool carried = false;
+        if (rotation.ok() && common != from_sec(INFINITY) && m_lastImuRotation != from_stRad(INFINITY) &&
+            readTime > m_lastImuTime) {
+            // the IMU is read after the wheels were sampled, so it is carried back to the same instant at the rate it
+            // turned since it was last read
+            const AngularVelocity rate = (rotation.value() - m_lastImuRotation) / from_usec(readTime - m_lastImuTime);
+            synced -= rate * (from_usec(readTime) - common);
+            carried = true;
+            // the previous reading had no rate to be carried back with yet, so it is carried back with this one
+            if (!m_imuCarried && m_lastCommon != from_sec(INFINITY)) {
+                previous = m_lastImuRotation - rate * (from_usec(m_lastImuTime) - m_lastCommon);
+            }
+        }
+        if (synced != from_stRad(INFINITY) && previous != from_stRad(INFINITY)) deltaTheta = synced - previous;
+        m_lastImuRotation = rotation.valueOr(from_stRad(INFINITY));
+        m_lastSyncedImuRotation = synced;
+        m_lastImuTime = readTime;
+        m_imuCarried = carried;
+    }
+    m_lastCommon = common;
+    if (deltaTheta == from_stRad(INFINITY) && m_verticals.size() >= 2) {
+        deltaTheta = wheelHeadingDelta(m_verticals[0], m_verticals[1], m_verticalDeltas[0], m_verticalDeltas[1]);
+    }
+    if (deltaTheta == from_stRad(INFINITY) && m_horizontals.size() >= 2) {
+        // horizontal wheels read sideways + d * dTheta, which is the opposite sign of vertical wheels
+        deltaTheta = -wheelHeadingDelta(m_horizontals[0], m_horizontals[1], m_horizontalDeltas[0],
+                                        m_horizontalDeltas[1]);
+    }
+    if (deltaTheta == from_stRad(INFINITY)) {
+        if (m_imu == nullptr && m_verticals.size() < 2 && m_horizontals.size() < 2) {
+            errno = EINVAL;
+            return INT_MAX;
+        }
+        // the heading sources are reconnecting or being read for the first time, so assume the robot didn't turn
+        deltaTheta = 0_stRad;
+    }
+    const double dTheta = to_stRad(deltaTheta);
+
+    // find the distance travelled by the tracking center, using every working tracking wheel
+    Length forward = 0_in;
+    int verticalCount = 0;
+    for (size_t i = 0; i < m_verticals.size(); i++) {
+        if (m_verticalDeltas[i] == from_in(INFINITY) || (verticalsGrip && m_verticals[i].slipping)) continue;
+        forward += m_verticalDeltas[i] + m_verticals[i].wheel.getOffset() * dTheta;
+        verticalCount++;
+    }
+    if (verticalCount != 0) forward /= verticalCount;
+    Length left = 0_in;
+    int horizontalCount = 0;
+    for (size_t i = 0; i < m_horizontals.size(); i++) {
+        if (m_horizontalDeltas[i] == from_in(INFINITY) || (horizontalsGrip && m_horizontals[i].slipping)) continue;
+        left += m_horizontalDeltas[i] - m_horizontals[i].wheel.getOffset() * dTheta;
+        horizontalCount++;
+    }
+    if (horizontalCount != 0) left /= horizontalCount;
+    if (m_tiltPoller != nullptr) {
+        const IMUSample sample = m_tiltPoller->getIMUSample(m_tiltIndex);
+        if (sample.hasOrientation) {
+            // the length of the part of each axis of the robot which lies along the field
+            const units::Vector3D<Number> x = sample.orientation.rotate(units::Vector3D<Number>(1, 0, 0));
+            const units::Vector3D<Number> y = sample.orientation.rotate(units::Vector3D<Number>(0, 1, 0));
+            forward *= std::sqrt(to_num(x.x * x.x + x.y * x.y));
+            left *= std::sqrt(to_num(y.x * y.x + y.y * y.y));
+        }
+    }
+
+    // the robot moves along an arc, so the displacement is the chord of that arc
+    const double chordScale = dTheta == 0 ? 1.0 : 2 * std::sin(dTheta / 2) / dTheta;
+    const double averageHeading = to_stRad(m_orientation.value()) + dTheta / 2;
+    const double cosine = std::cos(averageHeading);
+    const double sine = std::sin(averageHeading);
+    m_x += (forward * cosine - left * sine) * chordScale;
+    m_y += (forward * sine + left * cosine) * chordScale;
+    m_orientation += deltaTheta;
+    const units::Pose pose = getIntegratedPose();
+    m_publishedPose.publish(pose);
+    const uint64_t now = pros::c::micros();
+    if (m_history != nullptr) m_history->push(from_usec(now), pose);
+    if (m_adaptive) adaptRate(now, from_m(std::hypot(to_m(forward), to_m(left))), deltaTheta);
+    m_lastUpdate = now;
+    return 0;
+}
+
+int32_t Odometry::updateIfDue() {
+    // half a millisecond early still counts, so the jitter of the scheduler doesn't skip a whole tick
+    const uint64_t period = std::llround(to_usec(m_currentPeriod.load()));
+    if (pros::c::micros() - m_lastUpdate.load() + 500 < period) return 0;
+    return update();
+}
+
+void Odometry::adaptRate(uint64_t now, Length distance, Angle turn) {
+    const Time elapsed = from_usec(now - m_lastUpdate.load());
+    // compared as distances, so an update in the same microsecond as the last doesn't divide by 0
+    if (distance > m_rate.restSpeed * elapsed || units::abs(turn) > m_rate.restTurnRate * elapsed) {
+        m_lastMoving = now;
+    }
+    const bool resting = from_usec(now - m_lastMoving) >= m_rate.restDelay;
+    if (resting == m_resting.load()) return;
+    m_resting = resting;
+    const Time period = resting ? m_rate.restingPeriod : m_rate.movingPeriod;
+    m_currentPeriod = period;
+    if (m_ratePoller != nullptr) m_ratePoller->setPeriod(period);
+}
+
+int32_t Odometry::setAdaptiveRate(AdaptiveRate settings, DevicePoller* poller) {
+    // written so NaN fails the comparisons
+    const bool periodsValid = settings.movingPeriod >= 1_msec && settings.restingPeriod >= settings.movingPeriod &&
+                              settings.restingPeriod < from_sec(INFINITY);
+    const bool thresholdsValid = settings.restSpeed >= 0_mps && settings.restTurnRate >= 0_radps &&
+                                 settings.restDelay >= 0_sec;
+    if (!periodsValid || !thresholdsValid) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    std::lock_guard lock(m_mutex);
+    m_adaptive = true;
+    m_rate = settings;
+    m_ratePoller = poller;
+    // the robot counts as moving until it has been still for the delay
+    m_lastMoving = pros::c::micros();
+    m_resting = false;
+    m_currentPeriod = settings.movingPeriod;
+    if (poller != nullptr) poller->setPeriod(settings.movingPeriod);
+    return 0;
+}
+
+void Odometry::clearAdaptiveRate() {
+    std::lock_guard lock(m_mutex);
+    m_adaptive = false;
+    m_ratePoller = nullptr;
+    m_resting = false;
+    m_currentPeriod = m_period;
+}
+
+Time Odometry::getPeriod() const { return m_currentPeriod.load(); }
+
+bool Odometry::isResting() const { return m_resting.load(); }
+
+units::Pose Odometry::getIntegratedPose() const { return {m_x.value(), m_y.value(), m_orientation.value()}; }
+
+void Odometry::setIntegratedPose(units::Pose pose) {
+    m_x.reset(pose.x);
+    m_y.reset(pose.y);
+    m_orientation.reset(pose.orientation);
+    m_publishedPose.publish(pose);
+}
+
+int32_t Odometry::start(Time period, uint32_t priority) {
+    std::lock_guard lock(m_mutex);
+    if (m_running.load() || !m_taskExited.load()) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    m_period = period;
+    if (!m_adaptive) m_currentPeriod = period;
+    m_running = true;
+    m_taskExited = false;
+    LEMLIB_BOOT_EVENT("create lemlib odometry task", 0);
+    const pros::task_t task =
+        pros::c::task_create(taskFunction, this, priority, TASK_STACK_DEPTH_DEFAULT, "lemlib odometry");
+    if (task == nullptr) {
+        m_running = false;
+        m_taskExited = true;
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+void Odometry::stop() {
+    m_running = false;
+    // wait for the task to finish its current update, so the odometry can be safely destroyed afterwards
+    while (!m_taskExited.load()) pros::c::delay(1);
+}
+
+void Odometry::taskFunction(void* odometry) {
+    Odometry& self = *static_cast<Odometry*>(odometry);
+    uint32_t now = pros::c::millis();
+    while (self.m_running.load()) {
+        self.update();
+        // read every loop, as an adaptive rate changes it
+        const uint32_t period = std::max(1.0, std::round(to_msec(self.m_currentPeriod.load())));
+        pros::c::task_delay_until(&now, period);
+    }
+    // PROS deletes the task once this function returns
+    self.m_taskExited = true;
+}
+} // namespace lemlib
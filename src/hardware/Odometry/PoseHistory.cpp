@@ -0,0 +1,123 @@
+#include "hardware/Odometry/PoseHistory.hpp"
+#include <algorithm>
+#include <cmath>
+#include <errno.h>
+
+namespace lemlib {
+PoseHistoryBase::PoseHistoryBase(PoseSample* storage, size_t capacity)
+    : m_storage(storage),
+      m_capacity(capacity) {}
+
+void PoseHistoryBase::push(Time timestamp, const units::Pose& pose) {
+    const uint32_t head = m_head.load(std::memory_order_relaxed);
+    // the binary search needs timestamps which never decrease. Only this task writes, so the latest pose can be read
+    if (head != m_start.load(std::memory_order_relaxed)) {
+        timestamp = std::max(timestamp, m_storage[(head - 1) % m_capacity].timestamp);
+    }
+    m_storage[head % m_capacity] = {.timestamp = timestamp, .pose = pose};
+    m_head.store(head + 1, std::memory_order_release);
+}
+
+void PoseHistoryBase::clear() { m_start.store(m_head.load(std::memory_order_relaxed), std::memory_order_release); }
+
+PoseSample PoseHistoryBase::invalidSample() {
+    return {.timestamp = from_sec(INFINITY), .pose = {from_in(INFINITY), from_in(INFINITY), from_stRad(INFINITY)}};
+}
+
+units::Pose PoseHistoryBase::getPose(Time timestamp) const {
+    while (true) {
+        // the start is loaded first, so it is never after the head
+        const uint32_t start = m_start.load(std::memory_order_acquire);
+        const uint32_t head = m_head.load(std::memory_order_acquire);
+        const size_t size = std::min<size_t>(head - start, getCapacity());
+        if (size == 0) {
+            errno = EINVAL;
+            return invalidSample().pose;
+        }
+        // the writer is never writing to the slot of a pose until it wraps around to it
+        auto sample = [&](size_t age) { return m_storage[(head - 1 - age) % m_capacity]; };
+        auto unchanged = [&](size_t age) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return m_head.load(std::memory_order_relaxed) - head < m_capacity - age - 1;
+        };
+        const PoseSample latest = sample(0);
+        if (timestamp >= latest.timestamp) {
+            if (unchanged(0)) return latest.pose;
+            continue;
+        }
+        // newer poses have smaller ages, so timestamps decrease with age
+        size_t newer = 0;
+        size_t older = size - 1;
+        if (sample(older).timestamp > timestamp) {
+            if (!unchanged(older)) continue;
+            errno = ERANGE;
+            return invalidSample().pose;
+        }
+        while (older - newer > 1) {
+            const size_t middle = (newer + older) / 2;
+            if (sample(middle).timestamp <= timestamp) older = middle;
+            else newer = middle;
+        }
+        const PoseSample before = sample(older);
+        const PoseSample after = sample(newer);
+        // a pose overwritten during the search could have misled it, so the result is checked before it is used
+        if (!unchanged(older) || before.timestamp > timestamp || after.timestamp <= timestamp) continue;
+        const double t = to_sec(timestamp - before.timestamp) / to_sec(after.timestamp - before.timestamp);
+        // odometry doesn't wrap the orientation, so it can be interpolated like the position
+        return {before.pose.x + (after.pose.x - before.pose.x) * t, before.pose.y + (after.pose.y - before.pose.y) * t,
+                before.pose.orientation + (after.pose.orientation - before.pose.orientation) * t};
+    }
+}
+
+units::Pose PoseHistoryBase::predictPose(Time timestamp, Time window) const {
+    const PoseSample latest = getLatest();
+    // getLatest has already set errno
+    if (latest.timestamp == from_sec(INFINITY)) return latest.pose;
+    if (timestamp <= latest.timestamp) return getPose(timestamp);
+    // written so NaN fails the comparison
+    if (!(window > 0_sec)) return latest.pose;
+    const units::Pose past = getPose(latest.timestamp - window);
+    // the history is too short to measure the velocity over the window, so the robot is assumed to be still
+    if (past.x == from_in(INFINITY)) return latest.pose;
+    // the motion over the window is turned back into the forward and sideways distances of an odometry step
+    const double turn = to_stRad(latest.pose.orientation - past.orientation);
+    const double heading = to_stRad(past.orientation) + turn / 2;
+    const double dx = to_m(latest.pose.x - past.x);
+    const double dy = to_m(latest.pose.y - past.y);
+    const double arcScale = turn == 0 ? 1.0 : turn / (2 * std::sin(turn / 2));
+    const double forward = (dx * std::cos(heading) + dy * std::sin(heading)) * arcScale;
+    const double left = (dy * std::cos(heading) - dx * std::sin(heading)) * arcScale;
+    // and repeated from the latest pose, scaled to the time ahead of it
+    const double scale = to_sec(timestamp - latest.timestamp) / to_sec(window);
+    const double predictedTurn = turn * scale;
+    const double predictedHeading = to_stRad(latest.pose.orientation) + predictedTurn / 2;
+    const double chordScale = predictedTurn == 0 ? 1.0 : 2 * std::sin(predictedTurn / 2) / predictedTurn;
+    const double cosine = std::cos(predictedHeading);
+    const double sine = std::sin(predictedHeading);
+    return {latest.pose.x + from_m((forward * cosine - left * sine) * scale * chordScale),
+            latest.pose.y + from_m((forward * sine + left * cosine) * scale * chordScale),
+            latest.pose.orientation + from_stRad(predictedTurn)};
+}
+
+PoseSample PoseHistoryBase::getLatest() const {
+    while (true) {
+        const uint32_t start = m_start.load(std::memory_order_acquire);
+        const uint32_t head = m_head.load(std::memory_order_acquire);
+        if (head == start) {
+            errno = EINVAL;
+            return invalidSample();
+        }
+        const PoseSample sample = m_storage[(head - 1) % m_capacity];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_head.load(std::memory_order_relaxed) - head < m_capacity - 1) return sample;
+    }
+}
+
+size_t PoseHistoryBase::getSize() const {
+    const uint32_t start = m_start.load(std::memory_order_acquire);
+    return std::min<size_t>(m_head.load(std::memory_order_acquire) - start, getCapacity());
+}
+
+// one slot is always reserved for the writer, so it never writes to a slot which can be read
+size_t PoseHistoryBase::getCapacity() const { return m_capacity - 1; }
+} // namespace lemlib
@@ -0,0 +1,137 @@
+#include "hardware/Odometry/SlipDetector.hpp"
+#include "hardware/AllocationTracker.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+SlipDetector::SlipDetector(MotorGroup& motors, V5InertialSensor& imu, Length wheelDiameter,
+                           SlipDetectorSettings settings)
+    : m_motors(motors),
+      m_imu(imu),
+      m_wheelDiameter(wheelDiameter) {
+    m_settings.write(settings);
+}
+
+int32_t SlipDetector::update() {
+    LEMLIB_ALLOCATION_FREE("SlipDetector::update");
+    const SlipDetectorSettings settings = m_settings.read();
+    const int32_t count = m_motors.getTelemetry(m_telemetry);
+    if (count == 0 || count == INT_MAX) {
+        errno = ENODEV;
+        return INT_MAX;
+    }
+    const double now = to_sec(from_usec(pros::c::micros()));
+    // average the motors, so the wheels are treated as one
+    double velocity = 0;
+    double current = 0;
+    for (int32_t i = 0; i < count; i++) {
+        velocity += to_radps(m_telemetry[i].velocity);
+        current += std::abs(to_amp(m_telemetry[i].current));
+    }
+    velocity /= count;
+    current /= count;
+    const double speed = velocity * to_m(m_wheelDiameter) / 2;
+    SlipState state = m_state.read();
+    state.timestamp = from_sec(now);
+    if (!m_started) {
+        // there is no previous velocity to find the acceleration of the wheels from yet
+        m_started = true;
+        m_lastTime = now;
+        m_lastSpeed = speed;
+        m_state.write(state);
+        return 0;
+    }
+    const double dt = now - m_lastTime;
+    if (dt <= 0) return 0;
+    m_lastTime = now;
+    const double wheelAcceleration = (speed - m_lastSpeed) / dt;
+    m_lastSpeed = speed;
+    state.wheelAcceleration = from_mps2(wheelAcceleration);
+
+    const units::Vector3D<LinearAcceleration> acceleration = m_imu.getAcceleration();
+    const bool imuValid = acceleration.x != from_mps2(INFINITY);
+    // the IMU is assumed to be mounted flat, so the lateral axis is the forward axis turned a quarter turn around z
+    const double forwardX = settings.imuForward.x.internal();
+    const double forwardY = settings.imuForward.y.internal();
+    const double forwardZ = settings.imuForward.z.internal();
+    const double forwardLength = std::sqrt(forwardX * forwardX + forwardY * forwardY + forwardZ * forwardZ);
+    const double lateralLength = std::hypot(forwardX, forwardY);
+    double forwardResidual = 0;
+    double lateralResidual = 0;
+    if (imuValid && forwardLength > 0) {
+        const double ax = to_mps2(acceleration.x), ay = to_mps2(acceleration.y), az = to_mps2(acceleration.z);
+        const double forward = (ax * forwardX + ay * forwardY + az * forwardZ) / forwardLength;
+        const double lateral = lateralLength > 0 ? (ay * forwardX - ax * forwardY) / lateralLength : 0;
+        // the baselines soak up anything which changes slowly, like gravity on a tilted robot, the bias of the
+        // accelerometer and the centripetal acceleration through a turn
+        if (!m_baselineValid) {
+            m_baselineForward = forward - wheelAcceleration;
+            m_baselineLateral = lateral;
+            m_baselineValid = true;
+        }
+        forwardResidual = forward - wheelAcceleration - m_baselineForward;
+        lateralResidual = lateral - m_baselineLateral;
+        state.imuAcceleration = from_mps2(forward - m_baselineForward);
+    } else {
+        m_baselineValid = false;
+        state.imuAcceleration = from_mps2(wheelAcceleration);
+    }
+
+    // CUSUM of the disagreement between the wheels and the IMU
+    if (imuValid) {
+        m_slipSum = std::max(0.0, m_slipSum + (std::abs(forwardResidual) - to_mps2(settings.slipAllowance)) * dt);
+    } else m_slipSum = 0;
+    state.slipEvidence = from_mps(m_slipSum);
+    const bool slipDetected = m_slipSum >= to_mps(settings.slipThreshold);
+
+    // an impact is the robot accelerating much harder than its wheels, in any horizontal direction. Wheels spinning
+    // out disagree with the IMU too, but the other way around
+    const double forwardExcess = std::max(0.0, std::abs(to_mps2(state.imuAcceleration)) - std::abs(wheelAcceleration));
+    const bool impact = imuValid && std::hypot(forwardExcess, lateralResidual) >= to_mps2(settings.impactThreshold);
+    // pushing against something draws current without moving, or accelerating
+    const bool pushing = current >= to_amp(settings.stallCurrent) &&
+                         std::abs(velocity) < to_radps(settings.stallVelocity) &&
+                         (!imuValid || std::abs(state.imuAcceleration.internal()) < to_mps2(settings.slipAllowance));
+    m_stalledFor = pushing ? m_stalledFor + dt : 0;
+    const bool collisionDetected = impact || m_stalledFor >= to_sec(settings.stallTime);
+
+    // the baselines only learn from quiet updates, so a slip or a collision doesn't become part of them
+    if (imuValid && !slipDetected && !impact) {
+        const double gain = dt / (to_sec(settings.baselineTimeConstant) + dt);
+        m_baselineForward += gain * forwardResidual;
+        m_baselineLateral += gain * lateralResidual;
+    }
+
+    const double hold = to_sec(settings.holdTime);
+    if (slipDetected) {
+        if (now >= m_slipUntil) state.slips++;
+        m_slipUntil = now + hold;
+    }
+    if (collisionDetected) {
+        if (now >= m_collisionUntil) state.collisions++;
+        m_collisionUntil = now + hold;
+    }
+    state.slipping = slipDetected || now < m_slipUntil;
+    state.colliding = collisionDetected || now < m_collisionUntil;
+    m_state.write(state);
+    return 0;
+}
+
+SlipState SlipDetector::getState() const { return m_state.read(); }
+
+bool SlipDetector::isSlipping() const { return m_state.read().slipping; }
+
+bool SlipDetector::isColliding() const { return m_state.read().colliding; }
+
+int32_t SlipDetector::setSettings(SlipDetectorSettings settings) {
+    std::lock_guard lock(m_mutex);
+    m_settings.write(settings);
+    return 0;
+}
+
+SlipDetectorSettings SlipDetector::getSettings() const { return m_settings.read(); }
+} // namespace lemlib
@@ -0,0 +1,43 @@
+#include "hardware/Odometry/WallReset.hpp"
+#include <climits>
+#include <cmath>
+#include <errno.h>
+
+namespace lemlib {
+int32_t resetFromWall(Odometry& odometry, const DistanceSample& sample, units::Pose offset, Wall wall,
+                      Angle maxIncidence) {
+    if (!sample.connected) {
+        errno = ENODEV;
+        return INT_MAX;
+    }
+    const Length distance = sample.median != from_in(INFINITY) ? sample.median : sample.distance;
+    if (distance == from_in(INFINITY)) {
+        errno = ERANGE;
+        return INT_MAX;
+    }
+    // the pose when the sample was taken, if the history of the odometry goes back that far
+    units::Pose pose = odometry.getPose(sample.timestamp);
+    const bool inHistory = pose.x != from_in(INFINITY);
+    if (!inHistory) pose = odometry.getPose();
+    const bool xAxis = wall.axis == FieldAxis::X;
+    const double heading = to_stRad(pose.orientation + offset.orientation);
+    // how much of the beam goes along the axis, which is 1 or -1 when the sensor faces the wall straight on
+    const double along = xAxis ? std::cos(heading) : std::sin(heading);
+    const Length robot = xAxis ? pose.x : pose.y;
+    // the beam has to point towards the wall from the robot, and can't glance along it
+    if (std::abs(along) < std::cos(to_stRad(maxIncidence)) || to_m(wall.position - robot) * along <= 0) {
+        errno = EDOM;
+        return INT_MAX;
+    }
+    // how far the sensor is from the tracking center along the axis, at the heading of the robot
+    const units::V2Position sensor = pose.transform(units::V2Position(offset.x, offset.y));
+    const Length mount = (xAxis ? sensor.x : sensor.y) - robot;
+    const Length reset = wall.position - distance * along - mount;
+    units::Pose measured = pose;
+    if (xAxis) measured.x = reset;
+    else measured.y = reset;
+    if (inHistory) return odometry.correctPose(sample.timestamp, measured);
+    odometry.setPose(measured);
+    return 0;
+}
+} // namespace lemlib
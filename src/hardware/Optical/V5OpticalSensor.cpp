@@ -0,0 +1,99 @@
+#include "hardware/Optical/V5OpticalSensor.hpp"
+#include "hardware/SdkCallTracker.hpp"
+#include "pros/error.h"
+#include "pros/optical.h"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <mutex>
+
+namespace lemlib {
+V5OpticalSensor::V5OpticalSensor(SmartPort port, const HueClassifier& classifier, OpticalSettings settings)
+    : m_port(port),
+      m_classifier(classifier),
+      m_settings(settings),
+      m_claim(m_port, pros::c::E_DEVICE_OPTICAL) {}
+
+V5OpticalSensor::V5OpticalSensor(const V5OpticalSensor& other)
+    : m_port(other.m_port),
+      m_classifier(other.m_classifier),
+      m_settings(other.m_settings.read()),
+      m_claim(other.m_claim) {}
+
+#ifndef LEMLIB_SIM
+V5OpticalSensor V5OpticalSensor::from_pros_optical(pros::Optical sensor, const HueClassifier& classifier,
+                                                   OpticalSettings settings) {
+    return V5OpticalSensor({sensor.get_port(), runtime_check_port}, classifier, settings);
+}
+#endif
+
+int32_t V5OpticalSensor::isConnected() const {
+    return DeviceRegistry::get().isPlugged(m_port, pros::c::E_DEVICE_OPTICAL);
+}
+
+int32_t V5OpticalSensor::startInitialization() {
+    const double integrationTime = to_msec(MIN_INTEGRATION_TIME);
+    if (LEMLIB_SDK_CALL(m_port, pros::c::optical_set_integration_time(m_port, integrationTime)) == INT_MAX) {
+        m_reconfigure = true;
+        return INT_MAX;
+    }
+    const double ledPower = std::clamp(m_settings.read().ledPower.internal(), 0.0, 1.0);
+    if (LEMLIB_SDK_CALL(m_port, pros::c::optical_set_led_pwm(m_port, uint8_t(ledPower * 100))) == INT_MAX) {
+        m_reconfigure = true;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+OpticalReading V5OpticalSensor::getReading() {
+    OpticalReading reading;
+    reading.timestamp = from_usec(pros::c::micros());
+    const double hue = LEMLIB_SDK_CALL(m_port, pros::c::optical_get_hue(m_port));
+    const double saturation = hue == PROS_ERR_F ? PROS_ERR_F
+                                                : LEMLIB_SDK_CALL(m_port, pros::c::optical_get_saturation(m_port));
+    int32_t proximity = INT_MAX;
+    if (saturation != PROS_ERR_F) proximity = LEMLIB_SDK_CALL(m_port, pros::c::optical_get_proximity(m_port));
+    if (proximity == INT_MAX) {
+        // the sensor may have lost power, and the object is seen again as a new detection once it can be read
+        m_reconfigure = true;
+        if (m_color != HueClassifier::NONE) m_detectedAt = reading.timestamp;
+        m_color = HueClassifier::NONE;
+        reading.detectedAt = m_detectedAt;
+        return reading;
+    }
+    // the sensor reverts to an integration time of 100 ms when it reconnects. A reconnect between two reads is only
+    // seen by the DeviceRegistry
+    const uint32_t sequence = DeviceRegistry::get().getPlugSequence();
+    if (m_reconfigure.exchange(false) || sequence != m_plugSequence) {
+        m_plugSequence = sequence;
+        startInitialization();
+    }
+    reading.hue = from_stDeg(hue);
+    reading.saturation = saturation;
+    reading.proximity = double(proximity) / MAX_PROXIMITY;
+    const OpticalSettings settings = m_settings.read();
+    uint8_t color = HueClassifier::NONE;
+    if (reading.proximity >= settings.minProximity && reading.saturation >= settings.minSaturation) {
+        color = m_classifier.classify(reading.hue);
+    }
+    if (color != m_color) {
+        m_color = color;
+        m_detectedAt = reading.timestamp;
+    }
+    reading.color = color;
+    reading.detectedAt = m_detectedAt;
+    return reading;
+}
+
+int32_t V5OpticalSensor::setSettings(OpticalSettings settings) {
+    // the buffer only supports one writer at a time
+    std::lock_guard lock(m_mutex);
+    m_settings.write(settings);
+    m_reconfigure = true;
+    return 0;
+}
+
+OpticalSettings V5OpticalSensor::getSettings() const { return m_settings.read(); }
+
+uint8_t V5OpticalSensor::getPort() const { return m_port; }
+} // namespace lemlib
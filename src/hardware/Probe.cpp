@@ -0,0 +1,77 @@
+#include "hardware/Probe.hpp"
+#include <algorithm>
+#include <bit>
+#include <cinttypes>
+#include <climits>
+
+namespace lemlib {
+namespace {
+// histograms are only ever added to the front of the list, and never removed, so walking it never locks
+std::atomic<LatencyHistogram*> firstHistogram = nullptr;
+} // namespace
+
+LatencyHistogram::LatencyHistogram(const char* name)
+    : m_name(name) {
+    m_next = firstHistogram.load();
+    while (!firstHistogram.compare_exchange_weak(m_next, this)) {}
+}
+
+void LatencyHistogram::record(uint32_t micros) {
+    const size_t bucket = std::min<size_t>(std::bit_width(micros), BUCKETS - 1);
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_total.fetch_add(micros, std::memory_order_relaxed);
+    uint32_t max = m_max.load(std::memory_order_relaxed);
+    while (micros > max && !m_max.compare_exchange_weak(max, micros, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset() {
+    for (std::atomic<uint32_t>& bucket : m_buckets) bucket = 0;
+    m_count = 0;
+    m_max = 0;
+    m_total = 0;
+}
+
+void LatencyHistogram::dump(FILE* file) const {
+    const uint32_t count = m_count.load();
+    const uint64_t total = m_total.load();
+    std::fprintf(file, "%s,%" PRIu32 ",%" PRIu64 ",%" PRIu32, m_name, count, count == 0 ? 0 : total / count,
+                 m_max.load());
+    for (const std::atomic<uint32_t>& bucket : m_buckets) std::fprintf(file, ",%" PRIu32, bucket.load());
+    std::fprintf(file, "\n");
+}
+
+LatencyHistogram* LatencyHistogram::getFirst() { return firstHistogram.load(); }
+
+LatencyHistogram* LatencyHistogram::getNext() const { return m_next; }
+
+int32_t dumpProbes(FILE* file) {
+    std::fprintf(file, "name,count,mean_us,max_us");
+    // every bucket is named after the slowest call it counts
+    std::fprintf(file, ",<1");
+    for (size_t i = 1; i < LatencyHistogram::BUCKETS - 1; i++) std::fprintf(file, ",<%u", 1u << i);
+    std::fprintf(file, ",>=%u\n", 1u << (LatencyHistogram::BUCKETS - 2));
+    for (const LatencyHistogram* histogram = LatencyHistogram::getFirst(); histogram != nullptr;
+         histogram = histogram->getNext()) {
+        histogram->dump(file);
+    }
+    std::fflush(file);
+    return 0;
+}
+
+int32_t dumpProbes(const char* path) {
+    FILE* file = std::fopen(path, "w");
+    // fopen has already set errno
+    if (file == nullptr) return INT_MAX;
+    dumpProbes(file);
+    std::fclose(file);
+    return 0;
+}
+
+void resetProbes() {
+    for (LatencyHistogram* histogram = LatencyHistogram::getFirst(); histogram != nullptr;
+         histogram = histogram->getNext()) {
+        histogram->reset();
+    }
+}
+} // namespace lemlib
@@ -0,0 +1,220 @@
+#include "hardware/ReplayGate.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <errno.h>
+#ifdef LEMLIB_SIM
+#include <chrono>
+#endif
+
+namespace lemlib {
+namespace {
+constexpr uint16_t BASELINE_VERSION = 1;
+constexpr const char* STAGE_NAMES[] = {"odometry", "controller", "command"};
+
+// simulated time only moves when a task sleeps, so the host times the stages with its own clock
+double nowMicros() {
+#ifdef LEMLIB_SIM
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+    return pros::c::micros();
+#endif
+}
+
+// the part of a baseline before its steps
+struct BaselineHeader {
+        char magic[4] = {'L', 'R', 'P', 'B'};
+        uint16_t version = BASELINE_VERSION;
+        uint16_t stepSize = 0;
+        uint32_t steps = 0;
+        float typicalMicros[3] = {};
+};
+} // namespace
+
+ReplayGate::ReplayGate(ReplayLog& log, std::span<const PathSample> trajectory, ReplayRobot robot,
+                       DifferentialDrive* drive)
+    : m_log(log),
+      m_trajectory(trajectory),
+      m_robot(robot),
+      m_drive(drive),
+      m_leftEncoder(log, robot.leftEncoder),
+      m_rightEncoder(log, robot.rightEncoder),
+      m_imu(log, robot.imu),
+      m_controller(robot.trackWidth) {}
+
+int32_t ReplayGate::run() {
+    if (m_log.getSize() == 0 || !(m_robot.period > 0_sec)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    const size_t steps = size_t(to_sec(m_log.getDuration()) / to_sec(m_robot.period)) + 1;
+    m_steps.clear();
+    m_steps.reserve(steps);
+    for (std::vector<float>& durations : m_durations) {
+        durations.clear();
+        durations.reserve(steps);
+    }
+    m_odometry.emplace(std::vector<TrackingWheel> {{m_leftEncoder, m_robot.trackingWheelDiameter, m_robot.leftOffset},
+                                                   {m_rightEncoder, m_robot.trackingWheelDiameter,
+                                                    m_robot.rightOffset}},
+                       std::vector<TrackingWheel> {}, m_imu);
+    TrajectorySampler sampler(m_trajectory);
+    for (size_t i = 0; i < steps; i++) {
+        // stepping by index, so the time of a step doesn't depend on rounding errors adding up
+        const Time time = m_robot.period * double(i);
+        m_log.seek(time);
+        const double start = nowMicros();
+        m_odometry->update();
+        const double odometryDone = nowMicros();
+        const units::Pose pose = m_odometry->getPose();
+        const DriveVelocities velocities = m_controller.calculate(pose, sampler.sample(time));
+        const double controllerDone = nowMicros();
+        if (m_drive != nullptr) m_drive->moveVelocity(velocities, m_robot.driveWheelDiameter);
+        const double commandDone = nowMicros();
+        m_durations[0].push_back(odometryDone - start);
+        m_durations[1].push_back(controllerDone - odometryDone);
+        m_durations[2].push_back(commandDone - controllerDone);
+        m_steps.push_back({.x = float(to_m(pose.x)),
+                           .y = float(to_m(pose.y)),
+                           .orientation = float(to_stRad(pose.orientation)),
+                           .left = float(to_mps(velocities.left)),
+                           .right = float(to_mps(velocities.right))});
+    }
+    return steps;
+}
+
+ReplayTiming ReplayGate::getTiming(ReplayStage stage) const {
+    const std::vector<float>& durations = m_durations[size_t(stage)];
+    if (durations.empty()) return {};
+    std::vector<float> sorted = durations;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0;
+    for (float duration : sorted) total += duration;
+    const size_t p99 = std::min(sorted.size() - 1, (sorted.size() * 99) / 100);
+    return {.meanMicros = total / sorted.size(),
+            .medianMicros = sorted[sorted.size() / 2],
+            .p99Micros = sorted[p99],
+            .maxMicros = sorted.back()};
+}
+
+double ReplayGate::typicalMicros(size_t stage) const {
+    const std::vector<float>& durations = m_durations[stage];
+    if (durations.empty()) return 0;
+    std::vector<float> sorted = durations;
+    std::sort(sorted.begin(), sorted.end());
+    // the slowest percent is left out, as it is mostly other tasks preempting the replay
+    const size_t count = std::max<size_t>(1, (sorted.size() * 99) / 100);
+    double total = 0;
+    for (size_t i = 0; i < count; i++) total += sorted[i];
+    return total / count;
+}
+
+units::Pose ReplayGate::getPose(size_t step) const {
+    if (step >= m_steps.size()) return {from_in(INFINITY), from_in(INFINITY), from_stDeg(INFINITY)};
+    const Step& s = m_steps[step];
+    return {from_m(s.x), from_m(s.y), from_stRad(s.orientation)};
+}
+
+int32_t ReplayGate::saveBaseline(const char* path) const {
+    if (m_steps.empty()) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    BaselineHeader header;
+    header.stepSize = sizeof(Step);
+    header.steps = m_steps.size();
+    for (size_t i = 0; i < STAGES; i++) header.typicalMicros[i] = typicalMicros(i);
+    FILE* file = std::fopen(path, "wb");
+    // fopen has already set errno
+    if (file == nullptr) return INT_MAX;
+    const bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                         std::fwrite(m_steps.data(), sizeof(Step), m_steps.size(), file) == m_steps.size();
+    // the data may only reach the card when the file is closed
+    if (std::fclose(file) != 0 || !written) {
+        errno = EIO;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+int32_t ReplayGate::compare(const char* path, const ReplayLimits& limits, ReplayReport* report) const {
+    if (m_steps.empty()) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    FILE* file = std::fopen(path, "rb");
+    // fopen has already set errno
+    if (file == nullptr) return INT_MAX;
+    BaselineHeader header;
+    const bool valid = std::fread(&header, sizeof(header), 1, file) == 1 &&
+                       std::memcmp(header.magic, "LRPB", 4) == 0 && header.version == BASELINE_VERSION &&
+                       header.stepSize == sizeof(Step) && header.steps == m_steps.size();
+    if (!valid) {
+        std::fclose(file);
+        errno = EPROTO;
+        return INT_MAX;
+    }
+    ReplayReport result;
+    double position = 0;
+    double orientation = 0;
+    double command = 0;
+    // the baseline is read in batches, so a long match doesn't need a second copy of its steps in memory
+    std::array<Step, 64> batch;
+    size_t compared = 0;
+    size_t count;
+    while (compared < m_steps.size() && (count = std::fread(batch.data(), sizeof(Step), batch.size(), file)) != 0) {
+        count = std::min(count, m_steps.size() - compared);
+        for (size_t i = 0; i < count; i++) {
+            const Step& run = m_steps[compared + i];
+            const Step& base = batch[i];
+            position = std::max(position, std::hypot(double(run.x) - base.x, double(run.y) - base.y));
+            orientation = std::max(orientation, std::abs(double(run.orientation) - base.orientation));
+            command = std::max({command, std::abs(double(run.left) - base.left),
+                                std::abs(double(run.right) - base.right)});
+        }
+        compared += count;
+    }
+    std::fclose(file);
+    if (compared != m_steps.size()) {
+        errno = EPROTO;
+        return INT_MAX;
+    }
+    result.position = from_m(position);
+    result.orientation = from_stRad(orientation);
+    result.command = from_mps(command);
+    bool slow = false;
+    for (size_t i = 0; i < STAGES; i++) {
+        // a stage which took no time in the baseline, like a command without a drive, can't get slower
+        result.slowdown[i] = header.typicalMicros[i] > 0 ? typicalMicros(i) / header.typicalMicros[i] : 1;
+        slow = slow || result.slowdown[i] > limits.slowdown;
+    }
+    const bool drifted =
+        result.position > limits.position || result.orientation > limits.orientation || result.command > limits.command;
+    result.passed = !drifted && !slow;
+    if (report != nullptr) *report = result;
+    if (drifted) {
+        errno = ERANGE;
+        return INT_MAX;
+    }
+    if (slow) {
+        errno = ETIMEDOUT;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+void ReplayGate::print(const char* name) const {
+    for (size_t i = 0; i < STAGES; i++) {
+        const ReplayTiming timing = getTiming(ReplayStage(i));
+        std::printf("REPLAY {\"log\":\"%s\",\"stage\":\"%s\",\"n\":%u,\"mean_us\":%.2f,\"median_us\":%.2f,"
+                    "\"p99_us\":%.2f,\"max_us\":%.2f}\n",
+                    name, STAGE_NAMES[i], unsigned(m_durations[i].size()), timing.meanMicros, timing.medianMicros,
+                    timing.p99Micros, timing.maxMicros);
+    }
+    // flush, so results show up even if a later log hangs
+    std::fflush(stdout);
+}
+} // namespace lemlib
@@ -0,0 +1,105 @@
+#include "hardware/ReplayLog.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+namespace {
+// orders records by device, then kind, then timestamp
+bool recordBefore(const TelemetryRecord& a, const TelemetryRecord& b) {
+    if (a.device != b.device) return a.device < b.device;
+    if (a.kind != b.kind) return a.kind < b.kind;
+    return a.timestamp < b.timestamp;
+}
+} // namespace
+
+int32_t ReplayLog::load(const char* path) {
+    load(std::span<const TelemetryRecord>());
+    FILE* file = std::fopen(path, "rb");
+    // fopen has already set errno
+    if (file == nullptr) return INT_MAX;
+    std::array<uint8_t, 16> header;
+    uint16_t version = 0;
+    uint16_t recordSize = 0;
+    const bool valid = std::fread(header.data(), 1, header.size(), file) == header.size() &&
+                       std::memcmp(header.data(), "LLOG", 4) == 0;
+    std::memcpy(&version, &header[4], sizeof(version));
+    std::memcpy(&recordSize, &header[6], sizeof(recordSize));
+    if (!valid || version != TelemetryLogger::FORMAT_VERSION || recordSize != sizeof(TelemetryRecord)) {
+        std::fclose(file);
+        errno = EPROTO;
+        return INT_MAX;
+    }
+    std::vector<TelemetryRecord> records;
+    std::array<TelemetryRecord, 128> batch;
+    size_t count;
+    while ((count = std::fread(batch.data(), sizeof(TelemetryRecord), batch.size(), file)) != 0) {
+        records.insert(records.end(), batch.begin(), batch.begin() + count);
+    }
+    std::fclose(file);
+    load(records);
+    return 0;
+}
+
+void ReplayLog::load(std::span<const TelemetryRecord> records) {
+    m_records.assign(records.begin(), records.end());
+    // records of the same time keep the order they were logged in
+    std::stable_sort(m_records.begin(), m_records.end(), recordBefore);
+    m_start = UINT32_MAX;
+    m_end = 0;
+    for (const TelemetryRecord& record : m_records) {
+        m_start = std::min(m_start, record.timestamp);
+        m_end = std::max(m_end, record.timestamp);
+    }
+    if (m_records.empty()) m_start = 0;
+    seek(0_sec);
+}
+
+size_t ReplayLog::getSize() const { return m_records.size(); }
+
+Time ReplayLog::getDuration() const { return from_usec(m_end - m_start); }
+
+void ReplayLog::play() {
+    std::lock_guard lock(m_mutex);
+    Clock clock = m_clock.read();
+    if (clock.playing) return;
+    clock.anchor = pros::c::micros();
+    clock.playing = true;
+    m_clock.write(clock);
+}
+
+void ReplayLog::seek(Time time) {
+    std::lock_guard lock(m_mutex);
+    m_clock.write({.position = int64_t(std::round(to_usec(time))), .anchor = 0, .playing = false});
+}
+
+Time ReplayLog::getTime() const {
+    const Clock clock = m_clock.read();
+    if (!clock.playing) return from_usec(clock.position);
+    return from_usec(clock.position + int64_t(pros::c::micros() - clock.anchor));
+}
+
+const TelemetryRecord* ReplayLog::find(uint16_t device, TelemetryKind kind, Time time) const {
+    const double offset = std::round(to_usec(time));
+    if (!(offset >= 0)) return nullptr;
+    const TelemetryRecord key {.timestamp = uint32_t(std::min<double>(m_start + offset, UINT32_MAX)),
+                               .device = device,
+                               .kind = kind};
+    // the first record after the time, so the one before it is the latest one at the time
+    const auto next = std::upper_bound(m_records.begin(), m_records.end(), key, recordBefore);
+    if (next == m_records.begin()) return nullptr;
+    const TelemetryRecord& record = *(next - 1);
+    if (record.device != device || record.kind != kind) return nullptr;
+    return &record;
+}
+
+const TelemetryRecord* ReplayLog::find(uint16_t device, TelemetryKind kind) const {
+    return find(device, kind, getTime());
+}
+} // namespace lemlib
@@ -0,0 +1,150 @@
+#include "hardware/Routine.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <errno.h>
+#include <exception>
+#include <utility>
+
+namespace lemlib {
+Routine Routine::promise_type::get_return_object() noexcept {
+    const auto handle = std::coroutine_handle<promise_type>::from_promise(*this);
+    leaf = handle;
+    return Routine(handle);
+}
+
+void Routine::promise_type::unhandled_exception() const noexcept {
+    // a routine which threw can't be resumed, and the executor has nowhere to report it
+    std::terminate();
+}
+
+std::coroutine_handle<> Routine::promise_type::FinalAwaiter::await_suspend(
+    std::coroutine_handle<promise_type> handle) noexcept {
+    promise_type& promise = handle.promise();
+    // the root finished, so control goes back to the executor
+    if (!promise.parent) return std::noop_coroutine();
+    // the awaiting routine continues straight away, in the same update
+    promise.root->leaf = promise.parent;
+    return promise.parent;
+}
+
+std::coroutine_handle<> Routine::Awaiter::await_suspend(std::coroutine_handle<promise_type> parent) noexcept {
+    promise_type& promise = m_handle.promise();
+    promise.parent = parent;
+    promise.root = parent.promise().root;
+    promise.root->leaf = m_handle;
+    // the awaited routine starts straight away, instead of waiting for the next update
+    return m_handle;
+}
+
+Routine::Routine(Routine&& other) noexcept
+    : m_handle(std::exchange(other.m_handle, nullptr)) {}
+
+Routine& Routine::operator=(Routine&& other) noexcept {
+    if (this == &other) return *this;
+    if (m_handle) m_handle.destroy();
+    m_handle = std::exchange(other.m_handle, nullptr);
+    return *this;
+}
+
+// destroying the frame destroys every routine it is awaiting too, as they are temporaries in the frame
+Routine::~Routine() {
+    if (m_handle) m_handle.destroy();
+}
+
+bool Routine::isDone() const { return !m_handle || m_handle.done(); }
+
+RoutineWait::RoutineWait(std::function<bool()> condition, Time timeout)
+    : m_condition(std::move(condition)),
+      m_timeout(std::isfinite(to_msec(timeout)) ? std::max(0.0, std::round(to_msec(timeout))) : 0),
+      m_hasTimeout(std::isfinite(to_msec(timeout))) {}
+
+bool RoutineWait::await_ready() {
+    m_deadline = pros::c::millis() + m_timeout;
+    // waiting for a duration always gives way to other routines
+    return m_condition && m_condition();
+}
+
+void RoutineWait::await_suspend(std::coroutine_handle<Routine::promise_type> handle) noexcept {
+    Routine::promise_type& root = *handle.promise().root;
+    root.leaf = handle;
+    root.wait = this;
+}
+
+bool RoutineWait::isReady(uint32_t now) {
+    if (m_condition && m_condition()) return true;
+    // compared as a signed difference, so the deadline still works when millis wraps around
+    if (m_hasTimeout && int32_t(now - m_deadline) >= 0) {
+        // a wait without a condition is only waiting for the time, so it didn't time out
+        m_timedOut = bool(m_condition);
+        return true;
+    }
+    return false;
+}
+
+RoutineWait waitFor(Time duration) { return RoutineWait(nullptr, duration); }
+
+RoutineWait waitUntil(std::function<bool()> condition, Time timeout) {
+    return RoutineWait(std::move(condition), timeout);
+}
+
+int32_t RoutineExecutor::add(Routine routine) {
+    if (routine.isDone()) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    for (size_t i = 0; i < MAX_ROUTINES; i++) {
+        Slot& slot = m_slots[i];
+        SlotState expected = SlotState::EMPTY;
+        if (!slot.state.compare_exchange_strong(expected, SlotState::CLAIMED, std::memory_order_acquire)) continue;
+        slot.routine = std::move(routine);
+        slot.cancelled.store(false, std::memory_order_relaxed);
+        m_activeCount.fetch_add(1, std::memory_order_relaxed);
+        // publish the routine only after it has been moved in
+        slot.state.store(SlotState::ACTIVE, std::memory_order_release);
+        return i;
+    }
+    errno = ENOMEM;
+    return INT_MAX;
+}
+
+int32_t RoutineExecutor::cancel(int32_t index) {
+    if (index < 0 || size_t(index) >= MAX_ROUTINES ||
+        m_slots[index].state.load(std::memory_order_acquire) != SlotState::ACTIVE) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    m_slots[index].cancelled.store(true, std::memory_order_relaxed);
+    return 0;
+}
+
+void RoutineExecutor::cancelAll() {
+    for (Slot& slot : m_slots) slot.cancelled.store(true, std::memory_order_relaxed);
+}
+
+size_t RoutineExecutor::getActiveCount() const { return m_activeCount.load(std::memory_order_relaxed); }
+
+void RoutineExecutor::update() {
+    const uint32_t now = pros::c::millis();
+    for (Slot& slot : m_slots) {
+        if (slot.state.load(std::memory_order_acquire) != SlotState::ACTIVE) continue;
+        if (slot.cancelled.load(std::memory_order_relaxed)) {
+            finish(slot);
+            continue;
+        }
+        Routine::promise_type& root = slot.routine.m_handle.promise();
+        if (root.wait != nullptr && !root.wait->isReady(now)) continue;
+        // the wait is destroyed once the leaf is resumed
+        root.wait = nullptr;
+        root.leaf.resume();
+        if (slot.routine.isDone()) finish(slot);
+    }
+}
+
+void RoutineExecutor::finish(Slot& slot) {
+    slot.routine = Routine();
+    m_activeCount.fetch_sub(1, std::memory_order_relaxed);
+    slot.state.store(SlotState::EMPTY, std::memory_order_release);
+}
+} // namespace lemlib
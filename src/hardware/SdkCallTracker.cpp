@@ -0,0 +1,96 @@
+#include "hardware/SdkCallTracker.hpp"
+#include <array>
+#include <atomic>
+#include <cinttypes>
+#include <cstdlib>
+
+namespace lemlib {
+namespace {
+/**
+ * @brief The SDK calls of a single task
+ */
+struct TaskEntry {
+        std::atomic<pros::task_t> task = nullptr;
+        std::atomic<uint32_t> calls = 0;
+};
+
+constexpr size_t MAX_TASKS = 32;
+// smart ports 1 to 21, and the ADI ports on the brain as port 22. Index 0 is unused, so ports can be used as indices
+constexpr size_t PORTS = 23;
+
+// everything is constant initialized, so calls made by static initializers are counted too
+std::array<TaskEntry, MAX_TASKS> entries {};
+std::array<std::atomic<uint32_t>, PORTS> portCalls {};
+std::atomic<uint32_t> totalCalls = 0;
+
+/**
+ * @brief Find the entry of a task
+ *
+ * @param task the task
+ * @param create whether to claim a free entry if the task doesn't have one yet
+ * @return TaskEntry* the entry, or nullptr if the task has none, and none could be claimed
+ */
+TaskEntry* findEntry(pros::task_t task, bool create) {
+    // calls made before the scheduler starts have no task
+    if (task == nullptr) return nullptr;
+    for (TaskEntry& entry : entries) {
+        pros::task_t current = entry.task.load(std::memory_order_acquire);
+        if (current == task) return &entry;
+        if (current != nullptr) continue;
+        if (!create) return nullptr;
+        // entries are claimed in order and never released, so the first free entry ends the search
+        if (entry.task.compare_exchange_strong(current, task, std::memory_order_acq_rel) || current == task) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+} // namespace
+
+namespace detail {
+void countSdkCall(int port) {
+    totalCalls.fetch_add(1, std::memory_order_relaxed);
+    port = std::abs(port);
+    if (port > 0 && size_t(port) < PORTS) portCalls[port].fetch_add(1, std::memory_order_relaxed);
+    TaskEntry* entry = findEntry(pros::c::task_get_current(), true);
+    if (entry != nullptr) entry->calls.fetch_add(1, std::memory_order_relaxed);
+}
+} // namespace detail
+
+bool isTrackingSdkCalls() {
+#ifdef LEMLIB_TRACK_SDK_CALLS
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint32_t getSdkCalls() { return totalCalls.load(); }
+
+uint32_t getPortSdkCalls(uint8_t port) {
+    if (port == 0 || port >= PORTS) return 0;
+    return portCalls[port].load();
+}
+
+uint32_t getTaskSdkCalls(pros::task_t task) {
+    const TaskEntry* entry = findEntry(task, false);
+    if (entry == nullptr) return 0;
+    return entry->calls.load();
+}
+
+int32_t dumpSdkCalls(FILE* file) {
+    std::fprintf(file, "task,calls\n");
+    for (const TaskEntry& entry : entries) {
+        const pros::task_t task = entry.task.load(std::memory_order_acquire);
+        if (task == nullptr) break;
+        std::fprintf(file, "%p,%" PRIu32 "\n", task, entry.calls.load());
+    }
+    std::fprintf(file, "port,calls\n");
+    for (size_t port = 1; port < PORTS; port++) {
+        const uint32_t calls = portCalls[port].load();
+        if (calls != 0) std::fprintf(file, "%zu,%" PRIu32 "\n", port, calls);
+    }
+    std::fflush(file);
+    return 0;
+}
+} // namespace lemlib
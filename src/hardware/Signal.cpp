@@ -0,0 +1,40 @@
+#include "hardware/Signal.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace lemlib {
+void Signal::notify() {
+    // pairs with the fence in registerWaiter. Either this task sees the waiter, or the waiter sees the new state
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (std::atomic<pros::task_t>& waiter : m_waiters) {
+        const pros::task_t task = waiter.load(std::memory_order_relaxed);
+        if (task != nullptr) pros::c::task_notify(task);
+    }
+}
+
+int32_t Signal::registerWaiter() {
+    const pros::task_t task = pros::c::task_get_current();
+    int32_t slot = -1;
+    for (size_t i = 0; i < MAX_WAITERS; i++) {
+        pros::task_t expected = nullptr;
+        if (m_waiters[i].compare_exchange_strong(expected, task, std::memory_order_relaxed)) {
+            slot = i;
+            break;
+        }
+    }
+    // the condition is checked after this fence, so a change made before the next notify is never missed
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return slot;
+}
+
+void Signal::unregisterWaiter(int32_t slot) {
+    if (slot >= 0) m_waiters[slot].store(nullptr, std::memory_order_relaxed);
+}
+
+void Signal::sleep(int32_t slot, uint32_t timeout) {
+    if (slot < 0) pros::c::delay(1);
+    else pros::c::task_notify_take(true, timeout);
+}
+
+uint32_t Signal::toMilliseconds(Time timeout) { return std::max(0.0, std::round(to_msec(timeout))); }
+} // namespace lemlib
@@ -0,0 +1,71 @@
+#include "hardware/TaskManager.hpp"
+#include "hardware/TaskMonitor.hpp"
+#include "pros/rtos.h"
+#include <climits>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+TaskManager::TaskManager()
+    : m_configs({
+          // samples are taken on time, and reading every device rarely takes more than a few ms of a 10 ms period
+          TaskConfig {TASK_PRIORITY_DEFAULT + 1, TASK_STACK_DEPTH_DEFAULT, 0.2, 100_msec},
+          // control loops run on time, and user callbacks run on this stack, so it keeps the default depth
+          TaskConfig {TASK_PRIORITY_DEFAULT + 2, TASK_STACK_DEPTH_DEFAULT, 0.4, 100_msec},
+          // writing a batch only copies records into the file buffer, so the writers get a smaller stack and a
+          // longer window, which a slow write to the SD card doesn't use up straight away
+          TaskConfig {TASK_PRIORITY_MIN + 1, 0x1000, 0.1, 1000_msec},
+          TaskConfig {TASK_PRIORITY_MIN + 1, 0x1000, 0.1, 1000_msec},
+      }),
+      m_created(m_configs) {}
+
+TaskManager& TaskManager::get() {
+    static TaskManager manager;
+    return manager;
+}
+
+int32_t TaskManager::configure(TaskRole role, TaskConfig config) {
+    const bool valid = size_t(role) < ROLES && config.priority >= TASK_PRIORITY_MIN &&
+                       config.priority <= TASK_PRIORITY_MAX && config.stackDepth >= TASK_STACK_DEPTH_MIN &&
+                       config.budget > 0 && config.budget <= 1 && config.window > 0_sec;
+    if (!valid) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    std::lock_guard lock(m_mutex);
+    m_configs[size_t(role)] = config;
+    return 0;
+}
+
+TaskConfig TaskManager::getConfig(TaskRole role) const {
+    std::lock_guard lock(m_mutex);
+    return m_configs[size_t(role)];
+}
+
+pros::task_t TaskManager::create(TaskRole role, pros::task_fn_t function, void* parameters, uint32_t priority,
+                                 const char* name) {
+    TaskConfig config;
+    {
+        std::lock_guard lock(m_mutex);
+        config = m_configs[size_t(role)];
+        // the task attaches with the stack depth it was created with, even if the role is configured in between
+        m_created[size_t(role)] = config;
+    }
+    if (priority != MANAGED_PRIORITY) config.priority = priority;
+    return pros::c::task_create(function, parameters, config.priority, config.stackDepth, name);
+}
+
+int32_t TaskManager::attach(TaskRole role, const char* name) {
+    TaskConfig config;
+    {
+        std::lock_guard lock(m_mutex);
+        config = m_created[size_t(role)];
+    }
+    TaskMonitor& monitor = TaskMonitor::get();
+    const int32_t slot = monitor.attach(name, config.stackDepth);
+    // attach has already set errno
+    if (slot == INT_MAX) return INT_MAX;
+    monitor.setBudget(slot, config.budget, config.window);
+    return slot;
+}
+} // namespace lemlib
@@ -0,0 +1,259 @@
+#include "hardware/TaskMonitor.hpp"
+#include "hardware/BootTrace.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+namespace {
+// the pattern the unused part of a stack is painted with, the same one FreeRTOS uses
+constexpr uint32_t STACK_PATTERN = 0xa5a5a5a5;
+// how much of the stack below the caller of attach is left unpainted, for the frame of attach itself
+constexpr uintptr_t PAINT_GAP = 512;
+// the stack above the caller of attach isn't known, so this much of the bottom of the stack is left unpainted too
+constexpr uintptr_t PAINT_MARGIN = 1024;
+
+bool validSlot(int32_t slot) { return slot >= 0 && size_t(slot) < TaskMonitor::MAX_TASKS; }
+
+/**
+ * @brief Paint a range of memory below the stack pointer with the pattern
+ *
+ * It isn't inlined, so its own frame is always above the range it paints
+ *
+ * @param bottom the lowest address to paint
+ * @param top the address to paint up to
+ */
+[[gnu::noinline]] void paint(uintptr_t bottom, uintptr_t top) {
+    for (uintptr_t address = bottom; address < top; address += sizeof(uint32_t)) {
+        *reinterpret_cast<volatile uint32_t*>(address) = STACK_PATTERN;
+    }
+}
+
+/**
+ * @brief Find how much of a painted range is still painted, from its bottom
+ *
+ * @param bottom the lowest painted address
+ * @param top the address painting stopped at
+ * @return size_t the number of bytes from the bottom which were never overwritten
+ */
+size_t unused(uintptr_t bottom, uintptr_t top) {
+    uintptr_t address = bottom;
+    while (address < top && *reinterpret_cast<volatile const uint32_t*>(address) == STACK_PATTERN) {
+        address += sizeof(uint32_t);
+    }
+    return address - bottom;
+}
+} // namespace
+
+TaskMonitor::Work::Work(int32_t slot)
+    : m_slot(slot),
+      m_start(validSlot(slot) ? pros::c::micros() : 0) {
+    if (!validSlot(slot)) return;
+    Slot& budgeted = TaskMonitor::get().m_slots[slot];
+    if (budgeted.budgetMicros == 0 || m_start - budgeted.windowStart < budgeted.windowMicros) return;
+    // a new window starts with the whole budget, so a task which was demoted in the last one gets its priority back
+    budgeted.windowStart = m_start;
+    budgeted.windowBusy = 0;
+    if (budgeted.throttled) pros::c::task_set_priority(budgeted.task, budgeted.priority);
+    budgeted.throttled = false;
+}
+
+TaskMonitor::Work::~Work() {
+    if (!validSlot(m_slot)) return;
+    const uint64_t duration = pros::c::micros() - m_start;
+    Slot& slot = TaskMonitor::get().m_slots[m_slot];
+    slot.busy.fetch_add(duration, std::memory_order_relaxed);
+    // only the task itself writes the longest work, until update swaps it out
+    const uint32_t micros = std::min<uint64_t>(duration, UINT32_MAX);
+    uint32_t longest = slot.maxWork.load(std::memory_order_relaxed);
+    while (micros > longest && !slot.maxWork.compare_exchange_weak(longest, micros, std::memory_order_relaxed)) {}
+    if (slot.budgetMicros == 0) return;
+    slot.windowBusy += duration;
+    if (slot.throttled || slot.windowBusy <= slot.budgetMicros) return;
+    // the task keeps running, but only when every other task is waiting, so it can't starve a driver control loop
+    pros::c::task_set_priority(slot.task, TASK_PRIORITY_MIN);
+    slot.throttled = true;
+    slot.throttles.fetch_add(1, std::memory_order_relaxed);
+}
+
+TaskMonitor& TaskMonitor::get() {
+    static TaskMonitor monitor;
+    return monitor;
+}
+
+int32_t TaskMonitor::attach(const char* name, uint32_t stackDepth) {
+    // the address of a local is where the stack of the caller is right now
+    volatile uint32_t marker = 0;
+    const uintptr_t here = reinterpret_cast<uintptr_t>(&marker);
+    const size_t stackSize = size_t(stackDepth) * sizeof(uint32_t);
+    std::lock_guard lock(m_mutex);
+    const auto free = std::find_if(m_slots.begin(), m_slots.end(), [](const Slot& slot) { return !slot.used.load(); });
+    if (free == m_slots.end()) {
+        errno = ENOSPC;
+        return INT_MAX;
+    }
+    Slot& slot = *free;
+    std::snprintf(slot.name.data(), slot.name.size(), "%s", name);
+    // the channel names take the suffix, so long names are cut short before it instead
+    std::snprintf(slot.cpuChannel.data(), slot.cpuChannel.size(), "%.*s.cpu", int(slot.name.size() - 5), name);
+    std::snprintf(slot.stackChannel.data(), slot.stackChannel.size(), "%.*s.stack", int(slot.name.size() - 7), name);
+    slot.stackSize = stackSize;
+    // the stack grows down, so everything more than a frame below the caller is unused
+    slot.paintedTop = (here - PAINT_GAP) & ~uintptr_t(sizeof(uint32_t) - 1);
+    slot.paintedBottom = stackSize > PAINT_GAP + PAINT_MARGIN ? here - stackSize + PAINT_MARGIN : slot.paintedTop;
+    slot.paintedBottom = (slot.paintedBottom + sizeof(uint32_t) - 1) & ~uintptr_t(sizeof(uint32_t) - 1);
+    paint(slot.paintedBottom, slot.paintedTop);
+    slot.busy = 0;
+    slot.maxWork = 0;
+    slot.lastBusy = 0;
+    slot.budgetMicros = 0;
+    slot.throttled = false;
+    slot.throttles = 0;
+    slot.stats = {.name = slot.name.data(),
+                  .cpuLoad = 0,
+                  .maxWork = 0_sec,
+                  .stackSize = stackSize,
+                  .stackHeadroom = slot.paintedTop - slot.paintedBottom};
+    slot.used = true;
+    return free - m_slots.begin();
+}
+
+int32_t TaskMonitor::setBudget(int32_t slot, Number budget, Time window) {
+    std::lock_guard lock(m_mutex);
+    if (!validSlot(slot) || !m_slots[slot].used.load() || !(budget > 0) || budget > 1 || !(window > 0_sec)) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    Slot& budgeted = m_slots[slot];
+    budgeted.task = pros::c::task_get_current();
+    budgeted.priority = pros::c::task_get_priority(budgeted.task);
+    budgeted.windowMicros = std::max(1.0, std::round(to_usec(window)));
+    // a budget of the whole window can't be exceeded, so it is the same as no budget
+    budgeted.budgetMicros = budget < 1 ? std::max(1.0, std::round(to_num(budget) * budgeted.windowMicros)) : 0;
+    budgeted.windowStart = pros::c::micros();
+    budgeted.windowBusy = 0;
+    budgeted.stats.budget = budget;
+    return 0;
+}
+
+void TaskMonitor::detach(int32_t slot) {
+    if (!validSlot(slot)) return;
+    std::lock_guard lock(m_mutex);
+    m_slots[slot].used = false;
+    m_slots[slot].streamChannel = INT_MAX;
+}
+
+int32_t TaskMonitor::update() {
+    std::lock_guard lock(m_mutex);
+    const uint64_t now = pros::c::micros();
+    const double elapsed = now - m_lastSample;
+    m_lastSample = now;
+    double total = 0;
+    for (Slot& slot : m_slots) {
+        if (!slot.used.load()) continue;
+        const uint64_t busy = slot.busy.load(std::memory_order_relaxed);
+        // the clock only moves while tasks are waiting in the simulator, so an elapsed time of 0 is possible
+        const double load = elapsed > 0 ? std::clamp((busy - slot.lastBusy) / elapsed, 0.0, 1.0) : 0.0;
+        slot.lastBusy = busy;
+        slot.stats.cpuLoad = load;
+        slot.stats.maxWork = from_usec(slot.maxWork.exchange(0, std::memory_order_relaxed));
+        slot.stats.stackHeadroom = unused(slot.paintedBottom, slot.paintedTop);
+        slot.stats.throttles = slot.throttles.load(std::memory_order_relaxed);
+        total += load;
+    }
+    m_cpuLoad = std::min(total, 1.0);
+    return 0;
+}
+
+int32_t TaskMonitor::getStats(std::span<TaskStats> buffer) const {
+    std::lock_guard lock(m_mutex);
+    size_t count = 0;
+    for (const Slot& slot : m_slots) {
+        if (count == buffer.size()) break;
+        if (slot.used.load()) buffer[count++] = slot.stats;
+    }
+    return count;
+}
+
+Number TaskMonitor::getCpuLoad() const {
+    std::lock_guard lock(m_mutex);
+    return m_cpuLoad;
+}
+
+int32_t TaskMonitor::addChannels(TelemetryStream& stream) {
+    std::lock_guard lock(m_mutex);
+    size_t needed = 1;
+    for (const Slot& slot : m_slots) needed += slot.used.load() ? 2 : 0;
+    if (stream.getChannelCount() + needed > TelemetryStream::MAX_CHANNELS) {
+        errno = ENOSPC;
+        return INT_MAX;
+    }
+    const int32_t first = stream.addChannel("cpu", 0.001);
+    for (Slot& slot : m_slots) {
+        slot.streamChannel = slot.used.load() ? stream.addChannel(slot.cpuChannel.data(), 0.001) : INT_MAX;
+        // the stack channel comes right after the load channel
+        if (slot.used.load()) stream.addChannel(slot.stackChannel.data(), 1);
+    }
+    return first;
+}
+
+void TaskMonitor::publish(TelemetryStream& stream, int32_t first) const {
+    std::lock_guard lock(m_mutex);
+    if (first < 0 || first == INT_MAX) return;
+    stream.set(first, m_cpuLoad);
+    for (const Slot& slot : m_slots) {
+        if (slot.streamChannel == INT_MAX) continue;
+        stream.set(slot.streamChannel, slot.stats.cpuLoad);
+        stream.set(slot.streamChannel + 1, double(slot.stats.stackHeadroom));
+    }
+}
+
+int32_t TaskMonitor::start(Time period, uint32_t priority) {
+    std::lock_guard lock(m_mutex);
+    if (m_running.load() || !m_taskExited.load()) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    m_period = period;
+    m_lastSample = pros::c::micros();
+    m_running = true;
+    m_taskExited = false;
+    LEMLIB_BOOT_EVENT("create lemlib task monitor task", 0);
+    const pros::task_t task =
+        pros::c::task_create(taskFunction, this, priority, TASK_STACK_DEPTH_DEFAULT, "lemlib task monitor");
+    if (task == nullptr) {
+        m_running = false;
+        m_taskExited = true;
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+void TaskMonitor::stop() {
+    m_running = false;
+    // wait for the task to finish its current sample
+    while (!m_taskExited.load()) pros::c::delay(1);
+}
+
+void TaskMonitor::taskFunction(void* monitor) {
+    TaskMonitor& self = *static_cast<TaskMonitor*>(monitor);
+    const int32_t slot = self.attach("lemlib task monitor");
+    const uint32_t period = std::max(1.0, std::round(to_msec(self.m_period)));
+    uint32_t now = pros::c::millis();
+    while (self.m_running.load()) {
+        {
+            Work work(slot);
+            self.update();
+        }
+        pros::c::task_delay_until(&now, period);
+    }
+    self.detach(slot);
+    // PROS deletes the task once this function returns
+    self.m_taskExited = true;
+}
+} // namespace lemlib
@@ -0,0 +1,155 @@
+#include "hardware/TelemetryLogger.hpp"
+#include "hardware/BootTrace.hpp"
+#include "hardware/TaskManager.hpp"
+#include "hardware/TaskMonitor.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <errno.h>
+#include <mutex>
+
+namespace lemlib {
+namespace {
+/**
+ * @brief Convert a value to a float for a record, noting if it could not be read
+ *
+ * @param value the value
+ * @param error set to 1 if the value is not finite
+ * @return float the value
+ */
+float recordValue(double value, uint8_t& error) {
+    if (!std::isfinite(value)) error = 1;
+    return value;
+}
+} // namespace
+
+TelemetryLogger::TelemetryLogger(size_t capacity, Time period)
+    : m_period(period),
+      m_mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+      m_ring(new TelemetryRecord[m_mask + 1]) {}
+
+TelemetryLogger::~TelemetryLogger() { stop(); }
+
+int32_t TelemetryLogger::push(const TelemetryRecord& record) {
+    const uint32_t head = m_head.load(std::memory_order_relaxed);
+    // the tail is acquired, so the writer task has finished copying a slot before it is reused
+    if (head - m_tail.load(std::memory_order_acquire) > m_mask) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        errno = ENOBUFS;
+        return INT_MAX;
+    }
+    m_ring[head & m_mask] = record;
+    // publish the record only after it has been copied into the ring
+    m_head.store(head + 1, std::memory_order_release);
+    return 0;
+}
+
+int32_t TelemetryLogger::logMotor(uint16_t device, const MotorTelemetry& telemetry) {
+    TelemetryRecord record {.timestamp = uint32_t(pros::c::micros()), .device = device, .kind = TelemetryKind::MOTOR};
+    record.values[0] = recordValue(to_stDeg(telemetry.angle), record.error);
+    record.values[1] = recordValue(to_rpm(telemetry.velocity), record.error);
+    record.values[2] = recordValue(to_amp(telemetry.current), record.error);
+    record.values[3] = recordValue(units::to_celsius(telemetry.temperature), record.error);
+    return push(record);
+}
+
+int32_t TelemetryLogger::logMotors(uint16_t firstDevice, std::span<const MotorTelemetry> telemetry) {
+    int32_t result = 0;
+    for (size_t i = 0; i < telemetry.size(); i++) {
+        if (logMotor(firstDevice + i, telemetry[i]) != 0) result = INT_MAX;
+    }
+    return result;
+}
+
+int32_t TelemetryLogger::logIMU(uint16_t device, Angle rotation) {
+    TelemetryRecord record {.timestamp = uint32_t(pros::c::micros()), .device = device, .kind = TelemetryKind::IMU};
+    record.values[0] = recordValue(to_stDeg(rotation), record.error);
+    return push(record);
+}
+
+int32_t TelemetryLogger::logEncoder(uint16_t device, Angle angle) {
+    TelemetryRecord record {
+        .timestamp = uint32_t(pros::c::micros()), .device = device, .kind = TelemetryKind::ENCODER};
+    record.values[0] = recordValue(to_stDeg(angle), record.error);
+    return push(record);
+}
+
+uint32_t TelemetryLogger::getDropped() const { return m_dropped.load(); }
+
+uint32_t TelemetryLogger::getWritten() const { return m_written.load(); }
+
+void TelemetryLogger::drain() {
+    while (true) {
+        const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        const uint32_t count = std::min<uint32_t>(m_head.load(std::memory_order_acquire) - tail, BATCH_SIZE);
+        if (count == 0) break;
+        // records are copied out of the ring first, so the producer can reuse their slots during the slow write
+        for (uint32_t i = 0; i < count; i++) m_batch[i] = m_ring[(tail + i) & m_mask];
+        m_tail.store(tail + count, std::memory_order_release);
+        m_written.fetch_add(std::fwrite(m_batch.data(), sizeof(TelemetryRecord), count, m_file));
+    }
+    std::fflush(m_file);
+}
+
+int32_t TelemetryLogger::start(const char* path, uint32_t priority) {
+    std::lock_guard lock(m_mutex);
+    if (m_running.load() || !m_taskExited.load()) {
+        errno = EBUSY;
+        return INT_MAX;
+    }
+    // fopen has already set errno
+    m_file = std::fopen(path, "wb");
+    if (m_file == nullptr) return INT_MAX;
+    std::array<uint8_t, 16> header {'L', 'L', 'O', 'G'};
+    const uint16_t version = FORMAT_VERSION;
+    const uint16_t recordSize = sizeof(TelemetryRecord);
+    std::memcpy(&header[4], &version, sizeof(version));
+    std::memcpy(&header[6], &recordSize, sizeof(recordSize));
+    std::fwrite(header.data(), 1, header.size(), m_file);
+    m_running = true;
+    m_taskExited = false;
+    LEMLIB_BOOT_EVENT("create lemlib telemetry logger task", 0);
+    const pros::task_t task = TaskManager::get().create(TaskRole::TELEMETRY_LOGGER, taskFunction, this, priority,
+                                                        "lemlib telemetry logger");
+    if (task == nullptr) {
+        m_running = false;
+        m_taskExited = true;
+        std::fclose(m_file);
+        m_file = nullptr;
+        errno = ENOMEM;
+        return INT_MAX;
+    }
+    return 0;
+}
+
+void TelemetryLogger::stop() {
+    std::lock_guard lock(m_mutex);
+    m_running = false;
+    // wait for the task to finish its current batch, so the file can be closed safely afterwards
+    while (!m_taskExited.load()) pros::c::delay(1);
+    if (m_file == nullptr) return;
+    drain();
+    std::fclose(m_file);
+    m_file = nullptr;
+}
+
+void TelemetryLogger::taskFunction(void* logger) {
+    TelemetryLogger& self = *static_cast<TelemetryLogger*>(logger);
+    const uint32_t period = std::max(1.0, std::round(to_msec(self.m_period)));
+    uint32_t now = pros::c::millis();
+    const int32_t slot = TaskManager::get().attach(TaskRole::TELEMETRY_LOGGER, "lemlib telemetry logger");
+    while (self.m_running.load()) {
+        {
+            TaskMonitor::Work work(slot);
+            self.drain();
+        }
+        pros::c::task_delay_until(&now, period);
+    }
+    TaskMonitor::get().detach(slot);
+    // PROS deletes the task once this function returns
+    self.m_taskExited = true;
+}
+} // namespace lemlib
@@ -0,0 +1,438 @@
+#include "hardware/TelemetryStream.hpp"
+#include "pros/rtos.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <errno.h>
+
+namespace lemlib {
+namespace {
+/**
+ * @brief Write an unsigned integer 7 bits at a time, setting the top bit of every byte but the last
+ *
+ * @param out where to write it. Moved past the written bytes
+ * @param value the value
+ */
+void writeVarint(uint8_t*& out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = uint8_t(value) | 0x80;
+        value >>= 7;
+    }
+    *out++ = uint8_t(value);
+}
+
+/**
+ * @brief Read an unsigned integer written by writeVarint
+ *
+ * @param in where to read from. Moved past the read bytes
+ * @param end the end of the frame
+ * @param value the value
+ * @return true the value was read
+ * @return false the frame ended first, or the value is too long
+ */
+bool readVarint(const uint8_t*& in, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && in != end; shift += 7) {
+        const uint8_t byte = *in++;
+        value |= uint64_t(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+// zigzag encoding maps signed integers to unsigned ones, so small negative deltas stay short
+uint64_t zigzag(int64_t value) { return (uint64_t(value) << 1) ^ uint64_t(value >> 63); }
+
+int64_t unzigzag(uint64_t value) { return int64_t(value >> 1) ^ -int64_t(value & 1); }
+
+/**
+ * @brief CRC-8 with the polynomial 0x07
+ *
+ * @param data the data to check
+ * @return uint8_t the checksum
+ */
+uint8_t crc8(std::span<const uint8_t> data) {
+    uint8_t crc = 0;
+    for (const uint8_t byte : data) {
+        crc ^= byte;
+        for (int i = 0; i < 8; i++) crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+    }
+    return crc;
+}
+
+/**
+ * @brief COBS encode a frame, and end it with a 0 byte
+ *
+ * @param data the contents of the frame
+ * @param out the buffer to encode into
+ * @return size_t the size of the encoded frame, or 0 if the buffer is too small
+ */
+size_t cobsEncode(std::span<const uint8_t> data, std::span<uint8_t> out) {
+    // every 254 bytes need an extra code byte, and the frame needs its first code byte and its 0 byte
+    if (out.size() < data.size() + data.size() / 254 + 2) return 0;
+    size_t code = 0;
+    size_t size = 1;
+    for (const uint8_t byte : data) {
+        if (byte != 0) out[size++] = byte;
+        if (byte == 0 || size - code == 0xFF) {
+            out[code] = size - code;
+            code = size++;
+        }
+    }
+    out[code] = size - code;
+    out[size++] = 0;
+    return size;
+}
+
+/**
+ * @brief Decode a COBS encoded frame
+ *
+ * @param data the encoded frame, without its 0 byte
+ * @param out the buffer to decode into
+ * @return size_t the size of the decoded frame, or SIZE_MAX if it is malformed
+ */
+size_t cobsDecode(std::span<const uint8_t> data, std::span<uint8_t> out) {
+    size_t size = 0;
+    size_t i = 0;
+    while (i < data.size()) {
+        const uint8_t code = data[i++];
+        if (code == 0 || i + code - 1 > data.size()) return SIZE_MAX;
+        for (size_t j = 1; j < code; j++) out[size++] = data[i++];
+        // a code of 0xFF means the block was cut short, rather than ending at a 0 byte
+        if (code != 0xFF && i != data.size()) out[size++] = 0;
+    }
+    return size;
+}
+
+// the budget is measured over windows of a second
+constexpr uint32_t BUDGET_WINDOW = 1000000;
+} // namespace
+
+TelemetryStream::TelemetryStream(uint32_t keyFrameInterval, uint32_t schemaInterval)
+    : m_keyFrameInterval(std::max<uint32_t>(keyFrameInterval, 1)),
+      m_schemaInterval(std::max<uint32_t>(schemaInterval, 1)) {}
+
+int32_t TelemetryStream::addChannel(const char* name, double resolution) {
+    if (m_channelCount == MAX_CHANNELS) {
+        errno = ENOSPC;
+        return INT_MAX;
+    }
+    if (!std::isfinite(resolution) || resolution <= 0) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    m_channels[m_channelCount] = {name, resolution, 0, 0, false, false, 0};
+    m_schemaDue = true;
+    m_keyDue = true;
+    return m_channelCount++;
+}
+
+int32_t TelemetryStream::addPose(const char* name, Length linear, Angle angular) {
+    if (m_channelCount + 3 > MAX_CHANNELS) {
+        errno = ENOSPC;
+        return INT_MAX;
+    }
+    if (!std::isfinite(linear.internal()) || linear.internal() <= 0 || !std::isfinite(angular.internal()) ||
+        angular.internal() <= 0) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    const int32_t first = m_channelCount;
+    for (const char* suffix : {".x", ".y", ".theta"}) {
+        std::array<char, MAX_NAME_LENGTH + 1>& poseName = m_poseNames[m_channelCount];
+        std::snprintf(poseName.data(), poseName.size(), "%s%s", name, suffix);
+        addChannel(poseName.data(), suffix[1] == 't' ? angular.internal() : linear.internal());
+    }
+    return first;
+}
+
+size_t TelemetryStream::getChannelCount() const { return m_channelCount; }
+
+void TelemetryStream::setBandwidth(uint32_t bytesPerSecond) {
+    m_bandwidth = bytesPerSecond;
+    // the bucket starts full
+    m_tokens = int64_t(bytesPerSecond) * BUDGET_WINDOW / 4;
+    m_lastRefill = pros::c::micros();
+    m_windowStart = m_lastRefill;
+    m_windowBytes = 0;
+    m_heldBack = false;
+    m_level = 0;
+}
+
+int32_t TelemetryStream::setPriority(size_t channel, uint8_t priority) {
+    if (channel >= m_channelCount || priority > MAX_PRIORITY) {
+        errno = EINVAL;
+        return INT_MAX;
+    }
+    m_channels[channel].priority = priority;
+    return 0;
+}
+
+uint32_t TelemetryStream::getDecimation(size_t channel) const {
+    if (channel >= m_channelCount) return 0;
+    return 1u << std::max(0, m_level - m_channels[channel].priority);
+}
+
+bool TelemetryStream::updateBudget(uint32_t timestamp) {
+    if (m_bandwidth == 0) return true;
+    const int64_t burst = int64_t(m_bandwidth) * BUDGET_WINDOW / 4;
+    m_tokens = std::min(burst, m_tokens + int64_t(timestamp - m_lastRefill) * m_bandwidth);
+    m_lastRefill = timestamp;
+    const uint32_t window = timestamp - m_windowStart;
+    if (window >= BUDGET_WINDOW) {
+        // the channels with the highest priority are never decimated. If the stream still doesn't fit, fewer frames
+        // are sent instead
+        uint8_t highest = 0;
+        for (size_t i = 0; i < m_channelCount; i++) highest = std::max(highest, m_channels[i].priority);
+        // frames which were held back mean the stream doesn't fit. Halving the decimation can double what the
+        // decimated channels send, so it is only lowered when the stream fits with plenty of room
+        if (m_heldBack && m_level < highest) m_level++;
+        else if (!m_heldBack && m_level > 0 &&
+                 uint64_t(m_windowBytes) * BUDGET_WINDOW * 3 < uint64_t(m_bandwidth) * window) {
+            m_level--;
+        }
+        m_windowStart = timestamp;
+        m_windowBytes = 0;
+        m_heldBack = false;
+    }
+    if (m_tokens >= 0) return true;
+    m_heldBack = true;
+    return false;
+}
+
+void TelemetryStream::set(size_t channel, double value) {
+    if (channel >= m_channelCount) return;
+    Channel& target = m_channels[channel];
+    const double steps = std::round(value / target.resolution);
+    target.valid = std::isfinite(steps) && steps >= INT32_MIN && steps <= INT32_MAX;
+    target.value = target.valid ? int32_t(steps) : 0;
+    m_dataDue = true;
+}
+
+void TelemetryStream::setPose(size_t channel, units::Pose pose) {
+    set(channel, pose.x);
+    set(channel + 1, pose.y);
+    set(channel + 2, pose.orientation);
+}
+
+size_t TelemetryStream::writeFrame(uint32_t timestamp, std::span<uint8_t> frame) {
+    uint8_t* out = frame.data();
+    if (m_schemaDue) {
+        *out++ = uint8_t(StreamFrameType::SCHEMA);
+        *out++ = m_sequence;
+        *out++ = FORMAT_VERSION;
+        *out++ = m_channelCount;
+        for (size_t i = 0; i < m_channelCount; i++) {
+            // the resolution is sent as a little-endian double, which is how the brain stores it
+            const double resolution = m_channels[i].resolution;
+            std::memcpy(out, &resolution, sizeof(resolution));
+            out += sizeof(resolution);
+            const size_t length = strnlen(m_channels[i].name, MAX_NAME_LENGTH);
+            *out++ = length;
+            std::memcpy(out, m_channels[i].name, length);
+            out += length;
+        }
+        m_schemaDue = false;
+        m_keyDue = true;
+        m_keysSinceSchema = 0;
+    } else {
+        const bool key = m_keyDue || m_framesSinceKey + 1 >= m_keyFrameInterval;
+        *out++ = uint8_t(key ? StreamFrameType::KEY : StreamFrameType::DELTA);
+        *out++ = m_sequence;
+        writeVarint(out, key ? timestamp : timestamp - m_lastTimestamp);
+        uint32_t missing = 0;
+        // delta frames leave out channels which didn't change, and channels which are decimated out of this frame.
+        // The decoder keeps their last values
+        uint32_t skipped = 0;
+        for (size_t i = 0; i < m_channelCount; i++) {
+            const Channel& channel = m_channels[i];
+            if (!channel.valid) missing |= 1u << i;
+            else if (!key && channel.sentValid) {
+                const uint32_t decimation = 1u << std::max(0, m_level - channel.priority);
+                if (channel.value == channel.sent || m_deltaIndex % decimation != 0) skipped |= 1u << i;
+            }
+        }
+        writeVarint(out, missing);
+        if (!key) writeVarint(out, skipped);
+        for (size_t i = 0; i < m_channelCount; i++) {
+            Channel& channel = m_channels[i];
+            // a key frame resets missing channels, so both sides agree on what their next delta is from
+            if (!channel.valid) {
+                if (key) channel.sent = 0;
+                channel.sentValid = false;
+                continue;
+            }
+            if (skipped & (1u << i)) continue;
+            writeVarint(out, zigzag(key ? channel.value : int64_t(channel.value) - channel.sent));
+            channel.sent = channel.value;
+            channel.sentValid = true;
+        }
+        if (!key) m_deltaIndex++;
+        m_lastTimestamp = timestamp;
+        m_dataDue = false;
+        if (key) {
+            m_keyDue = false;
+            m_framesSinceKey = 0;
+            // the schema is sent again every few key frames, for decoders which start listening late
+            if (++m_keysSinceSchema >= m_schemaInterval) m_schemaDue = true;
+        } else {
+            m_framesSinceKey++;
+        }
+    }
+    m_sequence++;
+    const size_t size = out - frame.data();
+    *out++ = crc8(frame.first(size));
+    return size + 1;
+}
+
+int32_t TelemetryStream::encode(uint32_t timestamp, std::span<uint8_t> buffer) {
+    if (!m_schemaDue && !m_dataDue) return 0;
+    // the frame is only built once the buffer is known to fit it, so a failed call changes nothing
+    if (buffer.size() < MAX_FRAME_SIZE) {
+        errno = ENOBUFS;
+        return INT_MAX;
+    }
+    if (!updateBudget(timestamp)) return 0;
+    const size_t size = cobsEncode(std::span(m_frame).first(writeFrame(timestamp, m_frame)), buffer);
+    m_tokens -= int64_t(size) * BUDGET_WINDOW;
+    m_windowBytes += size;
+    return size;
+}
+
+int32_t TelemetryStream::send(FILE* file) {
+    const uint32_t timestamp = pros::c::micros();
+    while (true) {
+        const int32_t size = encode(timestamp, m_encoded);
+        if (size == 0) break;
+        if (std::fwrite(m_encoded.data(), 1, size, file) != size_t(size)) {
+            errno = EIO;
+            return INT_MAX;
+        }
+    }
+    std::fflush(file);
+    return 0;
+}
+
+int32_t TelemetryStreamDecoder::push(uint8_t byte) {
+    if (byte != 0) {
+        if (m_size == m_buffer.size()) m_overflow = true;
+        else m_buffer[m_size++] = byte;
+        return 0;
+    }
+    const size_t size = m_size;
+    const bool overflow = m_overflow;
+    m_size = 0;
+    m_overflow = false;
+    if (overflow) {
+        m_errors++;
+        errno = ENOBUFS;
+        return INT_MAX;
+    }
+    // two 0 bytes in a row end an empty frame, which is skipped
+    if (size == 0) return 0;
+    return decode(std::span(m_buffer).first(size));
+}
+
+int32_t TelemetryStreamDecoder::decode(std::span<const uint8_t> frame) {
+    const size_t size = frame.size() > m_decoded.size() ? SIZE_MAX : cobsDecode(frame, m_decoded);
+    // every frame has at least its type, sequence number and checksum
+    if (size == SIZE_MAX || size < 3 || crc8(std::span(m_decoded).first(size - 1)) != m_decoded[size - 1]) {
+        m_errors++;
+        errno = EPROTO;
+        return INT_MAX;
+    }
+    const uint8_t* in = m_decoded.data();
+    const uint8_t* const end = in + size - 1;
+    const uint8_t type = *in++;
+    const uint8_t sequence = *in++;
+    // a gap in the sequence numbers means frames were lost, so the deltas after it are from the wrong values
+    const uint8_t lost = sequence - m_sequence - 1;
+    if (m_synced && lost != 0) {
+        m_errors += lost;
+        m_synced = false;
+    }
+    m_sequence = sequence;
+    auto malformed = [&] {
+        m_errors++;
+        m_synced = false;
+        errno = EPROTO;
+        return INT_MAX;
+    };
+
+    if (type == uint8_t(StreamFrameType::SCHEMA)) {
+        if (end - in < 2 || *in++ != TelemetryStream::FORMAT_VERSION) return malformed();
+        const size_t count = *in++;
+        if (count > TelemetryStream::MAX_CHANNELS) return malformed();
+        for (size_t i = 0; i < count; i++) {
+            double resolution;
+            if (end - in < ptrdiff_t(sizeof(resolution)) + 1) return malformed();
+            std::memcpy(&resolution, in, sizeof(resolution));
+            in += sizeof(resolution);
+            const size_t length = *in++;
+            if (length > TelemetryStream::MAX_NAME_LENGTH || end - in < ptrdiff_t(length)) return malformed();
+            Channel& channel = m_channels[i];
+            std::memcpy(channel.name.data(), in, length);
+            channel.name[length] = '\0';
+            channel.resolution = resolution;
+            in += length;
+        }
+        if (in != end) return malformed();
+        m_channelCount = count;
+        m_hasSchema = true;
+        // the channels may have changed, so wait for a key frame
+        m_synced = false;
+        return int32_t(StreamFrameType::SCHEMA);
+    }
+
+    if (type != uint8_t(StreamFrameType::KEY) && type != uint8_t(StreamFrameType::DELTA)) return malformed();
+    const bool key = type == uint8_t(StreamFrameType::KEY);
+    if (!m_hasSchema || (!key && !m_synced)) {
+        errno = ENODATA;
+        return INT_MAX;
+    }
+    uint64_t timestamp;
+    uint64_t missing;
+    uint64_t skipped = 0;
+    if (!readVarint(in, end, timestamp) || !readVarint(in, end, missing)) return malformed();
+    if (!key && !readVarint(in, end, skipped)) return malformed();
+    // the frame is parsed into a copy, so a malformed frame leaves the last values
+    std::array<int32_t, TelemetryStream::MAX_CHANNELS> values;
+    for (size_t i = 0; i < m_channelCount; i++) {
+        values[i] = m_channels[i].value;
+        if (missing & (1ull << i)) {
+            if (key) values[i] = 0;
+            continue;
+        }
+        if (skipped & (1ull << i)) continue;
+        uint64_t value;
+        if (!readVarint(in, end, value)) return malformed();
+        values[i] = key ? unzigzag(value) : int64_t(values[i]) + unzigzag(value);
+    }
+    if (in != end) return malformed();
+    for (size_t i = 0; i < m_channelCount; i++) {
+        m_channels[i].value = values[i];
+        // skipped channels keep their last value, and whether it was valid
+        if (!(skipped & (1ull << i))) m_channels[i].valid = !(missing & (1ull << i));
+    }
+    m_timestamp = key ? timestamp : m_timestamp + timestamp;
+    m_synced = true;
+    return key ? int32_t(StreamFrameType::KEY) : int32_t(StreamFrameType::DELTA);
+}
+
+size_t TelemetryStreamDecoder::getChannelCount() const { return m_channelCount; }
+
+const char* TelemetryStreamDecoder::getName(size_t channel) const {
+    if (channel >= m_channelCount) return nullptr;
+    return m_channels[channel].name.data();
+}
+
+double TelemetryStreamDecoder::getValue(size_t channel) const {
+    if (channel >= m_channelCount || !m_channels[channel].valid) return INFINITY;
+    return m_channels[channel].value * m_channels[channel].resolution;
+}
+
+uint32_t TelemetryStreamDecoder::getTimestamp() const { return m_timestamp; }
+
+uint32_t TelemetryStreamDecoder::getErrors() const { return m_errors; }
+} // namespace lemlib
@@ -0,0 +1,130 @@
+#include "hardware/Trace.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cinttypes>
+#include <climits>
+#include <cstring>
+
+namespace lemlib {
+namespace {
+// the most tasks which get their own track. Events of other tasks share the last one
+constexpr size_t MAX_TRACKS = 16;
+constexpr size_t NAME_SIZE = 32;
+
+struct Track {
+        std::atomic<pros::task_t> task = nullptr;
+        // the name is copied when the track is created, as the task may be deleted before the trace is written
+        char name[NAME_SIZE] {};
+};
+
+/**
+ * @brief A span in the ring of the runtime trace
+ *
+ * The slot is written like a sequence lock: the sequence is cleared, the fields are written, and then the sequence is
+ * set to one more than the index of the span. A reader which sees the same sequence before and after it reads the
+ * fields got a whole span. The fields are atomics, so a reader racing a writer isn't undefined behavior
+ */
+struct TraceEvent {
+        std::atomic<size_t> sequence;
+        std::atomic<const char*> name;
+        std::atomic<uint32_t> start;
+        std::atomic<uint32_t> duration;
+        std::atomic<uint8_t> track;
+};
+
+std::array<Track, MAX_TRACKS> tracks {};
+std::array<TraceEvent, LEMLIB_TRACE_SIZE> events {};
+// the index of the next span
+std::atomic<size_t> next = 0;
+// the index of the first span which is written, moved by resetTrace
+std::atomic<size_t> first = 0;
+} // namespace
+
+namespace detail {
+uint8_t getTraceTrack() {
+    const pros::task_t task = pros::c::task_get_current();
+    for (size_t i = 0; i < MAX_TRACKS; i++) {
+        pros::task_t expected = tracks[i].task.load(std::memory_order_acquire);
+        if (expected == task) return i;
+        if (expected != nullptr) continue;
+        if (tracks[i].task.compare_exchange_strong(expected, task, std::memory_order_acq_rel)) {
+            std::strncpy(tracks[i].name, pros::c::task_get_name(task), NAME_SIZE - 1);
+            return i;
+        }
+        // another task took the slot first, which might be this one's
+        if (expected == task) return i;
+    }
+    return MAX_TRACKS - 1;
+}
+
+void writeTraceTracks(FILE* file) {
+    for (size_t i = 0; i < MAX_TRACKS; i++) {
+        if (tracks[i].task.load(std::memory_order_acquire) == nullptr) break;
+        std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,", i + 1);
+        std::fprintf(file, "\"args\":{\"name\":");
+        writeJsonString(file, tracks[i].name);
+        std::fprintf(file, "}}");
+    }
+}
+
+void writeJsonString(FILE* file, const char* string) {
+    std::fputc('"', file);
+    for (; *string != '\0'; string++) {
+        if (*string == '"' || *string == '\\') std::fputc('\\', file);
+        std::fputc(*string, file);
+    }
+    std::fputc('"', file);
+}
+} // namespace detail
+
+void recordTrace(const char* name, uint64_t start) {
+    const uint32_t duration = pros::c::micros() - start;
+    const size_t index = next.fetch_add(1, std::memory_order_relaxed);
+    TraceEvent& event = events[index % events.size()];
+    event.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.name.store(name, std::memory_order_relaxed);
+    event.start.store(start, std::memory_order_relaxed);
+    event.duration.store(duration, std::memory_order_relaxed);
+    event.track.store(detail::getTraceTrack(), std::memory_order_relaxed);
+    event.sequence.store(index + 1, std::memory_order_release);
+}
+
+int32_t dumpTrace(FILE* file) {
+    const size_t end = next.load(std::memory_order_relaxed);
+    const size_t begin = std::max(first.load(std::memory_order_relaxed), end < events.size() ? 0 : end - events.size());
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"V5 brain\"}}");
+    detail::writeTraceTracks(file);
+    for (size_t i = begin; i < end; i++) {
+        const TraceEvent& event = events[i % events.size()];
+        const size_t sequence = event.sequence.load(std::memory_order_acquire);
+        const char* const name = event.name.load(std::memory_order_relaxed);
+        const uint32_t start = event.start.load(std::memory_order_relaxed);
+        const uint32_t duration = event.duration.load(std::memory_order_relaxed);
+        const uint8_t track = event.track.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // the span is still being written, or was overwritten by a newer one
+        if (sequence != i + 1 || event.sequence.load(std::memory_order_relaxed) != sequence) continue;
+        std::fprintf(file, ",\n{\"name\":");
+        detail::writeJsonString(file, name);
+        std::fprintf(file, ",\"cat\":\"trace\",\"ph\":\"X\",\"pid\":1,\"tid\":%u", track + 1u);
+        std::fprintf(file, ",\"ts\":%" PRIu32 ",\"dur\":%" PRIu32 "}", start, duration);
+    }
+    std::fprintf(file, "\n]}\n");
+    std::fflush(file);
+    return 0;
+}
+
+int32_t dumpTrace(const char* path) {
+    FILE* file = std::fopen(path, "w");
+    // fopen has already set errno
+    if (file == nullptr) return INT_MAX;
+    dumpTrace(file);
+    std::fclose(file);
+    return 0;
+}
+
+void resetTrace() { first.store(next.load(std::memory_order_relaxed), std::memory_order_relaxed); }
+} // namespace lemlib
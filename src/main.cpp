@@ -1,3 +1,6 @@
+// the benchmark program in src/bench replaces this program when it is built with `make bench`
+#ifndef LEMLIB_BENCH
+
 #include "main.h"
 #include "hardware/Motor/Motor.hpp"
 #include "hardware/Motor/MotorGroup.hpp"
@@ -6,4 +9,6 @@ void initialize() {
     auto motor = lemlib::Motor(1, 200_rpm);
     pros::delay(3000);
     std::cout << sizeof(int) << std::endl;
-}
\ No newline at end of file
+}
+
+#endif